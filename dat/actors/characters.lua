@@ -695,62 +695,3 @@ characters[LUKAR] = {
 } -- characters[LUKAR]
 
 ]]--
-
-------------------------------------------------------------------------------[[
--- \brief Called everytime a character reaches a new experience level.
--- \param character A pointer to the GlobalCharacter who has gained the new level
---
--- Before this function is called, the character should already have their
--- _experience_level member incremented. What this function does is determine
--- the amount that each stat will grow by on the next level and if any new
--- skills are learned on this level.
-------------------------------------------------------------------------------]]
-function DetermineGrowth(character)
-	local new_level = character:GetExperienceLevel();        -- The value of the character's new XP level
-	local character_table = characters[character:GetID()];   -- Reference to the character's definition table
-	local growth_table = nil;                                -- Reference to the table containing the growth stats for this level
-	local new_skills = character_table["skills"][new_level]; -- Reference to the number or table of the new skills learned
-	local character_growth = character:GetGrowth();          -- Reference to the growth object contained within the character
-
-	if (character_table == nil) then
-		print("LUA ERROR: characters.lua::GainExperienceLevel() failed because the character's ID was invalid");
-		return;
-	end
-
-	-- Find the appropriate index in the growth_stats table for determining how much the stats should grow by this level
-	local growth_index = new_level
-	while (growth_index > 0) do
-		if (character_table["growth_stats"][growth_index] ~= nil) then
-			growth_table = character_table["growth_stats"][growth_index];
-			break;
-		end
-		growth_index = growth_index - 1;
-	end
-
-	if (growth_table == nil) then
-		print("LUA ERROR: characters.lua::GainExperienceLevel() failed because no growth stats were found");
-		return;
-	end
-
-	-- Calculate how much the character's stats are going to grow by the next level
-	character_growth._hit_points_growth = growth_table["hit_points"];
-	character_growth._skill_points_growth = growth_table["skill_points"];
-	character_growth._strength_growth = growth_table["strength"];
-	character_growth._vigor_growth = growth_table["vigor"];
-	character_growth._fortitude_growth = growth_table["fortitude"];
-	character_growth._protection_growth = growth_table["protection"];
-	character_growth._agility_growth = growth_table["agility"];
-	character_growth._evade_growth = 0;
-
-	-- Determine if the character learns any skills at this new level
-	if (type(new_skills) == "number") then
-		character_growth:_AddSkill(new_skills);
-	elseif (type(new_skills) == "table") then
-		for i, skill in ipairs(new_skills) do
-			character_growth:_AddSkill(skill);
-		end
-	elseif (type(new_skills) ~= "nil") then
-		print("LUA ERROR: characters.lua::GainExperienceLevel() failed because of an unknown skill type");
-		return;
-	end
-end -- function DetermineGrowth(character)
@@ -0,0 +1,36 @@
+-- The deterministic benchmark run by the test program (see src/test/test_benchmark.h).
+-- Every map is run for the given number of frames, followed by the battles.
+benchmark = {}
+
+-- The seed of the random number generators, set again before each run
+benchmark.seed = 1000
+
+-- The number of frames each map and battle is run for. Each frame updates the game by 10 milliseconds.
+benchmark.frames = 1200
+
+-- The key events replayed during each run: { frame, game command, pressed }
+-- The commands are those of the settings key table: up, down, left, right, confirm, cancel,
+-- menu, swap, left_select, right_select and pause.
+benchmark.input = {
+	{ 60, "down", true },
+	{ 180, "down", false },
+	{ 180, "right", true },
+	{ 300, "right", false },
+	{ 300, "up", true },
+	{ 420, "up", false },
+	{ 420, "left", true },
+	{ 540, "left", false },
+	{ 600, "confirm", true },
+	{ 605, "confirm", false },
+	{ 700, "confirm", true },
+	{ 705, "confirm", false },
+	{ 800, "confirm", true },
+	{ 805, "confirm", false },
+	{ 900, "confirm", true },
+	{ 905, "confirm", false }
+}
+
+-- The functions of dat/config/debug_battle.lua starting the battles to run
+benchmark.battles = {
+	"BootBattleTest"
+}
@@ -211,6 +211,11 @@ layers[3][23] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
 
 -- Valyria Tear map editor end. Do not edit this line. Place your scripts after this line. --
 
+-- The sounds played by the map scripts, loaded in the background while the map fades in
+sound_filenames = {
+	"snd/heal_spell.wav"
+}
+
 -- the main character handler
 local hero = {};
 
@@ -240,6 +245,9 @@ function Load(m)
 	-- Add clouds overlay
 	Map:GetEffectSupervisor():EnableAmbientOverlay("img/ambient/clouds.png", 5.0, 5.0, true);
 
+	-- Preload the healing effect, so that it shows up without delay
+	Map:GetParticleManager():PreloadEffect("dat/effects/particles/heal_particle.lua");
+
 	Map:AddSavePoint(19, 27, hoa_map.MapMode.CONTEXT_01);
 end
 
@@ -238,6 +238,12 @@ layers[4][23] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
 
 -- Valyria Tear map editor end. Do not edit this line. Place your scripts after this line. --
 
+-- The sounds played by the map scripts, loaded in the background while the map fades in
+sound_filenames = {
+	"snd/door_close.wav",
+	"snd/door_open2.wav"
+}
+
 -- The main character handlers
 local bronann = {};
 local bronanns_dad = {};
@@ -263,6 +263,13 @@ layers[2][39] = { -1, -1, -1, -1, -1, -1, 40, 41, 20, 21, -1, -1, -1, -1, -1, -1
 
 -- Valyria Tear map editor end. Do not edit this line. Place your scripts after this line. --
 
+-- The sounds played by the map scripts, loaded in the background while the map fades in
+sound_filenames = {
+	"snd/door_close.wav",
+	"snd/door_open2.wav",
+	"snd/rumble.wav"
+}
+
 local bronann = {};
 local kalya = {};
 
@@ -268,6 +268,12 @@ layers[5][23] = { 531, 532, 533, -1, -1, -1, 513, 514, 515, 516, -1, -1, -1, -1,
 
 -- Valyria Tear map editor end. Do not edit this line. Place your scripts after this line. --
 
+-- The sounds played by the map scripts, loaded in the background while the map fades in
+sound_filenames = {
+	"snd/door_close.wav",
+	"snd/door_open2.wav"
+}
+
 local bronann = {};
 
 -- the main map loading code
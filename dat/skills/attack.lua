@@ -22,6 +22,7 @@
 --                  executing the skill before their stamina begins regenrating (zero is valid).
 -- {action_name}: The sprite action played before executing the battle scripted function.
 -- {target_type}: The type of target the skill affects, which may be an attack point, actor, or party.
+-- {sounds}: (optional) The sounds played by the skill functions, loaded while a battle starts.
 --
 -- Each skill entry requires a function called {BattleExecute} to be defined. This function implements the
 -- execution of the skill in battle, dealing damage, causing status changes, playing sounds, and animating
@@ -47,6 +48,8 @@ skills[1] = {
 	action_name = "attack",
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_FOE_POINT,
 
+	sounds = { "snd/swordslice1.wav", "snd/sword_swipe.wav" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 
@@ -75,6 +78,8 @@ skills[2] = {
 	action_name = "attack",
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_FOE_POINT,
 
+	sounds = { "snd/swordslice1.wav", "snd/sword_swipe.wav" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 
@@ -103,6 +108,8 @@ skills[3] = {
 	action_name = "attack",
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_FOE,
 
+	sounds = { "snd/swordslice1.wav", "snd/sword_swipe.wav" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 
@@ -132,6 +139,8 @@ skills[4] = {
 	action_name = "attack",
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_FOE_POINT,
 
+	sounds = { "snd/swordslice2.wav", "snd/sword_swipe.wav" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 
@@ -160,6 +169,8 @@ skills[5] = {
 	action_name = "attack",
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_FOE_POINT,
 
+	sounds = { "snd/crossbow.ogg", "snd/crossbow_miss.ogg" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 
@@ -187,6 +198,8 @@ skills[6] = {
 	action_name = "attack",
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_FOE_POINT,
 
+	sounds = { "snd/swordslice2.wav", "snd/missed_target.wav" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 
@@ -211,6 +224,8 @@ skills[1001] = {
 	cooldown_time = 500,
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_FOE_POINT,
 
+	sounds = { "snd/slime_attack.wav" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 
@@ -230,6 +245,8 @@ skills[1002] = {
 	cooldown_time = 0,
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_FOE_POINT,
 
+	sounds = { "snd/spider_attack.wav" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 
@@ -249,6 +266,8 @@ skills[1003] = {
 	cooldown_time = 0,
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_FOE_POINT,
 
+	sounds = { "snd/snake_attack.wav" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 
@@ -268,6 +287,8 @@ skills[1004] = {
 	cooldown_time = 0,
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_FOE_POINT,
 
+	sounds = { "snd/skeleton_attack.wav" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 
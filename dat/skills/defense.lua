@@ -21,6 +21,7 @@
 -- {cooldown_time}: The number of milliseconds that the actor using the skill must wait after
 --                  executing the skill before their stamina begins regenrating (zero is valid).
 -- {target_type}: The type of target the skill affects, which may be an attack point, actor, or party.
+-- {sounds}: (optional) The sounds played by the skill functions, loaded while a battle starts.
 --
 -- Each skill entry requires a function called {BattleExecute} to be defined. This function implements the
 -- execution of the skill in battle, buffing defense, causing status changes, playing sounds, and animating
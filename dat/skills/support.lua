@@ -23,6 +23,7 @@
 -- {cooldown_time}: The number of milliseconds that the actor using the skill must wait after
 --                  executing the skill before their stamina begins regenrating (zero is valid).
 -- {target_type}: The type of target the skill affects, which may be an attack point, actor, or party.
+-- {sounds}: (optional) The sounds played by the skill functions, loaded while a battle starts.
 --
 -- Each skill entry requires a function called {BattleExecute} to be defined. This function implements the
 -- execution of the skill in battle, buffing defense, causing status changes, playing sounds, and animating
@@ -53,6 +54,8 @@ skills[20001] = {
 	cooldown_time = 200,
 	target_type = hoa_global.GameGlobal.GLOBAL_TARGET_ALLY,
 
+	sounds = { "snd/heal.wav" },
+
 	BattleExecute = function(user, target)
 		target_actor = target:GetActor();
 		target_actor:AddHitPoints(hoa_utils.RandomBoundedInteger(30, 50));
@@ -126,6 +126,8 @@ GameGlobal::~GameGlobal() {
 
 	_battle_events_script.CloseTable();
 	_battle_events_script.CloseFile();
+
+	_ClearActorDefinitions();
 } // GameGlobal::~GameGlobal()
 
 bool GameGlobal::SingletonInitialize() {
@@ -202,6 +204,10 @@ bool GameGlobal::SingletonInitialize() {
 	}
 	_battle_events_script.OpenTable("battle_events");
 
+	// The actor definitions are read last since they rely on the constants defined in the other files
+	if (!_LoadActorDefinitions())
+		return false;
+
 	return true;
 } // bool GameGlobal::SingletonInitialize()
 
@@ -349,6 +355,30 @@ GlobalCharacter* GameGlobal::GetCharacter(uint32 id) {
 }
 
 
+const GlobalCharacterDef* GameGlobal::GetCharacterDef(uint32 id) const {
+	std::map<uint32, GlobalCharacterDef*>::const_iterator it = _character_defs.find(id);
+	if (it == _character_defs.end())
+		return NULL;
+	else
+		return it->second;
+}
+
+
+const GlobalEnemyDef* GameGlobal::GetEnemyDef(uint32 id) const {
+	std::map<uint32, GlobalEnemyDef*>::const_iterator it = _enemy_defs.find(id);
+	if (it == _enemy_defs.end())
+		return NULL;
+	else
+		return it->second;
+}
+
+
+void GameGlobal::ReloadActorDefinitions() {
+	_ClearActorDefinitions();
+	_LoadActorDefinitions();
+}
+
+
 void GameGlobal::SwapCharactersByIndex(uint32 first_index, uint32 second_index) {
 	// Deal with the ordered characters
 	if (first_index == second_index) {
@@ -1357,4 +1387,61 @@ void GameGlobal::_LoadEvents(ReadScriptDescriptor& file, const std::string& grou
 	file.CloseTable();
 }
 
+
+
+bool GameGlobal::_LoadActorDefinitions() {
+	std::vector<uint32> ids;
+
+	ReadScriptDescriptor characters_script;
+	if (!characters_script.OpenFile("dat/actors/characters.lua")) {
+		PRINT_ERROR << "failed to open character data file" << std::endl;
+		return false;
+	}
+	characters_script.OpenTable("characters");
+	characters_script.ReadTableKeys(ids);
+	for (uint32 i = 0; i < ids.size(); ++i) {
+		GlobalCharacterDef* definition = new GlobalCharacterDef();
+		if (definition->Load(characters_script, ids[i]))
+			_character_defs[ids[i]] = definition;
+		else
+			delete definition;
+	}
+	characters_script.CloseTable();
+	characters_script.CloseFile();
+
+	ids.clear();
+	ReadScriptDescriptor enemies_script;
+	if (!enemies_script.OpenFile("dat/actors/enemies.lua")) {
+		PRINT_ERROR << "failed to open enemy data file" << std::endl;
+		return false;
+	}
+	enemies_script.OpenTable("enemies");
+	enemies_script.ReadTableKeys(ids);
+	for (uint32 i = 0; i < ids.size(); ++i) {
+		GlobalEnemyDef* definition = new GlobalEnemyDef();
+		if (definition->Load(enemies_script, ids[i]))
+			_enemy_defs[ids[i]] = definition;
+		else
+			delete definition;
+	}
+	enemies_script.CloseTable();
+	enemies_script.CloseFile();
+
+	IF_PRINT_DEBUG(GLOBAL_DEBUG) << "loaded " << _character_defs.size() << " character and "
+		<< _enemy_defs.size() << " enemy definitions" << std::endl;
+	return true;
+} // bool GameGlobal::_LoadActorDefinitions()
+
+
+
+void GameGlobal::_ClearActorDefinitions() {
+	for (std::map<uint32, GlobalCharacterDef*>::iterator it = _character_defs.begin(); it != _character_defs.end(); ++it)
+		delete it->second;
+	_character_defs.clear();
+
+	for (std::map<uint32, GlobalEnemyDef*>::iterator it = _enemy_defs.begin(); it != _enemy_defs.end(); ++it)
+		delete it->second;
+	_enemy_defs.clear();
+}
+
 } // namespace hoa_global
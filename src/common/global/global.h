@@ -210,6 +210,27 @@ public:
 		{ if (_characters.find(id) != _characters.end()) return true; else return false; }
 	//@}
 
+	//! \name Actor Definition Functions
+	//@{
+	/** \brief Returns the definition of a character, as read from dat/actors/characters.lua
+	*** \param id The ID number of the character
+	*** \return A pointer to the definition, or NULL if no character has this id
+	**/
+	const GlobalCharacterDef* GetCharacterDef(uint32 id) const;
+
+	/** \brief Returns the definition of an enemy, as read from dat/actors/enemies.lua
+	*** \param id The ID number of the enemy
+	*** \return A pointer to the definition, or NULL if no enemy has this id
+	**/
+	const GlobalEnemyDef* GetEnemyDef(uint32 id) const;
+
+	/** \brief Reads the actor definitions again
+	*** The actor names are translated when the definitions are read, so this must be called
+	*** whenever the game language changes.
+	**/
+	void ReloadActorDefinitions();
+	//@}
+
 	//! \name Inventory Methods
 	//@{
 	/** \brief Adds a new object to the inventory
@@ -610,6 +631,15 @@ private:
 	std::vector<GlobalKeyItem*>  _inventory_key_items;
 	//@}
 
+	/** \brief The character and enemy definitions, indexed by their id
+	*** They are read once from the actor data files, and every GlobalCharacter and GlobalEnemy
+	*** object is then created from them.
+	**/
+	//@{
+	std::map<uint32, GlobalCharacterDef*> _character_defs;
+	std::map<uint32, GlobalEnemyDef*> _enemy_defs;
+	//@}
+
 	//! \name Global data and function script files
 	//@{
 	//! \brief Contains character ID definitions and a number of useful functions
@@ -729,6 +759,14 @@ private:
 	*** \param group_name The name of the event group to load
 	**/
 	void _LoadEvents(hoa_script::ReadScriptDescriptor& file, const std::string& group_name);
+
+	/** \brief Reads the character and enemy definitions from their data files
+	*** \return False if one of the data files could not be opened
+	**/
+	bool _LoadActorDefinitions();
+
+	//! \brief Deletes the character and enemy definitions
+	void _ClearActorDefinitions();
 }; // class GameGlobal : public hoa_utils::Singleton<GameGlobal>
 
 //-----------------------------------------------------------------------------
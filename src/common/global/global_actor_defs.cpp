@@ -0,0 +1,341 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    global_actor_defs.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Source file for the global actor definitions
+*** ***************************************************************************/
+
+#include "global_actor_defs.h"
+
+#include "engine/script/script_read.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_script;
+
+namespace hoa_global {
+
+namespace {
+
+//! \brief Used to sort the growth stats by experience level
+bool CompareGrowthStatsLevel(const GlobalGrowthStatsDef& a, const GlobalGrowthStatsDef& b) {
+	return a.experience_level < b.experience_level;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// GlobalAttackPointDef class
+////////////////////////////////////////////////////////////////////////////////
+
+GlobalAttackPointDef::GlobalAttackPointDef() :
+	x_position(0),
+	y_position(0),
+	fortitude_modifier(0.0f),
+	protection_modifier(0.0f),
+	evade_modifier(0.0f)
+{}
+
+
+
+bool GlobalAttackPointDef::Load(ReadScriptDescriptor& script) {
+	if (script.IsFileOpen() == false) {
+		return false;
+	}
+
+	name = MakeUnicodeString(script.ReadString("name"));
+	x_position = script.ReadInt("x_position");
+	y_position = script.ReadInt("y_position");
+	fortitude_modifier = script.ReadFloat("fortitude_modifier");
+	protection_modifier = script.ReadFloat("protection_modifier");
+	evade_modifier = script.ReadFloat("evade_modifier");
+
+	// Status effect data is optional so check if a status_effect table exists first
+	if (script.DoesTableExist("status_effects") == true) {
+		script.OpenTable("status_effects");
+
+		std::vector<int32> table_keys;
+		script.ReadTableKeys(table_keys);
+		for (uint32 i = 0; i < table_keys.size(); i++) {
+			float probability = script.ReadFloat(table_keys[i]);
+			status_effects.push_back(make_pair(static_cast<GLOBAL_STATUS>(table_keys[i]), probability));
+		}
+
+		script.CloseTable();
+	}
+
+	if (script.IsErrorDetected()) {
+		if (GLOBAL_DEBUG) {
+			PRINT_WARNING << "one or more errors occurred while reading the attack point data - they are listed below" << endl;
+			cerr << script.GetErrorMessages() << endl;
+		}
+		return false;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GlobalGrowthStatsDef class
+////////////////////////////////////////////////////////////////////////////////
+
+GlobalGrowthStatsDef::GlobalGrowthStatsDef() :
+	experience_level(0),
+	hit_points(0),
+	skill_points(0),
+	strength(0),
+	vigor(0),
+	fortitude(0),
+	protection(0),
+	agility(0)
+{}
+
+////////////////////////////////////////////////////////////////////////////////
+// GlobalCharacterDef class
+////////////////////////////////////////////////////////////////////////////////
+
+GlobalCharacterDef::GlobalCharacterDef() :
+	id(0),
+	experience_level(0),
+	experience_points(0),
+	max_hit_points(0),
+	max_skill_points(0),
+	strength(0),
+	vigor(0),
+	fortitude(0),
+	protection(0),
+	agility(0),
+	evade(0.0f),
+	weapon(0),
+	head_armor(0),
+	torso_armor(0),
+	arm_armor(0),
+	leg_armor(0)
+{}
+
+
+
+bool GlobalCharacterDef::Load(ReadScriptDescriptor& script, uint32 character_id) {
+	id = character_id;
+
+	if (!script.DoesTableExist(id)) {
+		PRINT_WARNING << "no data found for character: " << id << endl;
+		return false;
+	}
+	script.OpenTable(id);
+
+	name = MakeUnicodeString(script.ReadString("name"));
+	portrait = script.ReadString("portrait");
+	full_portrait = script.ReadString("full_portrait");
+	stamina_icon = script.ReadString("stamina_icon");
+	battle_portraits = script.ReadString("battle_portraits");
+	map_sprite_name = script.ReadString("map_sprite_name");
+
+	std::vector<std::string> keys_vect;
+	script.ReadTableKeys("battle_animations", keys_vect);
+	script.OpenTable("battle_animations");
+	for (uint32 i = 0; i < keys_vect.size(); ++i)
+		battle_animations[keys_vect[i]] = script.ReadString(keys_vect[i]);
+	script.CloseTable();
+
+	script.OpenTable("initial_stats");
+	experience_level = script.ReadUInt("experience_level");
+	experience_points = script.ReadUInt("experience_points");
+	max_hit_points = script.ReadUInt("max_hit_points");
+	max_skill_points = script.ReadUInt("max_skill_points");
+	strength = script.ReadUInt("strength");
+	vigor = script.ReadUInt("vigor");
+	fortitude = script.ReadUInt("fortitude");
+	protection = script.ReadUInt("protection");
+	agility = script.ReadUInt("agility");
+	evade = script.ReadFloat("evade");
+	weapon = script.ReadUInt("weapon");
+	head_armor = script.ReadUInt("head_armor");
+	torso_armor = script.ReadUInt("torso_armor");
+	arm_armor = script.ReadUInt("arm_armor");
+	leg_armor = script.ReadUInt("leg_armor");
+	script.CloseTable();
+
+	script.OpenTable("attack_points");
+	attack_points.resize(GLOBAL_POSITION_LEGS + 1);
+	for (uint32 i = GLOBAL_POSITION_HEAD; i <= GLOBAL_POSITION_LEGS; i++) {
+		script.OpenTable(i);
+		if (attack_points[i].Load(script) == false) {
+			IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to succesfully load data for attack point: " << i << endl;
+		}
+		script.CloseTable();
+	}
+	script.CloseTable();
+
+	// The growth stats are indexed by the experience level from which they apply
+	std::vector<uint32> levels;
+	script.ReadTableKeys("growth_stats", levels);
+	script.OpenTable("growth_stats");
+	for (uint32 i = 0; i < levels.size(); i++) {
+		GlobalGrowthStatsDef growth;
+		growth.experience_level = levels[i];
+		script.OpenTable(levels[i]);
+		growth.hit_points = script.ReadUInt("hit_points");
+		growth.skill_points = script.ReadUInt("skill_points");
+		growth.strength = script.ReadUInt("strength");
+		growth.vigor = script.ReadUInt("vigor");
+		growth.fortitude = script.ReadUInt("fortitude");
+		growth.protection = script.ReadUInt("protection");
+		growth.agility = script.ReadUInt("agility");
+		script.CloseTable();
+		growth_stats.push_back(growth);
+	}
+	script.CloseTable();
+	sort(growth_stats.begin(), growth_stats.end(), CompareGrowthStatsLevel);
+
+	// The skills table contains key/value pairs. The key indicate the level required to learn the skill and the value
+	// is either the skill's id or a table of skill ids. ReadTableKeys does not guarantee returning the keys in a sorted
+	// order, so they are sorted afterwards.
+	levels.clear();
+	script.ReadTableKeys("skills", levels);
+	sort(levels.begin(), levels.end());
+	script.OpenTable("skills");
+	for (uint32 i = 0; i < levels.size(); i++) {
+		if (script.DoesTableExist(levels[i])) {
+			std::vector<uint32> skill_ids;
+			script.ReadUIntVector(levels[i], skill_ids);
+			for (uint32 j = 0; j < skill_ids.size(); j++)
+				skills.push_back(make_pair(levels[i], skill_ids[j]));
+		}
+		else {
+			skills.push_back(make_pair(levels[i], script.ReadUInt(levels[i])));
+		}
+	}
+	script.CloseTable();
+
+	script.CloseTable(); // characters[id]
+
+	if (script.IsErrorDetected()) {
+		if (GLOBAL_DEBUG) {
+			PRINT_WARNING << "one or more errors occurred while reading the data of character " << id << " - they are listed below" << endl;
+			cerr << script.GetErrorMessages() << endl;
+		}
+	}
+
+	return true;
+} // bool GlobalCharacterDef::Load(ReadScriptDescriptor& script, uint32 character_id)
+
+
+
+const GlobalGrowthStatsDef* GlobalCharacterDef::GetGrowthStats(uint32 level) const {
+	const GlobalGrowthStatsDef* growth = NULL;
+	for (uint32 i = 0; i < growth_stats.size(); i++) {
+		if (growth_stats[i].experience_level > level)
+			break;
+		if (growth_stats[i].experience_level > 0)
+			growth = &growth_stats[i];
+	}
+	return growth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GlobalEnemyDef class
+////////////////////////////////////////////////////////////////////////////////
+
+GlobalEnemyDef::GlobalEnemyDef() :
+	id(0),
+	sprite_width(0),
+	sprite_height(0),
+	no_stat_randomization(false),
+	hit_points(0),
+	skill_points(0),
+	experience_points(0),
+	strength(0),
+	vigor(0),
+	fortitude(0),
+	protection(0),
+	agility(0),
+	evade(0.0f),
+	drunes(0)
+{}
+
+
+
+bool GlobalEnemyDef::Load(ReadScriptDescriptor& script, uint32 enemy_id) {
+	id = enemy_id;
+
+	if (!script.DoesTableExist(id)) {
+		PRINT_WARNING << "no data found for enemy: " << id << endl;
+		return false;
+	}
+	script.OpenTable(id);
+
+	name = MakeUnicodeString(script.ReadString("name"));
+	sprite_width = script.ReadInt("sprite_width");
+	sprite_height = script.ReadInt("sprite_height");
+	battle_sprites = script.ReadString("battle_sprites");
+	stamina_icon = script.ReadString("stamina_icon");
+
+	if (script.DoesBoolExist("no_stat_randomization") == true) {
+		no_stat_randomization = script.ReadBool("no_stat_randomization");
+	}
+
+	script.OpenTable("base_stats");
+	hit_points = script.ReadUInt("hit_points");
+	skill_points = script.ReadUInt("skill_points");
+	experience_points = script.ReadUInt("experience_points");
+	strength = script.ReadUInt("strength");
+	vigor = script.ReadUInt("vigor");
+	fortitude = script.ReadUInt("fortitude");
+	protection = script.ReadUInt("protection");
+	agility = script.ReadUInt("agility");
+	evade = script.ReadFloat("evade");
+	drunes = script.ReadUInt("drunes");
+	script.CloseTable();
+
+	script.OpenTable("attack_points");
+	uint32 ap_size = script.GetTableSize();
+	attack_points.resize(ap_size);
+	for (uint32 i = 1; i <= ap_size; i++) {
+		script.OpenTable(i);
+		if (attack_points[i - 1].Load(script) == false) {
+			IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to load data for an attack point: " << i << endl;
+		}
+		script.CloseTable();
+	}
+	script.CloseTable();
+
+	script.OpenTable("skills");
+	for (uint32 i = 1; i <= script.GetTableSize(); i++) {
+		skills.push_back(script.ReadUInt(i));
+	}
+	script.CloseTable();
+
+	script.OpenTable("drop_objects");
+	for (uint32 i = 1; i <= script.GetTableSize(); i++) {
+		script.OpenTable(i);
+		dropped_objects.push_back(script.ReadUInt(1));
+		dropped_chance.push_back(script.ReadFloat(2));
+		script.CloseTable();
+	}
+	script.CloseTable();
+
+	script.CloseTable(); // enemies[id]
+
+	if (script.IsErrorDetected()) {
+		if (GLOBAL_DEBUG) {
+			PRINT_WARNING << "one or more errors occurred while reading the data of enemy " << id << " - they are listed below" << endl;
+			cerr << script.GetErrorMessages() << endl;
+		}
+	}
+
+	return true;
+} // bool GlobalEnemyDef::Load(ReadScriptDescriptor& script, uint32 enemy_id)
+
+} // namespace hoa_global
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    global_actor_defs.h
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Header file for the global actor definitions
+***
+*** The character and enemy data files are read once when the global manager is
+*** initialized, and their content is kept in the definition classes below.
+*** GlobalCharacter and GlobalEnemy objects are then created by copying their
+*** definition, without any Lua work.
+*** ***************************************************************************/
+
+#ifndef __GLOBAL_ACTOR_DEFS_HEADER__
+#define __GLOBAL_ACTOR_DEFS_HEADER__
+
+#include "global_utils.h"
+
+#include <map>
+
+namespace hoa_script {
+class ReadScriptDescriptor;
+}
+
+namespace hoa_global {
+
+/** ****************************************************************************
+*** \brief The definition of an attack point, shared by all the actors of a kind
+*** ***************************************************************************/
+class GlobalAttackPointDef {
+public:
+	GlobalAttackPointDef();
+
+	/** \brief Reads the attack point data
+	*** \param script The script file, with the attack point table open
+	*** \return False if the data could not be read
+	**/
+	bool Load(hoa_script::ReadScriptDescriptor& script);
+
+	hoa_utils::ustring name;
+	int16 x_position;
+	int16 y_position;
+	float fortitude_modifier;
+	float protection_modifier;
+	float evade_modifier;
+
+	//! \brief The status effects the attack point may trigger, with their probability
+	std::vector<std::pair<GLOBAL_STATUS, float> > status_effects;
+}; // class GlobalAttackPointDef
+
+
+/** ****************************************************************************
+*** \brief The stats gained by a character on each new experience level,
+*** starting from a given experience level
+*** ***************************************************************************/
+class GlobalGrowthStatsDef {
+public:
+	GlobalGrowthStatsDef();
+
+	//! \brief The experience level from which this growth applies
+	uint32 experience_level;
+
+	uint32 hit_points;
+	uint32 skill_points;
+	uint32 strength;
+	uint32 vigor;
+	uint32 fortitude;
+	uint32 protection;
+	uint32 agility;
+}; // class GlobalGrowthStatsDef
+
+
+/** ****************************************************************************
+*** \brief The definition of a playable character, read from dat/actors/characters.lua
+*** ***************************************************************************/
+class GlobalCharacterDef {
+public:
+	GlobalCharacterDef();
+
+	/** \brief Reads the character data
+	*** \param script The characters script file, with the "characters" table open
+	*** \param id The id of the character to read
+	*** \return False if the data could not be read
+	**/
+	bool Load(hoa_script::ReadScriptDescriptor& script, uint32 id);
+
+	/** \brief Returns the growth stats to use when reaching the given experience level
+	*** \return The growth stats of the closest lower or equal level, or NULL if there are none
+	**/
+	const GlobalGrowthStatsDef* GetGrowthStats(uint32 experience_level) const;
+
+	uint32 id;
+	hoa_utils::ustring name;
+
+	//! \name Image files
+	//@{
+	std::string portrait;
+	std::string full_portrait;
+	std::string stamina_icon;
+	std::string battle_portraits;
+	//! \brief The animation script files, indexed by animation name
+	std::map<std::string, std::string> battle_animations;
+	//@}
+
+	//! \brief The untranslated name used to link the character with its map sprite
+	std::string map_sprite_name;
+
+	//! \name Initial stats and equipment. An equipment id of 0 means nothing is equipped.
+	//@{
+	uint32 experience_level;
+	uint32 experience_points;
+	uint32 max_hit_points;
+	uint32 max_skill_points;
+	uint32 strength;
+	uint32 vigor;
+	uint32 fortitude;
+	uint32 protection;
+	uint32 agility;
+	float evade;
+	uint32 weapon;
+	uint32 head_armor;
+	uint32 torso_armor;
+	uint32 arm_armor;
+	uint32 leg_armor;
+	//@}
+
+	//! \brief The head, torso, arms and legs attack points
+	std::vector<GlobalAttackPointDef> attack_points;
+
+	//! \brief The growth stats, sorted by experience level
+	std::vector<GlobalGrowthStatsDef> growth_stats;
+
+	//! \brief The experience level at which each skill is learned, and the skill id, sorted by experience level
+	std::vector<std::pair<uint32, uint32> > skills;
+}; // class GlobalCharacterDef
+
+
+/** ****************************************************************************
+*** \brief The definition of an enemy, read from dat/actors/enemies.lua
+*** ***************************************************************************/
+class GlobalEnemyDef {
+public:
+	GlobalEnemyDef();
+
+	/** \brief Reads the enemy data
+	*** \param script The enemies script file, with the "enemies" table open
+	*** \param id The id of the enemy to read
+	*** \return False if the data could not be read
+	**/
+	bool Load(hoa_script::ReadScriptDescriptor& script, uint32 id);
+
+	uint32 id;
+	hoa_utils::ustring name;
+
+	//! \name Image files and sprite size
+	//@{
+	std::string battle_sprites;
+	std::string stamina_icon;
+	int32 sprite_width;
+	int32 sprite_height;
+	//@}
+
+	//! \brief True if the base stats must not be randomized when the enemy is initialized
+	bool no_stat_randomization;
+
+	//! \name Base stats
+	//@{
+	uint32 hit_points;
+	uint32 skill_points;
+	uint32 experience_points;
+	uint32 strength;
+	uint32 vigor;
+	uint32 fortitude;
+	uint32 protection;
+	uint32 agility;
+	float evade;
+	uint32 drunes;
+	//@}
+
+	std::vector<GlobalAttackPointDef> attack_points;
+
+	//! \brief The ids of the skills the enemy can use
+	std::vector<uint32> skills;
+
+	//! \brief The ids of the objects the enemy may drop, and the chance for each of them to be dropped
+	std::vector<uint32> dropped_objects;
+	std::vector<float> dropped_chance;
+}; // class GlobalEnemyDef
+
+} // namespace hoa_global
+
+#endif // __GLOBAL_ACTOR_DEFS_HEADER__
@@ -14,6 +14,7 @@
 *** ***************************************************************************/
 
 #include "global_actors.h"
+#include "global.h"
 
 #include "engine/script/script_read.h"
 #include "global_objects.h"
@@ -46,42 +47,14 @@ GlobalAttackPoint::GlobalAttackPoint(GlobalActor* owner) :
 
 
 
-bool GlobalAttackPoint::LoadData(ReadScriptDescriptor& script) {
-	if (script.IsFileOpen() == false) {
-		return false;
-	}
-
-	_name = MakeUnicodeString(script.ReadString("name"));
-	_x_position = script.ReadInt("x_position");
-	_y_position = script.ReadInt("y_position");
-	_fortitude_modifier = script.ReadFloat("fortitude_modifier");
-	_protection_modifier = script.ReadFloat("protection_modifier");
-	_evade_modifier = script.ReadFloat("evade_modifier");
-
-	// Status effect data is optional so check if a status_effect table exists first
-	if (script.DoesTableExist("status_effects") == true) {
-		script.OpenTable("status_effects");
-
-		std::vector<int32> table_keys;
-		script.ReadTableKeys(table_keys);
-		for (uint32 i = 0; i < table_keys.size(); i++) {
-			float probability = script.ReadFloat(table_keys[i]);
-			_status_effects.push_back(make_pair(static_cast<GLOBAL_STATUS>(table_keys[i]), probability));
-		}
-
-		script.CloseTable();
-	}
-
-
-	if (script.IsErrorDetected()) {
-		if (GLOBAL_DEBUG) {
-			PRINT_WARNING << "one or more errors occurred while reading the save game file - they are listed below" << endl;
-			cerr << script.GetErrorMessages() << endl;
-		}
-		return false;
-	}
-
-	return true;
+void GlobalAttackPoint::LoadData(const GlobalAttackPointDef& definition) {
+	_name = definition.name;
+	_x_position = definition.x_position;
+	_y_position = definition.y_position;
+	_fortitude_modifier = definition.fortitude_modifier;
+	_protection_modifier = definition.protection_modifier;
+	_evade_modifier = definition.evade_modifier;
+	_status_effects = definition.status_effects;
 }
 
 
@@ -761,26 +734,9 @@ void GlobalCharacterGrowth::AcknowledgeGrowth() {
 		_experience_level_gained = false;
 		_DetermineNextLevelExperience();
 
-		string filename = "dat/actors/characters.lua";
-		ReadScriptDescriptor character_script;
-		if (character_script.OpenFile(filename) == false) {
-			IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to open character data file: " << filename << endl;
-			return;
-		}
-
-		try {
-			ScriptCallFunction<void>(character_script.GetLuaState(), "DetermineGrowth", _character_owner);
-			_ConstructPeriodicGrowth();
-			_CheckForGrowth();
-		}
-		catch (luabind::error e) {
-			ScriptManager->HandleLuaError(e);
-		}
-		catch (luabind::cast_failed e) {
-			ScriptManager->HandleCastError(e);
-		}
-
-		character_script.CloseFile();
+		_DetermineGrowth();
+		_ConstructPeriodicGrowth();
+		_CheckForGrowth();
 
 		// Add any newly learned skills
 		for (uint32 i = 0; i < _skills_learned.size(); i++) {
@@ -846,6 +802,38 @@ void GlobalCharacterGrowth::_AddSkill(uint32 skill_id) {
 
 
 
+void GlobalCharacterGrowth::_DetermineGrowth() {
+	const GlobalCharacterDef* definition = GlobalManager->GetCharacterDef(_character_owner->GetID());
+	if (definition == NULL) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no definition found for character: " << _character_owner->GetID() << endl;
+		return;
+	}
+
+	uint32 new_level = _character_owner->GetExperienceLevel();
+	const GlobalGrowthStatsDef* growth = definition->GetGrowthStats(new_level);
+	if (growth == NULL) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no growth stats were found for level: " << new_level << endl;
+		return;
+	}
+
+	_hit_points_growth = growth->hit_points;
+	_skill_points_growth = growth->skill_points;
+	_strength_growth = growth->strength;
+	_vigor_growth = growth->vigor;
+	_fortitude_growth = growth->fortitude;
+	_protection_growth = growth->protection;
+	_agility_growth = growth->agility;
+	_evade_growth = 0.0f;
+
+	// Determine if the character learns any skills at this new level
+	for (uint32 i = 0; i < definition->skills.size(); i++) {
+		if (definition->skills[i].first == new_level)
+			_AddSkill(definition->skills[i].second);
+	}
+}
+
+
+
 void GlobalCharacterGrowth::_CheckForGrowth() {
 	// ----- (1): If a new experience level is gained, empty the periodic growth containers into the growth members
 	if (_character_owner->GetExperiencePoints() >= _experience_for_next_level) {
@@ -1084,22 +1072,16 @@ GlobalCharacter::GlobalCharacter(uint32 id, bool initial) :
 	_id = id;
 	_enabled = true;
 
-	// Open the characters script file
-	std::string filename = "dat/actors/characters.lua";
-	ReadScriptDescriptor char_script;
-	if (!char_script.OpenFile(filename)) {
-		PRINT_ERROR << "failed to open character data file: "
-			<< filename << std::endl;
+	const GlobalCharacterDef* definition = GlobalManager->GetCharacterDef(_id);
+	if (definition == NULL) {
+		PRINT_ERROR << "no definition found for character: " << _id << std::endl;
 		return;
 	}
 
-	// Retrieve their basic character property data
-	char_script.OpenTable("characters");
-	char_script.OpenTable(_id);
-	_name = MakeUnicodeString(char_script.ReadString("name"));
+	_name = definition->name;
 
 	// Load all the graphic data
-	std::string portrait_filename = char_script.ReadString("portrait");
+	const std::string& portrait_filename = definition->portrait;
 	if (DoesFileExist(portrait_filename)) {
 		_portrait.Load(portrait_filename);
 	}
@@ -1108,7 +1090,7 @@ GlobalCharacter::GlobalCharacter(uint32 id, bool initial) :
 			<< " for character: " << MakeStandardString(_name) << endl;
 	}
 
-	std::string full_portrait_filename = char_script.ReadString("full_portrait");
+	const std::string& full_portrait_filename = definition->full_portrait;
 	if (DoesFileExist(full_portrait_filename)) {
 		_full_portrait.Load(full_portrait_filename);
 	}
@@ -1117,7 +1099,7 @@ GlobalCharacter::GlobalCharacter(uint32 id, bool initial) :
 			<< " for character: " << MakeStandardString(_name) << endl;
 	}
 
-	std::string stamina_icon_filename = char_script.ReadString("stamina_icon");
+	const std::string& stamina_icon_filename = definition->stamina_icon;
 	bool stamina_icon_loaded = false;
 	if (DoesFileExist(stamina_icon_filename)) {
 		if (_stamina_icon.Load(stamina_icon_filename, 45.0f, 45.0f))
@@ -1140,7 +1122,7 @@ GlobalCharacter::GlobalCharacter(uint32 id, bool initial) :
 	for (uint32 i = 0; i < _battle_portraits.size(); i++) {
 		_battle_portraits[i].SetDimensions(100.0f, 100.0f);
 	}
-    std::string battle_portraits_filename = char_script.ReadString("battle_portraits");
+	const std::string& battle_portraits_filename = definition->battle_portraits;
 	if (battle_portraits_filename.empty() ||
 		!ImageDescriptor::LoadMultiImageFromElementGrid(_battle_portraits,
 														battle_portraits_filename, 1, 5)) {
@@ -1152,73 +1134,44 @@ GlobalCharacter::GlobalCharacter(uint32 id, bool initial) :
 	}
 
 	// Set up the map sprite name (untranslated) used as a string id to later link it with a map sprite.
-	_map_sprite_name = char_script.ReadString("map_sprite_name");
-
-    // Read each battle_animations table keys and store the corresponding animation in memory.
-    std::vector<std::string> keys_vect;
-    char_script.ReadTableKeys("battle_animations", keys_vect);
-    char_script.OpenTable("battle_animations");
-    for (uint32 i = 0; i < keys_vect.size(); ++i) {
-        AnimatedImage animation;
-        animation.LoadFromAnimationScript(char_script.ReadString(keys_vect[i]));
-        _battle_animation[keys_vect[i]] = animation;
-    }
-    char_script.CloseTable();
+	_map_sprite_name = definition->map_sprite_name;
+
+	// Load each battle animation and store it in memory.
+	for (std::map<std::string, std::string>::const_iterator it = definition->battle_animations.begin();
+			it != definition->battle_animations.end(); ++it) {
+		AnimatedImage animation;
+		animation.LoadFromAnimationScript(it->second);
+		_battle_animation[it->first] = animation;
+	}
 
 	// Construct the character from the initial stats if necessary
 	if (initial) {
-		char_script.OpenTable("initial_stats");
-		_experience_level = char_script.ReadUInt("experience_level");
-		_experience_points = char_script.ReadUInt("experience_points");
-		_max_hit_points = char_script.ReadUInt("max_hit_points");
+		_experience_level = definition->experience_level;
+		_experience_points = definition->experience_points;
+		_max_hit_points = definition->max_hit_points;
 		_hit_points = _max_hit_points;
-		_max_skill_points = char_script.ReadUInt("max_skill_points");
+		_max_skill_points = definition->max_skill_points;
 		_skill_points = _max_skill_points;
-		_strength = char_script.ReadUInt("strength");
-		_vigor = char_script.ReadUInt("vigor");
-		_fortitude = char_script.ReadUInt("fortitude");
-		_protection = char_script.ReadUInt("protection");
-		_agility = char_script.ReadUInt("agility");
-		_evade = char_script.ReadFloat("evade");
+		_strength = definition->strength;
+		_vigor = definition->vigor;
+		_fortitude = definition->fortitude;
+		_protection = definition->protection;
+		_agility = definition->agility;
+		_evade = definition->evade;
 
 		// Add the character's initial equipment. If any equipment ids are zero, that indicates nothing is to be equipped.
-		uint32 equipment_id = 0;
-		equipment_id = char_script.ReadUInt("weapon");
-		if (equipment_id != 0)
-			_weapon_equipped = new GlobalWeapon(equipment_id);
+		if (definition->weapon != 0)
+			_weapon_equipped = new GlobalWeapon(definition->weapon);
 		else
 			_weapon_equipped = NULL;
 
-		equipment_id = char_script.ReadUInt("head_armor");
-		if (equipment_id != 0)
-			_armor_equipped.push_back(new GlobalArmor(equipment_id));
-		else
-			_armor_equipped.push_back(NULL);
-
-		equipment_id = char_script.ReadUInt("torso_armor");
-		if (equipment_id != 0)
-			_armor_equipped.push_back(new GlobalArmor(equipment_id));
-		else
-			_armor_equipped.push_back(NULL);
-
-		equipment_id = char_script.ReadUInt("arm_armor");
-		if (equipment_id != 0)
-			_armor_equipped.push_back(new GlobalArmor(equipment_id));
-		else
-			_armor_equipped.push_back(NULL);
-
-		equipment_id = char_script.ReadUInt("leg_armor");
-		if (equipment_id != 0)
-			_armor_equipped.push_back(new GlobalArmor(equipment_id));
-		else
-			_armor_equipped.push_back(NULL);
-
-		char_script.CloseTable();
-		if (char_script.IsErrorDetected()) {
-			if (GLOBAL_DEBUG) {
-				PRINT_WARNING << "one or more errors occurred while reading initial data - they are listed below" << endl;
-				cerr << char_script.GetErrorMessages() << endl;
-			}
+		const uint32 armor_ids[] = { definition->head_armor, definition->torso_armor,
+			definition->arm_armor, definition->leg_armor };
+		for (uint32 i = 0; i < 4; i++) {
+			if (armor_ids[i] != 0)
+				_armor_equipped.push_back(new GlobalArmor(armor_ids[i]));
+			else
+				_armor_equipped.push_back(NULL);
 		}
 	} // if (initial == true)
 	else {
@@ -1227,57 +1180,21 @@ GlobalCharacter::GlobalCharacter(uint32 id, bool initial) :
 	}
 
 	// Setup the character's attack points
-	char_script.OpenTable("attack_points");
-	for (uint32 i = GLOBAL_POSITION_HEAD; i <= GLOBAL_POSITION_LEGS; i++) {
+	for (uint32 i = 0; i < definition->attack_points.size(); i++) {
 		_attack_points.push_back(new GlobalAttackPoint(this));
-		char_script.OpenTable(i);
-		if (_attack_points[i]->LoadData(char_script) == false) {
-			IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to succesfully load data for attack point: " << i << endl;
-		}
-		char_script.CloseTable();
-	}
-	char_script.CloseTable();
-
-	if (char_script.IsErrorDetected()) {
-		if (GLOBAL_DEBUG) {
-			PRINT_WARNING << "one or more errors occurred while reading attack point data - they are listed below" << endl;
-			cerr << char_script.GetErrorMessages() << endl;
-		}
+		_attack_points[i]->LoadData(definition->attack_points[i]);
 	}
 
 	// Construct the character's initial skill set if necessary
 	if (initial) {
-		// The skills table contains key/value pairs. The key indicate the level required to learn the skill and the value is the skill's id
-		vector<uint32> skill_levels;
-		char_script.OpenTable("skills");
-		char_script.ReadTableKeys(skill_levels);
-
-		// We want to add the skills beginning with the first learned to the last. ReadTableKeys does not guarantee returing the keys in a sorted order,
-		// so sort the skills by level before checking each one.
-		sort(skill_levels.begin(), skill_levels.end());
-
-		// Only add the skills for which the experience level requirements are met
-		for (uint32 i = 0; i < skill_levels.size(); i++) {
-			if (skill_levels[i] <= _experience_level) {
-				AddSkill(char_script.ReadUInt(skill_levels[i]));
-			}
-			// Because skill_levels is sorted, all remaining skills will not have their level requirements met
-			else {
+		// The skills are sorted by level, so all the skills following the first one
+		// with an unmet level requirement will not have their requirements met either
+		for (uint32 i = 0; i < definition->skills.size(); i++) {
+			if (definition->skills[i].first > _experience_level)
 				break;
-			}
-		}
-
-		char_script.CloseTable();
-		if (char_script.IsErrorDetected()) {
-			if (GLOBAL_DEBUG) {
-				PRINT_WARNING << "one or more errors occurred while reading skill data - they are listed below" << endl;
-				cerr << char_script.GetErrorMessages() << endl;
-			}
+			AddSkill(definition->skills[i].second);
 		}
-	} // if (initial)
-
-	char_script.CloseTable(); // "characters[id]"
-	char_script.CloseTable(); // "characters"
+	}
 
 	// Determine the character's initial growth if necessary
 	if (initial) {
@@ -1285,26 +1202,9 @@ GlobalCharacter::GlobalCharacter(uint32 id, bool initial) :
 		_growth._experience_for_last_level = _experience_points;
 		_growth._experience_for_next_level = _experience_points;
 		_growth._DetermineNextLevelExperience();
-		try {
-			ScriptCallFunction<void>(char_script.GetLuaState(), "DetermineGrowth", this);
-			_growth._ConstructPeriodicGrowth();
-		}
-		catch (luabind::error e) {
-			ScriptManager->HandleLuaError(e);
-		}
-		catch (luabind::cast_failed e) {
-			ScriptManager->HandleCastError(e);
-		}
-	}
-
-	// Close the script file and calculate all rating totals
-	if (char_script.IsErrorDetected()) {
-		if (GLOBAL_DEBUG) {
-			PRINT_WARNING << "one or more errors occurred while reading final data - they are listed below" << endl;
-			cerr << char_script.GetErrorMessages() << endl;
-		}
+		_growth._DetermineGrowth();
+		_growth._ConstructPeriodicGrowth();
 	}
-	char_script.CloseFile();
 
 	_CalculateAttackRatings();
 	_CalculateDefenseRatings();
@@ -1373,35 +1273,24 @@ GlobalEnemy::GlobalEnemy(uint32 id) :
 {
 	_id = id;
 
-	// Use the id member to determine the name of the data file that the enemy is defined in
-	string file_ext;
-	string filename;
-
-	if (_id == 0)
+	const GlobalEnemyDef* definition = GlobalManager->GetEnemyDef(_id);
+	if (definition == NULL) {
 		PRINT_ERROR << "invalid id for loading enemy data: " << _id << endl;
-
-	// Open the script file and table that store the enemy data
-	ReadScriptDescriptor enemy_data;
-	if (!enemy_data.OpenFile("dat/actors/enemies.lua")) {
-		PRINT_ERROR << "failed to open enemy data file: " << filename << endl;
 		return;
 	}
 
-	enemy_data.OpenTable("enemies");
-	enemy_data.OpenTable(_id);
-
 	// Load the enemy's name and sprite data
-	_name = MakeUnicodeString(enemy_data.ReadString("name"));
-	_sprite_width = enemy_data.ReadInt("sprite_width");
-	_sprite_height = enemy_data.ReadInt("sprite_height");
+	_name = definition->name;
+	_sprite_width = definition->sprite_width;
+	_sprite_height = definition->sprite_height;
 
 	// Attempt to load the MultiImage for the sprite's frames, which should contain one row and four columns of images
 	_battle_sprite_frames.assign(4, StillImage());
-	string sprite_filename = enemy_data.ReadString("battle_sprites");
+	const string& sprite_filename = definition->battle_sprites;
 	if (!ImageDescriptor::LoadMultiImageFromElementGrid(_battle_sprite_frames, sprite_filename, 1, 4))
 		IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to load sprite frames for enemy: " << sprite_filename << endl;
 
-	std::string stamina_icon_filename = enemy_data.ReadString("stamina_icon");
+	const std::string& stamina_icon_filename = definition->stamina_icon;
 	if (DoesFileExist(stamina_icon_filename)) {
 		_stamina_icon.Load(stamina_icon_filename, 45.0f, 45.0f);
 	}
@@ -1412,66 +1301,30 @@ GlobalEnemy::GlobalEnemy(uint32 id) :
 	}
 
 	// Load the enemy's base stats
-	if (enemy_data.DoesBoolExist("no_stat_randomization") == true) {
-		_no_stat_randomization = enemy_data.ReadBool("no_stat_randomization");
-	}
-
-	enemy_data.OpenTable("base_stats");
-	_max_hit_points = enemy_data.ReadUInt("hit_points");
+	_no_stat_randomization = definition->no_stat_randomization;
+	_max_hit_points = definition->hit_points;
 	_hit_points = _max_hit_points;
-	_max_skill_points = enemy_data.ReadUInt("skill_points");
+	_max_skill_points = definition->skill_points;
 	_skill_points = _max_skill_points;
-	_experience_points = enemy_data.ReadUInt("experience_points");
-	_strength = enemy_data.ReadUInt("strength");
-	_vigor = enemy_data.ReadUInt("vigor");
-	_fortitude = enemy_data.ReadUInt("fortitude");
-	_protection = enemy_data.ReadUInt("protection");
-	_agility = enemy_data.ReadUInt("agility");
-	_evade = enemy_data.ReadFloat("evade");
-	_drunes_dropped = enemy_data.ReadUInt("drunes");
-	enemy_data.CloseTable();
+	_experience_points = definition->experience_points;
+	_strength = definition->strength;
+	_vigor = definition->vigor;
+	_fortitude = definition->fortitude;
+	_protection = definition->protection;
+	_agility = definition->agility;
+	_evade = definition->evade;
+	_drunes_dropped = definition->drunes;
 
 	// Create the attack points for the enemy
-	enemy_data.OpenTable("attack_points");
-	uint32 ap_size = enemy_data.GetTableSize();
-	for (uint32 i = 1; i <= ap_size; i++) {
+	for (uint32 i = 0; i < definition->attack_points.size(); i++) {
 		_attack_points.push_back(new GlobalAttackPoint(this));
-		enemy_data.OpenTable(i);
-		if (_attack_points.back()->LoadData(enemy_data) == false) {
-			IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to load data for an attack point: " << i << endl;
-		}
-		enemy_data.CloseTable();
-	}
-	enemy_data.CloseTable();
-
-	// Add the set of skills for the enemy
-	enemy_data.OpenTable("skills");
-	for (uint32 i = 1; i <= enemy_data.GetTableSize(); i++) {
-		_skill_set.push_back(enemy_data.ReadUInt(i));
-	}
-	enemy_data.CloseTable();
-
-	// Load the possible items that the enemy may drop
-	enemy_data.OpenTable("drop_objects");
-	for (uint32 i = 1; i <= enemy_data.GetTableSize(); i++) {
-		enemy_data.OpenTable(i);
-		_dropped_objects.push_back(enemy_data.ReadUInt(1));
-		_dropped_chance.push_back(enemy_data.ReadFloat(2));
-		enemy_data.CloseTable();
-	}
-	enemy_data.CloseTable();
-
-	enemy_data.CloseTable(); // enemies[_id]
-	enemy_data.CloseTable(); // enemies
-
-	if (enemy_data.IsErrorDetected()) {
-		if (GLOBAL_DEBUG) {
-			PRINT_WARNING << "one or more errors occurred while reading the enemy data - they are listed below" << endl;
-			cerr << enemy_data.GetErrorMessages() << endl;
-		}
+		_attack_points.back()->LoadData(definition->attack_points[i]);
 	}
 
-	enemy_data.CloseFile();
+	// Add the set of skills and the possible items that the enemy may drop
+	_skill_set = definition->skills;
+	_dropped_objects = definition->dropped_objects;
+	_dropped_chance = definition->dropped_chance;
 
 	_CalculateAttackRatings();
 	_CalculateDefenseRatings();
@@ -24,6 +24,7 @@
 #define __GLOBAL_ACTORS_HEADER__
 
 #include "global_utils.h"
+#include "global_actor_defs.h"
 
 #include "engine/video/image.h"
 
@@ -68,17 +69,10 @@ public:
 	~GlobalAttackPoint()
 		{ _actor_owner = NULL; }
 
-	/** \brief Reads in the attack point's data from a script file
-	*** \param script A reference to the open script file where to retrieve the data from
-	*** \return True upon success, false upon failure.
-	***
-	*** There are two requirements for using this function. First, the script file must already
-	*** be opened for reading permissions. Second, the table which contains the attack point data
-	*** must be opened <b>prior</b> to making this function call. This function will not close the
-	*** table containing the attack point when it finishes loading the data, so the calling routine
-	*** must remember to close the table after this call is made.
+	/** \brief Copies the attack point's data from its definition
+	*** \param definition The attack point definition, as read from the actor data files
 	**/
-	bool LoadData(hoa_script::ReadScriptDescriptor& script);
+	void LoadData(const GlobalAttackPointDef& definition);
 
 	/** \brief Determines the total physical and metaphysical defense of the attack point
 	*** \param equipped_armor A pointer to the armor equipped on the attack point, or NULL if no armor is equipped
@@ -621,8 +615,7 @@ protected:
 *** character growth that occured after the character reached a new level.
 ***
 *** \todo This entire class' operation and its interaction with the GlobalCharacter
-*** class needs to be examined and improved where needed. Also examine the use of
-*** the DetermineGrowth() function in the Lua file dat/actors/characters.lua
+*** class needs to be examined and improved where needed.
 *** ***************************************************************************/
 class GlobalCharacterGrowth {
 	friend class GameGlobal;
@@ -635,8 +628,8 @@ public:
 	~GlobalCharacterGrowth();
 
 	/** \brief Processes any growth that has occured by modifier the character's stats
-	*** If an experience level is gained, this function will open up the script file that contains
-	*** the character's definition and get new growth stats for the next experience level.
+	*** If an experience level is gained, this function gets the new growth stats for the next
+	*** experience level from the character's definition.
 	**/
 	void AcknowledgeGrowth();
 
@@ -697,9 +690,7 @@ private:
 	*** has enough experience points to meet a growth requirement. They are all cleared to zero after
 	*** a call to AcknowledgeGrowth()
 	***
-	*** \note These members are given read/write access in Lua so that Lua may use them to hold new
-	*** growth amounts when a character reaches a new level. Refer to the function DetermineGrowth(character)
-	*** defined in dat/actors/characters.lua
+	*** \note These members are set by _DetermineGrowth() when a character reaches a new level.
 	**/
 	//@{
 	uint32 _hit_points_growth;
@@ -743,10 +734,15 @@ private:
 
 	/** \brief Adds a new skill for the character to learn at the next experience level gained
 	*** \param skill_id The ID number of the skill to add
-	*** \note This function is bound to and invoked by Lua to add all of the skills to be learned
 	**/
 	void _AddSkill(uint32 skill_id);
 
+	/** \brief Sets the growth members and the skills to learn for the character's new experience level
+	*** The growth stats and skills are taken from the character's definition. This function should be
+	*** followed by a call to _ConstructPeriodicGrowth().
+	**/
+	void _DetermineGrowth();
+
 	/** \brief Examines if any growth has occured as a result of the character's experience points
 	*** This is called by GlobalCharacter whenever the character's experience points change. If any growth is
 	*** detected, the _growth_detected member is set and the various growth members of the class are incremented
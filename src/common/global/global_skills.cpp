@@ -94,6 +94,9 @@ GlobalSkill::GlobalSkill(uint32 id) :
 		skill_script->CloseTable(); // animation_scripts table
 	}
 
+	if (skill_script->DoesTableExist("sounds"))
+		skill_script->ReadStringVector("sounds", _sound_filenames);
+
 	skill_script->CloseTable(); // id.
 
 	if (skill_script->IsErrorDetected()) {
@@ -118,6 +121,7 @@ GlobalSkill::GlobalSkill(const GlobalSkill& copy) {
 	_battle_execute_function = copy._battle_execute_function;
 	_field_execute_function = copy._field_execute_function;
 	_animation_scripts = copy._animation_scripts;
+	_sound_filenames = copy._sound_filenames;
 }
 
 
@@ -140,6 +144,7 @@ GlobalSkill& GlobalSkill::operator=(const GlobalSkill& copy) {
 	_battle_execute_function = copy._battle_execute_function;
 	_field_execute_function = copy._field_execute_function;
 	_animation_scripts = copy._animation_scripts;
+	_sound_filenames = copy._sound_filenames;
 
 	return *this;
 }
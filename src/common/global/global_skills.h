@@ -123,6 +123,10 @@ public:
 	*** Or an empty value otherwise;
 	**/
 	std::string GetAnimationScript(uint32 character_id);
+
+	//! \brief Returns the sounds played by the skill functions, which are loaded before a battle starts
+	const std::vector<std::string>& GetSoundFilenames() const
+	{ return _sound_filenames; }
 	//@}
 
 private:
@@ -179,6 +183,9 @@ private:
 
 	//! \brief map containing the animation scripts names linked to each characters id for the given skill.
 	std::map <uint32, std::string> _animation_scripts;
+
+	//! \brief The sounds played by the skill functions
+	std::vector<std::string> _sound_filenames;
 }; // class GlobalSkill
 
 } // namespace hoa_global
@@ -1170,7 +1170,7 @@ void OptionBox::_DrawOption(const Option& op, const OptionCellBounds &bounds, fl
 
 				if (text_index >= 0 && text_index < static_cast<int32>(op.text.size())) {
 					const ustring& text = op.text[text_index];
-					float width = static_cast<float>(VideoManager->Text()->CalculateTextWidth(_text_style.font, text));
+					float width = static_cast<float>(VideoManager->Text()->CalculateTextWidth(_text_style, text));
 					float edge = x - bounds.x_left; // edge value for VIDEO_X_LEFT
 
 					if (xalign == VIDEO_X_CENTER)
@@ -365,7 +365,7 @@ void TextBox::_AddLine(const ustring& line) {
 	ustring temp_line = line;
 
 	while (temp_line.empty() == false) {
-		int32 text_width = TextManager->CalculateTextWidth(_text_style.font, line);
+		int32 text_width = TextManager->CalculateTextWidth(_text_style.font, temp_line);
 
 		// If the text can fit in the text box, add the whole line and return
 		if (text_width < _width) {
@@ -376,16 +376,17 @@ void TextBox::_AddLine(const ustring& line) {
 
 		// Otherwise, find the maximum number of words which can fit and make that substring a line
 		// Word boundaries are found by calling the _IsCharacterBreakable() method
-		ustring wrapped_line;
+		// The widths of the first characters are measured on the cached layout of the line
 		int32 num_wrapped_chars = 0;
+		int32 wrapped_length = 0;
 		int32 last_breakable_index = -1;
 		int32 line_length = static_cast<int32>(temp_line.length());
 
 		while (num_wrapped_chars < line_length) {
-			wrapped_line += temp_line[num_wrapped_chars];
+			wrapped_length = num_wrapped_chars + 1;
 
 			if (_IsBreakableChar(temp_line[num_wrapped_chars])) {
-				int32 text_width = TextManager->CalculateTextWidth(_text_style.font, wrapped_line);
+				int32 text_width = TextManager->CalculateTextWidth(_text_style.font, temp_line, wrapped_length);
 
 				if (text_width < _width) {
 					// We haven't gone past the breaking point: mark this as a possible breaking point
@@ -404,11 +405,11 @@ void TextBox::_AddLine(const ustring& line) {
 		} // while (num_wrapped_chars < line_length)
 
 		// Figure out the number of characters in the wrapped line and construct the wrapped line
-		text_width = TextManager->CalculateTextWidth(_text_style.font, wrapped_line);
+		text_width = TextManager->CalculateTextWidth(_text_style.font, temp_line, wrapped_length);
 		if (text_width >= _width && last_breakable_index != -1) {
 			num_wrapped_chars = last_breakable_index;
 		}
-		wrapped_line = temp_line.substr(0, num_wrapped_chars);
+		ustring wrapped_line = temp_line.substr(0, num_wrapped_chars);
 
 		// Add the new wrapped line to the text.
 		_text.push_back(wrapped_line);
@@ -452,7 +453,7 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 	// Iterate through the loop for every line of text and draw it
 	for (int32 line = 0; line < static_cast<int32>(_text.size()); ++line) {
 		// (1): Calculate the x draw offset for this line and move to that position
-		float line_width = static_cast<float>(TextManager->CalculateTextWidth(_text_style.font, _text[line]));
+		float line_width = static_cast<float>(TextManager->CalculateTextWidth(_text_style, _text[line]));
 		int32 x_align = VideoManager->_ConvertXAlign(_text_xalign);
 		float x_offset = text_x + ((x_align + 1) * line_width) * 0.5f * VideoManager->_current_context.coordinate_system.GetHorizontalDirection();
 
@@ -477,8 +478,7 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 			else {
 				int32 num_completed_chars = cur_char - num_chars_drawn;
 				if (num_completed_chars > 0) {
-					ustring substring = _text[line].substr(0, num_completed_chars);
-					TextManager->Draw(substring);
+					TextManager->Draw(_text[line], _text_style, 0, num_completed_chars);
 				}
 			}
 		} // else if (_mode == VIDEO_TEXT_CHAR)
@@ -499,20 +499,16 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 
 				// Continue only if this line has at least one character that should be drawn
 				if (num_completed_chars >= 0) {
-					ustring substring;
-
 					// Draw any fully completed characters at full opacity
 					if (num_completed_chars > 0) {
-						substring = _text[line].substr(0, num_completed_chars);
-						TextManager->Draw(substring, _text_style);
+						TextManager->Draw(_text[line], _text_style, 0, num_completed_chars);
 					}
 
 					// Draw the current character that is being faded in at the appropriate alpha level
 					Color old_color = _text_style.color;
 					_text_style.color[3] *= cur_percent;
 
-					VideoManager->MoveRelative(static_cast<float>(TextManager->CalculateTextWidth(_text_style.font, substring)), 0.0f);
-					TextManager->Draw(_text[line].substr(num_completed_chars, 1), _text_style);
+					TextManager->Draw(_text[line], _text_style, num_completed_chars, 1);
 					_text_style.color = old_color;
 				}
 			}
@@ -551,21 +547,18 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 			}
 			// If the line contains the current character, draw all previous characters as well as the current one
 			else if (num_completed_chars >= 0) {
-				ustring substring;
-
 				// If there are already completed characters on this line, draw them in full
 				if (num_completed_chars > 0) {
-					substring = _text[line].substr(0, num_completed_chars);
-					TextManager->Draw(substring, _text_style);
+					TextManager->Draw(_text[line], _text_style, 0, num_completed_chars);
 				}
 
 				// Now draw the current character from the line, partially scissored according to the amount that is complete
-				ustring cur_char_string = _text[line].substr(num_completed_chars, 1);
+				int32 completed_width = TextManager->CalculateTextWidth(_text_style.font, _text[line], num_completed_chars);
 
 				// Create a rectangle for the current character, in window coordinates
 				int32 char_x, char_y, char_w, char_h;
 				char_x = static_cast<int32>(x_offset + VideoManager->_current_context.coordinate_system.GetHorizontalDirection()
-					* TextManager->CalculateTextWidth(_text_style.font, substring));
+					* completed_width);
 				char_y = static_cast<int32>(text_y - VideoManager->_current_context.coordinate_system.GetVerticalDirection()
 					* (_font_properties->height + _font_properties->descent));
 
@@ -575,13 +568,11 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 				if (VideoManager->_current_context.coordinate_system.GetVerticalDirection() < 0.0f)
 					char_x = static_cast<int32>(VideoManager->_current_context.coordinate_system.GetLeft()) - char_x;
 
-				char_w = TextManager->CalculateTextWidth(_text_style.font, cur_char_string);
+				char_w = TextManager->CalculateTextWidth(_text_style.font, _text[line], num_completed_chars + 1) - completed_width;
 				char_h = _font_properties->height;
 
 				// Multiply the width by percentage done to determine the scissoring dimensions
 				char_w = static_cast<int32>(cur_percent * char_w);
-				VideoManager->MoveRelative(VideoManager->_current_context.coordinate_system.GetHorizontalDirection()
-					* TextManager->CalculateTextWidth(_text_style.font, substring), 0.0f);
 
 				// Construct the scissor rectangle using the character dimensions and draw the revealing character
 				VideoManager->PushState();
@@ -589,7 +580,7 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 				scissor_rect.Intersect(char_scissor_rect);
 				VideoManager->EnableScissoring();
 				VideoManager->SetScissorRect(scissor_rect);
-				TextManager->Draw(cur_char_string, _text_style);
+				TextManager->Draw(_text[line], _text_style, num_completed_chars, 1);
 				VideoManager->PopState();
 			}
 			// In the else case, the current character is before the line, so we don't draw anything for this line at all
@@ -48,6 +48,7 @@ namespace hoa_audio {
 	class SoundDescriptor;
 
 	namespace private_audio {
+		class AudioCache;
 		class AudioCacheElement;
 
 		class AudioBuffer;
@@ -81,6 +82,7 @@ namespace hoa_video {
 	class StillImage;
 	class AnimatedImage;
 	class CompositeImage;
+	class StaticImageBatch;
 
 	class TextureController;
 
@@ -111,6 +113,9 @@ namespace hoa_video {
 
 		class ScreenFader;
 		class ShakeForce;
+
+		class SpriteBatch;
+		class Transform2D;
 	}
 }
 
@@ -140,7 +145,8 @@ namespace hoa_mode_manager {
 	class ParticleManager;
 	class ParticleSystem;
 	class ParticleSystemDef;
-	class Particle;
+	class ParticleArrays;
+	class ParticleRandom;
 	class ParticleVertex;
 	class ParticleTexCoord;
 	class ParticleKeyframe;
@@ -278,16 +284,25 @@ namespace hoa_boot {
 namespace hoa_map {
 	extern bool MAP_DEBUG;
 	class MapMode;
+	class MapLoadingMode;
 
 	namespace private_map {
 		class TileSupervisor;
 		class MapTile;
+		class TileContext;
+		class CompiledMap;
 
 		class MapRectangle;
 		class MapFrame;
 		class PathNode;
+		class PathFootprint;
+		class PathCorridor;
+		class PathGraph;
+		class PathFinder;
 
 		class ObjectSupervisor;
+		class ObjectGrid;
+		class CollisionGrid;
 		class MapObject;
 		class PhysicalObject;
 		class TreasureObject;
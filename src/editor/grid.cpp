@@ -20,6 +20,8 @@
 #include "engine/script/script_write.h"
 #include "engine/script/script_read.h"
 
+#include "modes/map/map_compiled.h"
+
 #include <QScrollBar>
 
 #include <sstream>
@@ -601,11 +603,13 @@ void Grid::SaveMap()
 	write_data.WriteComment("The names of the tilesets used, with the path and file extension omitted");
 	write_data.BeginTable("tileset_filenames");
 	uint32 i = 0;
+	std::vector<std::string> tileset_filenames;
 	for (QStringList::Iterator qit = tileset_names.begin();
 	     qit != tileset_names.end(); ++qit)
 	{
 		++i;
 		write_data.WriteString(i, (*qit).ascii());
+		tileset_filenames.push_back((*qit).ascii());
 	} // iterate through tileset_names writing each element
 	write_data.EndTable();
 	write_data.InsertNewLine();
@@ -614,6 +618,13 @@ void Grid::SaveMap()
 	write_data.WriteComment("Walkability status of tiles for 32 contexts. Zero indicates walkable for all contexts. Valid range: [0:2^32-1]");
 	write_data.WriteComment("Example: 1 (BIN 001) = wall for first context only, 2 (BIN 010) means wall for second context only, 5 (BIN 101) means Wall for first and third context.");
 	write_data.BeginTable("map_grid");
+
+	// The tile and collision data are compiled along, so that the game doesn't have to read them from Lua
+	uint32 layers_num = _tile_contexts[0].layers.size();
+	CompiledMap map_data;
+	map_data.Reset(_width, _height, _tile_contexts.size(), layers_num);
+	map_data.SetTilesetFilenames(tileset_filenames);
+
 	//[layer][walkability]
 	std::vector<std::vector<int32> > walk_vect;
 	// Used to save the northern walkability info of tiles in all layers of
@@ -720,6 +731,10 @@ void Grid::SaveMap()
 
 		write_data.WriteIntVector(y * 2,   map_row_north);
 		write_data.WriteIntVector(y * 2 + 1, map_row_south);
+		for (uint32 x = 0; x < _width * 2; ++x) {
+			map_data.SetCollision(x, y * 2, map_row_north[x]);
+			map_data.SetCollision(x, y * 2 + 1, map_row_south[x]);
+		}
 		map_row_north.assign(_width * 2, 0);
 		map_row_south.assign(_width * 2, 0);
 	} // iterate through the rows (y axis) of the layers
@@ -729,13 +744,13 @@ void Grid::SaveMap()
 	write_data.WriteComment("The tile layers. The numbers are indeces to the tile_mappings table.");
 	write_data.BeginTable("layers");
 
-	uint32 layers_num = _tile_contexts[0].layers.size();
 	for (uint32 layer_id = 0; layer_id < layers_num; ++layer_id) {
 
 		write_data.BeginTable(layer_id);
 
 		write_data.WriteString("type", getTypeFromLayer(_tile_contexts[0].layers[layer_id].layer_type));
 		write_data.WriteString("name", _tile_contexts[0].layers[layer_id].name);
+		map_data.SetLayerType(layer_id, _tile_contexts[0].layers[layer_id].layer_type);
 
 		std::vector<int32> layer_row;
 
@@ -744,6 +759,7 @@ void Grid::SaveMap()
 			for (uint32 x = 0; x < _width; x++)
 			{
 				layer_row.push_back(_tile_contexts[0].layers[layer_id].tiles[y][x]);
+				map_data.SetTile(0, layer_id, x, y, _tile_contexts[0].layers[layer_id].tiles[y][x]);
 			} // iterate through the columns of the lower layer
 			write_data.WriteIntVector(y, layer_row);
 			layer_row.clear();
@@ -770,6 +786,7 @@ void Grid::SaveMap()
 				for (uint32 x = 0; x < _width; ++x)
 				{
 					int32 ctxt_tile_id = _tile_contexts[context_id].layers[layer_id].tiles[y][x];
+					map_data.SetTile(context_id, layer_id, x, y, ctxt_tile_id);
 					// Record when :
 					// - A different tile exists when inheriting of the parent context
 					if (context_inherit > -1 && context_inherit < (int32)context_id) {
@@ -816,6 +833,11 @@ void Grid::SaveMap()
 
 	write_data.CloseFile();
 
+	// The compiled file records the checksum of the map file, so it is written once the map file is complete
+	std::string map_filename = string(_file_name.toAscii());
+	if (map_data.Write(GetCompiledMapFilename(map_filename), map_filename) == false)
+		QMessageBox::warning(this, "Saving File...", QString("ERROR: could not write the compiled map file of %1!").arg(_file_name));
+
 	_changed = false;
 } // Grid::SaveMap()
 
@@ -1201,6 +1223,9 @@ void Grid::paintGL()
 
 	if (_debug_textures_on)
 		VideoManager->Textures()->DEBUG_ShowTexSheet();
+
+	// Submit the queued tiles before Qt swaps the buffers
+	VideoManager->FlushBatch();
 } // void Grid::paintGL()
 
 
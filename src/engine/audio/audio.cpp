@@ -46,7 +46,16 @@ AudioEngine::AudioEngine () :
 	_context(0),
 	_max_sources(MAX_DEFAULT_AUDIO_SOURCES),
 	_active_music(NULL),
-	_max_cache_size(MAX_DEFAULT_AUDIO_SOURCES / 4)
+	_streaming_thread(NULL),
+	_streaming_semaphore(NULL),
+	_streaming_thread_running(false),
+	_streaming_buffer_count(NUMBER_STREAMING_BUFFERS),
+	_streaming_buffer_size(DEFAULT_BUFFER_SIZE),
+	_streaming_decoded_buffer_count(NUMBER_DECODED_BUFFERS),
+	_streaming_underrun_count(0),
+	_loading_thread(NULL),
+	_loading_semaphore(NULL),
+	_loading_thread_running(false)
 {}
 
 bool AudioEngine::SingletonInitialize() {
@@ -131,7 +140,6 @@ bool AudioEngine::SingletonInitialize() {
 		alGenSources(1, &source);
 		if (CheckALError() == true) {
 			_max_sources = i;
-			_max_cache_size = i / 4;
 			break;
 		}
 		_audio_sources.push_back(new private_audio::AudioSource(source));
@@ -142,6 +150,36 @@ bool AudioEngine::SingletonInitialize() {
 		return false;
 	}
 
+	// Start decoding the streamed audio in the background. When the thread can't be created,
+	// the audio is decoded by Update() instead.
+	_streaming_semaphore = SystemManager->CreateSemaphore(1);
+#if (THREAD_TYPE == SDL_THREADS)
+	if (_streaming_semaphore != NULL) {
+		_streaming_thread_running = true;
+		_streaming_thread = SystemManager->SpawnThread(&AudioEngine::_StreamingThread, this);
+		if (_streaming_thread == NULL) {
+			IF_PRINT_WARNING(AUDIO_DEBUG) << "could not create the audio streaming thread, "
+				"streamed audio will be decoded by the main thread" << endl;
+			_streaming_thread_running = false;
+		}
+	}
+#endif
+
+	// Decode the sounds loaded in the background on their own thread, so that a long sound
+	// doesn't starve the streams. When the thread can't be created, Update() decodes them.
+	_loading_semaphore = SystemManager->CreateSemaphore(1);
+#if (THREAD_TYPE == SDL_THREADS)
+	if (_loading_semaphore != NULL) {
+		_loading_thread_running = true;
+		_loading_thread = SystemManager->SpawnThread(&AudioEngine::_LoadingThread, this);
+		if (_loading_thread == NULL) {
+			IF_PRINT_WARNING(AUDIO_DEBUG) << "could not create the audio loading thread, "
+				"sounds will be loaded by the main thread" << endl;
+			_loading_thread_running = false;
+		}
+	}
+#endif
+
 	return true;
 } // bool AudioEngine::SingletonInitialize()
 
@@ -149,11 +187,28 @@ AudioEngine::~AudioEngine() {
 	if (!AUDIO_ENABLE)
 		return;
 
-	// Delete all entries in the sound cache
-	for (map<std::string, private_audio::AudioCacheElement>::iterator i = _audio_cache.begin(); i != _audio_cache.end(); i++) {
-		delete i->second.audio;
+	// Stop the streaming thread before the audio it decodes gets deleted
+	if (_streaming_thread != NULL) {
+		_streaming_thread_running = false;
+		SystemManager->WaitForThread(_streaming_thread);
+		_streaming_thread = NULL;
+	}
+
+	// Likewise, stop the loading thread before deleting the sounds it decodes
+	if (_loading_thread != NULL) {
+		_loading_thread_running = false;
+		SystemManager->WaitForThread(_loading_thread);
+		_loading_thread = NULL;
+	}
+
+	for (list<AudioLoadRequest*>::iterator i = _audio_loads.begin(); i != _audio_loads.end(); ++i) {
+		delete (*i)->audio;
+		delete *i;
 	}
-	_audio_cache.clear();
+	_audio_loads.clear();
+
+	// Delete all entries in the sound cache
+	_audio_cache.Clear();
 
 	// Delete all audio sources
 	for (vector<AudioSource*>::iterator i = _audio_sources.begin(); i != _audio_sources.end(); i++) {
@@ -171,6 +226,16 @@ AudioEngine::~AudioEngine() {
 			"registered when destructor was invoked" << std::endl;
 	}
 
+	if (_streaming_semaphore != NULL) {
+		SystemManager->DestroySemaphore(_streaming_semaphore);
+		_streaming_semaphore = NULL;
+	}
+
+	if (_loading_semaphore != NULL) {
+		SystemManager->DestroySemaphore(_loading_semaphore);
+		_loading_semaphore = NULL;
+	}
+
 	alcMakeContextCurrent(0);
 	alcDestroyContext(_context);
 	alcCloseDevice(_device);
@@ -180,6 +245,14 @@ void AudioEngine::Update() {
 	if (!AUDIO_ENABLE)
 		return;
 
+	_FinishAudioLoads();
+
+	// Without a streaming thread, the streamed audio is decoded here
+	if (_streaming_thread == NULL) {
+		for (list<AudioDescriptor*>::iterator i = _streamed_audio.begin(); i != _streamed_audio.end(); ++i)
+			(*i)->_DecodeStream();
+	}
+
 	for (vector<AudioSource*>::iterator i = _audio_sources.begin(); i != _audio_sources.end(); i++) {
 		if ((*i)->owner) {
 			(*i)->owner->_Update();
@@ -187,6 +260,31 @@ void AudioEngine::Update() {
 	}
 }
 
+void AudioEngine::SetStreamingBufferCount(uint32 count) {
+	// OpenAL needs a buffer to play while the other one is refilled
+	if (count < 2) {
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "tried to use less than 2 streaming buffers: " << count << endl;
+		count = 2;
+	}
+	_streaming_buffer_count = count;
+}
+
+void AudioEngine::SetStreamingBufferSize(uint32 size) {
+	if (size == 0) {
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "tried to set an empty streaming buffer size" << endl;
+		return;
+	}
+	_streaming_buffer_size = size;
+}
+
+void AudioEngine::SetStreamingDecodedBufferCount(uint32 count) {
+	if (count == 0) {
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "tried to decode no streaming buffer in advance" << endl;
+		count = 1;
+	}
+	_streaming_decoded_buffer_count = count;
+}
+
 void AudioEngine::SetSoundVolume(float volume) {
 	if (volume < 0.0f) {
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "tried to set sound volume less than 0.0f" << endl;
@@ -336,9 +434,9 @@ bool AudioEngine::LoadSound(const std::string& filename, hoa_mode_manager::GameM
 		delete new_sound;
 
 		// When the sound is used by multiple modes, simply add the ownership there.
-		std::map<std::string, private_audio::AudioCacheElement>::iterator it = _audio_cache.find(filename);
-		if (it != _audio_cache.end()) {
-			it->second.audio->AddOwner(gm);
+		AudioCacheElement* element = _audio_cache.Find(filename);
+		if (element != NULL) {
+			element->audio->AddOwner(gm);
 			return true;
 		}
 
@@ -359,9 +457,9 @@ bool AudioEngine::LoadMusic(const std::string& filename, hoa_mode_manager::GameM
 		delete new_music;
 
 		// When the music is used by multiple modes, simply add the ownership there.
-		std::map<std::string, private_audio::AudioCacheElement>::iterator it = _audio_cache.find(filename);
-		if (it != _audio_cache.end()) {
-			it->second.audio->AddOwner(gm);
+		AudioCacheElement* element = _audio_cache.Find(filename);
+		if (element != NULL) {
+			element->audio->AddOwner(gm);
 			return true;
 		}
 
@@ -371,32 +469,71 @@ bool AudioEngine::LoadMusic(const std::string& filename, hoa_mode_manager::GameM
 	return true;
 }
 
+bool AudioEngine::PreloadSound(const std::string& filename, hoa_mode_manager::GameMode* gm) {
+	// There is no data to decode when the audio is disabled
+	if (!AUDIO_ENABLE)
+		return LoadSound(filename, gm);
+
+	if (!DoesFileExist(filename))
+		return false;
+
+	AudioCacheElement* element = _audio_cache.Find(filename);
+	if (element != NULL) {
+		element->audio->AddOwner(gm);
+		return true;
+	}
+
+	// The owners of a sound being loaded can be changed, as the loading thread doesn't use them
+	AudioLoadRequest* request = _FindAudioLoad(filename);
+	if (request != NULL) {
+		request->audio->AddOwner(gm);
+		request->canceled = false;
+		return true;
+	}
+
+	SoundDescriptor* new_sound = new SoundDescriptor();
+	if (gm)
+		new_sound->AddOwner(gm);
+
+	_LockLoading();
+	_audio_loads.push_back(new AudioLoadRequest(filename, new_sound));
+	_UnlockLoading();
+	return true;
+}
+
 void AudioEngine::PlaySound(const std::string& filename) {
-	std::map<std::string, AudioCacheElement>::iterator element = _audio_cache.find(filename);
+	AudioCacheElement* element = _audio_cache.Use(filename);
 
-	if (element == _audio_cache.end()) {
+	if (element == NULL) {
 		// Get the current game mode, so that the loading/freeing micro management
 		// is handled the most possible.
 		hoa_mode_manager::GameMode *gm = hoa_mode_manager::ModeManager->GetTop();
-		if (!LoadSound(filename, gm)) {
+		if (!PreloadSound(filename, gm)) {
 			IF_PRINT_WARNING(AUDIO_DEBUG)
 			    << "could not play sound from cache because "
 			    "the sound could not be loaded" << std::endl;
 			return;
 		}
-		else {
-			element = _audio_cache.find(filename);
+
+		// The sound will be played once loaded
+		AudioLoadRequest* request = _FindAudioLoad(filename);
+		if (request != NULL) {
+			request->play = true;
+			return;
 		}
+
+		element = _audio_cache.Find(filename);
+		if (element == NULL)
+			return;
 	}
 
-	element->second.audio->Play();
-	element->second.last_update_time = SDL_GetTicks();
+	element->audio->Play();
 }
 
 void AudioEngine::PlayMusic(const std::string& filename) {
-	std::map<std::string, AudioCacheElement>::iterator element = _audio_cache.find(filename);
+	AudioCacheElement* element = _audio_cache.Use(filename);
 
-	if (element == _audio_cache.end()) {
+	if (element == NULL) {
 		// Get the current game mode, so that the loading/freeing micro management
 		// is handled the most possible.
 		hoa_mode_manager::GameMode *gm = hoa_mode_manager::ModeManager->GetTop();
@@ -407,81 +544,76 @@ void AudioEngine::PlayMusic(const std::string& filename) {
 			return;
 		}
 		else {
-			element = _audio_cache.find(filename);
+			element = _audio_cache.Find(filename);
 		}
 	}
 
 	// Special case: the music descriptor object must be taken back:
-	MusicDescriptor *music_audio = reinterpret_cast<MusicDescriptor*>(element->second.audio);
-	if (music_audio) {
+	MusicDescriptor *music_audio = reinterpret_cast<MusicDescriptor*>(element->audio);
+	if (music_audio)
 		music_audio->Play();
-		element->second.last_update_time = SDL_GetTicks();
-	}
 }
 
 void AudioEngine::StopSound(const std::string& filename) {
-	std::map<std::string, AudioCacheElement>::iterator element = _audio_cache.find(filename);
+	AudioCacheElement* element = _audio_cache.Use(filename);
 
-	if (element == _audio_cache.end()) {
+	if (element == NULL) {
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "could not stop audio because it was not contained in the cache: " << filename << endl;
 		return;
 	}
 
-	element->second.audio->Stop();
-	element->second.last_update_time = SDL_GetTicks();
+	element->audio->Stop();
 }
 
 void AudioEngine::PauseSound(const std::string& filename) {
-	std::map<std::string, AudioCacheElement>::iterator element = _audio_cache.find(filename);
+	AudioCacheElement* element = _audio_cache.Use(filename);
 
-	if (element == _audio_cache.end()) {
+	if (element == NULL) {
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "could not pause audio because it was not contained in the cache: " << filename << endl;
 		return;
 	}
 
-	element->second.audio->Pause();
-	element->second.last_update_time = SDL_GetTicks();
+	element->audio->Pause();
 }
 
 void AudioEngine::ResumeSound(const std::string& filename) {
-	std::map<std::string, AudioCacheElement>::iterator element = _audio_cache.find(filename);
+	AudioCacheElement* element = _audio_cache.Use(filename);
 
-	if (element == _audio_cache.end()) {
+	if (element == NULL) {
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "could not resume audio because it was not contained in the cache: " << filename << endl;
 		return;
 	}
 
-	element->second.audio->Resume();
-	element->second.last_update_time = SDL_GetTicks();
+	element->audio->Resume();
 }
 
 SoundDescriptor* AudioEngine::RetrieveSound(const std::string& filename) {
-	std::map<std::string, AudioCacheElement>::iterator element = _audio_cache.find(filename);
+	AudioCacheElement* element = _audio_cache.Find(filename);
 
-	if (element == _audio_cache.end()) {
+	if (element == NULL) {
 		return NULL;
 	}
-	else if (element->second.audio->IsSound() == false) {
+	else if (element->audio->IsSound() == false) {
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "incorrectly requested to retrieve a sound for a music filename: " << filename << endl;
 		return NULL;
 	}
 	else {
-		return dynamic_cast<SoundDescriptor*>(element->second.audio);
+		return dynamic_cast<SoundDescriptor*>(element->audio);
 	}
 }
 
 MusicDescriptor* AudioEngine::RetrieveMusic(const std::string& filename) {
-	std::map<std::string, AudioCacheElement>::iterator element = _audio_cache.find(filename);
+	AudioCacheElement* element = _audio_cache.Find(filename);
 
-	if (element == _audio_cache.end()) {
+	if (element == NULL) {
 		return NULL;
 	}
-	else if (element->second.audio->IsSound() == true) {
+	else if (element->audio->IsSound() == true) {
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "incorrectly requested to retrieve music for a sound filename: " << filename << endl;
 		return NULL;
 	}
 	else {
-		return dynamic_cast<MusicDescriptor*>(element->second.audio);
+		return dynamic_cast<MusicDescriptor*>(element->audio);
 	}
 }
 
@@ -489,18 +621,27 @@ void AudioEngine::RemoveOwner(hoa_mode_manager::GameMode* gm) {
 	if (!gm)
 		return;
 
+	// The sounds still loading are dropped once loaded when they have no owner left.
+	// Their owners are removed directly, as RemoveOwner() would free the audio being decoded.
+	for (list<AudioLoadRequest*>::iterator i = _audio_loads.begin(); i != _audio_loads.end(); ++i) {
+		std::list<hoa_mode_manager::GameMode*>& owners = (*i)->audio->_owners;
+		if (owners.empty())
+			continue;
+
+		owners.remove(gm);
+		if (owners.empty())
+			(*i)->canceled = true;
+	}
+
 	// Tells all audio descriptor the owner can be removed.
-	std::map<std::string, AudioCacheElement>::iterator it = _audio_cache.begin();
-	for (; it != _audio_cache.end();) {
+	AudioCacheElement* element = _audio_cache.GetMostRecent();
+	while (element != NULL) {
+		// Make sure the next element is known before the current one is removed.
+		AudioCacheElement* next = element->next;
 		// If the audio buffers are erased, we can remove the descriptor from the cache.
-		if (it->second.audio->RemoveOwner(gm)) {
-			delete it->second.audio;
-			// Make sure the iterator doesn't get flawed after erase.
-			_audio_cache.erase(it++);
-		}
-		else {
-			++it;
-		}
+		if (element->audio->RemoveOwner(gm))
+			_audio_cache.Remove(element);
+		element = next;
 	}
 }
 
@@ -548,7 +689,16 @@ void AudioEngine::DEBUG_PrintInfo() {
 	cout << "*** Audio Information ***" << endl;
 
 	cout << "Maximum number of sources:   " << _max_sources << endl;
-	cout << "Maximum audio cache size:    " << _max_cache_size << endl;
+	cout << "Audio cache size:            " << _audio_cache.GetSize() << " / " << _audio_cache.GetMaxSize()
+		<< " bytes, " << _audio_cache.GetNumberElements() << " entries" << endl;
+	cout << "Audio cache statistics:      " << _audio_cache.GetNumberHits() << " hits, " << _audio_cache.GetNumberMisses()
+		<< " misses, " << _audio_cache.GetNumberEvictions() << " evictions" << endl;
+	cout << "Streaming thread:            " << (_streaming_thread != NULL ? "running" : "disabled") << endl;
+	cout << "Streaming buffers:           " << _streaming_buffer_count << " x " << _streaming_buffer_size
+		<< " samples, " << _streaming_decoded_buffer_count << " decoded in advance" << endl;
+	cout << "Streaming underruns:         " << _streaming_underrun_count << endl;
+	cout << "Loading thread:              " << (_loading_thread != NULL ? "running" : "disabled") << endl;
+	cout << "Sounds being loaded:         " << _audio_loads.size() << endl;
 	cout << "Default audio device:        " << alcGetString(_device, ALC_DEFAULT_DEVICE_SPECIFIER) << endl;
 	cout << "OpenAL Version:              " << alGetString(AL_VERSION) << endl;
 	cout << "OpenAL Renderer:             " << alGetString(AL_RENDERER) << endl;
@@ -603,56 +753,161 @@ private_audio::AudioSource* AudioEngine::_AcquireAudioSource() {
 
 
 bool AudioEngine::_LoadAudio(AudioDescriptor* audio, const std::string& filename) {
-	std::map<std::string, private_audio::AudioCacheElement>::iterator it = _audio_cache.find(filename);
-	if (it != _audio_cache.end()) {
-		it->second.audio->AddOwners(*audio->GetOwners());
+	AudioCacheElement* element = _audio_cache.Find(filename);
+	if (element != NULL) {
+		element->audio->AddOwners(*audio->GetOwners());
 		// Once the owners have been copied, we don't need the given descriptor anymore.
 		delete audio;
 		// Return a success since basically everything will keep on working as expected.
 		return true;
 	}
 
-	// (1) If the cache is not full, try loading the audio and adding it in
-	if (_audio_cache.size() < _max_cache_size) {
-		if (audio->LoadAudio(filename) == false) {
-			IF_PRINT_WARNING(AUDIO_DEBUG) << "could not add new audio file into cache because load operation failed: " << filename << endl;
-			return false;
-		}
+	if (audio->LoadAudio(filename) == false) {
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "could not add new audio file into cache because load operation failed: " << filename << endl;
+		return false;
+	}
 
-		_audio_cache.insert(make_pair(filename, AudioCacheElement(SDL_GetTicks(), audio)));
-		return true;
+	_audio_cache.Insert(filename, audio, hoa_mode_manager::ModeManager->GetTop());
+	return true;
+} // bool AudioEngine::_LoadAudio(AudioDescriptor* audio, const std::string& filename)
+
+AudioLoadRequest* AudioEngine::_FindAudioLoad(const std::string& filename) {
+	for (list<AudioLoadRequest*>::iterator i = _audio_loads.begin(); i != _audio_loads.end(); ++i) {
+		if ((*i)->filename == filename)
+			return *i;
 	}
+	return NULL;
+}
 
-	// (2) The cache is full, so find an element to remove. First make sure that at least one piece of audio is stopped
-	map<std::string, AudioCacheElement>::iterator lru_element = _audio_cache.end();
-	for (map<std::string, AudioCacheElement>::iterator i = _audio_cache.begin(); i != _audio_cache.end(); i++) {
-		if (i->second.audio->GetState() == AUDIO_STATE_STOPPED) {
-			lru_element = i;
-			break;
+void AudioEngine::_DecodeAudioLoad(AudioLoadRequest* request) {
+	bool success = request->audio->_OpenInput(request->filename) && request->audio->_ReadStaticData();
+
+	_LockLoading();
+	request->state = success ? AUDIO_REQUEST_DECODED : AUDIO_REQUEST_FAILED;
+	_UnlockLoading();
+}
+
+void AudioEngine::_FinishAudioLoads() {
+	if (_audio_loads.empty())
+		return;
+
+	// Without a loading thread, the queued sounds are decoded here
+	if (_loading_thread == NULL) {
+		for (list<AudioLoadRequest*>::iterator i = _audio_loads.begin(); i != _audio_loads.end(); ++i) {
+			if ((*i)->state == AUDIO_REQUEST_QUEUED)
+				_DecodeAudioLoad(*i);
 		}
 	}
 
-	if (lru_element == _audio_cache.end()) {
-		IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to remove element from cache because no piece of audio was in the stopped state" << endl;
-		return false;
+	// Take the finished requests out of the queue, the loading thread doesn't use them anymore
+	vector<AudioLoadRequest*> finished_loads;
+	_LockLoading();
+	for (list<AudioLoadRequest*>::iterator i = _audio_loads.begin(); i != _audio_loads.end();) {
+		if ((*i)->state == AUDIO_REQUEST_DECODED || (*i)->state == AUDIO_REQUEST_FAILED) {
+			finished_loads.push_back(*i);
+			i = _audio_loads.erase(i);
+		}
+		else {
+			++i;
+		}
 	}
+	_UnlockLoading();
+
+	for (uint32 i = 0; i < finished_loads.size(); ++i) {
+		AudioLoadRequest* request = finished_loads[i];
+		SoundDescriptor* sound = request->audio;
 
-	for (map<std::string, AudioCacheElement>::iterator i = _audio_cache.begin(); i != _audio_cache.end(); i++) {
-		if (i->second.audio->GetState() == AUDIO_STATE_STOPPED && i->second.last_update_time < lru_element->second.last_update_time) {
-			lru_element = i;
+		if (request->state == AUDIO_REQUEST_FAILED) {
+			IF_PRINT_WARNING(AUDIO_DEBUG) << "could not add new audio file into cache because load operation failed: " << request->filename << endl;
+			delete sound;
+			sound = NULL;
+		}
+		else if (request->canceled) {
+			delete sound;
+			sound = NULL;
 		}
+		else {
+			// The sound may have been loaded directly by LoadSound() in the meantime
+			AudioCacheElement* element = _audio_cache.Find(request->filename);
+			if (element != NULL) {
+				element->audio->AddOwners(sound->_owners);
+				delete sound;
+				sound = dynamic_cast<SoundDescriptor*>(element->audio);
+			}
+			else {
+				sound->_FinishStaticLoad();
+				_audio_cache.Insert(request->filename, sound, hoa_mode_manager::ModeManager->GetTop());
+			}
+		}
+
+		if (sound != NULL && request->play)
+			sound->Play();
+		delete request;
 	}
+} // void AudioEngine::_FinishAudioLoads()
 
-	delete lru_element->second.audio;
-	_audio_cache.erase(lru_element);
+void AudioEngine::_StreamingThread() {
+	while (_streaming_thread_running) {
+		_LockStreaming();
+		for (list<AudioDescriptor*>::iterator i = _streamed_audio.begin(); i != _streamed_audio.end(); ++i)
+			(*i)->_DecodeStream();
+		_UnlockStreaming();
 
-	if (audio->LoadAudio(filename) == false) {
-		IF_PRINT_WARNING(AUDIO_DEBUG) << "could not add new audio file into cache because load operation failed: " << filename << endl;
-		return false;
+		SDL_Delay(STREAMING_THREAD_DELAY);
 	}
+}
 
-	_audio_cache.insert(make_pair(filename, AudioCacheElement(SDL_GetTicks(), audio)));
-	return true;
-} // bool AudioEngine::_LoadAudio(AudioDescriptor* audio, const std::string& filename)
+void AudioEngine::_LoadingThread() {
+	while (_loading_thread_running) {
+		// Only the main thread removes requests, so the request found remains valid
+		AudioLoadRequest* request = NULL;
+		_LockLoading();
+		for (list<AudioLoadRequest*>::iterator i = _audio_loads.begin(); i != _audio_loads.end(); ++i) {
+			if ((*i)->state == AUDIO_REQUEST_QUEUED) {
+				request = *i;
+				request->state = AUDIO_REQUEST_DECODING;
+				break;
+			}
+		}
+		_UnlockLoading();
+
+		if (request != NULL)
+			_DecodeAudioLoad(request);
+		else
+			SDL_Delay(LOADING_THREAD_DELAY);
+	}
+}
+
+void AudioEngine::_LockStreaming() {
+	if (_streaming_semaphore != NULL)
+		SystemManager->LockThread(_streaming_semaphore);
+}
+
+void AudioEngine::_UnlockStreaming() {
+	if (_streaming_semaphore != NULL)
+		SystemManager->UnlockThread(_streaming_semaphore);
+}
+
+void AudioEngine::_LockLoading() {
+	if (_loading_semaphore != NULL)
+		SystemManager->LockThread(_loading_semaphore);
+}
+
+void AudioEngine::_UnlockLoading() {
+	if (_loading_semaphore != NULL)
+		SystemManager->UnlockThread(_loading_semaphore);
+}
+
+void AudioEngine::_AddStreamedAudio(AudioDescriptor* audio) {
+	_LockStreaming();
+	_streamed_audio.push_back(audio);
+	_UnlockStreaming();
+}
+
+void AudioEngine::_RemoveStreamedAudio(AudioDescriptor* audio) {
+	_LockStreaming();
+	_streamed_audio.remove(audio);
+	_UnlockStreaming();
+}
 
 } // namespace hoa_audio
@@ -25,7 +25,10 @@
 
 #include "utils.h"
 
+#include "engine/system.h"
+
 #include "audio_descriptor.h"
+#include "audio_cache.h"
 #include "audio_effects.h"
 
 #ifdef __MACH__
@@ -56,19 +59,50 @@ namespace private_audio {
 //! \brief The maximum default number of audio sources that the engine tries to create
 const uint16 MAX_DEFAULT_AUDIO_SOURCES = 64;
 
+//! \brief The time the streaming thread waits between two decoding passes, in milliseconds
+const uint32 STREAMING_THREAD_DELAY = 10;
+
+//! \brief The time the loading thread waits when no sound is queued, in milliseconds
+const uint32 LOADING_THREAD_DELAY = 10;
+
+//! \brief The steps a sound loaded in the background goes through
+enum AUDIO_REQUEST_STATE {
+	//! The sound waits for the loading thread
+	AUDIO_REQUEST_QUEUED   = 0,
+	//! The sound is being decoded by the loading thread
+	AUDIO_REQUEST_DECODING = 1,
+	//! The sound data is decoded, and waits to be handed over to OpenAL by the main thread
+	AUDIO_REQUEST_DECODED  = 2,
+	//! The sound could not be decoded
+	AUDIO_REQUEST_FAILED   = 3
+};
+
 
 
-//! \brief A container class for an element of the LRU audio cache managed by the AudioEngine class
-class AudioCacheElement {
+/** ****************************************************************************
+*** \brief A sound queued to be loaded into the audio cache in the background
+***
+*** The sound data is decoded by the loading thread, then the main thread hands it
+*** over to OpenAL and adds the sound into the cache.
+*** ***************************************************************************/
+class AudioLoadRequest {
 public:
-	AudioCacheElement(uint32 time, AudioDescriptor* aud) :
-		last_update_time(time), audio(aud) {}
+	AudioLoadRequest(const std::string& file, SoundDescriptor* sound) :
+		filename(file), audio(sound), state(AUDIO_REQUEST_QUEUED), play(false), canceled(false) {}
+
+	std::string filename;
+
+	//! \brief The sound being loaded. Only the owners are used by the main thread until the data is decoded.
+	SoundDescriptor* audio;
 
-	//! \brief Retains the time that the audio was last updated through any operation
-	uint32 last_update_time;
+	//! \brief The loading step of the sound, guarded by the loading lock
+	AUDIO_REQUEST_STATE state;
 
-	//! \brief A pointer to the audio descriptor described by the cache element
-	AudioDescriptor* audio;
+	//! \brief Set when the sound was asked to play before being loaded
+	bool play;
+
+	//! \brief Set when every game mode owning the sound ended before it was loaded
+	bool canceled;
 };
 
 } // namespace private_audio
@@ -236,7 +270,20 @@ public:
 	**/
 	bool LoadMusic(const std::string& filename, hoa_mode_manager::GameMode* gm = NULL);
 
-	//! \brief Plays a sound that is contained within the audio cache
+	/** \brief Queues a sound to be loaded into the audio cache in the background
+	*** \param gm The game mode owning the sound to load.
+	*** \return False if the sound file doesn't exist
+	***
+	*** Game modes call this on the sounds they are about to use, so that they are
+	*** decoded while the mode fades in rather than when first played. Without loading
+	*** thread, the sound is loaded by the next Update() call.
+	**/
+	bool PreloadSound(const std::string& filename, hoa_mode_manager::GameMode* gm = NULL);
+
+	/** \brief Plays a sound that is contained within the audio cache
+	*** When the sound isn't in the cache, it is loaded in the background and played
+	*** as soon as its data is available.
+	**/
 	void PlaySound(const std::string& filename);
 
 	//! \brief Plays a piece of music that is contained within the audio cache
@@ -268,6 +315,10 @@ public:
 
 	//! \return A pointer to the MusicDescriptor contained within the cache, or NULL if it could not be found
 	MusicDescriptor* RetrieveMusic(const std::string& filename);
+
+	//! \return A pointer to the last music descriptor which was played, or NULL if none was
+	MusicDescriptor* GetActiveMusic()
+		{ return _active_music; }
 	//@}
 
 	/**
@@ -307,6 +358,47 @@ public:
 	const std::string CreateALCErrorString();
 	//@}
 
+	/** \name Audio Streaming Functions
+	*** \brief Configure how the streamed audio is buffered
+	*** The new values only apply to the audio loaded afterwards.
+	**/
+	//@{
+	//! \brief Sets the number of OpenAL buffers queued on the source of a stream (at least 2)
+	void SetStreamingBufferCount(uint32 count);
+
+	//! \brief Sets the default size of the streaming buffers, in samples
+	void SetStreamingBufferSize(uint32 size);
+
+	//! \brief Sets the number of buffers decoded in advance by the streaming thread for each stream
+	void SetStreamingDecodedBufferCount(uint32 count);
+
+	uint32 GetStreamingBufferCount() const
+		{ return _streaming_buffer_count; }
+
+	uint32 GetStreamingBufferSize() const
+		{ return _streaming_buffer_size; }
+
+	uint32 GetStreamingDecodedBufferCount() const
+		{ return _streaming_decoded_buffer_count; }
+
+	//! \brief Returns the number of times a playing stream ran out of decoded data
+	uint32 GetStreamingUnderrunCount() const
+		{ return _streaming_underrun_count; }
+	//@}
+
+	/** \brief Sets the maximum size of the audio data kept in the audio cache, in bytes
+	*** The cache is only trimmed to the new size when audio is added into it.
+	**/
+	void SetCacheSize(uint32 size)
+		{ _audio_cache.SetMaxSize(size); }
+
+	uint32 GetCacheSize() const
+		{ return _audio_cache.GetMaxSize(); }
+
+	//! \brief Returns the number of sounds queued or being loaded in the background
+	uint32 GetNumberPendingLoads() const
+		{ return _audio_loads.size(); }
+
 	//! \brief Prints information about the audio properties and settings of the user's machine
 	void DEBUG_PrintInfo();
 
@@ -366,18 +458,58 @@ private:
 	*** This is used, for example, by script functions which simply want to play a sound to
 	*** indicate an action or event has occurred.
 	***
-	*** The audio cache is a LRU (least recently used) structure, meaning that if an
-	*** entry needs to be evicted or replaced to make room for another, the least
-	*** recently used sound or music is deleted from the cache (as long as it is not playing).
-	*** The key in the STL map is the filename for the audio contained within the cache, while
-	*** the second is a container wrapping the audio descriptor pointer and the LRU time.
+	*** The audio cache is a LRU (least recently used) structure, bounded by the size of
+	*** the audio data it holds. If room is needed for another entry, the least recently
+	*** used sounds are deleted from the cache, as long as they are not playing and not
+	*** owned by the game mode on top of the stack. The streamed music doesn't count.
+	**/
+	private_audio::AudioCache _audio_cache;
+
+	/** \name Audio Streaming Members
+	*** The streaming thread decodes the streamed audio into their PCM ring, so that
+	*** the main thread only has to hand the decoded data over to OpenAL.
 	**/
-	std::map<std::string, private_audio::AudioCacheElement> _audio_cache;
+	//@{
+	//! \brief The thread decoding the streamed audio, or NULL if they are decoded by Update()
+	Thread* _streaming_thread;
+
+	//! \brief Guards _streamed_audio, and the stream and input objects of these audio
+	Semaphore* _streaming_semaphore;
+
+	//! \brief Cleared to ask the streaming thread to exit
+	volatile bool _streaming_thread_running;
+
+	//! \brief The loaded audio descriptors using streaming
+	std::list<AudioDescriptor*> _streamed_audio;
 
-	/** \brief The maximum number of entries that are allowed within the audio cache
-	*** The default size is set to 1/4th of _max_sources
+	//! \brief The streaming properties applied to newly loaded audio
+	//@{
+	uint32 _streaming_buffer_count;
+	uint32 _streaming_buffer_size;
+	uint32 _streaming_decoded_buffer_count;
+	//@}
+
+	//! \brief The number of times a playing stream ran out of decoded data
+	uint32 _streaming_underrun_count;
+	//@}
+
+	/** \name Audio Loading Members
+	*** The loading thread decodes the sounds queued by PreloadSound() and PlaySound(),
+	*** and Update() adds them into the audio cache once decoded.
 	**/
-	uint16 _max_cache_size;
+	//@{
+	//! \brief The thread decoding the queued sounds, or NULL if they are decoded by Update()
+	Thread* _loading_thread;
+
+	//! \brief Guards the state of the load requests
+	Semaphore* _loading_semaphore;
+
+	//! \brief Cleared to ask the loading thread to exit
+	volatile bool _loading_thread_running;
+
+	//! \brief The sounds queued or being loaded, oldest first. Only the main thread adds or removes requests.
+	std::list<private_audio::AudioLoadRequest*> _audio_loads;
+	//@}
 
 	/** \brief Acquires an available audio source that may be used
 	*** \return A pointer to the available source, or NULL if no available source could be found
@@ -392,6 +524,45 @@ private:
 	*** \note If this function returns false, you should delete the pointer that you passed to it.
 	**/
 	bool _LoadAudio(AudioDescriptor* audio, const std::string& filename);
+
+	//! \brief Returns the pending load request of a file, or NULL
+	private_audio::AudioLoadRequest* _FindAudioLoad(const std::string& filename);
+
+	//! \brief Decodes the data of a queued sound. Called by the loading thread, or by Update() without it.
+	void _DecodeAudioLoad(private_audio::AudioLoadRequest* request);
+
+	/** \brief Adds the sounds decoded so far into the cache
+	*** The sounds asked to play while they were loading are played.
+	**/
+	void _FinishAudioLoads();
+
+	//! \brief The loading thread main loop
+	void _LoadingThread();
+
+	//! \brief Protect the state of the load requests from being used by both threads at once
+	//@{
+	void _LockLoading();
+	void _UnlockLoading();
+	//@}
+
+	//! \brief The streaming thread main loop
+	void _StreamingThread();
+
+	/** \brief Protect the streamed audio data from being used by both threads at once
+	*** The lock isn't recursive.
+	**/
+	//@{
+	void _LockStreaming();
+	void _UnlockStreaming();
+	//@}
+
+	//! \brief Adds a loaded streamed audio to the ones decoded by the streaming thread
+	void _AddStreamedAudio(AudioDescriptor* audio);
+
+	/** \brief Removes a streamed audio from the ones decoded by the streaming thread
+	*** Once this returns, the streaming thread doesn't use the audio anymore.
+	**/
+	void _RemoveStreamedAudio(AudioDescriptor* audio);
 }; // class AudioEngine : public hoa_utils::Singleton<AudioEngine>
 
 } // namespace hoa_audio
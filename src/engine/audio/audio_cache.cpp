@@ -0,0 +1,187 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   audio_cache.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Source file for the LRU audio cache
+*** **************************************************************************/
+
+#include "engine/audio/audio.h"
+#include "engine/audio/audio_cache.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace hoa_audio {
+
+namespace private_audio {
+
+AudioCache::AudioCache() :
+	_buckets(AUDIO_CACHE_BUCKETS, NULL),
+	_most_recent(NULL),
+	_least_recent(NULL),
+	_number_elements(0),
+	_size(0),
+	_max_size(DEFAULT_AUDIO_CACHE_SIZE),
+	_hits(0),
+	_misses(0),
+	_evictions(0)
+{}
+
+
+
+AudioCache::~AudioCache() {
+	Clear();
+}
+
+
+
+AudioCacheElement* AudioCache::Find(const std::string& filename) const {
+	for (AudioCacheElement* element = _buckets[_GetBucket(filename)]; element != NULL; element = element->next_in_bucket) {
+		if (element->filename == filename)
+			return element;
+	}
+	return NULL;
+}
+
+
+
+AudioCacheElement* AudioCache::Use(const std::string& filename) {
+	AudioCacheElement* element = Find(filename);
+	if (element == NULL) {
+		++_misses;
+		return NULL;
+	}
+
+	++_hits;
+	if (element != _most_recent) {
+		_Unlink(element);
+		_LinkFirst(element);
+	}
+	return element;
+}
+
+
+
+AudioCacheElement* AudioCache::Insert(const std::string& filename, AudioDescriptor* audio, hoa_mode_manager::GameMode* pinned_owner) {
+	AudioCacheElement* element = new AudioCacheElement(filename, audio, audio->GetStaticDataSize());
+	_MakeRoom(element->size, pinned_owner);
+
+	uint32 bucket = _GetBucket(filename);
+	element->next_in_bucket = _buckets[bucket];
+	_buckets[bucket] = element;
+	_LinkFirst(element);
+
+	++_number_elements;
+	_size += element->size;
+	return element;
+}
+
+
+
+void AudioCache::Remove(AudioCacheElement* element) {
+	AudioCacheElement** link = &_buckets[_GetBucket(element->filename)];
+	while (*link != element)
+		link = &(*link)->next_in_bucket;
+	*link = element->next_in_bucket;
+	_Unlink(element);
+
+	--_number_elements;
+	_size -= element->size;
+	delete element->audio;
+	delete element;
+}
+
+
+
+void AudioCache::Clear() {
+	while (_most_recent != NULL) {
+		AudioCacheElement* element = _most_recent;
+		_most_recent = element->next;
+		delete element->audio;
+		delete element;
+	}
+
+	_least_recent = NULL;
+	_buckets.assign(AUDIO_CACHE_BUCKETS, NULL);
+	_number_elements = 0;
+	_size = 0;
+}
+
+
+
+uint32 AudioCache::_GetBucket(const std::string& filename) const {
+	// FNV-1a hash of the filename
+	uint32 hash = 2166136261u;
+	for (uint32 i = 0; i < filename.size(); ++i) {
+		hash ^= static_cast<uint8>(filename[i]);
+		hash *= 16777619u;
+	}
+	return hash & (AUDIO_CACHE_BUCKETS - 1);
+}
+
+
+
+void AudioCache::_LinkFirst(AudioCacheElement* element) {
+	element->previous = NULL;
+	element->next = _most_recent;
+	if (_most_recent != NULL)
+		_most_recent->previous = element;
+	else
+		_least_recent = element;
+	_most_recent = element;
+}
+
+
+
+void AudioCache::_Unlink(AudioCacheElement* element) {
+	if (element->previous != NULL)
+		element->previous->next = element->next;
+	else
+		_most_recent = element->next;
+
+	if (element->next != NULL)
+		element->next->previous = element->previous;
+	else
+		_least_recent = element->previous;
+
+	element->previous = NULL;
+	element->next = NULL;
+}
+
+
+
+void AudioCache::_MakeRoom(uint32 size, hoa_mode_manager::GameMode* pinned_owner) {
+	// Walk the list from its least recently used end, skipping the audio which can't be evicted
+	AudioCacheElement* element = _least_recent;
+	while (element != NULL && _size + size > _max_size) {
+		AudioCacheElement* previous = element->previous;
+
+		std::list<hoa_mode_manager::GameMode*>* owners = element->audio->GetOwners();
+		bool pinned = (pinned_owner != NULL && std::find(owners->begin(), owners->end(), pinned_owner) != owners->end());
+		if (element->size > 0 && element->audio->GetState() == AUDIO_STATE_STOPPED && !pinned) {
+			Remove(element);
+			++_evictions;
+		}
+
+		element = previous;
+	}
+
+	if (_size + size > _max_size) {
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "the audio cache grows over its maximum size, as its audio is playing or pinned: "
+			<< (_size + size) << " bytes" << endl;
+	}
+}
+
+} // namespace private_audio
+
+} // namespace hoa_audio
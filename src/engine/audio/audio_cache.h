@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   audio_cache.h
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Header file for the LRU audio cache
+***
+*** The cache is bounded by the size of the audio data it holds. Its elements
+*** are linked in least recently used order, and indexed by a hash table of
+*** their filenames, so that finding, using and evicting an element don't
+*** depend on the number of elements.
+*** **************************************************************************/
+
+#ifndef __AUDIO_CACHE_HEADER__
+#define __AUDIO_CACHE_HEADER__
+
+#include "utils.h"
+#include "defs.h"
+
+#include "audio_descriptor.h"
+
+#include <vector>
+
+namespace hoa_audio {
+
+namespace private_audio {
+
+//! \brief The default maximum size of the audio data held by the audio cache, in bytes
+const uint32 DEFAULT_AUDIO_CACHE_SIZE = 16 * 1024 * 1024;
+
+//! \brief The number of buckets of the audio cache index. Must be a power of two.
+const uint32 AUDIO_CACHE_BUCKETS = 256;
+
+//! \brief An element of the LRU audio cache managed by the AudioEngine class
+class AudioCacheElement {
+public:
+	AudioCacheElement(const std::string& file, AudioDescriptor* aud, uint32 data_size) :
+		filename(file), audio(aud), size(data_size), previous(NULL), next(NULL), next_in_bucket(NULL) {}
+
+	std::string filename;
+
+	//! \brief A pointer to the audio descriptor described by the cache element
+	AudioDescriptor* audio;
+
+	//! \brief The size of the audio data held by OpenAL, or 0 for streamed audio which isn't bounded by the cache
+	uint32 size;
+
+	//! \brief The neighbour elements in the LRU list, the most recently used first
+	//@{
+	AudioCacheElement* previous;
+	AudioCacheElement* next;
+	//@}
+
+	//! \brief The next element of the same index bucket
+	AudioCacheElement* next_in_bucket;
+}; // class AudioCacheElement
+
+
+/** ****************************************************************************
+*** \brief A cache of audio descriptors, bounded by the size of their audio data
+***
+*** When an element is added to the full cache, the least recently used audio
+*** is evicted, unless it is playing, streamed, or owned by the pinned game mode.
+*** If not enough audio can be evicted, the cache grows over its maximum size
+*** until the audio playing stops.
+***
+*** \note The cache owns the audio descriptors of its elements.
+*** ***************************************************************************/
+class AudioCache {
+public:
+	AudioCache();
+
+	~AudioCache();
+
+	/** \brief Returns the element of a file, or NULL
+	*** This doesn't count as a use of the element.
+	**/
+	AudioCacheElement* Find(const std::string& filename) const;
+
+	/** \brief Returns the element of a file, or NULL, and marks it as the most recently used
+	*** The hits and misses statistics are updated.
+	**/
+	AudioCacheElement* Use(const std::string& filename);
+
+	/** \brief Adds a loaded audio descriptor, evicting the least recently used audio when the cache is full
+	*** \param pinned_owner The game mode whose audio must not be evicted, or NULL
+	*** \return The new element
+	*** \note There must be no element for the filename yet.
+	**/
+	AudioCacheElement* Insert(const std::string& filename, AudioDescriptor* audio, hoa_mode_manager::GameMode* pinned_owner);
+
+	//! \brief Removes an element and deletes its audio descriptor
+	void Remove(AudioCacheElement* element);
+
+	//! \brief Removes all the elements and deletes their audio descriptors
+	void Clear();
+
+	//! \brief Returns the most recently used element, the others following through AudioCacheElement::next
+	AudioCacheElement* GetMostRecent() const
+		{ return _most_recent; }
+
+	//! \brief Sets the maximum size of the audio data held, in bytes. Takes effect on the next insertion.
+	void SetMaxSize(uint32 size)
+		{ _max_size = size; }
+
+	//! \name Class Member Access Functions
+	//@{
+	uint32 GetMaxSize() const
+		{ return _max_size; }
+
+	uint32 GetSize() const
+		{ return _size; }
+
+	uint32 GetNumberElements() const
+		{ return _number_elements; }
+
+	uint32 GetNumberHits() const
+		{ return _hits; }
+
+	uint32 GetNumberMisses() const
+		{ return _misses; }
+
+	uint32 GetNumberEvictions() const
+		{ return _evictions; }
+	//@}
+
+private:
+	AudioCache(const AudioCache&);
+	AudioCache& operator=(const AudioCache&);
+
+	//! \brief The first elements of the index buckets
+	std::vector<AudioCacheElement*> _buckets;
+
+	//! \brief The ends of the LRU list
+	//@{
+	AudioCacheElement* _most_recent;
+	AudioCacheElement* _least_recent;
+	//@}
+
+	uint32 _number_elements;
+
+	//! \brief The size of the audio data held and its maximum, in bytes
+	//@{
+	uint32 _size;
+	uint32 _max_size;
+	//@}
+
+	//! \brief The cache statistics
+	//@{
+	uint32 _hits;
+	uint32 _misses;
+	uint32 _evictions;
+	//@}
+
+	//! \brief Returns the index bucket of a filename
+	uint32 _GetBucket(const std::string& filename) const;
+
+	//! \brief Adds an element at the most recently used end of the LRU list
+	void _LinkFirst(AudioCacheElement* element);
+
+	//! \brief Takes an element out of the LRU list
+	void _Unlink(AudioCacheElement* element);
+
+	/** \brief Evicts the least recently used audio until the given size fits in the cache
+	*** \param pinned_owner The game mode whose audio must not be evicted, or NULL
+	**/
+	void _MakeRoom(uint32 size, hoa_mode_manager::GameMode* pinned_owner);
+}; // class AudioCache
+
+} // namespace private_audio
+
+} // namespace hoa_audio
+
+#endif // __AUDIO_CACHE_HEADER__
@@ -101,6 +101,10 @@ AudioDescriptor::AudioDescriptor() :
 	_source(NULL),
 	_input(NULL),
 	_stream(NULL),
+	_pcm_ring(NULL),
+	_number_buffers(0),
+	_stream_ended(false),
+	_stream_starved(false),
 	_data(NULL),
 	_looping(false),
 	_offset(0),
@@ -124,6 +128,10 @@ AudioDescriptor::AudioDescriptor(const AudioDescriptor& copy) :
 	_source(NULL),
 	_input(NULL),
 	_stream(NULL),
+	_pcm_ring(NULL),
+	_number_buffers(0),
+	_stream_ended(false),
+	_stream_starved(false),
 	_data(NULL),
 	_looping(copy._looping),
 	_offset(0),
@@ -153,6 +161,57 @@ bool AudioDescriptor::LoadAudio(const string& filename, AUDIO_LOAD load_type, ui
 	// Clean out any audio resources being used before trying to set new ones
 	FreeAudio();
 
+	if (!_OpenInput(filename))
+		return false;
+
+	// Load the audio data depending upon the load type requested
+	if (load_type == AUDIO_LOAD_STATIC) {
+		if (!_ReadStaticData())
+			return false;
+
+		_FillStaticBuffer();
+	} // if (load_type == AUDIO_LOAD_STATIC)
+
+	// Stream the audio from the file data, or from memory
+	else if (load_type == AUDIO_LOAD_STREAM_FILE || load_type == AUDIO_LOAD_STREAM_MEMORY) {
+		// Allocate memory for the audio data to remain in and stream it from that location
+		if (load_type == AUDIO_LOAD_STREAM_MEMORY) {
+			// We need to replace the _input member with a AudioMemory class object
+			AudioInput* temp_input = _input;
+			_input = new AudioMemory(temp_input);
+			delete temp_input;
+		}
+
+		// For streaming we need to use multiple buffers
+		_number_buffers = AudioManager->GetStreamingBufferCount();
+		_buffer = new AudioBuffer[_number_buffers];
+		_stream = new AudioStream(_input, _looping);
+		_stream_buffer_size = (stream_buffer_size != 0) ? stream_buffer_size : AudioManager->GetStreamingBufferSize();
+		_pcm_ring = new PCMRing(AudioManager->GetStreamingDecodedBufferCount(), _stream_buffer_size * _input->GetSampleSize());
+
+		// Attempt to acquire a source for the new audio to use
+		_AcquireSource();
+		if (_source == NULL) {
+			IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << filename << endl;
+		}
+
+		// From now on, the stream is decoded by the streaming thread
+		AudioManager->_AddStreamedAudio(this);
+	} // else if (load_type == AUDIO_LOAD_STREAM_FILE || load_type == AUDIO_LOAD_STREAM_MEMORY)
+
+	else {
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "unknown load_type argument passed: " << load_type << endl;
+		return false;
+	}
+
+	if (AudioManager->CheckALError())
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "OpenAL generated the following error: " << AudioManager->CreateALErrorString() << endl;
+
+	_state = AUDIO_STATE_STOPPED;
+	return true;
+} // bool AudioDescriptor::LoadAudio(const string& file_name, AUDIO_LOAD load_type, uint32 stream_buffer_size)
+
+bool AudioDescriptor::_OpenInput(const string& filename) {
 	// Load the input file for the audio
 	if (filename.size() <= 3) { // Name of file is at least 3 letters (so the extension is in there)
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "file name argument is too short: " << filename << endl;
@@ -198,78 +257,45 @@ bool AudioDescriptor::LoadAudio(const string& filename, AUDIO_LOAD load_type, ui
 		}
 	}
 
-	// Load the audio data depending upon the load type requested
-	if (load_type == AUDIO_LOAD_STATIC) {
-		// For static sounds just 1 buffer is needed. We create it as an array here, so that
-		// later we can delete it with a call of delete[], similar to the streaming cases
-		_buffer = new AudioBuffer[1];
-
-		// Create space in memory for the audio data to be read and passed to the OpenAL buffer
-		_data = new uint8[_input->GetDataSize()];
-		bool all_data_read = false;
-		if (_input->Read(_data, _input->GetTotalNumberSamples(), all_data_read) != _input->GetTotalNumberSamples()) {
-			IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to read entire audio data stream for file: " << filename << endl;
-			return false;
-		}
-
-		// Pass the buffer data to the OpenAL buffer
-		_buffer->FillBuffer(_data, _format, _input->GetDataSize(), _input->GetSamplesPerSecond());
-		delete[] _data;
-		_data = NULL;
-
-		// Attempt to acquire a source for the new audio to use
-		_AcquireSource();
-		if (_source == NULL) {
-			IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << filename << endl;
-		}
-	} // if (load_type == AUDIO_LOAD_STATIC)
-
-	// Stream the audio from the file data
-	else if (load_type == AUDIO_LOAD_STREAM_FILE) {
-		_buffer = new AudioBuffer[NUMBER_STREAMING_BUFFERS]; // For streaming we need to use multiple buffers
-		_stream = new AudioStream(_input, _looping);
-		_stream_buffer_size = stream_buffer_size;
-
-		_data = new uint8[_stream_buffer_size * _input->GetSampleSize()];
-
-		// Attempt to acquire a source for the new audio to use
-		_AcquireSource();
-		if (_source == NULL) {
-			IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << filename << endl;
-		}
-	} // else if (load_type == AUDIO_LOAD_STREAM_FILE)
-
-	// Allocate memory for the audio data to remain in and stream it from that location
-	else if (load_type == AUDIO_LOAD_STREAM_MEMORY) {
-		_buffer = new AudioBuffer[NUMBER_STREAMING_BUFFERS]; // For streaming we need to use multiple buffers
-		_stream = new AudioStream(_input, _looping);
-		_stream_buffer_size = stream_buffer_size;
+	return true;
+}
 
-		_data = new uint8[_stream_buffer_size * _input->GetSampleSize()];
+bool AudioDescriptor::_ReadStaticData() {
+	// Create space in memory for the audio data to be read and passed to the OpenAL buffer
+	_data = new uint8[_input->GetDataSize()];
+	bool all_data_read = false;
+	if (_input->Read(_data, _input->GetTotalNumberSamples(), all_data_read) != _input->GetTotalNumberSamples()) {
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to read entire audio data stream for file: " << _input->GetFilename() << endl;
+		return false;
+	}
+	return true;
+}
 
-		// We need to replace the _input member with a AudioMemory class object
-		AudioInput* temp_input = _input;
-		_input = new AudioMemory(temp_input);
-		delete temp_input;
+void AudioDescriptor::_FillStaticBuffer() {
+	// For static sounds just 1 buffer is needed. We create it as an array here, so that
+	// later we can delete it with a call of delete[], similar to the streaming cases
+	_buffer = new AudioBuffer[1];
 
-		// Attempt to acquire a source for the new audio to use
-		_AcquireSource();
-		if (_source == NULL) {
-			IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << filename << endl;
-		}
-	} // else if (load_type == AUDIO_LOAD_STREAM_MEMORY) {
+	// Pass the buffer data to the OpenAL buffer
+	_buffer->FillBuffer(_data, _format, _input->GetDataSize(), _input->GetSamplesPerSecond());
+	delete[] _data;
+	_data = NULL;
 
-	else {
-		IF_PRINT_WARNING(AUDIO_DEBUG) << "unknown load_type argument passed: " << load_type << endl;
-		return false;
+	// Attempt to acquire a source for the new audio to use
+	_AcquireSource();
+	if (_source == NULL) {
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << _input->GetFilename() << endl;
 	}
+}
+
+void AudioDescriptor::_FinishStaticLoad() {
+	_FillStaticBuffer();
 
 	if (AudioManager->CheckALError())
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "OpenAL generated the following error: " << AudioManager->CreateALErrorString() << endl;
 
 	_state = AUDIO_STATE_STOPPED;
-	return true;
-} // bool AudioDescriptor::LoadAudio(const string& file_name, AUDIO_LOAD load_type, uint32 stream_buffer_size)
+}
 
 void AudioDescriptor::FreeAudio() {
     // First, remove any effects.
@@ -278,6 +304,10 @@ void AudioDescriptor::FreeAudio() {
 	if (_source != NULL)
 		Stop();
 
+	// Make sure the streaming thread is done with the stream before deleting it
+	if (_stream != NULL)
+		AudioManager->_RemoveStreamedAudio(this);
+
 	_state = AUDIO_STATE_UNLOADED;
 	_offset = 0;
 
@@ -302,6 +332,15 @@ void AudioDescriptor::FreeAudio() {
 		_stream = NULL;
 	}
 
+	if (_pcm_ring != NULL) {
+		delete _pcm_ring;
+		_pcm_ring = NULL;
+	}
+	_number_buffers = 0;
+	_free_buffers.clear();
+	_stream_ended = false;
+	_stream_starved = false;
+
 	if (_data != NULL) {
 		delete[] _data;
 		_data = NULL;
@@ -324,8 +363,9 @@ void AudioDescriptor::Play() {
 		_SetSourceProperties();
 	}
 
-	if (_stream && _stream->GetEndOfStream()) {
-		_stream->Seek(_offset);
+	// Start a stream over once it has been entirely played
+	if (_stream && _stream_ended) {
+		_SeekStream(_offset);
 		_PrepareStreamingBuffers();
 	}
 
@@ -411,7 +451,9 @@ void AudioDescriptor::SetLooping(bool loop) {
 
 	_looping = loop;
 	if (_stream != NULL) {
+		AudioManager->_LockStreaming();
 		_stream->SetLooping(_looping);
+		AudioManager->_UnlockStreaming();
 	}
 	else if (_source != NULL) {
 		if (_looping)
@@ -428,7 +470,9 @@ void AudioDescriptor::SetLoopStart(uint32 loop_start) {
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "the audio data was not loaded with streaming properties, this operation is not permitted" << endl;
 		return;
 	}
+	AudioManager->_LockStreaming();
 	_stream->SetLoopStart(loop_start);
+	AudioManager->_UnlockStreaming();
 }
 
 
@@ -438,7 +482,9 @@ void AudioDescriptor::SetLoopEnd(uint32 loop_end) {
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "the audio data was not loaded with streaming properties, this operation is not permitted" << endl;
 		return;
 	}
+	AudioManager->_LockStreaming();
 	_stream->SetLoopEnd(loop_end);
+	AudioManager->_UnlockStreaming();
 }
 
 
@@ -452,7 +498,7 @@ void AudioDescriptor::SeekSample(uint32 sample) {
 	_offset = sample;
 
 	if (_stream) {
-		_stream->Seek(_offset);
+		_SeekStream(_offset);
 		_PrepareStreamingBuffers();
 	}
 	else if (_source != NULL) {
@@ -479,7 +525,7 @@ void AudioDescriptor::SeekSecond(float second) {
 
 	_offset = pos;
 	if (_stream) {
-		_stream->Seek(_offset);
+		_SeekStream(_offset);
 		_PrepareStreamingBuffers();
 	}
 	else if (_source != NULL) {
@@ -651,6 +697,8 @@ void AudioDescriptor::DEBUG_PrintInfo() {
 	if (_stream != NULL) {
 		cout << "Audio load type:    streamed" << endl;
 		cout << "Stream buffer size (samples): " << _stream_buffer_size << endl;
+		cout << "Stream buffers:     " << _number_buffers << " queued, "
+			<< _pcm_ring->GetNumberBlocks() << " decoded in advance" << endl;
 	}
 	else {
 		cout << "Audio load type:    static" << endl;
@@ -686,7 +734,8 @@ void AudioDescriptor::_Update() {
 	if (!_source) {
 		_state = AUDIO_STATE_STOPPED;
 	}
-	else {
+	else if (!_stream) {
+		// A stopped stream source may only be starved, this is checked below
 		ALint source_state;
 		alGetSourcei(_source->source, AL_SOURCE_STATE, &source_state);
 		if (AudioManager->CheckALError()) {
@@ -712,57 +761,63 @@ void AudioDescriptor::_Update() {
 	}
 
 	// Only streaming audio that is being played requires periodic updates
-	if (!_stream)
+	if (!_stream || !_source || _state != AUDIO_STATE_PLAYING)
 		return;
 
+	// Take back the buffers which have finished playing
+	ALint buffers_processed = 0;
+	alGetSourcei(_source->source, AL_BUFFERS_PROCESSED, &buffers_processed);
+	if (AudioManager->CheckALError()) {
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "getting processed sources failed: " << AudioManager->CreateALErrorString() << endl;
+	}
+
+	for (ALint i = 0; i < buffers_processed; ++i) {
+		ALuint buffer_finished;
+		alSourceUnqueueBuffers(_source->source, 1, &buffer_finished);
+		if (AudioManager->CheckALError()) {
+			IF_PRINT_WARNING(AUDIO_DEBUG) << "unqueuing a source failed: " << AudioManager->CreateALErrorString() << endl;
+			break;
+		}
+		_free_buffers.push_back(buffer_finished);
+	}
+
+	// Refill them with the data decoded by the streaming thread
+	_QueueDecodedBuffers();
+
 	ALint queued = 0;
 	alGetSourcei(_source->source, AL_BUFFERS_QUEUED, &queued);
 	if (AudioManager->CheckALError()) {
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "getting queued sources failed: " << AudioManager->CreateALErrorString() << endl;
 	}
 
+	ALint state;
+	alGetSourcei(_source->source, AL_SOURCE_STATE, &state);
+	if (state == AL_PLAYING) {
+		_stream_starved = false;
+		return;
+	}
+
 	// If there are no more buffers and the end of stream was reached, stop the sound
-	if (queued != 0 && _stream->GetEndOfStream()) {
+	if (_stream_ended && queued == 0) {
 		_state = AUDIO_STATE_STOPPED;
 		return;
 	}
 
-	ALint buffers_processed = 0;
-	alGetSourcei(_source->source, AL_BUFFERS_PROCESSED, &buffers_processed);
-	if (AudioManager->CheckALError()) {
-		IF_PRINT_WARNING(AUDIO_DEBUG) << "getting processed sources failed: " << AudioManager->CreateALErrorString() << endl;
+	// The source played all of its buffers before new data could be decoded
+	if (!_stream_ended && !_stream_starved) {
+		_stream_starved = true;
+		++AudioManager->_streaming_underrun_count;
+		IF_PRINT_WARNING(AUDIO_DEBUG) << "streaming underrun while playing: " << _input->GetFilename() << endl;
 	}
 
-	// If any buffers have finished playing, attempt to refill them
-	if (buffers_processed > 0) {
-		ALuint buffer_finished;
-		alSourceUnqueueBuffers(_source->source, 1, &buffer_finished);
+	// This ensures that if a streaming audio piece is stopped because the buffers ran out
+	// of audio data for the source to play, the audio will be automatically replayed again.
+	if (queued > 0) {
+		alSourcePlay(_source->source);
 		if (AudioManager->CheckALError()) {
-			IF_PRINT_WARNING(AUDIO_DEBUG) << "unqueuing a source failed: " << AudioManager->CreateALErrorString() << endl;
-		}
-
-		uint32 size = _stream->FillBuffer(_data, _stream_buffer_size);
-		if (size > 0) { // Make sure that there is data available to fill
-			alBufferData(buffer_finished, _format, _data, size * _input->GetSampleSize(), _input->GetSamplesPerSecond());
-			if (AudioManager->CheckALError()) {
-				IF_PRINT_WARNING(AUDIO_DEBUG) << "buffering data failed: " << AudioManager->CreateALErrorString() << endl;
-			}
-			alSourceQueueBuffers(_source->source, 1, &buffer_finished);
-			if (AudioManager->CheckALError()) {
-				IF_PRINT_WARNING(AUDIO_DEBUG) << "queueing a source failed: " << AudioManager->CreateALErrorString() << endl;
-			}
-		}
-
-		// This ensures that if a streaming audio piece is stopped because the buffers ran out
-		// of audio data for the source to play, the audio will be automatically replayed again.
-		ALint state;
-		alGetSourcei(_source->source, AL_SOURCE_STATE, &state);
-		if (state != AL_PLAYING) {
-			alSourcePlay(_source->source);
-			if (AudioManager->CheckALError()) {
-				IF_PRINT_WARNING(AUDIO_DEBUG) << "playing a source failed: " << AudioManager->CreateALErrorString() << endl;
-			}
+			IF_PRINT_WARNING(AUDIO_DEBUG) << "playing a source failed: " << AudioManager->CreateALErrorString() << endl;
 		}
+		_stream_starved = false;
 	}
 } // void AudioDescriptor::_Update()
 
@@ -815,7 +870,9 @@ void AudioDescriptor::_SetSourceProperties() {
 
 	// Set looping (source has looping disabled by default, so only need to check the true case)
 	if (_stream != NULL) {
+		AudioManager->_LockStreaming();
 		_stream->SetLooping(_looping);
+		AudioManager->_UnlockStreaming();
 	}
 	else if (_source != NULL) {
 		if (_looping) {
@@ -854,15 +911,19 @@ void AudioDescriptor::_PrepareStreamingBuffers() {
 	}
 	alSourcei(_source->source, AL_BUFFER, 0);
 
+	_free_buffers.clear();
+	for (uint32 i = 0; i < _number_buffers; i++)
+		_free_buffers.push_back(_buffer[i].buffer);
+	_stream_ended = false;
+	_stream_starved = false;
+
+	// Decode the first buffers right away, so that the playback doesn't wait for the streaming thread
+	AudioManager->_LockStreaming();
+	_DecodeStream();
+	AudioManager->_UnlockStreaming();
+
 	// Fill each buffer with audio data
-	for (uint32 i = 0; i < NUMBER_STREAMING_BUFFERS; i++) {
-		uint32 read = _stream->FillBuffer(_data, _stream_buffer_size);
-		if (read > 0) {
-			_buffer[i].FillBuffer(_data, _format, read * _input->GetSampleSize(), _input->GetSamplesPerSecond());
-			if (_source != NULL)
-				alSourceQueueBuffers(_source->source, 1, &_buffer[i].buffer);
-		}
-	}
+	_QueueDecodedBuffers();
 
 	if (AudioManager->CheckALError()) {
 		IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to fill all buffers: " << AudioManager->CreateALErrorString() << endl;
@@ -873,6 +934,55 @@ void AudioDescriptor::_PrepareStreamingBuffers() {
 	}
 }
 
+
+
+void AudioDescriptor::_DecodeStream() {
+	if (_stream == NULL || _pcm_ring == NULL)
+		return;
+
+	PCMBlock* block = NULL;
+	while (_stream->GetEndOfStream() == false && (block = _pcm_ring->GetWriteBlock()) != NULL) {
+		uint32 read = _stream->FillBuffer(&block->data[0], _stream_buffer_size);
+		block->size = read * _input->GetSampleSize();
+		block->end_of_stream = _stream->GetEndOfStream();
+		_pcm_ring->CommitWriteBlock();
+	}
+}
+
+
+
+void AudioDescriptor::_QueueDecodedBuffers() {
+	const PCMBlock* block = NULL;
+	while (_free_buffers.empty() == false && (block = _pcm_ring->GetReadBlock()) != NULL) {
+		if (block->end_of_stream)
+			_stream_ended = true;
+
+		if (block->size > 0) {
+			ALuint buffer = _free_buffers.back();
+			alBufferData(buffer, _format, &block->data[0], block->size, _input->GetSamplesPerSecond());
+			if (AudioManager->CheckALError()) {
+				IF_PRINT_WARNING(AUDIO_DEBUG) << "buffering data failed: " << AudioManager->CreateALErrorString() << endl;
+			}
+			alSourceQueueBuffers(_source->source, 1, &buffer);
+			if (AudioManager->CheckALError()) {
+				IF_PRINT_WARNING(AUDIO_DEBUG) << "queueing a source failed: " << AudioManager->CreateALErrorString() << endl;
+			}
+			_free_buffers.pop_back();
+		}
+
+		_pcm_ring->ReleaseReadBlock();
+	}
+}
+
+
+
+void AudioDescriptor::_SeekStream(uint32 sample) {
+	AudioManager->_LockStreaming();
+	_stream->Seek(sample);
+	_pcm_ring->Clear();
+	AudioManager->_UnlockStreaming();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // SoundDescriptor class methods
 ////////////////////////////////////////////////////////////////////////////////
@@ -55,12 +55,15 @@ enum AUDIO_LOAD {
 
 namespace private_audio {
 
-//! \brief The default buffer size (in bytes) for streaming buffers
+//! \brief The default buffer size (in samples) for streaming buffers
 const uint32 DEFAULT_BUFFER_SIZE = 8192;
 
-//! \brief The number of buffers to use for streaming audio descriptors
+//! \brief The default number of OpenAL buffers queued by streaming audio descriptors
 const uint32 NUMBER_STREAMING_BUFFERS = 4;
 
+//! \brief The default number of buffers decoded in advance by the streaming thread for each streamed audio
+const uint32 NUMBER_DECODED_BUFFERS = 8;
+
 /** ****************************************************************************
 *** \brief Represents an OpenAL buffer
 ***
@@ -187,13 +190,14 @@ public:
 	/** \brief Loads a new piece of audio data from a file
 	*** \param filename The name of the file that contains the new audio data (should have a .wav or .ogg file extension)
 	*** \param load_type The type of loading to perform (default == AUDIO_LOAD_STATIC)
-	*** \param stream_buffer_size If the loading type is streaming, the buffer size to use (default == DEFAULT_BUFFER_SIZE)
+	*** \param stream_buffer_size If the loading type is streaming, the buffer size to use in samples
+	*** (default == 0, the AudioEngine streaming buffer size)
 	*** \return True if the audio was succesfully loaded, false if there was an error
 	***
 	*** The action taken by this function depends on the load type selected. For static sounds, a single OpenAL buffer is
 	*** filled. For streaming, the file/memory is prepared.
 	**/
-	virtual bool LoadAudio(const std::string& filename, AUDIO_LOAD load_type = AUDIO_LOAD_STATIC, uint32 stream_buffer_size = private_audio::DEFAULT_BUFFER_SIZE);
+	virtual bool LoadAudio(const std::string& filename, AUDIO_LOAD load_type = AUDIO_LOAD_STATIC, uint32 stream_buffer_size = 0);
 
 	/** \brief Frees all data resources and resets class parameters
 	***
@@ -204,6 +208,10 @@ public:
 	const std::string GetFilename() const
 		{ if (_input == NULL) return ""; else return _input->GetFilename(); }
 
+	//! \brief Returns the size of the audio data held by OpenAL, or 0 if the audio is streamed or not loaded
+	uint32 GetStaticDataSize() const
+		{ if (_input == NULL || _stream != NULL) return 0; else return _input->GetDataSize(); }
+
 	//! \brief Returns true if this audio represents a sound, false if the audio represents a music piece
 	virtual bool IsSound() const = 0;
 
@@ -350,6 +358,24 @@ protected:
 	//! \brief A pointer to the stream object (set to NULL if the audio was loaded statically)
 	private_audio::AudioStream* _stream;
 
+	/** \brief The audio data decoded in advance by the streaming thread (NULL if the audio was loaded statically)
+	*** \note The stream and its input are used by the streaming thread, so they must only be
+	*** accessed while holding the AudioEngine streaming lock once the audio is loaded.
+	**/
+	private_audio::PCMRing* _pcm_ring;
+
+	//! \brief The number of OpenAL buffers in _buffer
+	uint32 _number_buffers;
+
+	//! \brief The streaming buffers which aren't queued on the source
+	std::vector<ALuint> _free_buffers;
+
+	//! \brief Set once the last data of a non-looping stream was queued on the source
+	bool _stream_ended;
+
+	//! \brief Set while the source of a stream is starved, so that each underrun is only counted once
+	bool _stream_starved;
+
 	//! \brief A pointer to where the data is streamed to
 	uint8* _data;
 
@@ -427,6 +453,43 @@ private:
 	*** ones must be refilled. This function should only be called for streaming audio.
 	**/
 	void _PrepareStreamingBuffers();
+
+	/** \brief Decodes the stream data until the PCM ring is full or the stream has ended
+	*** This is called by the streaming thread, or by the main thread when it needs data right away.
+	*** \note The AudioEngine streaming lock must be held when calling this function.
+	**/
+	void _DecodeStream();
+
+	/** \brief Fills the free streaming buffers with the decoded data and queues them on the source
+	*** This is only called by the main thread.
+	**/
+	void _QueueDecodedBuffers();
+
+	/** \brief Creates the input object reading the audio file, and sets the audio format
+	*** \param filename The name of the file, whose extension gives the input type
+	*** \return False if the file could not be opened
+	**/
+	bool _OpenInput(const std::string& filename);
+
+	/** \brief Reads and decodes the whole audio data of the input into _data
+	*** \return False if the data could not be entirely read
+	*** \note This function and _OpenInput() don't use OpenAL, so that static audio may be
+	*** decoded by the audio loading thread.
+	**/
+	bool _ReadStaticData();
+
+	//! \brief Hands the data read by _ReadStaticData() over to an OpenAL buffer, and frees it
+	void _FillStaticBuffer();
+
+	/** \brief Ends a static load started by _OpenInput() and _ReadStaticData() on another thread
+	*** This is only called by the main thread, which is then the only one using the audio.
+	**/
+	void _FinishStaticLoad();
+
+	/** \brief Seeks the stream and discards the data already decoded
+	*** \param sample The sample position to seek to
+	**/
+	void _SeekStream(uint32 sample);
 }; // class AudioDescriptor
 
 
@@ -470,7 +533,7 @@ public:
 
 	MusicDescriptor(const MusicDescriptor& copy);
 
-	bool LoadAudio(const std::string& filename, AUDIO_LOAD load_type = AUDIO_LOAD_STREAM_FILE, uint32 stream_buffer_size = private_audio::DEFAULT_BUFFER_SIZE);
+	bool LoadAudio(const std::string& filename, AUDIO_LOAD load_type = AUDIO_LOAD_STREAM_FILE, uint32 stream_buffer_size = 0);
 
 	bool IsSound() const
 		{ return false; }
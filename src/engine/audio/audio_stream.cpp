@@ -63,8 +63,9 @@ uint32 AudioStream::FillBuffer(uint8* buffer, uint32 size) {
 		uint32 remaining_data = (_looping == true) ? _loop_end_position : _audio_input->GetTotalNumberSamples();
 		remaining_data -= _read_position;
 		read_samples = (size - num_samples_read < remaining_data) ? size - num_samples_read : remaining_data;
-		num_samples_read += _audio_input->Read(buffer + num_samples_read * _audio_input->GetSampleSize(), read_samples, _end_of_stream);
-		_read_position += num_samples_read;
+		read_samples = _audio_input->Read(buffer + num_samples_read * _audio_input->GetSampleSize(), read_samples, _end_of_stream);
+		num_samples_read += read_samples;
+		_read_position += read_samples;
 
 		// Detect early exit condition
 		if (_looping == false && _end_of_stream == true) {
@@ -109,6 +110,71 @@ void AudioStream::SetLoopEnd(uint32 sample) {
 	_loop_end_position = sample;
 }
 
+// -----------------------------------------------------------------------------
+// PCMRing class
+// -----------------------------------------------------------------------------
+
+namespace {
+
+//! \brief Keeps the compiler and the processor from reordering memory accesses across the call
+inline void MemoryFence() {
+	__sync_synchronize();
+}
+
+} // namespace
+
+
+
+PCMRing::PCMRing(uint32 num_blocks, uint32 block_size) :
+	_blocks(num_blocks),
+	_write_count(0),
+	_read_count(0)
+{
+	for (uint32 i = 0; i < _blocks.size(); ++i)
+		_blocks[i].data.resize(block_size);
+}
+
+
+
+PCMBlock* PCMRing::GetWriteBlock() {
+	if (_write_count - _read_count >= _blocks.size())
+		return NULL;
+
+	// Don't overwrite the block before the consumer is done reading it
+	MemoryFence();
+	PCMBlock* block = &_blocks[_write_count % _blocks.size()];
+	block->size = 0;
+	block->end_of_stream = false;
+	return block;
+}
+
+
+
+void PCMRing::CommitWriteBlock() {
+	// Publish the block content before the block itself
+	MemoryFence();
+	_write_count = _write_count + 1;
+}
+
+
+
+const PCMBlock* PCMRing::GetReadBlock() const {
+	if (_read_count == _write_count)
+		return NULL;
+
+	// Don't read the block content before it was published
+	MemoryFence();
+	return &_blocks[_read_count % _blocks.size()];
+}
+
+
+
+void PCMRing::ReleaseReadBlock() {
+	// Finish reading the block before handing it back
+	MemoryFence();
+	_read_count = _read_count + 1;
+}
+
 } // namespace private_audio
 
 } // namespace hoa_audio
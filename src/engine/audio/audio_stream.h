@@ -32,6 +32,8 @@
 
 #include "audio_input.h"
 
+#include <vector>
+
 namespace hoa_audio {
 
 namespace private_audio {
@@ -121,6 +123,89 @@ private:
 	bool _end_of_stream;
 }; // class AudioStream
 
+
+/** ****************************************************************************
+*** \brief A block of decoded audio data
+*** ***************************************************************************/
+class PCMBlock {
+public:
+	PCMBlock() :
+		size(0), end_of_stream(false) {}
+
+	//! \brief The decoded audio data
+	std::vector<uint8> data;
+
+	//! \brief The number of bytes of valid data
+	uint32 size;
+
+	//! \brief Set when the block holds the last samples of a non-looping stream
+	bool end_of_stream;
+}; // class PCMBlock
+
+
+/** ****************************************************************************
+*** \brief A ring of decoded audio blocks shared by the streaming thread and the main thread
+***
+*** The audio streaming thread is the only producer of blocks and the main thread
+*** the only consumer. Each side only ever moves its own counter, and the block
+*** content is published before the counter moving past it, so the ring is used
+*** without any lock.
+***
+*** \note Clear() must only be called while the producer is known not to be using
+*** the ring, that is to say while holding the audio streaming lock.
+*** ***************************************************************************/
+class PCMRing {
+public:
+	/** \param num_blocks The number of blocks in the ring
+	*** \param block_size The size of each block in bytes
+	**/
+	PCMRing(uint32 num_blocks, uint32 block_size);
+
+	~PCMRing()
+		{}
+
+	/** \name Producer Functions
+	*** \brief Called by the thread decoding the audio
+	**/
+	//@{
+	//! \brief Returns the next block to fill, or NULL if the ring is full
+	PCMBlock* GetWriteBlock();
+
+	//! \brief Hands the block last returned by GetWriteBlock() over to the consumer
+	void CommitWriteBlock();
+	//@}
+
+	/** \name Consumer Functions
+	*** \brief Called by the thread queuing the audio buffers
+	**/
+	//@{
+	//! \brief Returns the oldest decoded block, or NULL if the ring is empty
+	const PCMBlock* GetReadBlock() const;
+
+	//! \brief Gives the block last returned by GetReadBlock() back to the producer
+	void ReleaseReadBlock();
+	//@}
+
+	//! \brief Discards every decoded block
+	void Clear()
+		{ _read_count = _write_count; }
+
+	uint32 GetNumberBlocks() const
+		{ return _blocks.size(); }
+
+private:
+	//! \brief The blocks of the ring
+	std::vector<PCMBlock> _blocks;
+
+	/** \brief The number of blocks ever committed and released
+	*** Their difference is the number of blocks ready to be consumed.
+	**/
+	//@{
+	volatile uint32 _write_count;
+	volatile uint32 _read_count;
+	//@}
+}; // class PCMRing
+
 } // namespace private_audio
 
 } // namespace hoa_audio
@@ -179,7 +179,7 @@ void EffectSupervisor::EnableLightning(int16 id, bool loop) {
 			it_end = _lightning_inner_info._lightning_sound_events.at(id).end(); it != it_end; ++it) {
 			_lightning_inner_info._current_lightning_sound_events.push_back(*it);
 			// Preload the files for efficiency
-			hoa_audio::AudioManager->LoadSound(it->sound_filename);
+			hoa_audio::AudioManager->PreloadSound(it->sound_filename);
 		}
 	}
 	else {
@@ -107,6 +107,8 @@ void BindEngineCode() {
 		luabind::class_<ParticleManager>("ParticleManager")
 			.def("AddParticleEffect", &ParticleManager::AddParticleEffect)
 			.def("RestartParticleEffect", &ParticleManager::RestartParticleEffect)
+			.def("PreloadEffect", &ParticleManager::PreloadEffect)
+			.def("PurgeEffect", &ParticleManager::PurgeEffect)
 			.def("StopAll", &ParticleManager::StopAll)
 	];
 
@@ -14,6 +14,7 @@
 *** **************************************************************************/
 
 #include "engine/input.h"
+#include "engine/profiler.h"
 #include "engine/video/video.h"
 #include "engine/script/script_read.h"
 
@@ -336,6 +337,25 @@ void InputEngine::_KeyEventHandler(SDL_KeyboardEvent& key_event) {
 				VideoManager->Textures()->DEBUG_NextTexSheet();
 				return;
 			}
+			else if (key_event.keysym.sym == SDLK_p) {
+				// Toggle the frame profiler and its overlay
+				ProfilerManager->ToggleEnabled();
+				return;
+			}
+			else if (key_event.keysym.sym == SDLK_e) {
+				// Write the profiled frames in a Chrome trace file
+				static uint32 i = 1;
+				string path = "";
+				while (true)
+				{
+					path = hoa_utils::GetUserDataPath(true) + "profile_trace_" + NumberToString<uint32>(i) + ".json";
+					if (!DoesFileExist(path))
+						break;
+					i++;
+				}
+				ProfilerManager->WriteTrace(path);
+				return;
+			}
 #endif
 
 			//return;
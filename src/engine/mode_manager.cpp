@@ -18,6 +18,7 @@
 
 #include "engine/video/video.h"
 #include "engine/audio/audio.h"
+#include "engine/script/script.h"
 
 #include "modes/mode_help_window.h"
 
@@ -28,6 +29,7 @@ using namespace hoa_system;
 using namespace hoa_boot;
 using namespace hoa_video;
 using namespace hoa_audio;
+using namespace hoa_script;
 
 template<> hoa_mode_manager::ModeEngine* Singleton<hoa_mode_manager::ModeEngine>::_singleton_reference = NULL;
 
@@ -38,6 +40,11 @@ bool MODE_MANAGER_DEBUG = false;
 
 const uint32 FADE_IN_OUT_TIME = 800;
 
+/** \brief The texture sheet occupancy under which the sheets are defragmented on a mode change
+*** The map and battle loads always defragment them, the other modes leave few holes.
+**/
+const float DEFRAGMENT_OCCUPANCY = 0.5f;
+
 // ****************************************************************************
 // ***** GameMode class
 // ****************************************************************************
@@ -245,6 +252,11 @@ void ModeEngine::Update() {
 			_pop_count--;
 		}
 
+		// Only repack the texture sheets when the popped game modes left many holes in them,
+		// as that reads the sheets back and makes the static image batches rebuild their geometry
+		if (TextureManager->GetTexSheetOccupancy() < DEFRAGMENT_OCCUPANCY)
+			TextureManager->DefragmentTexSheets();
+
 		// Push any new game modes onto the true game stack.
 		while (_push_stack.size() != 0) {
 			_game_stack.push_back(_push_stack.back());
@@ -260,6 +272,11 @@ void ModeEngine::Update() {
 		// Call the newly active game mode's Reset() function to re-initialize the game mode
 		_game_stack.back()->Reset();
 
+		// Report how many script files were parsed to leave the previous game mode and set up the new one
+		if (MODE_MANAGER_DEBUG) cout << "MODE MANAGER: " << ScriptManager->GetOpenedFilesCount()
+			<< " script files opened since the last mode change" << endl;
+		ScriptManager->ResetOpenedFilesCount();
+
 		// Reset the state change variable
 		_state_change = false;
 
@@ -44,6 +44,7 @@ const uint8 MODE_MANAGER_PAUSE_MODE  = 6;
 const uint8 MODE_MANAGER_SCENE_MODE  = 7;
 const uint8 MODE_MANAGER_WORLD_MODE  = 8;
 const uint8 MODE_MANAGER_SAVE_MODE   = 9;
+const uint8 MODE_MANAGER_LOADING_MODE = 10;
 //@}
 
 /** ***************************************************************************
@@ -0,0 +1,281 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   profiler.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Source file for the frame profiler
+*** **************************************************************************/
+
+#include "engine/profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+using namespace hoa_utils;
+
+template<> hoa_system::ProfilerEngine* Singleton<hoa_system::ProfilerEngine>::_singleton_reference = NULL;
+
+namespace hoa_system {
+
+ProfilerEngine* ProfilerManager = NULL;
+
+//! \brief How much the zone times of the last frame weigh in the averaged zone times
+const float PROFILER_AVERAGE_FACTOR = 0.05f;
+
+//! \brief The names of the zones registered so far, shared by all the threads
+//@{
+static const char* zone_names[PROFILER_MAX_ZONES];
+static volatile uint32 number_zones = 0;
+//@}
+
+//! \brief Guards the zone names while a zone is registered
+static volatile int32 zone_lock = 0;
+
+//! \brief Adds one to a value shared by several threads, and returns its previous value
+static uint32 AtomicIncrement(volatile uint32* value) {
+#ifdef _MSC_VER
+	return InterlockedIncrement(reinterpret_cast<volatile LONG*>(value)) - 1;
+#else
+	return __sync_fetch_and_add(value, 1);
+#endif
+}
+
+static void LockZones() {
+#ifdef _MSC_VER
+	while (InterlockedExchange(reinterpret_cast<volatile LONG*>(&zone_lock), 1) != 0)
+		SDL_Delay(0);
+#else
+	while (__sync_lock_test_and_set(&zone_lock, 1) != 0)
+		SDL_Delay(0);
+#endif
+}
+
+static void UnlockZones() {
+#ifdef _MSC_VER
+	InterlockedExchange(reinterpret_cast<volatile LONG*>(&zone_lock), 0);
+#else
+	__sync_lock_release(&zone_lock);
+#endif
+}
+
+//! \brief Makes the writes done so far visible to the other threads before the next ones
+static void SynchronizeMemory() {
+#ifdef _MSC_VER
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+//! \brief Escapes the characters of a string which can't appear as is in a JSON string
+static string EscapeJSONString(const char* text) {
+	string escaped;
+	for (const char* c = text; *c != '\0'; ++c) {
+		if (*c == '"' || *c == '\\')
+			escaped += '\\';
+		escaped += *c;
+	}
+	return escaped;
+}
+
+
+
+ProfilerEngine::ProfilerEngine() :
+	_enabled(false),
+	_current_frame(0),
+	_number_frames(0),
+	_main_thread(0),
+	_dropped_events(0)
+{
+	IF_PRINT_DEBUG(SYSTEM_DEBUG) << "constructor invoked" << endl;
+}
+
+
+
+ProfilerEngine::~ProfilerEngine() {
+	IF_PRINT_DEBUG(SYSTEM_DEBUG) << "destructor invoked" << endl;
+}
+
+
+
+bool ProfilerEngine::SingletonInitialize() {
+	return true;
+}
+
+
+
+uint32 ProfilerEngine::RegisterZone(const char* name) {
+	LockZones();
+	uint32 zone = 0;
+	while (zone < number_zones && strcmp(zone_names[zone], name) != 0)
+		++zone;
+
+	if (zone == PROFILER_MAX_ZONES) {
+		// The last zone gathers the zones which didn't fit
+		PRINT_WARNING << "too many profile zones, merging: " << name << endl;
+		zone = PROFILER_MAX_ZONES - 1;
+		zone_names[zone] = "Other zones";
+	}
+	else if (zone == number_zones) {
+		zone_names[zone] = name;
+		SynchronizeMemory();
+		number_zones = zone + 1;
+	}
+	UnlockZones();
+	return zone;
+}
+
+
+
+uint32 ProfilerEngine::GetNumberZones() {
+	return number_zones;
+}
+
+
+
+const char* ProfilerEngine::GetZoneName(uint32 zone) {
+	return zone_names[zone];
+}
+
+
+
+void ProfilerEngine::SetEnabled(bool enabled) {
+	if (enabled == _enabled)
+		return;
+
+	if (enabled == false) {
+		_enabled = false;
+		return;
+	}
+
+	// The frames are only allocated once the profiler is used
+	if (_frames.empty())
+		_frames.resize(PROFILER_HISTORY_FRAMES);
+
+	_main_thread = SDL_ThreadID();
+	_current_frame = 0;
+	_number_frames = 0;
+	_frames[0].start_time = GetMicroseconds();
+	_frames[0].end_time = 0;
+	_frames[0].number_events = 0;
+	_zone_times.clear();
+	_average_zone_times.clear();
+	_dropped_events = 0;
+	SynchronizeMemory();
+	_enabled = true;
+}
+
+
+
+void ProfilerEngine::BeginFrame() {
+	if (_enabled == false)
+		return;
+
+	Uint64 current_time = GetMicroseconds();
+	Frame& frame = _frames[_current_frame];
+	frame.end_time = current_time;
+
+	// Sum the zone times of the frame just completed
+	uint32 number_added_events = frame.number_events;
+	uint32 number_events = std::min(number_added_events, PROFILER_MAX_FRAME_EVENTS);
+	_dropped_events = number_added_events - number_events;
+	_zone_times.assign(GetNumberZones(), 0.0f);
+	for (uint32 i = 0; i < number_events; ++i) {
+		const ProfileEvent& event = frame.events[i];
+		if (event.zone < _zone_times.size())
+			_zone_times[event.zone] += event.duration / 1000.0f;
+	}
+
+	_average_zone_times.resize(_zone_times.size(), 0.0f);
+	for (uint32 i = 0; i < _zone_times.size(); ++i)
+		_average_zone_times[i] += (_zone_times[i] - _average_zone_times[i]) * PROFILER_AVERAGE_FACTOR;
+
+	// Start the next frame, overwriting the oldest one
+	uint32 next_frame = (_current_frame + 1) % PROFILER_HISTORY_FRAMES;
+	_frames[next_frame].start_time = current_time;
+	_frames[next_frame].end_time = 0;
+	_frames[next_frame].number_events = 0;
+	SynchronizeMemory();
+	_current_frame = next_frame;
+
+	if (_number_frames < PROFILER_HISTORY_FRAMES - 1)
+		++_number_frames;
+}
+
+
+
+void ProfilerEngine::RecordEvent(uint32 zone, Uint64 start, Uint64 end) {
+	if (_frames.empty())
+		return;
+
+	Frame& frame = _frames[_current_frame];
+	uint32 index = AtomicIncrement(&frame.number_events);
+	if (index >= PROFILER_MAX_FRAME_EVENTS)
+		return;
+
+	ProfileEvent& event = frame.events[index];
+	event.zone = zone;
+	event.thread = SDL_ThreadID();
+	event.start = start;
+	event.duration = static_cast<uint32>(end - start);
+}
+
+
+
+bool ProfilerEngine::WriteTrace(const std::string& filename) const {
+	if (_number_frames == 0) {
+		PRINT_WARNING << "no frame was recorded, the profiler must be enabled first" << endl;
+		return false;
+	}
+
+	ofstream file(filename.c_str());
+	if (!file) {
+		PRINT_ERROR << "could not open the trace file: " << filename << endl;
+		return false;
+	}
+
+	// The complete frames, oldest first
+	uint32 first_frame = (_current_frame + PROFILER_HISTORY_FRAMES - _number_frames) % PROFILER_HISTORY_FRAMES;
+	Uint64 origin = _frames[first_frame].start_time;
+
+	file << "{\"traceEvents\":[" << endl;
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << _main_thread << ",\"args\":{\"name\":\"Main loop\"}}";
+	for (uint32 i = 0; i < _number_frames; ++i) {
+		const Frame& frame = _frames[(first_frame + i) % PROFILER_HISTORY_FRAMES];
+		file << "," << endl << "{\"name\":\"Frame\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":"
+			<< static_cast<uint32>(frame.start_time - origin) << ",\"dur\":"
+			<< static_cast<uint32>(frame.end_time - frame.start_time) << ",\"pid\":1,\"tid\":" << _main_thread << "}";
+
+		uint32 number_events = std::min(static_cast<uint32>(frame.number_events), PROFILER_MAX_FRAME_EVENTS);
+		for (uint32 j = 0; j < number_events; ++j) {
+			const ProfileEvent& event = frame.events[j];
+			if (event.zone >= GetNumberZones() || event.start < origin)
+				continue;
+
+			file << "," << endl << "{\"name\":\"" << EscapeJSONString(GetZoneName(event.zone)) << "\",\"cat\":\"zone\",\"ph\":\"X\",\"ts\":"
+				<< static_cast<uint32>(event.start - origin) << ",\"dur\":" << event.duration
+				<< ",\"pid\":1,\"tid\":" << event.thread << "}";
+		}
+	}
+	file << endl << "]}" << endl;
+
+	if (!file) {
+		PRINT_ERROR << "could not write the trace file: " << filename << endl;
+		return false;
+	}
+
+	return true;
+} // bool ProfilerEngine::WriteTrace(const std::string& filename) const
+
+} // namespace hoa_system
@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   profiler.h
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Header file for the frame profiler
+***
+*** The profiler measures the time spent in the zones of code marked with the
+*** PROFILE_ZONE() macro. A zone lasts until the end of the block it is declared
+*** in. The zones entered during a frame are recorded as events in a fixed
+*** size buffer, which any thread may add events to without locking. The
+*** events of the last frames are kept, so that they can be written in the
+*** Chrome trace format (chrome://tracing) when a frame spike was seen.
+***
+*** Nothing is recorded while the profiler is disabled.
+*** **************************************************************************/
+
+#ifndef __PROFILER_HEADER__
+#define __PROFILER_HEADER__
+
+#include "utils.h"
+#include "defs.h"
+
+#include "engine/system.h"
+
+//! \brief Measures the time spent until the end of the current block, under the given zone name
+#define PROFILE_ZONE(name) \
+	static const uint32 PROFILE_CONCAT(_profile_zone_, __LINE__) = hoa_system::ProfilerEngine::RegisterZone(name); \
+	hoa_system::ProfileScope PROFILE_CONCAT(_profile_scope_, __LINE__)(PROFILE_CONCAT(_profile_zone_, __LINE__))
+
+//! \brief Pastes two tokens, once the macros they hold are expanded
+//@{
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_EXPANDED(a, b)
+#define PROFILE_CONCAT_EXPANDED(a, b) a##b
+//@}
+
+namespace hoa_system {
+
+class ProfilerEngine;
+
+//! \brief The singleton pointer responsible for the frame profiler, or NULL when it isn't created
+extern ProfilerEngine* ProfilerManager;
+
+//! \brief The maximum number of events recorded during a frame. Further events are dropped.
+const uint32 PROFILER_MAX_FRAME_EVENTS = 1024;
+
+//! \brief The number of frames whose events are kept
+const uint32 PROFILER_HISTORY_FRAMES = 60;
+
+//! \brief The maximum number of zone names
+const uint32 PROFILER_MAX_ZONES = 128;
+
+//! \brief The time spent in a zone, as recorded by the profiler
+class ProfileEvent {
+public:
+	//! \brief The index of the zone name
+	uint32 zone;
+
+	//! \brief The SDL id of the thread the zone was entered by
+	uint32 thread;
+
+	//! \brief The time the zone was entered at, in microseconds
+	Uint64 start;
+
+	//! \brief The time spent in the zone, in microseconds
+	uint32 duration;
+}; // class ProfileEvent
+
+
+/** ****************************************************************************
+*** \brief Records the time spent in the profile zones, frame after frame
+***
+*** The main loop calls BeginFrame() once per frame. The zone times of the last
+*** complete frame are summed and averaged for the profiler overlay drawn by
+*** the video engine.
+***
+*** \note This class is a singleton.
+*** ***************************************************************************/
+class ProfilerEngine : public hoa_utils::Singleton<ProfilerEngine> {
+	friend class hoa_utils::Singleton<ProfilerEngine>;
+
+public:
+	~ProfilerEngine();
+
+	bool SingletonInitialize();
+
+	/** \brief Returns the index of a zone name, adding it if needed
+	*** \param name The name of the zone, which must remain valid until the program exits
+	***
+	*** The zone names don't depend on the profiler object, so that the zones can be
+	*** declared before it is created. This function may be called by any thread.
+	**/
+	static uint32 RegisterZone(const char* name);
+
+	//! \brief Returns the number of zone names registered so far
+	static uint32 GetNumberZones();
+
+	//! \brief Returns the name of a zone
+	static const char* GetZoneName(uint32 zone);
+
+	//! \brief Starts a new frame. Only called by the main loop.
+	void BeginFrame();
+
+	/** \brief Adds an event to the current frame
+	*** This function may be called by any thread, without locking. The events added by
+	*** other threads while the main loop starts a new frame may be lost.
+	**/
+	void RecordEvent(uint32 zone, Uint64 start, Uint64 end);
+
+	/** \brief Writes the events of the last frames in the Chrome trace format
+	*** \param filename The name of the JSON file to write
+	*** \return False if the file could not be written
+	**/
+	bool WriteTrace(const std::string& filename) const;
+
+	//! \brief Enables or disables the event recording. The recorded frames are dropped.
+	void SetEnabled(bool enabled);
+
+	void ToggleEnabled()
+		{ SetEnabled(!_enabled); }
+
+	bool IsEnabled() const
+		{ return _enabled; }
+
+	//! \brief Returns the time spent in each zone during the last complete frame, in milliseconds
+	const std::vector<float>& GetZoneTimes() const
+		{ return _zone_times; }
+
+	//! \brief Returns the time spent in each zone, averaged over the last frames, in milliseconds
+	const std::vector<float>& GetAverageZoneTimes() const
+		{ return _average_zone_times; }
+
+	//! \brief Returns the number of events dropped during the last complete frame because its buffer was full
+	uint32 GetNumberDroppedEvents() const
+		{ return _dropped_events; }
+
+private:
+	ProfilerEngine();
+
+	//! \brief The events recorded during a frame
+	struct Frame {
+		//! \brief The time the frame started and ended at, in microseconds
+		Uint64 start_time, end_time;
+
+		//! \brief The number of events added to the frame, including the dropped ones
+		volatile uint32 number_events;
+
+		ProfileEvent events[PROFILER_MAX_FRAME_EVENTS];
+	};
+
+	//! \brief Whether the events are recorded
+	volatile bool _enabled;
+
+	//! \brief The recorded frames, used as a circular array
+	std::vector<Frame> _frames;
+
+	//! \brief The index of the frame the events are added to
+	volatile uint32 _current_frame;
+
+	//! \brief The number of complete frames recorded, up to PROFILER_HISTORY_FRAMES - 1
+	uint32 _number_frames;
+
+	//! \brief The SDL id of the thread running the main loop
+	uint32 _main_thread;
+
+	//! \brief The zone times of the last complete frame and their average, in milliseconds
+	//@{
+	std::vector<float> _zone_times;
+	std::vector<float> _average_zone_times;
+	//@}
+
+	uint32 _dropped_events;
+}; // class ProfilerEngine : public hoa_utils::Singleton<ProfilerEngine>
+
+
+/** ****************************************************************************
+*** \brief Records the time spent from its construction to its destruction
+***
+*** Declared through the PROFILE_ZONE() macro.
+*** ***************************************************************************/
+class ProfileScope {
+public:
+	ProfileScope(uint32 zone) :
+		_zone(zone), _start(0)
+		{ if (ProfilerManager != NULL && ProfilerManager->IsEnabled()) _start = GetMicroseconds(); }
+
+	~ProfileScope()
+		{ if (_start != 0) ProfilerManager->RecordEvent(_zone, _start, GetMicroseconds()); }
+
+private:
+	uint32 _zone;
+
+	//! \brief The time the zone was entered at, or 0 when the profiler was disabled
+	Uint64 _start;
+}; // class ProfileScope
+
+} // namespace hoa_system
+
+#endif // __PROFILER_HEADER__
@@ -15,8 +15,10 @@
 *** \brief   Source file for the scripting engine.
 *** ***************************************************************************/
 
+#include <algorithm>
 #include <iostream>
 #include <stdarg.h>
+#include <sys/stat.h>
 
 #include "script.h"
 #include "script_read.h"
@@ -34,11 +36,101 @@ namespace hoa_script {
 ScriptEngine* ScriptManager = NULL;
 bool SCRIPT_DEBUG = false;
 
+namespace {
+
+//! \brief Gets the modification stamp of a file, returns false if the file couldn't be examined.
+bool GetFileStamp(const std::string& filename, FileStamp& stamp) {
+	struct stat file_info;
+	if (stat(filename.c_str(), &file_info) != 0)
+		return false;
+
+	stamp.modification_time = static_cast<uint32>(file_info.st_mtime);
+	stamp.size = static_cast<uint32>(file_info.st_size);
+	return true;
+}
+
+
+
+//! \brief The lua_dump() writer, appending the bytecode chunks to a string.
+int32 WriteBytecodeChunk(lua_State* /*lstack*/, const void* data, size_t size, void* bytecode) {
+	static_cast<std::string*>(bytecode)->append(static_cast<const char*>(data), size);
+	return 0;
+}
+
+
+
+/** \brief Reads the bytecode stored in a cache file
+*** \param cache_filename The cache file to read
+*** \param filename The script file the bytecode must have been compiled from
+*** \param stamp The current stamp of the script file
+*** \param bytecode Filled with the bytecode
+*** \return False if the cache file is missing, invalid or outdated.
+**/
+bool ReadBytecodeCache(const std::string& cache_filename, const std::string& filename,
+	const FileStamp& stamp, std::string& bytecode)
+{
+	ifstream cache_file(cache_filename.c_str(), ios::in | ios::binary);
+	if (!cache_file)
+		return false;
+
+	// Magic, format version, Lua version, modification time, size and file name length
+	uint32 header[6];
+	if (!cache_file.read(reinterpret_cast<char*>(header), sizeof(header)))
+		return false;
+
+	if (header[0] != BYTECODE_CACHE_MAGIC || header[1] != BYTECODE_CACHE_VERSION || header[2] != LUA_VERSION_NUM
+			|| header[3] != stamp.modification_time || header[4] != stamp.size || header[5] != filename.size())
+		return false;
+
+	// Different files may share a cache file name, so the full file name is checked as well
+	std::string cached_filename(header[5], '\0');
+	if (!cache_file.read(&cached_filename[0], cached_filename.size()) || cached_filename != filename)
+		return false;
+
+	bytecode.assign(istreambuf_iterator<char>(cache_file), istreambuf_iterator<char>());
+	return (bytecode.empty() == false);
+} // bool ReadBytecodeCache(...)
+
+
+
+//! \brief Writes a cache file, using the same layout as the one expected by ReadBytecodeCache()
+void WriteBytecodeCache(const std::string& cache_filename, const std::string& filename,
+	const FileStamp& stamp, const std::string& bytecode)
+{
+	ofstream cache_file(cache_filename.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!cache_file) {
+		IF_PRINT_WARNING(SCRIPT_DEBUG) << "could not create the bytecode cache file: " << cache_filename << endl;
+		return;
+	}
+
+	uint32 header[6] = { BYTECODE_CACHE_MAGIC, BYTECODE_CACHE_VERSION, LUA_VERSION_NUM,
+		stamp.modification_time, stamp.size, static_cast<uint32>(filename.size()) };
+	cache_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	cache_file.write(filename.data(), filename.size());
+	cache_file.write(bytecode.data(), bytecode.size());
+	cache_file.close();
+
+	// Don't leave a truncated file behind
+	if (!cache_file)
+		DeleteFile(cache_filename);
+} // void WriteBytecodeCache(...)
+
+} // namespace
+
 //-----------------------------------------------------------------------------
 // ScriptEngine Class Functions
 //-----------------------------------------------------------------------------
 
-ScriptEngine::ScriptEngine() {
+ScriptEngine::ScriptEngine() :
+	_opened_files_count(0),
+	_gc_stepped(false),
+	_gc_cycle_running(false),
+	_gc_threshold(GC_MIN_THRESHOLD),
+	_gc_budget(static_cast<uint32>(DEFAULT_GC_FRAME_BUDGET * 1000.0f)),
+	_gc_step_time(0),
+	_gc_full_collection_time(0),
+	_gc_cycle_count(0)
+{
 	IF_PRINT_DEBUG(SCRIPT_DEBUG) << "ScriptEngine constructor invoked." << endl;
 
 	// Initialize Lua and LuaBind
@@ -53,6 +145,7 @@ ScriptEngine::~ScriptEngine() {
 	IF_PRINT_DEBUG(SCRIPT_DEBUG) << "ScriptEngine destructor invoked." << endl;
 
 	_open_files.clear();
+	_reusable_threads.clear();
 	lua_close(_global_state);
 	_global_state = NULL;
 }
@@ -60,6 +153,13 @@ ScriptEngine::~ScriptEngine() {
 
 
 bool ScriptEngine::SingletonInitialize() {
+	// A missing cache folder only disables the bytecode cache
+	std::string cache_path = GetUserDataPath(true) + "script_cache/";
+	if (DoesFileExist(cache_path) || MakeDirectory(cache_path))
+		_bytecode_cache_path = cache_path;
+	else
+		IF_PRINT_WARNING(SCRIPT_DEBUG) << "could not create the bytecode cache folder: " << cache_path << endl;
+
 	return true;
 }
 
@@ -93,16 +193,87 @@ void ScriptEngine::HandleCastError(luabind::cast_failed& err) {
 
 
 
+void ScriptEngine::StepGarbageCollector(uint32 slack) {
+	Uint64 start_time = hoa_system::GetMicroseconds();
+	_gc_step_time = 0;
+
+	// From now on, the collector only runs when asked to
+	if (!_gc_stepped) {
+		lua_gc(_global_state, LUA_GCSTOP, 0);
+		_gc_stepped = true;
+	}
+
+	uint32 heap_size = GetHeapSize();
+	if (!_gc_cycle_running) {
+		if (heap_size < _gc_threshold)
+			return;
+		_gc_cycle_running = true;
+	}
+
+	// The slack is ignored when the heap keeps growing during the cycle
+	uint32 budget = _gc_budget;
+	if (heap_size < _gc_threshold * GC_PAUSE_FACTOR)
+		budget = std::min(budget, slack);
+
+	Uint64 end_time = start_time + budget;
+	do {
+		// A non zero value is returned once the cycle has completed
+		if (lua_gc(_global_state, LUA_GCSTEP, GC_STEP_SIZE) != 0) {
+			_EndGarbageCollection();
+			break;
+		}
+	} while (hoa_system::GetMicroseconds() < end_time);
+
+	// Lua 5.1 restarts the automatic collector after a step
+	lua_gc(_global_state, LUA_GCSTOP, 0);
+	_gc_step_time = static_cast<uint32>(hoa_system::GetMicroseconds() - start_time);
+}
+
+
+
+void ScriptEngine::CollectAllGarbage() {
+	Uint64 start_time = hoa_system::GetMicroseconds();
+
+	lua_gc(_global_state, LUA_GCCOLLECT, 0);
+	if (_gc_stepped)
+		lua_gc(_global_state, LUA_GCSTOP, 0);
+	_EndGarbageCollection();
+
+	_gc_full_collection_time = static_cast<uint32>(hoa_system::GetMicroseconds() - start_time);
+}
+
+
+
+void ScriptEngine::SetGarbageCollectorBudget(float budget) {
+	if (budget < 0.0f) {
+		IF_PRINT_WARNING(SCRIPT_DEBUG) << "tried to set a negative garbage collector budget: " << budget << endl;
+		return;
+	}
+	_gc_budget = static_cast<uint32>(budget * 1000.0f);
+}
+
+
+
+uint32 ScriptEngine::GetHeapSize() const {
+	return static_cast<uint32>(lua_gc(_global_state, LUA_GCCOUNT, 0)) * 1024
+		+ static_cast<uint32>(lua_gc(_global_state, LUA_GCCOUNTB, 0));
+}
+
+
+
+void ScriptEngine::_EndGarbageCollection() {
+	_gc_cycle_running = false;
+	++_gc_cycle_count;
+	_gc_threshold = std::max(GetHeapSize() * GC_PAUSE_FACTOR, GC_MIN_THRESHOLD);
+}
+
+
+
 void ScriptEngine::_AddOpenFile(ScriptDescriptor* sd) {
 	// NOTE: This function assumes that the file is not already open
 
 	_open_files.insert(make_pair(sd->_filename, sd));
-	// Add the lua_State to the list of opened lua states if it is not already present
-	if (sd->GetAccessMode() == SCRIPT_READ || sd->GetAccessMode() == SCRIPT_MODIFY) {
-		ReadScriptDescriptor* rsd = dynamic_cast<ReadScriptDescriptor*>(sd);
-		if (_open_threads.find(rsd->GetFilename()) == _open_threads.end())
-			_open_threads[rsd->GetFilename()] = rsd->_lstack;
-	}
+	++_opened_files_count;
 }
 
 
@@ -110,17 +281,103 @@ void ScriptEngine::_AddOpenFile(ScriptDescriptor* sd) {
 void ScriptEngine::_RemoveOpenFile(ScriptDescriptor* sd) {
 	// NOTE: Function assumes that the ScriptDescriptor file is already open
 	_open_files.erase(sd->_filename);
+
+	// Let the next descriptor reuse the thread of the file
+	map<string, ReusableThread>::iterator it = _reusable_threads.find(sd->_filename);
+	if (it != _reusable_threads.end()) {
+		ReadScriptDescriptor* rsd = dynamic_cast<ReadScriptDescriptor*>(sd);
+		if (rsd != NULL && rsd->_lstack == it->second.lstack)
+			it->second.in_use = false;
+	}
 }
 
 
 
 lua_State *ScriptEngine::_CheckForPreviousLuaState(const std::string &filename) {
-	return NULL; // TEMP, see todo notes in script.h
+	map<string, ReusableThread>::iterator it = _reusable_threads.find(filename);
+	if (it == _reusable_threads.end())
+		return NULL;
 
-	if (_open_threads.find(filename) != _open_threads.end())
-		return _open_threads[filename];
-	else
+	// Two descriptors can't share the same thread stack at once
+	if (it->second.in_use)
 		return NULL;
+
+	FileStamp stamp;
+	if (GetFileStamp(filename, stamp) == false || stamp != it->second.stamp) {
+		// The file changed since it was run, so its thread is released
+		luaL_unref(_global_state, LUA_REGISTRYINDEX, it->second.registry_reference);
+		_reusable_threads.erase(it);
+		return NULL;
+	}
+
+	it->second.in_use = true;
+	return it->second.lstack;
+}
+
+
+
+void ScriptEngine::_AddReusableThread(const std::string& filename, lua_State* lstack) {
+	// Another descriptor is still reading the file through the registered thread
+	if (_reusable_threads.find(filename) != _reusable_threads.end())
+		return;
+
+	ReusableThread thread;
+	if (GetFileStamp(filename, thread.stamp) == false)
+		return;
+
+	// Anchor the thread in the registry so that it outlives the descriptor
+	lua_pushthread(lstack);
+	thread.registry_reference = luaL_ref(lstack, LUA_REGISTRYINDEX);
+	thread.lstack = lstack;
+	thread.in_use = true;
+	_reusable_threads[filename] = thread;
+}
+
+
+
+int32 ScriptEngine::_LoadFile(lua_State* lstack, const std::string& filename, bool read_cache) {
+	// Only the game data files are cached. They are given relative to the game folder,
+	// unlike the user files (saved games, settings, ...) which are given with a full path.
+	FileStamp stamp;
+	bool is_data_file = (filename.empty() == false && filename[0] != '/' && filename[0] != '\\'
+		&& filename.find(':') == string::npos);
+	if (_bytecode_cache_path.empty() || is_data_file == false || GetFileStamp(filename, stamp) == false)
+		return luaL_loadfile(lstack, filename.c_str());
+
+	std::string cache_filename = _GetBytecodeCacheFilename(filename);
+	std::string bytecode;
+	if (read_cache && ReadBytecodeCache(cache_filename, filename, stamp, bytecode)) {
+		// The chunk is named the way luaL_loadfile() does, so that error messages are unchanged
+		std::string chunk_name = "@" + filename;
+		if (luaL_loadbuffer(lstack, bytecode.data(), bytecode.size(), chunk_name.c_str()) == 0)
+			return 0;
+
+		IF_PRINT_WARNING(SCRIPT_DEBUG) << "invalid bytecode cache file: " << cache_filename << ", error message:" << endl
+			<< lua_tostring(lstack, STACK_TOP) << endl;
+		lua_pop(lstack, 1);
+	}
+
+	int32 result = luaL_loadfile(lstack, filename.c_str());
+	if (result != 0)
+		return result;
+
+	bytecode.clear();
+	if (lua_dump(lstack, WriteBytecodeChunk, &bytecode) == 0 && bytecode.empty() == false)
+		WriteBytecodeCache(cache_filename, filename, stamp, bytecode);
+
+	return 0;
+} // int32 ScriptEngine::_LoadFile(lua_State* lstack, const std::string& filename, bool read_cache)
+
+
+
+std::string ScriptEngine::_GetBytecodeCacheFilename(const std::string& filename) const {
+	// Flatten the path: 'dat/maps/demo.lua' is cached in 'dat_maps_demo.luac'
+	std::string cache_filename = filename;
+	for (uint32 i = 0; i < cache_filename.size(); ++i) {
+		if (cache_filename[i] == '/' || cache_filename[i] == '\\' || cache_filename[i] == ':')
+			cache_filename[i] = '_';
+	}
+	return _bytecode_cache_path + cache_filename + "c";
 }
 
 
@@ -45,6 +45,8 @@ extern "C" {
 #include "utils.h"
 #include "defs.h"
 
+#include "engine/profiler.h"
+
 //! \brief All calls to the scripting engine are wrapped in this namespace.
 namespace hoa_script {
 
@@ -54,6 +56,9 @@ extern ScriptEngine* ScriptManager;
 //! \brief Determines whether the code in the hoa_script namespace should print debug statements or not.
 extern bool SCRIPT_DEBUG;
 
+//! \brief The default time the Lua garbage collector may run for on each frame, in milliseconds
+const float DEFAULT_GC_FRAME_BUDGET = 1.0f;
+
 /** \name Script File Access Modes
 *** \brief Used to indicate with what priveledges a file is to be opened with.
 **/
@@ -71,8 +76,42 @@ enum SCRIPT_ACCESS_MODE {
 **/
 #define ScriptObject luabind::object
 
-//! \brief A macro for making Lua function calls
-#define ScriptCallFunction luabind::call_function
+//! \brief A macro for making Lua function calls, whose time is measured by the profiler
+#define ScriptCallFunction hoa_script::CallFunction
+
+/** \name Lua Function Calls
+*** \brief Call a Lua function through luabind::call_function(), within a profile zone
+*** \param function The Lua function object, or the Lua state and the global function name
+***
+*** luabind::call_function() returns a proxy calling the function when it is converted
+*** to the return type or destroyed, so the proxy is converted here for the call to be made
+*** within the zone.
+**/
+//@{
+template <typename R>
+R CallFunction(const luabind::object& function)
+	{ PROFILE_ZONE("Lua call"); return static_cast<R>(luabind::call_function<R>(function)); }
+
+template <typename R, typename A1>
+R CallFunction(const luabind::object& function, const A1& a1)
+	{ PROFILE_ZONE("Lua call"); return static_cast<R>(luabind::call_function<R>(function, a1)); }
+
+template <typename R, typename A1, typename A2>
+R CallFunction(const luabind::object& function, const A1& a1, const A2& a2)
+	{ PROFILE_ZONE("Lua call"); return static_cast<R>(luabind::call_function<R>(function, a1, a2)); }
+
+template <typename R, typename A1, typename A2, typename A3>
+R CallFunction(const luabind::object& function, const A1& a1, const A2& a2, const A3& a3)
+	{ PROFILE_ZONE("Lua call"); return static_cast<R>(luabind::call_function<R>(function, a1, a2, a3)); }
+
+template <typename R>
+R CallFunction(lua_State* lua_state, const char* function_name)
+	{ PROFILE_ZONE("Lua call"); return static_cast<R>(luabind::call_function<R>(lua_state, function_name)); }
+
+template <typename R, typename A1>
+R CallFunction(lua_State* lua_state, const char* function_name, const A1& a1)
+	{ PROFILE_ZONE("Lua call"); return static_cast<R>(luabind::call_function<R>(lua_state, function_name, a1)); }
+//@}
 
 //! An internal namespace to be used only by the scripting engine itself. Don't use this namespace anywhere else!
 namespace private_script {
@@ -83,6 +122,69 @@ const int32 STACK_TOP = -1;
 //! \brief Used to represent the end of a Lua table that is being iterated
 const luabind::iterator TABLE_END;
 
+//! \brief Identifies the Lua bytecode cache files and their format revision.
+//@{
+const uint32 BYTECODE_CACHE_MAGIC = 0x43425456; // "VTBC"
+const uint32 BYTECODE_CACHE_VERSION = 1;
+//@}
+
+//! \brief The amount of memory, in kilobytes, given to each incremental step of the Lua garbage collector
+const int32 GC_STEP_SIZE = 16;
+
+//! \brief A new collection cycle starts once the Lua heap reaches this many times its size after the last one
+const uint32 GC_PAUSE_FACTOR = 2;
+
+//! \brief The Lua heap size, in bytes, under which no collection cycle is started
+const uint32 GC_MIN_THRESHOLD = 1024 * 1024;
+
+/** ****************************************************************************
+*** \brief The modification stamp of a script file
+***
+*** Used to detect when the bytecode cached for a file, or the Lua thread that
+*** ran it, no longer matches the file content.
+*** ***************************************************************************/
+class FileStamp {
+public:
+	FileStamp() :
+		modification_time(0), size(0) {}
+
+	bool operator==(const FileStamp& other) const
+		{ return (modification_time == other.modification_time && size == other.size); }
+
+	bool operator!=(const FileStamp& other) const
+		{ return !(*this == other); }
+
+	//! \brief The last modification time of the file, in seconds since the epoch
+	uint32 modification_time;
+
+	//! \brief The size of the file in bytes
+	uint32 size;
+}; // class FileStamp
+
+/** ****************************************************************************
+*** \brief A Lua thread in which a read-only file has already been run
+***
+*** The thread is kept around so that opening the same file again with
+*** ReadScriptDescriptor::OpenReadOnlyFile() doesn't re-execute it.
+*** ***************************************************************************/
+class ReusableThread {
+public:
+	ReusableThread() :
+		lstack(NULL), registry_reference(LUA_NOREF), in_use(false) {}
+
+	//! \brief The thread the file was run in
+	lua_State* lstack;
+
+	//! \brief The registry reference preventing the thread from being garbage collected
+	int32 registry_reference;
+
+	//! \brief The stamp of the file when it was run
+	FileStamp stamp;
+
+	//! \brief Set while a descriptor has the file open through this thread
+	bool in_use;
+}; // class ReusableThread
+
 } // namespace private_script
 
 /** ****************************************************************************
@@ -231,38 +333,140 @@ public:
 	**/
 	void HandleCastError(luabind::cast_failed& err);
 
+	/** \brief Returns the number of script files opened since the last call to ResetOpenedFilesCount()
+	*** This is used to check how much script parsing happens on each game mode change.
+	**/
+	uint32 GetOpenedFilesCount() const
+		{ return _opened_files_count; }
+
+	void ResetOpenedFilesCount()
+		{ _opened_files_count = 0; }
+
+	/** \name Garbage Collection Functions
+	*** The Lua collector runs on its own until the main loop first steps it. From then
+	*** on, it only runs within the time the main loop gives it on each frame, and when
+	*** a full collection is asked for, such as at the end of a map or battle load.
+	**/
+	//@{
+	/** \brief Runs incremental steps of the garbage collector, within the frame budget
+	*** \param slack The time left before the next frame is due, in microseconds
+	***
+	*** A new collection cycle only starts once the Lua heap has grown enough since the end
+	*** of the previous one. The steps then run for the slack, up to the frame budget, and
+	*** at least one step is run. When the heap grows faster than it is collected, the whole
+	*** budget is used regardless of the slack.
+	**/
+	void StepGarbageCollector(uint32 slack);
+
+	//! \brief Runs a full collection cycle at once
+	void CollectAllGarbage();
+
+	//! \brief Sets the time the collector may run for on each frame, in milliseconds
+	void SetGarbageCollectorBudget(float budget);
+
+	float GetGarbageCollectorBudget() const
+		{ return _gc_budget / 1000.0f; }
+
+	//! \brief Returns the memory used by the Lua state, in bytes
+	uint32 GetHeapSize() const;
+
+	//! \brief Returns the time taken by the last StepGarbageCollector() call, in milliseconds
+	float GetGarbageCollectorStepTime() const
+		{ return _gc_step_time / 1000.0f; }
+
+	//! \brief Returns the time taken by the last CollectAllGarbage() call, in milliseconds
+	float GetFullCollectionTime() const
+		{ return _gc_full_collection_time / 1000.0f; }
+
+	//! \brief Returns the number of collection cycles completed so far, full collections included
+	uint32 GetNumberGarbageCollections() const
+		{ return _gc_cycle_count; }
+	//@}
+
 private:
 	ScriptEngine();
 
 	//! \brief Maintains a list of all script files that are currently open
 	std::map<std::string, ScriptDescriptor*> _open_files;
 
-	// TODO: not re-opening Lua files introduces serious problems (invalid data being read) and conflicts when
-	// two files share the same variable name are opened in succession. I believe this "feature" should be
-	// removed, but I'm leaving it here for now until we understand the situation completely.
-	/** \brief Maintains a cache of opened lua threads
+	/** \brief Maintains a cache of the Lua threads in which read-only files were run
 	*** This is done so that a file that has already been loaded into the lua state will not be loaded again.
 	*** Instead the lua_thread will be returned.
+	***
+	*** \note Re-opening a file without running it again is only valid when the file
+	*** keeps its data in its own tablespace and that data isn't modified afterwards.
+	*** Hence, only the files opened with ReadScriptDescriptor::OpenReadOnlyFile() are registered here.
 	**/
-	std::map<std::string, lua_State*> _open_threads;
+	std::map<std::string, private_script::ReusableThread> _reusable_threads;
 
 	//! \brief The lua state shared globally by all files
 	lua_State* _global_state;
 
+	/** \brief The folder where the compiled version of the game data scripts are stored
+	*** An empty string disables the bytecode cache.
+	**/
+	std::string _bytecode_cache_path;
+
+	//! \brief The number of files opened since the counter was last reset
+	uint32 _opened_files_count;
+
+	/** \name Garbage Collection Members
+	*** The times are given in microseconds.
+	**/
+	//@{
+	//! \brief Set once the automatic collector is stopped, so that it only runs within the frame budget
+	bool _gc_stepped;
+
+	//! \brief Set while an incremental collection cycle is in progress
+	bool _gc_cycle_running;
+
+	//! \brief The heap size from which a new collection cycle starts, in bytes
+	uint32 _gc_threshold;
+
+	uint32 _gc_budget;
+	uint32 _gc_step_time;
+	uint32 _gc_full_collection_time;
+	uint32 _gc_cycle_count;
+	//@}
+
 	//! \brief Adds an open file to the list of open files
 	void _AddOpenFile(ScriptDescriptor* sd);
 
 	//! \brief Removes an open file from the list of open files
 	void _RemoveOpenFile(ScriptDescriptor* sd);
 
-	// TODO: related to the to-do note above. I don't think this function should be used. For now it
-	// always returns NULL.
+	//! \brief Sets when the next collection cycle starts, once one has completed
+	void _EndGarbageCollection();
+
 	/** \brief Checks for the existence of a previously opened lua state from that filename.
 	*** This should class because the filename contains the full path
 	***
-	*** \return A pointer to the lua_State for the file, or NULL if the file has never been opened.
+	*** \return A pointer to the lua_State for the file, or NULL if the file has never been opened
+	*** as a read-only file, has changed since or is currently opened by another descriptor.
 	**/
 	lua_State* _CheckForPreviousLuaState(const std::string &filename);
+
+	/** \brief Registers the thread in which a read-only file was just run
+	*** \param filename The name of the file
+	*** \param lstack The thread the file was run in. It must be on top of the global stack.
+	**/
+	void _AddReusableThread(const std::string& filename, lua_State* lstack);
+
+	/** \brief Loads a Lua file as a function on top of the given stack, without running it
+	*** \param lstack The Lua thread to load the file in
+	*** \param filename The name of the file to load
+	*** \param read_cache Whether the cached bytecode can be used. When false, the file is compiled
+	*** from its source and the cached bytecode is replaced.
+	*** \return The luaL_loadfile() return value: 0 on success, a Lua error code otherwise.
+	***
+	*** The game data files, given as relative paths, are compiled once and their bytecode
+	*** is stored in the bytecode cache folder, keyed by the file modification time and size.
+	*** Further loads use that bytecode as long as the file doesn't change.
+	**/
+	int32 _LoadFile(lua_State* lstack, const std::string& filename, bool read_cache);
+
+	//! \brief Returns the bytecode cache file name used for the given script file
+	std::string _GetBytecodeCacheFilename(const std::string& filename) const;
 }; // class ScriptEngine : public hoa_utils::Singleton<ScriptEngine>
 
 } // namespace hoa_script
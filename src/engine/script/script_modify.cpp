@@ -53,20 +53,17 @@ bool ModifyScriptDescriptor::OpenFile(const std::string& file_name) {
 		return false;
 	}
 
-	// Check if this file was opened previously.
-	if ((this->_lstack = ScriptManager->_CheckForPreviousLuaState(file_name)) == NULL)
-	{
-		// Increases the global stack size by 1 element. That is needed because the new thread will be pushed in the
-		// stack and we have to be sure there is enough space there.
-		lua_checkstack(ScriptManager->GetGlobalState(),1);
-		_lstack = lua_newthread(ScriptManager->GetGlobalState());
-
-		// Attempt to load and execute the Lua file.
-		if (luaL_loadfile(_lstack, file_name.c_str()) != 0 || lua_pcall(_lstack, 0, 0, 0)) {
-			cerr << "SCRIPT ERROR: ModifyScriptDescriptor::OpenFile() could not open the file " << file_name << endl;
-			_access_mode = SCRIPT_CLOSED;
-			return false;
-		}
+	// The file is always run again, since the modified data must not end up in the thread of a read-only file.
+	// Increases the global stack size by 1 element. That is needed because the new thread will be pushed in the
+	// stack and we have to be sure there is enough space there.
+	lua_checkstack(ScriptManager->GetGlobalState(),1);
+	_lstack = lua_newthread(ScriptManager->GetGlobalState());
+
+	// Attempt to load and execute the Lua file.
+	if (ScriptManager->_LoadFile(_lstack, file_name, true) != 0 || lua_pcall(_lstack, 0, 0, 0)) {
+		cerr << "SCRIPT ERROR: ModifyScriptDescriptor::OpenFile() could not open the file " << file_name << endl;
+		_access_mode = SCRIPT_CLOSED;
+		return false;
 	}
 
 	// Write out some global stuff
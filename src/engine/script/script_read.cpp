@@ -50,6 +50,20 @@ bool ReadScriptDescriptor::OpenFile(const string& filename) {
 
 
 bool ReadScriptDescriptor::OpenFile(const string& filename, bool force_reload) {
+	// The files opened this way may share global names with other files or be modified
+	// once run, so they are always run again.
+	return _OpenFile(filename, false, force_reload);
+}
+
+
+
+bool ReadScriptDescriptor::OpenReadOnlyFile(const string& filename) {
+	return _OpenFile(filename, true, false);
+}
+
+
+
+bool ReadScriptDescriptor::_OpenFile(const string& filename, bool reuse_thread, bool force_reload) {
 	// check for file existence
 	if (!DoesFileExist(filename)) {
 		PRINT_ERROR << "Attempted to open unavailable file: "
@@ -64,26 +78,68 @@ bool ReadScriptDescriptor::OpenFile(const string& filename, bool force_reload) {
 	}
 
 	// Check if this file was opened previously.
-	if ((force_reload) || (_lstack = ScriptManager->_CheckForPreviousLuaState(filename)) == NULL) {
+	if (!reuse_thread || (_lstack = ScriptManager->_CheckForPreviousLuaState(filename)) == NULL) {
 		// Increases the global stack size by 1 element. That is needed because the new thread will be pushed in the
 		// stack and we have to be sure there is enough space there.
 		lua_checkstack(ScriptManager->GetGlobalState(), 1);
 		_lstack = lua_newthread(ScriptManager->GetGlobalState());
 
 		// Attempt to load and execute the Lua file
-		if (luaL_loadfile(_lstack, filename.c_str()) != 0 || lua_pcall(_lstack, 0, 0, 0)) {
+		if (ScriptManager->_LoadFile(_lstack, filename, !force_reload) != 0 || lua_pcall(_lstack, 0, 0, 0)) {
 			PRINT_ERROR << "could not open script file: " << filename << ", error message:" << endl;
 			cerr << lua_tostring(_lstack, private_script::STACK_TOP) << endl;
 			_access_mode = SCRIPT_CLOSED;
 			return false;
 		}
+
+		if (reuse_thread)
+			ScriptManager->_AddReusableThread(filename, _lstack);
 	}
 
 	_filename = filename;
 	_access_mode = SCRIPT_READ;
 	ScriptManager->_AddOpenFile(this);
 	return true;
-} // bool ReadScriptDescriptor::OpenFile(string file_name, bool force_reload)
+} // bool ReadScriptDescriptor::_OpenFile(const string& filename, bool reuse_thread, bool force_reload)
+
+
+
+bool ReadScriptDescriptor::OpenStandaloneFile(const string& filename) {
+	if (IsFileOpen()) {
+		PRINT_ERROR << "Attempted to open file while another one is still opened: "
+			<< filename << endl;
+		return false;
+	}
+
+	if (!DoesFileExist(filename)) {
+		PRINT_ERROR << "Attempted to open unavailable file: "
+			<< filename << endl;
+		return false;
+	}
+
+	_lstack = luaL_newstate();
+	if (_lstack == NULL) {
+		PRINT_ERROR << "could not create a Lua state for script file: " << filename << endl;
+		return false;
+	}
+	luaL_openlibs(_lstack);
+	luabind::open(_lstack);
+
+	// The bytecode cache doesn't depend on the global state, so it is used here as well
+	if (ScriptManager->_LoadFile(_lstack, filename, true) != 0 || lua_pcall(_lstack, 0, 0, 0)) {
+		PRINT_ERROR << "could not open script file: " << filename << ", error message:" << endl;
+		cerr << lua_tostring(_lstack, private_script::STACK_TOP) << endl;
+		lua_close(_lstack);
+		_lstack = NULL;
+		_access_mode = SCRIPT_CLOSED;
+		return false;
+	}
+
+	_standalone_state = true;
+	_filename = filename;
+	_access_mode = SCRIPT_READ;
+	return true;
+} // bool ReadScriptDescriptor::OpenStandaloneFile(const string& filename)
 
 
 
@@ -110,11 +166,20 @@ void ReadScriptDescriptor::CloseFile() {
 		cerr << _error_messages.str() << endl;
 	}
 
+	if (_standalone_state) {
+		lua_close(_lstack);
+		_standalone_state = false;
+	}
+	else {
+		// Leave the thread stack clean in case the thread is reused
+		lua_settop(_lstack, 0);
+		ScriptManager->_RemoveOpenFile(this);
+	}
+
 	_lstack = NULL;
 	_error_messages.clear();
 	_open_tables.clear();
 	_access_mode = SCRIPT_CLOSED;
-	ScriptManager->_RemoveOpenFile(this);
 }
 
 //-----------------------------------------------------------------------------
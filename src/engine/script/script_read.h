@@ -69,7 +69,8 @@ class ReadScriptDescriptor : public ScriptDescriptor {
 	friend class ScriptEngine;
 public:
 	ReadScriptDescriptor() :
-		_lstack(NULL) {}
+		_lstack(NULL),
+		_standalone_state(false) {}
 
 	virtual ~ReadScriptDescriptor();
 
@@ -79,11 +80,38 @@ public:
 	**/
 	//@{
 	virtual bool OpenFile(const std::string& file_name);
-	virtual bool OpenFile(const std::string& file_name, bool force_reload);
 	virtual bool OpenFile();
 	virtual void CloseFile();
 	//@}
 
+	/** \brief Opens the file, compiling it from its source if asked to
+	*** \param file_name The name of the Lua file to be opened.
+	*** \param force_reload When true, the cached bytecode of the file is ignored and replaced.
+	*** \return False on failure or true on success.
+	**/
+	virtual bool OpenFile(const std::string& file_name, bool force_reload);
+
+	/** \brief Opens a data file that is never modified once run
+	*** \param file_name The name of the Lua file to be opened.
+	*** \return False on failure or true on success.
+	***
+	*** Unlike OpenFile(), the file is only run the first time it is opened. Later calls reuse the Lua
+	*** thread it was run in, as long as the file hasn't changed on disk. Only use this function for
+	*** files keeping all their data in their own tablespace, and which data isn't modified by the game.
+	**/
+	bool OpenReadOnlyFile(const std::string& file_name);
+
+	/** \brief Opens a data file in a Lua state of its own, separated from the global one
+	*** \param file_name The name of the Lua file to be opened.
+	*** \return False on failure or true on success.
+	***
+	*** The file is run with the standard Lua libraries only, so it must not call any engine binding
+	*** while being run. As neither the global Lua state nor the script engine are modified, the file
+	*** can be opened and read from another thread, e.g. to parse the data tables of a map while the
+	*** game keeps on drawing frames. The Lua state is destroyed when the file is closed.
+	**/
+	bool OpenStandaloneFile(const std::string& file_name);
+
 	/** \name Existence Checking Functions
 	*** \brief Methods which check if there exist certain data names and types in a script file
 	*** \param key The variable, table, or function name to check for
@@ -401,6 +429,17 @@ protected:
 	//! \brief The Lua stack, which handles all data sharing between C++ and Lua.
 	lua_State *_lstack;
 
+	//! \brief Set when _lstack is a Lua state owned by the descriptor. See OpenStandaloneFile().
+	bool _standalone_state;
+
+	/** \brief Opens the file in a new Lua thread or in the thread it was previously run in
+	*** \param file_name The name of the Lua file to be opened.
+	*** \param reuse_thread Whether the thread of a previous read-only opening can be used.
+	*** \param force_reload Whether the file is compiled from its source even when its bytecode is cached.
+	*** \return False on failure or true on success.
+	**/
+	bool _OpenFile(const std::string& file_name, bool reuse_thread, bool force_reload);
+
 	/** \name Data Existence Check Functions
 	*** \brief These functions are called by the public DoesTYPEExist functions of this class.
 	*** \param key The name or numeric id of the Lua data to check.
@@ -34,6 +34,14 @@
 	#include <limits.h>
 #endif
 
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <time.h>
+#endif
+
+#include <algorithm>
+
 // #include "gettext.h"
 #include <libintl.h>
 
@@ -244,11 +252,64 @@ void SystemTimer::_UpdateTimer(uint32 time) {
 // SystemEngine Class
 // -----------------------------------------------------------------------------
 
+//! \brief The default number of frames per second drawn with FRAME_PACING_TARGET_FPS
+const uint32 DEFAULT_TARGET_FPS = 60;
+
+/** \brief The number of microseconds before a frame is due when the main loop stops sleeping and spins
+*** The operating system sleeps often last one or two milliseconds longer than asked.
+**/
+const uint32 FRAME_SPIN_TIME = 2000;
+
+/** \brief The number of frames in a row taking less than half the frame period after which the vertical sync is deemed ignored
+*** A frame waiting for the vertical sync can't be that short, unless the screen refreshes
+*** more than twice as often as expected.
+**/
+const uint32 VSYNC_IGNORED_FRAMES = 60;
+
+/** \brief The longest frame time accounted for, in microseconds
+*** Longer frames, for example after the process was suspended, count for this much only,
+*** so that they neither flood the update steps nor the frame statistics.
+**/
+const uint32 MAX_FRAME_TIME = MAX_UPDATE_STEPS * FIXED_UPDATE_TIME * 1000;
+
+Uint64 GetMicroseconds() {
+#if defined(_WIN32)
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return static_cast<Uint64>(counter.QuadPart / frequency.QuadPart) * 1000000 +
+		static_cast<Uint64>(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+	// Unlike gettimeofday(), the monotonic clock doesn't follow the changes of the wall clock
+	struct timespec time;
+	if (clock_gettime(CLOCK_MONOTONIC, &time) == 0)
+		return static_cast<Uint64>(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+	return static_cast<Uint64>(SDL_GetTicks()) * 1000;
+#else
+	return static_cast<Uint64>(SDL_GetTicks()) * 1000;
+#endif
+}
+
+
+
 SystemEngine::SystemEngine() {
 	IF_PRINT_DEBUG(SYSTEM_DEBUG) << "constructor invoked" << endl;
 
 	_not_done = true;
 	SetLanguage("en@quot"); //Default language is English
+
+	_frame_pacing = FRAME_PACING_VSYNC;
+	_frame_period = 1000000 / DEFAULT_TARGET_FPS;
+	_last_frame_time = 0;
+	_next_frame_time = 0;
+	_frame_drawing_time = 0;
+	_number_fast_frames = 0;
+	_vsync_ignored = false;
+	_update_lag = 0;
+	_number_update_steps = 0;
+	_updating = false;
+	_current_frame_sample = 0;
+	_number_frame_samples = 0;
 }
 
 
@@ -320,6 +381,10 @@ bool SystemEngine::SingletonInitialize() {
 void SystemEngine::InitializeTimers() {
 	_last_update = SDL_GetTicks();
 	_update_time = 1; // Set to non-zero, otherwise bad things may happen...
+	_last_frame_time = GetMicroseconds();
+	_next_frame_time = _last_frame_time + _frame_period;
+	_update_lag = 0;
+	_number_frame_samples = 0;
 	_hours_played = 0;
 	_minutes_played = 0;
 	_seconds_played = 0;
@@ -363,11 +428,149 @@ void SystemEngine::RemoveAutoTimer(SystemTimer* timer) {
 
 
 
+void SystemEngine::SetFramePacing(FRAME_PACING pacing, uint32 target_fps) {
+	if (target_fps == 0) {
+		IF_PRINT_WARNING(SYSTEM_DEBUG) << "target frame rate can not be zero, using the default one" << endl;
+		target_fps = DEFAULT_TARGET_FPS;
+	}
+
+	_frame_pacing = pacing;
+	_frame_period = 1000000 / target_fps;
+	_next_frame_time = GetMicroseconds() + _frame_period;
+	_number_fast_frames = 0;
+	_vsync_ignored = false;
+}
+
+
+
+void SystemEngine::WaitForNextFrame() {
+	Uint64 current_time = GetMicroseconds();
+
+	if (_frame_pacing == FRAME_PACING_TARGET_FPS || _vsync_ignored) {
+		// Never wait for more than a period, should the clock have jumped since the last frame
+		if (_next_frame_time > current_time + _frame_period)
+			_next_frame_time = current_time + _frame_period;
+
+		// Sleep while the frame is far from due, as the sleeps aren't accurate, then spin
+		while (current_time + FRAME_SPIN_TIME < _next_frame_time) {
+			SDL_Delay(static_cast<uint32>(_next_frame_time - current_time - FRAME_SPIN_TIME) / 1000 + 1);
+			current_time = GetMicroseconds();
+		}
+		while (current_time < _next_frame_time)
+			current_time = GetMicroseconds();
+
+		// Keep a steady rhythm, unless the frame is late by more than a whole period
+		_next_frame_time += _frame_period;
+		if (_next_frame_time < current_time)
+			_next_frame_time = current_time + _frame_period;
+	}
+
+	uint32 frame_time = 0;
+	if (current_time > _last_frame_time)
+		frame_time = static_cast<uint32>(std::min<Uint64>(current_time - _last_frame_time, MAX_FRAME_TIME));
+	_last_frame_time = current_time;
+
+	// Keep the target frame rate when the buffer swaps return right away, instead of busy looping
+	if (_frame_pacing == FRAME_PACING_VSYNC && !_vsync_ignored) {
+		_number_fast_frames = (frame_time < _frame_period / 2) ? _number_fast_frames + 1 : 0;
+		if (_number_fast_frames >= VSYNC_IGNORED_FRAMES) {
+			IF_PRINT_WARNING(SYSTEM_DEBUG) << "the vertical sync is ignored, keeping the target frame rate instead" << endl;
+			_vsync_ignored = true;
+			_next_frame_time = current_time + _frame_period;
+		}
+	}
+
+	_frame_times[_current_frame_sample] = frame_time;
+	_current_frame_sample = (_current_frame_sample + 1) % FRAME_TIME_SAMPLES;
+	if (_number_frame_samples < FRAME_TIME_SAMPLES)
+		++_number_frame_samples;
+
+	_update_lag = std::min(_update_lag + frame_time, MAX_FRAME_TIME);
+	_number_update_steps = 0;
+}
+
+
+
+void SystemEngine::EndFrameDrawing() {
+	Uint64 current_time = GetMicroseconds();
+	_frame_drawing_time = 0;
+	if (current_time > _last_frame_time)
+		_frame_drawing_time = static_cast<uint32>(std::min<Uint64>(current_time - _last_frame_time, MAX_FRAME_TIME));
+}
+
+
+
+uint32 SystemEngine::GetTimeUntilNextFrame() const {
+	// The buffer swap doesn't tell how long it waited, so the time left is estimated from the last frame
+	if (_frame_pacing != FRAME_PACING_TARGET_FPS && !_vsync_ignored) {
+		if (_frame_drawing_time >= _frame_period)
+			return 0;
+		return _frame_period - _frame_drawing_time;
+	}
+
+	Uint64 current_time = GetMicroseconds();
+	if (current_time >= _next_frame_time)
+		return 0;
+	return static_cast<uint32>(_next_frame_time - current_time);
+}
+
+
+
+bool SystemEngine::NextUpdateStep() {
+	if (_update_lag < FIXED_UPDATE_TIME * 1000) {
+		_updating = false;
+		return false;
+	}
+
+	// Drop the time left rather than running the frame on
+	if (_number_update_steps >= MAX_UPDATE_STEPS) {
+		_update_lag %= FIXED_UPDATE_TIME * 1000;
+		_updating = false;
+		return false;
+	}
+
+	_update_lag -= FIXED_UPDATE_TIME * 1000;
+	++_number_update_steps;
+	_updating = true;
+	return true;
+}
+
+
+
+float SystemEngine::GetUpdateInterpolation() const {
+	if (_updating)
+		return 1.0f;
+
+	return static_cast<float>(_update_lag) / (FIXED_UPDATE_TIME * 1000);
+}
+
+
+
+bool SystemEngine::GetFrameStatistics(float& min_time, float& average_time, float& p99_time) const {
+	if (_number_frame_samples == 0)
+		return false;
+
+	std::vector<uint32> frame_times(_frame_times, _frame_times + _number_frame_samples);
+	uint32 sum = 0;
+	for (uint32 i = 0; i < frame_times.size(); ++i)
+		sum += frame_times[i];
+
+	std::vector<uint32>::iterator p99 = frame_times.begin() + (frame_times.size() * 99) / 100;
+	std::nth_element(frame_times.begin(), p99, frame_times.end());
+
+	min_time = *std::min_element(frame_times.begin(), frame_times.end()) / 1000.0f;
+	average_time = sum / (frame_times.size() * 1000.0f);
+	p99_time = *p99 / 1000.0f;
+	return true;
+}
+
+
+
 void SystemEngine::UpdateTimers() {
 	// ----- (1): Update the update game timer
-	uint32 tmp = _last_update;
+	// The game logic always moves by a fixed step, the real time being caught up by the main loop
 	_last_update = SDL_GetTicks();
-	_update_time = _last_update - tmp;
+	_update_time = FIXED_UPDATE_TIME;
 
 	// ----- (2): Update the game play timer
 	_milliseconds_played += _update_time;
@@ -74,6 +74,31 @@ const int32 SYSTEM_TIMER_NO_LOOPS = 0;
 **/
 const int32 SYSTEM_TIMER_INFINITE_LOOP = -1;
 
+//! \brief The number of milliseconds the game logic is updated by on each update step
+const uint32 FIXED_UPDATE_TIME = 10;
+
+/** \brief The maximum number of update steps run for a single frame
+*** When the game falls further behind, for example while a mode is loading, the
+*** remaining time is dropped instead of being caught up.
+**/
+const uint32 MAX_UPDATE_STEPS = 10;
+
+//! \brief The number of frame times kept to compute the frame statistics
+const uint32 FRAME_TIME_SAMPLES = 256;
+
+//! \brief Returns the current time in microseconds, from a high resolution monotonic clock
+Uint64 GetMicroseconds();
+
+//! \brief How the main loop waits between two frames
+enum FRAME_PACING {
+	//! The buffer swap waits for the vertical sync of the screen, or the main loop keeps the target frame rate when it doesn't
+	FRAME_PACING_VSYNC = 0,
+	//! The main loop sleeps, then spins until the next frame is due
+	FRAME_PACING_TARGET_FPS = 1,
+	//! The frames are drawn as fast as possible
+	FRAME_PACING_UNCAPPED = 2
+};
+
 //! \brief All of the possible states which a SystemTimer classs object may be in
 enum SYSTEM_TIMER_STATE {
 	SYSTEM_TIMER_INVALID  = -1,
@@ -324,7 +349,66 @@ public:
 	*** the active game mode's execution begins with only 1 millisecond of time expired instead of several.
 	**/
 	void InitializeUpdateTimer()
-		{ _last_update = SDL_GetTicks(); _update_time = 1; }
+		{ _last_update = SDL_GetTicks(); _update_time = 1; _update_lag = 0; }
+
+	/** \brief Sets how the main loop waits between two frames
+	*** \param target_fps The number of frames per second drawn with FRAME_PACING_TARGET_FPS, which
+	*** is also the screen refresh rate expected with FRAME_PACING_VSYNC
+	***
+	*** \note The vertical sync itself is enabled by the video engine, see VideoEngine::SetVSync().
+	**/
+	void SetFramePacing(FRAME_PACING pacing, uint32 target_fps);
+
+	FRAME_PACING GetFramePacing() const
+		{ return _frame_pacing; }
+
+	/** \brief Waits until the next frame is due and records the frame time
+	*** This function should only be called <b>once</b> for each cycle through the main game loop,
+	*** after the frame is drawn. The time elapsed since the previous frame is added to the time
+	*** the game logic has to catch up with, see NextUpdateStep().
+	***
+	*** With FRAME_PACING_VSYNC, the driver may ignore the swap interval. When the frames keep on
+	*** taking less than half the expected refresh period, the main loop waits as with
+	*** FRAME_PACING_TARGET_FPS instead of drawing as fast as possible.
+	**/
+	void WaitForNextFrame();
+
+	/** \brief Records the time taken to update and draw the frame
+	*** This function should be called once the frame is drawn, right before the buffer swap.
+	**/
+	void EndFrameDrawing();
+
+	/** \brief Returns the time left before the next frame is due, in microseconds
+	*** With FRAME_PACING_TARGET_FPS, or FRAME_PACING_VSYNC when the vertical sync is ignored, this is
+	*** the time the main loop would sleep for. Otherwise, the next frame is expected to take as long
+	*** to update and draw as the last one, and the time left is what remains of the frame period,
+	*** the refresh period of the screen with FRAME_PACING_VSYNC.
+	**/
+	uint32 GetTimeUntilNextFrame() const;
+
+	/** \brief Tells whether the game logic should be updated once more for the current frame
+	*** \return True when a fixed update step is due, in which case its time is consumed
+	***
+	*** The game logic is always updated by FIXED_UPDATE_TIME milliseconds, as many times as
+	*** needed to catch up with the time elapsed. The main loop calls UpdateTimers() and updates
+	*** the engines and the game mode for each step.
+	**/
+	bool NextUpdateStep();
+
+	/** \brief Returns how far the drawn frame lies between the last two update steps
+	*** \return A value from 0.0f (the previous step) to 1.0f (the last step)
+	***
+	*** Used to interpolate the positions drawn, so that the movement stays smooth when the
+	*** frame rate and the update rate differ. While the update steps run, 1.0f is returned.
+	**/
+	float GetUpdateInterpolation() const;
+
+	/** \brief Computes the statistics of the last frame times
+	*** \param min_time, average_time, p99_time Set to the shortest, average and 99th percentile
+	*** frame times, in milliseconds
+	*** \return False if no frame was recorded yet
+	**/
+	bool GetFrameStatistics(float& min_time, float& average_time, float& p99_time) const;
 
 	/** \brief Adds a timer to the set system timers for auto updating
 	*** \param timer A pointer to the timer to add
@@ -342,8 +426,8 @@ public:
 	**/
 	void RemoveAutoTimer(SystemTimer* timer);
 
-	/** \brief Updates the game timer variables.
-	*** This function should only be called <b>once</b> for each cycle through the main game loop. Since
+	/** \brief Updates the game timer variables by one update step.
+	*** This function should only be called <b>once</b> for each update step of the main game loop. Since
 	*** it is called inside the loop in main.cpp, you should have no reason to call this function anywhere
 	*** else.
 	**/
@@ -435,6 +519,44 @@ private:
 	//! \brief The number of milliseconds that have transpired on the last timer update.
 	uint32 _update_time;
 
+	FRAME_PACING _frame_pacing;
+
+	//! \brief The number of microseconds between two frames at the target frame rate
+	uint32 _frame_period;
+
+	//! \brief The time the last frame started at, in microseconds
+	Uint64 _last_frame_time;
+
+	//! \brief The time the next frame is due at with FRAME_PACING_TARGET_FPS, in microseconds
+	Uint64 _next_frame_time;
+
+	//! \brief The time taken to update and draw the last frame, up to the buffer swap, in microseconds
+	uint32 _frame_drawing_time;
+
+	//! \brief The number of frames in a row which took less than half the frame period with FRAME_PACING_VSYNC
+	uint32 _number_fast_frames;
+
+	//! \brief Set when the buffer swaps don't wait for the vertical sync, the target frame rate being kept instead
+	bool _vsync_ignored;
+
+	//! \brief The number of microseconds the game logic has still to be updated by
+	uint32 _update_lag;
+
+	//! \brief The number of update steps run since the last frame, up to MAX_UPDATE_STEPS
+	uint32 _number_update_steps;
+
+	//! \brief Set while the update steps of a frame run
+	bool _updating;
+
+	//! \brief A circular array of the last frame times, in microseconds
+	uint32 _frame_times[FRAME_TIME_SAMPLES];
+
+	//! \brief The index where the next frame time is recorded
+	uint32 _current_frame_sample;
+
+	//! \brief The number of frame times recorded, up to FRAME_TIME_SAMPLES
+	uint32 _number_frame_samples;
+
 	/** \name Play time members
 	*** \brief Timers that retain the total amount of time that the user has been playing
 	*** When the player starts a new game or loads an existing game, these timers are reset.
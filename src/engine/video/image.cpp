@@ -263,6 +263,22 @@ bool ImageDescriptor::LoadMultiImageFromElementSize(vector<StillImage>& images,
 bool ImageDescriptor::LoadMultiImageFromElementGrid(vector<StillImage>& images, const string& filename,
 		const uint32 grid_rows, const uint32 grid_cols)
 {
+	// The multi images stored in a loaded atlas don't need their file
+	ImageTexture* const* atlas_textures = TextureManager->_GetAtlasMultiImage(filename, grid_rows, grid_cols);
+	if (atlas_textures != NULL) {
+		if (images.size() != grid_rows * grid_cols)
+			images.resize(grid_rows * grid_cols);
+
+		for (vector<StillImage>::iterator i = images.begin(); i < images.end(); i++) {
+			if (IsFloatEqual(i->_height, 0.0f) == true)
+				i->_height = static_cast<float>(atlas_textures[0]->height);
+			if (IsFloatEqual(i->_width, 0.0f) == true)
+				i->_width = static_cast<float>(atlas_textures[0]->width);
+		}
+
+		return _LoadMultiImage(images, filename, grid_rows, grid_cols);
+	}
+
 	if (!DoesFileExist(filename)) {
 		PRINT_WARNING << "Multi-image file not found: " << filename << endl;
 		return false;
@@ -306,6 +322,38 @@ bool ImageDescriptor::LoadMultiImageFromElementGrid(vector<StillImage>& images,
 
 
 
+bool ImageDescriptor::LoadMultiImageFromElementGrid(vector<StillImage>& images, const string& filename,
+		const ImageMemory& image_data, const uint32 grid_rows, const uint32 grid_cols)
+{
+	if (image_data.pixels == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "the decoded image data was empty for multi image file: " << filename << endl;
+		return false;
+	}
+
+	// Make sure that the number of grid rows and columns divide evenly into the image size
+	if ((image_data.height % grid_rows) != 0 || (image_data.width % grid_cols) != 0) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "multi image size not evenly divisible by grid rows or columns for multi image file: " << filename << endl;
+		return false;
+	}
+
+	if (images.size() != grid_rows * grid_cols) {
+		images.resize(grid_rows * grid_cols);
+	}
+
+	float elem_width = static_cast<float>(image_data.width) / static_cast<float>(grid_cols);
+	float elem_height = static_cast<float>(image_data.height) / static_cast<float>(grid_rows);
+	for (vector<StillImage>::iterator i = images.begin(); i < images.end(); i++) {
+		if (IsFloatEqual(i->_height, 0.0f) == true)
+			i->_height = static_cast<float>(elem_height);
+		if (IsFloatEqual(i->_width, 0.0f) == true)
+			i->_width = static_cast<float>(elem_width);
+	}
+
+	return _LoadMultiImage(images, filename, grid_rows, grid_cols, &image_data);
+} // bool ImageDescriptor::LoadMultiImageFromElementGrid(..., const ImageMemory& image_data, ...)
+
+
+
 bool ImageDescriptor::SaveMultiImage(const vector<StillImage*>& images, const string& filename,
 	const uint32 grid_rows, const uint32 grid_columns)
 {
@@ -471,9 +519,9 @@ void ImageDescriptor::_RemoveTextureReference() {
 	if (_texture->RemoveReference() == true) {
 		_texture->texture_sheet->RemoveTexture(_texture);
 
-		// If the image exceeds 512 in either width or height, it has an un-shared texture sheet, which we
-		// should now delete that the image is being removed
-		if (_texture->width > 512 || _texture->height > 512) {
+		// If the image had an un-shared texture sheet (because it exceeds the shared sheet size
+		// in either width or height, or comes from an atlas), we should now delete it once empty
+		if (_texture->texture_sheet->is_dedicated && _texture->texture_sheet->GetNumberTextures() == 0) {
 			TextureManager->_RemoveSheet(_texture->texture_sheet);
 		}
 // 		else {
@@ -527,13 +575,13 @@ void ImageDescriptor::_DrawOrientation() const {
 		x_scale = -x_scale;
 	if (current_context.coordinate_system.GetVerticalDirection() < 0.0f)
 		y_scale = -y_scale;
-	glScalef(x_scale, y_scale, 1.0f);
+	VideoManager->Scale(x_scale, y_scale);
 }
 
 
 
 void ImageDescriptor::_DrawTexture(const Color* draw_color) const {
-	// Array of the four vertexes defined on the 2D plane for glDrawArrays()
+	// Array of the four vertexes defined on the 2D plane, scaled by _DrawOrientation()
 	// This is no longer const, because when tiling the background for the menu's
 	// sometimes you need to draw part of a texture
 	float vert_coords[] = {
@@ -548,108 +596,58 @@ void ImageDescriptor::_DrawTexture(const Color* draw_color) const {
 		draw_color = _color;
 
 	// Set blending parameters
-	if (VideoManager->_current_context.blend) {
-		glEnable(GL_BLEND);
-		if (VideoManager->_current_context.blend == 1)
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
-		else
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
-	}
-	else if (_blend) {
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
-	}
-	else {
-		glDisable(GL_BLEND);
-	}
-
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, 0, vert_coords);
-
-	// If we have a valid image texture poiner, setup texture coordinates and the texture coordinate array for glDrawArrays()
-	if (_texture) {
-		// Set the texture coordinates
-		float s0, s1, t0, t1;
-
-		s0 = _texture->u1 + (_u1 * (_texture->u2 - _texture->u1));
-		s1 = _texture->u1 + (_u2 * (_texture->u2 - _texture->u1));
-		t0 = _texture->v1 + (_v1 * (_texture->v2 - _texture->v1));
-		t1 = _texture->v1 + (_v2 * (_texture->v2 - _texture->v1));
+	int8 blend = VideoManager->_current_context.blend;
+	if (blend == 0 && _blend)
+		blend = 1; // Normal blending
 
-		// Swap x texture coordinates if x flipping is enabled
-		if (VideoManager->_current_context.x_flip) {
-			float temp = s0;
-			s0 = s1;
-			s1 = temp;
-		}
+	// Use the first color on every vertex for unichrome images
+	Color vertex_colors[4];
+	if (_unichrome_vertices) {
+		vertex_colors[0] = vertex_colors[1] = vertex_colors[2] = vertex_colors[3] = draw_color[0];
+		draw_color = vertex_colors;
+	}
 
-		// Swap y texture coordinates if y flipping is enabled
-		if (VideoManager->_current_context.y_flip) {
-			float temp = t0;
-			t0 = t1;
-			t1 = temp;
-		}
+	// If we don't have a valid image texture pointer, we're drawing pure color on the vertices
+	if (!_texture) {
+		VideoManager->_sprite_batch.AddQuad(NULL, blend, _smooth, VideoManager->_transform,
+			vert_coords, NULL, draw_color);
+		return;
+	}
 
-		// Place the texture coordinates in a 4x2 array mirroring the structure of the vertex array for use in glDrawArrays().
-		float tex_coords[] = {
-			s0, t1,
-			s1, t1,
-			s1, t0,
-			s0, t0,
-		};
-
-		// Enable texturing and bind texture
-		glEnable(GL_TEXTURE_2D);
-		TextureManager->_BindTexture(_texture->texture_sheet->tex_id);
-		_texture->texture_sheet->Smooth(_smooth);
-
-		// Enable and setup the texture coordinate array
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glTexCoordPointer(2, GL_FLOAT, 0, tex_coords);
-
-		if (_unichrome_vertices) {
-			glColor4fv((GLfloat*)draw_color[0].GetColors());
-			glDisableClientState(GL_COLOR_ARRAY);
-		}
-		else {
-			glEnableClientState(GL_COLOR_ARRAY);
-			glColorPointer(4, GL_FLOAT, 0, (GLfloat*)draw_color);
-		}
-	} // if (_texture)
-	else {
-		// Otherwise there is no image texture, so we're drawing pure color on the vertices
+	// Set the texture coordinates
+	float s0, s1, t0, t1;
 
-		// Use a single call to glColor for unichrome images, or a setup a gl color array for multiple colors
-		if (_unichrome_vertices) {
-			glColor4fv((GLfloat*)draw_color[0].GetColors());
-			glDisableClientState(GL_COLOR_ARRAY);
-		}
-		else {
-			glEnableClientState(GL_COLOR_ARRAY);
-			glColorPointer(4, GL_FLOAT, 0, (GLfloat*)draw_color);
-		}
+	s0 = _texture->u1 + (_u1 * (_texture->u2 - _texture->u1));
+	s1 = _texture->u1 + (_u2 * (_texture->u2 - _texture->u1));
+	t0 = _texture->v1 + (_v1 * (_texture->v2 - _texture->v1));
+	t1 = _texture->v1 + (_v2 * (_texture->v2 - _texture->v1));
 
-		// Disable texturing as we're using pure colour
-		glDisable(GL_TEXTURE_2D);
+	// Swap x texture coordinates if x flipping is enabled
+	if (VideoManager->_current_context.x_flip) {
+		float temp = s0;
+		s0 = s1;
+		s1 = temp;
 	}
 
-	// Use a vertex array to draw all of the vertices
-	glDrawArrays(GL_QUADS, 0, 4);
-	glDisableClientState(GL_VERTEX_ARRAY);
-
-	if (_texture)
-	    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-
-	if (glIsEnabled(GL_COLOR_ARRAY))
-		glDisableClientState(GL_COLOR_ARRAY);
+	// Swap y texture coordinates if y flipping is enabled
+	if (VideoManager->_current_context.y_flip) {
+		float temp = t0;
+		t0 = t1;
+		t1 = temp;
+	}
 
-	if (VideoManager->_current_context.blend || _blend)
-		glDisable(GL_BLEND);
+	// Place the texture coordinates in a 4x2 array mirroring the structure of the vertex array
+	float tex_coords[] = {
+		s0, t1,
+		s1, t1,
+		s1, t0,
+		s0, t0,
+	};
 
-	if (VideoManager->CheckGLError()) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occurred: "
-			<< VideoManager->CreateGLErrorString() << std::endl;
-	}
+	// Queue the quad in the video engine sprite batch, which draws it along with
+	// the other quads sharing its texture sheet and blending mode
+	VideoManager->_sprite_batch.AddQuad(_texture->texture_sheet, blend, _smooth, VideoManager->_transform,
+		vert_coords, tex_coords, draw_color);
 } // void ImageDescriptor::_DrawTexture(const Color* color_array) const
 
 
@@ -757,11 +755,29 @@ void ImageDescriptor::_GetJpgImageInfo(const std::string& filename, uint32& rows
 
 
 bool ImageDescriptor::_LoadMultiImage(vector<StillImage>& images, const string &filename,
-	const uint32 grid_rows, const uint32 grid_cols)
+	const uint32 grid_rows, const uint32 grid_cols, const ImageMemory* image_data)
 {
 	uint32 current_image;
 	uint32 x, y;
 
+	// The element textures of the multi images stored in a loaded atlas are used as they are
+	ImageTexture* const* atlas_textures = TextureManager->_GetAtlasMultiImage(filename, grid_rows, grid_cols);
+	if (atlas_textures != NULL) {
+		for (current_image = 0; current_image < grid_rows * grid_cols; current_image++) {
+			StillImage& image = images.at(current_image);
+			image._filename = filename;
+			image._texture = atlas_textures[current_image];
+			image._image_texture = atlas_textures[current_image];
+			image._texture->AddReference();
+
+			if (image._grayscale) {
+				image._grayscale = false;
+				image.EnableGrayScale();
+			}
+		}
+		return true;
+	}
+
 	bool need_load = false;
 
 	// 1D vectors storing info for each image element
@@ -789,14 +805,19 @@ bool ImageDescriptor::_LoadMultiImage(vector<StillImage>& images, const string &
 	// from disk and create enough memory to copy over individual sub-image elements from it
 	ImageMemory multi_image;
 	ImageMemory sub_image;
+	// Points either to the caller's decoded image or to the one loaded here
+	const ImageMemory* source_image = image_data;
 	if (need_load) {
-		if (multi_image.LoadImage(filename) == false) {
-			IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to load multi image file: " << filename << endl;
-			return false;
+		if (source_image == NULL) {
+			if (multi_image.LoadImage(filename) == false) {
+				IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to load multi image file: " << filename << endl;
+				return false;
+			}
+			source_image = &multi_image;
 		}
 
-		sub_image.width = multi_image.width / grid_cols;
-		sub_image.height = multi_image.height / grid_rows;
+		sub_image.width = source_image->width / grid_cols;
+		sub_image.height = source_image->height / grid_rows;
 		sub_image.pixels = malloc(sub_image.width * sub_image.height * 4);
 		if (sub_image.pixels == NULL) {
 			PRINT_ERROR << "failed to malloc memory for multi image file: " << filename << endl;
@@ -839,8 +860,8 @@ bool ImageDescriptor::_LoadMultiImage(vector<StillImage>& images, const string &
 				images.at(current_image)._filename = filename;
 
 				for (uint32 i = 0; i < sub_image.height; ++i) {
-					memcpy((uint8*)sub_image.pixels + 4 * sub_image.width * i, (uint8*)multi_image.pixels + (((x * multi_image.height / grid_rows) + i) *
-						multi_image.width + y * multi_image.width / grid_cols) * 4, 4 * sub_image.width);
+					memcpy((uint8*)sub_image.pixels + 4 * sub_image.width * i, (uint8*)source_image->pixels + (((x * source_image->height / grid_rows) + i) *
+						source_image->width + y * source_image->width / grid_cols) * 4, 4 * sub_image.width);
 				}
 
 				img = new ImageTexture(filename, tags[current_image], sub_image.width, sub_image.height);
@@ -1032,7 +1053,7 @@ void StillImage::Draw(const Color& draw_color) const {
 		return;
 	}
 
-	glPushMatrix();
+	VideoManager->PushMatrix();
 	_DrawOrientation();
 
 	float modulation = VideoManager->_screen_fader.GetFadeModulation();
@@ -1053,7 +1074,7 @@ void StillImage::Draw(const Color& draw_color) const {
 		_DrawTexture(modulated_colors);
 	}
 
-	glPopMatrix();
+	VideoManager->PopMatrix();
 } // void StillImage::Draw(const Color& draw_color) const
 
 
@@ -1611,7 +1632,7 @@ void CompositeImage::Draw(const Color& draw_color) const {
 		coord_sys.GetVerticalDirection();
 
 	// Save the draw cursor position as we move to draw each element
-	glPushMatrix();
+	VideoManager->PushMatrix();
 
 	VideoManager->MoveRelative(x_align_offset, y_align_offset);
 
@@ -1641,7 +1662,7 @@ void CompositeImage::Draw(const Color& draw_color) const {
 		x_off += x_shake;
 		y_off += y_shake;
 
-		glPushMatrix();
+		VideoManager->PushMatrix();
 		VideoManager->MoveRelative(x_off * coord_sys.GetHorizontalDirection(),
 			y_off * coord_sys.GetVerticalDirection());
 
@@ -1653,7 +1674,7 @@ void CompositeImage::Draw(const Color& draw_color) const {
 		if (coord_sys.GetVerticalDirection() < 0.0f)
 			y_scale = -y_scale;
 
-		glScalef(x_scale, y_scale, 1.0f);
+		VideoManager->Scale(x_scale, y_scale);
 
 		if (skip_modulation)
 			_elements[i].image._DrawTexture(_color);
@@ -1665,9 +1686,9 @@ void CompositeImage::Draw(const Color& draw_color) const {
 			modulated_colors[3] = _color[3] * fade_color;
 			_elements[i].image._DrawTexture(modulated_colors);
 		}
-		glPopMatrix();
+		VideoManager->PopMatrix();
 	}
-	glPopMatrix();
+	VideoManager->PopMatrix();
 } // void CompositeImage::Draw(const Color& draw_color) const
 
 
@@ -86,6 +86,7 @@ class StillImage;
 *** ***************************************************************************/
 class ImageDescriptor {
 	friend class VideoEngine;
+	friend class StaticImageBatch;
 
 public:
 	ImageDescriptor();
@@ -224,6 +225,20 @@ public:
 	static bool LoadMultiImageFromElementGrid(std::vector<StillImage>& images, const std::string& filename,
 		const uint32 grid_rows, const uint32 grid_cols);
 
+	/** \brief Loads a multi image from pixels already decoded in system memory
+	*** \param images Reference to the vector of StillImages to be loaded with elements from the multi image
+	*** \param filename The name of the multi image file the pixels were decoded from, used to identify the textures
+	*** \param image_data The decoded multi image, as filled by ImageMemory::LoadImage()
+	*** \param grid_rows The number of rows of image elements contained in the multi image
+	*** \param grid_cols The number of columns of image elements contained in the multi image
+	*** \return True upon successful loading, false if there was an error
+	***
+	*** Only the texture creation needs the OpenGL context, so this permits to decode the image file
+	*** in another thread beforehand. The image data is not freed by this function.
+	**/
+	static bool LoadMultiImageFromElementGrid(std::vector<StillImage>& images, const std::string& filename,
+		const private_video::ImageMemory& image_data, const uint32 grid_rows, const uint32 grid_cols);
+
 	/** \brief Saves a vector of images into a single image file (a multi image)
 	*** \param images A reference to the vector of StillImage pointers to save into a multi image
 	*** \param filename The name of the multi image file to write (.png of .jpg extension required)
@@ -284,7 +299,7 @@ protected:
 	***
 	*** \note This method modifies the draw cursor position and does not restore it before finishing. Therefore
 	*** under most circumstances, you will want to call VideoManager->PushState()/PopState(), or
-	*** glPushMatrix()/glPopMatrix() before and after calling this function. The latter is preferred due to the
+	*** VideoManager->PushMatrix()/PopMatrix() before and after calling this function. The latter is preferred due to the
 	*** lower cost of the call, but some circumstances may require using the former when more state information
 	*** needs to be retained.
 	**/
@@ -293,6 +308,9 @@ protected:
 	/** \brief Draws the OpenGL texture referred to by the object on the screen
 	*** \param draw_color A non-NULL pointer to an array of four valid Color objects
 	***
+	*** The quad is not drawn immediately but queued in the video engine sprite batch,
+	*** which draws it later along with the other quads using the same texture sheet.
+	***
 	*** This method is typically a helper method to other draw calls in some way. It assumes that
 	*** all of the appropriate transformation, scaling, and other image property opertaions have been
 	*** completed prior to the calling of this function. The draw_color argument is usually nothing
@@ -325,10 +343,11 @@ private:
 	*** \param filename The name of the multi image file to read
 	*** \param grid_rows The number of rows of image elements in the multi image
 	*** \param grid_cols The number of columns of image elements in the multi image
+	*** \param image_data The already decoded multi image, or NULL to read it from the file when needed
 	*** \return True if the image file was loaded and parsed successfully, false if there was an error.
 	**/
 	static bool _LoadMultiImage(std::vector<StillImage>& images, const std::string& filename,
-		const uint32 grid_rows, const uint32 grid_cols);
+		const uint32 grid_rows, const uint32 grid_cols, const private_video::ImageMemory* image_data = NULL);
 }; // class ImageDescriptor
 
 
@@ -26,6 +26,10 @@ extern "C" {
 
 #include <SDL_image.h>
 
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
 using namespace std;
 using namespace hoa_utils;
 
@@ -33,6 +37,141 @@ namespace hoa_video {
 
 namespace private_video {
 
+// -----------------------------------------------------------------------------
+// Image decoding functions
+// -----------------------------------------------------------------------------
+
+namespace {
+
+//! \brief The channel masks of 32 bits RGBA pixels, with the bytes in the R, G, B, A order
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+const uint32 RGBA_RED_MASK = 0xFF000000;
+const uint32 RGBA_GREEN_MASK = 0x00FF0000;
+const uint32 RGBA_BLUE_MASK = 0x0000FF00;
+const uint32 RGBA_ALPHA_MASK = 0x000000FF;
+#else
+const uint32 RGBA_RED_MASK = 0x000000FF;
+const uint32 RGBA_GREEN_MASK = 0x0000FF00;
+const uint32 RGBA_BLUE_MASK = 0x00FF0000;
+const uint32 RGBA_ALPHA_MASK = 0xFF000000;
+#endif
+
+//! \brief Converts a row of pixels one at a time
+void _ConvertRowToRGBA(const uint8* src, bool swap_red_blue, uint8* dst, uint32 count) {
+	const uint32 red = swap_red_blue ? 2 : 0;
+	const uint32 blue = swap_red_blue ? 0 : 2;
+
+	for (uint32 i = 0; i < count; ++i, src += 4, dst += 4) {
+		// GL_LINEAR white artifact removal
+		// Make the r,g,b values black to prevent OpenGL to make linear average with
+		// another color when smoothing.
+		// This is removing the white edges often seen on sprites.
+		if (src[3] == 0) {
+			dst[0] = 0;
+			dst[1] = 0;
+			dst[2] = 0;
+			dst[3] = 0;
+		}
+		else {
+			dst[0] = src[red];
+			dst[1] = src[1];
+			dst[2] = src[blue];
+			dst[3] = src[3];
+		}
+	}
+}
+
+#ifdef __SSE2__
+//! \brief Converts a row of pixels four at a time. SSE2 is only available on little endian processors.
+void _ConvertRowToRGBA_SSE2(const uint8* src, bool swap_red_blue, uint8* dst, uint32 count) {
+	const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+	const __m128i alpha_green_mask = _mm_set1_epi32(0xFF00FF00);
+	const __m128i low_byte_mask = _mm_set1_epi32(0x000000FF);
+	const __m128i zero = _mm_setzero_si128();
+
+	uint32 i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+
+		// Swap the first and third bytes of each pixel
+		if (swap_red_blue) {
+			__m128i alpha_green = _mm_and_si128(pixels, alpha_green_mask);
+			__m128i red = _mm_and_si128(_mm_srli_epi32(pixels, 16), low_byte_mask);
+			__m128i blue = _mm_slli_epi32(_mm_and_si128(pixels, low_byte_mask), 16);
+			pixels = _mm_or_si128(alpha_green, _mm_or_si128(red, blue));
+		}
+
+		// Clear the fully transparent pixels
+		__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(pixels, alpha_mask), zero);
+		pixels = _mm_andnot_si128(transparent, pixels);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), pixels);
+	}
+
+	// The remaining pixels
+	_ConvertRowToRGBA(src + i * 4, swap_red_blue, dst + i * 4, count - i);
+}
+#endif
+
+} // namespace
+
+
+
+SDL_Surface* DecodeImageFile(const string& filename, bool& swap_red_blue) {
+	SDL_Surface* surface = IMG_Load(filename.c_str());
+	if (surface == NULL) {
+		PRINT_ERROR << "Couldn't load image file: " << filename << endl;
+		return NULL;
+	}
+
+	// 32 bits images with an alpha channel, which is what most of the game images are, are used as is
+	const SDL_PixelFormat* format = surface->format;
+	if (format->BytesPerPixel == 4 && format->Amask == RGBA_ALPHA_MASK && format->Gmask == RGBA_GREEN_MASK
+			&& (surface->flags & SDL_SRCCOLORKEY) == 0) {
+		if (format->Rmask == RGBA_RED_MASK && format->Bmask == RGBA_BLUE_MASK) {
+			swap_red_blue = false;
+			return surface;
+		}
+		if (format->Rmask == RGBA_BLUE_MASK && format->Bmask == RGBA_RED_MASK) {
+			swap_red_blue = true;
+			return surface;
+		}
+	}
+
+	// Other images are converted to RGBA. SDL_ConvertSurface() turns the color key into an alpha channel.
+	SDL_Surface* rgba_surface = SDL_CreateRGBSurface(SDL_SWSURFACE, 1, 1, 32,
+		RGBA_RED_MASK, RGBA_GREEN_MASK, RGBA_BLUE_MASK, RGBA_ALPHA_MASK);
+	if (rgba_surface == NULL) {
+		PRINT_ERROR << "Couldn't create the RGBA surface needed to convert: " << filename << endl;
+		SDL_FreeSurface(surface);
+		return NULL;
+	}
+
+	SDL_Surface* converted = SDL_ConvertSurface(surface, rgba_surface->format,
+		SDL_SWSURFACE | (surface->flags & SDL_SRCALPHA));
+	SDL_FreeSurface(rgba_surface);
+	SDL_FreeSurface(surface);
+	if (converted == NULL) {
+		PRINT_ERROR << "Couldn't convert image file to RGBA: " << filename << endl;
+		return NULL;
+	}
+
+	swap_red_blue = false;
+	return converted;
+}
+
+
+
+void ConvertToRGBA(const uint8* src, uint32 src_pitch, bool swap_red_blue, uint8* dst, uint32 width, uint32 height) {
+	for (uint32 y = 0; y < height; ++y) {
+#ifdef __SSE2__
+		_ConvertRowToRGBA_SSE2(src + y * src_pitch, swap_red_blue, dst + y * width * 4, width);
+#else
+		_ConvertRowToRGBA(src + y * src_pitch, swap_red_blue, dst + y * width * 4, width);
+#endif
+	}
+}
+
 // -----------------------------------------------------------------------------
 // ImageMemory class
 // -----------------------------------------------------------------------------
@@ -59,87 +198,44 @@ ImageMemory::~ImageMemory() {
 
 
 bool ImageMemory::LoadImage(const string& filename) {
+	if (TextureManager != NULL && TextureManager->_TakePrefetchedImage(filename, *this))
+		return true;
+
+	return DecodeImage(filename);
+}
+
+
+
+bool ImageMemory::DecodeImage(const string& filename) {
 	if (pixels != NULL) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "pixels member was not NULL upon function invocation" << endl;
 		free(pixels);
 		pixels = NULL;
 	}
 
-	SDL_Surface* temp_surf = NULL;
-	SDL_Surface* alpha_surf = NULL;
-
-	if((temp_surf = IMG_Load(filename.c_str())) == NULL) {
-		PRINT_ERROR << "Couldn't load image file: " << filename << endl;
+	bool swap_red_blue = false;
+	SDL_Surface* surface = DecodeImageFile(filename, swap_red_blue);
+	if (surface == NULL)
 		return false;
-	}
-
-	alpha_surf = SDL_DisplayFormatAlpha(temp_surf);
-
-	// Tells whether the alpha image will be used
-	bool alpha_format = true;
-	if(alpha_surf == NULL) {
-		// use the default image in that case
-		alpha_surf = temp_surf;
-		alpha_format = false;
-	}
-	else {
-		SDL_FreeSurface(temp_surf);
-	}
 
 	// Now allocate the pixel values
-	width = alpha_surf->w;
-	height = alpha_surf->h;
+	width = surface->w;
+	height = surface->h;
 	pixels = malloc(width * height * 4);
 	rgb_format = false;
+	if (pixels == NULL) {
+		PRINT_ERROR << "failed to malloc memory for image file: " << filename << endl;
+		SDL_FreeSurface(surface);
+		return false;
+	}
 
 	// convert the data so that it works in our format
-	uint8* img_pixel = NULL;
-	uint8* dst_pixel = NULL;
-
-	for (uint32 y = 0; y < height; ++y) {
-		for (uint32 x = 0; x < width; ++x) {
-			img_pixel = (uint8*)alpha_surf->pixels + y * alpha_surf->pitch + x * alpha_surf->format->BytesPerPixel;
-			dst_pixel = ((uint8*)pixels) + ((y * width) + x) * 4;
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-			if (alpha_format) {
-				dst_pixel[0] = img_pixel[0];
-				dst_pixel[1] = img_pixel[1];
-				dst_pixel[2] = img_pixel[2];
-				dst_pixel[3] = img_pixel[3];
-			}
-			else {
-				dst_pixel[2] = img_pixel[0];
-				dst_pixel[1] = img_pixel[1];
-				dst_pixel[0] = img_pixel[2];
-				dst_pixel[3] = img_pixel[3];
-			}
-#else
-			if (alpha_format) {
-				dst_pixel[2] = img_pixel[0];
-				dst_pixel[1] = img_pixel[1];
-				dst_pixel[0] = img_pixel[2];
-				dst_pixel[3] = img_pixel[3];
-			}
-			else {
-				dst_pixel[0] = img_pixel[0];
-				dst_pixel[1] = img_pixel[1];
-				dst_pixel[2] = img_pixel[2];
-				dst_pixel[3] = img_pixel[3];
-			}
-#endif
-			// GL_LINEAR white artifact removal
-			// Make the r,g,b values black to prevent OpenGL to make linear average with
-			// another color when smoothing.
-			// This is removing the white edges often seen on sprites.
-			if (dst_pixel[3] == 0) {
-				dst_pixel[0] = 0;
-				dst_pixel[1] = 0;
-				dst_pixel[2] = 0;
-			}
-		}
-	}
+	SDL_LockSurface(surface);
+	ConvertToRGBA(static_cast<const uint8*>(surface->pixels), surface->pitch, swap_red_blue,
+		static_cast<uint8*>(pixels), width, height);
+	SDL_UnlockSurface(surface);
 
-	SDL_FreeSurface(alpha_surf);
+	SDL_FreeSurface(surface);
 	return true;
 }
 
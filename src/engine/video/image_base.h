@@ -45,6 +45,29 @@ namespace hoa_video {
 
 namespace private_video {
 
+/** \brief Decodes an image file into a 32 bits per pixel surface
+*** \param filename The filename of the image to decode
+*** \param swap_red_blue Set to true if the surface pixels are in BGRA order, false if they are in RGBA order
+*** \return The decoded surface, to be freed with SDL_FreeSurface(), or NULL if the file could not be decoded
+***
+*** The pixels of images in other formats are converted to RGBA, and their color key is turned into
+*** transparent pixels. This function uses neither OpenGL nor the video surface, and can be called from any thread.
+**/
+SDL_Surface* DecodeImageFile(const std::string& filename, bool& swap_red_blue);
+
+/** \brief Converts 32 bits per pixel data to the RGBA format used by the textures
+*** \param src A pointer to the first source row
+*** \param src_pitch The length of a source row, in bytes
+*** \param swap_red_blue True if the source pixels are in BGRA order, false if they are in RGBA order
+*** \param dst The destination buffer, of width * height * 4 bytes
+*** \param width The width of the image, in pixels
+*** \param height The height of the image, in pixels
+***
+*** The color of fully transparent pixels is set to black, to prevent OpenGL linear filtering from blending
+*** it with the neighbouring visible pixels. The pixels are processed four at a time when SSE2 is available.
+**/
+void ConvertToRGBA(const uint8* src, uint32 src_pitch, bool swap_red_blue, uint8* dst, uint32 width, uint32 height);
+
 /** ****************************************************************************
 *** \brief A wrapper around an image buffer in system memory
 ***
@@ -80,9 +103,19 @@ public:
 	/** \brief Loads raw image data from a file and stores the data in the class members
 	*** \param file_name The filename of the image to load, which should have a .png or .jpg extension
 	*** \return True if the image was loaded successfully, false if it was not
+	***
+	*** If the file was given to TextureController::PrefetchImages(), the pixels already decoded by the
+	*** prefetching thread are used. Otherwise, the file is decoded with DecodeImage().
 	**/
 	bool LoadImage(const std::string& filename);
 
+	/** \brief Decodes an image file and stores the data in the class members
+	*** \param file_name The filename of the image to decode, which should have a .png or .jpg extension
+	*** \return True if the image was decoded successfully, false if it was not
+	*** \note This function doesn't need the OpenGL context and can be called from any thread.
+	**/
+	bool DecodeImage(const std::string& filename);
+
 	/** \brief Saves raw image data to a file
 	*** \param file_name The full filename of the image to load
 	*** \param png_image Set to true if this is a PNG image, or false if it is a JPG image
@@ -12,11 +12,9 @@
  * \author  Raj Sharma, roos@allacrost.org
  * \brief   Header file for particle data
  *
- * This file contains structure(s) for representing a single particle. In theory,
- * we should be able to just have one structure which holds all properties for
- * a particle, but in fact we have two: one for the position, and one for everything
- * else. The reason is that having the positions separated is more efficient
- * for rendering.
+ * This file contains the structures representing the particles of a system.
+ * The particle properties are kept in separate arrays, which is more efficient
+ * both for updating and for rendering them.
  *****************************************************************************/
 
 #ifndef __PARTICLE_HEADER__
@@ -62,101 +60,170 @@ public:
 
 
 /*!***************************************************************************
- *  \brief this is the structure we use to represent a particle
+ *  \brief small and fast pseudo-random number generator (xorshift). Each
+ *         particle system owns one, so that spawning particles doesn't go
+ *         through rand() and its modulo for every random property.
  *****************************************************************************/
 
+class ParticleRandom
+{
+public:
+
+	ParticleRandom()
+	{ Seed(0); }
+
+	//! \brief starts a new random sequence
+	void Seed(uint32 seed)
+	{
+		_state = seed ^ 0x9E3779B9;
+		if(_state == 0)
+			_state = 1;
+	}
+
+	//! \brief returns the next random 32 bit number of the sequence
+	uint32 Next()
+	{
+		_state ^= _state << 13;
+		_state ^= _state >> 17;
+		_state ^= _state << 5;
+		return _state;
+	}
+
+	//! \brief returns a random float between a and b
+	float Float(float a, float b)
+	{ return a + (b - a) * (static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f)); }
+
+private:
+
+	uint32 _state;
+};
+
+
+/*!***************************************************************************
+ *  \brief the particles of a system, stored as one array per property
+ *         (structure of arrays). This way, the update loops go through
+ *         contiguous floats, which the compiler can vectorize.
+ *
+ *  The keyframed properties (size, rotation speed and color) are interpolated
+ *  between a "from" and a "to" value, which already include the random
+ *  variations of the current and next keyframes. They only have to be
+ *  computed again when a particle reaches its next keyframe.
+ *****************************************************************************/
 
-class Particle
+class ParticleArrays
 {
 public:
 
+	/*!
+	 *  \brief sets the number of particles the arrays can hold
+	 */
+	void Resize(int32 num_particles);
+
+	/*!
+	 *  \brief frees the arrays
+	 */
+	void Clear();
+
+	/*!
+	 *  \brief copies every property of the particle at src to dest
+	 */
+	void Copy(int32 src, int32 dest);
+
 	//! position
-	float  x;
-	float  y;
+	std::vector<float> x;
+	std::vector<float> y;
 
 	//! size
-	float  size_x;
-	float  size_y;
+	std::vector<float> size_x;
+	std::vector<float> size_y;
 
 	//! velocity
-	float  velocity_x;
-	float  velocity_y;
+	std::vector<float> velocity_x;
+	std::vector<float> velocity_y;
 
 	//! store the combined velocity (particle + wind + wave) so we only have
 	//! to calculate it once
-	float combined_velocity_x;
-	float combined_velocity_y;
+	std::vector<float> combined_velocity_x;
+	std::vector<float> combined_velocity_y;
 
 	//! color
-	hoa_video::Color  color;
+	std::vector<hoa_video::Color> color;
 
 	//! current rotation angle
-	float  rotation_angle;
+	std::vector<float> rotation_angle;
 
 	//! rotation speed
-	float  rotation_speed;
+	std::vector<float> rotation_speed;
+
+	//! when a particle is created, it is given a rotation direction: either
+	//! 1 (clockwise) or -1 (counterclockwise)
+	std::vector<float> rotation_direction;
 
 	//! seconds since particle was spawned
-	float  time;
+	std::vector<float> time;
 
 	//! lifetime (when the particle is supposed to die)
-	float  lifetime;
+	std::vector<float> lifetime;
 
 	//! this is 2 * pi / wavelength. The reason we store this weird
 	//! number instead of the wavelength is because that's what we
 	//! will ultimately plug into the sin function
-	float wave_length_coefficient;
+	std::vector<float> wave_length_coefficient;
 
 	//! half the amplitude of the wave. We store half the amplitude
 	//! instead of the whole amplitude because that's what gets multiplied
 	//! with the sin function
-	float wave_half_amplitude;
+	std::vector<float> wave_half_amplitude;
 
 	//! acceleration, i.e. change in velocity per second. The most common use
 	//! for this is for simulating gravity. If you have multiple constant
 	//! forces acting on particles, then this vector should be the sum of
 	//! those forces.
-	float acceleration_x;
-	float acceleration_y;
+	std::vector<float> acceleration_x;
+	std::vector<float> acceleration_y;
 
 	//! tangential acceleration- just like normal acceleration, except it
 	//! is applied in the tangent direction. positive = clockwise.
-	float tangential_acceleration;
+	std::vector<float> tangential_acceleration;
 
 	//! radial acceleration- acceleration towards (negative) or away (positive)
 	//! from an attractor. Note that the default attractor is the emitter position.
 	//! The client can set an attractor for the entire effect by calling
 	//! ParticleEffect::SetAttractor(x,y)
-	float radial_acceleration;
+	std::vector<float> radial_acceleration;
 
 	//! wind velocity. this gets added to the particle's velocity each frame.
 	//! note that different particles might also have a slightly different wind
 	//! velocity, if the system has some wind velocity variation
-	float wind_velocity_x;
-	float wind_velocity_y;
+	std::vector<float> wind_velocity_x;
+	std::vector<float> wind_velocity_y;
 
 	//! damping- the particle's velocity gets multiplied by this value each second.
 	//! So for example, a damping of .6 means that a particle slows down by 40% each
 	//! second.
-	float damping;
-
-	//! when a particle is created, it is given a rotation direction: either
-	//! 1 (clockwise) or -1 (counterclockwise)
-	float rotation_direction;
-
-	//! property variations
-	float current_size_variation_x;
-	float current_size_variation_y;
-	float next_size_variation_x;
-	float next_size_variation_y;
-	float current_rotation_speed_variation;
-	float next_rotation_speed_variation;
-	hoa_video::Color current_color_variation;
-	hoa_video::Color next_color_variation;
-
-	//! keep track of current and next keyframes
-	ParticleKeyframe *current_keyframe;
-	ParticleKeyframe *next_keyframe;
+	std::vector<float> damping;
+
+	//! index of the current keyframe, and the segment to the next one,
+	//! copied from ParticleSystemDef::keyframe_segments
+	std::vector<uint32> keyframe;
+	std::vector<float> keyframe_start_time;
+	std::vector<float> keyframe_end_time;
+	std::vector<float> keyframe_inv_duration;
+
+	//! keyframed property values at the current and next keyframes,
+	//! variations included
+	std::vector<float> rotation_speed_from;
+	std::vector<float> rotation_speed_to;
+	std::vector<float> size_x_from;
+	std::vector<float> size_x_to;
+	std::vector<float> size_y_from;
+	std::vector<float> size_y_to;
+	std::vector<hoa_video::Color> color_from;
+	std::vector<hoa_video::Color> color_to;
+
+	//! scratch array holding the progress of each particle between its
+	//! keyframes, computed again on each update
+	std::vector<float> keyframe_progress;
 };
 
 } // hoa_mode_manager
@@ -28,6 +28,42 @@ ParticleEffect::ParticleEffect()
 	_age = 0.0f;
 	_effect_def = NULL;
 	_orientation = 0.0f;
+	_num_particles = 0;
+}
+
+
+ParticleEffect::~ParticleEffect()
+{
+	_Destroy();
+
+	list<ParticleSystem *>::iterator iSystem = _systems.begin();
+	while(iSystem != _systems.end())
+	{
+		delete (*iSystem);
+		++iSystem;
+	}
+	_systems.clear();
+}
+
+
+ParticleEffectDef::ParticleEffectDef() :
+	effect_collision_width(0.0f),
+	effect_collision_height(0.0f),
+	ref_count(0)
+{}
+
+
+ParticleEffectDef::~ParticleEffectDef()
+{
+	for(size_t i = 0; i < effect_pool.size(); ++i)
+		delete effect_pool[i];
+
+	std::list<ParticleSystemDef *>::iterator iSystem = _systems.begin();
+	while(iSystem != _systems.end())
+	{
+		delete (*iSystem);
+		++iSystem;
+	}
 }
 
 bool ParticleEffect::_Draw()
@@ -41,6 +77,13 @@ bool ParticleEffect::_Draw()
 
 	while(iSystem != _systems.end())
 	{
+		// Dead systems are kept, so that the effect can be restarted
+		if(!(*iSystem)->IsAlive())
+		{
+			++iSystem;
+			continue;
+		}
+
 		VideoManager->PushMatrix();
 		if(!(*iSystem)->Draw())
 		{
@@ -81,17 +124,12 @@ bool ParticleEffect::_Update(float frame_time)
 
 	list<ParticleSystem *>::iterator iSystem = _systems.begin();
 
+	// The dead systems are kept along with their buffers, so that the effect
+	// can be restarted or reused without any allocation
+	bool systems_alive = false;
 	while(iSystem != _systems.end())
 	{
-		if(!(*iSystem)->IsAlive())
-		{
-			(*iSystem)->Destroy();
-			iSystem = _systems.erase(iSystem);
-
-			if(_systems.empty())
-				_alive = false;
-		}
-		else
+		if((*iSystem)->IsAlive())
 		{
 			if(!(*iSystem)->Update(frame_time, effect_parameters))
 			{
@@ -101,10 +139,14 @@ bool ParticleEffect::_Update(float frame_time)
 			}
 
 			_num_particles += (*iSystem)->GetNumParticles();
-			++iSystem;
+			systems_alive = systems_alive || (*iSystem)->IsAlive();
 		}
+		++iSystem;
 	}
 
+	if(!systems_alive)
+		_alive = false;
+
 	return success;
 }
 
@@ -121,6 +163,22 @@ void ParticleEffect::_Destroy()
 }
 
 
+void ParticleEffect::_Restart()
+{
+	list<ParticleSystem *>::iterator iSystem = _systems.begin();
+
+	while(iSystem != _systems.end())
+	{
+		(*iSystem)->Reset();
+		++iSystem;
+	}
+
+	_alive = true;
+	_age = 0.0f;
+	_num_particles = 0;
+}
+
+
 void ParticleEffect::Move(float x, float y)
 {
 	_x = x;
@@ -54,6 +54,13 @@ namespace hoa_mode_manager
 class ParticleEffectDef
 {
 public:
+	ParticleEffectDef();
+
+	/*!
+	 *  \brief Destructor, deletes the system definitions and the pooled effects
+	 */
+	~ParticleEffectDef();
+
 
 	/** The effect size in pixels, used to know when to display it when it used as
 	*** a map object fir instance. It is used to compute the image rectangle.
@@ -64,6 +71,16 @@ public:
 
 	//! list of system definitions
 	std::list<ParticleSystemDef *> _systems;
+
+	//! The file the definition was loaded from, used as its key in the particle manager cache
+	std::string filename;
+
+	//! The number of effects created from this definition and not released yet, plus the
+	//! number of preloads. The definition is removed from the cache when it drops to zero.
+	int32 ref_count;
+
+	//! Released effects created from this definition, kept so that they can be reused
+	std::vector<ParticleEffect *> effect_pool;
 };
 
 
@@ -82,6 +99,11 @@ public:
 	 */
 	ParticleEffect();
 
+	/*!
+	 *  \brief Destructor, deletes the particle systems
+	 */
+	~ParticleEffect();
+
 
 	/*!
 	 *  \brief moves the effect to the specified position on the screen,
@@ -199,9 +221,15 @@ private:
 	 */
 	void _Destroy();
 
+	/*!
+	 *  \brief starts the effect and all of its systems over again, keeping the
+	 *         current position. Used to restart or to reuse an effect.
+	 */
+	void _Restart();
+
 
 	//! pointer to the effect definition
-	const ParticleEffectDef *_effect_def;
+	ParticleEffectDef *_effect_def;
 
 	//! list of subsystems that make up the effect. (for example, a fire effect might consist
 	//! of a flame + smoke + embers)
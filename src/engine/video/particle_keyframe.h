@@ -75,6 +75,25 @@ public:
 	float time;
 };
 
+
+/*!***************************************************************************
+ *  \brief the time span between a keyframe and the next one, precomputed
+ *         when loading a system definition so that the particles don't have
+ *         to look up the keyframes on every update.
+ *****************************************************************************/
+
+class ParticleKeyframeSegment
+{
+public:
+
+	//! time of the keyframe, and of the next one. The last keyframe ends at FLT_MAX
+	float start_time;
+	float end_time;
+
+	//! 1 / (end_time - start_time), or 0 for the last keyframe
+	float inv_duration;
+};
+
 }  // namespace hoa_mode_manager
 
 #endif  //! __PARTICLE_KEYFRAME_HEADER__
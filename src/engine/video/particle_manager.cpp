@@ -10,20 +10,25 @@
 #include "engine/video/particle_manager.h"
 
 #include "engine/video/video.h"
+#include "engine/profiler.h"
 #include "engine/script/script_read.h"
 
 #include "engine/video/particle_effect.h"
 #include "engine/video/particle_system.h"
 #include "engine/video/particle_keyframe.h"
 
+#include <algorithm>
+
 using namespace hoa_script;
 using namespace hoa_video;
 
 namespace hoa_mode_manager {
 
+std::map<std::string, ParticleEffectDef*> ParticleManager::_effect_defs;
+
 // The static version, to handle outside the particle manager
 ParticleEffect* ParticleManager::CreateEffect(const std::string& filename) {
-	ParticleEffectDef *def = _LoadEffect(filename);
+	ParticleEffectDef *def = _GetEffectDef(filename);
 
 	if (!def) {
 		PRINT_WARNING << "Failed to load particle definition file: "
@@ -40,9 +45,25 @@ ParticleEffect* ParticleManager::CreateEffect(const std::string& filename) {
 	return effect;
 }
 
+void ParticleManager::ReleaseEffect(ParticleEffect* effect) {
+	if (!effect)
+		return;
+
+	ParticleEffectDef *def = effect->_effect_def;
+	if (!def) {
+		delete effect;
+		return;
+	}
+
+	// Keep the effect for reuse, it is deleted along with its definition otherwise
+	effect->_alive = false;
+	def->effect_pool.push_back(effect);
+	_ReleaseEffectDef(def);
+}
+
 ParticleEffect* ParticleManager::AddParticleEffect(const std::string& filename, float x, float y)
 {
-	ParticleEffectDef *def = _LoadEffect(filename);
+	ParticleEffectDef *def = _GetEffectDef(filename);
 
 	if (!def) {
 		PRINT_WARNING << "Failed to load particle definition file: "
@@ -50,6 +71,20 @@ ParticleEffect* ParticleManager::AddParticleEffect(const std::string& filename,
 		return 0;
 	}
 
+	// Reuse a dead effect of the same kind when there is one
+	std::vector<ParticleEffect*>::iterator it = _all_effects.begin();
+	for (; it != _all_effects.end(); ++it) {
+		ParticleEffect *effect = *it;
+		if (effect->_effect_def != def || effect->IsAlive())
+			continue;
+
+		effect->_Restart();
+		effect->Move(x, y);
+		if (std::find(_active_effects.begin(), _active_effects.end(), effect) == _active_effects.end())
+			_active_effects.push_back(effect);
+		return effect;
+	}
+
 	ParticleEffect *effect = _AddEffect(def, x, y);
 	if (!effect) {
 		PRINT_WARNING << "Failed to add effect to particle manager from: "
@@ -59,6 +94,42 @@ ParticleEffect* ParticleManager::AddParticleEffect(const std::string& filename,
 	return effect;
 }
 
+bool ParticleManager::PreloadEffect(const std::string& filename)
+{
+	ParticleEffectDef *def = _GetEffectDef(filename);
+
+	if (!def) {
+		PRINT_WARNING << "Failed to load particle definition file: "
+		    << filename << std::endl;
+		return false;
+	}
+
+	++def->ref_count;
+	_preloaded_defs.push_back(def);
+
+	// Have an instance ready to be reused
+	if (def->effect_pool.empty())
+		ReleaseEffect(_CreateEffect(def));
+
+	return true;
+}
+
+void ParticleManager::PurgeEffect(const std::string& filename)
+{
+	std::vector<ParticleEffectDef*>::iterator it = _preloaded_defs.begin();
+	for (; it != _preloaded_defs.end(); ++it) {
+		if ((*it)->filename == filename) {
+			ParticleEffectDef *def = *it;
+			_preloaded_defs.erase(it);
+			_ReleaseEffectDef(def);
+			return;
+		}
+	}
+
+	IF_PRINT_WARNING(VIDEO_DEBUG) << "The particle effect was not preloaded: "
+		<< filename << std::endl;
+}
+
 bool ParticleManager::RestartParticleEffect(ParticleEffect *effect) {
 	if (!effect)
 		return false;
@@ -76,8 +147,7 @@ bool ParticleManager::RestartParticleEffect(ParticleEffect *effect) {
 		return false;
 
 	// Actually restart the effect
-	effect->_alive = true;
-	effect->_age = 0.0f;
+	effect->_Restart();
 
 	// Check whether the effect needs to be activated again
 	found = false;
@@ -95,7 +165,32 @@ bool ParticleManager::RestartParticleEffect(ParticleEffect *effect) {
 	return true;
 }
 
-ParticleEffectDef *ParticleManager::_LoadEffect(const std::string& particle_file)
+ParticleEffectDef *ParticleManager::_GetEffectDef(const std::string& filename)
+{
+	std::map<std::string, ParticleEffectDef*>::iterator it = _effect_defs.find(filename);
+	if (it != _effect_defs.end())
+		return it->second;
+
+	ParticleEffectDef *def = LoadEffectDef(filename);
+	if (!def)
+		return NULL;
+
+	def->filename = filename;
+	_effect_defs[filename] = def;
+	return def;
+}
+
+void ParticleManager::_ReleaseEffectDef(ParticleEffectDef* def)
+{
+	--def->ref_count;
+	if (def->ref_count > 0)
+		return;
+
+	_effect_defs.erase(def->filename);
+	delete def;
+}
+
+ParticleEffectDef *ParticleManager::LoadEffectDef(const std::string& particle_file)
 {
 	hoa_script::ReadScriptDescriptor particle_script;
 	if (!particle_script.OpenFile(particle_file)) {
@@ -248,6 +343,8 @@ ParticleEffectDef *ParticleManager::_LoadEffect(const std::string& particle_file
 		// pop the keyframes table
 		particle_script.CloseTable();
 
+		sys_def->ComputeKeyframeSegments();
+
 		// open up the animation_frames table
 		particle_script.ReadStringVector("animation_frames", sys_def->animation_frame_filenames);
 
@@ -359,7 +456,7 @@ ParticleEffectDef *ParticleManager::_LoadEffect(const std::string& particle_file
 	return def;
 }
 
-ParticleEffect* ParticleManager::_AddEffect(const ParticleEffectDef *def, float x, float y)
+ParticleEffect* ParticleManager::_AddEffect(ParticleEffectDef *def, float x, float y)
 {
 	if (!def) {
 		IF_PRINT_WARNING(VIDEO_DEBUG)
@@ -424,6 +521,8 @@ bool ParticleManager::Draw()
 
 bool ParticleManager::Update(int32 frame_time)
 {
+	PROFILE_ZONE("ParticleManager::Update");
+
 	float frame_time_seconds = static_cast<float>(frame_time) / 1000.0f;
 
 	std::vector<ParticleEffect*>::iterator it = _active_effects.begin();
@@ -467,16 +566,19 @@ void ParticleManager::StopAll(bool kill_immediate)
 }
 
 void ParticleManager::_Destroy() {
-    // Clear out every effects.
+    // Clear out every effects. They are kept for reuse while their definition is cached.
 	std::vector<ParticleEffect*>::iterator it = _all_effects.begin();
 	for (; it != _all_effects.end(); ++it) {
-		(*it)->_Destroy();
-		delete (*it);
+		ReleaseEffect(*it);
 	}
 	_all_effects.clear();
 	// Clear the active effect pointer references
 	_active_effects.clear();
 
+	// Release the preloaded definitions
+	for (uint32 i = 0; i < _preloaded_defs.size(); ++i)
+		_ReleaseEffectDef(_preloaded_defs[i]);
+	_preloaded_defs.clear();
 }
 
 // A helper function reading a lua subtable of 4 float values.
@@ -493,8 +595,21 @@ Color ParticleManager::_ReadColor(hoa_script::ReadScriptDescriptor& particle_scr
 	return new_color;
 }
 
-ParticleEffect *ParticleManager::_CreateEffect(const ParticleEffectDef *def)
+ParticleEffect *ParticleManager::_CreateEffect(ParticleEffectDef *def)
 {
+	// Reuse an unused effect of the definition when there is one
+	if (!def->effect_pool.empty()) {
+		ParticleEffect *effect = def->effect_pool.back();
+		def->effect_pool.pop_back();
+
+		effect->_Restart();
+		effect->Move(0.0f, 0.0f);
+		effect->SetOrientation(0.0f);
+		effect->SetAttractorPoint(0.0f, 0.0f);
+		++def->ref_count;
+		return effect;
+	}
+
 	std::list<ParticleSystemDef *>::const_iterator iSystem = def->_systems.begin();
 	std::list<ParticleSystemDef *>::const_iterator iEnd = def->_systems.end();
 
@@ -515,14 +630,13 @@ ParticleEffect *ParticleManager::_CreateEffect(const ParticleEffectDef *def)
 				sys->Destroy();
 				delete sys;
 
-				std::list<ParticleSystem *>::iterator iEffectSystem = effect->_systems.begin();
-				std::list<ParticleSystem *>::iterator iEffectEnd = effect->_systems.end();
+				// the effect destructor deletes the systems already created
+				delete effect;
 
-				while(iEffectSystem != iEffectEnd)
-				{
-					(*iEffectSystem)->Destroy();
-					delete (*iEffectSystem);
-					++iEffectSystem;
+				// don't keep a definition nothing uses in the cache
+				if (def->ref_count <= 0) {
+					_effect_defs.erase(def->filename);
+					delete def;
 				}
 
 				IF_PRINT_WARNING(VIDEO_DEBUG)
@@ -537,6 +651,7 @@ ParticleEffect *ParticleManager::_CreateEffect(const ParticleEffectDef *def)
 
 	effect->_alive = true;
 	effect->_age = 0.0f;
+	++def->ref_count;
 	return effect;
 }
 
@@ -15,6 +15,12 @@
  * The particle manager is very simple. Every time you want to draw an effect,
  * you call AddEffect() with a pointer to the effect definition structure.
  * Then every frame, call Update() and Draw() to draw all the effects.
+ *
+ * The effect definitions are cached and shared by all the particle managers.
+ * A definition stays in the cache as long as an effect created from it exists,
+ * or a manager has preloaded it. The effects no longer used are kept along
+ * with their definition, so that new effects can reuse them instead of being
+ * allocated.
  *****************************************************************************/
 
 #ifndef __PARTICLE_MANAGER_HEADER__
@@ -23,6 +29,8 @@
 #include "defs.h"
 #include "utils.h"
 
+#include <map>
+
 namespace hoa_mode_manager
 {
 
@@ -38,7 +46,9 @@ public:
 	/*!
 	 *  \brief Constructor
 	 */
-	ParticleManager() {}
+	ParticleManager():
+		_num_particles(0)
+	{}
 
 	~ParticleManager()
 		{ _Destroy(); }
@@ -51,9 +61,29 @@ public:
 	 * \param x x coordinate of where to add the effect
 	 * \param y y coordinate of where to add the effect
 	 * \return The effect pointer
+	 *
+	 * \note A dead effect of the same file is reused when available, so the
+	 *       pointer to an effect may be returned again once the effect has died.
 	 */
 	ParticleEffect* AddParticleEffect(const std::string& filename, float x, float y);
 
+	/*!
+	 *  \brief loads an effect definition and one instance of it in advance, so that
+	 *         adding the effect later neither reads its file nor allocates memory.
+	 *         The definition stays cached until this manager is destroyed or
+	 *         PurgeEffect() is called.
+	 * \param filename the effect filename to preload
+	 * \return Whether the effect could be loaded
+	 */
+	bool PreloadEffect(const std::string& filename);
+
+	/*!
+	 *  \brief releases an effect definition preloaded by this manager. It is
+	 *         removed from the cache once no effect uses it anymore.
+	 * \param filename the effect filename given to PreloadEffect()
+	 */
+	void PurgeEffect(const std::string& filename);
+
 	/*!
 	 *  \brief Restart the given particle effect
 	 *  \return Whether the effect successfully restarted.
@@ -98,6 +128,20 @@ public:
 	**/
 	static ParticleEffect* CreateEffect(const std::string& filename);
 
+	/** Releases an effect created with CreateEffect(). The effect is kept for reuse
+	*** as long as its definition is cached, and deleted otherwise.
+	*** \param effect The effect to release, which must not be used afterwards
+	**/
+	static void ReleaseEffect(ParticleEffect* effect);
+
+	/*!
+	 *  \brief loads an effect definition from a particle file, bypassing the
+	 *         definition cache. The caller owns the returned definition.
+	 * \param filename file to load the effect from
+	 * \return handle to the effect definition, or NULL if it could not be loaded
+	 */
+	static ParticleEffectDef* LoadEffectDef(const std::string& filename);
+
 private:
 	/*!
 	 *  \brief destroys the system. Called by VideoEngine's destructor
@@ -105,11 +149,19 @@ private:
 	void _Destroy();
 
 	/*!
-	 *  \brief loads an effect definition from a particle file
+	 *  \brief returns the cached definition of an effect, loading it if needed.
+	 *         No reference is added to the definition.
 	 * \param filename file to load the effect from
-	 * \return handle to the effect
+	 * \return the effect definition, or NULL if it could not be loaded
 	 */
-	static ParticleEffectDef* _LoadEffect(const std::string& filename);
+	static ParticleEffectDef* _GetEffectDef(const std::string& filename);
+
+	/*!
+	 *  \brief removes a reference to an effect definition, and deletes it
+	 *         along with its unused effects when it isn't used anymore.
+	 * \param def the effect definition to release
+	 */
+	static void _ReleaseEffectDef(ParticleEffectDef* def);
 
 	/*!
 	 *  \brief creates a new instance of an effect at (x,y), given its definition.
@@ -120,15 +172,15 @@ private:
 	 * \param y y coordinate of where to add the effect
 	 * \return The effect pointer
 	 */
-	ParticleEffect* _AddEffect(const ParticleEffectDef *def, float x, float y);
+	ParticleEffect* _AddEffect(ParticleEffectDef *def, float x, float y);
 
 	/*!
 	*  \brief Helper function to initialize a new ParticleEffect from its definition.
-	*	      Used by AddEffect()
+	*	      Used by AddEffect(). An unused effect of the definition is reused when available.
 	* \param def definition used to create the effect
 	* \return the effect created with the specified definition
 	*/
-	static ParticleEffect *_CreateEffect(const ParticleEffectDef *def);
+	static ParticleEffect *_CreateEffect(ParticleEffectDef *def);
 
 	//! \brief Helper function used to read a color subtable.
 	static hoa_video::Color _ReadColor(hoa_script::ReadScriptDescriptor& particle_script,
@@ -139,6 +191,12 @@ private:
 	**/
 	void _DEBUG_ShowParticleStats();
 
+	//! The effect definitions in use, indexed by filename.
+	static std::map<std::string, ParticleEffectDef*> _effect_defs;
+
+	//! The effect definitions preloaded by this manager.
+	std::vector<ParticleEffectDef*> _preloaded_defs;
+
 	//! All the effects currently being managed.
 	std::vector<ParticleEffect*> _all_effects;
 
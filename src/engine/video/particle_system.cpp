@@ -13,6 +13,8 @@
 #include "particle_keyframe.h"
 #include "engine/video/video.h"
 
+#include <cfloat>
+
 using namespace std;
 using namespace hoa_utils;
 using namespace hoa_video;
@@ -20,6 +22,130 @@ using namespace hoa_video;
 namespace hoa_mode_manager
 {
 
+ParticleSystemDef::~ParticleSystemDef()
+{
+	for(size_t j = 0; j < keyframes.size(); ++j)
+		delete keyframes[j];
+}
+
+
+void ParticleSystemDef::ComputeKeyframeSegments()
+{
+	keyframe_segments.resize(keyframes.size());
+
+	for(size_t j = 0; j < keyframes.size(); ++j)
+	{
+		ParticleKeyframeSegment &segment = keyframe_segments[j];
+		segment.start_time = keyframes[j]->time;
+
+		if(j + 1 < keyframes.size())
+		{
+			segment.end_time = keyframes[j + 1]->time;
+			float duration = segment.end_time - segment.start_time;
+			segment.inv_duration = (duration > 0.0f) ? 1.0f / duration : 0.0f;
+		}
+		else
+		{
+			segment.end_time = FLT_MAX;
+			segment.inv_duration = 0.0f;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// ParticleArrays: the particle properties, one array each
+//-----------------------------------------------------------------------------
+
+void ParticleArrays::Resize(int32 num_particles)
+{
+	size_t num = static_cast<size_t>(num_particles);
+
+	x.resize(num);
+	y.resize(num);
+	size_x.resize(num);
+	size_y.resize(num);
+	velocity_x.resize(num);
+	velocity_y.resize(num);
+	combined_velocity_x.resize(num);
+	combined_velocity_y.resize(num);
+	color.resize(num);
+	rotation_angle.resize(num);
+	rotation_speed.resize(num);
+	rotation_direction.resize(num);
+	time.resize(num);
+	lifetime.resize(num);
+	wave_length_coefficient.resize(num);
+	wave_half_amplitude.resize(num);
+	acceleration_x.resize(num);
+	acceleration_y.resize(num);
+	tangential_acceleration.resize(num);
+	radial_acceleration.resize(num);
+	wind_velocity_x.resize(num);
+	wind_velocity_y.resize(num);
+	damping.resize(num);
+	keyframe.resize(num);
+	keyframe_start_time.resize(num);
+	keyframe_end_time.resize(num);
+	keyframe_inv_duration.resize(num);
+	rotation_speed_from.resize(num);
+	rotation_speed_to.resize(num);
+	size_x_from.resize(num);
+	size_x_to.resize(num);
+	size_y_from.resize(num);
+	size_y_to.resize(num);
+	color_from.resize(num);
+	color_to.resize(num);
+	keyframe_progress.resize(num);
+}
+
+
+void ParticleArrays::Clear()
+{
+	Resize(0);
+}
+
+
+void ParticleArrays::Copy(int32 src, int32 dest)
+{
+	x[dest] = x[src];
+	y[dest] = y[src];
+	size_x[dest] = size_x[src];
+	size_y[dest] = size_y[src];
+	velocity_x[dest] = velocity_x[src];
+	velocity_y[dest] = velocity_y[src];
+	combined_velocity_x[dest] = combined_velocity_x[src];
+	combined_velocity_y[dest] = combined_velocity_y[src];
+	color[dest] = color[src];
+	rotation_angle[dest] = rotation_angle[src];
+	rotation_speed[dest] = rotation_speed[src];
+	rotation_direction[dest] = rotation_direction[src];
+	time[dest] = time[src];
+	lifetime[dest] = lifetime[src];
+	wave_length_coefficient[dest] = wave_length_coefficient[src];
+	wave_half_amplitude[dest] = wave_half_amplitude[src];
+	acceleration_x[dest] = acceleration_x[src];
+	acceleration_y[dest] = acceleration_y[src];
+	tangential_acceleration[dest] = tangential_acceleration[src];
+	radial_acceleration[dest] = radial_acceleration[src];
+	wind_velocity_x[dest] = wind_velocity_x[src];
+	wind_velocity_y[dest] = wind_velocity_y[src];
+	damping[dest] = damping[src];
+	keyframe[dest] = keyframe[src];
+	keyframe_start_time[dest] = keyframe_start_time[src];
+	keyframe_end_time[dest] = keyframe_end_time[src];
+	keyframe_inv_duration[dest] = keyframe_inv_duration[src];
+	rotation_speed_from[dest] = rotation_speed_from[src];
+	rotation_speed_to[dest] = rotation_speed_to[src];
+	size_x_from[dest] = size_x_from[src];
+	size_x_to[dest] = size_x_to[src];
+	size_y_from[dest] = size_y_from[src];
+	size_y_to[dest] = size_y_to[src];
+	color_from[dest] = color_from[src];
+	color_to[dest] = color_to[src];
+}
+
+
 ParticleSystem::ParticleSystem()
 {
 	_system_def = NULL;
@@ -37,13 +163,13 @@ ParticleSystem::ParticleSystem()
 // Create: initializes the particle system from the definition
 //-----------------------------------------------------------------------------
 
-bool ParticleSystem::Create(const ParticleSystemDef *sys_def)
+bool ParticleSystem::Create(const ParticleSystemDef *sys_def, bool load_animation)
 {
 	_system_def = sys_def;
 	_max_particles = sys_def->max_particles;
 	_num_particles = 0;
 
-	_particles.resize(_max_particles);
+	_particles.Resize(_max_particles);
 	_particle_vertices.resize(_max_particles * 4);
 	_particle_texcoords.resize(_max_particles * 4);
 	_particle_colors.resize(_max_particles * 4);
@@ -52,6 +178,11 @@ bool ParticleSystem::Create(const ParticleSystemDef *sys_def)
 	_stopped = false;
 	_age = 0.0f;
 
+	_random.Seed(static_cast<uint32>(rand()));
+
+	if(!load_animation)
+		return true;
+
 	size_t num_frames = sys_def->animation_frame_filenames.size();
 
 	for(size_t j = 0; j < num_frames; ++j)
@@ -71,6 +202,24 @@ bool ParticleSystem::Create(const ParticleSystemDef *sys_def)
 }
 
 
+//-----------------------------------------------------------------------------
+// Reset: starts the particle system over again, keeping its buffers
+//-----------------------------------------------------------------------------
+
+void ParticleSystem::Reset()
+{
+	_num_particles = 0;
+	_alive = true;
+	_stopped = false;
+	_age = 0.0f;
+	_last_update_time = 0.0f;
+
+	_random.Seed(static_cast<uint32>(rand()));
+
+	_animation.ResetAnimation();
+}
+
+
 
 //-----------------------------------------------------------------------------
 // Draw: draws the particle system
@@ -81,6 +230,9 @@ bool ParticleSystem::Draw()
 	if(!_system_def->enabled || _age < _system_def->emitter._start_time)
 		return true;
 
+	// The particles are drawn directly, so the queued images must be drawn first
+	VideoManager->FlushBatch();
+
 	// set blending parameters
 	if(_system_def->blend_mode == VIDEO_NO_BLEND)
 	{
@@ -160,21 +312,21 @@ bool ParticleSystem::Draw()
 
 		for(int32 j = 0; j < _num_particles; ++j)
 		{
-			float scaled_width_half  = img_width_half * _particles[j].size_x;
-			float scaled_height_half = img_height_half * _particles[j].size_y;
+			float scaled_width_half  = img_width_half * _particles.size_x[j];
+			float scaled_height_half = img_height_half * _particles.size_y[j];
 
-			float rotation_angle = _particles[j].rotation_angle;
+			float rotation_angle = _particles.rotation_angle[j];
 
 			if(_system_def->rotate_to_velocity)
 			{
 				// calculate the angle based on the velocity
-				rotation_angle += UTILS_HALF_PI + atan2f(_particles[j].combined_velocity_y, _particles[j].combined_velocity_x);
+				rotation_angle += UTILS_HALF_PI + atan2f(_particles.combined_velocity_y[j], _particles.combined_velocity_x[j]);
 
 				// calculate the scaling due to speed
 				if(_system_def->speed_scale_used)
 				{
 					// speed is magnitude of velocity
-					float speed = sqrtf(_particles[j].combined_velocity_x * _particles[j].combined_velocity_x + _particles[j].combined_velocity_y * _particles[j].combined_velocity_y);
+					float speed = sqrtf(_particles.combined_velocity_x[j] * _particles.combined_velocity_x[j] + _particles.combined_velocity_y[j] * _particles.combined_velocity_y[j]);
 					float scale_factor = _system_def->speed_scale * speed;
 
 					if(scale_factor < _system_def->min_speed_scale)
@@ -190,32 +342,32 @@ bool ParticleSystem::Draw()
 			_particle_vertices[v]._x = -scaled_width_half;
 			_particle_vertices[v]._y = -scaled_height_half;
 			RotatePoint(_particle_vertices[v]._x, _particle_vertices[v]._y, rotation_angle);
-			_particle_vertices[v]._x += _particles[j].x;
-			_particle_vertices[v]._y += _particles[j].y;
+			_particle_vertices[v]._x += _particles.x[j];
+			_particle_vertices[v]._y += _particles.y[j];
 			++v;
 
 			// upper-right vertex
 			_particle_vertices[v]._x = scaled_width_half;
 			_particle_vertices[v]._y = -scaled_height_half;
 			RotatePoint(_particle_vertices[v]._x, _particle_vertices[v]._y, rotation_angle);
-			_particle_vertices[v]._x += _particles[j].x;
-			_particle_vertices[v]._y += _particles[j].y;
+			_particle_vertices[v]._x += _particles.x[j];
+			_particle_vertices[v]._y += _particles.y[j];
 			++v;
 
 			// lower-right vertex
 			_particle_vertices[v]._x = scaled_width_half;
 			_particle_vertices[v]._y = scaled_height_half;
 			RotatePoint(_particle_vertices[v]._x, _particle_vertices[v]._y, rotation_angle);
-			_particle_vertices[v]._x += _particles[j].x;
-			_particle_vertices[v]._y += _particles[j].y;
+			_particle_vertices[v]._x += _particles.x[j];
+			_particle_vertices[v]._y += _particles.y[j];
 			++v;
 
 			// lower-left vertex
 			_particle_vertices[v]._x = -scaled_width_half;
 			_particle_vertices[v]._y = scaled_height_half;
 			RotatePoint(_particle_vertices[v]._x, _particle_vertices[v]._y, rotation_angle);
-			_particle_vertices[v]._x += _particles[j].x;
-			_particle_vertices[v]._y += _particles[j].y;
+			_particle_vertices[v]._x += _particles.x[j];
+			_particle_vertices[v]._y += _particles.y[j];
 			++v;
 
 
@@ -227,27 +379,27 @@ bool ParticleSystem::Draw()
 
 		for(int32 j = 0; j < _num_particles; ++j)
 		{
-			float scaled_width_half  = img_width_half * _particles[j].size_x;
-			float scaled_height_half = img_height_half * _particles[j].size_y;
+			float scaled_width_half  = img_width_half * _particles.size_x[j];
+			float scaled_height_half = img_height_half * _particles.size_y[j];
 
 			// upper-left vertex
-			_particle_vertices[v]._x = _particles[j].x - scaled_width_half;
-			_particle_vertices[v]._y = _particles[j].y - scaled_height_half;
+			_particle_vertices[v]._x = _particles.x[j] - scaled_width_half;
+			_particle_vertices[v]._y = _particles.y[j] - scaled_height_half;
 			++v;
 
 			// upper-right vertex
-			_particle_vertices[v]._x = _particles[j].x + scaled_width_half;
-			_particle_vertices[v]._y = _particles[j].y - scaled_height_half;
+			_particle_vertices[v]._x = _particles.x[j] + scaled_width_half;
+			_particle_vertices[v]._y = _particles.y[j] - scaled_height_half;
 			++v;
 
 			// lower-right vertex
-			_particle_vertices[v]._x = _particles[j].x + scaled_width_half;
-			_particle_vertices[v]._y = _particles[j].y + scaled_height_half;
+			_particle_vertices[v]._x = _particles.x[j] + scaled_width_half;
+			_particle_vertices[v]._y = _particles.y[j] + scaled_height_half;
 			++v;
 
 			// lower-left vertex
-			_particle_vertices[v]._x = _particles[j].x - scaled_width_half;
-			_particle_vertices[v]._y = _particles[j].y + scaled_height_half;
+			_particle_vertices[v]._x = _particles.x[j] - scaled_width_half;
+			_particle_vertices[v]._y = _particles.y[j] + scaled_height_half;
 			++v;
 		}
 	}
@@ -257,7 +409,7 @@ bool ParticleSystem::Draw()
 	int32 c = 0;
 	for(int32 j = 0; j < _num_particles; ++j)
 	{
-		Color color = _particles[j].color;
+		Color color = _particles.color[j];
 
 		if(_system_def->smooth_animation)
 			color = color * (1.0f - frame_progress);
@@ -306,6 +458,7 @@ bool ParticleSystem::Draw()
 	glTexCoordPointer (2, GL_FLOAT, 0, &_particle_texcoords[0]);
 
 	glDrawArrays(GL_QUADS, 0, _num_particles * 4);
+	VideoManager->CountDrawCall();
 
 	glDisableClientState(GL_VERTEX_ARRAY);
 
@@ -356,7 +509,7 @@ bool ParticleSystem::Draw()
 		c = 0;
 		for(int32 j = 0; j < _num_particles; ++j)
 		{
-			Color color = _particles[j].color;
+			Color color = _particles.color[j];
 			color = color * frame_progress;
 
 			_particle_colors[c] = color;
@@ -374,6 +527,7 @@ bool ParticleSystem::Draw()
 		glTexCoordPointer (2, GL_FLOAT, 0, &_particle_texcoords[0]);
 
 		glDrawArrays(GL_QUADS, 0, _num_particles * 4);
+		VideoManager->CountDrawCall();
 
 		glDisableClientState(GL_VERTEX_ARRAY);
 		glDisableClientState(GL_COLOR_ARRAY);
@@ -478,168 +632,168 @@ int32 ParticleSystem::GetNumParticles() const
 
 void ParticleSystem::Destroy()
 {
-	_particles.clear();
+	_particles.Clear();
 	_particle_vertices.clear();
 }
 
 //-----------------------------------------------------------------------------
 // _UpdateParticles: helper function to update the positions and properties
+//                   Each property is updated in its own loop over the arrays,
+//                   so that the compiler can vectorize most of them.
 //-----------------------------------------------------------------------------
 
 void ParticleSystem::_UpdateParticles(float t, const EffectParameters &params)
 {
-	for(int j = 0; j < _num_particles; ++j)
+	const int32 num = _num_particles;
+	if(num == 0)
+		return;
+
+	float *x = &_particles.x[0];
+	float *y = &_particles.y[0];
+	float *velocity_x = &_particles.velocity_x[0];
+	float *velocity_y = &_particles.velocity_y[0];
+	float *combined_velocity_x = &_particles.combined_velocity_x[0];
+	float *combined_velocity_y = &_particles.combined_velocity_y[0];
+	float *time = &_particles.time[0];
+	const float *lifetime = &_particles.lifetime[0];
+	float *progress = &_particles.keyframe_progress[0];
+
+	// calculate a time for each particle from 0 to 1 since this is what
+	// the keyframes are based on
+	for(int32 j = 0; j < num; ++j)
+		progress[j] = time[j] / lifetime[j];
+
+	// advance the particles which reached their next keyframe. This only
+	// happens a few times over a particle lifetime
+	const float *keyframe_end_time = &_particles.keyframe_end_time[0];
+	for(int32 j = 0; j < num; ++j)
 	{
-		// calculate a time for the particle from 0 to 1 since this is what
-		// the keyframes are based on
-		float scaled_time = _particles[j].time / _particles[j].lifetime;
+		if(progress[j] >= keyframe_end_time[j])
+			_AdvanceKeyframe(j, progress[j]);
+	}
 
-		// figure out which keyframe we're on
-		if(_particles[j].next_keyframe)
-		{
-			ParticleKeyframe *old_next = _particles[j].next_keyframe;
+	// figure out how far each particle is from its current to its next keyframe (0.0 to 1.0),
+	// and interpolate the keyframed properties. Particles at their last keyframe have an inverse
+	// duration of 0, and the same "from" and "to" values.
+	const float *keyframe_start_time = &_particles.keyframe_start_time[0];
+	const float *keyframe_inv_duration = &_particles.keyframe_inv_duration[0];
+	for(int32 j = 0; j < num; ++j)
+		progress[j] = (progress[j] - keyframe_start_time[j]) * keyframe_inv_duration[j];
 
-			// check if we need to advance the keyframe
-			if(scaled_time >= _particles[j].next_keyframe->time)
-			{
-				// figure out what keyframe we're on
-				size_t num_keyframes = _system_def->keyframes.size();
+	float *rotation_speed = &_particles.rotation_speed[0];
+	const float *rotation_speed_from = &_particles.rotation_speed_from[0];
+	const float *rotation_speed_to = &_particles.rotation_speed_to[0];
+	for(int32 j = 0; j < num; ++j)
+		rotation_speed[j] = rotation_speed_from[j] + progress[j] * (rotation_speed_to[j] - rotation_speed_from[j]);
 
-				size_t k;
-				for(k = 0; k < num_keyframes; ++k)
-				{
-					if(_system_def->keyframes[k]->time > scaled_time)
-					{
-						_particles[j].current_keyframe = _system_def->keyframes[k - 1];
-						_particles[j].next_keyframe    = _system_def->keyframes[k];
-						break;
-					}
-				}
+	float *size_x = &_particles.size_x[0];
+	const float *size_x_from = &_particles.size_x_from[0];
+	const float *size_x_to = &_particles.size_x_to[0];
+	for(int32 j = 0; j < num; ++j)
+		size_x[j] = size_x_from[j] + progress[j] * (size_x_to[j] - size_x_from[j]);
 
-				// if we didn't find any keyframe whose time is larger than this
-				// particle's time, then we are on the last one
-				if(k == num_keyframes)
-				{
-					_particles[j].current_keyframe = _system_def->keyframes[k - 1];
-					_particles[j].next_keyframe = NULL;
-
-					// set all of the keyframed properties to the value stored in the last
-					// keyframe
-					_particles[j].color          = _particles[j].current_keyframe->color;
-					_particles[j].rotation_speed = _particles[j].current_keyframe->rotation_speed;
-					_particles[j].size_x         = _particles[j].current_keyframe->size_x;
-					_particles[j].size_y         = _particles[j].current_keyframe->size_y;
-				}
+	float *size_y = &_particles.size_y[0];
+	const float *size_y_from = &_particles.size_y_from[0];
+	const float *size_y_to = &_particles.size_y_to[0];
+	for(int32 j = 0; j < num; ++j)
+		size_y[j] = size_y_from[j] + progress[j] * (size_y_to[j] - size_y_from[j]);
 
-				// if we skipped ahead only 1 keyframe, then inherit the current variations
-				// from the next ones
-				if(_particles[j].current_keyframe == old_next)
-				{
-					_particles[j].current_color_variation = _particles[j].next_color_variation;
-					_particles[j].current_rotation_speed_variation = _particles[j].current_rotation_speed_variation;
-					_particles[j].current_size_variation_x = _particles[j].next_size_variation_x;
-					_particles[j].current_size_variation_y = _particles[j].next_size_variation_y;
-				}
-				else
-				{
-					_particles[j].current_rotation_speed_variation = RandomFloat(-_particles[j].current_keyframe->rotation_speed_variation, _particles[j].current_keyframe->rotation_speed_variation);
-					for(int32 c = 0; c < 4; ++c)
-						_particles[j].current_color_variation[c] = RandomFloat(-_particles[j].current_keyframe->color_variation[c], _particles[j].current_keyframe->color_variation[c]);
-					_particles[j].current_size_variation_x = RandomFloat(-_particles[j].current_keyframe->size_variation_x, _particles[j].current_keyframe->size_variation_x);
-					_particles[j].current_size_variation_y = RandomFloat(-_particles[j].current_keyframe->size_variation_y, _particles[j].current_keyframe->size_variation_y);
-				}
+	// a color is made of 4 floats, so the color arrays are handled as float arrays
+	float *color = &_particles.color[0][0];
+	const float *color_from = &_particles.color_from[0][0];
+	const float *color_to = &_particles.color_to[0][0];
+	for(int32 j = 0; j < num; ++j)
+	{
+		for(int32 c = 0; c < 4; ++c)
+			color[j * 4 + c] = color_from[j * 4 + c] + progress[j] * (color_to[j * 4 + c] - color_from[j * 4 + c]);
+	}
 
-				// if there is a next keyframe, generate variations for it
-				if(_particles[j].next_keyframe)
-				{
-					_particles[j].next_rotation_speed_variation = RandomFloat(-_particles[j].next_keyframe->rotation_speed_variation, _particles[j].next_keyframe->rotation_speed_variation);
-					for(int32 c = 0; c < 4; ++c)
-						_particles[j].next_color_variation[c] = RandomFloat(-_particles[j].next_keyframe->color_variation[c], _particles[j].next_keyframe->color_variation[c]);
-					_particles[j].next_size_variation_x = RandomFloat(-_particles[j].next_keyframe->size_variation_x, _particles[j].next_keyframe->size_variation_x);
-					_particles[j].next_size_variation_y = RandomFloat(-_particles[j].next_keyframe->size_variation_y, _particles[j].next_keyframe->size_variation_y);
-				}
-			}
-		}
+	float *rotation_angle = &_particles.rotation_angle[0];
+	const float *rotation_direction = &_particles.rotation_direction[0];
+	for(int32 j = 0; j < num; ++j)
+		rotation_angle[j] += rotation_speed[j] * rotation_direction[j] * t;
 
+	const float *wind_velocity_x = &_particles.wind_velocity_x[0];
+	const float *wind_velocity_y = &_particles.wind_velocity_y[0];
+	for(int32 j = 0; j < num; ++j)
+	{
+		combined_velocity_x[j] = velocity_x[j] + wind_velocity_x[j];
+		combined_velocity_y[j] = velocity_y[j] + wind_velocity_y[j];
+	}
 
-		// if we aren't already at the last keyframe, interpolate to figure out the
-		// current keyframed properties
-		if(_particles[j].next_keyframe)
+	if(_system_def->wave_motion_used)
+	{
+		const float *wave_half_amplitude = &_particles.wave_half_amplitude[0];
+		const float *wave_length_coefficient = &_particles.wave_length_coefficient[0];
+		for(int32 j = 0; j < num; ++j)
 		{
-			// figure out how far we are from the current to the next (0.0 to 1.0)
-			float a = (scaled_time - _particles[j].current_keyframe->time) / (_particles[j].next_keyframe->time - _particles[j].current_keyframe->time);
-
-			_particles[j].rotation_speed = Lerp(a, _particles[j].current_keyframe->rotation_speed + _particles[j].current_rotation_speed_variation, _particles[j].next_keyframe->rotation_speed + _particles[j].next_rotation_speed_variation);
-			_particles[j].size_x         = Lerp(a, _particles[j].current_keyframe->size_x + _particles[j].current_size_variation_x, _particles[j].next_keyframe->size_x + _particles[j].next_size_variation_x);
-			_particles[j].size_y         = Lerp(a, _particles[j].current_keyframe->size_y + _particles[j].current_size_variation_y, _particles[j].next_keyframe->size_y + _particles[j].next_size_variation_y);
-			_particles[j].color[0]       = Lerp(a, _particles[j].current_keyframe->color[0] + _particles[j].current_color_variation[0], _particles[j].next_keyframe->color[0] + _particles[j].next_color_variation[0]);
-			_particles[j].color[1]       = Lerp(a, _particles[j].current_keyframe->color[1] + _particles[j].current_color_variation[1], _particles[j].next_keyframe->color[1] + _particles[j].next_color_variation[1]);
-			_particles[j].color[2]       = Lerp(a, _particles[j].current_keyframe->color[2] + _particles[j].current_color_variation[2], _particles[j].next_keyframe->color[2] + _particles[j].next_color_variation[2]);
-			_particles[j].color[3]       = Lerp(a, _particles[j].current_keyframe->color[3] + _particles[j].current_color_variation[3], _particles[j].next_keyframe->color[3] + _particles[j].next_color_variation[3]);
-		}
+			if(wave_half_amplitude[j] <= 0.0f)
+				continue;
 
-
-		_particles[j].rotation_angle += _particles[j].rotation_speed * _particles[j].rotation_direction * t;
-
-		float wind_velocity_x = _particles[j].wind_velocity_x;
-		float wind_velocity_y = _particles[j].wind_velocity_y;
-
-		_particles[j].combined_velocity_x = _particles[j].velocity_x + wind_velocity_x;
-		_particles[j].combined_velocity_y = _particles[j].velocity_y + wind_velocity_y;
-
-		if(_system_def->wave_motion_used && _particles[j].wave_half_amplitude > 0.0f)
-		{
 			// find the magnitude of the wave velocity
-// 			float half_amp = _particles[j].wave_half_amplitude; UNUSED VARIABLE
-// 			float wcoef = _particles[j].wave_length_coefficient; UNUSED VARIABLE
-			float wave_speed = _particles[j].wave_half_amplitude * sinf(_particles[j].wave_length_coefficient * _particles[j].time);
+			float wave_speed = wave_half_amplitude[j] * sinf(wave_length_coefficient[j] * time[j]);
 
 			// now the wave velocity is just that wave speed times the particle's tangential vector
-			float tangent_x = -_particles[j].combined_velocity_y;
-			float tangent_y = _particles[j].combined_velocity_x;
+			float tangent_x = -combined_velocity_y[j];
+			float tangent_y = combined_velocity_x[j];
 			float speed = sqrtf(tangent_x * tangent_x + tangent_y * tangent_y);
 			tangent_x /= speed;
 			tangent_y /= speed;
 
-			float wave_velocity_x = tangent_x * wave_speed;
-			float wave_velocity_y = tangent_y * wave_speed;
-
-			_particles[j].combined_velocity_x += wave_velocity_x;
-			_particles[j].combined_velocity_y += wave_velocity_y;
+			combined_velocity_x[j] += tangent_x * wave_speed;
+			combined_velocity_y[j] += tangent_y * wave_speed;
 		}
+	}
 
-		_particles[j].x += (_particles[j].combined_velocity_x) * t;
-		_particles[j].y += (_particles[j].combined_velocity_y) * t;
+	for(int32 j = 0; j < num; ++j)
+	{
+		x[j] += combined_velocity_x[j] * t;
+		y[j] += combined_velocity_y[j] * t;
+	}
 
+	// client-specified acceleration (dv = a * t)
+	const float *acceleration_x = &_particles.acceleration_x[0];
+	const float *acceleration_y = &_particles.acceleration_y[0];
+	for(int32 j = 0; j < num; ++j)
+	{
+		velocity_x[j] += acceleration_x[j] * t;
+		velocity_y[j] += acceleration_y[j] * t;
+	}
 
-		// client-specified acceleration (dv = a * t)
-		_particles[j].velocity_x += _particles[j].acceleration_x * t;
-		_particles[j].velocity_y += _particles[j].acceleration_y * t;
+	// radial acceleration: calculate unit vector from emitter center to this particle,
+	// and scale by the radial acceleration, if there is any
+	bool radial_used = (_system_def->radial_acceleration != 0.0f || _system_def->radial_acceleration_variation != 0.0f);
+	bool tangential_used = (_system_def->tangential_acceleration != 0.0f || _system_def->tangential_acceleration_variation != 0.0f);
 
-		// radial acceleration: calculate unit vector from emitter center to this particle,
-		// and scale by the radial acceleration, if there is any
+	if(radial_used || tangential_used)
+	{
+		float attractor_x;
+		float attractor_y;
 
+		if(_system_def->user_defined_attractor)
+		{
+			attractor_x = params.attractor_x;
+			attractor_y = params.attractor_y;
+		}
+		else
+		{
+			attractor_x = _system_def->emitter._center_x;
+			attractor_y = _system_def->emitter._center_y;
+		}
 
-		bool use_radial     = (_particles[j].radial_acceleration != 0.0f);
-		bool use_tangential = (_particles[j].tangential_acceleration != 0.0f);
+		const float *radial_acceleration = &_particles.radial_acceleration[0];
+		const float *tangential_acceleration = &_particles.tangential_acceleration[0];
+		for(int32 j = 0; j < num; ++j)
+		{
+			bool use_radial     = (radial_acceleration[j] != 0.0f);
+			bool use_tangential = (tangential_acceleration[j] != 0.0f);
 
+			if(!use_radial && !use_tangential)
+				continue;
 
-		if(use_radial || use_tangential)
-		{
 			// unit vector from attractor to particle
-			float attractor_to_particle_x;
-			float attractor_to_particle_y;
-
-			if(_system_def->user_defined_attractor)
-			{
-				attractor_to_particle_x = _particles[j].x - params.attractor_x;
-				attractor_to_particle_y = _particles[j].y - params.attractor_y;
-			}
-			else
-			{
-				attractor_to_particle_x = _particles[j].x - _system_def->emitter._center_x;
-				attractor_to_particle_y = _particles[j].y - _system_def->emitter._center_y;
-			}
+			float attractor_to_particle_x = x[j] - attractor_x;
+			float attractor_to_particle_y = y[j] - attractor_y;
 
 			float distance = sqrtf(attractor_to_particle_x * attractor_to_particle_x + attractor_to_particle_y * attractor_to_particle_y);
 
@@ -652,19 +806,14 @@ void ParticleSystem::_UpdateParticles(float t, const EffectParameters &params)
 			// radial acceleration
 			if(use_radial)
 			{
+				float attraction = 1.0f;
 				if(_system_def->attractor_falloff != 0.0f)
+					attraction = 1.0f - _system_def->attractor_falloff * distance;
+
+				if(attraction > 0.0f)
 				{
-					float attraction = 1.0f - _system_def->attractor_falloff * distance;
-					if(attraction > 0.0f)
-					{
-						_particles[j].velocity_x += attractor_to_particle_x * _particles[j].radial_acceleration * t * attraction;
-						_particles[j].velocity_y += attractor_to_particle_y * _particles[j].radial_acceleration * t * attraction;
-					}
-				}
-				else
-				{
-					_particles[j].velocity_x += attractor_to_particle_x * _particles[j].radial_acceleration * t;
-					_particles[j].velocity_y += attractor_to_particle_y * _particles[j].radial_acceleration * t;
+					velocity_x[j] += attractor_to_particle_x * radial_acceleration[j] * t * attraction;
+					velocity_y[j] += attractor_to_particle_y * radial_acceleration[j] * t * attraction;
 				}
 			}
 
@@ -675,25 +824,100 @@ void ParticleSystem::_UpdateParticles(float t, const EffectParameters &params)
 				float tangent_x = -attractor_to_particle_y;
 				float tangent_y = attractor_to_particle_x;
 
-				_particles[j].velocity_x += tangent_x * _particles[j].tangential_acceleration * t;
-				_particles[j].velocity_y += tangent_y * _particles[j].tangential_acceleration * t;
+				velocity_x[j] += tangent_x * tangential_acceleration[j] * t;
+				velocity_y[j] += tangent_y * tangential_acceleration[j] * t;
 			}
 		}
+	}
 
-
-		// damp the velocity
-
-		if(_particles[j].damping != 1.0f)
+	// damp the velocity
+	if(_system_def->damping != 1.0f || _system_def->damping_variation != 0.0f)
+	{
+		const float *damping = &_particles.damping[0];
+		for(int32 j = 0; j < num; ++j)
 		{
-			_particles[j].velocity_x *= pow(_particles[j].damping, t);
-			_particles[j].velocity_y *= pow(_particles[j].damping, t);
+			if(damping[j] != 1.0f)
+			{
+				float damping_factor = powf(damping[j], t);
+				velocity_x[j] *= damping_factor;
+				velocity_y[j] *= damping_factor;
+			}
 		}
+	}
+
+	for(int32 j = 0; j < num; ++j)
+		time[j] += t;
+}
+
+
+//-----------------------------------------------------------------------------
+// _AdvanceKeyframe: helper function moving a particle to the keyframe matching
+//                   its age. The values of the keyframed properties at the
+//                   current and next keyframes are computed once here, so
+//                   that updating the particle only requires interpolating
+//                   between them.
+//-----------------------------------------------------------------------------
 
-		_particles[j].time += t;
+void ParticleSystem::_AdvanceKeyframe(int32 i, float scaled_time)
+{
+	const std::vector<ParticleKeyframe *> &keyframes = _system_def->keyframes;
+	const std::vector<ParticleKeyframeSegment> &segments = _system_def->keyframe_segments;
+
+	uint32 old_next = _particles.keyframe[i] + 1;
+
+	// figure out what keyframe we're on
+	uint32 k = _particles.keyframe[i];
+	while(k + 1 < segments.size() && scaled_time >= segments[k].end_time)
+		++k;
+
+	_particles.keyframe[i] = k;
+	_particles.keyframe_start_time[i] = segments[k].start_time;
+	_particles.keyframe_end_time[i] = segments[k].end_time;
+	_particles.keyframe_inv_duration[i] = segments[k].inv_duration;
+
+	const ParticleKeyframe *current_keyframe = keyframes[k];
+
+	// if we are on the last keyframe, then set all of the keyframed properties
+	// to the value stored in it
+	if(k + 1 == keyframes.size())
+	{
+		_particles.rotation_speed_from[i] = _particles.rotation_speed_to[i] = current_keyframe->rotation_speed;
+		_particles.size_x_from[i] = _particles.size_x_to[i] = current_keyframe->size_x;
+		_particles.size_y_from[i] = _particles.size_y_to[i] = current_keyframe->size_y;
+		_particles.color_from[i] = _particles.color_to[i] = current_keyframe->color;
+		return;
+	}
+
+	// if we skipped ahead only 1 keyframe, then inherit the current variations
+	// from the next ones
+	if(k == old_next)
+	{
+		_particles.rotation_speed_from[i] = _particles.rotation_speed_to[i];
+		_particles.size_x_from[i] = _particles.size_x_to[i];
+		_particles.size_y_from[i] = _particles.size_y_to[i];
+		_particles.color_from[i] = _particles.color_to[i];
 	}
+	else
+	{
+		_particles.rotation_speed_from[i] = current_keyframe->rotation_speed + _random.Float(-current_keyframe->rotation_speed_variation, current_keyframe->rotation_speed_variation);
+		_particles.size_x_from[i] = current_keyframe->size_x + _random.Float(-current_keyframe->size_variation_x, current_keyframe->size_variation_x);
+		_particles.size_y_from[i] = current_keyframe->size_y + _random.Float(-current_keyframe->size_variation_y, current_keyframe->size_variation_y);
+		for(int32 c = 0; c < 4; ++c)
+			_particles.color_from[i][c] = current_keyframe->color[c] + _random.Float(-current_keyframe->color_variation[c], current_keyframe->color_variation[c]);
+	}
+
+	// generate variations for the next keyframe
+	const ParticleKeyframe *next_keyframe = keyframes[k + 1];
+
+	_particles.rotation_speed_to[i] = next_keyframe->rotation_speed + _random.Float(-next_keyframe->rotation_speed_variation, next_keyframe->rotation_speed_variation);
+	_particles.size_x_to[i] = next_keyframe->size_x + _random.Float(-next_keyframe->size_variation_x, next_keyframe->size_variation_x);
+	_particles.size_y_to[i] = next_keyframe->size_y + _random.Float(-next_keyframe->size_variation_y, next_keyframe->size_variation_y);
+	for(int32 c = 0; c < 4; ++c)
+		_particles.color_to[i][c] = next_keyframe->color[c] + _random.Float(-next_keyframe->color_variation[c], next_keyframe->color_variation[c]);
 }
 
 
+
 //-----------------------------------------------------------------------------
 // _KillParticles: helper function to kill expired particles. The num parameter
 //                 tells how many particles need to be emitted this frame.
@@ -706,7 +930,7 @@ void ParticleSystem::_KillParticles(int32 &num, const EffectParameters &params)
 	// check each active particle to see if it is expired
 	for(int j = 0; j < _num_particles; ++j)
 	{
-		if(_particles[j].time > _particles[j].lifetime)
+		if(_particles.time[j] > _particles.lifetime[j])
 		{
 			if(num > 0)
 			{
@@ -751,7 +975,7 @@ void ParticleSystem::_EmitParticles(int32 num, const EffectParameters &params)
 
 void ParticleSystem::_MoveParticle(int32 src, int32 dest)
 {
-	_particles[dest] = _particles[src];
+	_particles.Copy(src, dest);
 }
 
 
@@ -764,28 +988,31 @@ void ParticleSystem::_RespawnParticle(int32 i, const EffectParameters &params)
 {
 	const ParticleEmitter &emitter = _system_def->emitter;
 
+	float x = 0.0f;
+	float y = 0.0f;
+
 	switch(emitter._shape)
 	{
 		case EMITTER_SHAPE_POINT:
 		{
-			_particles[i].x = emitter._x;
-			_particles[i].y = emitter._y;
+			x = emitter._x;
+			y = emitter._y;
 			break;
 		}
 		case EMITTER_SHAPE_LINE:
 		{
-			_particles[i].x = RandomFloat(emitter._x, emitter._x2);
-			_particles[i].y = RandomFloat(emitter._y, emitter._y2);
+			x = _random.Float(emitter._x, emitter._x2);
+			y = _random.Float(emitter._y, emitter._y2);
 			break;
 		}
 		case EMITTER_SHAPE_CIRCLE:
 		{
-			float angle = RandomFloat(0.0f, UTILS_2PI);
-			_particles[i].x = emitter._radius * cosf(angle);
-			_particles[i].y = emitter._radius * sinf(angle);
+			float angle = _random.Float(0.0f, UTILS_2PI);
+			x = emitter._radius * cosf(angle);
+			y = emitter._radius * sinf(angle);
 			// Apply offset
-			_particles[i].x += emitter._x;
-			_particles[i].y += emitter._y;
+			x += emitter._x;
+			y += emitter._y;
 			break;
 		}
 		case EMITTER_SHAPE_FILLED_CIRCLE:
@@ -798,19 +1025,18 @@ void ParticleSystem::_RespawnParticle(int32 i, const EffectParameters &params)
 			do
 			{
 				float half_radius = emitter._radius * 0.5f;
-				_particles[i].x = RandomFloat(-half_radius, half_radius);
-				_particles[i].y = RandomFloat(-half_radius, half_radius);
-			} while(_particles[i].x * _particles[i].x +
-			        _particles[i].y * _particles[i].y > radius_squared);
+				x = _random.Float(-half_radius, half_radius);
+				y = _random.Float(-half_radius, half_radius);
+			} while(x * x + y * y > radius_squared);
 			// Apply offset
-			_particles[i].x += emitter._x;
-			_particles[i].y += emitter._y;
+			x += emitter._x;
+			y += emitter._y;
 			break;
 		}
 		case EMITTER_SHAPE_FILLED_RECTANGLE:
 		{
-			_particles[i].x = RandomFloat(emitter._x, emitter._x2);
-			_particles[i].y = RandomFloat(emitter._y, emitter._y2);
+			x = _random.Float(emitter._x, emitter._x2);
+			y = _random.Float(emitter._y, emitter._y2);
 			break;
 		}
 		default:
@@ -818,46 +1044,36 @@ void ParticleSystem::_RespawnParticle(int32 i, const EffectParameters &params)
 	};
 
 
-	_particles[i].x += RandomFloat(-emitter._x_variation, emitter._x_variation);
-	_particles[i].y += RandomFloat(-emitter._y_variation, emitter._y_variation);
+	x += _random.Float(-emitter._x_variation, emitter._x_variation);
+	y += _random.Float(-emitter._y_variation, emitter._y_variation);
 
 	if(params.orientation != 0.0f)
-		RotatePoint(_particles[i].x, _particles[i].y, params.orientation);
-
-	_particles[i].color = _system_def->keyframes[0]->color;
+		RotatePoint(x, y, params.orientation);
 
-	_particles[i].rotation_speed  = _system_def->keyframes[0]->rotation_speed;
-	_particles[i].time            = 0.0f;
-	_particles[i].size_x            = _system_def->keyframes[0]->size_x;
-	_particles[i].size_y            = _system_def->keyframes[0]->size_y;
+	_particles.x[i] = x;
+	_particles.y[i] = y;
+	_particles.time[i] = 0.0f;
 
 	if(_system_def->random_initial_angle)
-		_particles[i].rotation_angle = RandomFloat(0.0f, UTILS_2PI);
+		_particles.rotation_angle[i] = _random.Float(0.0f, UTILS_2PI);
 	else
-		_particles[i].rotation_angle = 0.0f;
-
-	_particles[i].current_keyframe = _system_def->keyframes[0];
-
-	if(_system_def->keyframes.size() > 1)
-		_particles[i].next_keyframe = _system_def->keyframes[1];
-	else
-		_particles[i].next_keyframe = NULL;
+		_particles.rotation_angle[i] = 0.0f;
 
 	float speed = _system_def->emitter._initial_speed;
-	speed += RandomFloat(-emitter._initial_speed_variation, emitter._initial_speed_variation);
+	speed += _random.Float(-emitter._initial_speed_variation, emitter._initial_speed_variation);
 
 
 	if(_system_def->emitter._spin == EMITTER_SPIN_CLOCKWISE)
 	{
-		_particles[i].rotation_direction = 1.0f;
+		_particles.rotation_direction[i] = 1.0f;
 	}
 	else if(_system_def->emitter._spin == EMITTER_SPIN_COUNTERCLOCKWISE)
 	{
-		_particles[i].rotation_direction = -1.0f;
+		_particles.rotation_direction[i] = -1.0f;
 	}
 	else
 	{
-		_particles[i].rotation_direction = static_cast<float>(2 * (rand()%2)) - 1.0f;
+		_particles.rotation_direction[i] = (_random.Next() & 1) ? 1.0f : -1.0f;
 	}
 
 	// figure out the orientation
@@ -866,92 +1082,107 @@ void ParticleSystem::_RespawnParticle(int32 i, const EffectParameters &params)
 
 	if(emitter._omnidirectional)
 	{
-		angle = RandomFloat(0.0f, UTILS_2PI);
+		angle = _random.Float(0.0f, UTILS_2PI);
 	}
 	else if(emitter._inner_cone == 0.0f && emitter._outer_cone == 0.0f)
 	{
 		angle = emitter._orientation + params.orientation;
 	}
 
-	_particles[i].velocity_x = speed * cosf(angle);
-	_particles[i].velocity_y = speed * sinf(angle);
+	_particles.velocity_x[i] = speed * cosf(angle);
+	_particles.velocity_y[i] = speed * sinf(angle);
 
-	// figure out property variations
+	// start on the first keyframe, and figure out the property variations
+	const ParticleKeyframe *first_keyframe = _system_def->keyframes[0];
+	const ParticleKeyframeSegment &segment = _system_def->keyframe_segments[0];
 
-	_particles[i].current_size_variation_x  = RandomFloat(-_system_def->keyframes[0]->size_variation_x, _system_def->keyframes[0]->size_variation_x);
-	_particles[i].current_size_variation_y  = RandomFloat(-_system_def->keyframes[0]->size_variation_y, _system_def->keyframes[0]->size_variation_y);
+	_particles.keyframe[i] = 0;
+	_particles.keyframe_start_time[i] = segment.start_time;
+	_particles.keyframe_end_time[i] = segment.end_time;
+	_particles.keyframe_inv_duration[i] = segment.inv_duration;
 
+	float size_variation_x = _random.Float(-first_keyframe->size_variation_x, first_keyframe->size_variation_x);
+	float size_variation_y = _random.Float(-first_keyframe->size_variation_y, first_keyframe->size_variation_y);
+	float rotation_speed_variation = _random.Float(-first_keyframe->rotation_speed_variation, first_keyframe->rotation_speed_variation);
+	Color color_variation;
 	for(int32 j = 0; j < 4; ++j)
-		_particles[i].current_color_variation[j] = RandomFloat(-_system_def->keyframes[0]->color_variation[j], _system_def->keyframes[0]->color_variation[j]);
-
-	_particles[i].current_rotation_speed_variation = RandomFloat(-_system_def->keyframes[0]->rotation_speed_variation, _system_def->keyframes[0]->rotation_speed_variation);
+		color_variation[j] = _random.Float(-first_keyframe->color_variation[j], first_keyframe->color_variation[j]);
 
 	if(_system_def->keyframes.size() > 1)
 	{
+		_particles.size_x_from[i] = first_keyframe->size_x + size_variation_x;
+		_particles.size_y_from[i] = first_keyframe->size_y + size_variation_y;
+		_particles.rotation_speed_from[i] = first_keyframe->rotation_speed + rotation_speed_variation;
+		for(int32 j = 0; j < 4; ++j)
+			_particles.color_from[i][j] = first_keyframe->color[j] + color_variation[j];
+
 		// figure out the next keyframe's variations
-		_particles[i].next_size_variation_x  = RandomFloat(-_system_def->keyframes[1]->size_variation_x, _system_def->keyframes[1]->size_variation_x);
-		_particles[i].next_size_variation_y  = RandomFloat(-_system_def->keyframes[1]->size_variation_y, _system_def->keyframes[1]->size_variation_y);
+		const ParticleKeyframe *next_keyframe = _system_def->keyframes[1];
 
+		_particles.size_x_to[i] = next_keyframe->size_x + _random.Float(-next_keyframe->size_variation_x, next_keyframe->size_variation_x);
+		_particles.size_y_to[i] = next_keyframe->size_y + _random.Float(-next_keyframe->size_variation_y, next_keyframe->size_variation_y);
+		_particles.rotation_speed_to[i] = next_keyframe->rotation_speed + _random.Float(-next_keyframe->rotation_speed_variation, next_keyframe->rotation_speed_variation);
 		for(int32 j = 0; j < 4; ++j)
-			_particles[i].next_color_variation[j] = RandomFloat(-_system_def->keyframes[1]->color_variation[j], _system_def->keyframes[1]->color_variation[j]);
-
-		_particles[i].next_rotation_speed_variation = RandomFloat(-_system_def->keyframes[1]->rotation_speed_variation, _system_def->keyframes[1]->rotation_speed_variation);
+			_particles.color_to[i][j] = next_keyframe->color[j] + _random.Float(-next_keyframe->color_variation[j], next_keyframe->color_variation[j]);
 	}
 	else
 	{
-		// if there's only 1 keyframe, then apply the variations now
+		// if there's only 1 keyframe, then apply the variations now, and keep them
+		_particles.size_x_from[i] = _particles.size_x_to[i] = first_keyframe->size_x + _random.Float(-size_variation_x, size_variation_x);
+		_particles.size_y_from[i] = _particles.size_y_to[i] = first_keyframe->size_y + _random.Float(-size_variation_y, size_variation_y);
+		_particles.rotation_speed_from[i] = _particles.rotation_speed_to[i] = first_keyframe->rotation_speed + _random.Float(-rotation_speed_variation, rotation_speed_variation);
 		for(int32 j = 0; j < 4; ++j)
-			_particles[i].color[j] += RandomFloat(-_particles[i].current_color_variation[j], _particles[i].current_color_variation[j]);
-
-		_particles[i].size_x += RandomFloat(-_particles[i].current_size_variation_x, _particles[i].current_size_variation_x);
-		_particles[i].size_y += RandomFloat(-_particles[i].current_size_variation_y, _particles[i].current_size_variation_y);
-
-		_particles[i].rotation_speed += RandomFloat(-_particles[i].current_rotation_speed_variation, _particles[i].current_rotation_speed_variation);
+			_particles.color_from[i][j] = _particles.color_to[i][j] = first_keyframe->color[j] + _random.Float(-color_variation[j], color_variation[j]);
 	}
 
-	_particles[i].tangential_acceleration = _system_def->tangential_acceleration;
+	_particles.size_x[i] = _particles.size_x_from[i];
+	_particles.size_y[i] = _particles.size_y_from[i];
+	_particles.rotation_speed[i] = _particles.rotation_speed_from[i];
+	_particles.color[i] = _particles.color_from[i];
+
+	_particles.tangential_acceleration[i] = _system_def->tangential_acceleration;
 	if(_system_def->tangential_acceleration_variation != 0.0f)
-		_particles[i].tangential_acceleration += RandomFloat(-_system_def->tangential_acceleration_variation, _system_def->tangential_acceleration_variation);
+		_particles.tangential_acceleration[i] += _random.Float(-_system_def->tangential_acceleration_variation, _system_def->tangential_acceleration_variation);
 
-	_particles[i].radial_acceleration = _system_def->radial_acceleration;
+	_particles.radial_acceleration[i] = _system_def->radial_acceleration;
 	if(_system_def->radial_acceleration_variation != 0.0f)
-		_particles[i].radial_acceleration += RandomFloat(-_system_def->radial_acceleration_variation, _system_def->radial_acceleration_variation);
+		_particles.radial_acceleration[i] += _random.Float(-_system_def->radial_acceleration_variation, _system_def->radial_acceleration_variation);
 
-	_particles[i].acceleration_x = _system_def->acceleration_x;
+	_particles.acceleration_x[i] = _system_def->acceleration_x;
 	if(_system_def->acceleration_variation_x != 0.0f)
-		_particles[i].acceleration_x += RandomFloat(-_system_def->acceleration_variation_x, _system_def->acceleration_variation_x);
+		_particles.acceleration_x[i] += _random.Float(-_system_def->acceleration_variation_x, _system_def->acceleration_variation_x);
 
-	_particles[i].acceleration_y = _system_def->acceleration_y;
+	_particles.acceleration_y[i] = _system_def->acceleration_y;
 	if(_system_def->acceleration_variation_y != 0.0f)
-		_particles[i].acceleration_y += RandomFloat(-_system_def->acceleration_variation_y, _system_def->acceleration_variation_y);
+		_particles.acceleration_y[i] += _random.Float(-_system_def->acceleration_variation_y, _system_def->acceleration_variation_y);
 
-	_particles[i].wind_velocity_x = _system_def->wind_velocity_x;
+	_particles.wind_velocity_x[i] = _system_def->wind_velocity_x;
 	if(_system_def->wind_velocity_variation_x != 0.0f)
-		_particles[i].wind_velocity_x += RandomFloat(-_system_def->wind_velocity_variation_x, _system_def->wind_velocity_variation_x);
+		_particles.wind_velocity_x[i] += _random.Float(-_system_def->wind_velocity_variation_x, _system_def->wind_velocity_variation_x);
 
-	_particles[i].wind_velocity_y = _system_def->wind_velocity_y;
+	_particles.wind_velocity_y[i] = _system_def->wind_velocity_y;
 	if(_system_def->wind_velocity_variation_y != 0.0f)
-		_particles[i].wind_velocity_y += RandomFloat(-_system_def->wind_velocity_variation_y, _system_def->wind_velocity_variation_y);
+		_particles.wind_velocity_y[i] += _random.Float(-_system_def->wind_velocity_variation_y, _system_def->wind_velocity_variation_y);
 
-	_particles[i].damping = _system_def->damping;
+	_particles.damping[i] = _system_def->damping;
 	if(_system_def->damping_variation != 0.0f)
-		_particles[i].damping += RandomFloat(-_system_def->damping_variation, _system_def->damping_variation);
+		_particles.damping[i] += _random.Float(-_system_def->damping_variation, _system_def->damping_variation);
 
 	if(_system_def->wave_motion_used)
 	{
-		_particles[i].wave_length_coefficient = _system_def->wave_length;
+		float wave_length = _system_def->wave_length;
 		if(_system_def->wave_length_variation != 0.0f)
-			_particles[i].wave_length_coefficient += RandomFloat(-_system_def->wave_length_variation, _system_def->wave_length_variation);
+			wave_length += _random.Float(-_system_def->wave_length_variation, _system_def->wave_length_variation);
 
-		_particles[i].wave_length_coefficient = UTILS_2PI / _particles[i].wave_length_coefficient;
+		_particles.wave_length_coefficient[i] = UTILS_2PI / wave_length;
 
-		_particles[i].wave_half_amplitude = _system_def->wave_amplitude;
+		float wave_amplitude = _system_def->wave_amplitude;
 		if(_system_def->wave_amplitude != 0.0f)
-			_particles[i].wave_half_amplitude += RandomFloat(-_system_def->wave_amplitude_variation, _system_def->wave_amplitude_variation);
-		_particles[i].wave_half_amplitude *= 0.5f;
+			wave_amplitude += _random.Float(-_system_def->wave_amplitude_variation, _system_def->wave_amplitude_variation);
+		_particles.wave_half_amplitude[i] = wave_amplitude * 0.5f;
 	}
 
-	_particles[i].lifetime = _system_def->particle_lifetime + RandomFloat(-_system_def->particle_lifetime_variation, _system_def->particle_lifetime_variation);
+	_particles.lifetime[i] = _system_def->particle_lifetime + _random.Float(-_system_def->particle_lifetime_variation, _system_def->particle_lifetime_variation);
 }
 
 
@@ -74,6 +74,15 @@ public:
 class ParticleSystemDef
 {
 public:
+	/*!
+	 *  \brief Destructor, deletes the keyframes
+	 */
+	~ParticleSystemDef();
+
+	/*!
+	 *  \brief computes the keyframe segments, once the keyframes are loaded
+	 */
+	void ComputeKeyframeSegments();
 
 
 	//! Is this system supposed to be displayed
@@ -87,6 +96,9 @@ public:
 	//! contain at least 1 keyframe (in that case, the properties are all held constant)
 	std::vector <ParticleKeyframe *> keyframes;
 
+	//! One segment per keyframe, going from that keyframe to the next one
+	std::vector <ParticleKeyframeSegment> keyframe_segments;
+
 	//! How to blend the particles: VIDEO_NO_BLEND, VIDEO_BLEND, or VIDEO_BLEND_ADD
 	//! For most effects, we want VIDEO_BLEND_ADD
 	int32 blend_mode;
@@ -259,9 +271,19 @@ public:
 	 *  \brief initializes this particle system as an instance of the
 	 *         type of particle system specified by the ParticleSystemDef
 	 * \param sys_def particle definition to base the system off of
+	 * \param load_animation false to only simulate the particles, without
+	 *        loading their images (e.g. when no video context is available)
 	 * \return success/failure
 	 */
-	bool Create(const ParticleSystemDef *sys_def);
+	bool Create(const ParticleSystemDef *sys_def, bool load_animation = true);
+
+
+	/*!
+	 *  \brief starts the system over again, as if it was just created. The
+	 *         particle buffers and the animation frames are kept, so that an
+	 *         unused system can be recycled without any allocation.
+	 */
+	void Reset();
 
 
 	/*!
@@ -329,6 +351,15 @@ private:
 	void _UpdateParticles(float t, const EffectParameters &params);
 
 
+	/*!
+	 *  \brief helper function moving a particle to the keyframe matching its
+	 *         age, and computing the property values to interpolate
+	 * \param i index of the particle
+	 * \param scaled_time the particle age, from 0 to 1 over its lifetime
+	 */
+	void _AdvanceKeyframe(int32 i, float scaled_time);
+
+
 	/*!
 	 *  \brief helper function to kill off any particles that have died
 	 *
@@ -391,9 +422,11 @@ private:
 	std::vector <hoa_video::Color> _particle_colors;
 	std::vector <ParticleTexCoord> _particle_texcoords;
 
-	//! This array holds everything except positions and colors. The reason we keep positions and
-	//! colors separate is so that they can be efficiently fed to OpenGL for rendering.
-	std::vector <Particle>     _particles;
+	//! The properties of every particle
+	ParticleArrays _particles;
+
+	//! Random numbers used when spawning particles
+	ParticleRandom _random;
 
 	//! if stopped is true, no new particles should be emitted
 	bool _stopped;
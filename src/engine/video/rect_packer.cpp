@@ -0,0 +1,226 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   rect_packer.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Source file for the rectangle packing code
+*** **************************************************************************/
+
+#include "rect_packer.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace hoa_video {
+
+namespace private_video {
+
+RectanglePacker::RectanglePacker() :
+	_width(0),
+	_height(0),
+	_used_area(0),
+	_free_rects_merged(true)
+{}
+
+
+
+void RectanglePacker::Reset(uint32 width, uint32 height) {
+	_width = width;
+	_height = height;
+	_used_area = 0;
+	_used_rects.clear();
+	_free_rects.clear();
+	_free_rects.push_back(Rect(0, 0, width, height));
+	_free_rects_merged = true;
+}
+
+
+
+bool RectanglePacker::Insert(uint32 width, uint32 height, uint32& x, uint32& y) {
+	if (width == 0 || height == 0)
+		return false;
+
+	// Don't bother looking for a place when there isn't enough free space in total
+	if (width > _width || height > _height || width * height > _width * _height - _used_area)
+		return false;
+
+	int32 best_index = _FindFreeRect(width, height);
+	// The space freed by the removed rectangles may be split into several free rectangles,
+	// so they are merged back before giving up
+	if (best_index < 0 && _free_rects_merged == false) {
+		_RebuildFreeRects();
+		best_index = _FindFreeRect(width, height);
+	}
+	if (best_index < 0)
+		return false;
+
+	Rect used(_free_rects[best_index].x, _free_rects[best_index].y, width, height);
+	_PlaceRect(used);
+	_used_rects.push_back(used);
+	_used_area += width * height;
+
+	x = used.x;
+	y = used.y;
+	return true;
+}
+
+
+
+bool RectanglePacker::Reserve(uint32 x, uint32 y, uint32 width, uint32 height) {
+	if (width == 0 || height == 0 || x + width > _width || y + height > _height)
+		return false;
+
+	Rect used(x, y, width, height);
+	for (uint32 i = 0; i < _used_rects.size(); ++i) {
+		const Rect& other = _used_rects[i];
+		if (x < other.x + other.width && other.x < x + width && y < other.y + other.height && other.y < y + height)
+			return false;
+	}
+
+	_PlaceRect(used);
+	_used_rects.push_back(used);
+	_used_area += width * height;
+	return true;
+}
+
+
+
+bool RectanglePacker::Remove(uint32 x, uint32 y, uint32 width, uint32 height) {
+	for (uint32 i = 0; i < _used_rects.size(); ++i) {
+		const Rect& used = _used_rects[i];
+		if (used.x != x || used.y != y || used.width != width || used.height != height)
+			continue;
+
+		_used_area -= width * height;
+		_used_rects[i] = _used_rects.back();
+		_used_rects.pop_back();
+
+		// The freed space is simply added as a new free rectangle. Computing the maximal
+		// free rectangles again is only done when an insertion fails.
+		_free_rects.push_back(Rect(x, y, width, height));
+		_free_rects_merged = false;
+		return true;
+	}
+
+	return false;
+}
+
+
+
+uint32 RectanglePacker::GetLargestFreeArea() {
+	if (_free_rects_merged == false)
+		_RebuildFreeRects();
+
+	uint32 largest = 0;
+	for (uint32 i = 0; i < _free_rects.size(); ++i)
+		largest = max(largest, _free_rects[i].width * _free_rects[i].height);
+	return largest;
+}
+
+
+
+float RectanglePacker::GetOccupancy() const {
+	if (_width == 0 || _height == 0)
+		return 0.0f;
+	return static_cast<float>(_used_area) / (static_cast<float>(_width) * static_cast<float>(_height));
+}
+
+
+
+int32 RectanglePacker::_FindFreeRect(uint32 width, uint32 height) const {
+	// Best short side fit: use the free rectangle leaving the smallest leftover on its
+	// shortest side, and the smallest leftover on its longest side in case of a tie
+	int32 best_index = -1;
+	uint32 best_short_side = 0xFFFFFFFF;
+	uint32 best_long_side = 0xFFFFFFFF;
+	for (uint32 i = 0; i < _free_rects.size(); ++i) {
+		const Rect& free_rect = _free_rects[i];
+		if (free_rect.width < width || free_rect.height < height)
+			continue;
+
+		uint32 leftover_x = free_rect.width - width;
+		uint32 leftover_y = free_rect.height - height;
+		uint32 short_side = min(leftover_x, leftover_y);
+		uint32 long_side = max(leftover_x, leftover_y);
+		if (short_side < best_short_side || (short_side == best_short_side && long_side < best_long_side)) {
+			best_index = i;
+			best_short_side = short_side;
+			best_long_side = long_side;
+		}
+	}
+	return best_index;
+}
+
+
+
+void RectanglePacker::_RebuildFreeRects() {
+	_free_rects.clear();
+	_free_rects.push_back(Rect(0, 0, _width, _height));
+	for (uint32 i = 0; i < _used_rects.size(); ++i)
+		_PlaceRect(_used_rects[i]);
+	_free_rects_merged = true;
+}
+
+
+
+void RectanglePacker::_PlaceRect(const Rect& used) {
+	// The free rectangles intersecting the used one are replaced by their parts lying outside of it
+	std::vector<Rect> split_rects;
+	uint32 kept = 0;
+	for (uint32 i = 0; i < _free_rects.size(); ++i) {
+		if (_SplitFreeRect(_free_rects[i], used, split_rects) == false)
+			_free_rects[kept++] = _free_rects[i];
+	}
+	_free_rects.resize(kept);
+
+	// The parts are smaller than the rectangle they come from, so only they may be contained
+	// in another free rectangle. The untouched free rectangles are still maximal.
+	for (uint32 i = 0; i < split_rects.size(); ++i) {
+		bool contained = false;
+		for (uint32 j = 0; j < split_rects.size() && contained == false; ++j) {
+			// Of two identical parts, only the first one is kept
+			if (j != i && split_rects[i].IsContainedIn(split_rects[j]))
+				contained = (split_rects[j].IsContainedIn(split_rects[i]) == false || j < i);
+		}
+		for (uint32 j = 0; j < kept && contained == false; ++j)
+			contained = split_rects[i].IsContainedIn(_free_rects[j]);
+
+		if (contained == false)
+			_free_rects.push_back(split_rects[i]);
+	}
+}
+
+
+
+bool RectanglePacker::_SplitFreeRect(const Rect& free_rect, const Rect& used, std::vector<Rect>& parts) {
+	if (used.x >= free_rect.x + free_rect.width || used.x + used.width <= free_rect.x ||
+			used.y >= free_rect.y + free_rect.height || used.y + used.height <= free_rect.y)
+		return false;
+
+	// Left and right parts
+	if (used.x > free_rect.x)
+		parts.push_back(Rect(free_rect.x, free_rect.y, used.x - free_rect.x, free_rect.height));
+	if (used.x + used.width < free_rect.x + free_rect.width)
+		parts.push_back(Rect(used.x + used.width, free_rect.y, free_rect.x + free_rect.width - used.x - used.width, free_rect.height));
+
+	// Top and bottom parts
+	if (used.y > free_rect.y)
+		parts.push_back(Rect(free_rect.x, free_rect.y, free_rect.width, used.y - free_rect.y));
+	if (used.y + used.height < free_rect.y + free_rect.height)
+		parts.push_back(Rect(free_rect.x, used.y + used.height, free_rect.width, free_rect.y + free_rect.height - used.y - used.height));
+
+	return true;
+}
+
+} // namespace private_video
+
+} // namespace hoa_video
@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   rect_packer.h
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Header file for the rectangle packing code
+***
+*** The packer uses the MaxRects algorithm: it keeps the list of the maximal
+*** free rectangles of the area, which may overlap each other, and places each
+*** new rectangle in the free rectangle which leaves the shortest side unused
+*** (best short side fit). This gives tight packings of images of any size
+*** without rounding them to blocks.
+*** **************************************************************************/
+
+#ifndef __RECT_PACKER_HEADER__
+#define __RECT_PACKER_HEADER__
+
+#include "defs.h"
+#include "utils.h"
+
+#include <vector>
+
+namespace hoa_video {
+
+namespace private_video {
+
+/** ****************************************************************************
+*** \brief Finds a place for rectangles of any size in a fixed size area
+***
+*** Rectangles can be removed in any order. Their space is made available
+*** right away, but it is only merged with the surrounding free space once an
+*** insertion fails, as this requires going through every placed rectangle.
+*** ***************************************************************************/
+class RectanglePacker {
+public:
+	RectanglePacker();
+
+	/** \brief Empties the packer and sets the size of its area
+	*** \param width The width of the area
+	*** \param height The height of the area
+	**/
+	void Reset(uint32 width, uint32 height);
+
+	/** \brief Finds a place for a new rectangle and marks it as used
+	*** \param width The width of the rectangle
+	*** \param height The height of the rectangle
+	*** \param x Set to the x position of the rectangle's upper-left corner
+	*** \param y Set to the y position of the rectangle's upper-left corner
+	*** \return False if the rectangle doesn't fit, in which case nothing is changed
+	**/
+	bool Insert(uint32 width, uint32 height, uint32& x, uint32& y);
+
+	/** \brief Marks a rectangle placed beforehand as used, e.g. by the atlas baking tool
+	*** \return False if the rectangle lies outside of the area or overlaps a used one,
+	*** in which case nothing is changed
+	**/
+	bool Reserve(uint32 x, uint32 y, uint32 width, uint32 height);
+
+	/** \brief Frees a rectangle previously placed by Insert()
+	*** \return False if no rectangle was placed at those coordinates with this size
+	**/
+	bool Remove(uint32 x, uint32 y, uint32 width, uint32 height);
+
+	//! \brief Returns the number of pixels covered by the placed rectangles
+	uint32 GetUsedArea() const
+		{ return _used_area; }
+
+	//! \brief Returns the area of the biggest rectangle which could still be inserted
+	uint32 GetLargestFreeArea();
+
+	//! \brief Returns the ratio of the area covered by the placed rectangles, between 0.0f and 1.0f
+	float GetOccupancy() const;
+
+	//! \brief Returns the number of rectangles placed
+	uint32 GetNumberRectangles() const
+		{ return _used_rects.size(); }
+
+private:
+	struct Rect {
+		Rect() :
+			x(0), y(0), width(0), height(0) {}
+
+		Rect(uint32 rx, uint32 ry, uint32 rwidth, uint32 rheight) :
+			x(rx), y(ry), width(rwidth), height(rheight) {}
+
+		//! \brief Tells whether this rectangle lies entirely in another one
+		bool IsContainedIn(const Rect& other) const
+			{ return x >= other.x && y >= other.y && x + width <= other.x + other.width && y + height <= other.y + other.height; }
+
+		uint32 x, y, width, height;
+	};
+
+	//! \brief The size of the packed area
+	uint32 _width, _height;
+
+	//! \brief The sum of the area of the used rectangles
+	uint32 _used_area;
+
+	//! \brief The maximal free rectangles. They may overlap each other.
+	std::vector<Rect> _free_rects;
+
+	//! \brief The rectangles placed by Insert()
+	std::vector<Rect> _used_rects;
+
+	//! \brief False when rectangles were removed since the free rectangles were last computed from the used ones
+	bool _free_rects_merged;
+
+	/** \brief Finds the free rectangle where to place a new one
+	*** \return The index of the free rectangle, or -1 if none is big enough
+	**/
+	int32 _FindFreeRect(uint32 width, uint32 height) const;
+
+	//! \brief Computes the maximal free rectangles again from the used ones
+	void _RebuildFreeRects();
+
+	//! \brief Splits every free rectangle intersecting the given used one
+	void _PlaceRect(const Rect& used);
+
+	/** \brief Computes the parts of a free rectangle which lie outside of a used one
+	*** \param parts The vector where to add the parts
+	*** \return False if the rectangles don't intersect, in which case nothing is added
+	**/
+	bool _SplitFreeRect(const Rect& free_rect, const Rect& used, std::vector<Rect>& parts);
+}; // class RectanglePacker
+
+} // namespace private_video
+
+} // namespace hoa_video
+
+#endif // __RECT_PACKER_HEADER__
@@ -0,0 +1,334 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   sprite_batch.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Source file for the image quad batching code
+*** **************************************************************************/
+
+#include "sprite_batch.h"
+
+#include "video.h"
+#include "image.h"
+
+#include <math.h>
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_video::private_video;
+
+namespace hoa_video {
+
+namespace private_video {
+
+// -----------------------------------------------------------------------------
+// Transform2D class
+// -----------------------------------------------------------------------------
+
+void Transform2D::Rotate(float angle) {
+	float radians = angle * UTILS_PI / 180.0f;
+	float cos_angle = cosf(radians);
+	float sin_angle = sinf(radians);
+
+	float a = _a * cos_angle + _c * sin_angle;
+	float b = _b * cos_angle + _d * sin_angle;
+	_c = _c * cos_angle - _a * sin_angle;
+	_d = _d * cos_angle - _b * sin_angle;
+	_a = a;
+	_b = b;
+}
+
+// -----------------------------------------------------------------------------
+// SpriteBatch class
+// -----------------------------------------------------------------------------
+
+SpriteBatch::SpriteBatch() :
+	_sheet(NULL),
+	_blend(0),
+	_smooth(true)
+{
+	_vertices.reserve(SPRITE_BATCH_MAX_QUADS * 4);
+}
+
+
+
+void SpriteBatch::AddQuad(TexSheet* sheet, int8 blend, bool smooth, const Transform2D& transform,
+	const float* vertex_coords, const float* tex_coords, const Color* colors)
+{
+	_SetState(sheet, blend, smooth);
+	if (_vertices.size() >= SPRITE_BATCH_MAX_QUADS * 4)
+		Flush();
+
+	for (uint32 i = 0; i < 4; ++i) {
+		BatchVertex vertex;
+		transform.Apply(vertex_coords[i * 2], vertex_coords[i * 2 + 1], vertex.x, vertex.y);
+		if (sheet) {
+			vertex.u = tex_coords[i * 2];
+			vertex.v = tex_coords[i * 2 + 1];
+		}
+		else {
+			vertex.u = 0.0f;
+			vertex.v = 0.0f;
+		}
+		vertex.color = colors[i];
+		_vertices.push_back(vertex);
+	}
+}
+
+
+
+void SpriteBatch::AddQuads(TexSheet* sheet, int8 blend, bool smooth, const Transform2D& transform,
+	uint32 num_quads, const float* vertex_coords, const float* tex_coords, const Color* quad_colors,
+	const Color& modulation)
+{
+	_SetState(sheet, blend, smooth);
+
+	for (uint32 q = 0; q < num_quads; ++q) {
+		if (_vertices.size() >= SPRITE_BATCH_MAX_QUADS * 4)
+			Flush();
+
+		Color color = quad_colors[q] * modulation;
+		const float* quad_vertices = vertex_coords + q * 8;
+		const float* quad_tex_coords = tex_coords + q * 8;
+
+		for (uint32 i = 0; i < 4; ++i) {
+			BatchVertex vertex;
+			transform.Apply(quad_vertices[i * 2], quad_vertices[i * 2 + 1], vertex.x, vertex.y);
+			if (sheet) {
+				vertex.u = quad_tex_coords[i * 2];
+				vertex.v = quad_tex_coords[i * 2 + 1];
+			}
+			else {
+				vertex.u = 0.0f;
+				vertex.v = 0.0f;
+			}
+			vertex.color = color;
+			_vertices.push_back(vertex);
+		}
+	}
+} // void SpriteBatch::AddQuads(...)
+
+
+
+void SpriteBatch::Flush() {
+	if (_vertices.empty())
+		return;
+
+	// Set blending parameters
+	if (_blend) {
+		glEnable(GL_BLEND);
+		if (_blend == 1)
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
+		else
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
+	}
+	else {
+		glDisable(GL_BLEND);
+	}
+
+	const BatchVertex& first = _vertices[0];
+
+	if (_sheet) {
+		glEnable(GL_TEXTURE_2D);
+		TextureManager->_BindTexture(_sheet->tex_id);
+		_sheet->Smooth(_smooth);
+
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(BatchVertex), &first.u);
+	}
+	else {
+		// Pure colored quads
+		glDisable(GL_TEXTURE_2D);
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(BatchVertex), &first.x);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glColorPointer(4, GL_FLOAT, sizeof(BatchVertex), first.color.GetColors());
+
+	// The vertices are already transformed, so they are drawn using an identity modelview matrix
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(_vertices.size()));
+	glPopMatrix();
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	if (_sheet)
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	if (_blend)
+		glDisable(GL_BLEND);
+
+	VideoManager->CountDrawCall();
+	_vertices.clear();
+
+	if (VideoManager->CheckGLError()) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occurred: "
+			<< VideoManager->CreateGLErrorString() << endl;
+	}
+} // void SpriteBatch::Flush()
+
+
+
+void SpriteBatch::_SetState(TexSheet* sheet, int8 blend, bool smooth) {
+	// Submit the previous quads when the render state changes
+	if (!_vertices.empty() && (sheet != _sheet || blend != _blend || (sheet && smooth != _smooth)))
+		Flush();
+
+	_sheet = sheet;
+	_blend = blend;
+	_smooth = smooth;
+}
+
+} // namespace private_video
+
+// -----------------------------------------------------------------------------
+// StaticImageBatch class
+// -----------------------------------------------------------------------------
+
+void StaticImageBatch::AddImage(const StillImage& image, float x, float y) {
+	const Context& current_context = VideoManager->_current_context;
+	float h_direction = current_context.coordinate_system.GetHorizontalDirection();
+	float v_direction = current_context.coordinate_system.GetVerticalDirection();
+
+	// Mirror the transformations applied by ImageDescriptor::_DrawOrientation(), screen shaking excepted
+	Transform2D transform;
+	transform.Translate(x, y);
+	transform.Translate(((current_context.x_align + 1) * image._width) * 0.5f * -h_direction,
+		((current_context.y_align + 1) * image._height) * 0.5f * -v_direction);
+	transform.Translate((current_context.x_flip ? image._width : 0.0f) * h_direction,
+		(current_context.y_flip ? image._height : 0.0f) * v_direction);
+	transform.Scale(image._width * h_direction, image._height * v_direction);
+
+	float vertex_coords[] = {
+		image._u1, image._v1,
+		image._u2, image._v1,
+		image._u2, image._v2,
+		image._u1, image._v2,
+	};
+
+	float tex_coords[] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	TexSheet* sheet = NULL;
+	if (image._texture) {
+		BaseTexture* texture = image._texture;
+		sheet = texture->texture_sheet;
+
+		float s0 = texture->u1 + (image._u1 * (texture->u2 - texture->u1));
+		float s1 = texture->u1 + (image._u2 * (texture->u2 - texture->u1));
+		float t0 = texture->v1 + (image._v1 * (texture->v2 - texture->v1));
+		float t1 = texture->v1 + (image._v2 * (texture->v2 - texture->v1));
+		if (current_context.x_flip) {
+			float temp = s0;
+			s0 = s1;
+			s1 = temp;
+		}
+		if (current_context.y_flip) {
+			float temp = t0;
+			t0 = t1;
+			t1 = temp;
+		}
+
+		tex_coords[0] = s0; tex_coords[1] = t1;
+		tex_coords[2] = s1; tex_coords[3] = t1;
+		tex_coords[4] = s1; tex_coords[5] = t0;
+		tex_coords[6] = s0; tex_coords[7] = t0;
+	}
+
+	// Find the group sharing the image render state, or create it
+	QuadGroup* group = NULL;
+	for (uint32 i = 0; i < _groups.size(); ++i) {
+		if (_groups[i].sheet == sheet && _groups[i].blend == image._blend && _groups[i].smooth == image._smooth) {
+			group = &_groups[i];
+			break;
+		}
+	}
+	if (group == NULL) {
+		_groups.push_back(QuadGroup());
+		group = &_groups.back();
+		group->sheet = sheet;
+		group->blend = image._blend;
+		group->smooth = image._smooth;
+	}
+
+	for (uint32 i = 0; i < 4; ++i) {
+		float vertex_x, vertex_y;
+		transform.Apply(vertex_coords[i * 2], vertex_coords[i * 2 + 1], vertex_x, vertex_y);
+		group->vertex_coords.push_back(vertex_x);
+		group->vertex_coords.push_back(vertex_y);
+		group->tex_coords.push_back(tex_coords[i * 2]);
+		group->tex_coords.push_back(tex_coords[i * 2 + 1]);
+	}
+	group->colors.push_back(image._color[0]);
+} // void StaticImageBatch::AddImage(const StillImage& image, float x, float y)
+
+
+
+void StaticImageBatch::Draw() const {
+	for (uint32 i = 0; i < _groups.size(); ++i)
+		_DrawGroup(_groups[i]);
+}
+
+
+
+void StaticImageBatch::DrawBatches(const std::vector<const StaticImageBatch*>& batches) {
+	vector<const QuadGroup*> groups;
+	for (uint32 i = 0; i < batches.size(); ++i) {
+		for (uint32 j = 0; j < batches[i]->_groups.size(); ++j)
+			groups.push_back(&batches[i]->_groups[j]);
+	}
+
+	// Submit the groups render state after render state, so that the sprite batch only has to flush once per texture sheet
+	stable_sort(groups.begin(), groups.end(), _CompareGroupStates);
+	for (uint32 i = 0; i < groups.size(); ++i)
+		_DrawGroup(*groups[i]);
+}
+
+
+
+bool StaticImageBatch::_CompareGroupStates(const QuadGroup* first, const QuadGroup* second) {
+	if (first->sheet != second->sheet)
+		return less<TexSheet*>()(first->sheet, second->sheet);
+	if (first->blend != second->blend)
+		return first->blend < second->blend;
+	return first->smooth < second->smooth;
+}
+
+
+
+void StaticImageBatch::_DrawGroup(const QuadGroup& group) {
+	if (group.colors.empty())
+		return;
+
+	int8 blend = VideoManager->_current_context.blend;
+	if (blend == 0 && group.blend)
+		blend = 1; // Normal blending
+
+	// Apply the screen shaking the same way ImageDescriptor::_DrawOrientation() does
+	Transform2D transform = VideoManager->_transform;
+	if (VideoManager->_shake_forces.size() > 0) {
+		const CoordSys& coordinate_system = VideoManager->_current_context.coordinate_system;
+		float x_shake = VideoManager->_x_shake * (coordinate_system.GetRight() - coordinate_system.GetLeft()) / VIDEO_STANDARD_RES_WIDTH;
+		float y_shake = VideoManager->_y_shake * (coordinate_system.GetTop() - coordinate_system.GetBottom()) / VIDEO_STANDARD_RES_HEIGHT;
+		transform.Translate(x_shake * coordinate_system.GetHorizontalDirection(), y_shake * coordinate_system.GetVerticalDirection());
+	}
+
+	float modulation = VideoManager->_screen_fader.GetFadeModulation();
+	Color fade_color(modulation, modulation, modulation, 1.0f);
+
+	VideoManager->_sprite_batch.AddQuads(group.sheet, blend, group.smooth, transform,
+		group.colors.size(), &group.vertex_coords[0], &group.tex_coords[0], &group.colors[0], fade_color);
+} // void StaticImageBatch::_DrawGroup(const QuadGroup& group)
+
+} // namespace hoa_video
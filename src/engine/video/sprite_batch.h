@@ -0,0 +1,239 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   sprite_batch.h
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Header file for the image quad batching code
+***
+*** Every image drawn through ImageDescriptor::_DrawTexture() is queued in the
+*** sprite batch instead of being sent to OpenGL right away. The queued quads
+*** are submitted with a single draw call each time the texture sheet, the
+*** blending mode or the smoothing changes, or when any other OpenGL state
+*** the quads depend on is about to be modified.
+*** **************************************************************************/
+
+#ifndef __SPRITE_BATCH_HEADER__
+#define __SPRITE_BATCH_HEADER__
+
+#include "defs.h"
+#include "utils.h"
+
+#include "color.h"
+
+#include <vector>
+
+namespace hoa_video {
+
+namespace private_video {
+
+class TexSheet;
+
+//! \brief The maximum number of quads queued before the batch is forcibly flushed
+const uint32 SPRITE_BATCH_MAX_QUADS = 4096;
+
+/** ****************************************************************************
+*** \brief A 2D affine transformation mirroring the OpenGL modelview matrix
+***
+*** The video engine keeps this copy of the modelview matrix up to date in every
+*** one of its transformation methods, so that batched quads can be transformed
+*** on the CPU without querying the matrix back from OpenGL.
+***
+*** The matrix is stored the OpenGL way (column-major), i.e. a point (x, y) is
+*** transformed into (a * x + c * y + tx, b * x + d * y + ty).
+*** ***************************************************************************/
+class Transform2D {
+public:
+	Transform2D()
+		{ Reset(); }
+
+	//! \brief Resets the transformation to the identity matrix (glLoadIdentity())
+	void Reset()
+		{ _a = 1.0f; _b = 0.0f; _c = 0.0f; _d = 1.0f; _tx = 0.0f; _ty = 0.0f; }
+
+	//! \brief Equivalent of glTranslatef(x, y, 0.0f)
+	void Translate(float x, float y)
+		{ _tx += _a * x + _c * y; _ty += _b * x + _d * y; }
+
+	//! \brief Equivalent of glScalef(x, y, 1.0f)
+	void Scale(float x, float y)
+		{ _a *= x; _b *= x; _c *= y; _d *= y; }
+
+	//! \brief Equivalent of glRotatef(angle, 0.0f, 0.0f, 1.0f). The angle is in degrees.
+	void Rotate(float angle);
+
+	/** \brief Loads the 2D part of an OpenGL 4x4 matrix (glLoadMatrixf())
+	*** \param matrix A pointer to 16 floats, in column-major order
+	**/
+	void Load(const float* matrix)
+		{ _a = matrix[0]; _b = matrix[1]; _c = matrix[4]; _d = matrix[5]; _tx = matrix[12]; _ty = matrix[13]; }
+
+	//! \brief Transforms the given point
+	void Apply(float x, float y, float& out_x, float& out_y) const
+		{ out_x = _a * x + _c * y + _tx; out_y = _b * x + _d * y + _ty; }
+
+private:
+	//! \brief The 2x2 linear part of the matrix
+	float _a, _b, _c, _d;
+
+	//! \brief The translation part of the matrix
+	float _tx, _ty;
+}; // class Transform2D
+
+
+/** ****************************************************************************
+*** \brief Accumulates textured and colored quads sharing the same render state
+***
+*** The quads are stored already transformed into the current coordinate
+*** system, so that a single glDrawArrays() call can draw quads coming from
+*** many different draw cursor positions. The vertex buffer is kept across
+*** frames so that no memory allocation happens once it has grown to the size
+*** of a typical frame.
+***
+*** \note Anything issuing raw OpenGL draw calls or changing the projection,
+*** viewport, scissoring or texture content must call VideoEngine::FlushBatch()
+*** first, so that the queued quads are drawn in the correct order and state.
+*** ***************************************************************************/
+class SpriteBatch {
+public:
+	SpriteBatch();
+
+	/** \brief Queues a new quad, flushing the previous ones first if the render state differs
+	*** \param sheet The texture sheet to draw from, or NULL for a pure colored quad
+	*** \param blend The blending mode: 0 for none, 1 for alpha blending, 2 for additive blending
+	*** \param smooth Whether the texture sheet should be linearly filtered
+	*** \param transform The modelview transformation to apply on the vertex coordinates
+	*** \param vertex_coords The four (x, y) local vertex coordinates
+	*** \param tex_coords The four (u, v) texture coordinates, ignored when sheet is NULL
+	*** \param colors The four vertex colors
+	**/
+	void AddQuad(TexSheet* sheet, int8 blend, bool smooth, const Transform2D& transform,
+		const float* vertex_coords, const float* tex_coords, const Color* colors);
+
+	/** \brief Queues several quads sharing the same render state and color
+	*** \param num_quads The number of quads to queue
+	*** \param vertex_coords The local vertex coordinates, eight floats per quad
+	*** \param tex_coords The texture coordinates, eight floats per quad, ignored when sheet is NULL
+	*** \param quad_colors One color per quad, applied on its four vertices
+	*** \param modulation A color every quad color is multiplied by
+	*** The other parameters are the same as the ones of AddQuad().
+	**/
+	void AddQuads(TexSheet* sheet, int8 blend, bool smooth, const Transform2D& transform,
+		uint32 num_quads, const float* vertex_coords, const float* tex_coords, const Color* quad_colors,
+		const Color& modulation);
+
+	//! \brief Draws every queued quad with a single draw call and empties the batch
+	void Flush();
+
+	//! \brief Tells whether there are quads waiting to be drawn
+	bool IsEmpty() const
+		{ return _vertices.empty(); }
+
+private:
+	//! \brief A single interleaved vertex of the batch
+	struct BatchVertex {
+		float x, y;
+		float u, v;
+		Color color;
+	};
+
+	//! \brief The persistent vertex buffer, four vertices per quad
+	std::vector<BatchVertex> _vertices;
+
+	//! \brief The render state of the quads currently queued
+	//@{
+	TexSheet* _sheet;
+	int8 _blend;
+	bool _smooth;
+	//@}
+
+	//! \brief Flushes the queued quads if their render state differs from the given one, then adopts it
+	void _SetState(TexSheet* sheet, int8 blend, bool smooth);
+}; // class SpriteBatch
+
+} // namespace private_video
+
+/** ****************************************************************************
+*** \brief Prebuilt geometry of still images which never move relatively to each other
+***
+*** The images are recorded once with AddImage(), which computes their quads
+*** using the current draw flags and coordinate system, just like a call to
+*** StillImage::Draw() at that position would. The recorded quads are then
+*** drawn relatively to the draw cursor by Draw(), without any per-image cost
+*** apart from the vertex transformation. This is typically used for the map
+*** tile layers, whose tiles don't change once loaded.
+***
+*** \note Only the upper-left vertex color of the recorded images is used.
+*** \note The recorded images must outlive the batch, as their texture sheets
+*** are referenced without being reference counted.
+*** \note The recorded texture coordinates are outdated once the images are moved
+*** in their texture sheet: the batch must then be recorded again. This happens
+*** when TextureController::GetTexSheetLayoutVersion() changes.
+*** ***************************************************************************/
+class StaticImageBatch {
+public:
+	StaticImageBatch()
+		{}
+
+	//! \brief Removes every recorded image
+	void Clear()
+		{ _groups.clear(); }
+
+	//! \brief Tells whether no image has been recorded
+	bool IsEmpty() const
+		{ return _groups.empty(); }
+
+	/** \brief Records the quad of a still image
+	*** \param image The image to record
+	*** \param x The x position of the image, relative to the origin the batch is later drawn at
+	*** \param y The y position of the image, relative to the origin the batch is later drawn at
+	**/
+	void AddImage(const StillImage& image, float x, float y);
+
+	//! \brief Queues the recorded quads in the video engine, relatively to the current draw cursor position
+	void Draw() const;
+
+	/** \brief Draws several batches, grouping their quads by texture sheet
+	*** \param batches The batches to draw, relatively to the current draw cursor position
+	***
+	*** This results in one draw call per texture sheet used, no matter how many
+	*** batches are given. The quads of different batches are thus not drawn in
+	*** order, which is only correct when the batches don't overlap.
+	**/
+	static void DrawBatches(const std::vector<const StaticImageBatch*>& batches);
+
+private:
+	//! \brief The recorded quads sharing the same render state
+	struct QuadGroup {
+		private_video::TexSheet* sheet;
+		bool blend;
+		bool smooth;
+
+		//! \brief Eight vertex coordinates and eight texture coordinates per quad
+		std::vector<float> vertex_coords;
+		std::vector<float> tex_coords;
+
+		//! \brief One color per quad
+		std::vector<Color> colors;
+	};
+
+	//! \brief The recorded quads, grouped by render state
+	std::vector<QuadGroup> _groups;
+
+	//! \brief Queues the quads of a group in the video engine sprite batch
+	static void _DrawGroup(const QuadGroup& group);
+
+	//! \brief Orders the quad groups by render state
+	static bool _CompareGroupStates(const QuadGroup* first, const QuadGroup* second);
+}; // class StaticImageBatch
+
+} // namespace hoa_video
+
+#endif // __SPRITE_BATCH_HEADER__
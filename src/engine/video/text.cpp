@@ -26,6 +26,8 @@
 
 #include "video.h"
 
+#include "engine/system.h"
+
 using namespace std;
 using namespace hoa_utils;
 using namespace hoa_video::private_video;
@@ -36,12 +38,38 @@ namespace hoa_video {
 
 TextSupervisor* TextManager = NULL;
 
+//! \brief Returns the FNV-1a hash of a unicode text
+static uint32 HashText(const ustring& text) {
+	uint32 hash = 2166136261u;
+	for (uint32 i = 0; i < text.length(); ++i) {
+		hash ^= text[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+//! \brief Returns the handle of a font, or INVALID_FONT_HANDLE while the text supervisor is being created
+static uint32 FindFontHandle(const string& font_name) {
+	if (TextManager == NULL)
+		return INVALID_FONT_HANDLE;
+	return TextManager->GetFontHandle(font_name);
+}
+
+//! \brief Returns the generation of the loaded fonts, which the font handles set now are valid for
+static uint32 CurrentFontGeneration() {
+	if (TextManager == NULL)
+		return 0;
+	return TextManager->GetFontGeneration();
+}
+
 // -----------------------------------------------------------------------------
 // TextStyle class
 // -----------------------------------------------------------------------------
 
 TextStyle::TextStyle() :
 	font(VideoManager->Text()->GetDefaultStyle().font),
+	font_handle(VideoManager->Text()->GetDefaultStyle().font_handle),
+	font_generation(VideoManager->Text()->GetDefaultStyle().font_generation),
 	color(VideoManager->Text()->GetDefaultStyle().color),
 	shadow_style(VideoManager->Text()->GetDefaultStyle().shadow_style),
 	shadow_offset_x(VideoManager->Text()->GetDefaultStyle().shadow_offset_x),
@@ -52,6 +80,8 @@ TextStyle::TextStyle() :
 
 TextStyle::TextStyle(string fnt) :
 	font(fnt),
+	font_handle(FindFontHandle(fnt)),
+	font_generation(CurrentFontGeneration()),
 	color(VideoManager->Text()->GetDefaultStyle().color),
 	shadow_style(VideoManager->Text()->GetDefaultStyle().shadow_style),
 	shadow_offset_x(VideoManager->Text()->GetDefaultStyle().shadow_offset_x),
@@ -62,6 +92,8 @@ TextStyle::TextStyle(string fnt) :
 
 TextStyle::TextStyle(Color c) :
 	font(VideoManager->Text()->GetDefaultStyle().font),
+	font_handle(VideoManager->Text()->GetDefaultStyle().font_handle),
+	font_generation(VideoManager->Text()->GetDefaultStyle().font_generation),
 	color(c),
 	shadow_style(VideoManager->Text()->GetDefaultStyle().shadow_style),
 	shadow_offset_x(VideoManager->Text()->GetDefaultStyle().shadow_offset_x),
@@ -72,6 +104,8 @@ TextStyle::TextStyle(Color c) :
 
 TextStyle::TextStyle(TEXT_SHADOW_STYLE style) :
 	font(VideoManager->Text()->GetDefaultStyle().font),
+	font_handle(VideoManager->Text()->GetDefaultStyle().font_handle),
+	font_generation(VideoManager->Text()->GetDefaultStyle().font_generation),
 	color(VideoManager->Text()->GetDefaultStyle().color),
 	shadow_style(style),
 	shadow_offset_x(VideoManager->Text()->GetDefaultStyle().shadow_offset_x),
@@ -82,6 +116,8 @@ TextStyle::TextStyle(TEXT_SHADOW_STYLE style) :
 
 TextStyle::TextStyle(string fnt, Color c) :
 	font(fnt),
+	font_handle(FindFontHandle(fnt)),
+	font_generation(CurrentFontGeneration()),
 	color(c),
 	shadow_style(VideoManager->Text()->GetDefaultStyle().shadow_style),
 	shadow_offset_x(VideoManager->Text()->GetDefaultStyle().shadow_offset_x),
@@ -92,6 +128,8 @@ TextStyle::TextStyle(string fnt, Color c) :
 
 TextStyle::TextStyle(string fnt, TEXT_SHADOW_STYLE style) :
 	font(fnt),
+	font_handle(FindFontHandle(fnt)),
+	font_generation(CurrentFontGeneration()),
 	color(VideoManager->Text()->GetDefaultStyle().color),
 	shadow_style(style),
 	shadow_offset_x(VideoManager->Text()->GetDefaultStyle().shadow_offset_x),
@@ -102,6 +140,8 @@ TextStyle::TextStyle(string fnt, TEXT_SHADOW_STYLE style) :
 
 TextStyle::TextStyle(Color c, TEXT_SHADOW_STYLE style) :
 	font(VideoManager->Text()->GetDefaultStyle().font),
+	font_handle(VideoManager->Text()->GetDefaultStyle().font_handle),
+	font_generation(VideoManager->Text()->GetDefaultStyle().font_generation),
 	color(c),
 	shadow_style(style),
 	shadow_offset_x(VideoManager->Text()->GetDefaultStyle().shadow_offset_x),
@@ -112,6 +152,8 @@ TextStyle::TextStyle(Color c, TEXT_SHADOW_STYLE style) :
 
 TextStyle::TextStyle(string fnt, Color c, TEXT_SHADOW_STYLE style) :
 	font(fnt),
+	font_handle(FindFontHandle(fnt)),
+	font_generation(CurrentFontGeneration()),
 	color(c),
 	shadow_style(style),
 	shadow_offset_x(VideoManager->Text()->GetDefaultStyle().shadow_offset_x),
@@ -122,12 +164,22 @@ TextStyle::TextStyle(string fnt, Color c, TEXT_SHADOW_STYLE style) :
 
 TextStyle::TextStyle(string fnt, Color c, TEXT_SHADOW_STYLE style, int32 shadow_x, int32 shadow_y) :
 	font(fnt),
+	font_handle(FindFontHandle(fnt)),
+	font_generation(CurrentFontGeneration()),
 	color(c),
 	shadow_style(style),
 	shadow_offset_x(shadow_x),
 	shadow_offset_y(shadow_y)
 {}
 
+
+
+void TextStyle::SetFont(const string& fnt) {
+	font = fnt;
+	font_handle = FindFontHandle(fnt);
+	font_generation = CurrentFontGeneration();
+}
+
 namespace private_video {
 
 // Endian-dependent bit masks for the different color channels
@@ -168,7 +220,8 @@ TextTexture::~TextTexture() {
 bool TextTexture::Regenerate() {
 	if (texture_sheet) {
 		texture_sheet->RemoveTexture(this);
-		TextureManager->_RemoveSheet(texture_sheet);
+		if (texture_sheet->is_dedicated)
+			TextureManager->_RemoveSheet(texture_sheet);
 		texture_sheet = NULL;
 	}
 
@@ -260,7 +313,7 @@ void TextElement::Draw(const Color& draw_color) const {
 		return;
 	}
 
-	glPushMatrix();
+	VideoManager->PushMatrix();
 	_DrawOrientation();
 
 	float modulation = VideoManager->_screen_fader.GetFadeModulation();
@@ -281,7 +334,7 @@ void TextElement::Draw(const Color& draw_color) const {
 		_DrawTexture(modulated_colors);
 	}
 
-	glPopMatrix();
+	VideoManager->PopMatrix();
 } // void TextElement::Draw(const Color& draw_color) const
 
 
@@ -384,6 +437,16 @@ TextImage& TextImage::operator=(const TextImage& copy) {
 
 
 
+void TextImage::SetNumber(int32 number) {
+	// The number is formatted into a buffer shared by all of the text images, then compared to the text
+	static ustring number_text;
+	number_text.clear();
+	AppendNumber(number_text, number);
+	SetText(number_text);
+}
+
+
+
 void TextImage::Clear() {
 	ImageDescriptor::Clear();
 	_string.clear();
@@ -398,12 +461,12 @@ void TextImage::Clear() {
 
 
 void TextImage::Draw() const {
-	glPushMatrix();
+	VideoManager->PushMatrix();
 	for (uint32 i = 0; i < _text_sections.size(); ++i) {
 		_text_sections[i]->Draw();
 		VideoManager->MoveRelative(0.0f, TextManager->GetFontProperties(_style.font)->line_skip * -VideoManager->_current_context.coordinate_system.GetVerticalDirection());
 	}
-	glPopMatrix();
+	VideoManager->PopMatrix();
 }
 
 
@@ -414,12 +477,12 @@ void TextImage::Draw(const Color& draw_color) const {
 		return;
 	}
 
-	glPushMatrix();
+	VideoManager->PushMatrix();
 	for (uint32 i = 0; i < _text_sections.size(); ++i) {
 		_text_sections[i]->Draw(draw_color);
 		VideoManager->MoveRelative(0.0f, TextManager->GetFontProperties(_style.font)->line_skip * -VideoManager->_current_context.coordinate_system.GetVerticalDirection());
 	}
-	glPopMatrix();
+	VideoManager->PopMatrix();
 }
 
 
@@ -504,7 +567,8 @@ void TextImage::_Regenerate() {
 
 // When TextSupervisor is created, the
 TextSupervisor::TextSupervisor() :
-	_default_style("", Color(), VIDEO_TEXT_SHADOW_INVALID, 0, 0)
+	_default_style("", Color(), VIDEO_TEXT_SHADOW_INVALID, 0, 0),
+	_font_generation(0)
 {}
 
 
@@ -517,16 +581,14 @@ TextSupervisor::~TextSupervisor() {
 		if (fp->ttf_font)
 			TTF_CloseFont(fp->ttf_font);
 
-		if (fp->glyph_cache) {
-			for (std::map<uint16, FontGlyph*>::iterator j = fp->glyph_cache->begin(); j != fp->glyph_cache->end(); j++) {
-				delete (*j).second;
-			}
-			delete fp->glyph_cache;
-		}
+		_ClearGlyphCache(fp);
+		for (uint32 j = 0; j < fp->glyph_sheets.size(); ++j)
+			TextureManager->_RemoveSheet(fp->glyph_sheets[j]);
 
 		delete fp;
 	}
 
+	_ClearTextLayouts();
 	TTF_Quit();
 }
 
@@ -578,8 +640,15 @@ bool TextSupervisor::LoadFont(const string& filename, const string& font_name, u
 	fp->descent = TTF_FontDescent(font);
 
 	// Create the glyph cache for the font and add it to the font map
-	fp->glyph_cache = new std::map<uint16, FontGlyph*>;
+	fp->glyph_cache.assign(GLYPH_TABLE_SIZE, NULL);
 	_font_map[font_name] = fp;
+
+	// Intern the font into the next handle
+	fp->handle = _fonts.size();
+	_fonts.push_back(fp);
+	++_font_generation;
+
+	_PrewarmGlyphs(fp);
 	return true;
 } // bool TextSupervisor::LoadFont(...)
 
@@ -592,6 +661,9 @@ void TextSupervisor::FreeFont(const std::string& font_name) {
 	}
 
 	// TODO: implement the rest of this function
+
+	// The font handles set before are to be checked again
+	++_font_generation;
 }
 
 
@@ -607,63 +679,81 @@ FontProperties* TextSupervisor::GetFontProperties(const std::string& font_name)
 
 
 
-void TextSupervisor::Draw(const ustring& text, const TextStyle& style) {
+FontProperties* TextSupervisor::GetFontProperties(const TextStyle& style) {
+	// The font of a style is fetched through its handle, as long as no font was loaded or freed since it was set
+	if (style.font_generation == _font_generation && style.font_handle < _fonts.size())
+		return _fonts[style.font_handle];
+
+	// Otherwise the font is looked up by its name, and the style keeps its new handle for the next calls
+	map<string, FontProperties*>::iterator font = _font_map.find(style.font);
+	style.font_handle = (font != _font_map.end()) ? font->second->handle : INVALID_FONT_HANDLE;
+	style.font_generation = _font_generation;
+	if (font == _font_map.end())
+		return NULL;
+
+	return font->second;
+}
+
+
+
+uint32 TextSupervisor::GetFontHandle(const std::string& font_name) const {
+	map<string, FontProperties*>::const_iterator font = _font_map.find(font_name);
+	if (font == _font_map.end())
+		return INVALID_FONT_HANDLE;
+
+	return font->second->handle;
+}
+
+
+
+void TextSupervisor::Draw(const ustring& text, const TextStyle& style, uint32 first_char, uint32 num_chars) {
 	if (text.empty()) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "empty string was passed to function" << endl;
 		return;
 	}
 
-	if (IsFontValid(style.font) == false) {
+	FontProperties* fp = GetFontProperties(style);
+	if (fp == NULL) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed because font was invalid: " << style.font << endl;
 		return;
 	}
 
-	FontProperties* fp = _font_map[style.font];
+	const TextLayout* layout = _GetTextLayout(text, fp);
+	uint32 last_char = first_char + num_chars;
 	VideoManager->PushState();
 
-	// Break the string into lines and render the shadow and text for each line
-	uint16 buffer[2048];
-	const uint16 NEWLINE = '\n';
-	size_t last_line = 0;
-	do {
-		// Find the next new line character in the string and save the line
-		size_t next_line;
-		for (next_line = last_line; next_line < text.length(); next_line++) {
-			if (text[next_line] == NEWLINE)
-				break;
-
-			buffer[next_line - last_line] = text[next_line];
-		}
-		buffer[next_line - last_line] = 0;
-		last_line = next_line + 1;
-
-		// If this line is empty, skip on to the next one
-		if (buffer[0] == 0) {
-			VideoManager->MoveRelative(0, -fp->line_skip * VideoManager->_current_context.coordinate_system.GetVerticalDirection());
-			continue;
-		}
-
-		// Save the draw cursor position before drawing this text
-		glPushMatrix();
+	// Render the shadow and text of the part of each line within the range
+	for (uint32 i = 0; i < layout->lines.size(); ++i) {
+		const TextLayoutLine& line = layout->lines[i];
+		uint32 line_end = line.first_char + line.glyphs.size();
+		uint32 begin = std::max(first_char, line.first_char);
+		uint32 end = std::min(last_char, line_end);
+
+		// Skip the empty lines, and the lines out of the range
+		if (begin < end) {
+			// Save the draw cursor position before drawing this text
+			VideoManager->PushMatrix();
+
+			// If text shadows are enabled, draw the shadow first
+			if (style.shadow_style != VIDEO_TEXT_SHADOW_NONE) {
+				VideoManager->PushMatrix();
+				VideoManager->MoveRelative(VideoManager->_current_context.coordinate_system.GetHorizontalDirection() * style.shadow_offset_x, 0.0f);
+				VideoManager->MoveRelative(0.0f, VideoManager->_current_context.coordinate_system.GetVerticalDirection() * style.shadow_offset_y);
+				_DrawTextHelper(line, begin - line.first_char, end - line.first_char, fp, _GetTextShadowColor(style));
+				VideoManager->PopMatrix();
+			}
 
-		// If text shadows are enabled, draw the shadow first
-		if (style.shadow_style != VIDEO_TEXT_SHADOW_NONE) {
-			glPushMatrix();
-			VideoManager->MoveRelative(VideoManager->_current_context.coordinate_system.GetHorizontalDirection() * style.shadow_offset_x, 0.0f);
-			VideoManager->MoveRelative(0.0f, VideoManager->_current_context.coordinate_system.GetVerticalDirection() * style.shadow_offset_y);
-			_DrawTextHelper(buffer, fp, _GetTextShadowColor(style));
-			glPopMatrix();
+			// Now draw the text itself and restore the position of the draw cursor
+			_DrawTextHelper(line, begin - line.first_char, end - line.first_char, fp, style.color);
+			VideoManager->PopMatrix();
 		}
 
-		// Now draw the text itself, restore the position of the draw cursor, and move the draw cursor one line down
-		_DrawTextHelper(buffer, fp, style.color);
-		glPopMatrix();
+		// Move the draw cursor one line down
 		VideoManager->MoveRelative(0, -fp->line_skip * VideoManager->_current_context.coordinate_system.GetVerticalDirection());
-
-	} while (last_line < text.length());
+	}
 
 	VideoManager->PopState();
-} // void TextSupervisor::Draw(const ustring& text)
+} // void TextSupervisor::Draw(const ustring& text, const TextStyle& style, uint32 first_char, uint32 num_chars)
 
 
 
@@ -673,12 +763,40 @@ int32 TextSupervisor::CalculateTextWidth(const std::string& font_name, const hoa
 		return -1;
 	}
 
-	int32 width;
-	if (TTF_SizeUNICODE(_font_map[font_name]->ttf_font, text.c_str(), &width, NULL) == -1) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "call to TTF_SizeUNICODE failed with TTF error: " << TTF_GetError() << endl;
+	return _GetTextLayout(text, _font_map[font_name])->width;
+}
+
+
+
+int32 TextSupervisor::CalculateTextWidth(const TextStyle& style, const hoa_utils::ustring& text) {
+	FontProperties* fp = GetFontProperties(style);
+	if (fp == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "font of the style argument was invalid: " << style.font << endl;
 		return -1;
 	}
 
+	return _GetTextLayout(text, fp)->width;
+}
+
+
+
+int32 TextSupervisor::CalculateTextWidth(const std::string& font_name, const hoa_utils::ustring& text, uint32 num_chars) {
+	if (IsFontValid(font_name) == false) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "font name argument was invalid: " << font_name << endl;
+		return -1;
+	}
+
+	const TextLayout* layout = _GetTextLayout(text, _font_map[font_name]);
+	int32 width = 0;
+	for (uint32 i = 0; i < layout->lines.size(); ++i) {
+		const TextLayoutLine& line = layout->lines[i];
+		if (line.first_char >= num_chars)
+			break;
+
+		uint32 end = std::min(num_chars - line.first_char, static_cast<uint32>(line.glyphs.size()));
+		width = std::max(width, line.positions[end]);
+	}
+
 	return width;
 }
 
@@ -756,7 +874,6 @@ void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp) {
 	SDL_Surface* initial = NULL;
 	SDL_Surface* intermediary = NULL;
 	int32 w, h;
-	GLuint texture;
 
 	// Go through each character in the string and cache those glyphs that have not already been cached
 	for (const uint16* character_ptr = text; *character_ptr != 0; ++character_ptr) {
@@ -764,7 +881,7 @@ void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp) {
 		const uint16& character = *character_ptr;
 
 		// Check if glyph already cached. If so, move on to the next character
-		if (fp->glyph_cache->find(character) != fp->glyph_cache->end())
+		if (fp->glyph_cache[character] != NULL)
 			continue;
 
 		// Attempt to create the initial SDL_Surface that contains the rendered glyph
@@ -778,8 +895,9 @@ void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp) {
 			}
 		}
 
-		w = RoundUpPow2(initial->w + 1);
-		h = RoundUpPow2(initial->h + 1);
+		// Keep a transparent border on the right and bottom sides, as the glyphs are drawn smoothed
+		w = initial->w + 1;
+		h = initial->h + 1;
 
 		intermediary = SDL_CreateRGBSurface(0, w, h, 32, RMASK, GMASK, BMASK, AMASK);
 		if (intermediary == NULL) {
@@ -796,170 +914,290 @@ void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp) {
 			return;
 		}
 
-		glGenTextures(1, &texture);
-		TextureManager->_BindTexture(texture);
-
-
 		SDL_LockSurface(intermediary);
 
-		uint32 num_bytes = w * h * 4;
-		for (uint32 j = 0; j < num_bytes; j += 4) {
-			(static_cast<uint8*>(intermediary->pixels))[j+3] = (static_cast<uint8*>(intermediary->pixels))[j+2];
-			(static_cast<uint8*>(intermediary->pixels))[j+0] = 0xff;
-			(static_cast<uint8*>(intermediary->pixels))[j+1] = 0xff;
-			(static_cast<uint8*>(intermediary->pixels))[j+2] = 0xff;
+		// The glyph is rendered in white, so that it can be drawn in any color
+		ImageMemory glyph_data;
+		glyph_data.width = w;
+		glyph_data.height = h;
+		glyph_data.rgb_format = false;
+		glyph_data.pixels = malloc(w * h * 4);
+		uint8* source = static_cast<uint8*>(intermediary->pixels);
+		uint8* destination = static_cast<uint8*>(glyph_data.pixels);
+		for (int32 y = 0; y < h; ++y) {
+			const uint8* source_row = source + y * intermediary->pitch;
+			for (int32 x = 0; x < w; ++x) {
+				destination[0] = 0xff;
+				destination[1] = 0xff;
+				destination[2] = 0xff;
+				destination[3] = source_row[x * 4 + 2];
+				destination += 4;
+			}
 		}
 
-		glTexImage2D(GL_TEXTURE_2D, 0, 4, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, intermediary->pixels );
 		SDL_UnlockSurface(intermediary);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		if (VideoManager->CheckGLError()) {
-			SDL_FreeSurface(initial);
-			SDL_FreeSurface(intermediary);
-			IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error was detected: " << VideoManager->CreateGLErrorString() << endl;
-			return;
-		}
+		SDL_FreeSurface(intermediary);
+		SDL_FreeSurface(initial);
 
 		int minx, maxx;
 		int miny, maxy;
 		int advance;
 		if (TTF_GlyphMetrics(font, character, &minx, &maxx, &miny, &maxy, &advance) != 0) {
-			SDL_FreeSurface(initial);
-			SDL_FreeSurface(intermediary);
+			free(glyph_data.pixels);
+			glyph_data.pixels = NULL;
 			IF_PRINT_WARNING(VIDEO_DEBUG) << "call to TTF_GlyphMetrics() failed" << endl;
 			return;
 		}
 
+		BaseTexture* texture = new BaseTexture(w, h);
+		bool added = _AddGlyphToSheet(fp, texture, glyph_data);
+		free(glyph_data.pixels);
+		glyph_data.pixels = NULL;
+		if (added == false) {
+			delete texture;
+			IF_PRINT_WARNING(VIDEO_DEBUG) << "could not add the glyph to a glyph sheet" << endl;
+			return;
+		}
+
 		FontGlyph* glyph = new FontGlyph;
 		glyph->texture = texture;
 		glyph->min_x = minx;
 		glyph->min_y = miny;
 		glyph->top_y = fp->ascent - maxy;
-		glyph->width = initial->w + 1;
-		glyph->height = initial->h + 1;
-		glyph->max_x = static_cast<float>(initial->w + 1) / static_cast<float>(w);
-		glyph->max_y = static_cast<float>(initial->h + 1) / static_cast<float>(h);
 		glyph->advance = advance;
 
-		fp->glyph_cache->insert(pair<uint16, FontGlyph*>(character, glyph));
-
-		SDL_FreeSurface(initial);
-		SDL_FreeSurface(intermediary);
+		fp->glyph_cache[character] = glyph;
 	}
 } // void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp)
 
 
 
-void TextSupervisor::_DrawTextHelper(const uint16* const text, FontProperties* fp, Color text_color) {
-	if (*text == 0) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "invalid argument, empty string" << endl;
-		return;
+void TextSupervisor::_PrewarmGlyphs(FontProperties* fp) {
+	// The printable ASCII characters, and the typographic quotes and ellipsis used by the translations
+	uint16 characters[256];
+	uint32 count = 0;
+	for (uint16 c = 0x20; c < 0x7F; ++c)
+		characters[count++] = c;
+	characters[count++] = 0x2018;
+	characters[count++] = 0x2019;
+	characters[count++] = 0x201C;
+	characters[count++] = 0x201D;
+	characters[count++] = 0x2026;
+
+	// The other languages also use the accented letters of the Latin-1 supplement
+	string language = hoa_system::SystemManager ? hoa_system::SystemManager->GetLanguage() : string();
+	if (language.empty() == false && language.compare(0, 2, "en") != 0) {
+		for (uint16 c = 0xA0; c <= 0xFF; ++c)
+			characters[count++] = c;
 	}
 
-	if (fp == NULL) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "invalid argument, NULL font properties" << endl;
-		return;
+	characters[count] = 0;
+	_CacheGlyphs(characters, fp);
+}
+
+
+
+void TextSupervisor::_ClearGlyphCache(FontProperties* fp) {
+	for (uint32 i = 0; i < fp->glyph_cache.size(); ++i) {
+		FontGlyph* glyph = fp->glyph_cache[i];
+		if (glyph == NULL)
+			continue;
+
+		glyph->texture->texture_sheet->RemoveTexture(glyph->texture);
+		delete glyph->texture;
+		delete glyph;
+		fp->glyph_cache[i] = NULL;
 	}
+}
 
-	glBlendFunc(GL_ONE, GL_ONE);
-	glEnable(GL_BLEND);
 
-	CoordSys& cs = VideoManager->_current_context.coordinate_system;
 
-	_CacheGlyphs(text, fp);
+bool TextSupervisor::_AddGlyphToSheet(FontProperties* fp, BaseTexture* texture, ImageMemory& data) {
+	for (uint32 i = 0; i < fp->glyph_sheets.size(); ++i) {
+		if (fp->glyph_sheets[i]->AddTexture(texture, data) == true)
+			return true;
+	}
+
+	// All of the font glyph sheets are full
+	TexSheet* sheet = TextureManager->_CreateTexSheet(GLYPH_SHEET_SIZE, GLYPH_SHEET_SIZE, VIDEO_TEXSHEET_GLYPHS, true);
+	if (sheet == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "could not create a new glyph sheet" << endl;
+		return false;
+	}
 
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_TEXTURE_2D);
-	glEnable(GL_ALPHA_TEST);
-	glAlphaFunc(GL_GREATER, 0.1f);
+	fp->glyph_sheets.push_back(sheet);
+	return sheet->AddTexture(texture, data);
+}
 
-	glPushMatrix();
 
-	int font_width, font_height;
-	if (TTF_SizeUNICODE(fp->ttf_font, text, &font_width, &font_height) != 0) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "call to TTF_SizeUNICODE() failed" << endl;
+
+void TextSupervisor::_DrawTextHelper(const TextLayoutLine& line, uint32 begin, uint32 end, FontProperties* fp, Color text_color) {
+	if (fp == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "invalid argument, NULL font properties" << endl;
 		return;
 	}
 
-	float xoff = ((VideoManager->_current_context.x_align + 1) * font_width) * 0.5f * -cs.GetHorizontalDirection();
-	float yoff = ((VideoManager->_current_context.y_align + 1) * font_height) * 0.5f * -cs.GetVerticalDirection();
+	CoordSys& cs = VideoManager->_current_context.coordinate_system;
+
+	VideoManager->PushMatrix();
+
+	float xoff = ((VideoManager->_current_context.x_align + 1) * line.width) * 0.5f * -cs.GetHorizontalDirection();
+	float yoff = ((VideoManager->_current_context.y_align + 1) * line.height) * 0.5f * -cs.GetVerticalDirection();
 
 	VideoManager->MoveRelative(xoff, yoff);
 
 	float modulation = VideoManager->_screen_fader.GetFadeModulation();
 	Color final_color = text_color * modulation;
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	// Build the quads of every glyph, and queue them each time the glyph sheet changes
+	_glyph_vertex_coords.clear();
+	_glyph_tex_coords.clear();
+	_glyph_colors.clear();
+	TexSheet* sheet = NULL;
 
-	GLint vertices[8];
-	GLfloat tex_coords[8];
-	glVertexPointer(2, GL_INT, 0, vertices);
-	glTexCoordPointer(2, GL_FLOAT, 0, tex_coords);
+	for (uint32 i = begin; i < end; ++i) {
+		FontGlyph* glyph_info = line.glyphs[i];
+		if (glyph_info == NULL)
+			continue;
 
-	// Iterate through each character in the string and render the character glyphs one at a time
-	int xpos = 0;
-	for (const uint16* glyph = text; *glyph != 0; glyph++) {
-		FontGlyph* glyph_info = (*fp->glyph_cache)[*glyph];
+		BaseTexture* texture = glyph_info->texture;
+		if (texture->texture_sheet != sheet && _glyph_colors.empty() == false) {
+			VideoManager->_sprite_batch.AddQuads(sheet, 1, true, VideoManager->_transform, _glyph_colors.size(),
+				&_glyph_vertex_coords[0], &_glyph_tex_coords[0], &_glyph_colors[0], Color::white);
+			_glyph_vertex_coords.clear();
+			_glyph_tex_coords.clear();
+			_glyph_colors.clear();
+		}
+		sheet = texture->texture_sheet;
 
-		int x_hi = glyph_info->width;
-		int y_hi = glyph_info->height;
+		int x_hi = texture->width;
+		int y_hi = texture->height;
 		if (cs.GetHorizontalDirection() < 0.0f)
 			x_hi = -x_hi;
 		if (cs.GetVerticalDirection() < 0.0f)
 			y_hi = -y_hi;
 
 		int min_x, min_y;
-		min_x = glyph_info->min_x * static_cast<int>(cs.GetHorizontalDirection()) + xpos;
+		min_x = glyph_info->min_x * static_cast<int>(cs.GetHorizontalDirection()) + line.positions[i];
 		min_y = glyph_info->min_y * static_cast<int>(cs.GetVerticalDirection());
 
-		float tx, ty;
-		tx = glyph_info->max_x;
-		ty = glyph_info->max_y;
+		float vertices[8] = {
+			static_cast<float>(min_x), static_cast<float>(min_y),
+			static_cast<float>(min_x + x_hi), static_cast<float>(min_y),
+			static_cast<float>(min_x + x_hi), static_cast<float>(min_y + y_hi),
+			static_cast<float>(min_x), static_cast<float>(min_y + y_hi)
+		};
+		float tex_coords[8] = {
+			texture->u1, texture->v2,
+			texture->u2, texture->v2,
+			texture->u2, texture->v1,
+			texture->u1, texture->v1
+		};
+		_glyph_vertex_coords.insert(_glyph_vertex_coords.end(), vertices, vertices + 8);
+		_glyph_tex_coords.insert(_glyph_tex_coords.end(), tex_coords, tex_coords + 8);
+		_glyph_colors.push_back(final_color);
+	} // for (uint32 i = begin; i < end; ++i)
+
+	if (_glyph_colors.empty() == false) {
+		VideoManager->_sprite_batch.AddQuads(sheet, 1, true, VideoManager->_transform, _glyph_colors.size(),
+			&_glyph_vertex_coords[0], &_glyph_tex_coords[0], &_glyph_colors[0], Color::white);
+	}
 
-		TextureManager->_BindTexture(glyph_info->texture);
-		if (VideoManager->CheckGLError()) {
-			IF_PRINT_WARNING(VIDEO_DEBUG) << "OpenGL error detected: " << VideoManager->CreateGLErrorString() << endl;
-			return;
+	VideoManager->PopMatrix();
+} // void TextSupervisor::_DrawTextHelper(const TextLayoutLine& line, uint32 begin, uint32 end, FontProperties* fp, Color text_color)
+
+
+
+const TextLayout* TextSupervisor::_GetTextLayout(const ustring& text, FontProperties* fp) {
+	std::pair<FontProperties*, uint32> key(fp, HashText(text));
+
+	TextLayoutMap::iterator recent = _text_layouts.find(key);
+	if (recent != _text_layouts.end() && recent->second->text == text)
+		return recent->second;
+
+	// A layout used before the recent ones is moved back with them
+	TextLayout* layout = NULL;
+	TextLayoutMap::iterator old = _old_text_layouts.find(key);
+	if (old != _old_text_layouts.end() && old->second->text == text) {
+		layout = old->second;
+		_old_text_layouts.erase(old);
+	}
+	else {
+		// Lay the text out, line after line
+		layout = new TextLayout();
+		layout->text = text;
+		layout->width = 0;
+		_CacheGlyphs(text.c_str(), fp);
+
+		const uint16 NEWLINE = '\n';
+		uint32 line_start = 0;
+		while (true) {
+			uint32 line_end = line_start;
+			while (line_end < text.length() && text[line_end] != NEWLINE)
+				++line_end;
+
+			layout->lines.push_back(TextLayoutLine());
+			TextLayoutLine& line = layout->lines.back();
+			line.first_char = line_start;
+			line.positions.push_back(0);
+			for (uint32 i = line_start; i < line_end; ++i) {
+				FontGlyph* glyph = fp->glyph_cache[text[i]];
+				line.glyphs.push_back(glyph);
+				line.positions.push_back(line.positions.back() + (glyph != NULL ? glyph->advance : 0));
+			}
+
+			ustring line_text = text.substr(line_start, line_end - line_start);
+			if (TTF_SizeUNICODE(fp->ttf_font, line_text.c_str(), &line.width, &line.height) != 0) {
+				IF_PRINT_WARNING(VIDEO_DEBUG) << "call to TTF_SizeUNICODE() failed with TTF error: " << TTF_GetError() << endl;
+				line.width = line.positions.back();
+				line.height = fp->height;
+			}
+			layout->width = std::max(layout->width, line.width);
+
+			if (line_end == text.length())
+				break;
+			line_start = line_end + 1;
 		}
+	}
+
+	// Once the recent layouts are too many, the older ones are dropped
+	if (_text_layouts.size() >= TEXT_LAYOUT_CACHE_SIZE) {
+		for (TextLayoutMap::iterator i = _old_text_layouts.begin(); i != _old_text_layouts.end(); ++i)
+			delete i->second;
+		_old_text_layouts.clear();
+		_old_text_layouts.swap(_text_layouts);
+		recent = _text_layouts.end();
+	}
 
-		vertices[0] = min_x;
-		vertices[1] = min_y;
-		vertices[2] = min_x + x_hi;
-		vertices[3] = min_y;
-		vertices[4] = min_x + x_hi;
-		vertices[5] = min_y + y_hi;
-		vertices[6] = min_x;
-		vertices[7] = min_y + y_hi;
-		tex_coords[0] = 0.0f;
-		tex_coords[1] = ty;
-		tex_coords[2] = tx;
-		tex_coords[3] = ty;
-		tex_coords[4] = tx;
-		tex_coords[5] = 0.0f;
-		tex_coords[6] = 0.0f;
-		tex_coords[7] = 0.0f;
+	// Another text with the same hash is replaced
+	if (recent != _text_layouts.end()) {
+		delete recent->second;
+		recent->second = layout;
+	}
+	else {
+		_text_layouts.insert(make_pair(key, layout));
+	}
+
+	return layout;
+} // const TextLayout* TextSupervisor::_GetTextLayout(const ustring& text, FontProperties* fp)
 
-		glColor4fv((GLfloat*)&final_color);
-		glDrawArrays(GL_QUADS, 0, 4);
 
-		xpos += glyph_info->advance;
-	} // for (const uint16* glyph = text; *glyph != 0; glyph++)
 
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glPopMatrix();
+void TextSupervisor::_ClearTextLayouts() {
+	for (TextLayoutMap::iterator i = _text_layouts.begin(); i != _text_layouts.end(); ++i)
+		delete i->second;
+	_text_layouts.clear();
 
-	glDisable(GL_ALPHA_TEST);
-} // void TextSupervisor::_DrawTextHelper(const uint16* const text, FontProperties* fp, Color color)
+	for (TextLayoutMap::iterator i = _old_text_layouts.begin(); i != _old_text_layouts.end(); ++i)
+		delete i->second;
+	_old_text_layouts.clear();
+}
 
 
 
 bool TextSupervisor::_RenderText(hoa_utils::ustring& string, TextStyle& style, ImageMemory& buffer) {
-	FontProperties* fp = _font_map[style.font];
-	TTF_Font* font = fp->ttf_font;
+	FontProperties* fp = GetFontProperties(style);
+	TTF_Font* font = (fp != NULL) ? fp->ttf_font : NULL;
 
 	if (font == NULL) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "font of TextStyle argument '" << style.font << "' was invalid" << endl;
@@ -990,7 +1228,9 @@ bool TextSupervisor::_RenderText(hoa_utils::ustring& string, TextStyle& style, I
 	// Calculate the width of the width and minimum y value of the text
 	const uint16* char_ptr;
 	for (char_ptr = string.c_str(); *char_ptr != '\0'; ++char_ptr) {
-		FontGlyph* glyphinfo = (*fp->glyph_cache)[*char_ptr];
+		FontGlyph* glyphinfo = fp->glyph_cache[*char_ptr];
+		if (glyphinfo == NULL)
+			continue;
 		if (glyphinfo->top_y < min_y)
 			min_y = glyphinfo->top_y;
 		calc_line_width += glyphinfo->advance;
@@ -1002,8 +1242,8 @@ bool TextSupervisor::_RenderText(hoa_utils::ustring& string, TextStyle& style, I
 	// Check if the first character starts left of pixel 0, and set
 // 	char_ptr = string.c_str();
 	if (*char_ptr) {
-		FontGlyph* first_glyphinfo = (*fp->glyph_cache)[*char_ptr];
-		if (first_glyphinfo->min_x < 0)
+		FontGlyph* first_glyphinfo = fp->glyph_cache[*char_ptr];
+		if (first_glyphinfo != NULL && first_glyphinfo->min_x < 0)
 			line_start_x = first_glyphinfo->min_x;
 	}
 
@@ -1029,7 +1269,9 @@ bool TextSupervisor::_RenderText(hoa_utils::ustring& string, TextStyle& style, I
 	int32 xpos = -line_start_x;
 	int32 ypos = -min_y;
 	for (char_ptr = string.c_str(); *char_ptr != '\0'; ++char_ptr) {
-		FontGlyph* glyphinfo = (*fp->glyph_cache)[*char_ptr];
+		FontGlyph* glyphinfo = fp->glyph_cache[*char_ptr];
+		if (glyphinfo == NULL)
+			continue;
 
 		// Render the glyph
 		initial = TTF_RenderGlyph_Blended(font, *char_ptr, white_color);
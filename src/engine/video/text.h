@@ -62,23 +62,31 @@ enum TEXT_SHADOW_STYLE {
 };
 
 
+//! \brief The number of characters of the Unicode Basic Multilingual Plane, i.e. the size of a font glyph table.
+const uint32 GLYPH_TABLE_SIZE = 0x10000;
+
+//! \brief The width and height of the texture sheets holding the glyphs of a font, in pixels.
+const int32 GLYPH_SHEET_SIZE = 512;
+
+//! \brief The number of text layouts cached before the least recently used ones are dropped, see TextSupervisor.
+const uint32 TEXT_LAYOUT_CACHE_SIZE = 256;
+
+//! \brief The handle of a font which isn't loaded, see TextSupervisor::GetFontHandle().
+const uint32 INVALID_FONT_HANDLE = 0xFFFFFFFF;
+
 /** ****************************************************************************
 *** \brief A structure to hold properties about a particular font glyph
 *** ***************************************************************************/
 class FontGlyph {
 public:
-	//! \brief The index of the GL texture for this glyph.
-	GLuint texture;
-
-	//! \brief The width and height of the glyph in pixels.
-	int32 width, height;
+	/** \brief The location of the glyph image in one of the glyph sheets of its font.
+	*** The width and height of the glyph in pixels are the ones of this texture.
+	**/
+	private_video::BaseTexture* texture;
 
 	//! \brief The mininum x and y pixel coordinates of the glyph in texture space (refer to TTF_GlyphMetrics).
 	int min_x, min_y;
 
-	//! \brief The maximum x and y pixel coordinates of the glyph in texture space (refer to TTF_GlyphMetrics).
-	float max_x, max_y;
-
 	//! \brief The amount of space between glyphs.
 	int32 advance;
 
@@ -89,6 +97,11 @@ public:
 
 /** ****************************************************************************
 *** \brief A structure which holds properties about fonts
+***
+*** The glyphs of a font are rendered once and stored in texture sheets of their
+*** own, so that a whole line of text is drawn from a single texture. The most
+*** used glyphs are cached when the font is loaded, the other ones are cached
+*** the first time they are drawn.
 *** ***************************************************************************/
 class FontProperties {
 public:
@@ -104,8 +117,16 @@ public:
 	//! \brief A pointer to SDL_TTF's font structure.
 	TTF_Font* ttf_font;
 
-	//! \brief A pointer to a cache which holds all of the glyphs used in this font.
-	std::map<uint16, FontGlyph*>* glyph_cache;
+	//! \brief The handle given to the font when it was loaded, see TextSupervisor::GetFontHandle().
+	uint32 handle;
+
+	/** \brief The glyphs cached for this font, indexed by character
+	*** This table is GLYPH_TABLE_SIZE long, and its entries are NULL for the characters not cached yet.
+	**/
+	std::vector<FontGlyph*> glyph_cache;
+
+	//! \brief The texture sheets holding the images of the cached glyphs.
+	std::vector<private_video::TexSheet*> glyph_sheets;
 }; // class FontProperties
 
 
@@ -116,6 +137,11 @@ public:
 *** default style. The various constructors for the TextStyle class will use the
 *** properties of the default text style when they are not provided with the
 *** information to initialize all of the class members.
+***
+*** The font of a style is interned into a handle when the style is made, so
+*** that drawing text in this style doesn't look the font up by its name. The
+*** styles drawn every frame are best made once and kept, rather than built
+*** from a font name at each draw.
 *** ***************************************************************************/
 class TextStyle {
 public:
@@ -146,11 +172,31 @@ public:
 	//! \brief Full constructor requiring initialization data arguments for all class members
 	TextStyle(std::string fnt, Color c, TEXT_SHADOW_STYLE style, int32 shadow_x, int32 shadow_y);
 
+	//! \brief Sets the font name and its handle
+	void SetFont(const std::string& fnt);
+
+	//! \brief Returns true if both styles draw text the same way
+	bool operator==(const TextStyle& style) const
+		{ return font == style.font && color == style.color && shadow_style == style.shadow_style
+			&& shadow_offset_x == style.shadow_offset_x && shadow_offset_y == style.shadow_offset_y; }
+
+	bool operator!=(const TextStyle& style) const
+		{ return !(*this == style); }
+
 	// ---------- Public members
 
 	//! \brief The string font name
 	std::string font;
 
+	/** \brief The handle of the font, or INVALID_FONT_HANDLE if the font wasn't loaded when it was set
+	*** The font must be changed with SetFont(), which sets its handle as well. When a font was loaded
+	*** or freed since, the font is looked up by its name once, and the handle is set again.
+	**/
+	mutable uint32 font_handle;
+
+	//! \brief The generation of the loaded fonts the handle was set with, see TextSupervisor::GetFontGeneration()
+	mutable uint32 font_generation;
+
 	//! \brief The color of the text
 	Color color;
 
@@ -163,6 +209,43 @@ public:
 
 namespace private_video {
 
+/** ****************************************************************************
+*** \brief A line of a text laid out in a font
+*** ***************************************************************************/
+class TextLayoutLine {
+public:
+	//! \brief The index of the first character of the line in the text
+	uint32 first_char;
+
+	//! \brief The glyph of each character of the line, NULL for the characters which could not be cached
+	std::vector<FontGlyph*> glyphs;
+
+	/** \brief The position of each glyph from the start of the line, in pixels
+	*** There is one more position than glyphs, the last one being the end of the line.
+	**/
+	std::vector<int32> positions;
+
+	//! \brief The width and height of the line as measured by SDL_ttf, used to align it
+	int32 width, height;
+}; // class TextLayoutLine
+
+
+/** ****************************************************************************
+*** \brief A text split into lines and laid out in a font, as cached by the TextSupervisor
+*** ***************************************************************************/
+class TextLayout {
+public:
+	//! \brief The text laid out, telling apart the texts whose hash is the same
+	hoa_utils::ustring text;
+
+	//! \brief The lines of the text, split at the newline characters
+	std::vector<TextLayoutLine> lines;
+
+	//! \brief The width of the widest line
+	int32 width;
+}; // class TextLayout
+
+
 /** ****************************************************************************
 *** \brief Represents an image of rendered text stored in a texture sheet
 ***
@@ -337,17 +420,25 @@ public:
 	void SetVertexColors(const Color &tl, const Color &tr, const Color &bl, const Color &br)
 		{ _color[0] = tl; _color[1] = tr; _color[2] = bl; _color[3] = br; }
 
-	//! \brief Sets the text contained
+	/** \brief Sets the text contained
+	*** The text is only rendered again when it changes, so that it can be set every frame.
+	**/
 	void SetText(const hoa_utils::ustring &string)
-		{ _string = string; _Regenerate(); }
+		{ if (string != _string) { _string = string; _Regenerate(); } }
 
 	//! \brief Sets the text (std::string version)
 	void SetText(const std::string &string)
-		{ SetText(hoa_utils::MakeUnicodeString(string)); _Regenerate(); }
+		{ SetText(hoa_utils::MakeUnicodeString(string)); }
 
-	//! \brief Sets the texts style - regenerating text if present.
+	/** \brief Sets the text to a number, such as hit points drawn every frame
+	*** The number is formatted without allocating memory, and the text is only rendered
+	*** again when the number changes.
+	**/
+	void SetNumber(int32 number);
+
+	//! \brief Sets the texts style - regenerating text if present and if the style changes.
 	void SetStyle(TextStyle style)
-		{ _style = style; _Regenerate(); }
+		{ if (style != _style) { _style = style; _Regenerate(); } }
 
 	//! \name Class Member Access Functions
 	//@{
@@ -387,6 +478,11 @@ private:
 *** \note When the API user needs to access methods of this class, the recommended
 *** way for doing so is to call "VideoManager->Text()->MethodName()".
 *** VideoManager->Text() returns the singleton pointer to this class.
+***
+*** \note The texts drawn and measured are laid out once, then their layout is
+*** cached, so that drawing the same text again doesn't call SDL_ttf nor allocate
+*** memory. The cache holds two generations of layouts: once the recent one is
+*** full, the older one is dropped and the recent one takes its place.
 *** ***************************************************************************/
 class TextSupervisor : public hoa_utils::Singleton<TextSupervisor> {
 	friend class hoa_utils::Singleton<TextSupervisor>;
@@ -436,6 +532,24 @@ public:
 	*** \return A pointer to the FontProperties object with the requested data, or NULL if the properties could not be fetched
 	**/
 	FontProperties* GetFontProperties(const std::string& font_name);
+
+	/** \brief Get the font properties for the font of a text style, through its font handle
+	*** \param style The text style whose font to get
+	*** \return A pointer to the FontProperties object of the font, or NULL if the font isn't loaded
+	**/
+	FontProperties* GetFontProperties(const TextStyle& style);
+
+	/** \brief Returns the handle of a font, a small integer given to it when it was loaded
+	*** \param font_name The reference name of the font
+	*** \return The font handle, or INVALID_FONT_HANDLE if the font isn't loaded
+	**/
+	uint32 GetFontHandle(const std::string& font_name) const;
+
+	/** \brief Returns a number changed every time a font is loaded or freed
+	*** The font handles kept in the text styles are only trusted for the generation they were set with.
+	**/
+	uint32 GetFontGeneration() const
+		{ return _font_generation; }
 	//@}
 
 	//! \name Text methods
@@ -450,7 +564,19 @@ public:
 	*** \param text The text string to draw in unicode format
 	*** \param style A reference to the TextStyle to use for drawing the string
 	**/
-	void Draw(const hoa_utils::ustring& text, const TextStyle& style);
+	void Draw(const hoa_utils::ustring& text, const TextStyle& style)
+		{ Draw(text, style, 0, text.length()); }
+
+	/** \brief Draws a part of a unicode string of text, at the position it has in the whole string
+	*** \param text The text string to draw in unicode format
+	*** \param style A reference to the TextStyle to use for drawing the string
+	*** \param first_char The index of the first character to draw
+	*** \param num_chars The number of characters to draw
+	***
+	*** The lines are aligned as when the whole string is drawn. This is used to draw a text
+	*** gradually, without creating new strings.
+	**/
+	void Draw(const hoa_utils::ustring& text, const TextStyle& style, uint32 first_char, uint32 num_chars);
 
 	/** \brief Renders and draws a standard string of text to the screen in the default text style
 	*** \param text The text string to draw in standard format
@@ -472,6 +598,22 @@ public:
 	**/
 	int32 CalculateTextWidth(const std::string& font_name, const hoa_utils::ustring& text);
 
+	/** \brief Calculates the width of the first characters of a unicode string of text
+	*** \param font_name The reference name of the font to use for the calculation
+	*** \param text The text string in unicode format
+	*** \param num_chars The number of characters to measure
+	*** \return The position where the next character would be drawn, or -1 if there was an error
+	*** \note For a text of several lines, the widest of their measured parts is returned.
+	**/
+	int32 CalculateTextWidth(const std::string& font_name, const hoa_utils::ustring& text, uint32 num_chars);
+
+	/** \brief Calculates the width of a unicode string of text in the font of a text style
+	*** \param style The text style whose font to use for the calculation
+	*** \param text The text string in unicode format
+	*** \return The width of the text as it would be rendered, or -1 if there was an error
+	**/
+	int32 CalculateTextWidth(const TextStyle& style, const hoa_utils::ustring& text);
+
 	/** \brief Calculates what the width would be for a standard string of text if it were rendered
 	*** \param font_name The reference name of the font to use for the calculation
 	*** \param text The text string in standard format
@@ -502,6 +644,32 @@ private:
 	**/
 	std::map<std::string, FontProperties*> _font_map;
 
+	//! \brief The properties of the loaded fonts, indexed by their font handle
+	std::vector<FontProperties*> _fonts;
+
+	//! \brief The generation of the loaded fonts, see GetFontGeneration()
+	uint32 _font_generation;
+
+	/** \brief The quads of the line of text being drawn, reused to avoid allocations
+	*** There are eight vertex and eight texture coordinates, and one color, per glyph.
+	**/
+	//@{
+	std::vector<float> _glyph_vertex_coords;
+	std::vector<float> _glyph_tex_coords;
+	std::vector<Color> _glyph_colors;
+	//@}
+
+	//! \brief The cached text layouts, keyed by their font and the hash of their text
+	typedef std::map<std::pair<FontProperties*, uint32>, private_video::TextLayout*> TextLayoutMap;
+
+	/** \brief The cached text layouts, recently used and older ones
+	*** The older layouts are moved back to the recent ones when they are used again.
+	**/
+	//@{
+	TextLayoutMap _text_layouts;
+	TextLayoutMap _old_text_layouts;
+	//@}
+
 	// ---------- Private methods
 
 	/** \brief Retrieves the color for a shadow based on the current text color and a shadow style
@@ -516,15 +684,49 @@ private:
 	**/
 	void _CacheGlyphs(const uint16* text, FontProperties* fp);
 
-	/** \brief Draws text to the screen using OpenGL commands
-	*** \param text A pointer to a unicode string holding the text to draw
+	/** \brief Caches the glyphs used by most of the text in the active language
+	*** \param fp A pointer to the FontProperties of the font to cache the glyphs for
+	***
+	*** This avoids rendering glyphs and updating the glyph sheets while text is being drawn.
+	**/
+	void _PrewarmGlyphs(FontProperties* fp);
+
+	/** \brief Removes all of the cached glyphs of a font from its glyph sheets
+	*** \param fp A pointer to the FontProperties of the font to clear the glyph cache of
+	*** \note The glyph sheets themselves are kept.
+	**/
+	void _ClearGlyphCache(FontProperties* fp);
+
+	/** \brief Adds the image of a glyph to one of the glyph sheets of a font, creating a new sheet if needed
+	*** \param fp A pointer to the FontProperties of the font the glyph belongs to
+	*** \param texture The glyph texture to place in a glyph sheet
+	*** \param data The pixel data of the glyph
+	*** \return True if the glyph was added successfully
+	**/
+	bool _AddGlyphToSheet(FontProperties* fp, private_video::BaseTexture* texture, private_video::ImageMemory& data);
+
+	/** \brief Queues the glyphs of a line of text in the video engine sprite batch
+	*** \param line The laid out line of text to draw
+	*** \param begin, end The range of glyphs of the line to draw
 	*** \param fp A pointer to the properties of the font to use in drawing the text
 	*** \param text_color The color to render the text in
 	***
 	*** This class assists the public Draw methods. This method is intended for drawing only
 	*** a single line of text in a single color (it does not account for shadows).
+	*** As all of the glyphs of a line usually lie in the same glyph sheet, the line and
+	*** its shadow are drawn with a single draw call.
 	**/
-	void _DrawTextHelper(const uint16* const text, FontProperties* fp, Color text_color);
+	void _DrawTextHelper(const private_video::TextLayoutLine& line, uint32 begin, uint32 end, FontProperties* fp, Color text_color);
+
+	/** \brief Returns the layout of a text in a font, laying the text out if it isn't cached
+	*** \param text The unicode text
+	*** \param fp A pointer to the properties of the font to lay the text out in
+	*** \return The text layout, which remains valid until the next call of this function
+	**/
+	const private_video::TextLayout* _GetTextLayout(const hoa_utils::ustring& text, FontProperties* fp);
+
+	//! \brief Deletes all of the cached text layouts
+	void _ClearTextLayouts();
 
 	/** \brief Renders a unicode string with a given TextStyle to a pixel array
 	*** \param string The unicdoe string to render
@@ -17,6 +17,9 @@
 
 #include "texture.h"
 
+#include <algorithm>
+#include <cstring>
+
 using namespace std;
 using namespace hoa_utils;
 
@@ -35,7 +38,8 @@ TexSheet::TexSheet(uint32 sheet_width, uint32 sheet_height, GLuint sheet_id, Tex
 	type(sheet_type),
 	is_static(sheet_static),
 	smoothed(false),
-	loaded(true)
+	loaded(true),
+	is_dedicated(false)
 {
 	Smooth();
 }
@@ -98,6 +102,8 @@ bool TexSheet::Reload() {
 
 
 bool TexSheet::CopyRect(int32 x, int32 y, ImageMemory& data) {
+	// The queued images must be drawn with the previous sheet content
+	VideoManager->FlushBatch();
 	TextureManager->_BindTexture(tex_id);
 
 	glTexSubImage2D(
@@ -123,6 +129,8 @@ bool TexSheet::CopyRect(int32 x, int32 y, ImageMemory& data) {
 
 
 bool TexSheet::CopyScreenRect(int32 x, int32 y, const ScreenRect& screen_rect) {
+	// The queued images must be on screen before copying it
+	VideoManager->FlushBatch();
 	TextureManager->_BindTexture(tex_id);
 
 	glCopyTexSubImage2D(
@@ -177,6 +185,8 @@ void TexSheet::DEBUG_Draw() const {
 		0.0f, 0.0f, // Upper left
 	};
 
+	VideoManager->FlushBatch();
+
 	// Enable texturing and bind the texture
 	glDisable(GL_BLEND);
 	glEnable(GL_TEXTURE_2D);
@@ -190,6 +200,7 @@ void TexSheet::DEBUG_Draw() const {
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glVertexPointer(2, GL_FLOAT, 0, vertex_coords);
 	glDrawArrays(GL_QUADS, 0, 4);
+	VideoManager->CountDrawCall();
 
 	if (VideoManager->CheckGLError() == true) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occurred: " << VideoManager->CreateGLErrorString() << endl;
@@ -379,6 +390,12 @@ uint32 FixedTexSheet::GetNumberTextures() {
 
 
 
+float FixedTexSheet::GetOccupancy() {
+	return static_cast<float>(GetNumberTextures() * _texture_width * _texture_height) / static_cast<float>(width * height);
+}
+
+
+
 int32 FixedTexSheet::_CalculateBlockIndex(BaseTexture* img) {
 	int32 block_x = img->x / _texture_width;
 	int32 block_y = img->y / _texture_height;
@@ -423,12 +440,21 @@ FixedTexNode* FixedTexSheet::_RemoveOpenNode() {
 // VariableTexSheet class
 // -----------------------------------------------------------------------------
 
+namespace {
+
+//! \brief Used to repack the tallest textures first, and then the widest ones
+bool CompareTextureSizes(const BaseTexture* first, const BaseTexture* second) {
+	if (first->height != second->height)
+		return first->height > second->height;
+	return first->width > second->width;
+}
+
+} // namespace
+
 VariableTexSheet::VariableTexSheet(int32 sheet_width, int32 sheet_height, GLuint sheet_id, TexSheetType sheet_type, bool sheet_static) :
 	TexSheet(sheet_width, sheet_height, sheet_id, sheet_type, sheet_static)
 {
-	_block_width = width / 16;
-	_block_height = height / 16;
-	_blocks = new VariableTexNode[_block_width * _block_height];
+	_packer.Reset(width, height);
 }
 
 
@@ -436,8 +462,6 @@ VariableTexSheet::VariableTexSheet(int32 sheet_width, int32 sheet_height, GLuint
 VariableTexSheet::~VariableTexSheet() {
 	if (GetNumberTextures() != 0)
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture sheet being deleted when it has a non-zero allocated texture count: " << GetNumberTextures() << endl;
-
-	delete[] _blocks;
 }
 
 
@@ -463,76 +487,26 @@ bool VariableTexSheet::InsertTexture(BaseTexture* img) {
 		return false;
 	}
 
-	// Don't allow insertions into a texture sheet containing a texture larger than 512x512.
-	// Texture sheets with this property may only be used by one texture at a time
-	if (_block_width > 32 || _block_height > 32) { // 32 blocks == 512 pixels
-		if (_blocks[0].free_image == false)
-			return false;
-	}
-
-	// Attempt to find an open region in the texture sheet to fit this texture
-	int32 block_x = -1, block_y = -1;
-	int32 w = (img->width + 15) / 16;
-	int32 h = (img->height + 15) / 16;
-
-	// This is a brute force algorithm to try and find space to allocate the texture.
-	// If this becomes a bottleneck, we may wish to use a more intellegent algorithm here.
-	bool continue_search = true;
-	for (int32 y = 0; y < _block_height - h + 1 && continue_search; y++) {
-		for (int32 x = 0; x < _block_width - w + 1; x++) {
-			int32 furthest_blocker = -1;
-
-			bool continue_neighbor_search = true;
-			for (int32 dy = 0; dy < h && continue_neighbor_search; dy++) {
-				for (int32 dx = 0; dx < w; dx++) {
-					if (_blocks[(x + dx) + ((y + dy) * _block_width)].free_image == false) {
-						furthest_blocker = x + dx;
-						continue_neighbor_search = false;
-						break;
-					}
-				}
-			}
-
-			if (furthest_blocker == -1) {
-				block_x = x;
-				block_y = y;
-				continue_search = false;
-				break;
-			}
-		}
-	}
-
-	// If either of these conditions is true, it means we were unable to allocate enough space to insert this texture
-	if (block_x == -1 || block_y == -1)
+	// Sheets dedicated to a single texture may not be shared
+	if (is_dedicated && _textures.empty() == false)
 		return false;
 
-	// Go through each block that is to be occupied by the new texture and set its properties
-	for (int32 y = block_y; y < block_y + h; y++) {
-		for (int32 x = block_x; x < block_x + w; x++) {
-			int32 index = x + (y * _block_width);
+	uint32 x = 0, y = 0;
+	if (_packer.Insert(img->width, img->height, x, y) == false) {
+		// The space of the freed textures is only taken back when nothing else is left
+		if (_freed_textures.empty())
+			return false;
 
-			// If the texture pointer for the block is not NULL, this means it contains a freed texture.
-			// Now we must remove that texture entirely since we are overwriting at least one of its blocks.
-			if (_blocks[index].image) {
-				RemoveTexture(_blocks[index].image);
-			}
+		while (_freed_textures.empty() == false)
+			RemoveTexture(*_freed_textures.begin());
 
-			_blocks[index].free_image = false;
-			_blocks[index].image = img;
-		}
+		if (_packer.Insert(img->width, img->height, x, y) == false)
+			return false;
 	}
 
-	// Calculate the pixel and uv coordinates for the newly inserted texture
-	img->x = block_x * 16;
-	img->y = block_y * 16;
-
-	float sheet_width = static_cast<float>(width);
-	float sheet_height = static_cast<float>(height);
-
-	img->u1 = static_cast<float>(img->x + 0.5f) / sheet_width;
-	img->u2 = static_cast<float>(img->x + img->width - 0.5f) / sheet_width;
-	img->v1 = static_cast<float>(img->y + 0.5f) / sheet_height;
-	img->v2 = static_cast<float>(img->y + img->height - 0.5f) / sheet_height;
+	img->x = x;
+	img->y = y;
+	_SetTextureCoordinates(img);
 
 	img->texture_sheet = this;
 	_textures.insert(img);
@@ -543,39 +517,152 @@ bool VariableTexSheet::InsertTexture(BaseTexture* img) {
 
 
 void VariableTexSheet::RemoveTexture(BaseTexture* img) {
-	_SetBlockProperties(img, NULL, true);
-	_textures.erase(img);
+	if (img == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL pointer was given as function argument" << endl;
+		return;
+	}
+
+	if (_textures.erase(img) == 0) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture pointer argument was not contained within this texture sheet" << endl;
+		return;
+	}
+
+	_freed_textures.erase(img);
+	_packer.Remove(img->x, img->y, img->width, img->height);
 }
 
 
 
-void VariableTexSheet::_SetBlockProperties(BaseTexture* tex, BaseTexture* new_tex, bool free) {
-	if (tex == NULL) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL pointer was given as function argument" << endl;
+void VariableTexSheet::FreeTexture(BaseTexture* img) {
+	if (_textures.find(img) == _textures.end()) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture pointer argument was not contained within this texture sheet" << endl;
 		return;
 	}
 
-	if (_textures.find(tex) == _textures.end()) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture pointer argument was not contained within this texture sheet" << endl;
+	_freed_textures.insert(img);
+}
+
+
+
+void VariableTexSheet::RestoreTexture(BaseTexture* img) {
+	_freed_textures.erase(img);
+}
+
+
+
+bool VariableTexSheet::IsFragmented() {
+	uint32 free_area = width * height - _packer.GetUsedArea();
+	return _packer.GetLargestFreeArea() * 2 < free_area;
+}
+
+
+
+bool VariableTexSheet::Repack() {
+	if (loaded == false || is_dedicated || _textures.empty())
+		return false;
+
+	// Place all the textures again, without changing anything yet in case they don't fit
+	vector<BaseTexture*> textures(_textures.begin(), _textures.end());
+	sort(textures.begin(), textures.end(), CompareTextureSizes);
+
+	RectanglePacker packer;
+	packer.Reset(width, height);
+	vector<uint32> new_x(textures.size());
+	vector<uint32> new_y(textures.size());
+	bool moved = false;
+	for (uint32 i = 0; i < textures.size(); ++i) {
+		if (packer.Insert(textures[i]->width, textures[i]->height, new_x[i], new_y[i]) == false) {
+			IF_PRINT_WARNING(VIDEO_DEBUG) << "the textures could not be placed again in the sheet" << endl;
+			return false;
+		}
+		if (new_x[i] != static_cast<uint32>(textures[i]->x) || new_y[i] != static_cast<uint32>(textures[i]->y))
+			moved = true;
 	}
 
-	// Calculate upper-left corner in blocks
-	int32 block_x = tex->x / 16;
-	int32 block_y = tex->y / 16;
+	if (moved == false)
+		return false;
 
-	// Calculate width and height in blocks
-	int32 w = (tex->width  + 15) / 16;
-	int32 h = (tex->height + 15) / 16;
+	// Move the pixels of each texture to their new place
+	ImageMemory old_pixels;
+	old_pixels.CopyFromTexture(this);
+	if (old_pixels.pixels == NULL)
+		return false;
 
-	for (int32 y = block_y; y < block_y + h; y++) {
-		for (int32 x = block_x; x < block_x + w; x++) {
-			int32 index = x + y * _block_width;
-			if (_blocks[index].image == tex) {
-				_blocks[index].free_image = free;
-				_blocks[index].image = new_tex;
-			}
+	ImageMemory new_pixels;
+	new_pixels.width = width;
+	new_pixels.height = height;
+	new_pixels.rgb_format = false;
+	new_pixels.pixels = calloc(width * height, 4);
+	if (new_pixels.pixels == NULL) {
+		PRINT_ERROR << "failed to malloc enough memory to repack the texture sheet" << endl;
+		free(old_pixels.pixels);
+		old_pixels.pixels = NULL;
+		return false;
+	}
+
+	uint32 pitch = width * 4;
+	for (uint32 i = 0; i < textures.size(); ++i) {
+		BaseTexture* img = textures[i];
+		uint32 row_bytes = img->width * 4;
+		for (uint32 row = 0; row < img->height; ++row) {
+			memcpy(static_cast<uint8*>(new_pixels.pixels) + (new_y[i] + row) * pitch + new_x[i] * 4,
+				static_cast<uint8*>(old_pixels.pixels) + (img->y + row) * pitch + img->x * 4, row_bytes);
 		}
 	}
+
+	bool success = CopyRect(0, 0, new_pixels);
+
+	free(old_pixels.pixels);
+	old_pixels.pixels = NULL;
+	free(new_pixels.pixels);
+	new_pixels.pixels = NULL;
+
+	if (success == false) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "call to CopyRect() failed" << endl;
+		return false;
+	}
+
+	for (uint32 i = 0; i < textures.size(); ++i) {
+		textures[i]->x = new_x[i];
+		textures[i]->y = new_y[i];
+		_SetTextureCoordinates(textures[i]);
+	}
+	_packer = packer;
+
+	return true;
+} // bool VariableTexSheet::Repack()
+
+
+
+bool VariableTexSheet::InsertTextureAt(BaseTexture* img, uint32 x, uint32 y) {
+	if (img == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL pointer was given as function argument" << endl;
+		return false;
+	}
+
+	if (_packer.Reserve(x, y, img->width, img->height) == false)
+		return false;
+
+	img->x = x;
+	img->y = y;
+	_SetTextureCoordinates(img);
+
+	img->texture_sheet = this;
+	_textures.insert(img);
+
+	return true;
+}
+
+
+
+void VariableTexSheet::_SetTextureCoordinates(BaseTexture* img) {
+	float sheet_width = static_cast<float>(width);
+	float sheet_height = static_cast<float>(height);
+
+	img->u1 = static_cast<float>(img->x + 0.5f) / sheet_width;
+	img->u2 = static_cast<float>(img->x + img->width - 0.5f) / sheet_width;
+	img->v1 = static_cast<float>(img->y + 0.5f) / sheet_height;
+	img->v2 = static_cast<float>(img->y + img->height - 0.5f) / sheet_height;
 }
 
 } // namespace private_video
@@ -32,10 +32,8 @@
 ***
 *** - <b>VariableTexSheet</b>: a texture sheet for variable-size textures.
 *** This sheet allows textures of any size to be inserted, but has slower
-*** performance than the FixedTexSheet.
-***
-*** - <b>VariableTexNode</b>: represents a texture node entry for the
-*** VariableTexSheet class.
+*** performance than the FixedTexSheet. The textures are placed by a
+*** RectanglePacker.
 *** ***************************************************************************/
 
 #ifndef __TEXTURE_HEADER__
@@ -43,6 +41,8 @@
 
 #include "utils.h"
 
+#include "rect_packer.h"
+
 #ifdef _VS
 	#include <GL/glew.h>
 #endif
@@ -78,8 +78,10 @@ enum TexSheetType {
 	VIDEO_TEXSHEET_32x64 = 1,
 	VIDEO_TEXSHEET_64x64 = 2,
 	VIDEO_TEXSHEET_ANY = 3,
+	//! \brief Holds the glyphs of a single font, see FontProperties
+	VIDEO_TEXSHEET_GLYPHS = 4,
 
-	VIDEO_TEXSHEET_TOTAL = 4
+	VIDEO_TEXSHEET_TOTAL = 5
 };
 
 
@@ -155,6 +157,9 @@ public:
 	//! \brief Returns the number of textures that are contained on this texture sheet
 	virtual uint32 GetNumberTextures() = 0;
 
+	//! \brief Returns the ratio of the sheet area used by its textures, between 0.0f and 1.0f
+	virtual float GetOccupancy() = 0;
+
 	/** \brief Unloads all texture memory used by OpenGL for this sheet
 	*** \return Success/failure
 	**/
@@ -224,6 +229,9 @@ public:
 	//! \brief Flag indicating if texture sheet is loaded or not
 	bool loaded;
 
+	//! \brief If true, the sheet was created for a single texture and is deleted along with it
+	bool is_dedicated;
+
 protected:
 	//! \brief The width and height of the sheet in number of texture blocks
 	int32 _block_width, _block_height;
@@ -305,6 +313,8 @@ public:
 	void RestoreTexture(BaseTexture* img);
 
 	uint32 GetNumberTextures();
+
+	float GetOccupancy();
 	//@}
 
 private:
@@ -341,30 +351,14 @@ private:
 }; // class FixedTexSheet : public TexSheet
 
 
-/** ****************************************************************************
-*** \brief Keeps track of which images are used/freed in the variable texture mem manager
-*** ***************************************************************************/
-class VariableTexNode {
-public:
-	VariableTexNode() :
-		image(NULL), free_image(true) {}
-
-	//! \brief A pointer to the image
-	BaseTexture* image;
-
-	//! \brief Set to true if the image is freed
-	bool free_image;
-}; // class VariableTexNode
-
-
 /** ****************************************************************************
 *** \brief Used to manage texture sheets of variable image sizes
 ***
-*** This class divides a texture sheet up into 16x16 pixel blocks, and keeps
-*** track of which images have allocated which blocks. This is done to reduce
-*** the time complexity for doing texture insertion and removal operations, but
-*** the downside is that it may leave some space in the texture sheet occupied
-*** but unused for images that are not divisible by 16 in width or height.
+*** The textures are placed at the pixel by a RectanglePacker, so that no space
+*** is lost around textures whose size is not a multiple of some block size.
+*** Removing textures leaves holes which new textures can only partly fill, so
+*** the sheet can be repacked: every texture is then placed again, from the
+*** tallest to the smallest, and its pixels are moved to its new place.
 *** ***************************************************************************/
 class VariableTexSheet : public TexSheet {
 public:
@@ -387,33 +381,53 @@ public:
 
 	void RemoveTexture(BaseTexture* img);
 
-	void FreeTexture(BaseTexture* img)
-		{ _SetBlockProperties(img, img, true); }
+	void FreeTexture(BaseTexture* img);
 
-	void RestoreTexture(BaseTexture* img)
-		{ _SetBlockProperties(img, img, false); }
+	void RestoreTexture(BaseTexture* img);
 
 	uint32 GetNumberTextures()
 		{ return _textures.size(); }
+
+	float GetOccupancy()
+		{ return _packer.GetOccupancy(); }
 	//@}
 
-private:
-	/** \brief The list of 16x16 pixel blocks in the sheet.
-	*** The size of this structure is: (width / 16) * (height / 16)
+	/** \brief Tells whether the free space of the sheet is split into many small areas
+	*** This is the case when the biggest texture which could still be inserted is
+	*** less than half as big as the total free space.
+	**/
+	bool IsFragmented();
+
+	/** \brief Places all the textures of the sheet again, so that their free space is merged
+	*** \return False if the sheet was left untouched, either because it could not be read
+	*** back or because its textures could not be placed again
+	***
+	*** The sheet pixels are read back from OpenGL and moved along with their texture.
+	*** \note The texture coordinates of the moved textures change, so any copy of them
+	*** made outside of the textures themselves must be updated.
 	**/
-	VariableTexNode* _blocks;
+	bool Repack();
+
+	/** \brief Inserts a texture at a given place, whose pixels are already in the sheet
+	*** This is used for the textures of the prebuilt atlases, see TextureController::LoadAtlas().
+	*** \return False if the place is outside of the sheet or used by another texture
+	**/
+	bool InsertTextureAt(BaseTexture* img, uint32 x, uint32 y);
+
+private:
+	//! \brief Places the textures in the sheet
+	RectanglePacker _packer;
 
 	/** \brief A set containing each texture that has been inserted into this class
 	*** This container is used to be able to quickly determine if a texture is loaded by an object of this class
 	**/
 	std::set<BaseTexture*> _textures;
 
-	/** \brief Updates the properties of all of the blocks associated with a given texture
-	*** \param tex The texture to update
-	*** \param new_tex The texture pointer to set the block to
-	*** \param new_image The boolean value to set the free status flag to
-	**/
-	void _SetBlockProperties(BaseTexture* tex, BaseTexture* new_tex, bool free);
+	//! \brief The textures marked as free, whose space is given to new textures when the sheet is full
+	std::set<BaseTexture*> _freed_textures;
+
+	//! \brief Sets the texture coordinates of a texture from its position in the sheet
+	void _SetTextureCoordinates(BaseTexture* img);
 }; // class VariableTexSheet : public TexSheet
 
 }  // namespace private_video
@@ -0,0 +1,239 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   texture_atlas.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Source file for the prebuilt texture atlas files
+*** **************************************************************************/
+
+#include "texture_atlas.h"
+
+#include <zlib.h>
+
+#include <fstream>
+#include <sys/stat.h>
+
+using namespace std;
+using namespace hoa_utils;
+
+namespace hoa_video {
+
+namespace private_video {
+
+namespace {
+
+//! \brief The first value of an atlas file, "VTAT"
+const uint32 TEXTURE_ATLAS_MAGIC = 0x56544154;
+
+//! \brief Changed whenever the layout of the atlas files changes
+const uint32 TEXTURE_ATLAS_VERSION = 2;
+
+//! \brief The ways the atlas pixels may be stored
+enum TEXTURE_ATLAS_COMPRESSION {
+	TEXTURE_ATLAS_RAW = 0,
+	TEXTURE_ATLAS_ZLIB = 1
+};
+
+//! \brief The size of the biggest atlas accepted, to reject corrupted files before allocating their pixels
+const uint32 TEXTURE_ATLAS_MAX_SIZE = 16384;
+
+
+
+bool ReadUInt32(ifstream& file, uint32& value) {
+	return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+
+
+bool ReadString(ifstream& file, std::string& value) {
+	uint32 length = 0;
+	if (!ReadUInt32(file, length) || length > 4096)
+		return false;
+
+	value.assign(length, '\0');
+	return length == 0 || (bool)file.read(&value[0], length);
+}
+
+
+
+void WriteUInt32(ofstream& file, uint32 value) {
+	file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+
+void WriteString(ofstream& file, const std::string& value) {
+	WriteUInt32(file, value.size());
+	file.write(value.data(), value.size());
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// TextureAtlasStamp class
+// -----------------------------------------------------------------------------
+
+bool TextureAtlasStamp::Read(const std::string& filename) {
+	struct stat file_info;
+	if (stat(filename.c_str(), &file_info) != 0)
+		return false;
+
+	modification_time = static_cast<uint32>(file_info.st_mtime);
+	size = static_cast<uint32>(file_info.st_size);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// TextureAtlasFile class
+// -----------------------------------------------------------------------------
+
+bool TextureAtlasFile::Read(const std::string& filename) {
+	ifstream file(filename.c_str(), ios::in | ios::binary);
+	if (!file)
+		return false;
+
+	// Magic, format version, width, height, compression, stored pixels size, number of entries and of multi images
+	uint32 header[8];
+	if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+		PRINT_WARNING << "truncated texture atlas file: " << filename << endl;
+		return false;
+	}
+
+	if (header[0] != TEXTURE_ATLAS_MAGIC || header[1] != TEXTURE_ATLAS_VERSION) {
+		PRINT_WARNING << "invalid or outdated texture atlas file: " << filename << endl;
+		return false;
+	}
+
+	width = header[2];
+	height = header[3];
+	uint32 compression = header[4];
+	uint32 stored_size = header[5];
+	if (width == 0 || height == 0 || width > TEXTURE_ATLAS_MAX_SIZE || height > TEXTURE_ATLAS_MAX_SIZE
+			|| (compression != TEXTURE_ATLAS_RAW && compression != TEXTURE_ATLAS_ZLIB)) {
+		PRINT_WARNING << "invalid texture atlas header in file: " << filename << endl;
+		return false;
+	}
+
+	entries.resize(header[6]);
+	for (uint32 i = 0; i < entries.size(); ++i) {
+		TextureAtlasEntry& entry = entries[i];
+		if (!ReadString(file, entry.filename) || !ReadString(file, entry.tags)
+				|| !ReadUInt32(file, entry.stamp.modification_time) || !ReadUInt32(file, entry.stamp.size) || !ReadUInt32(file, entry.x)
+				|| !ReadUInt32(file, entry.y) || !ReadUInt32(file, entry.width) || !ReadUInt32(file, entry.height)
+				|| entry.x + entry.width > width || entry.y + entry.height > height) {
+			PRINT_WARNING << "invalid texture atlas entry " << i << " in file: " << filename << endl;
+			return false;
+		}
+	}
+
+	multi_images.resize(header[7]);
+	for (uint32 i = 0; i < multi_images.size(); ++i) {
+		TextureAtlasMultiImage& multi_image = multi_images[i];
+		if (!ReadString(file, multi_image.filename) || !ReadUInt32(file, multi_image.rows)
+				|| !ReadUInt32(file, multi_image.cols) || !ReadUInt32(file, multi_image.first_entry)
+				|| multi_image.first_entry + multi_image.rows * multi_image.cols > entries.size()) {
+			PRINT_WARNING << "invalid texture atlas multi image " << i << " in file: " << filename << endl;
+			return false;
+		}
+	}
+
+	uint32 pixels_size = width * height * 4;
+	std::vector<uint8> stored_pixels(stored_size);
+	if (stored_size == 0 || !file.read(reinterpret_cast<char*>(&stored_pixels[0]), stored_size)) {
+		PRINT_WARNING << "truncated texture atlas pixels in file: " << filename << endl;
+		return false;
+	}
+
+	if (compression == TEXTURE_ATLAS_RAW) {
+		if (stored_size != pixels_size) {
+			PRINT_WARNING << "invalid texture atlas pixels size in file: " << filename << endl;
+			return false;
+		}
+		pixels.swap(stored_pixels);
+	}
+	else {
+		pixels.resize(pixels_size);
+		uLongf uncompressed_size = pixels_size;
+		if (uncompress(&pixels[0], &uncompressed_size, &stored_pixels[0], stored_size) != Z_OK
+				|| uncompressed_size != pixels_size) {
+			PRINT_WARNING << "could not uncompress the texture atlas pixels in file: " << filename << endl;
+			return false;
+		}
+	}
+
+	return true;
+} // bool TextureAtlasFile::Read(const std::string& filename)
+
+
+
+bool TextureAtlasFile::Write(const std::string& filename, bool compress) const {
+	if (pixels.size() != width * height * 4) {
+		PRINT_WARNING << "the atlas pixels don't match its size" << endl;
+		return false;
+	}
+
+	std::vector<uint8> compressed_pixels;
+	const std::vector<uint8>* stored_pixels = &pixels;
+	if (compress) {
+		uLongf compressed_size = compressBound(pixels.size());
+		compressed_pixels.resize(compressed_size);
+		if (compress2(&compressed_pixels[0], &compressed_size, &pixels[0], pixels.size(), Z_BEST_COMPRESSION) != Z_OK) {
+			PRINT_WARNING << "could not compress the atlas pixels" << endl;
+			return false;
+		}
+		compressed_pixels.resize(compressed_size);
+		stored_pixels = &compressed_pixels;
+	}
+
+	ofstream file(filename.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!file) {
+		PRINT_WARNING << "could not create the texture atlas file: " << filename << endl;
+		return false;
+	}
+
+	uint32 header[8] = { TEXTURE_ATLAS_MAGIC, TEXTURE_ATLAS_VERSION, width, height,
+		compress ? TEXTURE_ATLAS_ZLIB : TEXTURE_ATLAS_RAW, static_cast<uint32>(stored_pixels->size()),
+		static_cast<uint32>(entries.size()), static_cast<uint32>(multi_images.size()) };
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	for (uint32 i = 0; i < entries.size(); ++i) {
+		WriteString(file, entries[i].filename);
+		WriteString(file, entries[i].tags);
+		WriteUInt32(file, entries[i].stamp.modification_time);
+		WriteUInt32(file, entries[i].stamp.size);
+		WriteUInt32(file, entries[i].x);
+		WriteUInt32(file, entries[i].y);
+		WriteUInt32(file, entries[i].width);
+		WriteUInt32(file, entries[i].height);
+	}
+
+	for (uint32 i = 0; i < multi_images.size(); ++i) {
+		WriteString(file, multi_images[i].filename);
+		WriteUInt32(file, multi_images[i].rows);
+		WriteUInt32(file, multi_images[i].cols);
+		WriteUInt32(file, multi_images[i].first_entry);
+	}
+
+	file.write(reinterpret_cast<const char*>(&(*stored_pixels)[0]), stored_pixels->size());
+	file.close();
+
+	// Don't leave a truncated file behind
+	if (!file) {
+		PRINT_WARNING << "could not write the texture atlas file: " << filename << endl;
+		DeleteFile(filename);
+		return false;
+	}
+	return true;
+} // bool TextureAtlasFile::Write(const std::string& filename, bool compress) const
+
+} // namespace private_video
+
+} // namespace hoa_video
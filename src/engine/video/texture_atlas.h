@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   texture_atlas.h
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Header file for the prebuilt texture atlas files
+***
+*** A texture atlas file holds the pixels of many images already packed in a
+*** single texture sheet, and the place of each image in it. The atlases are
+*** made by the vt-atlas-baker tool from the image files listed in a manifest,
+*** and are loaded by TextureController::LoadAtlas(), which creates all their
+*** image textures with a single upload and without decoding any image file.
+***
+*** The file layout is: a header of uint32 values (magic, format version,
+*** sheet width and height, compression, size of the stored pixels, number
+*** of entries and of multi images), the entries with the stamp of their
+*** source image file, the multi images, and the
+*** RGBA pixels of the sheet, compressed with zlib or not. The values are
+*** stored in the byte order of the machine which baked the file; a file
+*** baked with another byte order is rejected by its magic number.
+*** **************************************************************************/
+
+#ifndef __TEXTURE_ATLAS_HEADER__
+#define __TEXTURE_ATLAS_HEADER__
+
+#include "defs.h"
+#include "utils.h"
+
+#include <vector>
+
+namespace hoa_video {
+
+namespace private_video {
+
+//! \brief The file name extension of the texture atlas files
+const std::string TEXTURE_ATLAS_EXTENSION = ".vta";
+
+/** \brief The modification time and size of an image file, as when it was baked
+*** An atlas entry whose image file has another stamp is outdated, and the image
+*** is then loaded from its file.
+**/
+class TextureAtlasStamp {
+public:
+	TextureAtlasStamp() :
+		modification_time(0), size(0) {}
+
+	/** \brief Gets the current stamp of a file
+	*** \return False if the file couldn't be examined
+	**/
+	bool Read(const std::string& filename);
+
+	bool operator==(const TextureAtlasStamp& other) const
+		{ return (modification_time == other.modification_time && size == other.size); }
+
+	bool operator!=(const TextureAtlasStamp& other) const
+		{ return !(*this == other); }
+
+	uint32 modification_time;
+
+	uint32 size;
+}; // class TextureAtlasStamp
+
+
+//! \brief An image stored in a texture atlas
+class TextureAtlasEntry {
+public:
+	TextureAtlasEntry() :
+		x(0), y(0), width(0), height(0) {}
+
+	//! \brief The image file name and tags, as used to register the image texture
+	std::string filename;
+	std::string tags;
+
+	//! \brief The stamp of the image file when the atlas was baked
+	TextureAtlasStamp stamp;
+
+	//! \brief The place of the image in the atlas, in pixels
+	uint32 x, y, width, height;
+}; // class TextureAtlasEntry
+
+
+/** \brief A multi image stored in a texture atlas
+*** Its elements are consecutive entries, in the order used by ImageDescriptor::LoadMultiImageFromElementGrid().
+**/
+class TextureAtlasMultiImage {
+public:
+	TextureAtlasMultiImage() :
+		rows(0), cols(0), first_entry(0) {}
+
+	std::string filename;
+
+	uint32 rows, cols;
+
+	//! \brief The index of the entry of the first element
+	uint32 first_entry;
+}; // class TextureAtlasMultiImage
+
+
+/** ****************************************************************************
+*** \brief The content of a texture atlas file
+***
+*** This class doesn't use the video engine, so that it can be used by the
+*** atlas baking tool as well.
+*** ***************************************************************************/
+class TextureAtlasFile {
+public:
+	TextureAtlasFile() :
+		width(0), height(0) {}
+
+	/** \brief Reads an atlas file
+	*** \param filename The name of the file to read
+	*** \return False if the file could not be read or is invalid, in which case the content is undefined
+	**/
+	bool Read(const std::string& filename);
+
+	/** \brief Writes an atlas file
+	*** \param filename The name of the file to write
+	*** \param compress Whether the pixels should be compressed with zlib
+	*** \return False if the file could not be written
+	**/
+	bool Write(const std::string& filename, bool compress) const;
+
+	//! \brief Returns the entry of the image element of a multi image
+	const TextureAtlasEntry& GetElement(const TextureAtlasMultiImage& multi_image, uint32 row, uint32 col) const
+		{ return entries[multi_image.first_entry + row * multi_image.cols + col]; }
+
+	//! \brief The width and height of the atlas, in pixels
+	uint32 width, height;
+
+	std::vector<TextureAtlasEntry> entries;
+
+	std::vector<TextureAtlasMultiImage> multi_images;
+
+	//! \brief The RGBA pixels of the atlas, row by row from the top
+	std::vector<uint8> pixels;
+}; // class TextureAtlasFile
+
+} // namespace private_video
+
+} // namespace hoa_video
+
+#endif // __TEXTURE_ATLAS_HEADER__
@@ -17,6 +17,8 @@
 
 #include "texture_controller.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace hoa_utils;
 using namespace hoa_video::private_video;
@@ -29,15 +31,40 @@ TextureController* TextureManager = NULL;
 
 
 
+//! \brief The time the prefetching thread sleeps when there is no image to decode, in milliseconds
+const uint32 PREFETCH_THREAD_DELAY = 10;
+
 TextureController::TextureController() :
 	debug_current_sheet(-1),
 	_last_tex_id(INVALID_TEXTURE_ID),
-	_debug_num_tex_switches(0)
+	_debug_num_tex_switches(0),
+	_tex_sheet_size(DEFAULT_TEXSHEET_SIZE),
+	_max_tex_sheet_size(0),
+	_tex_sheet_layout_version(0),
+	_prefetch_thread(NULL),
+	_prefetch_semaphore(NULL),
+	_prefetch_thread_running(false)
 {}
 
 
 
 TextureController::~TextureController() {
+	if (_prefetch_thread != NULL) {
+		_prefetch_thread_running = false;
+		hoa_system::SystemManager->WaitForThread(_prefetch_thread);
+		_prefetch_thread = NULL;
+	}
+	ClearPrefetchedImages();
+	if (_prefetch_semaphore != NULL) {
+		hoa_system::SystemManager->DestroySemaphore(_prefetch_semaphore);
+		_prefetch_semaphore = NULL;
+	}
+
+	// The atlas textures are deleted along with the other ones below
+	for (map<string, LoadedTextureAtlas*>::iterator i = _atlases.begin(); i != _atlases.end(); ++i)
+		delete i->second;
+	_atlases.clear();
+
 	IF_PRINT_DEBUG(VIDEO_DEBUG) << "Deleting all remaining ImageTextures, a total of: " << _images.size() << endl;
 
 	// Invoking the ImageTexture destructor will erase the entry in the _images map that corresponds to that object
@@ -57,28 +84,48 @@ TextureController::~TextureController() {
 
 
 bool TextureController::SingletonInitialize() {
+	// The shared texture sheets may not be bigger than what the video card supports
+	GLint max_size = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+	if (max_size > 0)
+		_max_tex_sheet_size = static_cast<uint32>(max_size);
+	SetTexSheetSize(_tex_sheet_size);
+
 	// Create a default set of texture sheets
-	if (_CreateTexSheet(512, 512, VIDEO_TEXSHEET_32x32, false) == NULL) {
+	if (_CreateTexSheet(_tex_sheet_size, _tex_sheet_size, VIDEO_TEXSHEET_32x32, false) == NULL) {
 		PRINT_ERROR << "could not create default 32x32 texture sheet" << endl;
 		return false;
 	}
-	if (_CreateTexSheet(512, 512, VIDEO_TEXSHEET_32x64, false) == NULL) {
+	if (_CreateTexSheet(_tex_sheet_size, _tex_sheet_size, VIDEO_TEXSHEET_32x64, false) == NULL) {
 		PRINT_ERROR << "could not create default 32x64 texture sheet" << endl;
 		return false;
 	}
-	if (_CreateTexSheet(512, 512, VIDEO_TEXSHEET_64x64, false) == NULL) {
+	if (_CreateTexSheet(_tex_sheet_size, _tex_sheet_size, VIDEO_TEXSHEET_64x64, false) == NULL) {
 		PRINT_ERROR << "could not create default 64x64 texture sheet" << endl;
 		return false;
 	}
-	if (_CreateTexSheet(512, 512, VIDEO_TEXSHEET_ANY, true) == NULL) {
+	if (_CreateTexSheet(_tex_sheet_size, _tex_sheet_size, VIDEO_TEXSHEET_ANY, true) == NULL) {
 		PRINT_ERROR << "could not create default static variable sized texture sheet" << endl;
 		return false;
 	}
-	if (_CreateTexSheet(512, 512, VIDEO_TEXSHEET_ANY, false) == NULL) {
+	if (_CreateTexSheet(_tex_sheet_size, _tex_sheet_size, VIDEO_TEXSHEET_ANY, false) == NULL) {
 		PRINT_ERROR << "could not create default variable sized tex sheet" << endl;
 		return false;
 	}
 
+	// Start the image prefetching thread. Without it, PrefetchImages() does nothing.
+	_prefetch_semaphore = hoa_system::SystemManager->CreateSemaphore(1);
+#if (THREAD_TYPE == SDL_THREADS)
+	if (_prefetch_semaphore != NULL) {
+		_prefetch_thread_running = true;
+		_prefetch_thread = hoa_system::SystemManager->SpawnThread(&TextureController::_PrefetchThread, this);
+		if (_prefetch_thread == NULL) {
+			IF_PRINT_WARNING(VIDEO_DEBUG) << "could not create the image prefetching thread" << endl;
+			_prefetch_thread_running = false;
+		}
+	}
+#endif
+
 	return true;
 }
 
@@ -112,22 +159,13 @@ bool TextureController::UnloadTextures() {
 		i++;
 	}
 
-	// Clear all font caches
+	// Clear all font caches, and the text layouts referring to their glyphs. The glyph sheets are reloaded empty along with the other sheets.
 	map<string, FontProperties*>::iterator j = TextManager->_font_map.begin();
 	while (j != TextManager->_font_map.end()) {
-		FontProperties *fp = j->second;
-
-		if (fp->glyph_cache) {
-			for (map<uint16, FontGlyph*>::iterator k = fp->glyph_cache->begin(); k != fp->glyph_cache->end(); k++) {
-				_DeleteTexture((*k).second->texture);
-				delete (*k).second;
-			}
-
-			fp->glyph_cache->clear();
-		}
-
+		TextManager->_ClearGlyphCache(j->second);
 		j++;
 	}
+	TextManager->_ClearTextLayouts();
 
 	return success;
 } // bool TextureController::UnloadTextures()
@@ -155,11 +193,252 @@ bool TextureController::ReloadTextures() {
 
 	_DeleteTempTextures();
 
+	// Cache the most used glyphs again
+	map<string, FontProperties*>::iterator j = TextManager->_font_map.begin();
+	while (j != TextManager->_font_map.end()) {
+		TextManager->_PrewarmGlyphs(j->second);
+		j++;
+	}
+
 	return success;
 }
 
 
 
+void TextureController::PrefetchImages(const std::vector<std::string>& filenames) {
+	if (_prefetch_thread == NULL)
+		return;
+
+	hoa_system::SystemManager->LockThread(_prefetch_semaphore);
+	for (uint32 i = 0; i < filenames.size(); ++i) {
+		const std::string& filename = filenames[i];
+
+		// Skip the images already in texture memory, decoded, or about to be
+		if (_IsImageTextureRegistered(filename) || _prefetched_images.find(filename) != _prefetched_images.end()
+				|| filename == _prefetch_current
+				|| std::find(_prefetch_queue.begin(), _prefetch_queue.end(), filename) != _prefetch_queue.end())
+			continue;
+
+		_prefetch_queue.push_back(filename);
+	}
+	hoa_system::SystemManager->UnlockThread(_prefetch_semaphore);
+}
+
+
+
+void TextureController::ClearPrefetchedImages() {
+	if (_prefetch_semaphore != NULL)
+		hoa_system::SystemManager->LockThread(_prefetch_semaphore);
+
+	_prefetch_queue.clear();
+	for (std::map<std::string, ImageMemory*>::iterator i = _prefetched_images.begin(); i != _prefetched_images.end(); ++i) {
+		free(i->second->pixels);
+		i->second->pixels = NULL;
+		delete i->second;
+	}
+	_prefetched_images.clear();
+
+	if (_prefetch_semaphore != NULL)
+		hoa_system::SystemManager->UnlockThread(_prefetch_semaphore);
+}
+
+
+
+void TextureController::SetTexSheetSize(uint32 size) {
+	// The fixed size sheets must be able to hold at least one 64x64 image
+	if (size < 64)
+		size = 64;
+	size = RoundUpPow2(size);
+	if (_max_tex_sheet_size != 0 && size > _max_tex_sheet_size) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture sheet size " << size << " limited to the maximum texture size: " << _max_tex_sheet_size << endl;
+		size = _max_tex_sheet_size;
+	}
+	_tex_sheet_size = size;
+}
+
+
+
+void TextureController::DefragmentTexSheets() {
+	// Only one empty sheet of each kind is kept
+	bool empty_sheet_kept[2] = { false, false };
+
+	vector<TexSheet*>::iterator it = _tex_sheets.begin();
+	while (it != _tex_sheets.end()) {
+		VariableTexSheet* sheet = dynamic_cast<VariableTexSheet*>(*it);
+		if (sheet == NULL || sheet->type != VIDEO_TEXSHEET_ANY || sheet->is_dedicated) {
+			++it;
+			continue;
+		}
+
+		if (sheet->GetNumberTextures() == 0) {
+			if (empty_sheet_kept[sheet->is_static] == true) {
+				delete sheet;
+				it = _tex_sheets.erase(it);
+				continue;
+			}
+			empty_sheet_kept[sheet->is_static] = true;
+		}
+		else if (sheet->IsFragmented()) {
+			_RepackTexSheet(sheet);
+		}
+		++it;
+	}
+
+	if (VIDEO_DEBUG)
+		DEBUG_PrintTexSheetOccupancy();
+}
+
+
+
+float TextureController::GetTexSheetOccupancy() const {
+	float used_area = 0.0f;
+	float total_area = 0.0f;
+	for (vector<TexSheet*>::const_iterator it = _tex_sheets.begin(); it != _tex_sheets.end(); ++it) {
+		TexSheet* sheet = *it;
+		if (sheet->type != VIDEO_TEXSHEET_ANY || sheet->is_dedicated || sheet->GetNumberTextures() == 0)
+			continue;
+
+		float area = static_cast<float>(sheet->width) * static_cast<float>(sheet->height);
+		used_area += sheet->GetOccupancy() * area;
+		total_area += area;
+	}
+
+	if (total_area == 0.0f)
+		return 1.0f;
+	return used_area / total_area;
+}
+
+
+
+bool TextureController::LoadAtlas(const std::string& filename) {
+	map<string, LoadedTextureAtlas*>::iterator it = _atlases.find(filename);
+	if (it != _atlases.end()) {
+		it->second->reference_count++;
+		return true;
+	}
+
+	// Atlases are optional, the images are then loaded from their own file
+	if (DoesFileExist(filename) == false)
+		return false;
+
+	TextureAtlasFile atlas_file;
+	if (atlas_file.Read(filename) == false) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "could not read the texture atlas file: " << filename << endl;
+		return false;
+	}
+
+	if (_max_tex_sheet_size != 0 && (atlas_file.width > _max_tex_sheet_size || atlas_file.height > _max_tex_sheet_size)) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture atlas bigger than the maximum texture size: " << filename << endl;
+		return false;
+	}
+
+	TexSheet* sheet = _CreateTexSheet(atlas_file.width, atlas_file.height, VIDEO_TEXSHEET_ANY, true);
+	if (sheet == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "could not create the texture sheet of the atlas: " << filename << endl;
+		return false;
+	}
+	// No other image may be inserted in the atlas sheet
+	sheet->is_dedicated = true;
+
+	if (_UploadAtlas(atlas_file, sheet) == false) {
+		_RemoveSheet(sheet);
+		return false;
+	}
+
+	LoadedTextureAtlas* atlas = new LoadedTextureAtlas();
+	atlas->sheet = sheet;
+	atlas->reference_count = 1;
+	atlas->textures.resize(atlas_file.entries.size(), NULL);
+
+	// The entries whose image file changed since the atlas was baked are left out
+	std::vector<bool> outdated(atlas_file.entries.size(), false);
+	TextureAtlasStamp stamp;
+	for (uint32 i = 0; i < atlas_file.entries.size(); ++i) {
+		const TextureAtlasEntry& entry = atlas_file.entries[i];
+		// The elements of a multi image share its file
+		if (i == 0 || entry.filename != atlas_file.entries[i - 1].filename) {
+			if (stamp.Read(entry.filename) == false)
+				stamp = TextureAtlasStamp();
+		}
+		if (stamp != entry.stamp) {
+			IF_PRINT_WARNING(VIDEO_DEBUG) << "outdated entry in texture atlas " << filename << ": " << entry.filename << endl;
+			outdated[i] = true;
+		}
+	}
+
+	VariableTexSheet* atlas_sheet = static_cast<VariableTexSheet*>(sheet);
+	for (uint32 i = 0; i < atlas_file.entries.size(); ++i) {
+		const TextureAtlasEntry& entry = atlas_file.entries[i];
+		if (outdated[i])
+			continue;
+
+		// The images already loaded from their file keep their texture
+		ImageTexture* img = _GetImageTexture(entry.filename + entry.tags);
+		if (img == NULL) {
+			img = new ImageTexture(entry.filename, entry.tags, entry.width, entry.height);
+			if (atlas_sheet->InsertTextureAt(img, entry.x, entry.y) == false) {
+				IF_PRINT_WARNING(VIDEO_DEBUG) << "overlapping entry in texture atlas: " << filename << endl;
+				delete img;
+				// Otherwise the sheet is removed along with its last texture
+				if (sheet->GetNumberTextures() == 0)
+					_RemoveSheet(sheet);
+				_ReleaseAtlas(atlas);
+				return false;
+			}
+		}
+
+		img->AddReference();
+		atlas->textures[i] = img;
+	}
+
+	for (uint32 i = 0; i < atlas_file.multi_images.size(); ++i) {
+		const TextureAtlasMultiImage& multi_image = atlas_file.multi_images[i];
+		if (outdated[multi_image.first_entry] == false)
+			atlas->multi_images[multi_image.filename] = multi_image;
+	}
+
+	// Every image of the atlas was already loaded
+	if (sheet->GetNumberTextures() == 0) {
+		_RemoveSheet(sheet);
+		atlas->sheet = NULL;
+	}
+
+	_atlases[filename] = atlas;
+	IF_PRINT_DEBUG(VIDEO_DEBUG) << "loaded texture atlas " << filename << " holding " << atlas->textures.size() << " images" << endl;
+	return true;
+} // bool TextureController::LoadAtlas(const std::string& filename)
+
+
+
+void TextureController::UnloadAtlas(const std::string& filename) {
+	// Nothing to do if the atlas could not be loaded
+	map<string, LoadedTextureAtlas*>::iterator it = _atlases.find(filename);
+	if (it == _atlases.end())
+		return;
+
+	LoadedTextureAtlas* atlas = it->second;
+	if (--atlas->reference_count > 0)
+		return;
+
+	_atlases.erase(it);
+	_ReleaseAtlas(atlas);
+}
+
+
+
+void TextureController::DEBUG_PrintTexSheetOccupancy() {
+	cout << "VIDEO: " << _tex_sheets.size() << " texture sheets, layout version " << _tex_sheet_layout_version << endl;
+	for (uint32 i = 0; i < _tex_sheets.size(); ++i) {
+		TexSheet* sheet = _tex_sheets[i];
+		cout << "  sheet " << i << ": " << sheet->width << "x" << sheet->height << ", type " << sheet->type
+			<< (sheet->is_static ? ", static" : "") << (sheet->is_dedicated ? ", dedicated" : "")
+			<< ", " << sheet->GetNumberTextures() << " textures, "
+			<< static_cast<int32>(sheet->GetOccupancy() * 100.0f) << "% occupied" << endl;
+	}
+}
+
+
+
 void TextureController::DEBUG_NextTexSheet() {
 	debug_current_sheet++;
 
@@ -208,13 +487,13 @@ void TextureController::DEBUG_ShowTexSheet() {
 	VideoManager->SetDrawFlags(VIDEO_NO_BLEND, VIDEO_X_LEFT, VIDEO_Y_BOTTOM, 0);
 	VideoManager->SetCoordSys(0.0f, VIDEO_STANDARD_RES_WIDTH, 0.0f, VIDEO_STANDARD_RES_HEIGHT);
 
-	glPushMatrix();
+	VideoManager->PushMatrix();
 	VideoManager->Move(0.0f,0.0f);
-	glScalef(sheet->width / 2.0f, sheet->height / 2.0f, 1.0f);
+	VideoManager->Scale(sheet->width / 2.0f, sheet->height / 2.0f);
 
 	sheet->DEBUG_Draw();
 
-	glPopMatrix();
+	VideoManager->PopMatrix();
 
 	char buf[200];
 
@@ -237,6 +516,8 @@ void TextureController::DEBUG_ShowTexSheet() {
 		sprintf(buf, "  Type:    64x64");
 	else if (sheet->type == VIDEO_TEXSHEET_ANY)
 		sprintf(buf, "  Type:    Any size");
+	else if (sheet->type == VIDEO_TEXSHEET_GLYPHS)
+		sprintf(buf, "  Type:    Font glyphs");
 	else
 		sprintf(buf, "  Type:    Unknown");
 
@@ -251,6 +532,10 @@ void TextureController::DEBUG_ShowTexSheet() {
 	VideoManager->MoveRelative(0, -20);
 	TextManager->Draw(buf);
 
+	sprintf(buf, "  Usage:   %d textures, %d%%", sheet->GetNumberTextures(), static_cast<int32>(sheet->GetOccupancy() * 100.0f));
+	VideoManager->MoveRelative(0, -20);
+	TextManager->Draw(buf);
+
 	VideoManager->PopState();
 } // void TextureController::DEBUG_ShowTexSheet()
 
@@ -309,6 +594,9 @@ void TextureController::_BindTexture(GLuint tex_id) {
 
 
 void TextureController::_DeleteTexture(GLuint tex_id) {
+	// Draw the queued images which could still be using this texture
+	VideoManager->FlushBatch();
+
 	glDeleteTextures(1, &tex_id);
 
 	if (_last_tex_id == tex_id)
@@ -407,8 +695,8 @@ void TextureController::_RemoveSheet(TexSheet* sheet) {
 
 
 TexSheet* TextureController::_InsertImageInTexSheet(BaseTexture *image, ImageMemory& load_info, bool is_static) {
-	// Image sizes larger than 512 in either dimension require their own texture sheet
-	if (load_info.width > 512 || load_info.height > 512) {
+	// Image sizes larger than the shared sheets in either dimension require their own texture sheet
+	if (load_info.width > _tex_sheet_size || load_info.height > _tex_sheet_size) {
 		int32 round_width = RoundUpPow2(load_info.width);
 		int32 round_height = RoundUpPow2(load_info.height);
 		TexSheet* sheet = _CreateTexSheet(round_width, round_height, VIDEO_TEXSHEET_ANY, false);
@@ -418,6 +706,7 @@ TexSheet* TextureController::_InsertImageInTexSheet(BaseTexture *image, ImageMem
 			IF_PRINT_WARNING(VIDEO_DEBUG) << "could not create new texture sheet for image" << endl;
 			return NULL;
 		}
+		sheet->is_dedicated = true;
 
 		if (sheet->AddTexture(image, load_info) == true)
 			return sheet;
@@ -448,15 +737,32 @@ TexSheet* TextureController::_InsertImageInTexSheet(BaseTexture *image, ImageMem
 			continue;
 		}
 
-		if (sheet->type == type && sheet->is_static == is_static) {
+		if (sheet->type == type && sheet->is_static == is_static && sheet->is_dedicated == false) {
 			if (sheet->AddTexture(image, load_info) == true) {
 				return sheet;
 			}
 		}
 	}
 
+	// The variable sized sheets may have enough free space left, but split in areas too small for the image
+	if (type == VIDEO_TEXSHEET_ANY) {
+		uint32 image_area = load_info.width * load_info.height;
+		for (uint32 i = 0; i < _tex_sheets.size(); i++) {
+			VariableTexSheet* sheet = dynamic_cast<VariableTexSheet*>(_tex_sheets[i]);
+			if (sheet == NULL || sheet->type != type || sheet->is_static != is_static || sheet->is_dedicated)
+				continue;
+
+			float free_area = (1.0f - sheet->GetOccupancy()) * sheet->width * sheet->height;
+			if (free_area < image_area || sheet->IsFragmented() == false)
+				continue;
+
+			if (_RepackTexSheet(sheet) && sheet->AddTexture(image, load_info) == true)
+				return sheet;
+		}
+	}
+
 	// We couldn't add it to any existing sheets, so we must create a new one for it
-	TexSheet *sheet = _CreateTexSheet(512, 512, type, is_static);
+	TexSheet *sheet = _CreateTexSheet(_tex_sheet_size, _tex_sheet_size, type, is_static);
 	if (sheet == NULL) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create a new texture sheet for image" << endl;
 		return NULL;
@@ -475,6 +781,19 @@ TexSheet* TextureController::_InsertImageInTexSheet(BaseTexture *image, ImageMem
 
 
 bool TextureController::_ReloadImagesToSheet(TexSheet* sheet) {
+	// The sheet of a loaded atlas is reloaded from the atlas file, in a single upload
+	for (map<string, LoadedTextureAtlas*>::iterator i = _atlases.begin(); i != _atlases.end(); ++i) {
+		if (i->second->sheet != sheet)
+			continue;
+
+		TextureAtlasFile atlas_file;
+		if (atlas_file.Read(i->first) == false) {
+			IF_PRINT_WARNING(VIDEO_DEBUG) << "could not read the texture atlas file: " << i->first << endl;
+			return false;
+		}
+		return _UploadAtlas(atlas_file, sheet);
+	}
+
 	// Delete images
 	std::map<string, pair<ImageMemory, ImageMemory> > multi_image_info;
 
@@ -603,6 +922,85 @@ bool TextureController::_ReloadImagesToSheet(TexSheet* sheet) {
 
 
 
+bool TextureController::_RepackTexSheet(VariableTexSheet* sheet) {
+	// The queued quads still use the current texture coordinates
+	VideoManager->FlushBatch();
+
+	if (sheet->Repack() == false)
+		return false;
+
+	_tex_sheet_layout_version++;
+	IF_PRINT_DEBUG(VIDEO_DEBUG) << "repacked a texture sheet holding " << sheet->GetNumberTextures() << " textures, "
+		<< static_cast<int32>(sheet->GetOccupancy() * 100.0f) << "% occupied" << endl;
+	return true;
+}
+
+
+
+void TextureController::GetAtlasMultiImages(uint32 rows, uint32 cols, std::set<std::string>& filenames) const {
+	for (map<string, LoadedTextureAtlas*>::const_iterator i = _atlases.begin(); i != _atlases.end(); ++i) {
+		const map<string, TextureAtlasMultiImage>& multi_images = i->second->multi_images;
+		for (map<string, TextureAtlasMultiImage>::const_iterator j = multi_images.begin(); j != multi_images.end(); ++j) {
+			if (j->second.rows == rows && j->second.cols == cols)
+				filenames.insert(j->first);
+		}
+	}
+}
+
+
+
+ImageTexture* const* TextureController::_GetAtlasMultiImage(const std::string& filename, uint32 rows, uint32 cols) const {
+	for (map<string, LoadedTextureAtlas*>::const_iterator i = _atlases.begin(); i != _atlases.end(); ++i) {
+		map<string, TextureAtlasMultiImage>::const_iterator multi_image = i->second->multi_images.find(filename);
+		if (multi_image == i->second->multi_images.end())
+			continue;
+
+		if (multi_image->second.rows == rows && multi_image->second.cols == cols)
+			return &i->second->textures[multi_image->second.first_entry];
+	}
+
+	return NULL;
+}
+
+
+
+bool TextureController::_UploadAtlas(TextureAtlasFile& atlas_file, TexSheet* sheet) {
+	ImageMemory atlas_image;
+	atlas_image.width = atlas_file.width;
+	atlas_image.height = atlas_file.height;
+	atlas_image.rgb_format = false;
+	atlas_image.pixels = &atlas_file.pixels[0];
+
+	bool success = sheet->CopyRect(0, 0, atlas_image);
+	// The pixels belong to the atlas file
+	atlas_image.pixels = NULL;
+
+	if (success == false)
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "call to TexSheet::CopyRect() failed" << endl;
+	return success;
+}
+
+
+
+void TextureController::_ReleaseAtlas(LoadedTextureAtlas* atlas) {
+	for (uint32 i = 0; i < atlas->textures.size(); ++i) {
+		ImageTexture* img = atlas->textures[i];
+		if (img == NULL || img->RemoveReference() == false)
+			continue;
+
+		// The texture isn't used by any image
+		TexSheet* sheet = img->texture_sheet;
+		sheet->RemoveTexture(img);
+		if (sheet->is_dedicated && sheet->GetNumberTextures() == 0)
+			_RemoveSheet(sheet);
+		delete img;
+	}
+
+	delete atlas;
+}
+
+
+
 void TextureController::_RegisterImageTexture(ImageTexture* img) {
 	if (img == NULL) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL argument passed to function" << endl;
@@ -668,4 +1066,69 @@ void TextureController::_UnregisterTextTexture(TextTexture* tex) {
 }
 
 
+void TextureController::_PrefetchThread() {
+	while (_prefetch_thread_running) {
+		hoa_system::SystemManager->LockThread(_prefetch_semaphore);
+		if (_prefetch_queue.empty()) {
+			hoa_system::SystemManager->UnlockThread(_prefetch_semaphore);
+			SDL_Delay(PREFETCH_THREAD_DELAY);
+			continue;
+		}
+		_prefetch_current = _prefetch_queue.front();
+		_prefetch_queue.pop_front();
+		std::string filename = _prefetch_current;
+		hoa_system::SystemManager->UnlockThread(_prefetch_semaphore);
+
+		ImageMemory* image = new ImageMemory();
+		if (image->DecodeImage(filename) == false) {
+			delete image;
+			image = NULL;
+		}
+
+		hoa_system::SystemManager->LockThread(_prefetch_semaphore);
+		if (image != NULL)
+			_prefetched_images[filename] = image;
+		_prefetch_current.clear();
+		hoa_system::SystemManager->UnlockThread(_prefetch_semaphore);
+	}
+}
+
+
+
+bool TextureController::_TakePrefetchedImage(const std::string& filename, ImageMemory& image) {
+	if (_prefetch_thread == NULL)
+		return false;
+
+	while (true) {
+		hoa_system::SystemManager->LockThread(_prefetch_semaphore);
+
+		std::map<std::string, ImageMemory*>::iterator it = _prefetched_images.find(filename);
+		if (it != _prefetched_images.end()) {
+			free(image.pixels);
+			image.width = it->second->width;
+			image.height = it->second->height;
+			image.pixels = it->second->pixels;
+			image.rgb_format = it->second->rgb_format;
+			it->second->pixels = NULL;
+			delete it->second;
+			_prefetched_images.erase(it);
+			hoa_system::SystemManager->UnlockThread(_prefetch_semaphore);
+			return true;
+		}
+
+		// Decoding the file again would take longer than waiting for the prefetching thread
+		if (filename != _prefetch_current) {
+			std::deque<std::string>::iterator queued = std::find(_prefetch_queue.begin(), _prefetch_queue.end(), filename);
+			if (queued != _prefetch_queue.end())
+				_prefetch_queue.erase(queued);
+			hoa_system::SystemManager->UnlockThread(_prefetch_semaphore);
+			return false;
+		}
+
+		hoa_system::SystemManager->UnlockThread(_prefetch_semaphore);
+		SDL_Delay(1);
+	}
+}
+
+
 }  // namespace hoa_video
@@ -23,8 +23,11 @@
 #include "utils.h"
 
 #include "texture.h"
+#include "texture_atlas.h"
 #include "image_base.h"
 
+#include "engine/system.h"
+
 // OpenGL includes
 #ifdef __APPLE__
 	#include <OpenGL/gl.h>
@@ -34,13 +37,41 @@
 	#include <GL/glu.h>
 #endif
 
+#include <deque>
 #include <map>
+#include <set>
 
 namespace hoa_video {
 
 //! \brief The singleton pointer for the instance of the texture controller
 extern TextureController* TextureManager;
 
+//! \brief The default width and height of the shared texture sheets, in pixels
+const uint32 DEFAULT_TEXSHEET_SIZE = 1024;
+
+namespace private_video {
+
+//! \brief The textures of a texture atlas file loaded by TextureController::LoadAtlas()
+class LoadedTextureAtlas {
+public:
+	LoadedTextureAtlas() :
+		sheet(NULL), reference_count(0) {}
+
+	//! \brief The texture sheet holding the atlas pixels
+	TexSheet* sheet;
+
+	//! \brief The number of LoadAtlas() calls not matched by an UnloadAtlas() call yet
+	uint32 reference_count;
+
+	//! \brief The texture of each atlas entry, holding a reference on it
+	std::vector<ImageTexture*> textures;
+
+	//! \brief The multi images of the atlas, indexed by filename
+	std::map<std::string, TextureAtlasMultiImage> multi_images;
+}; // class LoadedTextureAtlas
+
+} // namespace private_video
+
 class TextureController : public hoa_utils::Singleton<TextureController> {
 	friend class hoa_utils::Singleton<TextureController>;
 	friend class VideoEngine;
@@ -54,6 +85,7 @@ class TextureController : public hoa_utils::Singleton<TextureController> {
 	friend class private_video::TexSheet;
 	friend class private_video::FixedTexSheet;
 	friend class private_video::VariableTexSheet;
+	friend class private_video::SpriteBatch;
 
 	friend class hoa_mode_manager::ParticleSystem;
 
@@ -79,12 +111,94 @@ public:
 	**/
 	bool ReloadTextures();
 
+	/** \brief Decodes image files in the background, before they are loaded
+	*** \param filenames The names of the image files to decode
+	***
+	*** The files are decoded by the prefetching thread, and kept in system memory until an image
+	*** or a multi image is loaded from them. Loading these images then only requires to add their
+	*** pixels to a texture sheet. When the prefetching thread couldn't be created, this does nothing
+	*** and the files are decoded when loaded.
+	**/
+	void PrefetchImages(const std::vector<std::string>& filenames);
+
+	//! \brief Cancels the pending prefetching requests and frees the prefetched images not used yet
+	void ClearPrefetchedImages();
+
+	/** \brief Sets the width and height of the texture sheets shared by several images
+	*** \param size The size, in pixels, rounded up to a power of two and limited to GL_MAX_TEXTURE_SIZE
+	***
+	*** Only the texture sheets created afterwards use the new size. Images bigger than
+	*** that size get a texture sheet of their own.
+	**/
+	void SetTexSheetSize(uint32 size);
+
+	//! \brief Returns the width and height of the shared texture sheets
+	uint32 GetTexSheetSize() const
+		{ return _tex_sheet_size; }
+
+	/** \brief Returns a number changed every time textures are moved in their texture sheet
+	*** The texture coordinates kept outside of the images, as in a StaticImageBatch, must be
+	*** computed again when this number changes.
+	**/
+	uint32 GetTexSheetLayoutVersion() const
+		{ return _tex_sheet_layout_version; }
+
+	/** \brief Repacks the fragmented variable sized texture sheets and deletes the empty ones
+	*** This is best called after many images were unloaded, like when leaving a game mode.
+	*** The sheets are read back from the video memory to be repacked, so this is slow.
+	**/
+	void DefragmentTexSheets();
+
+	/** \brief Returns the part of the shared variable sized texture sheets used by textures
+	*** \return A value from 0.0f to 1.0f, 1.0f when no such sheet holds any texture
+	***
+	*** The empty sheets aren't counted. A low value means many images were unloaded, and that
+	*** DefragmentTexSheets() is worth calling.
+	**/
+	float GetTexSheetOccupancy() const;
+
+	/** \brief Loads a prebuilt texture atlas file made by the vt-atlas-baker tool
+	*** \param filename The name of the atlas file
+	*** \return False if the file doesn't exist or could not be loaded
+	***
+	*** The atlas pixels are uploaded at once in a texture sheet of their own, and an image texture
+	*** is registered for each of its images. Loading these images or multi images afterwards simply
+	*** adds a reference to their texture, without opening their file. The images already loaded
+	*** from their own file keep their texture. Atlases are optional: when one is missing, its images
+	*** are loaded from their file as usual. So are the images whose file changed since the atlas
+	*** was baked.
+	***
+	*** \note Each call must be matched by a call to UnloadAtlas(), even when it failed.
+	**/
+	bool LoadAtlas(const std::string& filename);
+
+	/** \brief Releases the textures of an atlas loaded with LoadAtlas()
+	*** The textures still used by images are kept until these images are unloaded.
+	**/
+	void UnloadAtlas(const std::string& filename);
+
+	//! \brief Tells whether an atlas file is currently loaded
+	bool IsAtlasLoaded(const std::string& filename) const
+		{ return (_atlases.find(filename) != _atlases.end()); }
+
+	/** \brief Gathers the multi images stored in the loaded atlases, which thus don't need their file
+	*** \param rows, cols The grid of the multi images to gather
+	*** \param filenames Filled with the multi image file names
+	***
+	*** The loaded atlases aren't guarded against other threads, so this must be called from the
+	*** main thread, and its result handed over to a loading thread.
+	**/
+	void GetAtlasMultiImages(uint32 rows, uint32 cols, std::set<std::string>& filenames) const;
+
 	//! \brief Cycles forward to show the next texture sheet
 	void DEBUG_NextTexSheet();
 
 	//! \brief Cycles backward to show the previous texture sheet
 	void DEBUG_PrevTexSheet();
 
+	//! \brief Prints the number of textures and the occupancy of every texture sheet
+	void DEBUG_PrintTexSheetOccupancy();
+
 	/** \brief Displays the currently selected texture sheet.
 	*** By using DEBUG_NextTexSheet() and DEBUG_PrevTexSheet(), you can change the current texture sheet so the sheet shown by this function
 	*** cycles through all currently loaded texture sheets.
@@ -112,6 +226,42 @@ private:
 	//! \brief Keeps track of the number of texture switches per frame
 	uint32 _debug_num_tex_switches;
 
+	//! \brief The width and height of the shared texture sheets
+	uint32 _tex_sheet_size;
+
+	//! \brief The maximum texture size supported by OpenGL, or 0 while unknown
+	uint32 _max_tex_sheet_size;
+
+	//! \brief Incremented every time a texture sheet is repacked
+	uint32 _tex_sheet_layout_version;
+
+	//! \brief The texture atlases currently loaded, indexed by filename
+	std::map<std::string, private_video::LoadedTextureAtlas*> _atlases;
+
+	/** \name Image Prefetching Members
+	*** The prefetching thread decodes the queued image files, which are then taken
+	*** by ImageMemory::LoadImage() instead of decoding the files again.
+	**/
+	//@{
+	//! \brief The thread decoding the prefetched images, or NULL if prefetching is disabled
+	Thread* _prefetch_thread;
+
+	//! \brief Guards the prefetching queue, the image being decoded and the prefetched images
+	Semaphore* _prefetch_semaphore;
+
+	//! \brief Cleared to ask the prefetching thread to exit
+	volatile bool _prefetch_thread_running;
+
+	//! \brief The image files waiting to be decoded
+	std::deque<std::string> _prefetch_queue;
+
+	//! \brief The image file currently decoded by the prefetching thread, or an empty string
+	std::string _prefetch_current;
+
+	//! \brief The decoded images waiting to be loaded, indexed by filename
+	std::map<std::string, private_video::ImageMemory*> _prefetched_images;
+	//@}
+
 	// ---------- Private methods
 
 	//! \name Texture Operations
@@ -173,8 +323,8 @@ private:
 	*** \return A new texsheet with the image contained within it, or NULL if an error occured and the image could not be added to any sheet
 	***
 	*** A new texture sheet will be created by this function in one of two cases. First, if there was no room for the image in any existing
-	*** compatible texture sheets. Second, if the image is very large (either height or width of the image exceeds 512 pixels), it will
-	*** merit having its own un-shared texture sheet.
+	*** compatible texture sheets, even after repacking the fragmented ones. Second, if the image is very large (either height or width of
+	*** the image exceeds the shared texture sheet size), it will merit having its own un-shared texture sheet.
 	**/
 	private_video::TexSheet* _InsertImageInTexSheet(private_video::BaseTexture* image, private_video::ImageMemory& load_info, bool is_static);
 
@@ -183,6 +333,47 @@ private:
 	*** \return True only if every single image owned by the TexSheet was successfully reloaded back into it
 	**/
 	bool _ReloadImagesToSheet(private_video::TexSheet* sheet);
+
+	/** \brief Repacks a variable sized texture sheet and updates the layout version if textures were moved
+	*** \return True if textures were moved
+	**/
+	bool _RepackTexSheet(private_video::VariableTexSheet* sheet);
+	//@}
+
+	//! \name Texture Atlas Operations
+	//@{
+	/** \brief Returns the element textures of a multi image stored in a loaded atlas
+	*** \param filename The multi image file name
+	*** \param rows The number of rows of elements
+	*** \param cols The number of columns of elements
+	*** \return A pointer to the rows * cols textures, in the order of the multi image elements,
+	*** or NULL if no loaded atlas holds the multi image with that grid
+	**/
+	private_video::ImageTexture* const* _GetAtlasMultiImage(const std::string& filename, uint32 rows, uint32 cols) const;
+
+	/** \brief Uploads the pixels of an atlas file in its texture sheet
+	*** \return False if the pixels could not be copied in the sheet
+	**/
+	bool _UploadAtlas(private_video::TextureAtlasFile& atlas_file, private_video::TexSheet* sheet);
+
+	//! \brief Removes the references held by an atlas and deletes it
+	void _ReleaseAtlas(private_video::LoadedTextureAtlas* atlas);
+	//@}
+
+	//! \name Image Prefetching Operations
+	//@{
+	//! \brief The function run by the prefetching thread
+	void _PrefetchThread();
+
+	/** \brief Hands over the pixels of a prefetched image
+	*** \param filename The name of the image file
+	*** \param image The image memory to fill
+	*** \return True if the image was prefetched, false if it must be decoded by the caller
+	***
+	*** If the prefetching thread is decoding the file, this waits for it to be done. If the
+	*** file is still queued, it is removed from the queue. This can be called from any thread.
+	**/
+	bool _TakePrefetchedImage(const std::string& filename, private_video::ImageMemory& image);
 	//@}
 
 	//! \name Image Texture Operations
@@ -17,8 +17,11 @@
 #include "engine/video/video.h"
 #include "engine/script/script_read.h"
 
+#include "engine/profiler.h"
 #include "engine/system.h"
 
+#include <algorithm>
+
 using namespace std;
 
 using namespace hoa_utils;
@@ -71,7 +74,9 @@ void RotatePoint(float& x, float& y, float angle) {
 //-----------------------------------------------------------------------------
 
 VideoEngine::VideoEngine() :
-	_initialized(false)
+	_initialized(false),
+	_draw_call_count(0),
+	_last_draw_call_count(0)
 {
 	_target = VIDEO_TARGET_SDL_WINDOW;
 	_x_cursor = 0;
@@ -90,10 +95,8 @@ VideoEngine::VideoEngine() :
 	_gamma_value = 1.0f;
 	_gl_error_code = GL_NO_ERROR;
 
-	_fps_sum = 0;
 	_fps_display = false;
-	_current_sample = 0;
-	_number_samples = 0;
+	_vsync = true;
 
 	_current_context.blend = 0;
 	_current_context.x_align = -1;
@@ -107,9 +110,6 @@ VideoEngine::VideoEngine() :
 
 	strcpy(_next_temp_file, "00000000");
 
-	for (uint32 sample = 0; sample < FPS_SAMPLES; sample++)
-		 _fps_samples[sample] = 0;
-
 	// Custom fading overlay
 	_fade_overlay_img.Load("", 1.0f, 1.0f);
 }
@@ -119,60 +119,95 @@ void VideoEngine::DrawFPS() {
 	if (!_fps_display)
 		return;
 
-	uint32 frame_time = hoa_system::SystemManager->GetUpdateTime();
+	float min_time, average_time, p99_time;
+	if (!hoa_system::SystemManager->GetFrameStatistics(min_time, average_time, p99_time))
+		return;
+
 	SetDrawFlags(VIDEO_X_LEFT, VIDEO_Y_BOTTOM, VIDEO_X_NOFLIP, VIDEO_Y_NOFLIP, VIDEO_BLEND, 0);
+	TextStyle style("text20", Color::white);
 
-	// Calculate the FPS for the current frame
-	uint32 current_fps = 1000;
-	if (frame_time) {
-		current_fps /= frame_time;
-	}
+	// The text to display to the screen
+	char fps_text[16];
+	sprintf(fps_text, "FPS: %d", static_cast<int32>(1000.0f / average_time + 0.5f));
 
-	// The number of times to insert the current FPS sample into the fps_samples array
-	uint32 number_insertions;
+	Move(880.0f, 720.0f); // Upper right hand corner of the screen
+	Text()->Draw(fps_text, style);
 
-	if (_number_samples == 0) {
-		// If the FPS display is uninitialized, set the entire FPS array to the current FPS
-		_number_samples = FPS_SAMPLES;
-		number_insertions = FPS_SAMPLES;
-	}
-	else if (current_fps >= 500) {
-		 // If the game is going at 500 fps or faster, 1 insertion is enough
-		number_insertions = 1;
-	}
-	else {
-		// Find if there's a discrepancy between the current frame time and the averaged one.
-		// If there's a large difference, add extra samples so the FPS display "catches up" more quickly.
-		float avg_frame_time = 1000.0f * FPS_SAMPLES / _fps_sum;
-		int32 time_difference = static_cast<int32>(avg_frame_time) - static_cast<int32>(frame_time);
+	// The number of draw calls issued during the last frame
+	char draw_calls_text[32];
+	sprintf(draw_calls_text, "Draws: %d", _last_draw_call_count);
 
-		if (time_difference < 0)
-			time_difference = -time_difference;
+	Move(880.0f, 700.0f);
+	Text()->Draw(draw_calls_text, style);
 
-		if (time_difference <= static_cast<int32>(MAX_FTIME_DIFF))
-			number_insertions = 1;
-		else
-			number_insertions = FPS_CATCHUP; // Take more samples to catch up to the current FPS
-	}
+	// The frame times, in milliseconds
+	char frame_time_text[32];
+	sprintf(frame_time_text, "Min: %.1f ms", min_time);
+	Move(880.0f, 680.0f);
+	Text()->Draw(frame_time_text, style);
 
-	// Insert the current_fps samples into the fps_samples array for the number of times specified
-	for (uint32 j = 0; j < number_insertions; j++) {
-		_fps_sum -= _fps_samples[_current_sample];
-		_fps_sum += current_fps;
-		_fps_samples[_current_sample] = current_fps;
-		_current_sample = (_current_sample + 1) % FPS_SAMPLES;
-	}
+	sprintf(frame_time_text, "Avg: %.1f ms", average_time);
+	Move(880.0f, 660.0f);
+	Text()->Draw(frame_time_text, style);
 
-	uint32 avg_fps = _fps_sum / FPS_SAMPLES;
+	sprintf(frame_time_text, "P99: %.1f ms", p99_time);
+	Move(880.0f, 640.0f);
+	Text()->Draw(frame_time_text, style);
 
-	// The text to display to the screen
-	char fps_text[16];
-	sprintf(fps_text, "FPS: %d", avg_fps);
+} // void VideoEngine::DrawFPS()
 
-	Move(930.0f, 720.0f); // Upper right hand corner of the screen
-	Text()->Draw(fps_text, TextStyle("text20", Color::white));
 
-} // void GUISystem::_DrawFPS(uint32 frame_time)
+
+void VideoEngine::DrawProfiler() {
+	if (hoa_system::ProfilerManager == NULL || !hoa_system::ProfilerManager->IsEnabled())
+		return;
+
+	const std::vector<float>& zone_times = hoa_system::ProfilerManager->GetZoneTimes();
+	const std::vector<float>& average_zone_times = hoa_system::ProfilerManager->GetAverageZoneTimes();
+
+	// The slowest zones are listed first
+	std::vector<std::pair<float, uint32> > zones;
+	for (uint32 i = 0; i < average_zone_times.size(); ++i) {
+		if (average_zone_times[i] >= 0.01f)
+			zones.push_back(std::make_pair(average_zone_times[i], i));
+	}
+	std::sort(zones.rbegin(), zones.rend());
+	if (zones.size() > PROFILER_OVERLAY_ZONES)
+		zones.resize(PROFILER_OVERLAY_ZONES);
+
+	SetDrawFlags(VIDEO_X_LEFT, VIDEO_Y_BOTTOM, VIDEO_X_NOFLIP, VIDEO_Y_NOFLIP, VIDEO_BLEND, 0);
+	TextStyle style("text18", Color::white);
+	char zone_text[128];
+
+	float y = 740.0f;
+	sprintf(zone_text, "Profiler (ms, averaged) - dropped events: %d", hoa_system::ProfilerManager->GetNumberDroppedEvents());
+	Move(20.0f, y);
+	Text()->Draw(zone_text, style);
+
+	y -= 20.0f;
+	sprintf(zone_text, "Lua heap: %d KB - GC step: %.2f ms - last full GC: %.2f ms - cycles: %d",
+		hoa_script::ScriptManager->GetHeapSize() / 1024, hoa_script::ScriptManager->GetGarbageCollectorStepTime(),
+		hoa_script::ScriptManager->GetFullCollectionTime(), hoa_script::ScriptManager->GetNumberGarbageCollections());
+	Move(20.0f, y);
+	Text()->Draw(zone_text, style);
+
+	for (uint32 i = 0; i < zones.size(); ++i) {
+		y -= 20.0f;
+		uint32 zone = zones[i].second;
+
+		// The bars of the zones which took much longer than usual during the last frame are red
+		Color bar_color(0.2f, 0.5f, 1.0f, 0.6f);
+		if (zone < zone_times.size() && zone_times[zone] > 2.0f * zones[i].first)
+			bar_color = Color(1.0f, 0.2f, 0.2f, 0.6f);
+
+		Move(20.0f, y);
+		DrawRectangle(std::min(zones[i].first * PROFILER_OVERLAY_PIXELS_PER_MS, PROFILER_OVERLAY_BAR_WIDTH), 18.0f, bar_color);
+
+		sprintf(zone_text, "%s: %.2f", hoa_system::ProfilerEngine::GetZoneName(zone), zones[i].first);
+		Move(20.0f, y);
+		Text()->Draw(zone_text, style);
+	}
+} // void VideoEngine::DrawProfiler()
 
 
 VideoEngine::~VideoEngine() {
@@ -331,6 +366,8 @@ void VideoEngine::Clear(const Color &c) {
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	TextureManager->_debug_num_tex_switches = 0;
+	_last_draw_call_count = _draw_call_count;
+	_draw_call_count = 0;
 
 	if (CheckGLError() == true) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occured: " << CreateGLErrorString() << endl;
@@ -359,7 +396,11 @@ void VideoEngine::Draw() {
 
 	// Draw FPS Counter If We Need To
 	DrawFPS();
+	DrawProfiler();
 	PopState();
+
+	// Submit the remaining queued images before the buffers get swapped
+	FlushBatch();
 } // void VideoEngine::Draw()
 
 
@@ -405,7 +446,7 @@ bool VideoEngine::ApplySettings() {
 		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 		SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 2);
 		SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
-		SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, 1);
+		SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, _vsync ? 1 : 0);
 
 		if (SDL_SetVideoMode(_temp_width, _temp_height, 0, flags) == false) {
 			// RGB values of 1 for each and 8 for depth seemed to be sufficient.
@@ -418,7 +459,7 @@ bool VideoEngine::ApplySettings() {
 			SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 0);
 			SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 0);
 			SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 0);
-			SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, 1);
+			SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, _vsync ? 1 : 0);
 
 			if (SDL_SetVideoMode(_temp_width, _temp_height, 0, flags) == false) {
 				IF_PRINT_WARNING(VIDEO_DEBUG) << "SDL_SetVideoMode() failed with error: " << SDL_GetError() << endl;
@@ -473,6 +514,8 @@ void VideoEngine::SetViewport(float left, float right, float bottom, float top)
 		return;
 	}
 
+	FlushBatch();
+
 	int32 l = static_cast<int32>(left * _screen_width * .01f);
 	int32 b = static_cast<int32>(bottom * _screen_height * .01f);
 	int32 r = static_cast<int32>(right * _screen_width * .01f);
@@ -494,6 +537,9 @@ void VideoEngine::SetViewport(float left, float right, float bottom, float top)
 
 
 void VideoEngine::SetCoordSys(const CoordSys& coordinate_system) {
+	// The queued images were transformed using the previous projection
+	FlushBatch();
+
 	_current_context.coordinate_system = coordinate_system;
 
 	glMatrixMode(GL_PROJECTION);
@@ -506,11 +552,14 @@ void VideoEngine::SetCoordSys(const CoordSys& coordinate_system) {
 	// This small translation is supposed to help with pixel-perfect 2D rendering in OpenGL.
 	// Reference: http://www.opengl.org/resources/faq/technical/transformations.htm#tran0030
 	glTranslatef(0.375, 0.375, 0);
+	_transform.Reset();
+	_transform.Translate(0.375f, 0.375f);
 }
 
 
 
 void VideoEngine::EnableScissoring() {
+	FlushBatch();
 	_current_context.scissoring_enabled = true;
 	glEnable(GL_SCISSOR_TEST);
 }
@@ -518,6 +567,7 @@ void VideoEngine::EnableScissoring() {
 
 
 void VideoEngine::DisableScissoring() {
+	FlushBatch();
 	_current_context.scissoring_enabled = false;
 	glDisable(GL_SCISSOR_TEST);
 }
@@ -525,6 +575,7 @@ void VideoEngine::DisableScissoring() {
 
 
 void VideoEngine::SetScissorRect(float left, float right, float bottom, float top) {
+	FlushBatch();
 	_current_context.scissor_rectangle = CalculateScreenRect(left, right, bottom, top);
 
 	glScissor(static_cast<GLint>((_current_context.scissor_rectangle.left / static_cast<float>(VIDEO_STANDARD_RES_WIDTH)) * _current_context.viewport.width),
@@ -537,6 +588,7 @@ void VideoEngine::SetScissorRect(float left, float right, float bottom, float to
 
 
 void VideoEngine::SetScissorRect(const ScreenRect& rect) {
+	FlushBatch();
 	_current_context.scissor_rectangle = rect;
 
 	glScissor(static_cast<GLint>((_current_context.scissor_rectangle.left / static_cast<float>(VIDEO_STANDARD_RES_WIDTH)) * _current_context.viewport.width),
@@ -584,6 +636,8 @@ ScreenRect VideoEngine::CalculateScreenRect(float left, float right, float botto
 void VideoEngine::Move(float x, float y) {
 	glLoadIdentity();
 	glTranslatef(x, y, 0);
+	_transform.Reset();
+	_transform.Translate(x, y);
 	_x_cursor = x;
 	_y_cursor = y;
 }
@@ -592,6 +646,7 @@ void VideoEngine::Move(float x, float y) {
 
 void VideoEngine::MoveRelative(float x, float y) {
 	glTranslatef(x, y, 0);
+	_transform.Translate(x, y);
 	_x_cursor += x;
 	_y_cursor += y;
 }
@@ -599,10 +654,24 @@ void VideoEngine::MoveRelative(float x, float y) {
 
 
 
+void VideoEngine::PopMatrix() {
+	glPopMatrix();
+
+	if (_transform_stack.empty()) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "no transformations were saved on the stack" << endl;
+		return;
+	}
+
+	_transform = _transform_stack.top();
+	_transform_stack.pop();
+}
+
+
+
 void VideoEngine::PushState() {
 	// Push current modelview transformation
 	glMatrixMode(GL_MODELVIEW);
-	glPushMatrix();
+	PushMatrix();
 
 	_context_stack.push(_current_context);
 }
@@ -616,12 +685,28 @@ void VideoEngine::PopState() {
 		return;
 	}
 
-	_current_context = _context_stack.top();
+	const Context& previous_context = _context_stack.top();
+
+	// The queued images must be drawn before the viewport or the scissoring get changed
+	if (previous_context.scissoring_enabled != _current_context.scissoring_enabled
+			|| previous_context.viewport.left != _current_context.viewport.left
+			|| previous_context.viewport.top != _current_context.viewport.top
+			|| previous_context.viewport.width != _current_context.viewport.width
+			|| previous_context.viewport.height != _current_context.viewport.height
+			|| (previous_context.scissoring_enabled
+				&& (previous_context.scissor_rectangle.left != _current_context.scissor_rectangle.left
+				|| previous_context.scissor_rectangle.top != _current_context.scissor_rectangle.top
+				|| previous_context.scissor_rectangle.width != _current_context.scissor_rectangle.width
+				|| previous_context.scissor_rectangle.height != _current_context.scissor_rectangle.height))) {
+		FlushBatch();
+	}
+
+	_current_context = previous_context;
 	_context_stack.pop();
 
 	// Restore the modelview transformation
 	glMatrixMode(GL_MODELVIEW);
-	glPopMatrix();
+	PopMatrix();
 	glViewport(_current_context.viewport.left, _current_context.viewport.top, _current_context.viewport.width, _current_context.viewport.height);
 
 	if (_current_context.scissoring_enabled) {
@@ -643,6 +728,7 @@ void VideoEngine::SetTransform(float matrix[16]) {
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
 	glLoadMatrixf(matrix);
+	_transform.Load(matrix);
 }
 
 void VideoEngine::DrawFadeEffect() {
@@ -693,6 +779,8 @@ StillImage VideoEngine::CaptureScreen() throw(Exception) {
 	// Create a texture sheet of an appropriate size that can retain the capture
 	TexSheet* temp_sheet = TextureManager->_CreateTexSheet(RoundUpPow2(viewport_dimensions[2]), RoundUpPow2(viewport_dimensions[3]), VIDEO_TEXSHEET_ANY, false);
 	VariableTexSheet* sheet = dynamic_cast<VariableTexSheet*>(temp_sheet);
+	if (sheet != NULL)
+		sheet->is_dedicated = true;
 
 	// Ensure that texture sheet creation succeeded, insert the texture image into the sheet, and copy the screen into the sheet
 	if (sheet == NULL) {
@@ -772,6 +860,7 @@ void VideoEngine::MakeScreenshot(const std::string& filename) {
 	buffer.rgb_format = true;
 
 	// Read pixel data
+	FlushBatch();
 	glReadPixels(0, 0, buffer.width, buffer.height, GL_RGB, GL_UNSIGNED_BYTE, buffer.pixels);
 
 	if (CheckGLError() == true) {
@@ -926,6 +1015,8 @@ void VideoEngine::DrawLine(float x1, float y1, float x2, float y2, float width,
 		x1, y1,
 		x2, y2
 	};
+	FlushBatch();
+
 	glEnable(GL_BLEND);
 	glDisable(GL_TEXTURE_2D);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
@@ -940,6 +1031,7 @@ void VideoEngine::DrawLine(float x1, float y1, float x2, float y2, float width,
 	glColor4fv((GLfloat*)color.GetColors());
 	glVertexPointer(2, GL_FLOAT, 0, vert_coords);
 	glDrawArrays(GL_LINES, 0, 2);
+	CountDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glPopAttrib();
 }
@@ -968,10 +1060,13 @@ void VideoEngine::DrawGrid(float x, float y, float x_step, float y_step, const C
 		vertices.push_back(y);
 		num_vertices += 2;
 	}
+	FlushBatch();
+
 	glColor4fv(&c[0]);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glVertexPointer(2, GL_FLOAT, 0, &(vertices[0]));
 	glDrawArrays(GL_LINES, 0, num_vertices);
+	CountDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 
 	PopState();
@@ -35,6 +35,7 @@
 #include "interpolator.h"
 #include "shake.h"
 #include "screen_rect.h"
+#include "sprite_batch.h"
 #include "texture_controller.h"
 #include "text.h"
 
@@ -75,14 +76,14 @@ extern VideoEngine* VideoManager;
 extern bool VIDEO_DEBUG;
 
 namespace private_video {
-//! \brief The number of FPS samples to retain across frames
-const uint32 FPS_SAMPLES = 250;
-
-//! \brief Maximum milliseconds that the current frame time and our averaged frame time must vary before we begin trying to catch up
-const uint32 MAX_FTIME_DIFF = 5;
-
-//! \brief The number of samples to take if we need to play catchup with the current FPS
-const uint32 FPS_CATCHUP = 20;
+//! \brief The maximum number of profile zones listed by the profiler overlay
+const uint32 PROFILER_OVERLAY_ZONES = 24;
+
+//! \brief The length of the profiler overlay bars for one millisecond, and their maximum length, in pixels
+//@{
+const float PROFILER_OVERLAY_PIXELS_PER_MS = 40.0f;
+const float PROFILER_OVERLAY_BAR_WIDTH = 600.0f;
+//@}
 }
 
 //! \brief Draw flags to control x and y alignment, flipping, and texture blending.
@@ -188,6 +189,8 @@ class VideoEngine : public hoa_utils::Singleton<VideoEngine> {
 	friend class CompositeImage;
 	friend class private_video::TextElement;
 	friend class TextImage;
+	friend class private_video::SpriteBatch;
+	friend class StaticImageBatch;
 
 public:
 	~VideoEngine();
@@ -296,6 +299,12 @@ public:
 	void ToggleFullscreen()
 		{ SetFullscreen(!_temp_fullscreen); }
 
+	/** \brief Enables or disables the vertical sync of the buffer swaps
+	*** \note You must call ApplySettings() to actually apply the change
+	**/
+	void SetVSync(bool vsync)
+		{ _vsync = vsync; }
+
 	//! \brief Will make the pixel art related images smoothed (only used for map tiles at the moment)
 	void SetPixelArtSmoothed(bool smooth)
 		{ _smooth_pixel_art = smooth; }
@@ -425,11 +434,10 @@ public:
 	*** calls (Move/MoveRelative/Scale/Rotate)
 	**/
 	void PushMatrix()
-		{ glPushMatrix(); }
+		{ glPushMatrix(); _transform_stack.push(_transform); }
 
 	//! \brief Pops the modelview transformation from the stack
-	void PopMatrix()
-		{ glPopMatrix(); }
+	void PopMatrix();
 
 	/** \brief Saves relevant state of the video engine on to an internal stack
 	*** The contents saved include the modelview transformation and the current
@@ -453,7 +461,7 @@ public:
 	*** prior to using this function.
 	**/
 	void Rotate(float angle)
-		{ glRotatef(angle, 0, 0, 1); }
+		{ glRotatef(angle, 0, 0, 1); _transform.Rotate(angle); }
 
 	/** \brief Scales all subsequent image drawing calls in the horizontal and vertical direction
 	*** \param x The amount of horizontal scaling to perform (0.5 for half, 1.0 for normal, 2.0 for double, etc)
@@ -462,7 +470,7 @@ public:
 	*** prior to using this function.
 	**/
 	void Scale(float x, float y)
-		{ glScalef(x, y, 1.0f); }
+		{ glScalef(x, y, 1.0f); _transform.Scale(x, y); }
 
 	/** \brief Sets the OpenGL transform to the contents of 4x4 matrix
 	*** \param matrix A pointer to an array of 16 float values that form a 4x4 transformation matrix
@@ -666,13 +674,40 @@ public:
 	 */
 	TextStyle GetTextStyle();
 
-	//! \brief Updates the FPS counter and draws the current average FPS to the screen.
+	/** \brief Draws the average FPS and the frame time statistics to the screen.
+	*** The shortest, average and 99th percentile frame times are the ones of the last
+	*** frames recorded by the system engine, see SystemEngine::GetFrameStatistics().
+	**/
 	void DrawFPS();
 
+	/** \brief Draws the time spent in the profile zones, when the profiler is enabled
+	*** The zones are listed from the slowest one, with a bar as long as their average time.
+	**/
+	void DrawProfiler();
+
 	/** \brief toggles the FPS display
 	 */
 	void ToggleFPS()
 		{ _fps_display = !_fps_display; }
+
+	//-- Batching -------------------------------------------------------------
+
+	/** \brief Draws all the image quads queued in the sprite batch
+	*** Images are not drawn immediately but queued so that consecutive images
+	*** sharing the same texture sheet and blending mode are drawn at once.
+	*** This must be called before issuing any raw OpenGL draw call or before
+	*** changing any OpenGL state the queued images depend on.
+	**/
+	void FlushBatch()
+		{ _sprite_batch.Flush(); }
+
+	//! \brief Adds one to the number of OpenGL draw calls issued during the current frame
+	void CountDrawCall()
+		{ ++_draw_call_count; }
+
+	//! \brief Returns the number of OpenGL draw calls issued during the last complete frame
+	uint32 GetDrawCallCount() const
+		{ return _last_draw_call_count; }
 private:
 	VideoEngine();
 
@@ -689,24 +724,6 @@ private:
 	//! fps display flag. If true, FPS is displayed
 	bool _fps_display;
 
-	//! \brief A circular array of FPS samples used for calculating average FPS
-	uint32 _fps_samples[private_video::FPS_SAMPLES];
-
-	/** \brief Keeps track of the sum of FPS values over the last VIDEO_FPS_SAMPLES frames
-	*** This is used to simplify the calculation of average frames per second.
-	**/
-	uint32 _fps_sum;
-
-	//! \brief An index variable to keep track of the start of the circular fps_samples array.
-	uint32 _current_sample;
-
-	/** \brief The number of FPS samples currently recorded.
-	*** This value should always be VIDEO_FPS_SAMPLES, unless the game has just started, in which
-	*** case it could be anywhere from 0 to VIDEO_FPS_SAMPLES depending on how many frames have
-	*** been displayed.
-	**/
-	uint32 _number_samples;
-
 	//! \brief Holds the most recently fetched OpenGL error code
 	GLenum _gl_error_code;
 
@@ -767,6 +784,9 @@ private:
 	//! \brief Tells whether pixel art sprites should be smoothed.
 	bool _smooth_pixel_art;
 
+	//! holds whether the buffer swaps wait for the vertical sync. Not actually applied until ApplySettings() is called
+	bool _vsync;
+
 	//! image which is to be used as the cursor
 	StillImage _default_menu_cursor;
 
@@ -779,6 +799,19 @@ private:
 	//! check to see if the VideoManager has already been setup.
 	bool _initialized;
 
+	//! \brief Queues the image quads to draw them with as few draw calls as possible
+	private_video::SpriteBatch _sprite_batch;
+
+	//! \brief A copy of the OpenGL modelview matrix, used to transform the batched quads
+	private_video::Transform2D _transform;
+
+	//! \brief The saved modelview matrices, following the OpenGL matrix stack
+	std::stack<private_video::Transform2D> _transform_stack;
+
+	//! \brief The number of draw calls issued during the current and the last complete frame
+	uint32 _draw_call_count;
+	uint32 _last_draw_call_count;
+
 	//-- Private methods ------------------------------------------------------
 
 	/** \brief converts VIDEO_DRAW_LEFT or VIDEO_DRAW_RIGHT flags to a numerical offset
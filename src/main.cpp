@@ -28,6 +28,7 @@
 #include "engine/audio/audio.h"
 #include "engine/input.h"
 #include "engine/mode_manager.h"
+#include "engine/profiler.h"
 #include "engine/video/video.h"
 #include "engine/system.h"
 
@@ -35,13 +36,13 @@
 #include "common/gui/gui.h"
 
 #include "modes/boot/boot.h"
+#include "main_init.h"
 #include "main_options.h"
 
 #ifdef __MACH__
 	#include <unistd.h>
 #endif
 
-#include <SDL_image.h>
 #include <time.h>
 
 using namespace std;
@@ -57,289 +58,11 @@ using namespace hoa_script;
 using namespace hoa_boot;
 using namespace hoa_map;
 
-/** \brief Frees all data allocated by the game by destroying the singleton classes
-***
-*** \note <b>Do not attempt to call or otherwise reference this function.</b>
-*** It is for use in the application's main() function only.
-***
-*** Deleteing the singleton class objects will free all of the memory that the game uses.
-*** This is because all other classes and data structures in the game are managed
-*** by these singletons either directly or in directly. For example, BattleMode is a
-*** class object that is managed by the ModeEngine class, and thus the GameModeManager
-*** destructor will also invoke the BattleMode destructor (as well as the destructors of any
-*** other game modes that exist).
-**/
-void QuitApp() {
-	// NOTE: Even if the singleton objects do not exist when this function is called, invoking the
-	// static Destroy() singleton function will do no harm (it checks that the object exists before deleting it).
-
-	// Delete the mode manager first so that all game modes free their resources
-	ModeEngine::SingletonDestroy();
-
-	// Delete the global manager second to remove all object references corresponding to other engine subsystems
-	GameGlobal::SingletonDestroy();
-
-	// Delete all of the reamining independent engine components
-	GUISystem::SingletonDestroy();
-	AudioEngine::SingletonDestroy();
-	InputEngine::SingletonDestroy();
-	ScriptEngine::SingletonDestroy();
-	SystemEngine::SingletonDestroy();
-	VideoEngine::SingletonDestroy();
-} // void QuitApp()
-
-/** \brief Reads in all of the saved game settings and sets values in the according game manager classes
-*** \return True if the settings were loaded successfully
-**/
-bool LoadSettings()
-{
-	ReadScriptDescriptor settings;
-	if (settings.OpenFile(GetSettingsFilename()) == false)
-		return false;
-
-	settings.OpenTable("settings");
-
-	// Load language settings
-	SystemManager->SetLanguage(static_cast<std::string>(settings.ReadString("language")));
-
-	settings.OpenTable("key_settings");
-	InputManager->SetUpKey(static_cast<SDLKey>(settings.ReadInt("up")));
-	InputManager->SetDownKey(static_cast<SDLKey>(settings.ReadInt("down")));
-	InputManager->SetLeftKey(static_cast<SDLKey>(settings.ReadInt("left")));
-	InputManager->SetRightKey(static_cast<SDLKey>(settings.ReadInt("right")));
-	InputManager->SetConfirmKey(static_cast<SDLKey>(settings.ReadInt("confirm")));
-	InputManager->SetCancelKey(static_cast<SDLKey>(settings.ReadInt("cancel")));
-	InputManager->SetMenuKey(static_cast<SDLKey>(settings.ReadInt("menu")));
-	InputManager->SetSwapKey(static_cast<SDLKey>(settings.ReadInt("swap")));
-	InputManager->SetLeftSelectKey(static_cast<SDLKey>(settings.ReadInt("left_select")));
-	InputManager->SetRightSelectKey(static_cast<SDLKey>(settings.ReadInt("right_select")));
-	InputManager->SetPauseKey(static_cast<SDLKey>(settings.ReadInt("pause")));
-	settings.CloseTable();
-
-	if (settings.IsErrorDetected()) {
-		cerr << "SETTINGS LOAD ERROR: failure while trying to retrieve key map "
-			<< "information from file: " << GetSettingsFilename() << endl;
-		cerr << settings.GetErrorMessages() << endl;
-		return false;
-	}
-
-	settings.OpenTable("joystick_settings");
-	// TEMP: this is a hack to disable joystick input to fix a bug with "phantom" joysticks on certain systems.
-	// In the future it should call a method of the input engine to disable the joysticks.
-	if (settings.DoesBoolExist("input_disabled") && settings.ReadBool("input_disabled") == true) {
-		PRINT_DEBUG << "settings file specified to disable joystick input" << endl;
-		SDL_JoystickEventState(SDL_IGNORE);
-		SDL_QuitSubSystem(SDL_INIT_JOYSTICK);
-	}
-	InputManager->SetJoyIndex(static_cast<int32>(settings.ReadInt("index")));
-	InputManager->SetConfirmJoy(static_cast<uint8>(settings.ReadInt("confirm")));
-	InputManager->SetCancelJoy(static_cast<uint8>(settings.ReadInt("cancel")));
-	InputManager->SetMenuJoy(static_cast<uint8>(settings.ReadInt("menu")));
-	InputManager->SetSwapJoy(static_cast<uint8>(settings.ReadInt("swap")));
-	InputManager->SetLeftSelectJoy(static_cast<uint8>(settings.ReadInt("left_select")));
-	InputManager->SetRightSelectJoy(static_cast<uint8>(settings.ReadInt("right_select")));
-	InputManager->SetPauseJoy(static_cast<uint8>(settings.ReadInt("pause")));
-
-	InputManager->SetQuitJoy(static_cast<uint8>(settings.ReadInt("quit")));
-	if (settings.DoesIntExist("x_axis"))
-		InputManager->SetXAxisJoy(static_cast<int8>(settings.ReadInt("x_axis")));
-	if (settings.DoesIntExist("y_axis"))
-		InputManager->SetYAxisJoy(static_cast<int8>(settings.ReadInt("y_axis")));
-
-	// WinterKnight: These are hidden settings. You can change them by editing settings.lua,
-	// but they are not available in the options menu at this time.
-	if (settings.DoesIntExist("threshold"))
-		InputManager->SetThresholdJoy(static_cast<uint16>(settings.ReadInt("threshold")));
-
-	settings.CloseTable();
-
-	// battle_settings.timer_multiplier is also a hidden setting
-	if (settings.DoesTableExist("battle_settings")) {
-		settings.OpenTable("battle_settings");
-		// TEMP: I don't think that we should do this... - Roots
-// 		if (settings.DoesFloatExist("timer_multiplier"))
-// 			hoa_battle::timer_multiplier = static_cast<float>(settings.ReadFloat("timer_multiplier"));
-// 		if (settings.DoesBoolExist("wait"))
-// 			hoa_battle::wait = static_cast<bool>(settings.ReadBool("wait"));
-		settings.CloseTable();
-	}
-
-	if (settings.IsErrorDetected()) {
-		cerr << "SETTINGS LOAD ERROR: an error occured while trying to retrieve joystick mapping information "
-			<< "from file: " << GetSettingsFilename() << endl;
-		cerr << settings.GetErrorMessages() << endl;
-		return false;
-	}
-
-	// Load video settings
-	settings.OpenTable("video_settings");
-	bool fullscreen = settings.ReadBool("full_screen");
-	int32 resx = settings.ReadInt("screen_resx");
-	int32 resy = settings.ReadInt("screen_resy");
-	VideoManager->SetInitialResolution(resx, resy);
-	VideoManager->SetFullscreen(fullscreen);
-	settings.CloseTable();
-
-	if (settings.IsErrorDetected()) {
-		cerr << "SETTINGS LOAD ERROR: failure while trying to retrieve video settings "
-			<< "information from file: " << GetSettingsFilename() << endl;
-		cerr << settings.GetErrorMessages() << endl;
-		return false;
-	}
-
-	// Load Audio settings
-	if (AUDIO_ENABLE) {
-		settings.OpenTable("audio_settings");
-		AudioManager->SetMusicVolume(static_cast<float>(settings.ReadFloat("music_vol")));
-		AudioManager->SetSoundVolume(static_cast<float>(settings.ReadFloat("sound_vol")));
-	}
-	settings.CloseAllTables();
-
-	if (settings.IsErrorDetected()) {
-		cerr << "SETTINGS LOAD ERROR: failure while trying to retrieve audio settings "
-			<< "information from file: " << GetSettingsFilename() << endl;
-		cerr << settings.GetErrorMessages() << endl;
-		return false;
-	}
-
-	settings.CloseFile();
-
-	return true;
-} // bool LoadSettings()
-
-
-/** \brief Initializes all engine components and makes other preparations for the game to start
-*** \return True if the game engine was initialized successfully, false if an unrecoverable error occured
-**/
-void InitializeEngine() throw (Exception) {
-	// Initialize SDL. The video, audio, and joystick subsystems are initialized elsewhere.
-	if (SDL_Init(SDL_INIT_TIMER) != 0) {
-		throw Exception("MAIN ERROR: Unable to initialize SDL: ", __FILE__, __LINE__, __FUNCTION__);
-	}
-
-	// Create and initialize singleton class managers
-	AudioManager = AudioEngine::SingletonCreate();
-	InputManager = InputEngine::SingletonCreate();
-	ScriptManager = ScriptEngine::SingletonCreate();
-	VideoManager = VideoEngine::SingletonCreate();
-	SystemManager = SystemEngine::SingletonCreate();
-	ModeManager = ModeEngine::SingletonCreate();
-	GUIManager = GUISystem::SingletonCreate();
-	GlobalManager = GameGlobal::SingletonCreate();
-
-	// TODO: Open the user setting's file and apply those settings
-
-	if (VideoManager->SingletonInitialize() == false) {
-		throw Exception("ERROR: unable to initialize VideoManager", __FILE__, __LINE__, __FUNCTION__);
-	}
-
-	if (AudioManager->SingletonInitialize() == false) {
-		throw Exception("ERROR: unable to initialize AudioManager", __FILE__, __LINE__, __FUNCTION__);
-	}
-
-	if (ScriptManager->SingletonInitialize() == false) {
-		throw Exception("ERROR: unable to initialize ScriptManager", __FILE__, __LINE__, __FUNCTION__);
-	}
-
-	hoa_defs::BindEngineCode();
-	hoa_defs::BindCommonCode();
-	hoa_defs::BindModeCode();
-
-	if (SystemManager->SingletonInitialize() == false) {
-		throw Exception("ERROR: unable to initialize SystemManager", __FILE__, __LINE__, __FUNCTION__);
-	}
-	if (InputManager->SingletonInitialize() == false) {
-		throw Exception("ERROR: unable to initialize InputManager", __FILE__, __LINE__, __FUNCTION__);
-	}
-	if (ModeManager->SingletonInitialize() == false) {
-		throw Exception("ERROR: unable to initialize ModeManager", __FILE__, __LINE__, __FUNCTION__);
-	}
-	if (GlobalManager->SingletonInitialize() == false) {
-		throw Exception("ERROR: unable to initialize GlobalManager", __FILE__, __LINE__, __FUNCTION__);
-	}
-
-	// Set the window icon
-	#ifdef _WIN32
-		SDL_WM_SetIcon(IMG_Load("img/logos/program_icon.bmp"), NULL);
-	#else
-		SDL_WM_SetIcon(IMG_Load("img/logos/program_icon.png"), NULL);
-	#endif
-
-	// Load all the settings from lua. This includes some engine configuration settings.
-	if (LoadSettings() == false)
-		throw Exception("ERROR: Unable to load settings file", __FILE__, __LINE__, __FUNCTION__);
-
-	// Apply engine configuration settings with delayed initialization calls to the managers
-	InputManager->InitializeJoysticks();
-	if (VideoManager->ApplySettings() == false)
-		throw Exception("ERROR: Unable to apply video settings", __FILE__, __LINE__, __FUNCTION__);
-	if (VideoManager->FinalizeInitialization() == false)
-		throw Exception("ERROR: Unable to apply video settings", __FILE__, __LINE__, __FUNCTION__);
-	if (GUIManager->LoadMenuSkin("black_sleet", "img/menus/black_sleet_skin.png", "img/menus/black_sleet_texture.png") == false) {
-		throw Exception("Failed to load the 'Black Sleet' MenuSkin images.", __FILE__, __LINE__, __FUNCTION__);
-	}
-	// NOTE: This function call should have its argument set to false for release builds
-	GUIManager->DEBUG_EnableGUIOutlines(false);
-
-	// Load all standard font sets used across the game
-	if (VideoManager->Text()->LoadFont("img/fonts/libertine_capitals.ttf", "title20", 20) == false) {
-		throw Exception("Failed to load libertine_capitals.ttf font at size 20", __FILE__, __LINE__, __FUNCTION__);
-	}
-	if (VideoManager->Text()->LoadFont("img/fonts/libertine_capitals.ttf", "title22", 22) == false) {
-		throw Exception("Failed to load libertine_capitals.ttf font at size 22", __FILE__, __LINE__, __FUNCTION__);
-	}
-	if (VideoManager->Text()->LoadFont("img/fonts/libertine_capitals.ttf", "title24", 24) == false) {
-		throw Exception("Failed to load libertine_capitals.ttf font at size 24", __FILE__, __LINE__, __FUNCTION__);
-	}
-	if (VideoManager->Text()->LoadFont("img/fonts/libertine_capitals.ttf", "title28", 28) == false) {
-		throw Exception("Failed to load libertine_capitals.ttf font at size 28", __FILE__, __LINE__, __FUNCTION__);
-	}
-
-	if (VideoManager->Text()->LoadFont("img/fonts/libertine.ttf", "text18", 18) == false) {
-		throw Exception("Failed to load libertine.ttf font at size 18", __FILE__, __LINE__, __FUNCTION__);
-	}
-	if (VideoManager->Text()->LoadFont("img/fonts/libertine.ttf", "text20", 20) == false) {
-		throw Exception("Failed to load libertine.ttf font at size 20", __FILE__, __LINE__, __FUNCTION__);
-	}
-	if (VideoManager->Text()->LoadFont("img/fonts/libertine.ttf", "text22", 22) == false) {
-		throw Exception("Failed to load libertine.ttf font at size 22", __FILE__, __LINE__, __FUNCTION__);
-	}
-	if (VideoManager->Text()->LoadFont("img/fonts/libertine.ttf", "text24", 24) == false) {
-		throw Exception("Failed to load libertine.ttf font at size 24", __FILE__, __LINE__, __FUNCTION__);
-	}
-
-	VideoManager->Text()->SetDefaultStyle(TextStyle("text22", Color::white, VIDEO_TEXT_SHADOW_BLACK, 1, -2));
-
-	// Set the window title and icon name
-	SDL_WM_SetCaption(APPFULLNAME, APPFULLNAME);
-
-	// Hide the mouse cursor since we don't use or acknowledge mouse input from the user
-	SDL_ShowCursor(SDL_DISABLE);
-
-	// Enabled for multilingual keyboard support
-	SDL_EnableUNICODE(1);
-
-	// Ignore the events that we don't care about so they never appear in the event queue
-	SDL_EventState(SDL_MOUSEMOTION, SDL_IGNORE);
-	SDL_EventState(SDL_MOUSEBUTTONDOWN, SDL_IGNORE);
-	SDL_EventState(SDL_MOUSEBUTTONUP, SDL_IGNORE);
-	SDL_EventState(SDL_SYSWMEVENT, SDL_IGNORE);
-	SDL_EventState(SDL_VIDEOEXPOSE, SDL_IGNORE);
-	SDL_EventState(SDL_USEREVENT, SDL_IGNORE);
-
-	if (GUIManager->SingletonInitialize() == false) {
-		throw Exception("ERROR: unable to initialize GUIManager", __FILE__, __LINE__, __FUNCTION__);
-	}
-
-	SystemManager->InitializeTimers();
-} // void InitializeEngine()
-
-
 // Every great game begins with a single function :)
 int main(int argc, char *argv[]) {
 	// When the program exits, the QuitApp() function will be called first, followed by SDL_Quit()
 	atexit(SDL_Quit);
-	atexit(QuitApp);
+	atexit(hoa_main::QuitApp);
 
 	try {
 		// Change to the directory where the game data is stored
@@ -374,7 +97,7 @@ int main(int argc, char *argv[]) {
 		}
 
 		// Function call below throws exceptions if any errors occur
-		InitializeEngine();
+		hoa_main::InitializeEngine();
 
 	} catch (Exception& e) {
 		#ifdef WIN32
@@ -390,33 +113,66 @@ int main(int argc, char *argv[]) {
 	try {
 		// This is the main loop for the game. The loop iterates once for every frame drawn to the screen.
 		while (SystemManager->NotDone()) {
-		    // Update only every 10 milliseconds.
-		    SDL_Delay(10);
+			ProfilerManager->BeginFrame();
 
 			// 1) Render the scene
-			VideoManager->Clear();
-			ModeManager->Draw();
-			VideoManager->Draw();
-			ModeManager->DrawEffects();
-			ModeManager->DrawPostEffects();
-			// Swap the buffers once the draw operations are done.
-			SDL_GL_SwapBuffers();
+			{
+				PROFILE_ZONE("ModeManager->Draw");
+				VideoManager->Clear();
+				ModeManager->Draw();
+				ModeManager->DrawEffects();
+				ModeManager->DrawPostEffects();
+			}
+			{
+				PROFILE_ZONE("VideoManager->Draw");
+				// Draws the video engine debug info and submits the queued images
+				VideoManager->Draw();
+			}
+			{
+				PROFILE_ZONE("SDL_GL_SwapBuffers");
+				// Swap the buffers once the draw operations are done.
+				SystemManager->EndFrameDrawing();
+				SDL_GL_SwapBuffers();
+			}
+
+			// 2) Collect the Lua garbage, within the time left before the next frame
+			{
+				PROFILE_ZONE("ScriptManager->StepGarbageCollector");
+				ScriptManager->StepGarbageCollector(SystemManager->GetTimeUntilNextFrame());
+			}
 
-			// Update timers for correct time-based movement operation
-			SystemManager->UpdateTimers();
+			// 3) Wait for the next frame, depending on the frame pacing
+			{
+				PROFILE_ZONE("SystemManager->WaitForNextFrame");
+				SystemManager->WaitForNextFrame();
+			}
 
-			// Process all new events
-			InputManager->EventHandler();
+			// 4) Update the game by fixed steps until it catches up with the time elapsed
+			while (SystemManager->NextUpdateStep()) {
+				// Update timers for correct time-based movement operation
+				SystemManager->UpdateTimers();
 
-			// Update video
-			VideoManager->Update();
+				// Process all new events
+				{
+					PROFILE_ZONE("InputManager->EventHandler");
+					InputManager->EventHandler();
+				}
 
-			// Update any streaming audio sources
-			AudioManager->Update();
+				// Update video
+				VideoManager->Update();
 
-			// Update the game status
-			ModeManager->Update();
+				// Update any streaming audio sources
+				{
+					PROFILE_ZONE("AudioManager->Update");
+					AudioManager->Update();
+				}
 
+				// Update the game status
+				{
+					PROFILE_ZONE("ModeManager->Update");
+					ModeManager->Update();
+				}
+			}
 		} // while (SystemManager->NotDone())
 	} catch (Exception& e) {
 		#ifdef WIN32
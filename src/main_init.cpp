@@ -0,0 +1,347 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2010 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file    main_init.cpp
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Initialization and destruction of the engine components
+*** **************************************************************************/
+
+#include "engine/audio/audio.h"
+#include "engine/input.h"
+#include "engine/mode_manager.h"
+#include "engine/profiler.h"
+#include "engine/video/video.h"
+#include "engine/system.h"
+
+#include "common/global/global.h"
+#include "common/gui/gui.h"
+
+#include "main_init.h"
+
+#include <SDL_image.h>
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_audio;
+using namespace hoa_video;
+using namespace hoa_gui;
+using namespace hoa_mode_manager;
+using namespace hoa_input;
+using namespace hoa_system;
+using namespace hoa_global;
+using namespace hoa_script;
+
+namespace hoa_main {
+
+void QuitApp() {
+	// NOTE: Even if the singleton objects do not exist when this function is called, invoking the
+	// static Destroy() singleton function will do no harm (it checks that the object exists before deleting it).
+
+	// Delete the mode manager first so that all game modes free their resources
+	ModeEngine::SingletonDestroy();
+
+	// Delete the global manager second to remove all object references corresponding to other engine subsystems
+	GameGlobal::SingletonDestroy();
+
+	// Delete all of the reamining independent engine components
+	GUISystem::SingletonDestroy();
+	AudioEngine::SingletonDestroy();
+	InputEngine::SingletonDestroy();
+	ScriptEngine::SingletonDestroy();
+	SystemEngine::SingletonDestroy();
+	VideoEngine::SingletonDestroy();
+
+	// Delete the profiler last, as the other components may still record profile zones until they are deleted
+	ProfilerEngine::SingletonDestroy();
+} // void QuitApp()
+
+
+
+bool LoadSettings()
+{
+	ReadScriptDescriptor settings;
+	if (settings.OpenFile(GetSettingsFilename()) == false)
+		return false;
+
+	settings.OpenTable("settings");
+
+	// Load language settings
+	SystemManager->SetLanguage(static_cast<std::string>(settings.ReadString("language")));
+
+	settings.OpenTable("key_settings");
+	InputManager->SetUpKey(static_cast<SDLKey>(settings.ReadInt("up")));
+	InputManager->SetDownKey(static_cast<SDLKey>(settings.ReadInt("down")));
+	InputManager->SetLeftKey(static_cast<SDLKey>(settings.ReadInt("left")));
+	InputManager->SetRightKey(static_cast<SDLKey>(settings.ReadInt("right")));
+	InputManager->SetConfirmKey(static_cast<SDLKey>(settings.ReadInt("confirm")));
+	InputManager->SetCancelKey(static_cast<SDLKey>(settings.ReadInt("cancel")));
+	InputManager->SetMenuKey(static_cast<SDLKey>(settings.ReadInt("menu")));
+	InputManager->SetSwapKey(static_cast<SDLKey>(settings.ReadInt("swap")));
+	InputManager->SetLeftSelectKey(static_cast<SDLKey>(settings.ReadInt("left_select")));
+	InputManager->SetRightSelectKey(static_cast<SDLKey>(settings.ReadInt("right_select")));
+	InputManager->SetPauseKey(static_cast<SDLKey>(settings.ReadInt("pause")));
+	settings.CloseTable();
+
+	if (settings.IsErrorDetected()) {
+		cerr << "SETTINGS LOAD ERROR: failure while trying to retrieve key map "
+			<< "information from file: " << GetSettingsFilename() << endl;
+		cerr << settings.GetErrorMessages() << endl;
+		return false;
+	}
+
+	settings.OpenTable("joystick_settings");
+	// TEMP: this is a hack to disable joystick input to fix a bug with "phantom" joysticks on certain systems.
+	// In the future it should call a method of the input engine to disable the joysticks.
+	if (settings.DoesBoolExist("input_disabled") && settings.ReadBool("input_disabled") == true) {
+		PRINT_DEBUG << "settings file specified to disable joystick input" << endl;
+		SDL_JoystickEventState(SDL_IGNORE);
+		SDL_QuitSubSystem(SDL_INIT_JOYSTICK);
+	}
+	InputManager->SetJoyIndex(static_cast<int32>(settings.ReadInt("index")));
+	InputManager->SetConfirmJoy(static_cast<uint8>(settings.ReadInt("confirm")));
+	InputManager->SetCancelJoy(static_cast<uint8>(settings.ReadInt("cancel")));
+	InputManager->SetMenuJoy(static_cast<uint8>(settings.ReadInt("menu")));
+	InputManager->SetSwapJoy(static_cast<uint8>(settings.ReadInt("swap")));
+	InputManager->SetLeftSelectJoy(static_cast<uint8>(settings.ReadInt("left_select")));
+	InputManager->SetRightSelectJoy(static_cast<uint8>(settings.ReadInt("right_select")));
+	InputManager->SetPauseJoy(static_cast<uint8>(settings.ReadInt("pause")));
+
+	InputManager->SetQuitJoy(static_cast<uint8>(settings.ReadInt("quit")));
+	if (settings.DoesIntExist("x_axis"))
+		InputManager->SetXAxisJoy(static_cast<int8>(settings.ReadInt("x_axis")));
+	if (settings.DoesIntExist("y_axis"))
+		InputManager->SetYAxisJoy(static_cast<int8>(settings.ReadInt("y_axis")));
+
+	// WinterKnight: These are hidden settings. You can change them by editing settings.lua,
+	// but they are not available in the options menu at this time.
+	if (settings.DoesIntExist("threshold"))
+		InputManager->SetThresholdJoy(static_cast<uint16>(settings.ReadInt("threshold")));
+
+	settings.CloseTable();
+
+	// battle_settings.timer_multiplier is also a hidden setting
+	if (settings.DoesTableExist("battle_settings")) {
+		settings.OpenTable("battle_settings");
+		// TEMP: I don't think that we should do this... - Roots
+// 		if (settings.DoesFloatExist("timer_multiplier"))
+// 			hoa_battle::timer_multiplier = static_cast<float>(settings.ReadFloat("timer_multiplier"));
+// 		if (settings.DoesBoolExist("wait"))
+// 			hoa_battle::wait = static_cast<bool>(settings.ReadBool("wait"));
+		settings.CloseTable();
+	}
+
+	if (settings.IsErrorDetected()) {
+		cerr << "SETTINGS LOAD ERROR: an error occured while trying to retrieve joystick mapping information "
+			<< "from file: " << GetSettingsFilename() << endl;
+		cerr << settings.GetErrorMessages() << endl;
+		return false;
+	}
+
+	// Load video settings
+	settings.OpenTable("video_settings");
+	bool fullscreen = settings.ReadBool("full_screen");
+	int32 resx = settings.ReadInt("screen_resx");
+	int32 resy = settings.ReadInt("screen_resy");
+	VideoManager->SetInitialResolution(resx, resy);
+	VideoManager->SetFullscreen(fullscreen);
+
+	// Optional frame pacing settings: "vsync", "fps" or "uncapped"
+	if (settings.DoesStringExist("frame_pacing")) {
+		std::string frame_pacing = settings.ReadString("frame_pacing");
+		uint32 target_fps = settings.DoesUIntExist("target_fps") ? settings.ReadUInt("target_fps") : 60;
+		if (frame_pacing == "vsync") {
+			SystemManager->SetFramePacing(FRAME_PACING_VSYNC, target_fps);
+		}
+		else if (frame_pacing == "fps") {
+			SystemManager->SetFramePacing(FRAME_PACING_TARGET_FPS, target_fps);
+		}
+		else if (frame_pacing == "uncapped") {
+			SystemManager->SetFramePacing(FRAME_PACING_UNCAPPED, target_fps);
+		}
+		else {
+			cerr << "SETTINGS LOAD WARNING: unknown frame pacing: " << frame_pacing << endl;
+		}
+		VideoManager->SetVSync(SystemManager->GetFramePacing() == FRAME_PACING_VSYNC);
+	}
+
+	// Optional time given to the Lua garbage collector on each frame, in milliseconds
+	if (settings.DoesFloatExist("gc_budget"))
+		ScriptManager->SetGarbageCollectorBudget(settings.ReadFloat("gc_budget"));
+	settings.CloseTable();
+
+	if (settings.IsErrorDetected()) {
+		cerr << "SETTINGS LOAD ERROR: failure while trying to retrieve video settings "
+			<< "information from file: " << GetSettingsFilename() << endl;
+		cerr << settings.GetErrorMessages() << endl;
+		return false;
+	}
+
+	// Load Audio settings
+	if (AUDIO_ENABLE) {
+		settings.OpenTable("audio_settings");
+		AudioManager->SetMusicVolume(static_cast<float>(settings.ReadFloat("music_vol")));
+		AudioManager->SetSoundVolume(static_cast<float>(settings.ReadFloat("sound_vol")));
+
+		// Optional streaming settings
+		if (settings.DoesUIntExist("stream_buffer_count"))
+			AudioManager->SetStreamingBufferCount(settings.ReadUInt("stream_buffer_count"));
+		if (settings.DoesUIntExist("stream_buffer_size"))
+			AudioManager->SetStreamingBufferSize(settings.ReadUInt("stream_buffer_size"));
+		if (settings.DoesUIntExist("stream_decoded_buffers"))
+			AudioManager->SetStreamingDecodedBufferCount(settings.ReadUInt("stream_decoded_buffers"));
+
+		// Optional audio cache size, in bytes
+		if (settings.DoesUIntExist("cache_size"))
+			AudioManager->SetCacheSize(settings.ReadUInt("cache_size"));
+	}
+	settings.CloseAllTables();
+
+	if (settings.IsErrorDetected()) {
+		cerr << "SETTINGS LOAD ERROR: failure while trying to retrieve audio settings "
+			<< "information from file: " << GetSettingsFilename() << endl;
+		cerr << settings.GetErrorMessages() << endl;
+		return false;
+	}
+
+	settings.CloseFile();
+
+	return true;
+} // bool LoadSettings()
+
+
+
+void InitializeEngine() throw (Exception) {
+	// Initialize SDL. The video, audio, and joystick subsystems are initialized elsewhere.
+	if (SDL_Init(SDL_INIT_TIMER) != 0) {
+		throw Exception("MAIN ERROR: Unable to initialize SDL: ", __FILE__, __LINE__, __FUNCTION__);
+	}
+
+	// Create and initialize singleton class managers
+	ProfilerManager = ProfilerEngine::SingletonCreate();
+	AudioManager = AudioEngine::SingletonCreate();
+	InputManager = InputEngine::SingletonCreate();
+	ScriptManager = ScriptEngine::SingletonCreate();
+	VideoManager = VideoEngine::SingletonCreate();
+	SystemManager = SystemEngine::SingletonCreate();
+	ModeManager = ModeEngine::SingletonCreate();
+	GUIManager = GUISystem::SingletonCreate();
+	GlobalManager = GameGlobal::SingletonCreate();
+
+	// TODO: Open the user setting's file and apply those settings
+
+	if (VideoManager->SingletonInitialize() == false) {
+		throw Exception("ERROR: unable to initialize VideoManager", __FILE__, __LINE__, __FUNCTION__);
+	}
+
+	if (AudioManager->SingletonInitialize() == false) {
+		throw Exception("ERROR: unable to initialize AudioManager", __FILE__, __LINE__, __FUNCTION__);
+	}
+
+	if (ScriptManager->SingletonInitialize() == false) {
+		throw Exception("ERROR: unable to initialize ScriptManager", __FILE__, __LINE__, __FUNCTION__);
+	}
+
+	hoa_defs::BindEngineCode();
+	hoa_defs::BindCommonCode();
+	hoa_defs::BindModeCode();
+
+	if (SystemManager->SingletonInitialize() == false) {
+		throw Exception("ERROR: unable to initialize SystemManager", __FILE__, __LINE__, __FUNCTION__);
+	}
+	if (ProfilerManager->SingletonInitialize() == false) {
+		throw Exception("ERROR: unable to initialize ProfilerManager", __FILE__, __LINE__, __FUNCTION__);
+	}
+	if (InputManager->SingletonInitialize() == false) {
+		throw Exception("ERROR: unable to initialize InputManager", __FILE__, __LINE__, __FUNCTION__);
+	}
+	if (ModeManager->SingletonInitialize() == false) {
+		throw Exception("ERROR: unable to initialize ModeManager", __FILE__, __LINE__, __FUNCTION__);
+	}
+	if (GlobalManager->SingletonInitialize() == false) {
+		throw Exception("ERROR: unable to initialize GlobalManager", __FILE__, __LINE__, __FUNCTION__);
+	}
+
+	// Set the window icon
+	#ifdef _WIN32
+		SDL_WM_SetIcon(IMG_Load("img/logos/program_icon.bmp"), NULL);
+	#else
+		SDL_WM_SetIcon(IMG_Load("img/logos/program_icon.png"), NULL);
+	#endif
+
+	// Load all the settings from lua. This includes some engine configuration settings.
+	if (LoadSettings() == false)
+		throw Exception("ERROR: Unable to load settings file", __FILE__, __LINE__, __FUNCTION__);
+
+	// Apply engine configuration settings with delayed initialization calls to the managers
+	InputManager->InitializeJoysticks();
+	if (VideoManager->ApplySettings() == false)
+		throw Exception("ERROR: Unable to apply video settings", __FILE__, __LINE__, __FUNCTION__);
+	if (VideoManager->FinalizeInitialization() == false)
+		throw Exception("ERROR: Unable to apply video settings", __FILE__, __LINE__, __FUNCTION__);
+	if (GUIManager->LoadMenuSkin("black_sleet", "img/menus/black_sleet_skin.png", "img/menus/black_sleet_texture.png") == false) {
+		throw Exception("Failed to load the 'Black Sleet' MenuSkin images.", __FILE__, __LINE__, __FUNCTION__);
+	}
+	// NOTE: This function call should have its argument set to false for release builds
+	GUIManager->DEBUG_EnableGUIOutlines(false);
+
+	// Load all standard font sets used across the game
+	if (VideoManager->Text()->LoadFont("img/fonts/libertine_capitals.ttf", "title20", 20) == false) {
+		throw Exception("Failed to load libertine_capitals.ttf font at size 20", __FILE__, __LINE__, __FUNCTION__);
+	}
+	if (VideoManager->Text()->LoadFont("img/fonts/libertine_capitals.ttf", "title22", 22) == false) {
+		throw Exception("Failed to load libertine_capitals.ttf font at size 22", __FILE__, __LINE__, __FUNCTION__);
+	}
+	if (VideoManager->Text()->LoadFont("img/fonts/libertine_capitals.ttf", "title24", 24) == false) {
+		throw Exception("Failed to load libertine_capitals.ttf font at size 24", __FILE__, __LINE__, __FUNCTION__);
+	}
+	if (VideoManager->Text()->LoadFont("img/fonts/libertine_capitals.ttf", "title28", 28) == false) {
+		throw Exception("Failed to load libertine_capitals.ttf font at size 28", __FILE__, __LINE__, __FUNCTION__);
+	}
+
+	if (VideoManager->Text()->LoadFont("img/fonts/libertine.ttf", "text18", 18) == false) {
+		throw Exception("Failed to load libertine.ttf font at size 18", __FILE__, __LINE__, __FUNCTION__);
+	}
+	if (VideoManager->Text()->LoadFont("img/fonts/libertine.ttf", "text20", 20) == false) {
+		throw Exception("Failed to load libertine.ttf font at size 20", __FILE__, __LINE__, __FUNCTION__);
+	}
+	if (VideoManager->Text()->LoadFont("img/fonts/libertine.ttf", "text22", 22) == false) {
+		throw Exception("Failed to load libertine.ttf font at size 22", __FILE__, __LINE__, __FUNCTION__);
+	}
+	if (VideoManager->Text()->LoadFont("img/fonts/libertine.ttf", "text24", 24) == false) {
+		throw Exception("Failed to load libertine.ttf font at size 24", __FILE__, __LINE__, __FUNCTION__);
+	}
+
+	VideoManager->Text()->SetDefaultStyle(TextStyle("text22", Color::white, VIDEO_TEXT_SHADOW_BLACK, 1, -2));
+
+	// Set the window title and icon name
+	SDL_WM_SetCaption(APPFULLNAME, APPFULLNAME);
+
+	// Hide the mouse cursor since we don't use or acknowledge mouse input from the user
+	SDL_ShowCursor(SDL_DISABLE);
+
+	// Enabled for multilingual keyboard support
+	SDL_EnableUNICODE(1);
+
+	// Ignore the events that we don't care about so they never appear in the event queue
+	SDL_EventState(SDL_MOUSEMOTION, SDL_IGNORE);
+	SDL_EventState(SDL_MOUSEBUTTONDOWN, SDL_IGNORE);
+	SDL_EventState(SDL_MOUSEBUTTONUP, SDL_IGNORE);
+	SDL_EventState(SDL_SYSWMEVENT, SDL_IGNORE);
+	SDL_EventState(SDL_VIDEOEXPOSE, SDL_IGNORE);
+	SDL_EventState(SDL_USEREVENT, SDL_IGNORE);
+
+	if (GUIManager->SingletonInitialize() == false) {
+		throw Exception("ERROR: unable to initialize GUIManager", __FILE__, __LINE__, __FUNCTION__);
+	}
+
+	SystemManager->InitializeTimers();
+} // void InitializeEngine()
+
+} // namespace hoa_main
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2010 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file    main_init.h
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Header file for the initialization and destruction of the engine components
+*** \note    Only the main() functions of the game and of the test program should need to include this file.
+*** **************************************************************************/
+
+#ifndef __MAIN_INIT_HEADER__
+#define __MAIN_INIT_HEADER__
+
+#include "utils.h"
+
+namespace hoa_main {
+
+/** \brief Frees all data allocated by the game by destroying the singleton classes
+***
+*** \note <b>Do not attempt to call or otherwise reference this function.</b>
+*** It is for use in the main() functions of the game and of the test program only.
+***
+*** Deleteing the singleton class objects will free all of the memory that the game uses.
+*** This is because all other classes and data structures in the game are managed
+*** by these singletons either directly or in directly. For example, BattleMode is a
+*** class object that is managed by the ModeEngine class, and thus the GameModeManager
+*** destructor will also invoke the BattleMode destructor (as well as the destructors of any
+*** other game modes that exist).
+**/
+void QuitApp();
+
+/** \brief Reads in all of the saved game settings and sets values in the according game manager classes
+*** \return True if the settings were loaded successfully
+**/
+bool LoadSettings();
+
+/** \brief Initializes all engine components and makes other preparations for the game to start
+*** \throw Exception if an unrecoverable error occured
+**/
+void InitializeEngine() throw (hoa_utils::Exception);
+
+} // namespace hoa_main
+
+#endif // __MAIN_INIT_HEADER__
@@ -67,7 +67,13 @@ const char* DEFAULT_VICTORY_MUSIC  = "mus/Fanfare.ogg";
 const char* DEFAULT_DEFEAT_MUSIC   = "mus/Intermission.ogg";
 //@}
 
+//! \brief The texture atlas holding the battle interface images
+const char* BATTLE_ATLAS_FILENAME  = "img/atlases/battle.vta";
+
 BattleMedia::BattleMedia() {
+	// Loaded first, so that the images below are taken from the atlas when it exists
+	TextureManager->LoadAtlas(BATTLE_ATLAS_FILENAME);
+
 	if (!background_image.Load("img/backdrops/battle/desert_cave/desert_cave.png"))
 		PRINT_ERROR << "failed to load default background image" << endl;
 
@@ -166,6 +172,8 @@ BattleMedia::~BattleMedia() {
 	battle_music.FreeAudio();
 	victory_music.FreeAudio();
 	defeat_music.FreeAudio();
+
+	TextureManager->UnloadAtlas(BATTLE_ATLAS_FILENAME);
 }
 
 
@@ -329,6 +337,11 @@ void BattleMode::Reset() {
 
 	if (_state == BATTLE_STATE_INVALID) {
 		_Initialize();
+
+		// Fill the holes left in the texture sheets by the map, now that the battle images are loaded,
+		// and collect the garbage left by the battle setup before the first frame is drawn
+		TextureManager->DefragmentTexSheets();
+		ScriptManager->CollectAllGarbage();
 	}
 
 	UnFreezeTimers();
@@ -772,6 +785,7 @@ void BattleMode::_Initialize() {
 
 	// (2): Determine the origin position for all characters and enemies
 	_DetermineActorLocations();
+	_PreloadSkillSounds();
 
 	// (3): Find the actor with the highext agility rating
 	uint32 highest_agility = 0;
@@ -852,6 +866,24 @@ void BattleMode::_Initialize() {
 
 
 
+void BattleMode::_PreloadSkillSounds() {
+	std::vector<BattleActor*> actors(_character_actors.begin(), _character_actors.end());
+	actors.insert(actors.end(), _enemy_actors.begin(), _enemy_actors.end());
+
+	for (uint32 i = 0; i < actors.size(); ++i) {
+		const std::map<uint32, GlobalSkill*>& skills = actors[i]->GetGlobalActor()->GetSkills();
+		for (std::map<uint32, GlobalSkill*>::const_iterator it = skills.begin(); it != skills.end(); ++it) {
+			const std::vector<std::string>& sounds = it->second->GetSoundFilenames();
+			for (uint32 j = 0; j < sounds.size(); ++j) {
+				if (!AudioManager->PreloadSound(sounds[j], this))
+					IF_PRINT_WARNING(BATTLE_DEBUG) << "failed to load skill sound: " << sounds[j] << endl;
+			}
+		}
+	}
+}
+
+
+
 void BattleMode::_DetermineActorLocations() {
 	// Temporary static positions for enemies
 	const float TEMP_ENEMY_LOCATIONS[][2] = {
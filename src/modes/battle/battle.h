@@ -440,6 +440,9 @@ private:
 	**/
 	void _DetermineActorLocations();
 
+	//! \brief Loads the sounds of the actors skills in the background, while the battle fades in
+	void _PreloadSkillSounds();
+
 	//! \brief Returns the number of enemies that are still alive in the battle
 	uint32 _NumberEnemiesAlive() const;
 
@@ -475,19 +475,14 @@ float BattleActor::TotalEvadeRating() {
 BattleCharacter::BattleCharacter(GlobalCharacter* character) :
 	BattleActor(character),
 	_global_character(character),
-	_last_rendered_hp(0),
-	_last_rendered_sp(0),
 	_sprite_animation_alias("idle")
 {
-	_last_rendered_hp = GetHitPoints();
-	_last_rendered_sp = GetSkillPoints();
-
 	_name_text.SetStyle(TextStyle("title22"));
 	_name_text.SetText(GetName());
 	_hit_points_text.SetStyle(TextStyle("text24", VIDEO_TEXT_SHADOW_BLACK));
-	_hit_points_text.SetText(NumberToString(_last_rendered_hp));
+	_hit_points_text.SetNumber(GetHitPoints());
 	_skill_points_text.SetStyle(TextStyle("text24", VIDEO_TEXT_SHADOW_BLACK));
-	_skill_points_text.SetText(NumberToString(_last_rendered_sp));
+	_skill_points_text.SetNumber(GetSkillPoints());
 
 	_action_selection_text.SetStyle(TextStyle("text20"));
 	_action_selection_text.SetText("");
@@ -794,22 +789,10 @@ void BattleCharacter::DrawStatus(uint32 order) {
 		VideoManager->MoveRelative(110.0f, 0.0f);
 		_skill_points_text.Draw();
 
-		// TODO: The SetText calls below should not be done here. They should be made whenever the character's HP/SP
-		// is modified. This re-renders the text every frame regardless of whether or not the HP/SP changed so its
-		// not efficient
-
 		// Update hit and skill points after drawing to reduce gpu stall
-		if (_last_rendered_hp != GetHitPoints())
-		{
-			_last_rendered_hp = GetHitPoints();
-			_hit_points_text.SetText(NumberToString(_last_rendered_hp));
-		}
-
-		if (_last_rendered_sp != GetSkillPoints())
-		{
-			_last_rendered_sp = GetSkillPoints();
-			_skill_points_text.SetText(NumberToString(_last_rendered_sp));
-		}
+		// The texts are only rendered again when the points change
+		_hit_points_text.SetNumber(GetHitPoints());
+		_skill_points_text.SetNumber(GetSkillPoints());
 	}
 
 	// Note: if the command menu is visible, it will be drawn over all of the components that follow below. We still perform these draw calls
@@ -390,22 +390,22 @@ void IndicatorSupervisor::AddDamageIndicator(uint32 amount) {
 
 	float damage_percent = static_cast<float>(amount) / static_cast<float>(_actor->GetMaxHitPoints());
 	if (damage_percent < 0.10f) {
-		style.font = "text24";
+		style.SetFont("text24");
 		style.color = low_red;
 		style.shadow_style = VIDEO_TEXT_SHADOW_BLACK;
 	}
 	else if (damage_percent < 0.20f) {
-		style.font = "text24";
+		style.SetFont("text24");
 		style.color = mid_red;
 		style.shadow_style = VIDEO_TEXT_SHADOW_BLACK;
 	}
 	else if (damage_percent < 0.30f) {
-		style.font = "text24";
+		style.SetFont("text24");
 		style.color = high_red;
 		style.shadow_style = VIDEO_TEXT_SHADOW_BLACK;
 	}
 	else { // (damage_percent >= 0.30f)
-		style.font = "text24";
+		style.SetFont("text24");
 		style.color = full_red;
 		style.shadow_style = VIDEO_TEXT_SHADOW_BLACK;
 	}
@@ -436,22 +436,22 @@ void IndicatorSupervisor::AddHealingIndicator(uint32 amount, bool hit_points) {
 	// bug in rendering colored text that needs to be addressed first.
 	float healing_percent = static_cast<float>(amount / _actor->GetMaxHitPoints());
 	if (healing_percent < 0.10f) {
-		style.font = "text24";
+		style.SetFont("text24");
 		style.color = hit_points ? low_green : low_blue;
 		style.shadow_style = VIDEO_TEXT_SHADOW_BLACK;
 	}
 	else if (healing_percent < 0.20f) {
-		style.font = "text24";
+		style.SetFont("text24");
 		style.color = hit_points ? mid_green : mid_blue;
 		style.shadow_style = VIDEO_TEXT_SHADOW_BLACK;
 	}
 	else if (healing_percent < 0.30f) {
-		style.font = "text24";
+		style.SetFont("text24");
 		style.color = hit_points ? high_green : high_blue;
 		style.shadow_style = VIDEO_TEXT_SHADOW_BLACK;
 	}
 	else { // (healing_percent >= 0.30f)
-		style.font = "text24";
+		style.SetFont("text24");
 		style.color = hit_points ? Color::green : Color::blue;
 		style.shadow_style = VIDEO_TEXT_SHADOW_BLACK;
 	}
@@ -475,9 +475,9 @@ void BootMode::_SetupMainMenu() {
 	}
 
 	// Preload main sounds
-	AudioManager->LoadSound("snd/confirm.wav", this);
-	AudioManager->LoadSound("snd/cancel.wav", this);
-	AudioManager->LoadSound("snd/bump.wav", this);
+	AudioManager->PreloadSound("snd/confirm.wav", this);
+	AudioManager->PreloadSound("snd/cancel.wav", this);
+	AudioManager->PreloadSound("snd/bump.wav", this);
 }
 
 
@@ -544,7 +544,7 @@ void BootMode::_SetupAudioOptionsMenu() {
 	_audio_options_menu.SetSelection(0);
 
 	// Preload test sound
-	AudioManager->LoadSound("snd/volume_test.wav", this);
+	AudioManager->PreloadSound("snd/volume_test.wav", this);
 }
 
 
@@ -1066,6 +1066,9 @@ void BootMode::_OnLanguageSelect() {
 
 	// Reload all the translatable text in the boot menus.
 	_ReloadTranslatableMenus();
+
+	// The actor names are translated when their definitions are read
+	GlobalManager->ReloadActorDefinitions();
 }
 
 
@@ -17,6 +17,7 @@
 
 #include "engine/audio/audio.h"
 #include "engine/input.h"
+#include "engine/profiler.h"
 #include "engine/system.h"
 
 #include "common/global/global.h"
@@ -26,6 +27,7 @@
 #include "modes/boot/boot.h"
 #include "modes/save/save_mode.h"
 
+#include "modes/map/map_compiled.h"
 #include "modes/map/map_dialogue.h"
 #include "modes/map/map_events.h"
 #include "modes/map/map_objects.h"
@@ -58,7 +60,7 @@ MapMode* MapMode::_current_instance = NULL;
 // ********** MapMode Public Class Methods
 // ****************************************************************************
 
-MapMode::MapMode(const std::string& filename) :
+MapMode::MapMode(const std::string& filename, TileSupervisor* tile_supervisor) :
 	GameMode(),
 	_map_filename(filename),
 	_map_tablespace(""),
@@ -81,6 +83,9 @@ MapMode::MapMode(const std::string& filename) :
 	mode_type = MODE_MANAGER_MAP_MODE;
 	_current_instance = this;
 
+	// Makes the images baked in the map atlas available without loading their file
+	TextureManager->LoadAtlas(GetMapAtlasFilename(_map_filename));
+
 	ResetState();
 	PushState(STATE_EXPLORE);
 
@@ -112,7 +117,7 @@ MapMode::MapMode(const std::string& filename) :
 	for (uint32 i = 0; i < inactive_save_point_animations.size(); ++i)
 		ScaleToMapCoords(inactive_save_point_animations[i]);
 
-	_tile_supervisor = new TileSupervisor();
+	_tile_supervisor = (tile_supervisor != NULL) ? tile_supervisor : new TileSupervisor();
 	_object_supervisor = new ObjectSupervisor();
 	_event_supervisor = new EventSupervisor();
 	_dialogue_supervisor = new DialogueSupervisor();
@@ -159,6 +164,9 @@ MapMode::~MapMode() {
 	delete(_dialogue_supervisor);
 	delete(_treasure_supervisor);
 
+	// The atlas textures still used by other modes are kept until they are released
+	TextureManager->UnloadAtlas(GetMapAtlasFilename(_map_filename));
+
 	_map_script.CloseFile();
 }
 
@@ -256,6 +264,12 @@ void MapMode::Update() {
 
 
 void MapMode::Draw() {
+	// The frame is drawn in between two update steps, so the camera position is interpolated again.
+	// When another mode is on top, the map isn't updated and is drawn still.
+	if (ModeManager->GetTop() != this)
+		_object_supervisor->SavePreviousPositions();
+	_UpdateMapFrame();
+
 	VideoManager->SetStandardCoordSys();
 	GetScriptSupervisor().DrawBackground();
 
@@ -340,6 +354,7 @@ void MapMode::AddGroundObject(MapObject *obj) {
 		return;
 	}
 	_object_supervisor->_ground_objects.push_back(obj);
+	_object_supervisor->_ground_object_grid.AddObject(obj);
 	_object_supervisor->_all_objects.insert(make_pair(obj->object_id, obj));
 }
 
@@ -360,6 +375,7 @@ void MapMode::AddSkyObject(MapObject *obj) {
 		return;
 	}
 	_object_supervisor->_sky_objects.push_back(obj);
+	_object_supervisor->_sky_object_grid.AddObject(obj);
 	_object_supervisor->_all_objects.insert(make_pair(obj->object_id, obj));
 }
 
@@ -486,14 +502,21 @@ bool MapMode::_Load() {
 	if (!map_filename.empty() && !_map_image.Load(_map_script.ReadString("map_image_filename")))
 		PRINT_ERROR << "Failed to load location graphic image: " << _map_image.GetFilename() << endl;
 
+	// The tile and collision data are read from the compiled map file when it is up to date
+	CompiledMap map_data;
+	if (!map_data.Load(_map_script)) {
+		PRINT_ERROR << "Failed to load the map data of: " << _map_filename << endl;
+		return false;
+	}
+
 	// Instruct the supervisor classes to perform their portion of the load operation
-	if (!_tile_supervisor->Load(_map_script)) {
+	// NOTE: The tiles may already have been loaded by the map loading mode.
+	if (!_tile_supervisor->IsLoaded() && !_tile_supervisor->Load(map_data)) {
 		PRINT_ERROR << "Failed to load the tile data." << endl;
 		return false;
 	}
 
-	// NOTE: The object supervisor will complain itself about the error.
-	if (!_object_supervisor->Load(_map_script))
+	if (!_object_supervisor->Load(map_data))
 		return false;
 
 	// Load map default music
@@ -502,6 +525,16 @@ bool MapMode::_Load() {
 	if (!AudioManager->LoadMusic(_music_filename, this))
 		PRINT_WARNING << "Failed to load map music: " << _music_filename << endl;
 
+	// Load the sounds played by the map scripts in the background, while the map fades in
+	if (_map_script.DoesTableExist("sound_filenames")) {
+		std::vector<std::string> sound_filenames;
+		_map_script.ReadStringVector("sound_filenames", sound_filenames);
+		for (uint32 i = 0; i < sound_filenames.size(); ++i) {
+			if (!AudioManager->PreloadSound(sound_filenames[i], this))
+				PRINT_WARNING << "Failed to load map sound: " << sound_filenames[i] << endl;
+		}
+	}
+
 
 	// Create and store all enemies that may appear on this map
 	std::vector<int32> enemy_ids;
@@ -562,6 +595,8 @@ bool MapMode::_Load() {
 
 
 void MapMode::_UpdateExplore() {
+	PROFILE_ZONE("MapMode::_UpdateExplore");
+
 	// First go to menu mode if the user requested it
 	if (InputManager->MenuPress()) {
 		MenuMode *MM = new MenuMode(_map_hud_name, _map_image.GetFilename());
@@ -682,14 +717,16 @@ void MapMode::_UpdateMapFrame() {
 	// However, we've discussed the possiblity of adding a zoom feature to maps, in which case we need to continually re-calculate the pixel size
 	VideoManager->GetPixelSize(x_pixel_length, y_pixel_length);
 
+	// The camera is drawn between its last two positions, like the other objects
+	MapPosition camera_position = _camera->GetDrawPosition();
 	float path_x, path_y = 0.0f;
 	if (!_camera_timer.IsRunning()) {
-		path_x = _camera->GetXPosition();
-		path_y = _camera->GetYPosition();
+		path_x = camera_position.x;
+		path_y = camera_position.y;
 	}
 	else {
-		path_x = _camera->GetXPosition()+(1-_camera_timer.PercentComplete())*_delta_x;
-		path_y = _camera->GetYPosition()+(1-_camera_timer.PercentComplete())*_delta_y;
+		path_x = camera_position.x+(1-_camera_timer.PercentComplete())*_delta_x;
+		path_y = camera_position.y+(1-_camera_timer.PercentComplete())*_delta_y;
 	}
 
 	current_x = GetFloatInteger(path_x);
@@ -81,8 +81,10 @@ class MapMode : public hoa_mode_manager::GameMode {
 	friend void hoa_defs::BindModeCode();
 
 public:
-	//! \param filename The name of the Lua file that retains all data about the map to create
-	MapMode(const std::string& filename);
+	/** \param filename The name of the Lua file that retains all data about the map to create
+	*** \param tile_supervisor The map tiles, when already loaded by the map loading mode. The map takes ownership of it.
+	**/
+	MapMode(const std::string& filename, private_map::TileSupervisor* tile_supervisor = NULL);
 
 	~MapMode();
 
@@ -0,0 +1,669 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   map_compiled.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Source file for the compiled map data files
+*** **************************************************************************/
+
+#include "modes/map/map_compiled.h"
+#include "modes/map/map_tiles.h"
+
+#include "engine/script/script_read.h"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_script;
+
+namespace hoa_map {
+
+namespace private_map {
+
+namespace {
+
+//! \brief The first value of a compiled map file, "VTMC"
+const uint32 COMPILED_MAP_MAGIC = 0x56544D43;
+
+//! \brief Changed whenever the layout of the compiled map files changes
+const uint32 COMPILED_MAP_VERSION = 1;
+
+//! \brief The number of uint32 values in the header: magic, format version, map file size and checksum,
+//! number of tile columns and rows, of contexts, of layers, of collision planes and of tilesets
+const uint32 COMPILED_MAP_HEADER_SIZE = 10;
+
+//! \brief The biggest number of tile columns or rows accepted, to reject corrupted files
+const uint32 COMPILED_MAP_MAX_SIZE = 4096;
+
+//! \brief The biggest number of layers accepted, to reject corrupted files
+const uint32 COMPILED_MAP_MAX_LAYERS = 256;
+
+//! \brief The folder of the user data path where the maps edited by hand are compiled
+const std::string COMPILED_MAP_CACHE_FOLDER = "map_cache/";
+
+
+
+/** \brief Maps a whole file in memory, read only
+*** \param size Set to the size of the file
+*** \return The start of the file in memory, or NULL if it could not be mapped or is empty
+**/
+void* MapFile(const std::string& filename, uint32& size) {
+	size = 0;
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	void* mapping = NULL;
+	DWORD file_size = GetFileSize(file, NULL);
+	if (file_size != INVALID_FILE_SIZE && file_size > 0) {
+		HANDLE file_mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (file_mapping != NULL) {
+			// The view stays valid once the handles are closed
+			mapping = MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(file_mapping);
+		}
+	}
+	CloseHandle(file);
+
+	if (mapping != NULL)
+		size = file_size;
+	return mapping;
+#else
+	int file = open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+		return NULL;
+
+	void* mapping = NULL;
+	struct stat file_info;
+	if (fstat(file, &file_info) == 0 && file_info.st_size > 0) {
+		mapping = mmap(NULL, file_info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping == MAP_FAILED)
+			mapping = NULL;
+	}
+	// The mapping stays valid once the file is closed
+	close(file);
+
+	if (mapping != NULL)
+		size = file_info.st_size;
+	return mapping;
+#endif
+}
+
+
+
+void UnmapFile(void* mapping, uint32 size) {
+#ifdef _WIN32
+	UnmapViewOfFile(mapping);
+#else
+	munmap(mapping, size);
+#endif
+}
+
+
+
+//! \brief Computes the size and the CRC-32 checksum of a file
+bool GetFileChecksum(const std::string& filename, uint32& size, uint32& checksum) {
+	void* mapping = MapFile(filename, size);
+	if (mapping == NULL)
+		return false;
+
+	checksum = crc32(crc32(0L, Z_NULL, 0), static_cast<const Bytef*>(mapping), size);
+	UnmapFile(mapping, size);
+	return true;
+}
+
+
+
+//! \brief Returns the name of the compiled file of a map in the user data folder
+std::string GetCompiledMapCacheFilename(const std::string& map_filename) {
+	// Flatten the path: 'dat/maps/demo.lua' is compiled in 'dat_maps_demo.vtm'
+	std::string cache_filename = GetCompiledMapFilename(map_filename);
+	for (uint32 i = 0; i < cache_filename.size(); ++i) {
+		if (cache_filename[i] == '/' || cache_filename[i] == '\\' || cache_filename[i] == ':')
+			cache_filename[i] = '_';
+	}
+	return GetUserDataPath(true) + COMPILED_MAP_CACHE_FOLDER + cache_filename;
+}
+
+
+
+LAYER_TYPE StringToLayerType(const std::string& type) {
+	if (type == "ground")
+		return GROUND_LAYER;
+	else if (type == "sky")
+		return SKY_LAYER;
+	return INVALID_LAYER;
+}
+
+
+
+void WriteUInt32(ofstream& file, uint32 value) {
+	file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+
+
+std::string GetCompiledMapFilename(const std::string& map_filename) {
+	std::string filename = map_filename;
+	size_t extension = filename.rfind('.');
+	if (extension != std::string::npos && filename.find('/', extension) == std::string::npos)
+		filename.erase(extension);
+
+	return filename + COMPILED_MAP_EXTENSION;
+}
+
+// -----------------------------------------------------------------------------
+// CompiledMap class
+// -----------------------------------------------------------------------------
+
+CompiledMap::CompiledMap() :
+	_num_tile_cols(0),
+	_num_tile_rows(0),
+	_num_contexts(0),
+	_num_layers(0),
+	_num_collision_planes(0),
+	_collision_contexts(NULL),
+	_layer_types(NULL),
+	_tiles(NULL),
+	_collision(NULL),
+	_mapping(NULL),
+	_mapping_size(0)
+{}
+
+
+
+CompiledMap::~CompiledMap() {
+	Close();
+}
+
+
+
+bool CompiledMap::Open(const std::string& map_filename) {
+	Close();
+
+	uint32 map_size = 0;
+	uint32 map_checksum = 0;
+	if (GetFileChecksum(map_filename, map_size, map_checksum) == false)
+		return false;
+
+	return _OpenFile(GetCompiledMapFilename(map_filename), map_size, map_checksum)
+		|| _OpenFile(GetCompiledMapCacheFilename(map_filename), map_size, map_checksum);
+}
+
+
+
+bool CompiledMap::Load(ReadScriptDescriptor& map_file) {
+	if (Open(map_file.GetFilename()))
+		return true;
+
+	if (ReadScript(map_file) == false)
+		return false;
+
+	// Failing to compile the map only means it will be read from Lua the next time as well
+	std::string cache_path = GetUserDataPath(true) + COMPILED_MAP_CACHE_FOLDER;
+	if (DoesFileExist(cache_path) || MakeDirectory(cache_path))
+		Write(GetCompiledMapCacheFilename(map_file.GetFilename()), map_file.GetFilename());
+	return true;
+}
+
+
+
+bool CompiledMap::ReadScript(ReadScriptDescriptor& map_file) {
+	Close();
+
+	uint32 num_tile_cols = map_file.ReadUInt("num_tile_cols");
+	uint32 num_tile_rows = map_file.ReadUInt("num_tile_rows");
+	if (num_tile_cols == 0 || num_tile_rows == 0 || num_tile_cols > COMPILED_MAP_MAX_SIZE || num_tile_rows > COMPILED_MAP_MAX_SIZE) {
+		PRINT_ERROR << "invalid map size in map file: " << map_file.GetFilename() << endl;
+		return false;
+	}
+
+	// A context can't inherit from itself or from a context with a higher id.
+	// The base context can't inherit from another one.
+	vector<int32> context_inherits;
+	map_file.OpenTable("contexts");
+	uint32 num_contexts = map_file.GetTableSize();
+	for (uint32 context_id = 0; context_id < num_contexts; ++context_id) {
+		map_file.OpenTable(context_id);
+		int32 inheritance = map_file.ReadInt("inherit_from");
+		if (context_id == 0 || (int32)context_id <= inheritance || inheritance < -1)
+			inheritance = -1;
+		context_inherits.push_back(inheritance);
+		map_file.CloseTable();
+	}
+	map_file.CloseTable(); // contexts
+
+	if (num_contexts == 0 || num_contexts > 32) {
+		PRINT_ERROR << "invalid number of contexts in map file: " << map_file.GetFilename() << endl;
+		return false;
+	}
+
+	// Read the names of the tilesets used by this map
+	map_file.ReadStringVector("tileset_filenames", _tileset_filenames);
+	int32 num_tiles = _tileset_filenames.size() * TILES_PER_TILESET;
+
+	if (!map_file.DoesTableExist("layers")) {
+		PRINT_ERROR << "No 'layers' table in the map file." << endl;
+		return false;
+	}
+
+	map_file.OpenTable("layers");
+	uint32 num_layers = map_file.GetTableSize();
+	if (num_layers > COMPILED_MAP_MAX_LAYERS) {
+		PRINT_ERROR << "too many layers in map file: " << map_file.GetFilename() << endl;
+		map_file.CloseTable();
+		return false;
+	}
+
+	Reset(num_tile_cols, num_tile_rows, num_contexts, num_layers);
+
+	// Read in the map tile indeces from all tile layers for the base context
+	// The indeces stored for the map layers in this file directly correspond to a location within a tileset. Tilesets contain a total of 256 tiles
+	// each, so 0-255 correspond to the first tileset, 256-511 the second, etc. The tile location within the tileset is also determined by the index,
+	// where the first 16 indeces in the tileset range are the tiles of the first row (left to right), and so on.
+	vector<int32> table_x_indeces; // Used to temporarily store a row of table indeces
+	for (uint32 layer_id = 0; layer_id < num_layers; ++layer_id) {
+		// Missing or invalid layers are kept empty
+		if (!map_file.DoesTableExist(layer_id))
+			continue;
+
+		map_file.OpenTable(layer_id);
+
+		LAYER_TYPE layer_type = StringToLayerType(map_file.ReadString("type"));
+		if (layer_type == INVALID_LAYER) {
+			PRINT_WARNING << "Ignoring unexisting layer type: " << layer_type
+				<< " in file: " << map_file.GetFilename() << endl;
+			map_file.CloseTable(); // layers[layer_id]
+			continue;
+		}
+		SetLayerType(layer_id, layer_type);
+
+		for (uint32 y = 0; y < num_tile_rows; ++y) {
+			// Check to make sure tables are of the proper size
+			if (!map_file.DoesTableExist(y)) {
+				PRINT_ERROR << "the layers["<< layer_id <<"] table size was not equal to the number of tile rows specified by the map, "
+					" first missing row: " << y << endl;
+				map_file.CloseTable(); // layers[layer_id]
+				map_file.CloseTable(); // layers
+				return false;
+			}
+
+			table_x_indeces.clear();
+			map_file.ReadIntVector(y, table_x_indeces);
+
+			// Check the number of columns
+			if (table_x_indeces.size() != num_tile_cols) {
+				PRINT_ERROR << "the layers[" << layer_id << "]["<< y << "] table size was not equal to the number of tile columns specified by the map, "
+				"should have " << num_tile_cols << " values."<< endl;
+				map_file.CloseTable(); // layers[layer_id]
+				map_file.CloseTable(); // layers
+				return false;
+			}
+
+			for (uint32 x = 0; x < num_tile_cols; ++x) {
+				if (table_x_indeces[x] >= num_tiles || table_x_indeces[x] < -1) {
+					PRINT_WARNING << "Invalid tile index: " << table_x_indeces[x] << " in layer: " << layer_id
+						<< ", x: " << x << ", y: " << y << endl;
+					continue;
+				}
+				SetTile(0, layer_id, x, y, table_x_indeces[x]);
+			}
+		}
+		map_file.CloseTable(); // layers[layer_id]
+	}
+	map_file.CloseTable(); // layers
+
+	// Load the tile data for each additional map context
+	const uint32 layer_size = num_tile_cols * num_tile_rows;
+	const uint32 context_size = num_layers * layer_size;
+	for (uint32 ctxt = 1; ctxt < num_contexts; ++ctxt) {
+		string context_name = "context_";
+		if (ctxt < 10) // precede single digit context names with a zero
+			context_name += "0";
+		context_name += NumberToString(ctxt);
+
+		// Initialize this context by making a copy of its parent context first, as most contexts re-use many of the same tiles.
+		// A non-inheriting context starts empty.
+		if (context_inherits[ctxt] > -1) {
+			std::copy(_owned_tiles.begin() + context_inherits[ctxt] * context_size,
+				_owned_tiles.begin() + (context_inherits[ctxt] + 1) * context_size,
+				_owned_tiles.begin() + ctxt * context_size);
+		}
+
+		// Read the table corresponding to this context and modify each tile accordingly.
+		// The context table is an array of integer data. The size of this array should be divisible by four, as every consecutive group of four integers in
+		// this table represent one tile context element. The first integer corresponds to the tile layer (0 = lower, 1 = middle, 2 = upper), the second
+		// and third represent the row and column of the tile respectively, and the fourth value indicates which tile image should be used for this context.
+		// So if the first four entries in the context table were {0, 12, 26, 180}, this would set the lower layer tile at position (12, 26) to the tile
+		// index 180.
+		std::vector<int32> context_data;
+		map_file.ReadIntVector(context_name, context_data);
+		if (context_data.size() % 4 != 0) {
+			PRINT_WARNING <<  ", context data was not evenly divisible by four (incomplete context data)"
+				<< " in context: " << ctxt << endl;
+			continue;
+		}
+
+		for (uint32 j = 0; j < context_data.size(); j += 4) {
+			int32 layer_id = context_data[j];
+			int32 y = context_data[j + 1];
+			int32 x = context_data[j + 2];
+			int32 tile_id = context_data[j + 3];
+
+			if (y < 0 || y >= (int32)num_tile_rows || x < 0 || x >= (int32)num_tile_cols ||
+					layer_id < 0 || layer_id >= (int32)num_layers || tile_id >= num_tiles || tile_id < -1) {
+				PRINT_WARNING << "Invalid context data found for context: " << ctxt << ": layer id: " << layer_id
+					<< ", x: " << x << ", y: " << y << ", tile: " << tile_id << endl;
+				continue;
+			}
+
+			SetTile(ctxt, layer_id, x, y, tile_id);
+		}
+	}
+
+	// Construct the collision grid
+	if (!map_file.DoesTableExist("map_grid")) {
+		PRINT_ERROR << "No map grid found in map file: " << map_file.GetFilename() << endl;
+		return false;
+	}
+
+	map_file.OpenTable("map_grid");
+	if (map_file.GetTableSize() != GetNumGridRows()) {
+		PRINT_ERROR << "the map grid should have " << GetNumGridRows() << " rows in map file: " << map_file.GetFilename() << endl;
+		map_file.CloseTable();
+		return false;
+	}
+
+	vector<uint32> grid_row;
+	for (uint32 y = 0; y < GetNumGridRows(); ++y) {
+		grid_row.clear();
+		map_file.ReadUIntVector(y, grid_row);
+		if (grid_row.size() != GetNumGridCols()) {
+			PRINT_ERROR << "the map_grid[" << y << "] table should have " << GetNumGridCols() << " values in map file: "
+				<< map_file.GetFilename() << endl;
+			map_file.CloseTable();
+			return false;
+		}
+
+		for (uint32 x = 0; x < GetNumGridCols(); ++x)
+			SetCollision(x, y, grid_row[x]);
+	}
+	map_file.CloseTable(); // map_grid
+
+	return true;
+} // bool CompiledMap::ReadScript(ReadScriptDescriptor& map_file)
+
+
+
+bool CompiledMap::Write(const std::string& filename, const std::string& map_filename) const {
+	uint32 map_size = 0;
+	uint32 map_checksum = 0;
+	if (GetFileChecksum(map_filename, map_size, map_checksum) == false) {
+		PRINT_WARNING << "could not read the map file to compile: " << map_filename << endl;
+		return false;
+	}
+
+	ofstream file(filename.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!file) {
+		PRINT_WARNING << "could not create the compiled map file: " << filename << endl;
+		return false;
+	}
+
+	uint32 header[COMPILED_MAP_HEADER_SIZE] = { COMPILED_MAP_MAGIC, COMPILED_MAP_VERSION, map_size, map_checksum,
+		_num_tile_cols, _num_tile_rows, _num_contexts, _num_layers, _num_collision_planes,
+		static_cast<uint32>(_tileset_filenames.size()) };
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	file.write(reinterpret_cast<const char*>(_collision_contexts), _num_collision_planes * sizeof(uint32));
+	file.write(reinterpret_cast<const char*>(_layer_types), _num_layers * sizeof(uint32));
+
+	// The tiles are padded so that the collision planes stay aligned
+	uint32 num_tiles = _num_contexts * _num_layers * _num_tile_cols * _num_tile_rows;
+	file.write(reinterpret_cast<const char*>(_tiles), num_tiles * sizeof(int16));
+	if (num_tiles % 2 != 0) {
+		int16 padding = 0;
+		file.write(reinterpret_cast<const char*>(&padding), sizeof(padding));
+	}
+
+	file.write(reinterpret_cast<const char*>(_collision), _num_collision_planes * _GetCollisionPlaneSize() * sizeof(uint32));
+
+	for (uint32 i = 0; i < _tileset_filenames.size(); ++i) {
+		WriteUInt32(file, _tileset_filenames[i].size());
+		file.write(_tileset_filenames[i].data(), _tileset_filenames[i].size());
+	}
+	file.close();
+
+	// Don't leave a truncated file behind
+	if (!file) {
+		PRINT_WARNING << "could not write the compiled map file: " << filename << endl;
+		DeleteFile(filename);
+		return false;
+	}
+	return true;
+} // bool CompiledMap::Write(const std::string& filename, const std::string& map_filename) const
+
+
+
+void CompiledMap::Close() {
+	if (_mapping != NULL) {
+		UnmapFile(_mapping, _mapping_size);
+		_mapping = NULL;
+		_mapping_size = 0;
+	}
+
+	_num_tile_cols = 0;
+	_num_tile_rows = 0;
+	_num_contexts = 0;
+	_num_layers = 0;
+	_num_collision_planes = 0;
+	_tileset_filenames.clear();
+	_owned_collision_contexts.clear();
+	_owned_layer_types.clear();
+	_owned_tiles.clear();
+	_owned_collision.clear();
+	_UseOwnedData();
+}
+
+
+
+void CompiledMap::Reset(uint32 num_tile_cols, uint32 num_tile_rows, uint32 num_contexts, uint32 num_layers) {
+	std::vector<std::string> tileset_filenames;
+	tileset_filenames.swap(_tileset_filenames);
+	Close();
+	_tileset_filenames.swap(tileset_filenames);
+
+	_num_tile_cols = num_tile_cols;
+	_num_tile_rows = num_tile_rows;
+	_num_contexts = num_contexts;
+	_num_layers = num_layers;
+	_owned_layer_types.assign(num_layers, GROUND_LAYER);
+	_owned_tiles.assign(num_contexts * num_layers * num_tile_cols * num_tile_rows, -1);
+	_UseOwnedData();
+}
+
+
+
+uint32 CompiledMap::GetCollision(uint32 x, uint32 y) const {
+	uint32 element = y * GetNumGridCols() + x;
+	uint32 context_mask = 0;
+	for (uint32 i = 0; i < _num_collision_planes; ++i) {
+		if (_collision[i * _GetCollisionPlaneSize() + element / 32] & (1 << (element % 32)))
+			context_mask |= _collision_contexts[i];
+	}
+	return context_mask;
+}
+
+
+
+void CompiledMap::SetCollision(uint32 x, uint32 y, uint32 context_mask) {
+	uint32 element = y * GetNumGridCols() + x;
+	for (uint32 bit = 0; bit < 32; ++bit) {
+		uint32 context = 1 << bit;
+		// Find the plane of the context, adding it if it doesn't exist yet
+		uint32 plane = 0;
+		while (plane < _num_collision_planes && _owned_collision_contexts[plane] != context)
+			++plane;
+
+		if ((context_mask & context) != 0) {
+			if (plane == _num_collision_planes) {
+				_owned_collision_contexts.push_back(context);
+				_owned_collision.resize(_owned_collision.size() + _GetCollisionPlaneSize(), 0);
+				++_num_collision_planes;
+			}
+			_owned_collision[plane * _GetCollisionPlaneSize() + element / 32] |= (1 << (element % 32));
+		}
+		else if (plane < _num_collision_planes) {
+			_owned_collision[plane * _GetCollisionPlaneSize() + element / 32] &= ~(1 << (element % 32));
+		}
+	}
+	_UseOwnedData();
+}
+
+
+
+void CompiledMap::_UseOwnedData() {
+	_collision_contexts = _owned_collision_contexts.empty() ? NULL : &_owned_collision_contexts[0];
+	_layer_types = _owned_layer_types.empty() ? NULL : &_owned_layer_types[0];
+	_tiles = _owned_tiles.empty() ? NULL : &_owned_tiles[0];
+	_collision = _owned_collision.empty() ? NULL : &_owned_collision[0];
+}
+
+
+
+bool CompiledMap::_OpenFile(const std::string& filename, uint32 map_size, uint32 map_checksum) {
+	uint32 size = 0;
+	void* mapping = MapFile(filename, size);
+	if (mapping == NULL)
+		return false;
+
+	const uint32* header = static_cast<const uint32*>(mapping);
+	if (size < COMPILED_MAP_HEADER_SIZE * sizeof(uint32) || header[0] != COMPILED_MAP_MAGIC || header[1] != COMPILED_MAP_VERSION) {
+		PRINT_WARNING << "invalid or outdated compiled map file: " << filename << endl;
+		UnmapFile(mapping, size);
+		return false;
+	}
+
+	// The map file was changed since it was compiled
+	if (header[2] != map_size || header[3] != map_checksum) {
+		UnmapFile(mapping, size);
+		return false;
+	}
+
+	uint32 num_tile_cols = header[4];
+	uint32 num_tile_rows = header[5];
+	uint32 num_contexts = header[6];
+	uint32 num_layers = header[7];
+	uint32 num_collision_planes = header[8];
+	uint32 num_tilesets = header[9];
+	if (num_tile_cols == 0 || num_tile_rows == 0 || num_tile_cols > COMPILED_MAP_MAX_SIZE || num_tile_rows > COMPILED_MAP_MAX_SIZE
+			|| num_contexts == 0 || num_contexts > 32 || num_layers > COMPILED_MAP_MAX_LAYERS || num_collision_planes > 32) {
+		PRINT_WARNING << "invalid compiled map header in file: " << filename << endl;
+		UnmapFile(mapping, size);
+		return false;
+	}
+
+	// Check the number of tiles against the file size first, so that the sizes below can't overflow
+	uint32 layer_size = num_tile_cols * num_tile_rows;
+	if (num_contexts * num_layers > size / (layer_size * sizeof(int16))) {
+		PRINT_WARNING << "truncated compiled map file: " << filename << endl;
+		UnmapFile(mapping, size);
+		return false;
+	}
+
+	uint32 num_tiles = num_contexts * num_layers * layer_size;
+	uint32 plane_size = (num_tile_cols * 2 * num_tile_rows * 2 + 31) / 32;
+	uint32 offset = COMPILED_MAP_HEADER_SIZE * sizeof(uint32);
+	uint32 collision_contexts_offset = offset;
+	offset += num_collision_planes * sizeof(uint32);
+	uint32 layer_types_offset = offset;
+	offset += num_layers * sizeof(uint32);
+	uint32 tiles_offset = offset;
+	offset += ((num_tiles + 1) / 2) * 2 * sizeof(int16);
+	uint32 collision_offset = offset;
+	offset += num_collision_planes * plane_size * sizeof(uint32);
+	if (size < offset) {
+		PRINT_WARNING << "truncated compiled map file: " << filename << endl;
+		UnmapFile(mapping, size);
+		return false;
+	}
+
+	// Reject the layer types and tile indeces which the map mode could not handle
+	const uint8* data = static_cast<const uint8*>(mapping);
+	const uint32* layer_types = reinterpret_cast<const uint32*>(data + layer_types_offset);
+	for (uint32 i = 0; i < num_layers; ++i) {
+		if (layer_types[i] != GROUND_LAYER && layer_types[i] != SKY_LAYER) {
+			PRINT_WARNING << "invalid layer type in compiled map file: " << filename << endl;
+			UnmapFile(mapping, size);
+			return false;
+		}
+	}
+
+	const int16* tiles = reinterpret_cast<const int16*>(data + tiles_offset);
+	int32 max_tile = num_tilesets * TILES_PER_TILESET;
+	for (uint32 i = 0; i < num_tiles; ++i) {
+		if (tiles[i] < -1 || tiles[i] >= max_tile) {
+			PRINT_WARNING << "invalid tile index in compiled map file: " << filename << endl;
+			UnmapFile(mapping, size);
+			return false;
+		}
+	}
+
+	std::vector<std::string> tileset_filenames(num_tilesets);
+	for (uint32 i = 0; i < num_tilesets; ++i) {
+		uint32 length = 0;
+		if (offset + sizeof(uint32) <= size) {
+			memcpy(&length, data + offset, sizeof(uint32));
+			offset += sizeof(uint32);
+		}
+		if (length == 0 || length > size - offset) {
+			PRINT_WARNING << "invalid tileset name in compiled map file: " << filename << endl;
+			UnmapFile(mapping, size);
+			return false;
+		}
+		tileset_filenames[i].assign(reinterpret_cast<const char*>(data + offset), length);
+		offset += length;
+	}
+
+	Close();
+	_mapping = mapping;
+	_mapping_size = size;
+	_num_tile_cols = num_tile_cols;
+	_num_tile_rows = num_tile_rows;
+	_num_contexts = num_contexts;
+	_num_layers = num_layers;
+	_num_collision_planes = num_collision_planes;
+	_collision_contexts = reinterpret_cast<const uint32*>(data + collision_contexts_offset);
+	_layer_types = layer_types;
+	_tiles = tiles;
+	_collision = reinterpret_cast<const uint32*>(data + collision_offset);
+	_tileset_filenames.swap(tileset_filenames);
+	return true;
+} // bool CompiledMap::_OpenFile(const std::string& filename, uint32 map_size, uint32 map_checksum)
+
+} // namespace private_map
+
+} // namespace hoa_map
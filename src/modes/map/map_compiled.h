@@ -0,0 +1,223 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   map_compiled.h
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Header file for the compiled map data files
+***
+*** A compiled map file holds the bulk data of a map Lua file: the tile layers
+*** of every context, already resolved from the context inheritance, the
+*** collision grid and the tileset names. It is mapped in memory as is, so
+*** the tile and collision data are used without going through Lua, while the
+*** map file keeps its scripted part.
+***
+*** The compiled file is written by the map editor next to the map file it
+*** saves, with the same name and the .vtm extension. It records the size and
+*** checksum of the map file it was compiled from: when the map file was
+*** edited by hand afterwards, the compiled file is ignored and the data are
+*** read from Lua again, then compiled in the user data folder so that the
+*** next loads are fast.
+***
+*** The file layout is: a header of uint32 values, the context masks
+*** of the collision planes, the layer types, the int16 tile indeces of every
+*** layer of every context padded to four bytes, the collision planes and the
+*** tileset names as length prefixed strings. The values are stored in the
+*** byte order of the machine which compiled the file; a file compiled with
+*** another byte order is rejected by its magic number.
+*** **************************************************************************/
+
+#ifndef __MAP_COMPILED_HEADER__
+#define __MAP_COMPILED_HEADER__
+
+#include "defs.h"
+#include "utils.h"
+
+#include <vector>
+
+namespace hoa_script {
+class ReadScriptDescriptor;
+}
+
+namespace hoa_map {
+
+namespace private_map {
+
+//! \brief The file name extension of the compiled map files
+const std::string COMPILED_MAP_EXTENSION = ".vtm";
+
+//! \brief Returns the name of the compiled map file written next to a map file
+std::string GetCompiledMapFilename(const std::string& map_filename);
+
+/** ****************************************************************************
+*** \brief The tile and collision data of a map, compiled or read from Lua
+***
+*** The data are either mapped from a compiled map file, or owned by the
+*** object when read from the map script or filled by the map editor.
+***
+*** This class doesn't use the video engine, so that it can be used by the
+*** map editor and from the map loading thread.
+*** ***************************************************************************/
+class CompiledMap {
+public:
+	CompiledMap();
+
+	~CompiledMap();
+
+	/** \brief Maps the compiled file of a map, if there is an up to date one
+	*** \param map_filename The name of the map Lua file
+	*** \return False if there is no compiled file matching the current map file
+	***
+	*** The compiled file written next to the map file is tried first, then the one in the user data folder.
+	**/
+	bool Open(const std::string& map_filename);
+
+	/** \brief Opens the compiled file of a map, or reads the map data from its script
+	*** \param map_file The map file, opened with no Lua tables open
+	*** \return False if the map data could not be read
+	***
+	*** When the data are read from the script, they are compiled in the user data folder.
+	**/
+	bool Load(hoa_script::ReadScriptDescriptor& map_file);
+
+	/** \brief Reads the map data from the map script
+	*** \param map_file The map file, opened with no Lua tables open
+	*** \return False if the map data are invalid
+	**/
+	bool ReadScript(hoa_script::ReadScriptDescriptor& map_file);
+
+	/** \brief Writes the data in a compiled map file
+	*** \param filename The name of the compiled file to write
+	*** \param map_filename The name of the map Lua file the data come from, whose checksum is recorded
+	*** \return False if the file could not be written
+	**/
+	bool Write(const std::string& filename, const std::string& map_filename) const;
+
+	//! \brief Releases the data, unmapping the compiled file if needed
+	void Close();
+
+	/** \brief Sets the size of the map and allocates its data, emptying the tiles and the collision grid
+	*** Used to fill the data without reading the map script, as done by the map editor.
+	**/
+	void Reset(uint32 num_tile_cols, uint32 num_tile_rows, uint32 num_contexts, uint32 num_layers);
+
+	//! \name Class Member Access Functions
+	//@{
+	uint32 GetNumTileCols() const
+		{ return _num_tile_cols; }
+
+	uint32 GetNumTileRows() const
+		{ return _num_tile_rows; }
+
+	uint32 GetNumContexts() const
+		{ return _num_contexts; }
+
+	uint32 GetNumLayers() const
+		{ return _num_layers; }
+
+	//! \brief The collision grid has twice as many columns and rows as the tile layers
+	uint32 GetNumGridCols() const
+		{ return _num_tile_cols * 2; }
+
+	uint32 GetNumGridRows() const
+		{ return _num_tile_rows * 2; }
+
+	//! \brief Returns the layer type, as a value of hoa_map::private_map::LAYER_TYPE
+	uint32 GetLayerType(uint32 layer) const
+		{ return _layer_types[layer]; }
+
+	/** \brief Returns the tiles of a layer in a context, row by row
+	*** The tile indeces are the ones of the map file: the tileset index times 256 plus the tile index in
+	*** the tileset, or -1 for no tile.
+	**/
+	const int16* GetTiles(uint32 context, uint32 layer) const
+		{ return _tiles + (context * _num_layers + layer) * _num_tile_cols * _num_tile_rows; }
+
+	//! \brief Returns the mask of the contexts where a collision grid element is a wall
+	uint32 GetCollision(uint32 x, uint32 y) const;
+
+	const std::vector<std::string>& GetTilesetFilenames() const
+		{ return _tileset_filenames; }
+
+	//! \brief Tells whether the data come from a compiled file
+	bool IsMapped() const
+		{ return _mapping != NULL; }
+
+	//! \brief Only usable on data not mapped from a file
+	void SetLayerType(uint32 layer, uint32 layer_type)
+		{ _owned_layer_types[layer] = layer_type; }
+
+	void SetTile(uint32 context, uint32 layer, uint32 x, uint32 y, int16 tile)
+		{ _owned_tiles[(context * _num_layers + layer) * _num_tile_cols * _num_tile_rows + y * _num_tile_cols + x] = tile; }
+
+	void SetCollision(uint32 x, uint32 y, uint32 context_mask);
+
+	void SetTilesetFilenames(const std::vector<std::string>& tileset_filenames)
+		{ _tileset_filenames = tileset_filenames; }
+	//@}
+
+private:
+	CompiledMap(const CompiledMap&);
+	CompiledMap& operator=(const CompiledMap&);
+
+	//! \brief The size of the tile layers
+	uint32 _num_tile_cols, _num_tile_rows;
+
+	uint32 _num_contexts;
+
+	uint32 _num_layers;
+
+	/** \brief The collision grid is stored as one plane of bits per context having walls
+	*** _collision_contexts holds the context mask of each plane.
+	**/
+	uint32 _num_collision_planes;
+
+	//! \brief Point either in the compiled file mapping or in the owned vectors below
+	//@{
+	const uint32* _collision_contexts;
+	const uint32* _layer_types;
+	const int16* _tiles;
+	const uint32* _collision;
+	//@}
+
+	std::vector<std::string> _tileset_filenames;
+
+	//! \brief The mapped compiled file, or NULL
+	void* _mapping;
+	uint32 _mapping_size;
+
+	//! \brief The data not mapped from a compiled file
+	//@{
+	std::vector<uint32> _owned_collision_contexts;
+	std::vector<uint32> _owned_layer_types;
+	std::vector<int16> _owned_tiles;
+	std::vector<uint32> _owned_collision;
+	//@}
+
+	//! \brief Returns the number of uint32 values in a collision plane
+	uint32 _GetCollisionPlaneSize() const
+		{ return (GetNumGridCols() * GetNumGridRows() + 31) / 32; }
+
+	//! \brief Points the data at the owned vectors
+	void _UseOwnedData();
+
+	/** \brief Maps a compiled file and checks that it was compiled from the given map file
+	*** \param map_size The size of the map file
+	*** \param map_checksum The CRC-32 checksum of the map file
+	*** \return False if the file is missing, outdated or invalid
+	**/
+	bool _OpenFile(const std::string& filename, uint32 map_size, uint32 map_checksum);
+}; // class CompiledMap
+
+} // namespace private_map
+
+} // namespace hoa_map
+
+#endif // __MAP_COMPILED_HEADER__
@@ -21,6 +21,7 @@
 
 #include "modes/map/map.h"
 #include "modes/map/map_events.h"
+#include "modes/map/map_loading.h"
 #include "modes/map/map_objects.h"
 #include "modes/map/map_sprites.h"
 
@@ -193,9 +194,10 @@ bool MapTransitionEvent::_Update() {
 	// break the fade smoothness and visible duration.
 	if (!_done) {
 		hoa_global::GlobalManager->SetPreviousLocation(_transition_origin);
-		MapMode *MM = new MapMode(_transition_map_filename);
+		// The loading mode is drawn over the black screen, and the new map fades in once loaded.
+		MapLoadingMode *MLM = new MapLoadingMode(_transition_map_filename);
 		ModeManager->Pop();
-		ModeManager->Push(MM, false, true);
+		ModeManager->Push(MLM, false, false);
 		_done = true;
 	}
 	return true;
@@ -605,6 +607,7 @@ PathMoveSpriteEvent::PathMoveSpriteEvent(const std::string& event_id, uint16 spr
 	_current_node_x(0.0f),
 	_current_node_y(0.0f),
 	_current_node(0),
+	_path_request_id(0),
 	_run(run)
 {}
 
@@ -619,6 +622,7 @@ PathMoveSpriteEvent::PathMoveSpriteEvent(const std::string& event_id, VirtualSpr
 	_current_node_x(0.0f),
 	_current_node_y(0.0f),
 	_current_node(0),
+	_path_request_id(0),
 	_run(run)
 {}
 
@@ -662,21 +666,31 @@ void PathMoveSpriteEvent::_Start() {
 	}
 	MapPosition dest(_destination_x, _destination_y);
 
-	_path = MapMode::CurrentInstance()->GetObjectSupervisor()->FindPath(_sprite, dest);
-	if (_path.empty()) {
-		PRINT_ERROR << "No path to destination (" << _destination_x
-					<< ", " << _destination_y << ") for sprite: "
-					<< _sprite->GetObjectID() << endl;
-		return;
-	}
-
-	_current_node_x = _path[_current_node].x;
-	_current_node_y = _path[_current_node].y;
-
-	_sprite->moving = true;
+	// The path is searched during the next object supervisor updates
+	_path.clear();
+	_path_request_id = MapMode::CurrentInstance()->GetObjectSupervisor()->RequestPath(_sprite, dest);
 }
 
 bool PathMoveSpriteEvent::_Update() {
+	// Wait for the path to be found before moving the sprite
+	if (_path_request_id != 0) {
+		if (!MapMode::CurrentInstance()->GetObjectSupervisor()->TakePath(_path_request_id, _path))
+			return false;
+		_path_request_id = 0;
+
+		if (_path.empty()) {
+			PRINT_ERROR << "No path to destination (" << _destination_x
+						<< ", " << _destination_y << ") for sprite: "
+						<< _sprite->GetObjectID() << endl;
+			Terminate();
+			return true;
+		}
+
+		_current_node_x = _path[_current_node].x;
+		_current_node_y = _path[_current_node].y;
+		_sprite->moving = true;
+	}
+
 	if (_path.empty()) {
 		// No path
 		Terminate();
@@ -716,6 +730,11 @@ bool PathMoveSpriteEvent::_Update() {
 }
 
 void PathMoveSpriteEvent::Terminate() {
+	if (_path_request_id != 0) {
+		MapMode::CurrentInstance()->GetObjectSupervisor()->CancelPathRequest(_path_request_id);
+		_path_request_id = 0;
+	}
+
 	_sprite->moving = false;
 	SpriteEvent::Terminate();
 }
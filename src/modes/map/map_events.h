@@ -731,13 +731,16 @@ protected:
 	//! \brief Holds the path needed to traverse from source to destination
 	Path _path;
 
+	//! \brief The id of the path request made to the object supervisor, or 0 once the path is found
+	uint32 _path_request_id;
+
 	//! \brief Tells whether the sprite should use the walk or run animation
 	bool _run;
 
-	//! \brief Calculates a path for the sprite to move to the destination
+	//! \brief Requests a path for the sprite to move to the destination
 	void _Start();
 
-	//! \brief Returns true when the sprite has reached the destination
+	//! \brief Returns true when the sprite has reached the destination, or when there is no path to it
 	bool _Update();
 
 	//! \brief Sets the correct direction for the sprite to move to the next node in the path
@@ -0,0 +1,258 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    map_loading.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Source file for the map loading mode.
+*** ***************************************************************************/
+
+#include "modes/map/map_loading.h"
+
+#include "engine/audio/audio.h"
+#include "engine/script/script_read.h"
+#include "engine/video/video.h"
+
+#include "modes/boot/boot.h"
+#include "modes/map/map.h"
+#include "modes/map/map_compiled.h"
+#include "modes/map/map_tiles.h"
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_audio;
+using namespace hoa_mode_manager;
+using namespace hoa_script;
+using namespace hoa_system;
+using namespace hoa_video;
+using namespace hoa_boot;
+using namespace hoa_map::private_map;
+
+namespace hoa_map {
+
+//! \brief The size and position of the progress bar, in the standard screen resolution.
+//@{
+const float PROGRESS_BAR_WIDTH = 400.0f;
+const float PROGRESS_BAR_HEIGHT = 12.0f;
+const float PROGRESS_BAR_X = (VIDEO_STANDARD_RES_WIDTH - PROGRESS_BAR_WIDTH) / 2.0f;
+const float PROGRESS_BAR_Y = 360.0f;
+//@}
+
+MapLoadingMode::MapLoadingMode(const std::string& filename) :
+	GameMode(),
+	_map_filename(filename),
+	_state(MAP_LOADING_DECODING),
+	_tile_supervisor(new TileSupervisor()),
+	_loading_thread(NULL),
+	_thread_finished(false),
+	_thread_succeeded(false),
+	_number_tilesets(0),
+	_decoded_tilesets(0),
+	_uploaded_tilesets(0)
+{
+	mode_type = MODE_MANAGER_LOADING_MODE;
+
+	// The tilesets and sprites baked in the map atlas are neither decoded nor uploaded one by one
+	TextureManager->LoadAtlas(GetMapAtlasFilename(_map_filename));
+
+	// The previous map is deleted before the new one is created. Keep the music it owns alive
+	// meanwhile, so that it doesn't restart when the new map plays the same one.
+	MusicDescriptor* music = AudioManager->GetActiveMusic();
+	if (music != NULL && !music->GetOwners()->empty())
+		music->AddOwner(this);
+
+	_loading_text.SetStyle(TextStyle("title24", Color::white, VIDEO_TEXT_SHADOW_BLACK));
+	_loading_text.SetText(UTranslate("Loading..."));
+}
+
+
+
+MapLoadingMode::~MapLoadingMode() {
+	_WaitForLoadingThread();
+
+	// Not handed over to a map mode
+	delete _tile_supervisor;
+
+	// The map mode holds its own reference on the atlas
+	TextureManager->UnloadAtlas(GetMapAtlasFilename(_map_filename));
+}
+
+
+
+void MapLoadingMode::Reset() {
+	VideoManager->SetCoordSys(0.0f, VIDEO_STANDARD_RES_WIDTH, 0.0f, VIDEO_STANDARD_RES_HEIGHT);
+	VideoManager->SetDrawFlags(VIDEO_BLEND, 0);
+
+	// The mode may be reset again, e.g. when coming back from pause mode
+	if (_state != MAP_LOADING_DECODING || _loading_thread != NULL || _thread_finished)
+		return;
+
+	// The loading thread must not read the loaded atlases, which the main thread may change meanwhile
+	std::set<std::string> atlas_tilesets;
+	TextureManager->GetAtlasMultiImages(16, 16, atlas_tilesets);
+	_tile_supervisor->SetAtlasTilesets(atlas_tilesets);
+
+	_loading_thread = SystemManager->SpawnThread(&MapLoadingMode::_LoadingThread, this);
+	if (_loading_thread == NULL) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "could not start the loading thread, the map will be loaded at once: " << _map_filename << endl;
+		_state = MAP_LOADING_CREATING;
+	}
+}
+
+
+
+void MapLoadingMode::Update() {
+	switch (_state) {
+		case MAP_LOADING_DECODING:
+			if (!_thread_finished)
+				return;
+
+			_WaitForLoadingThread();
+			// On failure, the map mode loads the tiles itself and reports the errors
+			_state = _thread_succeeded ? MAP_LOADING_UPLOADING : MAP_LOADING_CREATING;
+			break;
+
+		case MAP_LOADING_UPLOADING:
+			// Only one tileset is added to texture memory per frame, to keep on drawing the progress
+			if (_uploaded_tilesets < _tile_supervisor->GetNumberTilesets()) {
+				if (!_tile_supervisor->UploadTileset(_uploaded_tilesets)) {
+					_state = MAP_LOADING_CREATING;
+					break;
+				}
+				++_uploaded_tilesets;
+			}
+
+			if (_uploaded_tilesets >= _tile_supervisor->GetNumberTilesets())
+				_state = MAP_LOADING_FINISHING;
+			break;
+
+		case MAP_LOADING_FINISHING:
+			_tile_supervisor->FinishLoading();
+			_state = MAP_LOADING_CREATING;
+			break;
+
+		case MAP_LOADING_CREATING:
+			_CreateMapMode();
+			_state = MAP_LOADING_DONE;
+			break;
+
+		default:
+			break;
+	}
+} // void MapLoadingMode::Update()
+
+
+
+void MapLoadingMode::Draw() {
+	VideoManager->SetCoordSys(0.0f, VIDEO_STANDARD_RES_WIDTH, 0.0f, VIDEO_STANDARD_RES_HEIGHT);
+
+	VideoManager->SetDrawFlags(VIDEO_X_CENTER, VIDEO_Y_CENTER, 0);
+	VideoManager->Move(VIDEO_STANDARD_RES_WIDTH / 2.0f, PROGRESS_BAR_Y + 40.0f);
+	_loading_text.Draw();
+
+	VideoManager->SetDrawFlags(VIDEO_X_LEFT, VIDEO_Y_BOTTOM, 0);
+	VideoManager->Move(PROGRESS_BAR_X, PROGRESS_BAR_Y);
+	VideoManager->DrawRectangle(PROGRESS_BAR_WIDTH * _GetProgress(), PROGRESS_BAR_HEIGHT, Color::white);
+	VideoManager->DrawRectangleOutline(PROGRESS_BAR_X, PROGRESS_BAR_X + PROGRESS_BAR_WIDTH,
+		PROGRESS_BAR_Y, PROGRESS_BAR_Y + PROGRESS_BAR_HEIGHT, 2.0f, Color::gray);
+}
+
+
+
+void MapLoadingMode::_LoadingThread() {
+	// The map file only needs to be run when it has no up to date compiled file.
+	// It is then read in a Lua state of its own, as the global one can't be used by several threads.
+	CompiledMap map_data;
+	bool success = map_data.Open(_map_filename);
+	if (!success) {
+		ReadScriptDescriptor map_file;
+		success = map_file.OpenStandaloneFile(_map_filename);
+		if (success) {
+			success = !map_file.OpenTablespace().empty() && map_data.Load(map_file);
+			map_file.CloseFile();
+		}
+	}
+
+	if (success)
+		success = _tile_supervisor->LoadTileData(map_data, true);
+
+	if (success) {
+		_number_tilesets = _tile_supervisor->GetNumberTilesets();
+		for (uint32 i = 0; i < _number_tilesets && success; ++i) {
+			success = _tile_supervisor->DecodeTileset(i);
+			++_decoded_tilesets;
+		}
+	}
+
+	_thread_succeeded = success;
+	_thread_finished = true;
+} // void MapLoadingMode::_LoadingThread()
+
+
+
+void MapLoadingMode::_WaitForLoadingThread() {
+	if (_loading_thread == NULL)
+		return;
+
+	SystemManager->WaitForThread(_loading_thread);
+	_loading_thread = NULL;
+}
+
+
+
+float MapLoadingMode::_GetProgress() const {
+	// Reading the tile data, then decoding and uploading every tileset, and creating the map
+	float total_steps = 2.0f * _number_tilesets + 3.0f;
+	float done_steps = 0.0f;
+	if (_state == MAP_LOADING_DECODING)
+		done_steps = (_number_tilesets > 0 ? 1.0f : 0.0f) + _decoded_tilesets;
+	else if (_state == MAP_LOADING_UPLOADING)
+		done_steps = 1.0f + _number_tilesets + _uploaded_tilesets;
+	else
+		done_steps = total_steps - (_state == MAP_LOADING_FINISHING ? 2.0f : 1.0f);
+
+	return done_steps / total_steps;
+}
+
+
+
+void MapLoadingMode::_CreateMapMode() {
+	// Only hand over the tiles once they are fully loaded, the map mode loads them again otherwise
+	TileSupervisor* tile_supervisor = NULL;
+	if (_tile_supervisor->IsLoaded()) {
+		tile_supervisor = _tile_supervisor;
+		_tile_supervisor = NULL;
+	}
+
+	MapMode* MM = NULL;
+	try {
+		MM = new MapMode(_map_filename, tile_supervisor);
+	}
+	catch (luabind::error e) {
+		PRINT_ERROR << "Error loading map " << _map_filename << ", returning to BootMode." << endl;
+		cerr << "Exception message:" << endl;
+		ScriptManager->HandleLuaError(e);
+		ModeManager->PopAll();
+		ModeManager->Push(new BootMode(), true, true);
+		return;
+	}
+
+	// Fill the holes left in the texture sheets by the previous map, and collect the garbage it left
+	// in the Lua state, while the loading screen is shown rather than while the new map runs
+	TextureManager->DefragmentTexSheets();
+	ScriptManager->CollectAllGarbage();
+
+	// The loading screen is replaced by a black one, from which the map fades in
+	VideoManager->FadeScreen(Color::black, 0);
+	ModeManager->Pop();
+	ModeManager->Push(MM, false, true);
+} // void MapLoadingMode::_CreateMapMode()
+
+} // namespace hoa_map
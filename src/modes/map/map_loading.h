@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    map_loading.h
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Header file for the map loading mode.
+***
+*** This mode is displayed while a map is being loaded. The map file data and
+*** the tileset images are read and decoded in a loading thread, while the
+*** main thread keeps on drawing a progress bar. The decoded tilesets are then
+*** turned into textures one per frame, before the map mode is created and
+*** replaces the loading mode.
+*** ***************************************************************************/
+
+#ifndef __MAP_LOADING_HEADER__
+#define __MAP_LOADING_HEADER__
+
+#include "engine/mode_manager.h"
+#include "engine/system.h"
+#include "engine/video/text.h"
+
+namespace hoa_map {
+
+namespace private_map {
+
+//! \brief The successive states of the map loading mode.
+enum MAP_LOADING_STATE {
+	//! The map data is read and the tileset images decoded in the loading thread
+	MAP_LOADING_DECODING = 0,
+	//! The decoded tilesets are added to texture memory, one per frame
+	MAP_LOADING_UPLOADING = 1,
+	//! The tile images and layer chunks are created
+	MAP_LOADING_FINISHING = 2,
+	//! The map mode is created and replaces the loading mode
+	MAP_LOADING_CREATING = 3,
+	MAP_LOADING_DONE = 4
+};
+
+} // namespace private_map
+
+/** ****************************************************************************
+*** \brief Loads a map while displaying its progress on the screen
+***
+*** Only the work using neither OpenGL nor the global Lua state is done in the
+*** loading thread: reading the map tile data and the tileset definitions in
+*** standalone Lua states, and decoding the tileset images. Running the map
+*** script and its Load() function, and creating the map objects, is still
+*** done by the MapMode constructor on the main thread.
+***
+*** \note If the loading thread fails, the map is loaded synchronously by the
+*** MapMode constructor instead, which reports the errors on its own.
+*** ***************************************************************************/
+class MapLoadingMode : public hoa_mode_manager::GameMode {
+public:
+	//! \param filename The name of the Lua file that retains all data about the map to load
+	MapLoadingMode(const std::string& filename);
+
+	~MapLoadingMode();
+
+	//! \brief Starts the loading thread, the first time the mode is made active.
+	void Reset();
+
+	//! \brief Processes the main thread part of the loading, and creates the map once done.
+	void Update();
+
+	//! \brief Draws the loading progress.
+	void Draw();
+
+private:
+	//! \brief The name of the map file to load.
+	std::string _map_filename;
+
+	//! \brief The current loading state.
+	private_map::MAP_LOADING_STATE _state;
+
+	//! \brief The map tiles being loaded. Handed over to the map mode once created.
+	private_map::TileSupervisor* _tile_supervisor;
+
+	//! \brief The loading thread, or NULL when not running.
+	Thread* _loading_thread;
+
+	/** \name Loading Thread Status
+	*** \brief Written by the loading thread and polled by the main thread.
+	**/
+	//@{
+	volatile bool _thread_finished;
+	volatile bool _thread_succeeded;
+	volatile uint32 _number_tilesets;
+	volatile uint32 _decoded_tilesets;
+	//@}
+
+	//! \brief The number of tilesets already added to texture memory.
+	uint32 _uploaded_tilesets;
+
+	//! \brief The "Loading..." text displayed above the progress bar.
+	hoa_video::TextImage _loading_text;
+
+	//! \brief The function run by the loading thread.
+	void _LoadingThread();
+
+	//! \brief Waits for the loading thread to end, if it was started.
+	void _WaitForLoadingThread();
+
+	//! \brief Returns the loading progress, between 0.0f and 1.0f.
+	float _GetProgress() const;
+
+	//! \brief Creates the map mode and replaces the loading mode with it.
+	void _CreateMapMode();
+}; // class MapLoadingMode : public hoa_mode_manager::GameMode
+
+} // namespace hoa_map
+
+#endif // __MAP_LOADING_HEADER__
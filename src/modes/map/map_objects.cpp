@@ -16,6 +16,7 @@
 #include "utils.h"
 
 #include "engine/audio/audio.h"
+#include "engine/profiler.h"
 #include "engine/system.h"
 #include "engine/video/video.h"
 #include "engine/video/particle_effect.h"
@@ -23,6 +24,7 @@
 #include "common/global/global.h"
 
 #include "modes/map/map.h"
+#include "modes/map/map_compiled.h"
 #include "modes/map/map_dialogue.h"
 #include "modes/map/map_objects.h"
 #include "modes/map/map_sprites.h"
@@ -54,11 +56,26 @@ MapObject::MapObject() :
 	visible(true),
 	no_collision(false),
 	sky_object(false),
-	draw_on_second_pass(false)
+	draw_on_second_pass(false),
+	object_grid(NULL),
+	grid_cell_left(-1),
+	grid_cell_top(-1),
+	grid_cell_right(-1),
+	grid_cell_bottom(-1)
 {}
 
 
 
+void MapObject::SetPosition(float x, float y) {
+	position.x = x;
+	position.y = y;
+
+	if (object_grid)
+		object_grid->UpdateObject(this);
+}
+
+
+
 bool MapObject::ShouldDraw() {
 	if (!visible)
 		return false;
@@ -83,10 +100,11 @@ bool MapObject::ShouldDraw() {
 	// change the coordinate system in map mode, then this should be done only once and the calculated values should be saved for re-use.
 	// However, we've discussed the possiblity of adding a zoom feature to maps, in which case we need to continually re-calculate the pixel size
 	VideoManager->GetPixelSize(x_pixel_length, y_pixel_length);
-	rounded_x_offset = FloorToFloatMultiple(GetFloatFraction(GetXPosition()), x_pixel_length);
-	rounded_y_offset = FloorToFloatMultiple(GetFloatFraction(GetYPosition()), y_pixel_length);
-	x_pos = static_cast<float>(GetFloatInteger(GetXPosition())) + rounded_x_offset;
-	y_pos = static_cast<float>(GetFloatInteger(GetYPosition())) + rounded_y_offset;
+	MapPosition draw_position = GetDrawPosition();
+	rounded_x_offset = FloorToFloatMultiple(GetFloatFraction(draw_position.x), x_pixel_length);
+	rounded_y_offset = FloorToFloatMultiple(GetFloatFraction(draw_position.y), y_pixel_length);
+	x_pos = static_cast<float>(GetFloatInteger(draw_position.x)) + rounded_x_offset;
+	y_pos = static_cast<float>(GetFloatInteger(draw_position.y)) + rounded_y_offset;
 
 	// ---------- Move the drawing cursor to the appropriate coordinates for this sprite
 	VideoManager->Move(x_pos - map->GetMapFrame().screen_edges.left,
@@ -95,6 +113,19 @@ bool MapObject::ShouldDraw() {
 } // bool MapObject::ShouldDraw()
 
 
+MapPosition MapObject::GetDrawPosition() const {
+	float delta_x = position.x - previous_position.x;
+	float delta_y = position.y - previous_position.y;
+	if (delta_x > MAX_INTERPOLATED_DISTANCE || delta_x < -MAX_INTERPOLATED_DISTANCE ||
+			delta_y > MAX_INTERPOLATED_DISTANCE || delta_y < -MAX_INTERPOLATED_DISTANCE)
+		return position;
+
+	// Draw the object between its last two positions, as far as the drawn frame lies between the update steps
+	float interpolation = SystemManager->GetUpdateInterpolation();
+	return MapPosition(previous_position.x + delta_x * interpolation, previous_position.y + delta_y * interpolation);
+}
+
+
 MapRectangle MapObject::GetCollisionRectangle() const {
 	MapRectangle rect;
 	rect.left = position.x - coll_half_width;
@@ -222,9 +253,9 @@ ParticleObject::ParticleObject(const std::string& filename, float x, float y,
 }
 
 ParticleObject::~ParticleObject() {
-	// We have to delete the particle effect since we don't register it
+	// We have to release the particle effect since we don't register it
 	// to the ParticleManager.
-	delete _particle_effect;
+	hoa_mode_manager::ParticleManager::ReleaseEffect(_particle_effect);
 }
 
 void ParticleObject::Update() {
@@ -283,7 +314,7 @@ SavePoint::SavePoint(float x, float y, MAP_CONTEXT map_context):
 	MapMode *map_mode = MapMode::CurrentInstance();
 
 	// Preload the save active sound
-	AudioManager->LoadSound("snd/save_point_activated_dokashiteru_oga.wav", map_mode);
+	AudioManager->PreloadSound("snd/save_point_activated_dokashiteru_oga.wav", map_mode);
 
 	// The save point is going along with two particle objects used to show
 	// whether the player is in or out the save point
@@ -608,6 +639,92 @@ bool TreasureObject::AddObject(uint32 id, uint32 quantity) {
 	return _treasure->AddObject(id, quantity);
 }
 
+// ----------------------------------------------------------------------------
+// ---------- CollisionGrid Class Functions
+// ----------------------------------------------------------------------------
+
+void CollisionGrid::Load(const CompiledMap& map_data) {
+	// The versions are unique among all the grids, so that the path finding data of a former map are never reused
+	static uint32 last_version = 0;
+	_version = ++last_version;
+
+	_num_grid_x_axis = map_data.GetNumGridCols();
+	_num_grid_y_axis = map_data.GetNumGridRows();
+	_words_per_row = (_num_grid_x_axis + 31) / 32;
+
+	// Only the contexts having walls get a plane
+	uint32 wall_contexts = 0;
+	for (uint16 y = 0; y < _num_grid_y_axis; ++y) {
+		for (uint16 x = 0; x < _num_grid_x_axis; ++x)
+			wall_contexts |= map_data.GetCollision(x, y);
+	}
+
+	int32 context_planes[32];
+	_plane_contexts.clear();
+	for (uint32 bit = 0; bit < 32; ++bit) {
+		context_planes[bit] = -1;
+		if (wall_contexts & (1u << bit)) {
+			context_planes[bit] = _plane_contexts.size();
+			_plane_contexts.push_back(1u << bit);
+		}
+	}
+
+	_planes.assign(_plane_contexts.size() * _num_grid_y_axis * _words_per_row, 0);
+	for (uint16 y = 0; y < _num_grid_y_axis; ++y) {
+		for (uint16 x = 0; x < _num_grid_x_axis; ++x) {
+			uint32 walls = map_data.GetCollision(x, y);
+			for (uint32 bit = 0; walls != 0; ++bit, walls >>= 1) {
+				if (walls & 1)
+					_planes[(context_planes[bit] * _num_grid_y_axis + y) * _words_per_row + x / 32] |= (1u << (x % 32));
+			}
+		}
+	}
+}
+
+
+
+bool CollisionGrid::IsWall(uint32 x, uint32 y, uint32 context_mask) const {
+	for (uint32 plane = 0; plane < _plane_contexts.size(); ++plane) {
+		if ((_plane_contexts[plane] & context_mask) != 0
+				&& (_planes[(plane * _num_grid_y_axis + y) * _words_per_row + x / 32] & (1u << (x % 32))) != 0)
+			return true;
+	}
+	return false;
+}
+
+
+
+bool CollisionGrid::HasWall(uint32 left, uint32 top, uint32 right, uint32 bottom, uint32 context_mask) const {
+	uint32 first_word = left / 32;
+	uint32 last_word = right / 32;
+	// The bits of the first and last words lying within the rectangle
+	uint32 first_mask = 0xFFFFFFFF << (left % 32);
+	uint32 last_mask = 0xFFFFFFFF >> (31 - right % 32);
+	if (first_word == last_word)
+		first_mask &= last_mask;
+
+	for (uint32 plane = 0; plane < _plane_contexts.size(); ++plane) {
+		if ((_plane_contexts[plane] & context_mask) == 0)
+			continue;
+
+		const uint32* row = &_planes[(plane * _num_grid_y_axis + top) * _words_per_row];
+		for (uint32 y = top; y <= bottom; ++y, row += _words_per_row) {
+			if ((row[first_word] & first_mask) != 0)
+				return true;
+			if (first_word == last_word)
+				continue;
+
+			for (uint32 word = first_word + 1; word < last_word; ++word) {
+				if (row[word] != 0)
+					return true;
+			}
+			if ((row[last_word] & last_mask) != 0)
+				return true;
+		}
+	}
+	return false;
+}
+
 // ----------------------------------------------------------------------------
 // ---------- ObjectSupervisor Class Functions
 // ----------------------------------------------------------------------------
@@ -615,6 +732,8 @@ bool TreasureObject::AddObject(uint32 id, uint32 quantity) {
 ObjectSupervisor::ObjectSupervisor() :
 	_num_grid_x_axis(0),
 	_num_grid_y_axis(0),
+	_path_search_id(0),
+	_last_path_request_id(0),
 	_last_id(1000),
 	_visible_party_member(0)
 {
@@ -708,27 +827,168 @@ void ObjectSupervisor::SortObjects() {
 
 
 
-bool ObjectSupervisor::Load(ReadScriptDescriptor& map_file) {
-	if (!map_file.DoesTableExist("map_grid")) {
-		PRINT_ERROR << "No map grid found in map file: " << map_file.GetFilename() << endl;
-		return false;
+// ----------------------------------------------------------------------------
+// ---------- ObjectGrid Class Functions
+// ----------------------------------------------------------------------------
+
+void ObjectGrid::Resize(uint16 num_grid_x_axis, uint16 num_grid_y_axis) {
+	_num_cells_x = (num_grid_x_axis + OBJECT_GRID_CELL_SIZE - 1) / OBJECT_GRID_CELL_SIZE;
+	_num_cells_y = (num_grid_y_axis + OBJECT_GRID_CELL_SIZE - 1) / OBJECT_GRID_CELL_SIZE;
+	if (_num_cells_x == 0)
+		_num_cells_x = 1;
+	if (_num_cells_y == 0)
+		_num_cells_y = 1;
+
+	_cells.clear();
+	_cells.resize(_num_cells_x * _num_cells_y);
+}
+
+
+
+void ObjectGrid::AddObject(MapObject* object) {
+	if (object->object_grid) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "object was already registered in an object grid: " << object->object_id << endl;
+		return;
 	}
 
-	// Construct the collision grid
-	map_file.OpenTable("map_grid");
-	_num_grid_y_axis = map_file.GetTableSize();
-	for (uint16 y = 0; y < _num_grid_y_axis; ++y) {
-		_collision_grid.push_back(vector<uint32>());
-		map_file.ReadUIntVector(y, _collision_grid.back());
+	int16 left, top, right, bottom;
+	_GetCellRange(object->GetCollisionRectangle(), left, top, right, bottom);
+	object->object_grid = this;
+	_InsertObject(object, left, top, right, bottom);
+}
+
+
+
+void ObjectGrid::UpdateObject(MapObject* object) {
+	if (_cells.empty())
+		return;
+
+	int16 left, top, right, bottom;
+	_GetCellRange(object->GetCollisionRectangle(), left, top, right, bottom);
+
+	// The object didn't leave its cells
+	if (left == object->grid_cell_left && top == object->grid_cell_top
+			&& right == object->grid_cell_right && bottom == object->grid_cell_bottom)
+		return;
+
+	_RemoveObject(object);
+	_InsertObject(object, left, top, right, bottom);
+}
+
+
+
+void ObjectGrid::GetObjects(const MapRectangle& rect, std::vector<MapObject*>& objects) const {
+	// The grid wasn't sized yet
+	if (_cells.empty())
+		return;
+
+	int16 left, top, right, bottom;
+	_GetCellRange(rect, left, top, right, bottom);
+
+	for (int16 y = top; y <= bottom; ++y) {
+		for (int16 x = left; x <= right; ++x) {
+			const vector<MapObject*>& cell = _cells[y * _num_cells_x + x];
+			for (uint32 i = 0; i < cell.size(); ++i) {
+				MapObject* object = cell[i];
+				// An object spanning several of the searched cells is only appended
+				// from the first cell both its range and the searched range share.
+				if (x != max(left, object->grid_cell_left) || y != max(top, object->grid_cell_top))
+					continue;
+				objects.push_back(object);
+			}
+		}
+	}
+}
+
+
+
+void ObjectGrid::_GetCellRange(const MapRectangle& rect, int16& left, int16& top, int16& right, int16& bottom) const {
+	left = static_cast<int16>(floorf(rect.left / OBJECT_GRID_CELL_SIZE));
+	top = static_cast<int16>(floorf(rect.top / OBJECT_GRID_CELL_SIZE));
+	right = static_cast<int16>(floorf(rect.right / OBJECT_GRID_CELL_SIZE));
+	bottom = static_cast<int16>(floorf(rect.bottom / OBJECT_GRID_CELL_SIZE));
+
+	left = max<int16>(0, min<int16>(left, _num_cells_x - 1));
+	right = max<int16>(0, min<int16>(right, _num_cells_x - 1));
+	top = max<int16>(0, min<int16>(top, _num_cells_y - 1));
+	bottom = max<int16>(0, min<int16>(bottom, _num_cells_y - 1));
+}
+
+
+
+void ObjectGrid::_RemoveObject(MapObject* object) {
+	if (_cells.empty() || object->grid_cell_left < 0)
+		return;
+
+	for (int16 y = object->grid_cell_top; y <= object->grid_cell_bottom; ++y) {
+		for (int16 x = object->grid_cell_left; x <= object->grid_cell_right; ++x) {
+			vector<MapObject*>& cell = _cells[y * _num_cells_x + x];
+			vector<MapObject*>::iterator it = find(cell.begin(), cell.end(), object);
+			if (it != cell.end()) {
+				// The order of the objects in a cell doesn't matter
+				*it = cell.back();
+				cell.pop_back();
+			}
+		}
+	}
+
+	object->grid_cell_left = -1;
+	object->grid_cell_top = -1;
+	object->grid_cell_right = -1;
+	object->grid_cell_bottom = -1;
+}
+
+
+
+void ObjectGrid::_InsertObject(MapObject* object, int16 left, int16 top, int16 right, int16 bottom) {
+	if (_cells.empty())
+		return;
+
+	for (int16 y = top; y <= bottom; ++y) {
+		for (int16 x = left; x <= right; ++x)
+			_cells[y * _num_cells_x + x].push_back(object);
+	}
+
+	object->grid_cell_left = left;
+	object->grid_cell_top = top;
+	object->grid_cell_right = right;
+	object->grid_cell_bottom = bottom;
+}
+
+// ----------------------------------------------------------------------------
+// ---------- ObjectSupervisor Class Functions
+// ----------------------------------------------------------------------------
+
+bool ObjectSupervisor::Load(const CompiledMap& map_data) {
+	// Construct the collision grid, once the path finding thread using it is stopped
+	_path_finder.Reset();
+	_num_grid_x_axis = map_data.GetNumGridCols();
+	_num_grid_y_axis = map_data.GetNumGridRows();
+	_collision_grid.Load(map_data);
+	_path_finder.Initialize(&_collision_grid, true);
+
+	// Set up the object spatial indexes, registering again any object added beforehand
+	_ground_object_grid.Resize(_num_grid_x_axis, _num_grid_y_axis);
+	_sky_object_grid.Resize(_num_grid_x_axis, _num_grid_y_axis);
+	for (uint32 i = 0; i < _ground_objects.size(); ++i) {
+		_ground_objects[i]->object_grid = NULL;
+		_ground_object_grid.AddObject(_ground_objects[i]);
+	}
+	for (uint32 i = 0; i < _sky_objects.size(); ++i) {
+		_sky_objects[i]->object_grid = NULL;
+		_sky_object_grid.AddObject(_sky_objects[i]);
 	}
-	map_file.CloseTable();
-	_num_grid_x_axis = _collision_grid[0].size();
 	return true;
 }
 
 
 
 void ObjectSupervisor::Update() {
+	PROFILE_ZONE("ObjectSupervisor::Update");
+
+	// Keep the positions of the previous step, so that the objects can be drawn in between
+	SavePreviousPositions();
+
 	for (uint32 i = 0; i < _ground_objects.size(); ++i)
 		_ground_objects[i]->Update();
 	// Update save point animation and activeness.
@@ -744,9 +1004,26 @@ void ObjectSupervisor::Update() {
 	for (uint32 i = 0; i < _zones.size(); ++i)
 		_zones[i]->Update();
 
+	// Catch up with the collision rectangles changed without moving the objects
+	for (uint32 i = 0; i < _ground_objects.size(); ++i)
+		_ground_object_grid.UpdateObject(_ground_objects[i]);
+	for (uint32 i = 0; i < _sky_objects.size(); ++i)
+		_sky_object_grid.UpdateObject(_sky_objects[i]);
+
+	UpdatePathRequests(PATH_FINDING_FRAME_BUDGET);
+
 	// TODO: examine all sprites for movement and context change, then check all resident zones to see if the sprite has entered
 }
 
+void ObjectSupervisor::SavePreviousPositions() {
+	for (uint32 i = 0; i < _ground_objects.size(); ++i)
+		_ground_objects[i]->previous_position = _ground_objects[i]->position;
+	for (uint32 i = 0; i < _pass_objects.size(); ++i)
+		_pass_objects[i]->previous_position = _pass_objects[i]->position;
+	for (uint32 i = 0; i < _sky_objects.size(); ++i)
+		_sky_objects[i]->previous_position = _sky_objects[i]->position;
+}
+
 void ObjectSupervisor::DrawSavePoints() {
 	for (uint32 i = 0; i < _save_points.size(); ++i) {
 		_save_points[i]->Draw();
@@ -856,17 +1133,17 @@ MapObject* ObjectSupervisor::FindNearestObject(const VirtualSprite* sprite, floa
 		return NULL;
 	}
 
-	// Go through all objects and determine which (if any) lie within the search area
+	// Go through the objects near the search area and determine which (if any) lie within it
 	vector<MapObject*> valid_objects; // A vector to hold objects which are inside the search area (either partially or fully)
-	vector<MapObject*>* search_vector = NULL; // A pointer to the vector of objects to search
+	vector<MapObject*> search_vector; // The objects registered in the object grid cells overlapping the search area
 
 	// Only search the object layer that the sprite resides on. Note that we do not consider searching the pass layer.
 	if (sprite->sky_object)
-		search_vector = &_sky_objects;
+		_sky_object_grid.GetObjects(search_area, search_vector);
 	else
-		search_vector = &_ground_objects;
+		_ground_object_grid.GetObjects(search_area, search_vector);
 
-	for (vector<MapObject*>::iterator i = (*search_vector).begin(); i != (*search_vector).end(); i++) {
+	for (vector<MapObject*>::iterator i = search_vector.begin(); i != search_vector.end(); i++) {
 		if (*i == sprite) // Don't allow the sprite itself to be considered in the search
 			continue;
 
@@ -990,24 +1267,24 @@ COLLISION_TYPE ObjectSupervisor::DetectCollision(VirtualSprite* sprite,
 	// Check if the object's collision rectangel overlaps with any unwalkable elements on the collision grid
 	// Grid based collision is not done for objects in the sky layer
 	if (!sprite->sky_object) {
-		// Determine if the object's collision rectangle overlaps any unwalkable tiles
+		// Determine if the object's collision rectangle overlaps any unwalkable tiles at the object's current context
 		// Note that because the sprite's collision rectangle was previously determined to be within the map bounds,
-		// the map grid tile indeces referenced in this loop are all valid entries and do not need to be checked for out-of-bounds conditions
-		for (uint32 y = static_cast<uint32>(sprite_rect.top); y <= static_cast<uint32>(sprite_rect.bottom); ++y) {
-			for (uint32 x = static_cast<uint32>(sprite_rect.left); x <= static_cast<uint32>(sprite_rect.right); ++x) {
-				// Checks the collision grid at the row-column at the object's current context
-				if ((_collision_grid[y][x] & sprite->context) != 0) {
-					return WALL_COLLISION;
-				}
-			}
+		// the map grid tile indeces checked are all valid entries and do not need to be checked for out-of-bounds conditions
+		if (_collision_grid.HasWall(static_cast<uint32>(sprite_rect.left), static_cast<uint32>(sprite_rect.top),
+				static_cast<uint32>(sprite_rect.right), static_cast<uint32>(sprite_rect.bottom), sprite->context)) {
+			return WALL_COLLISION;
 		}
 	}
 
-	vector<MapObject*>* objects = sprite->sky_object ?
-		&_sky_objects : &_ground_objects;
+	// Only examine the objects registered in the object grid cells overlapping the sprite
+	_collision_candidates.clear();
+	if (sprite->sky_object)
+		_sky_object_grid.GetObjects(sprite_rect, _collision_candidates);
+	else
+		_ground_object_grid.GetObjects(sprite_rect, _collision_candidates);
 
 	std::vector<hoa_map::private_map::MapObject*>::const_iterator it, it_end;
-	for (it = objects->begin(), it_end = objects->end(); it != it_end; ++it) {
+	for (it = _collision_candidates.begin(), it_end = _collision_candidates.end(); it != it_end; ++it) {
 		MapObject *collision_object = *it;
 		// Check if the object exists and has the no_collision property enabled
 		if (!collision_object || collision_object->no_collision)
@@ -1036,7 +1313,7 @@ COLLISION_TYPE ObjectSupervisor::DetectCollision(VirtualSprite* sprite,
 } // bool ObjectSupervisor::DetectCollision(VirtualSprite* sprite, float x, float y, MapObject** collision_object_ptr)
 
 
-Path ObjectSupervisor::FindPath(VirtualSprite* sprite, const MapPosition& destination) {
+Path ObjectSupervisor::FindPath(VirtualSprite* sprite, const MapPosition& destination, const PathCorridor* corridor) {
 	// NOTE: Refer to the implementation of the A* algorithm to understand
 	// what all these lists and score values are for.
 
@@ -1044,7 +1321,7 @@ Path ObjectSupervisor::FindPath(VirtualSprite* sprite, const MapPosition& destin
 	// but we still use integer positions for path finding.
 	Path path;
 
-	if (!MapMode::CurrentInstance()->GetObjectSupervisor()->IsWithinMapBounds(sprite)) {
+	if (!IsWithinMapBounds(sprite)) {
 		IF_PRINT_WARNING(MAP_DEBUG) << "Sprite position is invalid" << endl;
 		return path;
 	}
@@ -1053,7 +1330,7 @@ Path ObjectSupervisor::FindPath(VirtualSprite* sprite, const MapPosition& destin
 	if (DetectCollision(sprite, destination.x, destination.y) == WALL_COLLISION)
 		return path;
 
-	if (!MapMode::CurrentInstance()->GetObjectSupervisor()->IsWithinMapBounds(destination.x, destination.y)) {
+	if (!IsWithinMapBounds(destination.x, destination.y)) {
 		IF_PRINT_WARNING(MAP_DEBUG) << "Invalid destination coordinates" << endl;
 		return path;
 	}
@@ -1070,60 +1347,110 @@ Path ObjectSupervisor::FindPath(VirtualSprite* sprite, const MapPosition& destin
 		return path;
 	}
 
-	std::vector<PathNode> open_list;
-	std::vector<PathNode> closed_list;
+	// Start a new search: the cells not stamped with the new search id are considered unvisited
+	uint32 num_cells = _num_grid_x_axis * _num_grid_y_axis;
+	++_path_search_id;
+	if (_path_cells.size() != num_cells || _path_search_id == 0) {
+		_path_cells.assign(num_cells, PathCell());
+		_path_search_id = 1;
+	}
+	_path_open_list.clear();
+
+	// The offsets of the eight adjacent nodes, the four lateral ones first
+	const int16 x_offsets[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+	const int16 y_offsets[8] = { 0, 0, -1, 1, -1, 1, -1, 1 };
 
 	// The current "best node"
 	PathNode best_node;
-	// Used to hold the eight adjacent nodes
-	PathNode nodes[8];
+	// Used to hold the adjacent node being checked
+	PathNode node;
 
 	// Temporary delta variables used in calculation of a node's heuristic (h score)
 	uint32 x_delta, y_delta;
 	// The number to add to a node's g_score, depending on whether it is a lateral or diagonal movement
 	int16 g_add;
 
-	open_list.push_back(source_node);
+	int32 source_index = source_node.tile_y * _num_grid_x_axis + source_node.tile_x;
+	int32 dest_index = dest.tile_y * _num_grid_x_axis + dest.tile_x;
+
+	PathCell& source_cell = _path_cells[source_index];
+	source_cell.search_id = _path_search_id;
+	source_cell.g_score = 0;
+	source_cell.parent_index = -1;
+	source_cell.collision_cost = 0;
+	source_cell.closed = false;
+	_path_open_list.push_back(source_node);
 
 	// We will try to keep the original offset all along.
 	float offset_x = GetFloatFraction(destination.x);
 	float offset_y = GetFloatFraction(destination.y);
 
-	while (open_list.empty() == false) {
-		sort(open_list.begin(), open_list.end());
-		best_node = open_list.back();
-		open_list.pop_back();
-		closed_list.push_back(best_node);
+	bool destination_reached = false;
+	while (_path_open_list.empty() == false) {
+		pop_heap(_path_open_list.begin(), _path_open_list.end());
+		best_node = _path_open_list.back();
+		_path_open_list.pop_back();
+
+		int32 best_index = best_node.tile_y * _num_grid_x_axis + best_node.tile_x;
+		PathCell& best_cell = _path_cells[best_index];
+
+		// A node is pushed again each time a better path to it is found.
+		// Only its first occurence popped out of the heap is relevant.
+		if (best_cell.closed)
+			continue;
+		best_cell.closed = true;
 
 		// Check if destination has been reached, and break out of the loop if so
-		if (best_node == dest)
+		if (best_index == dest_index) {
+			destination_reached = true;
 			break;
-
-		// Setup the coordinates of the 8 adjacent nodes to the best node
-		nodes[0].tile_x = best_node.tile_x - 1; nodes[0].tile_y = best_node.tile_y;
-		nodes[1].tile_x = best_node.tile_x + 1; nodes[1].tile_y = best_node.tile_y;
-		nodes[2].tile_x = best_node.tile_x;     nodes[2].tile_y = best_node.tile_y - 1;
-		nodes[3].tile_x = best_node.tile_x;     nodes[3].tile_y = best_node.tile_y + 1;
-		nodes[4].tile_x = best_node.tile_x - 1; nodes[4].tile_y = best_node.tile_y - 1;
-		nodes[5].tile_x = best_node.tile_x - 1; nodes[5].tile_y = best_node.tile_y + 1;
-		nodes[6].tile_x = best_node.tile_x + 1; nodes[6].tile_y = best_node.tile_y - 1;
-		nodes[7].tile_x = best_node.tile_x + 1; nodes[7].tile_y = best_node.tile_y + 1;
+		}
 
 		// Check the eight adjacent nodes
 		for (uint8 i = 0; i < 8; ++i) {
-			// ---------- (A): Check if all tiles are walkable
-			// Don't use 0.0f here for both since errors at the border between
-			// two positions may occure, especially when running.
-			COLLISION_TYPE collision_type = DetectCollision(sprite,
-															((float)nodes[i].tile_x) + offset_x,
-															((float)nodes[i].tile_y) + offset_y);
-
-			// Can't go through walls.
-			if (collision_type == WALL_COLLISION)
+			node.tile_x = best_node.tile_x + x_offsets[i];
+			node.tile_y = best_node.tile_y + y_offsets[i];
+			if (node.tile_x < 0 || node.tile_x >= static_cast<int16>(_num_grid_x_axis)
+					|| node.tile_y < 0 || node.tile_y >= static_cast<int16>(_num_grid_y_axis))
+				continue;
+			if (corridor != NULL && !corridor->Contains(node.tile_x, node.tile_y))
 				continue;
 
-			// ---------- (B): Check if the node is already in the closed list
-			if (find(closed_list.begin(), closed_list.end(), nodes[i]) != closed_list.end())
+			int32 index = node.tile_y * _num_grid_x_axis + node.tile_x;
+			PathCell& cell = _path_cells[index];
+
+			// ---------- (A): Check whether the node is walkable, only once per search
+			if (cell.search_id != _path_search_id) {
+				cell.search_id = _path_search_id;
+				cell.parent_index = -1;
+				cell.closed = false;
+				cell.collision_cost = 0;
+
+				// Don't use 0.0f here for both since errors at the border between
+				// two positions may occure, especially when running.
+				COLLISION_TYPE collision_type = DetectCollision(sprite,
+																((float)node.tile_x) + offset_x,
+																((float)node.tile_y) + offset_y);
+
+				// Can't go through walls.
+				if (collision_type == WALL_COLLISION) {
+					cell.closed = true;
+					continue;
+				}
+
+				// Add some g cost when there is another sprite there,
+				// so the NPC try to get around when possible,
+				// but will still go through it when there are no other choices.
+				if (collision_type == CHARACTER_COLLISION
+					|| collision_type == ENEMY_COLLISION)
+					cell.collision_cost = 20;
+
+				// Mark the node as not reached yet
+				cell.g_score = -1;
+			}
+
+			// ---------- (B): Check if the node is a wall or already processed
+			if (cell.closed)
 				continue;
 
 			// ---------- (C): If this point has been reached, the node is valid for the sprite to move to
@@ -1132,47 +1459,34 @@ Path ObjectSupervisor::FindPath(VirtualSprite* sprite, const MapPosition& destin
 				g_add = 10;
 			else
 				g_add = 14;
+			int32 g_score = best_cell.g_score + g_add + cell.collision_cost;
 
-			// Add some g cost when there is another sprite there,
-			// so the NPC try to get around when possible,
-			// but will still go through it when there are no other choices.
-			if (collision_type == CHARACTER_COLLISION
-				|| collision_type == ENEMY_COLLISION)
-				g_add += 20;
-
-			// Set the node's parent and calculate its g_score
-			nodes[i].parent_x = best_node.tile_x;
-			nodes[i].parent_y = best_node.tile_y;
-			nodes[i].g_score = best_node.g_score + g_add;
-
-			// ---------- (D): Check to see if the node is already on the open list and update it if necessary
-			vector<PathNode>::iterator iter = find(open_list.begin(), open_list.end(), nodes[i]);
-			if (iter != open_list.end()) {
-				// If its G is higher, it means that the path we are on is better, so switch the parent
-				if (iter->g_score > nodes[i].g_score) {
-					iter->g_score = nodes[i].g_score;
-					iter->f_score = nodes[i].g_score + iter->h_score;
-					iter->parent_x = nodes[i].parent_x;
-					iter->parent_y = nodes[i].parent_y;
-				}
-			}
-			// ---------- (E): Add the new node to the open list
-			else {
-				// Calculate the H and F score of the new node (the heuristic used is diagonal)
-				x_delta = abs(dest.tile_x - nodes[i].tile_x);
-				y_delta = abs(dest.tile_y - nodes[i].tile_y);
-				if (x_delta > y_delta)
-					nodes[i].h_score = 14 * y_delta + 10 * (x_delta - y_delta);
-				else
-					nodes[i].h_score = 14 * x_delta + 10 * (y_delta - x_delta);
-
-				nodes[i].f_score = nodes[i].g_score + nodes[i].h_score;
-				open_list.push_back(nodes[i]);
-			}
+			// ---------- (D): Keep the node score when it was already reached through a better path
+			if (cell.g_score >= 0 && cell.g_score <= g_score)
+				continue;
+
+			// ---------- (E): Add the node to the open list, with its new parent and score
+			cell.g_score = g_score;
+			cell.parent_index = best_index;
+
+			// Calculate the H and F score of the node (the heuristic used is diagonal)
+			x_delta = abs(dest.tile_x - node.tile_x);
+			y_delta = abs(dest.tile_y - node.tile_y);
+			if (x_delta > y_delta)
+				node.h_score = 14 * y_delta + 10 * (x_delta - y_delta);
+			else
+				node.h_score = 14 * x_delta + 10 * (y_delta - x_delta);
+
+			node.parent_x = best_node.tile_x;
+			node.parent_y = best_node.tile_y;
+			node.g_score = static_cast<int16>(g_score);
+			node.f_score = node.g_score + node.h_score;
+			_path_open_list.push_back(node);
+			push_heap(_path_open_list.begin(), _path_open_list.end());
 		} // for (uint8 i = 0; i < 8; ++i)
-	} // while (open_list.empty() == false)
+	} // while (_path_open_list.empty() == false)
 
-	if (open_list.empty() == true) {
+	if (!destination_reached) {
 		IF_PRINT_WARNING(MAP_DEBUG) << "could not find path to destination" << endl;
 		return path;
 	}
@@ -1180,25 +1494,99 @@ Path ObjectSupervisor::FindPath(VirtualSprite* sprite, const MapPosition& destin
 	// Add the destination node to the vector.
 	path.push_back(destination);
 
-	// Retain the last node parent, and remove it from the closed list
-	int16 parent_x = best_node.parent_x;
-	int16 parent_y = best_node.parent_y;
-	closed_list.pop_back();
-
-	// Go backwards through the closed list following the parent nodes to construct the path
-	for (vector<PathNode>::iterator iter = closed_list.end() - 1; iter != closed_list.begin(); --iter) {
-		if (iter->tile_y == parent_y && iter->tile_x == parent_x) {
-			MapPosition next_pos(((float)iter->tile_x) + offset_x, ((float)iter->tile_y) + offset_y);
-			path.push_back(next_pos);
-
-			parent_x = iter->parent_x;
-			parent_y = iter->parent_y;
-		}
+	// Go backwards from the destination parent to the source, following the parent nodes to construct the path
+	for (int32 index = _path_cells[dest_index].parent_index; index != source_index; index = _path_cells[index].parent_index) {
+		MapPosition next_pos(((float)(index % _num_grid_x_axis)) + offset_x, ((float)(index / _num_grid_x_axis)) + offset_y);
+		path.push_back(next_pos);
 	}
 	std::reverse(path.begin(), path.end());
 
 	return path;
-} // Path ObjectSupervisor::FindPath(const VirtualSprite* sprite, const MapPosition& destination)
+} // Path ObjectSupervisor::FindPath(const VirtualSprite* sprite, const MapPosition& destination, const PathCorridor* corridor)
+
+
+
+uint32 ObjectSupervisor::RequestPath(VirtualSprite* sprite, const MapPosition& destination) {
+	uint32 request_id = ++_last_path_request_id;
+	if (request_id == 0)
+		request_id = ++_last_path_request_id;
+
+	// Let FindPath() report the invalid positions
+	if (!IsWithinMapBounds(sprite) || !IsWithinMapBounds(destination.x, destination.y)
+			|| (static_cast<int16>(sprite->GetXPosition()) == static_cast<int16>(destination.x)
+			&& static_cast<int16>(sprite->GetYPosition()) == static_cast<int16>(destination.y))) {
+		_found_paths[request_id] = FindPath(sprite, destination);
+		return request_id;
+	}
+
+	// The grid elements covered by the sprite on a path node, as checked by DetectCollision()
+	MapRectangle rect = sprite->GetCollisionRectangle(GetFloatFraction(destination.x), GetFloatFraction(destination.y));
+	PathFootprint footprint;
+	footprint.context = (sprite->sky_object || sprite->no_collision) ? MAP_CONTEXT_NONE : sprite->context;
+	footprint.left = static_cast<int16>(floorf(rect.left));
+	footprint.top = static_cast<int16>(floorf(rect.top));
+	footprint.right = static_cast<int16>(floorf(rect.right));
+	footprint.bottom = static_cast<int16>(floorf(rect.bottom));
+
+	_path_requests[request_id] = PathRequest(sprite, destination);
+	_path_finder.RequestCorridor(request_id, footprint,
+		static_cast<uint32>(sprite->GetXPosition()), static_cast<uint32>(sprite->GetYPosition()),
+		static_cast<uint32>(destination.x), static_cast<uint32>(destination.y));
+	return request_id;
+}
+
+
+
+bool ObjectSupervisor::TakePath(uint32 request_id, Path& path) {
+	std::map<uint32, Path>::iterator it = _found_paths.find(request_id);
+	if (it == _found_paths.end())
+		return false;
+
+	path.swap(it->second);
+	_found_paths.erase(it);
+	return true;
+}
+
+
+
+void ObjectSupervisor::CancelPathRequest(uint32 request_id) {
+	if (_path_requests.erase(request_id) > 0)
+		_path_finder.CancelRequest(request_id);
+	_found_paths.erase(request_id);
+}
+
+
+
+void ObjectSupervisor::UpdatePathRequests(uint32 time_budget) {
+	uint32 start_time = SDL_GetTicks();
+	uint32 request_id;
+	PathFinder::CORRIDOR_STATUS status;
+
+	do {
+		if (!_path_finder.TakeCorridor(request_id, status, _path_corridor))
+			break;
+
+		std::map<uint32, PathRequest>::iterator it = _path_requests.find(request_id);
+		if (it == _path_requests.end())
+			continue;
+
+		Path& path = _found_paths[request_id];
+		if (status == PathFinder::CORRIDOR_UNREACHABLE) {
+			IF_PRINT_WARNING(MAP_DEBUG) << "could not find path to destination" << endl;
+		}
+		else {
+			if (status == PathFinder::CORRIDOR_FOUND)
+				path = FindPath(it->second.sprite, it->second.destination, &_path_corridor);
+
+			// The corridor may be blocked by sprites or objects while another way is free,
+			// and it can't be used when the sprite doesn't stand on a walkable element
+			if (path.empty())
+				path = FindPath(it->second.sprite, it->second.destination);
+		}
+
+		_path_requests.erase(it);
+	} while (SDL_GetTicks() - start_time < time_budget);
+}
 
 void ObjectSupervisor::ReloadVisiblePartyMember() {
 	// Don't do anything when there is no visible party member.
@@ -1250,7 +1638,7 @@ void ObjectSupervisor::DrawCollisionArea(const MapFrame* frame) {
 				x < static_cast<uint32>((frame->tile_x_start + frame->num_draw_x_axis) * 2); ++x) {
 
 			// Draw the collision rectangle
-			if (_collision_grid[y][x] & context_id)
+			if (_collision_grid.IsWall(x, y, context_id))
 				VideoManager->DrawRectangle(1.0f, 1.0f, Color(1.0f, 0.0f, 0.0f, 0.6f));
 
 			VideoManager->MoveRelative(1.0f, 0.0f);
@@ -21,6 +21,7 @@
 
 #include "engine/video/video.h"
 
+#include "modes/map/map_pathfinding.h"
 #include "modes/map/map_utils.h"
 #include "modes/map/map_treasure.h"
 
@@ -95,6 +96,12 @@ public:
 	MapPosition position;
 	//@}
 
+	/** \brief The coordinates of the object at the previous update step
+	*** Used to draw the object between its previous and current positions when the frames
+	*** are drawn at a different rate than the game is updated.
+	**/
+	MapPosition previous_position;
+
 	/** \brief The half-width and height of the image, in map grid coordinates.
 	*** The half_width member is indeed just that: half the width of the object's image. We keep
 	*** the half width rather than the full width because the origin of the object is its bottom
@@ -144,6 +151,15 @@ public:
 	bool draw_on_second_pass;
 	//@}
 
+	//! \name Spatial Indexing Members
+	//@{
+	//! \brief The object grid the object is registered in, or NULL when it isn't registered in any.
+	ObjectGrid* object_grid;
+
+	//! \brief The range of object grid cells the object collision rectangle was last registered in.
+	int16 grid_cell_left, grid_cell_top, grid_cell_right, grid_cell_bottom;
+	//@}
+
 	// ---------- Methods
 
 	/** \brief Updates the state of an object.
@@ -212,14 +228,14 @@ public:
 	void SetContext(MAP_CONTEXT ctxt)
 		{ context = ctxt; }
 
-	void SetPosition(float x, float y)
-		{ position.x = x; position.y = y; }
+	//! \note These three functions also update the object location in its object grid.
+	void SetPosition(float x, float y);
 
 	void SetXPosition(float x)
-		{ position.x = x; }
+		{ SetPosition(x, position.y); }
 
 	void SetYPosition(float y)
-		{ position.y = y; }
+		{ SetPosition(position.x, y); }
 
 	void SetImgHalfWidth(float width)
 		{ img_half_width = width; }
@@ -260,6 +276,9 @@ public:
 	float GetYPosition() const
 		{ return position.y; }
 
+	//! \brief Returns the position the object is drawn at, interpolated between the last two update steps
+	MapPosition GetDrawPosition() const;
+
 	float GetImgHalfWidth() const
 		{ return img_half_width; }
 
@@ -305,6 +324,120 @@ struct MapObject_Ptr_Less {
 };
 
 
+//! \brief The size of the side of an object grid cell, in collision grid elements.
+const uint16 OBJECT_GRID_CELL_SIZE = 4;
+
+/** ****************************************************************************
+*** \brief A uniform grid indexing map objects by their collision rectangles.
+***
+*** This is used as a broad-phase for collision detection and object searches, so
+*** that only the objects near a given area are examined instead of all of the
+*** objects of a layer. Each cell covers OBJECT_GRID_CELL_SIZE x OBJECT_GRID_CELL_SIZE
+*** collision grid elements, and an object is registered in every cell its collision
+*** rectangle overlaps. Objects out of the map bounds are registered in the border cells.
+***
+*** \note The objects are registered regardless of their context, which has to be
+*** checked by the callers along with the exact collision rectangle intersection.
+*** ***************************************************************************/
+class ObjectGrid {
+public:
+	ObjectGrid() :
+		_num_cells_x(0),
+		_num_cells_y(0)
+	{}
+
+	/** \brief Sets the size of the area covered by the grid and empties it
+	*** \param num_grid_x_axis The number of columns of the map collision grid
+	*** \param num_grid_y_axis The number of rows of the map collision grid
+	**/
+	void Resize(uint16 num_grid_x_axis, uint16 num_grid_y_axis);
+
+	//! \brief Registers an object in the cells overlapped by its collision rectangle.
+	void AddObject(MapObject* object);
+
+	/** \brief Moves an object to the cells overlapped by its current collision rectangle
+	*** Nothing is done when the object still overlaps the same cells, which is the common case.
+	**/
+	void UpdateObject(MapObject* object);
+
+	/** \brief Appends the objects whose registered cells overlap the given rectangle
+	*** \param rect The area to search, in collision grid coordinates
+	*** \param objects The vector to append the objects to. Each object is appended only once.
+	*** Nothing is appended until the grid is sized with Resize().
+	**/
+	void GetObjects(const MapRectangle& rect, std::vector<MapObject*>& objects) const;
+
+private:
+	//! \brief The number of cell columns and rows
+	uint16 _num_cells_x, _num_cells_y;
+
+	//! \brief The objects registered in each cell: _cells[cell_y * _num_cells_x + cell_x]
+	std::vector<std::vector<MapObject*> > _cells;
+
+	//! \brief Computes the range of cells overlapped by a rectangle, clamped to the grid bounds
+	void _GetCellRange(const MapRectangle& rect, int16& left, int16& top, int16& right, int16& bottom) const;
+
+	//! \brief Removes an object from the cells it was last registered in
+	void _RemoveObject(MapObject* object);
+
+	//! \brief Registers an object in the given range of cells
+	void _InsertObject(MapObject* object, int16 left, int16 top, int16 right, int16 bottom);
+}; // class ObjectGrid
+
+
+/** ****************************************************************************
+*** \brief The walls of the map collision grid, for every context.
+***
+*** The walls are stored as one plane of bits per context having walls, row by
+*** row, so that a rectangle of grid elements is checked a word at a time.
+*** ***************************************************************************/
+class CollisionGrid {
+public:
+	CollisionGrid() :
+		_num_grid_x_axis(0),
+		_num_grid_y_axis(0),
+		_words_per_row(0),
+		_version(0)
+	{}
+
+	//! \brief Loads the walls of every context from the map data
+	void Load(const CompiledMap& map_data);
+
+	uint16 GetGridXAxisSize() const
+		{ return _num_grid_x_axis; }
+
+	uint16 GetGridYAxisSize() const
+		{ return _num_grid_y_axis; }
+
+	//! \brief Returns a number changed each time the walls are loaded, used to tell whether the path finding data are up to date
+	uint32 GetVersion() const
+		{ return _version; }
+
+	//! \brief Tells whether a grid element is a wall in any of the given contexts
+	bool IsWall(uint32 x, uint32 y, uint32 context_mask) const;
+
+	/** \brief Tells whether a rectangle of grid elements holds a wall in any of the given contexts
+	*** \note The bounds are included, and the rectangle must lie within the grid
+	**/
+	bool HasWall(uint32 left, uint32 top, uint32 right, uint32 bottom, uint32 context_mask) const;
+
+private:
+	//! \brief The number of columns and rows of the grid
+	uint16 _num_grid_x_axis, _num_grid_y_axis;
+
+	//! \brief The number of uint32 values in a row of a plane
+	uint32 _words_per_row;
+
+	//! \brief The context mask of each plane
+	std::vector<uint32> _plane_contexts;
+
+	//! \brief The wall bits: the element (x, y) of a plane is the bit (x % 32) of _planes[(plane * rows + y) * _words_per_row + x / 32]
+	std::vector<uint32> _planes;
+
+	uint32 _version;
+}; // class CollisionGrid
+
+
 /** ****************************************************************************
 *** \brief Represents visible objects on the map that have no motion.
 ***
@@ -659,19 +792,20 @@ public:
 	//! \brief Sorts objects on all three layers according to their draw order
 	void SortObjects();
 
-	/** \brief Loads the collision grid data and saved state of all map objects
-	*** \param map_file A reference to the open map script file
+	/** \brief Loads the collision grid data and sets up the object grids
+	*** \param map_data The collision data of the map, compiled or read from the map file
 	*** \return Whether the collision data loading was successful.
-	***
-	*** The file must be open prior to making this call and additionally must
-	*** be at the highest level scope (i.e., there are no actively open tables
-	*** in the script descriptor object).
 	**/
-	bool Load(hoa_script::ReadScriptDescriptor& map_file);
+	bool Load(const CompiledMap& map_data);
 
 	//! \brief Updates the state of all map zones and objects
 	void Update();
 
+	/** \brief Sets the previous positions of the objects to their current ones
+	*** Done before each update step, and when the map isn't updated so that the objects are drawn still.
+	**/
+	void SavePreviousPositions();
+
 	/** \brief Draws the various object layers to the screen
 	*** \param frame A pointer to the information required to draw this frame
 	*** \note These functions do not reset the coordinate system and hence depend that the proper coordinate system
@@ -745,15 +879,45 @@ public:
 	/** \brief Finds a path from a sprite's current position to a destination
 	*** \param sprite A pointer of the sprite to find the path for
 	*** \param dest The destination coordinates
+	*** \param corridor The clusters the path may go through, or NULL to search the whole map
 	*** \param path A vector of PathNode objects storing the path
 	***
 	*** This algorithm uses the A* algorithm to find a path from a source to a destination.
-	*** This function ignores the position of all other objects and only concerns itself with
-	*** which map grid elements are walkable.
+	*** The open list is a binary heap and the per element scores, parents and closed states
+	*** are kept in a flat array the size of the collision grid, reused between calls.
+	*** Elements occupied by other sprites are walkable but more costly to go through.
 	***
 	*** \note If an error is detected or a path could not be found, the function will empty the path vector before returning
 	**/
-	Path FindPath(private_map::VirtualSprite* sprite, const MapPosition& destination);
+	Path FindPath(private_map::VirtualSprite* sprite, const MapPosition& destination, const PathCorridor* corridor = NULL);
+
+	/** \brief Queues the search of a path from a sprite's current position to a destination
+	*** \param sprite A pointer of the sprite to find the path for, which shouldn't move until the path is found
+	*** \param destination The destination coordinates
+	*** \return The id of the request, to give to TakePath()
+	***
+	*** The corridor of clusters the path goes through is first found on the walls only, using
+	*** the cluster and portal graph of the path finder, then the path is searched by FindPath()
+	*** within this corridor. The whole map is only searched when the other sprites or objects
+	*** block the corridor. The requests are handled by UpdatePathRequests().
+	**/
+	uint32 RequestPath(private_map::VirtualSprite* sprite, const MapPosition& destination);
+
+	/** \brief Gives the path found for a request
+	*** \param request_id The id returned by RequestPath()
+	*** \param path Set to the path found, empty if the destination can't be reached
+	*** \return False if the path isn't found yet
+	**/
+	bool TakePath(uint32 request_id, Path& path);
+
+	//! \brief Drops a path request, whether its path is found or not
+	void CancelPathRequest(uint32 request_id);
+
+	/** \brief Finds the paths of the queued requests whose corridor is found
+	*** \param time_budget The number of milliseconds after which no other request is handled
+	*** \note At least one request is handled when there is one, whatever its cost.
+	**/
+	void UpdatePathRequests(uint32 time_budget);
 
 	/** \brief Returns the pointer to the virtual focus.
 	**/
@@ -773,6 +937,15 @@ public:
 	**/
 	void ReloadVisiblePartyMember();
 
+	//! \brief Returns the number of columns and rows of the collision grid.
+	//@{
+	uint16 GetGridXAxisSize() const
+		{ return _num_grid_x_axis; }
+
+	uint16 GetGridYAxisSize() const
+		{ return _num_grid_y_axis; }
+	//@}
+
 	//! \brief Tells whether the collision coords are valid.
 	bool IsWithinMapBounds(float x, float y) const;
 
@@ -798,6 +971,34 @@ private:
 	**/
 	uint16 _num_grid_x_axis, _num_grid_y_axis;
 
+	//! \brief The spatial indexes of the ground and sky objects, used by collision detection and object searches.
+	ObjectGrid _ground_object_grid;
+	ObjectGrid _sky_object_grid;
+
+	//! \brief Holds the objects found near the area examined by DetectCollision(), reused between calls.
+	std::vector<private_map::MapObject*> _collision_candidates;
+
+	//! \brief The path finding state of each collision grid element: _path_cells[y * _num_grid_x_axis + x]
+	std::vector<private_map::PathCell> _path_cells;
+
+	//! \brief The id of the last path search, used to tell which elements of _path_cells are up to date.
+	uint32 _path_search_id;
+
+	//! \brief The path finding open list, kept as a binary heap and reused between searches.
+	std::vector<private_map::PathNode> _path_open_list;
+
+	//! \brief The path requests whose corridor is being searched, by request id
+	std::map<uint32, private_map::PathRequest> _path_requests;
+
+	//! \brief The paths found and not taken yet, by request id
+	std::map<uint32, Path> _found_paths;
+
+	//! \brief The id of the last path request made
+	uint32 _last_path_request_id;
+
+	//! \brief The corridor given by the path finder, reused between requests
+	private_map::PathCorridor _path_corridor;
+
 	//! \brief Holds the most recently generated object ID number
 	uint16 _last_id;
 
@@ -816,13 +1017,11 @@ private:
 	**/
 	private_map::MapSprite *_visible_party_member;
 
-	/** \brief A 2D vector indicating which grid element on the map sprites may be occupied by objects.
-	*** Each bit of each element in this grid corresponds to a context. So all together this entire grid
-	*** stores the collision information for all 32 possible map contexts.
-	*** \Note A position in this member is stored like this:
-	*** _collision_grid[y][x]
-	**/
-	std::vector<std::vector<uint32> > _collision_grid;
+	//! \brief Indicates which grid elements on the map may not be occupied by objects, in every context.
+	private_map::CollisionGrid _collision_grid;
+
+	//! \brief Finds the corridors of the path requests. Declared after the collision grid, so that its worker thread is stopped first.
+	private_map::PathFinder _path_finder;
 
 	/** \brief A map containing pointers to all of the sprites on a map.
 	*** This map does not include a pointer to the _virtual_focus object. The
@@ -0,0 +1,646 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   map_pathfinding.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Source file for the hierarchical path finding of map sprites
+*** **************************************************************************/
+
+#include "modes/map/map.h"
+#include "modes/map/map_objects.h"
+#include "modes/map/map_pathfinding.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_system;
+
+namespace hoa_map {
+
+namespace private_map {
+
+namespace {
+
+//! \brief The offsets of the eight adjacent grid elements, the four lateral ones first, as used by FindPath()
+const int32 X_OFFSETS[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+const int32 Y_OFFSETS[8] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+
+//! \brief Returns the cost of the shortest unobstructed path between two grid elements
+int32 GetDiagonalDistance(uint32 x1, uint32 y1, uint32 x2, uint32 y2) {
+	int32 x_delta = abs(static_cast<int32>(x1) - static_cast<int32>(x2));
+	int32 y_delta = abs(static_cast<int32>(y1) - static_cast<int32>(y2));
+	if (x_delta > y_delta)
+		return 14 * y_delta + 10 * (x_delta - y_delta);
+	else
+		return 14 * x_delta + 10 * (y_delta - x_delta);
+}
+
+//! \brief The open lists are binary heaps giving the lowest score first
+typedef std::pair<int32, uint32> OpenNode;
+
+} // namespace
+
+
+
+bool PathFootprint::operator<(const PathFootprint& other) const {
+	if (context != other.context)
+		return context < other.context;
+	if (left != other.left)
+		return left < other.left;
+	if (top != other.top)
+		return top < other.top;
+	if (right != other.right)
+		return right < other.right;
+	return bottom < other.bottom;
+}
+
+// -----------------------------------------------------------------------------
+// ---------- PathCorridor Class Functions
+// -----------------------------------------------------------------------------
+
+void PathCorridor::Set(uint32 num_grid_cols, uint32 num_grid_rows, const std::vector<uint32>& clusters) {
+	_num_cluster_cols = (num_grid_cols + PATH_CLUSTER_SIZE - 1) / PATH_CLUSTER_SIZE;
+	uint32 num_cluster_rows = (num_grid_rows + PATH_CLUSTER_SIZE - 1) / PATH_CLUSTER_SIZE;
+	_clusters.assign(_num_cluster_cols * num_cluster_rows, false);
+	for (uint32 i = 0; i < clusters.size(); ++i)
+		_clusters[clusters[i]] = true;
+}
+
+// -----------------------------------------------------------------------------
+// ---------- PathGraph Class Functions
+// -----------------------------------------------------------------------------
+
+void PathGraph::Build(const CollisionGrid& grid, const PathFootprint& footprint) {
+	_footprint = footprint;
+	_num_grid_cols = grid.GetGridXAxisSize();
+	_num_grid_rows = grid.GetGridYAxisSize();
+	_num_cluster_cols = (_num_grid_cols + PATH_CLUSTER_SIZE - 1) / PATH_CLUSTER_SIZE;
+	_num_cluster_rows = (_num_grid_rows + PATH_CLUSTER_SIZE - 1) / PATH_CLUSTER_SIZE;
+
+	// An element is walkable when the footprint lies within the map and doesn't overlap a wall,
+	// which is what DetectCollision() checks before looking at the objects
+	_walkable.assign(_num_grid_cols * _num_grid_rows, false);
+	for (uint32 y = 0; y < _num_grid_rows; ++y) {
+		int32 top = static_cast<int32>(y) + footprint.top;
+		int32 bottom = static_cast<int32>(y) + footprint.bottom;
+		if (top < 0 || bottom >= static_cast<int32>(_num_grid_rows))
+			continue;
+
+		for (uint32 x = 0; x < _num_grid_cols; ++x) {
+			int32 left = static_cast<int32>(x) + footprint.left;
+			int32 right = static_cast<int32>(x) + footprint.right;
+			if (left < 0 || right >= static_cast<int32>(_num_grid_cols))
+				continue;
+
+			_walkable[y * _num_grid_cols + x] = !grid.HasWall(left, top, right, bottom, footprint.context);
+		}
+	}
+
+	// Place the portals on the borders shared by two clusters
+	_nodes.clear();
+	_cluster_nodes.assign(_num_cluster_cols * _num_cluster_rows, std::vector<uint32>());
+	_cell_nodes.assign(_num_grid_cols * _num_grid_rows, -1);
+	for (uint32 cluster_y = 0; cluster_y < _num_cluster_rows; ++cluster_y) {
+		for (uint32 cluster_x = 0; cluster_x < _num_cluster_cols; ++cluster_x) {
+			uint32 left = cluster_x * PATH_CLUSTER_SIZE;
+			uint32 top = cluster_y * PATH_CLUSTER_SIZE;
+			uint32 width = min(PATH_CLUSTER_SIZE, _num_grid_cols - left);
+			uint32 height = min(PATH_CLUSTER_SIZE, _num_grid_rows - top);
+
+			if (cluster_x + 1 < _num_cluster_cols)
+				_AddPortals(left + width - 1, top, 0, 1, height, 1, 0);
+			if (cluster_y + 1 < _num_cluster_rows)
+				_AddPortals(left, top + height - 1, 1, 0, width, 0, 1);
+		}
+	}
+	_cell_nodes.clear();
+
+	// Link the portals of each cluster with the cost of the shortest path between them
+	for (uint32 cluster = 0; cluster < _cluster_nodes.size(); ++cluster) {
+		const std::vector<uint32>& cluster_nodes = _cluster_nodes[cluster];
+		for (uint32 i = 0; i < cluster_nodes.size(); ++i) {
+			Node& node = _nodes[cluster_nodes[i]];
+			_SearchCluster(node.cell);
+			for (uint32 j = 0; j < cluster_nodes.size(); ++j) {
+				int32 cost = _GetClusterCost(_nodes[cluster_nodes[j]].cell);
+				if (j != i && cost >= 0)
+					node.edges.push_back(Edge(cluster_nodes[j], cost));
+			}
+		}
+	}
+} // void PathGraph::Build(const CollisionGrid& grid, const PathFootprint& footprint)
+
+
+
+bool PathGraph::FindClusters(uint32 start_x, uint32 start_y, uint32 dest_x, uint32 dest_y, std::vector<uint32>& clusters) {
+	clusters.clear();
+
+	uint32 start_cell = start_y * _num_grid_cols + start_x;
+	uint32 dest_cell = dest_y * _num_grid_cols + dest_x;
+	uint32 start_cluster = _GetCluster(start_x, start_y);
+	uint32 dest_cluster = _GetCluster(dest_x, dest_y);
+
+	// The destination is a node of its own, set after the portals
+	uint32 dest_node = _nodes.size();
+	_node_scores.assign(_nodes.size() + 1, -1);
+	_node_parents.assign(_nodes.size() + 1, -1);
+	std::vector<OpenNode> open_list;
+
+	// The start is linked to the portals of its cluster, and to the destination when it can be reached within the cluster
+	_SearchCluster(start_cell);
+	const std::vector<uint32>& start_nodes = _cluster_nodes[start_cluster];
+	for (uint32 i = 0; i < start_nodes.size(); ++i) {
+		int32 cost = _GetClusterCost(_nodes[start_nodes[i]].cell);
+		if (cost < 0)
+			continue;
+
+		_node_scores[start_nodes[i]] = cost;
+		open_list.push_back(OpenNode(cost + GetDiagonalDistance(_nodes[start_nodes[i]].cell % _num_grid_cols,
+			_nodes[start_nodes[i]].cell / _num_grid_cols, dest_x, dest_y), start_nodes[i]));
+		push_heap(open_list.begin(), open_list.end(), greater<OpenNode>());
+	}
+	if (start_cluster == dest_cluster && _GetClusterCost(dest_cell) >= 0) {
+		_node_scores[dest_node] = _GetClusterCost(dest_cell);
+		open_list.push_back(OpenNode(_node_scores[dest_node], dest_node));
+		push_heap(open_list.begin(), open_list.end(), greater<OpenNode>());
+	}
+
+	// The portals of the destination cluster are linked to the destination. The costs are symmetric.
+	_SearchCluster(dest_cell);
+	std::vector<Edge> dest_edges;
+	const std::vector<uint32>& dest_nodes = _cluster_nodes[dest_cluster];
+	for (uint32 i = 0; i < dest_nodes.size(); ++i) {
+		int32 cost = _GetClusterCost(_nodes[dest_nodes[i]].cell);
+		if (cost >= 0)
+			dest_edges.push_back(Edge(dest_nodes[i], cost));
+	}
+
+	bool destination_reached = false;
+	while (open_list.empty() == false) {
+		pop_heap(open_list.begin(), open_list.end(), greater<OpenNode>());
+		OpenNode best = open_list.back();
+		open_list.pop_back();
+
+		if (best.second == dest_node) {
+			destination_reached = true;
+			break;
+		}
+
+		// A node is pushed again each time a better path to it is found, only its best occurence is relevant
+		const Node& node = _nodes[best.second];
+		int32 score = _node_scores[best.second];
+		if (best.first > score + GetDiagonalDistance(node.cell % _num_grid_cols, node.cell / _num_grid_cols, dest_x, dest_y))
+			continue;
+
+		for (uint32 i = 0; i < node.edges.size(); ++i) {
+			uint32 next = node.edges[i].node;
+			int32 next_score = score + node.edges[i].cost;
+			if (_node_scores[next] >= 0 && _node_scores[next] <= next_score)
+				continue;
+
+			_node_scores[next] = next_score;
+			_node_parents[next] = best.second;
+			open_list.push_back(OpenNode(next_score + GetDiagonalDistance(_nodes[next].cell % _num_grid_cols,
+				_nodes[next].cell / _num_grid_cols, dest_x, dest_y), next));
+			push_heap(open_list.begin(), open_list.end(), greater<OpenNode>());
+		}
+
+		if (node.cluster != dest_cluster)
+			continue;
+		for (uint32 i = 0; i < dest_edges.size(); ++i) {
+			if (dest_edges[i].node != best.second)
+				continue;
+
+			int32 dest_score = score + dest_edges[i].cost;
+			if (_node_scores[dest_node] < 0 || dest_score < _node_scores[dest_node]) {
+				_node_scores[dest_node] = dest_score;
+				_node_parents[dest_node] = best.second;
+				open_list.push_back(OpenNode(dest_score, dest_node));
+				push_heap(open_list.begin(), open_list.end(), greater<OpenNode>());
+			}
+		}
+	} // while (open_list.empty() == false)
+
+	if (!destination_reached)
+		return false;
+
+	clusters.push_back(start_cluster);
+	clusters.push_back(dest_cluster);
+	for (int32 node = _node_parents[dest_node]; node >= 0; node = _node_parents[node])
+		clusters.push_back(_nodes[node].cluster);
+
+	sort(clusters.begin(), clusters.end());
+	clusters.erase(unique(clusters.begin(), clusters.end()), clusters.end());
+	return true;
+} // bool PathGraph::FindClusters(...)
+
+
+
+void PathGraph::_AddPortals(uint32 first_x, uint32 first_y, uint32 step_x, uint32 step_y, uint32 length, uint32 cross_x, uint32 cross_y) {
+	uint32 run_start = 0;
+	uint32 run_length = 0;
+	for (uint32 i = 0; i <= length; ++i) {
+		uint32 x = first_x + i * step_x;
+		uint32 y = first_y + i * step_y;
+		if (i < length && IsWalkable(x, y) && IsWalkable(x + cross_x, y + cross_y)) {
+			if (run_length == 0)
+				run_start = i;
+			++run_length;
+			continue;
+		}
+		if (run_length == 0)
+			continue;
+
+		// Wide openings get a portal at both ends, so that the paths going along them aren't bent toward their middle
+		uint32 positions[2] = { run_start + run_length / 2, run_start + run_length / 2 };
+		if (run_length >= PATH_CLUSTER_SIZE / 2) {
+			positions[0] = run_start;
+			positions[1] = run_start + run_length - 1;
+		}
+		for (uint32 j = 0; j < 2; ++j) {
+			if (j == 1 && positions[1] == positions[0])
+				break;
+
+			uint32 cell = (first_y + positions[j] * step_y) * _num_grid_cols + first_x + positions[j] * step_x;
+			uint32 node = _GetNode(cell);
+			uint32 facing_node = _GetNode(cell + cross_y * _num_grid_cols + cross_x);
+			_nodes[node].edges.push_back(Edge(facing_node, 10));
+			_nodes[facing_node].edges.push_back(Edge(node, 10));
+		}
+		run_length = 0;
+	}
+}
+
+
+
+uint32 PathGraph::_GetNode(uint32 cell) {
+	if (_cell_nodes[cell] >= 0)
+		return _cell_nodes[cell];
+
+	Node node;
+	node.cell = cell;
+	node.cluster = _GetCluster(cell % _num_grid_cols, cell / _num_grid_cols);
+	_cell_nodes[cell] = _nodes.size();
+	_cluster_nodes[node.cluster].push_back(_nodes.size());
+	_nodes.push_back(node);
+	return _nodes.size() - 1;
+}
+
+
+
+void PathGraph::_SearchCluster(uint32 cell) {
+	uint32 left = ((cell % _num_grid_cols) / PATH_CLUSTER_SIZE) * PATH_CLUSTER_SIZE;
+	uint32 top = ((cell / _num_grid_cols) / PATH_CLUSTER_SIZE) * PATH_CLUSTER_SIZE;
+	int32 width = min(PATH_CLUSTER_SIZE, _num_grid_cols - left);
+	int32 height = min(PATH_CLUSTER_SIZE, _num_grid_rows - top);
+
+	_cluster_costs.assign(PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE, -1);
+	_cluster_open_list.clear();
+
+	uint32 origin = (cell / _num_grid_cols - top) * PATH_CLUSTER_SIZE + cell % _num_grid_cols - left;
+	_cluster_costs[origin] = 0;
+	_cluster_open_list.push_back(OpenNode(0, origin));
+
+	while (_cluster_open_list.empty() == false) {
+		pop_heap(_cluster_open_list.begin(), _cluster_open_list.end(), greater<OpenNode>());
+		OpenNode best = _cluster_open_list.back();
+		_cluster_open_list.pop_back();
+		if (best.first > _cluster_costs[best.second])
+			continue;
+
+		int32 best_x = best.second % PATH_CLUSTER_SIZE;
+		int32 best_y = best.second / PATH_CLUSTER_SIZE;
+		for (uint32 i = 0; i < 8; ++i) {
+			int32 x = best_x + X_OFFSETS[i];
+			int32 y = best_y + Y_OFFSETS[i];
+			if (x < 0 || x >= width || y < 0 || y >= height || !IsWalkable(left + x, top + y))
+				continue;
+
+			uint32 index = y * PATH_CLUSTER_SIZE + x;
+			int32 cost = best.first + (i < 4 ? 10 : 14);
+			if (_cluster_costs[index] >= 0 && _cluster_costs[index] <= cost)
+				continue;
+
+			_cluster_costs[index] = cost;
+			_cluster_open_list.push_back(OpenNode(cost, index));
+			push_heap(_cluster_open_list.begin(), _cluster_open_list.end(), greater<OpenNode>());
+		}
+	}
+} // void PathGraph::_SearchCluster(uint32 cell)
+
+
+
+int32 PathGraph::_GetClusterCost(uint32 cell) const {
+	return _cluster_costs[((cell / _num_grid_cols) % PATH_CLUSTER_SIZE) * PATH_CLUSTER_SIZE + (cell % _num_grid_cols) % PATH_CLUSTER_SIZE];
+}
+
+// -----------------------------------------------------------------------------
+// ---------- PathFinder Class Functions
+// -----------------------------------------------------------------------------
+
+bool PathFinder::CacheKey::operator<(const CacheKey& other) const {
+	if (start != other.start)
+		return start < other.start;
+	if (dest != other.dest)
+		return dest < other.dest;
+	if (version != other.version)
+		return version < other.version;
+	return footprint < other.footprint;
+}
+
+
+
+PathFinder::PathFinder() :
+	_grid(NULL),
+	_version(0),
+	_cache_hits(0),
+	_cache_misses(0),
+	_current_request_id(0),
+	_current_request_canceled(false),
+	_thread(NULL),
+	_semaphore(NULL),
+	_requests_semaphore(NULL),
+	_thread_running(false)
+{}
+
+
+
+PathFinder::~PathFinder() {
+	Reset();
+}
+
+
+
+void PathFinder::Initialize(const CollisionGrid* grid, bool use_worker_thread) {
+	Reset();
+	_grid = grid;
+	_version = grid->GetVersion();
+
+	// The system engine isn't created by every caller, e.g. the tests
+	if (use_worker_thread == false || SystemManager == NULL)
+		return;
+
+#if (THREAD_TYPE == SDL_THREADS)
+	_semaphore = SystemManager->CreateSemaphore(1);
+	_requests_semaphore = SystemManager->CreateSemaphore(0);
+	if (_semaphore != NULL && _requests_semaphore != NULL) {
+		_thread_running = true;
+		_thread = SystemManager->SpawnThread(&PathFinder::_WorkerThread, this);
+		if (_thread == NULL) {
+			IF_PRINT_WARNING(MAP_DEBUG) << "could not create the path finding thread" << endl;
+			_thread_running = false;
+		}
+	}
+#endif
+}
+
+
+
+void PathFinder::Reset() {
+	if (_thread != NULL) {
+		_thread_running = false;
+		// Wake the worker thread up, so that it sees it has to exit
+		SystemManager->UnlockThread(_requests_semaphore);
+		SystemManager->WaitForThread(_thread);
+		_thread = NULL;
+	}
+	if (_semaphore != NULL) {
+		SystemManager->DestroySemaphore(_semaphore);
+		_semaphore = NULL;
+	}
+	if (_requests_semaphore != NULL) {
+		SystemManager->DestroySemaphore(_requests_semaphore);
+		_requests_semaphore = NULL;
+	}
+
+	for (uint32 i = 0; i < _graphs.size(); ++i)
+		delete _graphs[i];
+	_graphs.clear();
+	_cache.clear();
+	_cache_order.clear();
+	_requests.clear();
+	_results.clear();
+	_current_request_id = 0;
+	_grid = NULL;
+}
+
+
+
+void PathFinder::RequestCorridor(uint32 request_id, const PathFootprint& footprint, uint32 start_x, uint32 start_y, uint32 dest_x, uint32 dest_y) {
+	Request request;
+	request.id = request_id;
+	request.footprint = footprint;
+	request.start_x = start_x;
+	request.start_y = start_y;
+	request.dest_x = dest_x;
+	request.dest_y = dest_y;
+
+	_Lock();
+	_requests.push_back(request);
+	_Unlock();
+
+	// Wake the worker thread up
+	if (_thread != NULL)
+		SystemManager->UnlockThread(_requests_semaphore);
+}
+
+
+
+bool PathFinder::TakeCorridor(uint32& request_id, CORRIDOR_STATUS& status, PathCorridor& corridor) {
+	if (_thread == NULL) {
+		if (_requests.empty())
+			return false;
+
+		Request request = _requests.front();
+		_requests.pop_front();
+		request_id = request.id;
+		status = FindCorridor(request.footprint, request.start_x, request.start_y, request.dest_x, request.dest_y, _clusters);
+	}
+	else {
+		_Lock();
+		if (_results.empty()) {
+			_Unlock();
+			return false;
+		}
+		request_id = _results.front().id;
+		status = _results.front().status;
+		_clusters.swap(_results.front().clusters);
+		_results.pop_front();
+		_Unlock();
+	}
+
+	if (status == CORRIDOR_FOUND)
+		corridor.Set(_grid->GetGridXAxisSize(), _grid->GetGridYAxisSize(), _clusters);
+	return true;
+}
+
+
+
+void PathFinder::CancelRequest(uint32 request_id) {
+	_Lock();
+	for (std::deque<Request>::iterator it = _requests.begin(); it != _requests.end(); ++it) {
+		if (it->id == request_id) {
+			_requests.erase(it);
+			break;
+		}
+	}
+	for (std::deque<Result>::iterator it = _results.begin(); it != _results.end(); ++it) {
+		if (it->id == request_id) {
+			_results.erase(it);
+			break;
+		}
+	}
+	if (_current_request_id == request_id)
+		_current_request_canceled = true;
+	_Unlock();
+}
+
+
+
+PathFinder::CORRIDOR_STATUS PathFinder::FindCorridor(const PathFootprint& footprint, uint32 start_x, uint32 start_y,
+	uint32 dest_x, uint32 dest_y, std::vector<uint32>& clusters)
+{
+	// The graphs and the corridors are only valid for the walls they were computed with
+	if (_grid->GetVersion() != _version) {
+		for (uint32 i = 0; i < _graphs.size(); ++i)
+			delete _graphs[i];
+		_graphs.clear();
+		_cache.clear();
+		_cache_order.clear();
+		_version = _grid->GetVersion();
+	}
+
+	CacheKey key;
+	key.footprint = footprint;
+	key.start = start_y * _grid->GetGridXAxisSize() + start_x;
+	key.dest = dest_y * _grid->GetGridXAxisSize() + dest_x;
+	key.version = _version;
+
+	// The counters are read by the main thread while the worker thread searches
+	std::map<CacheKey, CacheEntry>::const_iterator cached = _cache.find(key);
+	if (cached != _cache.end()) {
+		_Lock();
+		++_cache_hits;
+		_Unlock();
+		clusters = cached->second.clusters;
+		return cached->second.status;
+	}
+	_Lock();
+	++_cache_misses;
+	_Unlock();
+
+	PathGraph* graph = _GetGraph(footprint);
+	CacheEntry entry;
+	if (graph->IsWalkable(start_x, start_y) == false)
+		entry.status = CORRIDOR_UNKNOWN;
+	else if (graph->IsWalkable(dest_x, dest_y) == false)
+		entry.status = CORRIDOR_UNREACHABLE;
+	else if (graph->FindClusters(start_x, start_y, dest_x, dest_y, entry.clusters) == false)
+		entry.status = CORRIDOR_UNREACHABLE;
+	else
+		entry.status = CORRIDOR_FOUND;
+
+	// Forget the oldest corridor when the cache is full
+	if (_cache_order.size() >= PATH_CACHE_SIZE) {
+		_cache.erase(_cache_order.front());
+		_cache_order.pop_front();
+	}
+	_cache[key] = entry;
+	_cache_order.push_back(key);
+
+	clusters = entry.clusters;
+	return entry.status;
+} // PathFinder::CORRIDOR_STATUS PathFinder::FindCorridor(...)
+
+
+
+PathGraph* PathFinder::_GetGraph(const PathFootprint& footprint) {
+	for (uint32 i = 0; i < _graphs.size(); ++i) {
+		if (_graphs[i]->GetFootprint() == footprint)
+			return _graphs[i];
+	}
+
+	PathGraph* graph = new PathGraph();
+	graph->Build(*_grid, footprint);
+	_graphs.push_back(graph);
+	return graph;
+}
+
+
+
+void PathFinder::_WorkerThread() {
+	while (true) {
+		// Sleep until a request is queued or the thread is asked to exit
+		SystemManager->LockThread(_requests_semaphore);
+		if (_thread_running == false)
+			break;
+
+		_Lock();
+		// The request may have been canceled meanwhile
+		if (_requests.empty()) {
+			_Unlock();
+			continue;
+		}
+		Request request = _requests.front();
+		_requests.pop_front();
+		_current_request_id = request.id;
+		_current_request_canceled = false;
+		_Unlock();
+
+		Result result;
+		result.id = request.id;
+		result.status = FindCorridor(request.footprint, request.start_x, request.start_y, request.dest_x, request.dest_y, result.clusters);
+
+		_Lock();
+		if (_current_request_canceled == false)
+			_results.push_back(result);
+		_current_request_id = 0;
+		_Unlock();
+	}
+}
+
+
+
+uint32 PathFinder::GetNumberCacheHits() const {
+	_Lock();
+	uint32 cache_hits = _cache_hits;
+	_Unlock();
+	return cache_hits;
+}
+
+
+
+uint32 PathFinder::GetNumberCacheMisses() const {
+	_Lock();
+	uint32 cache_misses = _cache_misses;
+	_Unlock();
+	return cache_misses;
+}
+
+
+
+void PathFinder::_Lock() const {
+	if (_semaphore != NULL)
+		SystemManager->LockThread(_semaphore);
+}
+
+
+
+void PathFinder::_Unlock() const {
+	if (_semaphore != NULL)
+		SystemManager->UnlockThread(_semaphore);
+}
+
+} // namespace private_map
+
+} // namespace hoa_map
@@ -0,0 +1,356 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   map_pathfinding.h
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Header file for the hierarchical path finding of map sprites
+***
+*** The collision grid is cut in square clusters. For each sprite collision
+*** box and context, the clusters are linked by portals placed on the
+*** walkable parts of their borders, and the portals of a same cluster are
+*** linked with the cost of the shortest path between them (HPA*). Looking for
+*** a path then only goes through the portals, which gives the corridor of
+*** clusters the path lies in. The actual path is searched by the object
+*** supervisor within this corridor only, taking the other sprites and the
+*** objects into account.
+***
+*** The corridor searches only depend on the collision grid walls, so they
+*** are cached and may be run by a worker thread.
+*** **************************************************************************/
+
+#ifndef __MAP_PATHFINDING_HEADER__
+#define __MAP_PATHFINDING_HEADER__
+
+#include "defs.h"
+#include "utils.h"
+
+#include "engine/system.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace hoa_map {
+
+namespace private_map {
+
+//! \brief The number of collision grid elements on each side of a path finding cluster
+const uint32 PATH_CLUSTER_SIZE = 16;
+
+//! \brief The maximum number of corridors kept in the path finding cache
+const uint32 PATH_CACHE_SIZE = 128;
+
+//! \brief The number of milliseconds the path requests may take each frame
+const uint32 PATH_FINDING_FRAME_BUDGET = 3;
+
+/** ****************************************************************************
+*** \brief The part of the collision grid covered by a sprite, relative to its path node
+***
+*** A sprite standing on the path node (x, y) covers the collision grid elements
+*** from (x + left, y + top) to (x + right, y + bottom), bounds included.
+*** ***************************************************************************/
+class PathFootprint {
+public:
+	PathFootprint() :
+		context(0), left(0), top(0), right(0), bottom(0) {}
+
+	//! \brief The contexts whose walls block the sprite, or 0 when only the map bounds do
+	uint32 context;
+
+	int16 left, top, right, bottom;
+
+	bool operator==(const PathFootprint& other) const
+		{ return context == other.context && left == other.left && top == other.top && right == other.right && bottom == other.bottom; }
+
+	bool operator<(const PathFootprint& other) const;
+}; // class PathFootprint
+
+
+/** ****************************************************************************
+*** \brief The clusters a path may go through
+*** ***************************************************************************/
+class PathCorridor {
+public:
+	PathCorridor() :
+		_num_cluster_cols(0) {}
+
+	//! \brief Sets the corridor to the given clusters of a grid
+	void Set(uint32 num_grid_cols, uint32 num_grid_rows, const std::vector<uint32>& clusters);
+
+	//! \brief Tells whether a collision grid element lies in the corridor
+	bool Contains(uint32 x, uint32 y) const
+		{ return _clusters[(y / PATH_CLUSTER_SIZE) * _num_cluster_cols + x / PATH_CLUSTER_SIZE]; }
+
+private:
+	uint32 _num_cluster_cols;
+
+	//! \brief Whether each cluster of the grid is part of the corridor
+	std::vector<bool> _clusters;
+}; // class PathCorridor
+
+
+/** ****************************************************************************
+*** \brief The cluster and portal graph of the collision grid, for one footprint
+***
+*** The portals are collision grid elements lying on the border of a cluster.
+*** Each portal is linked to the portal facing it in the neighbour cluster, and
+*** to the portals of its cluster it can reach without leaving the cluster.
+*** ***************************************************************************/
+class PathGraph {
+public:
+	PathGraph() :
+		_num_grid_cols(0), _num_grid_rows(0), _num_cluster_cols(0), _num_cluster_rows(0) {}
+
+	//! \brief Computes the walkable elements, the portals and their links
+	void Build(const CollisionGrid& grid, const PathFootprint& footprint);
+
+	const PathFootprint& GetFootprint() const
+		{ return _footprint; }
+
+	//! \brief Tells whether the footprint fits at a grid element without touching a wall or the map bounds
+	bool IsWalkable(uint32 x, uint32 y) const
+		{ return _walkable[y * _num_grid_cols + x]; }
+
+	/** \brief Finds the clusters the shortest path between two walkable elements goes through
+	*** \param clusters Set to the indeces of the clusters of the path
+	*** \return False if the destination can't be reached
+	**/
+	bool FindClusters(uint32 start_x, uint32 start_y, uint32 dest_x, uint32 dest_y, std::vector<uint32>& clusters);
+
+private:
+	//! \brief A link from a portal to another one
+	struct Edge {
+		Edge(uint32 n, int32 c) :
+			node(n), cost(c) {}
+
+		uint32 node;
+		int32 cost;
+	};
+
+	//! \brief A portal
+	struct Node {
+		//! \brief The collision grid element index of the portal
+		uint32 cell;
+
+		uint32 cluster;
+
+		std::vector<Edge> edges;
+	};
+
+	PathFootprint _footprint;
+
+	uint32 _num_grid_cols, _num_grid_rows;
+
+	uint32 _num_cluster_cols, _num_cluster_rows;
+
+	//! \brief Whether the footprint fits at each collision grid element
+	std::vector<bool> _walkable;
+
+	std::vector<Node> _nodes;
+
+	//! \brief The portals of each cluster
+	std::vector<std::vector<uint32> > _cluster_nodes;
+
+	//! \brief The portal at each collision grid element, or -1. Used while building the graph.
+	std::vector<int32> _cell_nodes;
+
+	/** \brief The cost of the shortest path from the search origin to each element of the searched cluster,
+	*** or -1 when it isn't reachable. Reused between searches.
+	**/
+	std::vector<int32> _cluster_costs;
+
+	//! \brief The open list of the cluster searches, reused between searches
+	std::vector<std::pair<int32, uint32> > _cluster_open_list;
+
+	//! \brief The scores and parents of the portals during a search, reused between searches
+	//@{
+	std::vector<int32> _node_scores;
+	std::vector<int32> _node_parents;
+	//@}
+
+	//! \brief Returns the index of the cluster holding a grid element
+	uint32 _GetCluster(uint32 x, uint32 y) const
+		{ return (y / PATH_CLUSTER_SIZE) * _num_cluster_cols + x / PATH_CLUSTER_SIZE; }
+
+	//! \brief Adds the portals of the border between two clusters, along a run of grid elements
+	void _AddPortals(uint32 first_x, uint32 first_y, uint32 step_x, uint32 step_y, uint32 length, uint32 cross_x, uint32 cross_y);
+
+	//! \brief Returns the portal at a grid element, creating it if needed
+	uint32 _GetNode(uint32 cell);
+
+	/** \brief Computes the cost of the shortest paths from a grid element to every element of its cluster
+	*** The paths don't leave the cluster. The costs are stored in _cluster_costs, indexed by
+	*** the element position relative to the cluster.
+	**/
+	void _SearchCluster(uint32 cell);
+
+	//! \brief Returns the cost found by the last cluster search to a grid element of the cluster, or -1
+	int32 _GetClusterCost(uint32 cell) const;
+}; // class PathGraph
+
+
+/** ****************************************************************************
+*** \brief Finds the corridors of the path requests, caching the results
+***
+*** The requests are queued and their corridors are found either by a worker
+*** thread, or by the main thread when TakeCorridor() is called. The graphs of
+*** the footprints used and the cached corridors are dropped when the
+*** collision grid is loaded again.
+*** ***************************************************************************/
+class PathFinder {
+public:
+	//! \brief The result of a corridor search
+	enum CORRIDOR_STATUS {
+		//! The corridor is found
+		CORRIDOR_FOUND = 0,
+		//! The destination can't be reached
+		CORRIDOR_UNREACHABLE = 1,
+		//! The sprite doesn't stand on a walkable element, so the corridor can't be used
+		CORRIDOR_UNKNOWN = 2
+	};
+
+	PathFinder();
+
+	~PathFinder();
+
+	/** \brief Sets the collision grid the paths are searched on
+	*** \param use_worker_thread Whether the corridors should be searched by a worker thread
+	***
+	*** When the worker thread can't be created, the corridors are searched by the main thread.
+	**/
+	void Initialize(const CollisionGrid* grid, bool use_worker_thread);
+
+	/** \brief Stops the worker thread and drops the graphs, the cache and the requests
+	*** This must be done before the collision grid is loaded again.
+	**/
+	void Reset();
+
+	/** \brief Queues a corridor search
+	*** \param request_id The id of the request, given back by TakeCorridor()
+	*** \note The start and destination elements must lie within the collision grid
+	**/
+	void RequestCorridor(uint32 request_id, const PathFootprint& footprint, uint32 start_x, uint32 start_y, uint32 dest_x, uint32 dest_y);
+
+	/** \brief Gives the next finished corridor search
+	*** \param request_id Set to the id of the request
+	*** \param status Set to the search result
+	*** \param corridor Set to the corridor found
+	*** \return False if no search is finished
+	***
+	*** Without worker thread, this searches the corridor of the next request.
+	**/
+	bool TakeCorridor(uint32& request_id, CORRIDOR_STATUS& status, PathCorridor& corridor);
+
+	//! \brief Drops a request, whether it is queued or finished
+	void CancelRequest(uint32 request_id);
+
+	//! \brief Searches a corridor right away, using the cache
+	CORRIDOR_STATUS FindCorridor(const PathFootprint& footprint, uint32 start_x, uint32 start_y, uint32 dest_x, uint32 dest_y,
+		std::vector<uint32>& clusters);
+
+	//! \name Class Member Access Functions
+	//@{
+	uint32 GetNumberCacheHits() const;
+
+	uint32 GetNumberCacheMisses() const;
+
+	bool IsUsingWorkerThread() const
+		{ return _thread != NULL; }
+	//@}
+
+private:
+	PathFinder(const PathFinder&);
+	PathFinder& operator=(const PathFinder&);
+
+	//! \brief A queued corridor search
+	struct Request {
+		uint32 id;
+		PathFootprint footprint;
+		uint32 start_x, start_y, dest_x, dest_y;
+	};
+
+	//! \brief A finished corridor search
+	struct Result {
+		uint32 id;
+		CORRIDOR_STATUS status;
+		std::vector<uint32> clusters;
+	};
+
+	//! \brief The key of the cached corridors: the footprint, the start and destination elements and the grid version
+	struct CacheKey {
+		PathFootprint footprint;
+		uint32 start, dest, version;
+
+		bool operator<(const CacheKey& other) const;
+	};
+
+	//! \brief A cached corridor search result
+	struct CacheEntry {
+		CORRIDOR_STATUS status;
+		std::vector<uint32> clusters;
+	};
+
+	const CollisionGrid* _grid;
+
+	//! \brief The collision grid version the graphs and the cache were computed for
+	uint32 _version;
+
+	//! \brief The graphs of the footprints used so far
+	std::vector<PathGraph*> _graphs;
+
+	std::map<CacheKey, CacheEntry> _cache;
+
+	//! \brief The cached keys, oldest first
+	std::deque<CacheKey> _cache_order;
+
+	//! \brief The number of searches found or not in the cache, guarded like the requests
+	uint32 _cache_hits, _cache_misses;
+
+	//! \brief The clusters of the corridor given by TakeCorridor(), reused between calls
+	std::vector<uint32> _clusters;
+
+	std::deque<Request> _requests;
+
+	std::deque<Result> _results;
+
+	//! \brief The id of the request being searched by the worker thread, or 0
+	uint32 _current_request_id;
+
+	//! \brief Set when the request being searched by the worker thread is canceled
+	bool _current_request_canceled;
+
+	//! \brief The worker thread, or NULL when the corridors are searched by the main thread
+	Thread* _thread;
+
+	//! \brief Guards the requests and the results while the worker thread runs
+	Semaphore* _semaphore;
+
+	//! \brief Posted for each queued request, the worker thread waits on it while it has nothing to do
+	Semaphore* _requests_semaphore;
+
+	//! \brief Cleared to ask the worker thread to exit
+	volatile bool _thread_running;
+
+	//! \brief Returns the graph of a footprint, building it if needed
+	PathGraph* _GetGraph(const PathFootprint& footprint);
+
+	//! \brief The function run by the worker thread
+	void _WorkerThread();
+
+	void _Lock() const;
+	void _Unlock() const;
+}; // class PathFinder
+
+} // namespace private_map
+
+} // namespace hoa_map
+
+#endif // __MAP_PATHFINDING_HEADER__
@@ -13,12 +13,16 @@
 *** \brief   Source file for map mode tile management.
 *** ***************************************************************************/
 
+#include "engine/profiler.h"
 #include "engine/script/script.h"
 #include "engine/video/video.h"
 
 #include "modes/map/map.h"
+#include "modes/map/map_compiled.h"
 #include "modes/map/map_tiles.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace hoa_utils;
 using namespace hoa_script;
@@ -30,7 +34,11 @@ namespace private_map {
 
 TileSupervisor::TileSupervisor() :
 	_num_tile_on_x_axis(0),
-	_num_tile_on_y_axis(0)
+	_num_tile_on_y_axis(0),
+	_num_chunk_on_x_axis(0),
+	_num_chunk_on_y_axis(0),
+	_chunks_layout_version(0),
+	_loaded(false)
 {}
 
 
@@ -41,247 +49,71 @@ TileSupervisor::~TileSupervisor() {
 	for (uint32 i = 0; i < _tile_images.size(); i++)
 		delete(_tile_images[i]);
 
-	_tile_grid.clear();
+	// In case the loading was interrupted
+	_ClearLoadingData();
+
+	_tile_chunks.clear();
+	_context_chunks.clear();
+	_tile_contexts.clear();
 	_tile_images.clear();
 	_animated_tile_images.clear();
 }
 
 
-LAYER_TYPE getLayerType(const std::string& type) {
-	if (type == "ground")
-		return GROUND_LAYER;
-	else if (type == "sky")
-		return SKY_LAYER;
-	return INVALID_LAYER;
-}
-
-
-bool TileSupervisor::Load(ReadScriptDescriptor& map_file) {
-	// Load the map dimensions and do some basic sanity checks
-	_num_tile_on_y_axis = map_file.ReadInt("num_tile_rows");
-	_num_tile_on_x_axis = map_file.ReadInt("num_tile_cols");
-
-	vector<int32> context_inherits;
-	//map_file.ReadUIntVector("context_inherits", context_inherits);
-	map_file.OpenTable("contexts");
-	uint32 num_contexts = map_file.GetTableSize();
-	for (uint32 context_id = 0;  context_id < num_contexts; ++context_id) {
-		map_file.OpenTable(context_id);
-		int32 inheritance = map_file.ReadInt("inherit_from");
-
-		// The base context can't inherit from another one
-		if (context_id == 0)
-			inheritance = -1;
-
-		// A context can't inherit from a context with a higher id, or itself.
-		if ((int32)context_id <= inheritance || inheritance < -1)
-			inheritance = -1;
-
-		context_inherits.push_back(inheritance);
-
-		map_file.CloseTable();
-	}
-	map_file.CloseTable(); // contexts
-
-	// Load all of the tileset images that are used by this map
-
-	// Contains all of the tileset filenames used (string does not contain path information or file extensions)
-	vector<string> tileset_filenames;
-	// Temporarily retains all tile images loaded for each tileset. Each inner vector contains 256 StillImage objects
-	vector<vector<StillImage> > tileset_images;
-
-	map_file.ReadStringVector("tileset_filenames", tileset_filenames);
-
-	for (uint32 i = 0; i < tileset_filenames.size(); i++) {
-		// Construct the image filename from the tileset filename and create a new vector to use in the LoadMultiImage call
-		string image_filename = "img/tilesets/" + tileset_filenames[i] + ".png";
-		tileset_images.push_back(vector<StillImage>(TILES_PER_TILESET));
+bool TileSupervisor::Load(const CompiledMap& map_data) {
+	if (!LoadTileData(map_data))
+		return false;
 
-		// Each tileset image is 512x512 pixels, yielding 16 * 16 (== 256) 32x32 pixel tiles each
-		if (!ImageDescriptor::LoadMultiImageFromElementGrid(tileset_images[i], image_filename, 16, 16)) {
-			PRINT_ERROR << "failed to load tileset image: " << image_filename << endl;
+	// The tileset images are decoded as they are uploaded, as they may already be in texture memory
+	for (uint32 i = 0; i < _tileset_filenames.size(); ++i) {
+		if (!UploadTileset(i))
 			return false;
-		}
-
-		// The map mode coordinate system used corresponds to a tile size of (2.0, 2.0)
-		for (uint32 j = 0; j < TILES_PER_TILESET; j++) {
-			tileset_images[i][j].SetDimensions(2.0f, 2.0f);
-			tileset_images[i][j].Smooth(VideoManager->ShouldSmoothPixelArt());
-		}
-	}
-
-	if (!map_file.DoesTableExist("layers")) {
-		PRINT_ERROR << "No 'layers' table in the map file." << endl;
-		return false;
 	}
 
-	// Read in the map tile indeces from all tile layers for the base context
-	// The indeces stored for the map layers in this file directly correspond to a location within a tileset. Tilesets contain a total of 256 tiles
-	// each, so 0-255 correspond to the first tileset, 256-511 the second, etc. The tile location within the tileset is also determined by the index,
-	// where the first 16 indeces in the tileset range are the tiles of the first row (left to right), and so on.
-
-	// Create the base context
-	_tile_grid.clear();
-	_tile_grid.insert(make_pair(MAP_CONTEXT_01, Context()));
+	return FinishLoading();
+} // bool TileSupervisor::Load(const CompiledMap& map_data)
 
-	vector<int32> table_x_indeces; // Used to temporarily store a row of table indeces
 
-	map_file.OpenTable("layers");
-
-	uint32 layers_number = map_file.GetTableSize();
-
-	// layers[0]-[n]
-	for (uint32 layer_id = 0; layer_id < layers_number; ++layer_id) {
-		// Opens the sub-table: layers[layer_id]
-		if (!map_file.DoesTableExist(layer_id))
-			continue;
 
-		map_file.OpenTable(layer_id);
-
-		// Add a layer for the base context
-		_tile_grid[MAP_CONTEXT_01].resize(layer_id + 1);
-
-		LAYER_TYPE layer_type = getLayerType(map_file.ReadString("type"));
-
-		if (layer_type == INVALID_LAYER) {
-			PRINT_WARNING << "Ignoring unexisting layer type: " << layer_type
-				<< " in file: " << map_file.GetFilename() << endl;
-			map_file.CloseTable(); // layers[i]
-			continue;
-		}
+bool TileSupervisor::LoadTileData(const CompiledMap& map_data, bool standalone_scripts) {
+	_ClearLoadingData();
+	_loaded = false;
 
-		_tile_grid[MAP_CONTEXT_01][layer_id].layer_type = layer_type;
+	_num_tile_on_y_axis = map_data.GetNumTileRows();
+	_num_tile_on_x_axis = map_data.GetNumTileCols();
 
-		// Add the new tile rows (y axis)
-		_tile_grid[MAP_CONTEXT_01][layer_id].tiles.resize(_num_tile_on_y_axis);
+	// The names of the tilesets used by this map. Their images are loaded by DecodeTileset() and UploadTileset()
+	_tileset_filenames = map_data.GetTilesetFilenames();
+	_tileset_image_data.resize(_tileset_filenames.size());
+	_tileset_images.resize(_tileset_filenames.size());
+	_tileset_animations.resize(_tileset_filenames.size());
 
-		// Read the tile data
-		for (uint32 y = 0; y < _num_tile_on_y_axis; ++y) {
-			table_x_indeces.clear();
+	uint32 layers_number = map_data.GetNumLayers();
+	_layer_types.resize(layers_number);
+	for (uint32 layer_id = 0; layer_id < layers_number; ++layer_id)
+		_layer_types[layer_id] = static_cast<LAYER_TYPE>(map_data.GetLayerType(layer_id));
 
-			// Check to make sure tables are of the proper size
-			if (!map_file.DoesTableExist(y)) {
-				PRINT_ERROR << "the layers["<< layer_id <<"] table size was not equal to the number of tile rows specified by the map, "
-					" first missing row: " << y << endl;
-				return false;
-			}
-
-			map_file.ReadIntVector(y, table_x_indeces);
-
-			// Check the number of columns
-			if (table_x_indeces.size() != _num_tile_on_x_axis){
-				PRINT_ERROR << "the layers[" << layer_id << "]["<< y << "] table size was not equal to the number of tile columns specified by the map, "
-				"should have " << _num_tile_on_x_axis << " values."<< endl;
-				return false;
-			}
-
-			// Prepare the columns (x axis)
-			_tile_grid[MAP_CONTEXT_01][layer_id].tiles[y].resize(_num_tile_on_x_axis);
-
-			for (uint32 x = 0; x < _num_tile_on_x_axis; ++x) {
-				_tile_grid[MAP_CONTEXT_01][layer_id].tiles[y][x] = table_x_indeces[x];
-			}
-		}
-		map_file.CloseTable(); // layers[layer_id]
+	// The tile indeces of every context are already resolved from the context inheritance
+	// The indeces directly correspond to a location within a tileset. Tilesets contain a total of 256 tiles each,
+	// so 0-255 correspond to the first tileset, 256-511 the second, etc.
+	const uint32 context_size = layers_number * _num_tile_on_x_axis * _num_tile_on_y_axis;
+	std::vector<std::vector<int16> > all_tiles(map_data.GetNumContexts());
+	for (uint32 ctxt = 0; ctxt < all_tiles.size(); ++ctxt) {
+		if (context_size > 0)
+			all_tiles[ctxt].assign(map_data.GetTiles(ctxt, 0), map_data.GetTiles(ctxt, 0) + context_size);
 	}
 
-	map_file.CloseTable(); // layers
-
-	// Create each additional context for the map by loading its table data
-
-	// Load the tile data for each additional map context
-	for (uint32 ctxt = 1; ctxt < num_contexts; ++ctxt) {
-		MAP_CONTEXT this_context = static_cast<MAP_CONTEXT>(1 << ctxt);
-		string context_name = "context_";
-		if (ctxt < 10) // precede single digit context names with a zero
-			context_name += "0";
-		context_name += NumberToString(ctxt);
-
-		// Check wether the context inhjeritance id is lower than the current one.
-		if (context_inherits[ctxt] >= (int32)ctxt) {
-			PRINT_WARNING << "Invalid context inheritance found for context id: " << ctxt
-			<< ". Permitted values goes from -1 (none) to " << ctxt - 1 << endl;
-			continue;
-		}
-
-		// Initialize this context by making a copy of the base map context first, as most contexts re-use many of the same tiles from the base context
-		// If non-inheriting context, start with empty map!
-		if (context_inherits[ctxt] > -1) {
-			_tile_grid.insert(make_pair(this_context,
-										_tile_grid[GetContextMaskFromConstextId(context_inherits[ctxt])]));
-		}
-		else {
-			_tile_grid.insert(make_pair(this_context, Context()));
-
-			// Resize the context to have the same size as the base one
-			// The number of layers
-			_tile_grid[this_context].resize(layers_number);
-			// Fro each layer, set up the grid size
-			for (uint32 layer_id = 0; layer_id < layers_number; ++layer_id) {
-				// Type
-				_tile_grid[this_context][layer_id].layer_type = _tile_grid[MAP_CONTEXT_01][layer_id].layer_type;
-				// Height
-				_tile_grid[this_context][layer_id].tiles.resize(_num_tile_on_y_axis);
-				for (uint32 y = 0; y < _num_tile_on_y_axis; ++y) {
-					// and width
-					_tile_grid[this_context][layer_id].tiles[y].assign((size_t)_num_tile_on_x_axis, -1);
-				}
-			}
-		}
-
-		// Read the table corresponding to this context and modify each tile accordingly.
-		// The context table is an array of integer data. The size of this array should be divisible by four, as every consecutive group of four integers in
-		// this table represent one tile context element. The first integer corresponds to the tile layer (0 = lower, 1 = middle, 2 = upper), the second
-		// and third represent the row and column of the tile respectively, and the fourth value indicates which tile image should be used for this context.
-		// So if the first four entries in the context table were {0, 12, 26, 180}, this would set the lower layer tile at position (12, 26) to the tile
-		// index 180.
-		std::vector<int32> context_data;
-		map_file.ReadIntVector(context_name, context_data);
-		if (context_data.size() % 4 != 0) {
-			PRINT_WARNING <<  ", context data was not evenly divisible by four (incomplete context data)"
-				<< " in context: " << this_context << endl;
-			continue;
-		}
-
-		for (uint32 j = 0; j < context_data.size(); j += 4) {
-			int32 layer_id = context_data[j];
-			int32 y = context_data[j + 1];
-			int32 x = context_data[j + 2];
-			int32 tile_id = context_data[j + 3];
-
-			if (y >= _num_tile_on_y_axis ||
-					x >= _num_tile_on_x_axis ||
-					layer_id >= (int32)_tile_grid[this_context].size()) {
-				PRINT_WARNING << "Invalid context data found for context: " << this_context << ": layer id: " << layer_id
-					<< ", x: " << x << ", y: " << y << endl;
-				continue;
-			}
-
-			_tile_grid[this_context][layer_id].tiles[y][x] = tile_id;
-		}
-	} // for (uint32 ctxt = 1; ctxt < map_instance->_num_map_contexts; ++ctxt)
-
-
 	// Determine which tiles in each tileset are referenced in this map
 
 	// Used to determine whether each tile is used by the map or not. An entry of -1 indicates that particular tile is not used
-	vector<int16> tile_references;
+	vector<int16>& tile_references = _tile_references;
 	// Set size to be equal to the total number of tiles and initialize all entries to -1 (unreferenced)
-	tile_references.assign(tileset_filenames.size() * TILES_PER_TILESET, -1);
-
-	std::map<MAP_CONTEXT, Context>::const_iterator it = _tile_grid.begin();
-	std::map<MAP_CONTEXT, Context>::const_iterator it_end = _tile_grid.end();
-	// For each context
-	for (; it != it_end; ++it) {
-		// For each layer
-		for (uint32 layer_id = 0; layer_id < layers_number; ++layer_id) {
-			// For each tile id
-			for (uint32 y = 0; y < _num_tile_on_y_axis; ++y) {
-				for (uint32 x = 0; x < _num_tile_on_x_axis; ++x) {
-					if ((it->second)[layer_id].tiles[y][x] >= 0)
-						tile_references[ (it->second)[layer_id].tiles[y][x] ] = 0;
-				}
-			}
+	tile_references.assign(_tileset_filenames.size() * TILES_PER_TILESET, -1);
+
+	for (uint32 ctxt = 0; ctxt < all_tiles.size(); ++ctxt) {
+		for (uint32 i = 0; i < context_size; ++i) {
+			if (all_tiles[ctxt][i] >= 0)
+				tile_references[all_tiles[ctxt][i]] = 0;
 		}
 	}
 
@@ -302,37 +134,31 @@ bool TileSupervisor::Load(ReadScriptDescriptor& map_file) {
 	}
 
 	// Now, go back and re-assign all tile layer indeces with the translated indeces
-	std::map<MAP_CONTEXT, Context>::iterator it2 = _tile_grid.begin();
-	std::map<MAP_CONTEXT, Context>::iterator it2_end = _tile_grid.end();
-	// For each context
-	for (; it2 != it2_end; ++it2) {
-		// For each layer
-		for (uint32 layer_id = 0; layer_id < layers_number; ++layer_id) {
-			// For each tile id
-			for (uint32 y = 0; y < _num_tile_on_y_axis; ++y) {
-				for (uint32 x = 0; x < _num_tile_on_x_axis; ++x) {
-					if ((it2->second)[layer_id].tiles[y][x] >= 0)
-						(it2->second)[layer_id].tiles[y][x] = tile_references[ (it2->second)[layer_id].tiles[y][x] ];
-				}
-			}
+	for (uint32 ctxt = 0; ctxt < all_tiles.size(); ++ctxt) {
+		for (uint32 i = 0; i < context_size; ++i) {
+			if (all_tiles[ctxt][i] >= 0)
+				all_tiles[ctxt][i] = tile_references[all_tiles[ctxt][i]];
 		}
 	}
 
-	// Parse all of the tileset definition files and create any animated tile images that will be used
+	_StoreTileContexts(all_tiles);
+
+	// Parse all of the tileset definition files and retain the animations that will be used
 
 	// Used to access the tileset definition file
 	ReadScriptDescriptor tileset_script;
 	// Temporarily retains the animation data (every two elements corresponds to a pair of tile frame index and display time)
 	vector<uint32> animation_info;
-	// Temporarily holds all animated tile images. The map key is the value of the tile index, before reference translation is done in the next step
-	map<uint32, AnimatedImage*> tile_animations;
 
-	for (uint32 i = 0; i < tileset_filenames.size(); i++) {
-		if (tileset_script.OpenFile("dat/tilesets/" + tileset_filenames[i] + ".lua") == false) {
-			PRINT_ERROR << "map failed to load because it could not open a tileset definition file: " << tileset_script.GetFilename() << endl;
-			exit(1);
+	for (uint32 i = 0; i < _tileset_filenames.size(); i++) {
+		string tileset_filename = "dat/tilesets/" + _tileset_filenames[i] + ".lua";
+		bool tileset_opened = standalone_scripts ? tileset_script.OpenStandaloneFile(tileset_filename)
+			: tileset_script.OpenReadOnlyFile(tileset_filename);
+		if (!tileset_opened) {
+			PRINT_ERROR << "map failed to load because it could not open a tileset definition file: " << tileset_filename << endl;
+			return false;
 		}
-		tileset_script.OpenTable(tileset_filenames[i]);
+		tileset_script.OpenTable(_tileset_filenames[i]);
 
 		if (tileset_script.DoesTableExist("animated_tiles") == true) {
 			tileset_script.OpenTable("animated_tiles");
@@ -349,21 +175,107 @@ bool TileSupervisor::Load(ReadScriptDescriptor& map_file) {
 					continue;
 				}
 
-				AnimatedImage* new_animation = new AnimatedImage();
-				new_animation->SetDimensions(2.0f, 2.0f);
-
-				// Each pair of entries in the animation info indicate the tile frame index (k) and the time (k+1)
-				for (uint32 k = 0; k < animation_info.size(); k += 2) {
-					new_animation->AddFrame(tileset_images[i][animation_info[k]], animation_info[k+1]);
-				}
-				tile_animations.insert(make_pair(first_frame_index, new_animation));
+				_tileset_animations[i].push_back(animation_info);
 			}
 			tileset_script.CloseTable();
 		}
 
 		tileset_script.CloseTable();
 		tileset_script.CloseFile();
-	} // for (uint32 i = 0; i < tileset_filenames.size(); i++)
+	} // for (uint32 i = 0; i < _tileset_filenames.size(); i++)
+
+	return true;
+} // bool TileSupervisor::LoadTileData(const CompiledMap& map_data, bool standalone_scripts)
+
+
+
+bool TileSupervisor::DecodeTileset(uint32 tileset_index) {
+	if (tileset_index >= _tileset_filenames.size()) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "invalid tileset index: " << tileset_index << endl;
+		return false;
+	}
+
+	string image_filename = "img/tilesets/" + _tileset_filenames[tileset_index] + ".png";
+	// The tilesets stored in the map atlas are already in texture memory
+	if (_atlas_tilesets.find(image_filename) != _atlas_tilesets.end())
+		return true;
+
+	if (!_tileset_image_data[tileset_index].LoadImage(image_filename)) {
+		PRINT_ERROR << "failed to load tileset image: " << image_filename << endl;
+		return false;
+	}
+	return true;
+}
+
+
+
+bool TileSupervisor::UploadTileset(uint32 tileset_index) {
+	if (tileset_index >= _tileset_filenames.size()) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "invalid tileset index: " << tileset_index << endl;
+		return false;
+	}
+
+	// Construct the image filename from the tileset filename and create a new vector to use in the LoadMultiImage call
+	string image_filename = "img/tilesets/" + _tileset_filenames[tileset_index] + ".png";
+	vector<StillImage>& tileset_images = _tileset_images[tileset_index];
+	tileset_images.assign(TILES_PER_TILESET, StillImage());
+
+	// Each tileset image is 512x512 pixels, yielding 16 * 16 (== 256) 32x32 pixel tiles each
+	private_video::ImageMemory& image_data = _tileset_image_data[tileset_index];
+	bool tileset_loaded = (image_data.pixels != NULL)
+		? ImageDescriptor::LoadMultiImageFromElementGrid(tileset_images, image_filename, image_data, 16, 16)
+		: ImageDescriptor::LoadMultiImageFromElementGrid(tileset_images, image_filename, 16, 16);
+
+	// The decoded pixels are not needed anymore once in texture memory
+	if (image_data.pixels != NULL) {
+		free(image_data.pixels);
+		image_data.pixels = NULL;
+	}
+
+	if (!tileset_loaded) {
+		PRINT_ERROR << "failed to load tileset image: " << image_filename << endl;
+		return false;
+	}
+
+	// The map mode coordinate system used corresponds to a tile size of (2.0, 2.0)
+	for (uint32 j = 0; j < TILES_PER_TILESET; j++) {
+		tileset_images[j].SetDimensions(2.0f, 2.0f);
+		tileset_images[j].Smooth(VideoManager->ShouldSmoothPixelArt());
+	}
+	return true;
+} // bool TileSupervisor::UploadTileset(uint32 tileset_index)
+
+
+
+bool TileSupervisor::FinishLoading() {
+	vector<vector<StillImage> >& tileset_images = _tileset_images;
+	vector<int16>& tile_references = _tile_references;
+
+	// Create the animated tile images that will be used
+	// The map key is the value of the tile index, before reference translation
+	map<uint32, AnimatedImage*> tile_animations;
+
+	for (uint32 i = 0; i < _tileset_animations.size(); i++) {
+		if (tileset_images[i].size() != TILES_PER_TILESET) {
+			IF_PRINT_WARNING(MAP_DEBUG) << "a tileset wasn't uploaded: " << _tileset_filenames[i] << endl;
+			_ClearLoadingData();
+			return false;
+		}
+
+		for (uint32 j = 0; j < _tileset_animations[i].size(); j++) {
+			const vector<uint32>& animation_info = _tileset_animations[i][j];
+			uint32 first_frame_index = animation_info[0] + (i * TILES_PER_TILESET);
+
+			AnimatedImage* new_animation = new AnimatedImage();
+			new_animation->SetDimensions(2.0f, 2.0f);
+
+			// Each pair of entries in the animation info indicate the tile frame index (k) and the time (k+1)
+			for (uint32 k = 0; k < animation_info.size(); k += 2) {
+				new_animation->AddFrame(tileset_images[i][animation_info[k]], animation_info[k+1]);
+			}
+			tile_animations.insert(make_pair(first_frame_index, new_animation));
+		}
+	}
 
 	// Add all referenced tiles to the _tile_images vector, in the proper order
 
@@ -392,10 +304,30 @@ bool TileSupervisor::Load(ReadScriptDescriptor& map_file) {
 	}
 
 	// Remove all tileset images. Any tiles which were not added to _tile_images will no longer exist in memory
-	tileset_images.clear();
+	_ClearLoadingData();
+
+	_BuildLayerChunks();
 
+	_loaded = true;
 	return true;
-} // bool TileSupervisor::Load(ReadScriptDescriptor& map_file)
+} // bool TileSupervisor::FinishLoading()
+
+
+
+void TileSupervisor::_ClearLoadingData() {
+	for (uint32 i = 0; i < _tileset_image_data.size(); ++i) {
+		if (_tileset_image_data[i].pixels != NULL) {
+			free(_tileset_image_data[i].pixels);
+			_tileset_image_data[i].pixels = NULL;
+		}
+	}
+
+	_tileset_filenames.clear();
+	_tileset_image_data.clear();
+	_tileset_images.clear();
+	_tileset_animations.clear();
+	_tile_references.clear();
+}
 
 
 
@@ -407,46 +339,224 @@ void TileSupervisor::Update() {
 
 
 void TileSupervisor::DrawLayers(const MapFrame* frame, const LAYER_TYPE& layer_type) {
+	PROFILE_ZONE("TileSupervisor::DrawLayers");
+
 	MAP_CONTEXT context = MapMode::CurrentInstance()->GetCurrentContext();
 
-	std::map<MAP_CONTEXT, Context>::const_iterator it = _tile_grid.find(context);
-	if (it == _tile_grid.end())
+	// The texture coordinates recorded in the chunks are wrong once the tiles moved in their texture sheet
+	if (_loaded && _chunks_layout_version != TextureManager->GetTexSheetLayoutVersion())
+		_BuildLayerChunks();
+
+	uint32 context_id = 0;
+	while (context_id < _context_chunks.size() && static_cast<uint32>(context) != (1u << context_id))
+		++context_id;
+	if (context_id >= _context_chunks.size())
 		return;
 
 	// We'll use the top-left positions to render the tiles.
 	VideoManager->SetDrawFlags(VIDEO_BLEND, VIDEO_X_LEFT, VIDEO_Y_TOP, 0);
 
-	const Context& layers = it->second;
-
-	for (uint32 layer_id = 0; layer_id < layers.size(); ++layer_id) {
-
-		const Layer& layer = layers[layer_id];
-		if (layer.layer_type != layer_type)
+	const ContextChunks& layer_chunks = _context_chunks[context_id];
+
+	// We substract 0.5 horizontally and 1.0 vertically here
+	// because the video engine will display the map tiles using their
+	// top left coordinates to avoid a position computation flaw when specifying the tile
+	// coordinates from the bottom center point, as the engine does for everything else.
+	// The chunks are positioned relatively to the top-left corner of the map.
+	float origin_x = frame->tile_x_offset - 1.0f - frame->tile_x_start * 2.0f;
+	float origin_y = frame->tile_y_offset - 2.0f - frame->tile_y_start * 2.0f;
+
+	// Only the chunks overlapping the visible tiles are drawn
+	uint16 chunk_x_start = frame->tile_x_start / TILE_CHUNK_SIZE;
+	uint16 chunk_y_start = frame->tile_y_start / TILE_CHUNK_SIZE;
+	uint16 chunk_x_end = (frame->tile_x_start + frame->num_draw_x_axis - 1) / TILE_CHUNK_SIZE;
+	uint16 chunk_y_end = (frame->tile_y_start + frame->num_draw_y_axis - 1) / TILE_CHUNK_SIZE;
+	if (chunk_x_end >= _num_chunk_on_x_axis)
+		chunk_x_end = _num_chunk_on_x_axis - 1;
+	if (chunk_y_end >= _num_chunk_on_y_axis)
+		chunk_y_end = _num_chunk_on_y_axis - 1;
+
+	for (uint32 layer_id = 0; layer_id < _layer_types.size(); ++layer_id) {
+		if (_layer_types[layer_id] != layer_type)
 			continue;
 
-		// We substract 0.5 horizontally and 1.0 vertically here
-		// because the video engine will display the map tiles using their
-		// top left coordinates to avoid a position computation flaw when specifying the tile
-		// coordinates from the bottom center point, as the engine does for everything else.
-		VideoManager->Move(frame->tile_x_offset - 1.0f, frame->tile_y_offset - 2.0f);
-
-		for (uint32 y = static_cast<uint32>(frame->tile_y_start);
-			y < static_cast<uint32>(frame->tile_y_start + frame->num_draw_y_axis); ++y) {
-			for (uint32 x = static_cast<uint32>(frame->tile_x_start);
-					x < static_cast<uint32>(frame->tile_x_start + frame->num_draw_x_axis); ++x) {
-				// Draw a tile image if it exists at this location
-				if (layer.tiles[y][x] >= 0)
-					_tile_images[ layer.tiles[y][x] ]->Draw();
-
-				VideoManager->MoveRelative(2.0f, 0.0f);
-			} // x
-			VideoManager->MoveRelative(-static_cast<float>(frame->num_draw_x_axis * 2), 2.0f);
-		} // y
+		const std::vector<uint32>& chunks = layer_chunks[layer_id];
+
+		// Draw the still tiles of all the visible chunks at once
+		_visible_chunks.clear();
+		for (uint16 y = chunk_y_start; y <= chunk_y_end; ++y) {
+			for (uint16 x = chunk_x_start; x <= chunk_x_end; ++x) {
+				const LayerChunk& chunk = _tile_chunks[chunks[y * _num_chunk_on_x_axis + x]];
+				if (!chunk.still_tiles.IsEmpty())
+					_visible_chunks.push_back(&chunk.still_tiles);
+			}
+		}
+		VideoManager->Move(origin_x, origin_y);
+		StaticImageBatch::DrawBatches(_visible_chunks);
+
+		// Then draw their animated tiles
+		for (uint16 y = chunk_y_start; y <= chunk_y_end; ++y) {
+			for (uint16 x = chunk_x_start; x <= chunk_x_end; ++x) {
+				const LayerChunk& chunk = _tile_chunks[chunks[y * _num_chunk_on_x_axis + x]];
+				for (uint32 i = 0; i < chunk.animated_tiles.size(); ++i) {
+					VideoManager->Move(origin_x + chunk.animated_tiles_x[i] * 2.0f, origin_y + chunk.animated_tiles_y[i] * 2.0f);
+					chunk.animated_tiles[i]->Draw();
+				}
+			}
+		}
 	} // layer_id
 	// Restore the previous draw flags
 	VideoManager->SetDrawFlags(VIDEO_X_CENTER, VIDEO_Y_BOTTOM, 0);
 }
 
+
+
+int16 TileSupervisor::_GetTile(uint32 context_id, uint32 layer_id, uint32 x, uint32 y) const {
+	const TileContext& context = _tile_contexts[context_id];
+	uint32 position = (layer_id * _num_tile_on_y_axis + y) * _num_tile_on_x_axis + x;
+	if (context.inherit_from < 0)
+		return context.tiles[position];
+
+	std::vector<uint32>::const_iterator it = std::lower_bound(context.delta_positions.begin(), context.delta_positions.end(), position);
+	if (it != context.delta_positions.end() && *it == position)
+		return context.delta_tiles[it - context.delta_positions.begin()];
+	return _tile_contexts[context.inherit_from].tiles[position];
+}
+
+
+
+void TileSupervisor::_StoreTileContexts(std::vector<std::vector<int16> >& all_tiles) {
+	_tile_contexts.assign(all_tiles.size(), TileContext());
+	for (uint32 ctxt = 0; ctxt < all_tiles.size(); ++ctxt) {
+		const std::vector<int16>& tiles = all_tiles[ctxt];
+
+		// A different tile takes three times the memory of a tile stored whole, so the differences
+		// are only kept when less than a third of the tiles differ from a context stored whole.
+		int32 best_parent = -1;
+		uint32 best_count = tiles.size() / 3;
+		for (uint32 parent = 0; parent < ctxt; ++parent) {
+			if (_tile_contexts[parent].inherit_from >= 0)
+				continue;
+
+			const std::vector<int16>& parent_tiles = _tile_contexts[parent].tiles;
+			uint32 count = 0;
+			for (uint32 i = 0; i < tiles.size() && count < best_count; ++i) {
+				if (tiles[i] != parent_tiles[i])
+					++count;
+			}
+			if (count < best_count) {
+				best_parent = parent;
+				best_count = count;
+			}
+		}
+
+		TileContext& context = _tile_contexts[ctxt];
+		if (best_parent < 0) {
+			context.tiles.swap(all_tiles[ctxt]);
+			continue;
+		}
+
+		context.inherit_from = best_parent;
+		context.delta_positions.reserve(best_count);
+		context.delta_tiles.reserve(best_count);
+		const std::vector<int16>& parent_tiles = _tile_contexts[best_parent].tiles;
+		for (uint32 i = 0; i < tiles.size(); ++i) {
+			if (tiles[i] != parent_tiles[i]) {
+				context.delta_positions.push_back(i);
+				context.delta_tiles.push_back(tiles[i]);
+			}
+		}
+		all_tiles[ctxt].clear();
+	}
+} // void TileSupervisor::_StoreTileContexts(std::vector<std::vector<int16> >& all_tiles)
+
+
+
+void TileSupervisor::_BuildLayerChunks() {
+	_chunks_layout_version = TextureManager->GetTexSheetLayoutVersion();
+	_num_chunk_on_x_axis = (_num_tile_on_x_axis + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+	_num_chunk_on_y_axis = (_num_tile_on_y_axis + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+	const uint32 num_chunks = _num_chunk_on_x_axis * _num_chunk_on_y_axis;
+	const uint32 layer_size = _num_tile_on_x_axis * _num_tile_on_y_axis;
+
+	// Assign the chunks to the layers first. A context inheriting from another one
+	// only gets chunks of its own where some of its tiles differ.
+	uint32 next_chunk = 0;
+	_context_chunks.assign(_tile_contexts.size(), ContextChunks());
+	for (uint32 ctxt = 0; ctxt < _tile_contexts.size(); ++ctxt) {
+		const TileContext& context = _tile_contexts[ctxt];
+		ContextChunks& layer_chunks = _context_chunks[ctxt];
+		if (context.inherit_from < 0) {
+			layer_chunks.resize(_layer_types.size());
+			for (uint32 layer_id = 0; layer_id < layer_chunks.size(); ++layer_id) {
+				layer_chunks[layer_id].resize(num_chunks);
+				for (uint32 i = 0; i < num_chunks; ++i)
+					layer_chunks[layer_id][i] = next_chunk++;
+			}
+			continue;
+		}
+
+		layer_chunks = _context_chunks[context.inherit_from];
+		std::vector<bool> own_chunks(_layer_types.size() * num_chunks, false);
+		for (uint32 i = 0; i < context.delta_positions.size(); ++i) {
+			uint32 layer_id = context.delta_positions[i] / layer_size;
+			uint32 y = (context.delta_positions[i] % layer_size) / _num_tile_on_x_axis;
+			uint32 x = context.delta_positions[i] % _num_tile_on_x_axis;
+			uint32 chunk = (y / TILE_CHUNK_SIZE) * _num_chunk_on_x_axis + x / TILE_CHUNK_SIZE;
+			if (!own_chunks[layer_id * num_chunks + chunk]) {
+				own_chunks[layer_id * num_chunks + chunk] = true;
+				layer_chunks[layer_id][chunk] = next_chunk++;
+			}
+		}
+	}
+
+	_tile_chunks.clear();
+	_tile_chunks.resize(next_chunk);
+	std::vector<bool> built_chunks(next_chunk, false);
+
+	// The tiles are recorded with the coordinate system and draw flags used by DrawLayers()
+	VideoManager->PushState();
+	VideoManager->SetCoordSys(0.0f, SCREEN_GRID_X_LENGTH, SCREEN_GRID_Y_LENGTH, 0.0f);
+	VideoManager->SetDrawFlags(VIDEO_BLEND, VIDEO_X_LEFT, VIDEO_Y_TOP, 0);
+
+	for (uint32 ctxt = 0; ctxt < _tile_contexts.size(); ++ctxt) {
+		for (uint32 layer_id = 0; layer_id < _layer_types.size(); ++layer_id) {
+			for (uint16 chunk_y = 0; chunk_y < _num_chunk_on_y_axis; ++chunk_y) {
+				for (uint16 chunk_x = 0; chunk_x < _num_chunk_on_x_axis; ++chunk_x) {
+					// Shared chunks are built once, by the first context using them
+					uint32 chunk_index = _context_chunks[ctxt][layer_id][chunk_y * _num_chunk_on_x_axis + chunk_x];
+					if (built_chunks[chunk_index])
+						continue;
+					built_chunks[chunk_index] = true;
+
+					LayerChunk& chunk = _tile_chunks[chunk_index];
+					uint16 y_end = std::min<uint16>((chunk_y + 1) * TILE_CHUNK_SIZE, _num_tile_on_y_axis);
+					uint16 x_end = std::min<uint16>((chunk_x + 1) * TILE_CHUNK_SIZE, _num_tile_on_x_axis);
+					for (uint16 y = chunk_y * TILE_CHUNK_SIZE; y < y_end; ++y) {
+						for (uint16 x = chunk_x * TILE_CHUNK_SIZE; x < x_end; ++x) {
+							int16 tile_id = _GetTile(ctxt, layer_id, x, y);
+							if (tile_id < 0)
+								continue;
+
+							AnimatedImage* animation = dynamic_cast<AnimatedImage*>(_tile_images[tile_id]);
+							if (animation) {
+								chunk.animated_tiles.push_back(animation);
+								chunk.animated_tiles_x.push_back(x);
+								chunk.animated_tiles_y.push_back(y);
+							}
+							else {
+								chunk.still_tiles.AddImage(*static_cast<StillImage*>(_tile_images[tile_id]), x * 2.0f, y * 2.0f);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	VideoManager->PopState();
+} // void TileSupervisor::_BuildLayerChunks()
+
 } // namespace private_map
 
 } // namespace hoa_map
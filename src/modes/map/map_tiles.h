@@ -22,8 +22,12 @@
 #include "defs.h"
 #include "utils.h"
 
+#include "engine/video/sprite_batch.h"
+
 #include "map_utils.h"
 
+#include <set>
+
 namespace hoa_map {
 
 namespace private_map {
@@ -35,19 +39,58 @@ enum LAYER_TYPE {
 	INVALID_LAYER = 2
 };
 
-class Layer {
+/** ****************************************************************************
+*** \brief The tiles of every layer of a map context
+***
+*** The tiles are stored in a single row-major array for all the layers:
+*** tiles[(layer_id * rows + y) * columns + x]. Most contexts only change a few
+*** tiles of another one, so they are stored instead as the sorted list of the
+*** tiles differing from that context.
+*** ***************************************************************************/
+class TileContext {
 public:
-	LAYER_TYPE layer_type;
-	// Represents the tile indeces: i.e: tiles[y][x] = tile_id at (x,y)
-	std::vector< std::vector<int16> > tiles;
-
-	Layer():
-		layer_type(GROUND_LAYER)
+	TileContext() :
+		inherit_from(-1)
 	{}
+
+	//! \brief The index of the context whose tiles are used where no difference is recorded, or -1 if the tiles are stored whole
+	int32 inherit_from;
+
+	//! \brief The tile indeces of all the layers, when the context doesn't inherit from another one
+	std::vector<int16> tiles;
+
+	//! \brief The positions in the tiles array of the tiles differing from the inherited context, in ascending order
+	std::vector<uint32> delta_positions;
+
+	//! \brief The tile indeces at those positions
+	std::vector<int16> delta_tiles;
 };
 
-// A map context - A map file can have several, but at least one.
-typedef std::vector<Layer> Context;
+//! \brief The number of tiles on each side of a square layer chunk.
+const uint16 TILE_CHUNK_SIZE = 16;
+
+/** ****************************************************************************
+*** \brief The prebuilt geometry of a square area of a tile layer
+***
+*** The still tiles of the chunk are recorded once in a static image batch when
+*** the map is loaded, whereas the animated tiles are drawn one by one every
+*** frame, as their frames keep changing.
+*** ***************************************************************************/
+class LayerChunk {
+public:
+	//! \brief The still tiles of the chunk, positioned relatively to the map origin.
+	hoa_video::StaticImageBatch still_tiles;
+
+	//! \brief The animated tile images of the chunk and their tile coordinates.
+	//@{
+	std::vector<hoa_video::AnimatedImage*> animated_tiles;
+	std::vector<uint16> animated_tiles_x;
+	std::vector<uint16> animated_tiles_y;
+	//@}
+};
+
+// The chunks of each layer of a context: indeces in the chunk pool of chunks[layer_id][chunk_y * chunk_columns + chunk_x]
+typedef std::vector<std::vector<uint32> > ContextChunks;
 
 /** ****************************************************************************
 *** \brief A helper class to MapMode responsible for all tile data and operations
@@ -67,11 +110,48 @@ public:
 
 	~TileSupervisor();
 
-	/** \brief Handles all operations on loading tilesets and tile images from the map data file
-	*** \param map_file A reference to the Lua file containing the map data
-	*** \note The map file should already be opened with no Lua tables open
+	/** \brief Handles all operations on loading tilesets and tile images from the map data
+	*** \param map_data The tile data of the map, compiled or read from the map file
+	***
+	*** This runs every loading step below at once.
+	**/
+	bool Load(const CompiledMap& map_data);
+
+	/** \name Staged Loading Functions
+	*** \brief Load the tiles over several steps, so that a part of the work can be done in another thread
+	***
+	*** LoadTileData() and DecodeTileset() use neither the video engine nor the global Lua state when the
+	*** tileset definition files are opened standalone, and can thus be called from a loading thread. UploadTileset() and FinishLoading() must be called from the main thread afterwards.
+	**/
+	//@{
+	/** \brief Sets up the map dimensions and the tile layers of every context and reads the tileset definitions
+	*** \param map_data The tile data of the map, compiled or read from the map file
+	*** \param standalone_scripts Whether the tileset definition files should be opened in their own Lua state
 	**/
-	bool Load(hoa_script::ReadScriptDescriptor& map_file);
+	bool LoadTileData(const CompiledMap& map_data, bool standalone_scripts = false);
+
+	/** \brief Sets the tileset image files stored in the loaded atlases, which DecodeTileset() skips
+	*** This must be called from the main thread, before the loading thread starts. See TextureController::GetAtlasMultiImages().
+	**/
+	void SetAtlasTilesets(const std::set<std::string>& image_filenames)
+		{ _atlas_tilesets = image_filenames; }
+
+	//! \brief Decodes the image file of a tileset into system memory, unless it was given to SetAtlasTilesets()
+	bool DecodeTileset(uint32 tileset_index);
+
+	//! \brief Creates the tile images of a tileset, using the decoded image data when available
+	bool UploadTileset(uint32 tileset_index);
+
+	//! \brief Creates the animated tiles and the layer chunks once every tileset is uploaded
+	bool FinishLoading();
+
+	uint32 GetNumberTilesets() const
+		{ return _tileset_filenames.size(); }
+
+	//! \brief Tells whether the tiles are ready to be drawn
+	bool IsLoaded() const
+		{ return _loaded; }
+	//@}
 
 	//! \brief Updates all animated tile images
 	void Update();
@@ -101,11 +181,13 @@ private:
 	**/
 	uint16 _num_tile_on_y_axis;
 
-	/** \brief A map of 2D vectors that contains all of the map's tile objects.
-	*** Each key-value pair in the std::map represents a map context, thus the size of the std::map is equal to
-	*** the number of contexts in the game map (up to 32).
+	//! \brief The type of each tile layer, common to all the contexts.
+	std::vector<LAYER_TYPE> _layer_types;
+
+	/** \brief The tiles of every context, indexed by context id (up to 32).
+	*** The tile values are indeces in _tile_images, or -1 for no tile.
 	**/
-	std::map<MAP_CONTEXT, Context > _tile_grid;
+	std::vector<TileContext> _tile_contexts;
 
 	//! \brief Contains the image objects for all map tiles, both still and animated.
 	std::vector<hoa_video::ImageDescriptor*> _tile_images;
@@ -115,6 +197,68 @@ private:
 	*** _tile_images vector, which contains both still and animated images.
 	**/
 	std::vector<hoa_video::AnimatedImage*> _animated_tile_images;
+
+	//! \brief The number of chunk columns and rows covering the map.
+	uint16 _num_chunk_on_x_axis;
+	uint16 _num_chunk_on_y_axis;
+
+	/** \brief The prebuilt geometry of the tile layers.
+	*** A context shares the chunks of the context it inherits from where it has no different tiles.
+	**/
+	std::vector<LayerChunk> _tile_chunks;
+
+	//! \brief The chunks of every layer of every context, indexed by context id.
+	std::vector<ContextChunks> _context_chunks;
+
+	//! \brief The texture sheet layout version the chunks were built with. See TextureController::GetTexSheetLayoutVersion().
+	uint32 _chunks_layout_version;
+
+	//! \brief Used by DrawLayers() to gather the visible chunks of a layer without reallocating every frame.
+	std::vector<const hoa_video::StaticImageBatch*> _visible_chunks;
+
+	//! \brief Set once FinishLoading() is done.
+	bool _loaded;
+
+	/** \name Loading Data
+	*** \brief Retain the tileset data between the loading steps. Released by FinishLoading().
+	**/
+	//@{
+	//! \brief The tileset names used by the map (without path information or file extensions)
+	std::vector<std::string> _tileset_filenames;
+
+	//! \brief The tileset images decoded by DecodeTileset(), not yet turned into textures
+	std::vector<hoa_video::private_video::ImageMemory> _tileset_image_data;
+
+	//! \brief The tileset image files stored in the loaded atlases, set by SetAtlasTilesets()
+	std::set<std::string> _atlas_tilesets;
+
+	//! \brief The tile images of each tileset. Each inner vector contains 256 StillImage objects
+	std::vector<std::vector<hoa_video::StillImage> > _tileset_images;
+
+	/** \brief The animated tiles of each tileset, as read in the tileset definition files
+	*** In each animation, every two elements corresponds to a pair of tile frame index and display time.
+	**/
+	std::vector<std::vector<std::vector<uint32> > > _tileset_animations;
+
+	//! \brief The translated index of each tileset tile in _tile_images, or -1 if the map doesn't use it
+	std::vector<int16> _tile_references;
+	//@}
+
+	//! \brief Frees the tileset data retained between the loading steps.
+	void _ClearLoadingData();
+
+	//! \brief Returns the tile at the given position of a layer, or -1 for no tile.
+	int16 _GetTile(uint32 context_id, uint32 layer_id, uint32 x, uint32 y) const;
+
+	/** \brief Stores the tiles of the contexts as differences with another context when it saves memory
+	*** \param all_tiles The tiles of every context, stored whole. They are moved out of the vectors.
+	**/
+	void _StoreTileContexts(std::vector<std::vector<int16> >& all_tiles);
+
+	/** \brief Records the still tiles of every layer into chunks and sorts out the animated ones.
+	*** Called once the tile grid and the tile images have been loaded, and again whenever texture sheets are repacked.
+	**/
+	void _BuildLayerChunks();
 }; // class TileSupervisor
 
 } // namespace private_map
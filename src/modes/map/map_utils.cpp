@@ -16,6 +16,8 @@
 // Local map mode headers
 #include "map_utils.h"
 
+#include "engine/video/texture_atlas.h"
+
 using namespace std;
 
 namespace hoa_map {
@@ -129,6 +131,20 @@ MAP_CONTEXT GetContextMaskFromConstextId(uint32 id) {
 	return MAP_CONTEXT_NONE;
 }
 
+
+
+std::string GetMapAtlasFilename(const std::string& map_filename) {
+	std::string name = map_filename;
+	if (name.compare(0, 9, "dat/maps/") == 0)
+		name.erase(0, 9);
+
+	size_t extension = name.rfind('.');
+	if (extension != std::string::npos)
+		name.erase(extension);
+
+	return "img/atlases/maps/" + name + hoa_video::private_video::TEXTURE_ATLAS_EXTENSION;
+}
+
 } // namespace private_map
 
 } // namespace hoa_map
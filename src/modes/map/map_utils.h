@@ -117,6 +117,11 @@ enum MAP_CONTEXT {
 // Gives back the correct MAP_CONTEXT bitmask values corresponding to the given context id
 MAP_CONTEXT GetContextMaskFromConstextId(uint32 id);
 
+/** \brief Gives back the name of the texture atlas file baked for a map
+*** The atlas of 'dat/maps/layna_forest_entrance.lua' is 'img/atlases/maps/layna_forest_entrance.vta'.
+**/
+std::string GetMapAtlasFilename(const std::string& map_filename);
+
 /** \name Map Zone Types
 *** \brief Identifier types for the various classes of map zones
 ***
@@ -166,6 +171,11 @@ const float FAST_SPEED       = 110.0f;
 const float VERY_FAST_SPEED  = 75.0f;
 //@}
 
+/** \brief The longest distance, in map grid elements, an object may move by between two update steps and still be drawn interpolated
+*** Objects moving further were placed elsewhere rather than walking, so they are drawn at their new position right away.
+**/
+const float MAX_INTERPOLATED_DISTANCE = 1.0f;
+
 
 /** \name Sprite Direction Constants
 *** \brief Constants used for determining sprite directions
@@ -406,6 +416,36 @@ public:
 		{ return this->f_score > that.f_score; }
 }; // class PathNode
 
+
+/** ****************************************************************************
+*** \brief The path finding state of a single collision grid element.
+***
+*** The ObjectSupervisor keeps one of these per collision grid element, stored
+*** in a flat array, and reuses them from one path search to the next.
+*** An element data is only meaningful when its search_id is equal to the id of
+*** the search in progress, so that the array never has to be cleared.
+*** ***************************************************************************/
+class PathCell {
+public:
+	//! \brief The id of the last search which reached this element.
+	uint32 search_id;
+
+	//! \brief The lowest score found so far from the source to this element.
+	int32 g_score;
+
+	//! \brief The index of the element this one was reached from, or -1 for the source.
+	int32 parent_index;
+
+	//! \brief The additional score to step on this element, due to a sprite standing there.
+	int16 collision_cost;
+
+	//! \brief Whether the element is either a wall or has already been fully processed.
+	bool closed;
+
+	PathCell() : search_id(0), g_score(0), parent_index(-1), collision_cost(0), closed(false)
+		{}
+}; // class PathCell
+
 struct MapVector {
 	MapVector() :
 		x(0.0f),
@@ -428,6 +468,25 @@ typedef MapVector MapPosition;
 
 typedef std::vector<MapPosition> Path;
 
+class VirtualSprite;
+
+/** ****************************************************************************
+*** \brief A path search waiting for its corridor to be found
+*** ***************************************************************************/
+class PathRequest {
+public:
+	//! \brief The sprite to find the path for
+	VirtualSprite* sprite;
+
+	MapPosition destination;
+
+	PathRequest() : sprite(NULL)
+		{}
+
+	PathRequest(VirtualSprite* sprite_, const MapPosition& destination_) : sprite(sprite_), destination(destination_)
+		{}
+}; // class PathRequest
+
 } // namespace private_map
 
 } // namespace hoa_map
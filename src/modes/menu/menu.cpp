@@ -51,6 +51,9 @@ const uint32 win_start_x = (1024 - 800) / 2 - 40;
 const uint32 win_start_y = (768 - 600) / 2 + 15;
 const uint32 win_width = 208;
 
+//! \brief The texture atlas holding the menu interface images
+const std::string MENU_ATLAS_FILENAME = "img/atlases/menu.vta";
+
 ////////////////////////////////////////////////////////////////////////////////
 // MenuMode class -- Initialization and Destruction Code
 ////////////////////////////////////////////////////////////////////////////////
@@ -61,6 +64,9 @@ MenuMode::MenuMode(ustring locale_name, std::string locale_image) :
 	if (MENU_DEBUG)
 		cout << "MENU: MenuMode constructor invoked." << endl;
 
+	// Loaded first, so that the menu images are taken from the atlas when it exists
+	TextureManager->LoadAtlas(MENU_ATLAS_FILENAME);
+
 	_locale_name.SetPosition(win_start_x + 40, win_start_y + 457);
 	_locale_name.SetDimensions(500.0f, 50.0f);
 	_locale_name.SetTextStyle(TextStyle("title22"));
@@ -101,6 +107,33 @@ MenuMode::MenuMode(ustring locale_name, std::string locale_image) :
 	_shard_description.SetAlignment(VIDEO_X_LEFT, VIDEO_Y_CENTER);
 	_shard_description.SetDisplayText(UTranslate("This item is a crystal shard and can be associated with equipment."));
 
+	// Translate the labels of the bottom window
+	_time_label = MakeUnicodeString("Time: ");
+	_drunes_label = UTranslate("Drunes: ");
+
+	_stat_labels.push_back(UTranslate("STR: "));
+	_stat_labels.push_back(UTranslate("VIG: "));
+	_stat_labels.push_back(UTranslate("FRT: "));
+	_stat_labels.push_back(UTranslate("PRO: "));
+	_stat_labels.push_back(UTranslate("AGI: "));
+	_stat_labels.push_back(UTranslate("EVD: "));
+
+	_equipment_labels.push_back(UTranslate("Current Equipment:"));
+	_equipment_labels.push_back(UTranslate("Weapon"));
+	_equipment_labels.push_back(UTranslate("Head"));
+	_equipment_labels.push_back(UTranslate("Torso"));
+	_equipment_labels.push_back(UTranslate("Arm"));
+	_equipment_labels.push_back(UTranslate("Legs"));
+
+	_phys_atk_label = UTranslate("PHYS ATK: ");
+	_phys_def_label = UTranslate("PHYS DEF: ");
+	_meta_atk_label = UTranslate("META ATK: ");
+	_meta_def_label = UTranslate("META DEF: ");
+	_phys_atk_header = UTranslate("PHYS ATK:");
+	_phys_def_header = UTranslate("PHYS DEF:");
+	_meta_atk_header = UTranslate("META ATK:");
+	_meta_def_header = UTranslate("META DEF:");
+
 	_current_window = WINDOW_INVENTORY;
 
 
@@ -183,6 +216,8 @@ MenuMode::~MenuMode() {
 
 	if (_message_window != NULL)
 		delete _message_window;
+
+	TextureManager->UnloadAtlas(MENU_ATLAS_FILENAME);
 } // MenuMode::~MenuMode()
 
 
@@ -808,186 +843,116 @@ void MenuMode::_DrawBottomMenu() {
 	} // if SHOW_SKILLS
 	else if (_current_menu_showing == SHOW_EQUIP) {
 		GlobalCharacter* ch = dynamic_cast<GlobalCharacter*>(GlobalManager->GetActiveParty()->GetActorAtIndex(_equip_window._char_select.GetSelection()));
-		VideoManager->Text()->Draw(UTranslate("STR: ") + MakeUnicodeString(NumberToString(ch->GetStrength())));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("VIG: ") + MakeUnicodeString(NumberToString(ch->GetVigor())));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("FRT: ") + MakeUnicodeString(NumberToString(ch->GetFortitude())));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("PRO: ") + MakeUnicodeString(NumberToString(ch->GetProtection())));
+		uint32 stats[] = { ch->GetStrength(), ch->GetVigor(), ch->GetFortitude(), ch->GetProtection(), ch->GetAgility() };
+		for (uint32 i = 0; i < 5; ++i) {
+			FormatLabel(_bottom_text, _stat_labels[i], stats[i]);
+			VideoManager->Text()->Draw(_bottom_text);
+			VideoManager->MoveRelative(0, 20);
+		}
 
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("AGI: ") + MakeUnicodeString(NumberToString(ch->GetAgility())));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("EVD: ") + MakeUnicodeString(NumberToString(ch->GetEvade()) + "%"));
+		FormatLabel(_bottom_text, _stat_labels[5], static_cast<int32>(ch->GetEvade()));
+		_bottom_text += static_cast<uint16>('%');
+		VideoManager->Text()->Draw(_bottom_text);
 
 		VideoManager->Move(310, 577);
 
-		VideoManager->Text()->Draw(UTranslate("Current Equipment:"));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("Weapon"));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("Head"));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("Torso"));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("Arm"));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("Legs"));
+		VideoManager->Text()->Draw(_equipment_labels[0]);
+		for (uint32 i = 1; i < _equipment_labels.size(); ++i) {
+			VideoManager->MoveRelative(0, 20);
+			VideoManager->Text()->Draw(_equipment_labels[i]);
+		}
 
 		VideoManager->Move(400, 577);
 
 		VideoManager->MoveRelative(0, 20);
 		GlobalWeapon *wpn = ch->GetWeaponEquipped();
-		VideoManager->Text()->Draw(UTranslate("PHYS ATK: ") + MakeUnicodeString(NumberToString(wpn ? wpn->GetPhysicalAttack() : 0)));
-
-		VideoManager->MoveRelative(0, 20);
-		GlobalArmor *head_armor = ch->GetHeadArmorEquipped();
-		VideoManager->Text()->Draw(UTranslate("PHYS DEF: ") + MakeUnicodeString(NumberToString(head_armor ? head_armor->GetPhysicalDefense() : 0)));
-
-		VideoManager->MoveRelative(0, 20);
-		GlobalArmor *torso_armor = ch->GetTorsoArmorEquipped();
-		VideoManager->Text()->Draw(UTranslate("PHYS DEF: ") + MakeUnicodeString(NumberToString(torso_armor ? torso_armor->GetPhysicalDefense() : 0)));
-
-		VideoManager->MoveRelative(0, 20);
-		GlobalArmor *arm_armor = ch->GetArmArmorEquipped();
-		VideoManager->Text()->Draw(UTranslate("PHYS DEF: ") + MakeUnicodeString(NumberToString(arm_armor ? arm_armor->GetPhysicalDefense() : 0)));
-
-		VideoManager->MoveRelative(0, 20);
-		GlobalArmor *leg_armor = ch->GetLegArmorEquipped();
-		VideoManager->Text()->Draw(UTranslate("PHYS DEF: ") + MakeUnicodeString(NumberToString(leg_armor ? leg_armor->GetPhysicalDefense() : 0)));
+		FormatLabel(_bottom_text, _phys_atk_label, wpn ? wpn->GetPhysicalAttack() : 0);
+		VideoManager->Text()->Draw(_bottom_text);
+
+		GlobalArmor* armors[] = { ch->GetHeadArmorEquipped(), ch->GetTorsoArmorEquipped(), ch->GetArmArmorEquipped(), ch->GetLegArmorEquipped() };
+		for (uint32 i = 0; i < 4; ++i) {
+			VideoManager->MoveRelative(0, 20);
+			FormatLabel(_bottom_text, _phys_def_label, armors[i] ? armors[i]->GetPhysicalDefense() : 0);
+			VideoManager->Text()->Draw(_bottom_text);
+		}
 
 		VideoManager->Move(550, 577);
 
 		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("META ATK: ") + MakeUnicodeString(NumberToString(wpn ? wpn->GetMetaphysicalAttack() : 0)));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("META DEF: ") + MakeUnicodeString(NumberToString(head_armor ? head_armor->GetMetaphysicalDefense() : 0)));
+		FormatLabel(_bottom_text, _meta_atk_label, wpn ? wpn->GetMetaphysicalAttack() : 0);
+		VideoManager->Text()->Draw(_bottom_text);
 
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("META DEF: ") + MakeUnicodeString(NumberToString(torso_armor ? torso_armor->GetMetaphysicalDefense() : 0)));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("META DEF: ") + MakeUnicodeString(NumberToString(arm_armor ? arm_armor->GetMetaphysicalDefense() : 0)));
-
-		VideoManager->MoveRelative(0, 20);
-		VideoManager->Text()->Draw(UTranslate("META DEF: ") + MakeUnicodeString(NumberToString(leg_armor ? leg_armor->GetMetaphysicalDefense() : 0)));
+		for (uint32 i = 0; i < 4; ++i) {
+			VideoManager->MoveRelative(0, 20);
+			FormatLabel(_bottom_text, _meta_def_label, armors[i] ? armors[i]->GetMetaphysicalDefense() : 0);
+			VideoManager->Text()->Draw(_bottom_text);
+		}
 		VideoManager->SetDrawFlags(VIDEO_X_CENTER,VIDEO_Y_BOTTOM,0);
 
 
 		if (_equip_window._active_box == EQUIP_ACTIVE_LIST) {
 			VideoManager->Move(755, 577);
 
+			// Find the name and ratings of the selected equipment
+			GlobalObject* equipment = NULL;
+			bool is_weapon = false;
+			uint32 phys_rating = 0;
+			uint32 meta_rating = 0;
+
 			switch (_equip_window._equip_select.GetSelection()) {
 				case EQUIP_WEAPON:
 				{
 					GlobalWeapon* weapon = GlobalManager->GetInventoryWeapons()->at(_equip_window._equip_list.GetSelection());
-
-					VideoManager->Text()->Draw(weapon->GetName());
-					VideoManager->MoveRelative(0, 20);
-
-					VideoManager->Text()->Draw(UTranslate("PHYS ATK:"));
-					VideoManager->MoveRelative(0, 20);
-					VideoManager->Text()->Draw(MakeUnicodeString(NumberToString(weapon->GetPhysicalAttack())));
-					VideoManager->MoveRelative(0, 20);
-
-					VideoManager->Text()->Draw(UTranslate("META ATK:"));
-					VideoManager->MoveRelative(0, 20);
-					VideoManager->Text()->Draw(MakeUnicodeString(NumberToString(weapon->GetMetaphysicalAttack())));
-					VideoManager->MoveRelative(0, 20);
-
+					equipment = weapon;
+					is_weapon = true;
+					phys_rating = weapon->GetPhysicalAttack();
+					meta_rating = weapon->GetMetaphysicalAttack();
 					break;
 				} // case EQUIP_WEAPON
 				case EQUIP_HEADGEAR:
-				{
-					GlobalArmor* armor = GlobalManager->GetInventoryHeadArmor()->at(_equip_window._equip_list.GetSelection());
-
-					VideoManager->Text()->Draw(armor->GetName());
-					VideoManager->MoveRelative(0, 20);
-
-					VideoManager->Text()->Draw(UTranslate("PHYS DEF:"));
-					VideoManager->MoveRelative(0, 20);
-					VideoManager->Text()->Draw(MakeUnicodeString(NumberToString(armor->GetPhysicalDefense())));
-					VideoManager->MoveRelative(0, 20);
-
-					VideoManager->Text()->Draw(UTranslate("META DEF:"));
-					VideoManager->MoveRelative(0, 20);
-					VideoManager->Text()->Draw(MakeUnicodeString(NumberToString(armor->GetMetaphysicalDefense())));
-					VideoManager->MoveRelative(0, 20);
-
-					break;
-				} // case EQUIP_HEADGEAR
 				case EQUIP_BODYARMOR:
-				{
-					GlobalArmor* armor = GlobalManager->GetInventoryTorsoArmor()->at(_equip_window._equip_list.GetSelection());
-
-					VideoManager->Text()->Draw(armor->GetName());
-					VideoManager->MoveRelative(0, 20);
-
-					VideoManager->Text()->Draw(UTranslate("PHYS DEF:"));
-					VideoManager->MoveRelative(0, 20);
-					VideoManager->Text()->Draw(MakeUnicodeString(NumberToString(armor->GetPhysicalDefense())));
-					VideoManager->MoveRelative(0, 20);
-
-					VideoManager->Text()->Draw(UTranslate("META DEF:"));
-					VideoManager->MoveRelative(0, 20);
-					VideoManager->Text()->Draw(MakeUnicodeString(NumberToString(armor->GetMetaphysicalDefense())));
-					VideoManager->MoveRelative(0, 20);
-
-					break;
-				} // case EQUIP_BODYARMOR
 				case EQUIP_OFFHAND:
-				{
-					GlobalArmor* armor = GlobalManager->GetInventoryArmArmor()->at(_equip_window._equip_list.GetSelection());
-
-					VideoManager->Text()->Draw(armor->GetName());
-					VideoManager->MoveRelative(0, 20);
-
-					VideoManager->Text()->Draw(UTranslate("PHYS DEF:"));
-					VideoManager->MoveRelative(0, 20);
-					VideoManager->Text()->Draw(MakeUnicodeString(NumberToString(armor->GetPhysicalDefense())));
-					VideoManager->MoveRelative(0, 20);
-
-					VideoManager->Text()->Draw(UTranslate("META DEF:"));
-					VideoManager->MoveRelative(0, 20);
-					VideoManager->Text()->Draw(MakeUnicodeString(NumberToString(armor->GetMetaphysicalDefense())));
-					VideoManager->MoveRelative(0, 20);
-
-					break;
-				} // case EQUIP_OFFHAND
 				case EQUIP_LEGGINGS:
 				{
-					GlobalArmor* armor = GlobalManager->GetInventoryLegArmor()->at(_equip_window._equip_list.GetSelection());
-
-					VideoManager->Text()->Draw(armor->GetName());
-					VideoManager->MoveRelative(0, 20);
-
-					VideoManager->Text()->Draw(UTranslate("PHYS DEF:"));
-					VideoManager->MoveRelative(0, 20);
-					VideoManager->Text()->Draw(MakeUnicodeString(NumberToString(armor->GetPhysicalDefense())));
-					VideoManager->MoveRelative(0, 20);
-
-					VideoManager->Text()->Draw(UTranslate("META DEF:"));
-					VideoManager->MoveRelative(0, 20);
-					VideoManager->Text()->Draw(MakeUnicodeString(NumberToString(armor->GetMetaphysicalDefense())));
-					VideoManager->MoveRelative(0, 20);
-
+					vector<GlobalArmor*>* armor_list = NULL;
+					if (_equip_window._equip_select.GetSelection() == EQUIP_HEADGEAR)
+						armor_list = GlobalManager->GetInventoryHeadArmor();
+					else if (_equip_window._equip_select.GetSelection() == EQUIP_BODYARMOR)
+						armor_list = GlobalManager->GetInventoryTorsoArmor();
+					else if (_equip_window._equip_select.GetSelection() == EQUIP_OFFHAND)
+						armor_list = GlobalManager->GetInventoryArmArmor();
+					else
+						armor_list = GlobalManager->GetInventoryLegArmor();
+
+					GlobalArmor* armor = armor_list->at(_equip_window._equip_list.GetSelection());
+					equipment = armor;
+					phys_rating = armor->GetPhysicalDefense();
+					meta_rating = armor->GetMetaphysicalDefense();
 					break;
-				} // case EQUIP_LEGGINGS
+				} // case EQUIP_HEADGEAR, EQUIP_BODYARMOR, EQUIP_OFFHAND and EQUIP_LEGGINGS
 
 				default:
 					break;
 			} // switch
+
+			if (equipment != NULL) {
+				VideoManager->Text()->Draw(equipment->GetName());
+				VideoManager->MoveRelative(0, 20);
+
+				VideoManager->Text()->Draw(is_weapon ? _phys_atk_header : _phys_def_header);
+				VideoManager->MoveRelative(0, 20);
+				_bottom_text.clear();
+				AppendNumber(_bottom_text, phys_rating);
+				VideoManager->Text()->Draw(_bottom_text);
+				VideoManager->MoveRelative(0, 20);
+
+				VideoManager->Text()->Draw(is_weapon ? _meta_atk_header : _meta_def_header);
+				VideoManager->MoveRelative(0, 20);
+				_bottom_text.clear();
+				AppendNumber(_bottom_text, meta_rating);
+				VideoManager->Text()->Draw(_bottom_text);
+				VideoManager->MoveRelative(0, 20);
+			}
 		} // if EQUIP_ACTIVE_LIST
 	} // if SHOW_EQUIP
 	else {
@@ -996,20 +961,21 @@ void MenuMode::_DrawBottomMenu() {
 
 		// Draw Played Time
 		VideoManager->MoveRelative(-40, 60);
-		std::ostringstream os_time;
-		uint8 hours = SystemManager->GetPlayHours();
-		uint8 minutes = SystemManager->GetPlayMinutes();
-		uint8 seconds = SystemManager->GetPlaySeconds();
-		os_time << (hours < 10 ? "0" : "") << static_cast<uint32>(hours) << ":";
-		os_time << (minutes < 10 ? "0" : "") << static_cast<uint32>(minutes) << ":";
-		os_time << (seconds < 10 ? "0" : "") << static_cast<uint32>(seconds);
-
-		std::string time = std::string("Time: ") + os_time.str();
-		VideoManager->Text()->Draw(MakeUnicodeString(time));
+		uint8 time[] = { SystemManager->GetPlayHours(), SystemManager->GetPlayMinutes(), SystemManager->GetPlaySeconds() };
+		_bottom_text = _time_label;
+		for (uint32 i = 0; i < 3; ++i) {
+			if (i > 0)
+				_bottom_text += static_cast<uint16>(':');
+			if (time[i] < 10)
+				_bottom_text += static_cast<uint16>('0');
+			AppendNumber(_bottom_text, time[i]);
+		}
+		VideoManager->Text()->Draw(_bottom_text);
 
 		// Display the current funds that the party has
 		VideoManager->MoveRelative(0, 30);
-		VideoManager->Text()->Draw(UTranslate("Drunes: ") + MakeUnicodeString(NumberToString(GlobalManager->GetDrunes())));
+		FormatLabel(_bottom_text, _drunes_label, GlobalManager->GetDrunes());
+		VideoManager->Text()->Draw(_bottom_text);
 
 		if (!_locale_graphic.GetFilename().empty()) {
 			VideoManager->SetDrawFlags(VIDEO_X_RIGHT, VIDEO_Y_BOTTOM, 0);
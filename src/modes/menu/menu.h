@@ -196,6 +196,27 @@ private:
 	//! \brief Test indicating that the item is a shard and can be associated with equipment.
 	hoa_gui::TextBox _shard_description;
 
+	/** \name Bottom Window Labels
+	*** \brief The labels drawn in the bottom window, translated once rather than at every draw
+	**/
+	//@{
+	hoa_utils::ustring _time_label;
+	hoa_utils::ustring _drunes_label;
+
+	//! \brief The labels of the character stats, from strength to evade
+	std::vector<hoa_utils::ustring> _stat_labels;
+
+	//! \brief The "Current Equipment:" title, followed by the labels of the equipment slots
+	std::vector<hoa_utils::ustring> _equipment_labels;
+
+	//! \brief The labels of the attack and defense ratings, followed by a rating, then on a line of their own
+	hoa_utils::ustring _phys_atk_label, _phys_def_label, _meta_atk_label, _meta_def_label;
+	hoa_utils::ustring _phys_atk_header, _phys_def_header, _meta_atk_header, _meta_def_header;
+	//@}
+
+	//! \brief The buffer each line of text of the bottom window is formatted into, reused at every draw
+	hoa_utils::ustring _bottom_text;
+
 	/** \name Main Display Windows
 	*** \brief The various menu windows that are displayed in menu mode
 	**/
@@ -37,12 +37,29 @@ namespace hoa_menu {
 
 namespace private_menu {
 
+//! \brief Sets a ustring to a label followed by points and their maximum, as "HP: 45 (120)"
+static void FormatPoints(ustring& text, const ustring& label, int32 points, int32 max_points) {
+	FormatLabel(text, label, points);
+	text += static_cast<uint16>(' ');
+	text += static_cast<uint16>('(');
+	AppendNumber(text, max_points);
+	text += static_cast<uint16>(')');
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // CharacterWindow Class
 ////////////////////////////////////////////////////////////////////////////////
 
-CharacterWindow::CharacterWindow() : _char_id(GLOBAL_CHARACTER_INVALID) {
+CharacterWindow::CharacterWindow() :
+	_char_id(GLOBAL_CHARACTER_INVALID),
+	_name_style("title22"),
+	_text_style("text20"),
+	_level_label(UTranslate("Lv: ")),
+	_hp_label(UTranslate("HP: ")),
+	_sp_label(UTranslate("SP: ")),
+	_xp_label(UTranslate("XP to Next: "))
+{
 }
 
 
@@ -92,26 +109,27 @@ void CharacterWindow::Draw() {
 
 	// Write character name
 	VideoManager->MoveRelative(150, -5);
-	VideoManager->Text()->Draw(character->GetName(), TextStyle("title22"));
+	VideoManager->Text()->Draw(character->GetName(), _name_style);
 
 	// Level
 	VideoManager->MoveRelative(0,20);
-	VideoManager->Text()->Draw(UTranslate("Lv: ") + MakeUnicodeString(NumberToString(character->GetExperienceLevel())), TextStyle("text20"));
+	FormatLabel(_text, _level_label, character->GetExperienceLevel());
+	VideoManager->Text()->Draw(_text, _text_style);
 
 	// HP
 	VideoManager->MoveRelative(0,20);
-	VideoManager->Text()->Draw(UTranslate("HP: ") + MakeUnicodeString(NumberToString(character->GetHitPoints()) +
-		" / " + NumberToString(character->GetMaxHitPoints())), TextStyle("text20"));
+	FormatLabel(_text, _hp_label, character->GetHitPoints(), character->GetMaxHitPoints());
+	VideoManager->Text()->Draw(_text, _text_style);
 
 	// SP
 	VideoManager->MoveRelative(0,20);
-	VideoManager->Text()->Draw(UTranslate("SP: ") + MakeUnicodeString(NumberToString(character->GetSkillPoints()) +
-		" / " + NumberToString(character->GetMaxSkillPoints())), TextStyle("text20"));
+	FormatLabel(_text, _sp_label, character->GetSkillPoints(), character->GetMaxSkillPoints());
+	VideoManager->Text()->Draw(_text, _text_style);
 
 	// XP to level up
 	VideoManager->MoveRelative(0, 20);
-	VideoManager->Text()->Draw(UTranslate("XP to Next: ") +
-		MakeUnicodeString(NumberToString(character->GetExperienceForNextLevel() - character->GetExperiencePoints())), TextStyle("text20"));
+	FormatLabel(_text, _xp_label, character->GetExperienceForNextLevel() - character->GetExperiencePoints());
+	VideoManager->Text()->Draw(_text, _text_style);
 
 	return;
 }
@@ -474,8 +492,19 @@ void InventoryWindow::Draw() {
 ////////////////////////////////////////////////////////////////////////////////
 
 StatusWindow::StatusWindow() :
-	_char_select_active(false)
+	_char_select_active(false),
+	_level_label(UTranslate("Experience Level: ")),
+	_hp_label(UTranslate("HP: ")),
+	_sp_label(UTranslate("SP: ")),
+	_xp_label(UTranslate("XP to Next: "))
 {
+	_stat_labels.push_back(UTranslate("Strength: "));
+	_stat_labels.push_back(UTranslate("Vigor: "));
+	_stat_labels.push_back(UTranslate("Fortitude: "));
+	_stat_labels.push_back(UTranslate("Protection: "));
+	_stat_labels.push_back(UTranslate("Agility: "));
+	_stat_labels.push_back(UTranslate("Evade: "));
+
 	// Get party size for iteration
 	uint32 partysize = GlobalManager->GetActiveParty()->GetPartySize();
 	StillImage portrait;
@@ -571,39 +600,35 @@ void StatusWindow::Draw() {
 	VideoManager->Text()->Draw(ch->GetName());
 
 	VideoManager->MoveRelative(0, 25);
-	VideoManager->Text()->Draw(UTranslate("Experience Level: ") + MakeUnicodeString(NumberToString(ch->GetExperienceLevel())));
+	FormatLabel(_text, _level_label, ch->GetExperienceLevel());
+	VideoManager->Text()->Draw(_text);
 
 	VideoManager->SetDrawFlags(VIDEO_X_LEFT, 0);
 
 	//Draw all character stats
 	VideoManager->MoveRelative(-55, 60);
-	VideoManager->Text()->Draw(UTranslate("HP: ") + MakeUnicodeString(NumberToString(ch->GetHitPoints()) +
-		" (" + NumberToString(ch->GetMaxHitPoints()) + ")"));
-
-	VideoManager->MoveRelative(0, 25);
-	VideoManager->Text()->Draw(UTranslate("SP: ") + MakeUnicodeString(NumberToString(ch->GetSkillPoints()) +
-		" (" + NumberToString(ch->GetMaxSkillPoints()) + ")"));
-
-	VideoManager->MoveRelative(0, 25);
-	VideoManager->Text()->Draw(UTranslate("XP to Next: ") + MakeUnicodeString(NumberToString(ch->GetExperienceForNextLevel() - ch->GetExperiencePoints())));
+	FormatPoints(_text, _hp_label, ch->GetHitPoints(), ch->GetMaxHitPoints());
+	VideoManager->Text()->Draw(_text);
 
 	VideoManager->MoveRelative(0, 25);
-	VideoManager->Text()->Draw(UTranslate("Strength: ") + MakeUnicodeString(NumberToString(ch->GetStrength())));
+	FormatPoints(_text, _sp_label, ch->GetSkillPoints(), ch->GetMaxSkillPoints());
+	VideoManager->Text()->Draw(_text);
 
 	VideoManager->MoveRelative(0, 25);
-	VideoManager->Text()->Draw(UTranslate("Vigor: ") + MakeUnicodeString(NumberToString(ch->GetVigor())));
-
-	VideoManager->MoveRelative(0, 25);
-	VideoManager->Text()->Draw(UTranslate("Fortitude: ") + MakeUnicodeString(NumberToString(ch->GetFortitude())));
-
-	VideoManager->MoveRelative(0, 25);
-	VideoManager->Text()->Draw(UTranslate("Protection: ") + MakeUnicodeString(NumberToString(ch->GetProtection())));
-
-	VideoManager->MoveRelative(0, 25);
-	VideoManager->Text()->Draw(UTranslate("Agility: ") + MakeUnicodeString(NumberToString(ch->GetAgility())));
+	FormatLabel(_text, _xp_label, ch->GetExperienceForNextLevel() - ch->GetExperiencePoints());
+	VideoManager->Text()->Draw(_text);
+
+	uint32 stats[] = { ch->GetStrength(), ch->GetVigor(), ch->GetFortitude(), ch->GetProtection(), ch->GetAgility() };
+	for (uint32 i = 0; i < 5; ++i) {
+		VideoManager->MoveRelative(0, 25);
+		FormatLabel(_text, _stat_labels[i], stats[i]);
+		VideoManager->Text()->Draw(_text);
+	}
 
 	VideoManager->MoveRelative(0, 25);
-	VideoManager->Text()->Draw(UTranslate("Evade: ") + MakeUnicodeString(NumberToString(ch->GetEvade()) + "%"));
+	FormatLabel(_text, _stat_labels[5], static_cast<int32>(ch->GetEvade()));
+	_text += static_cast<uint16>('%');
+	VideoManager->Text()->Draw(_text);
 
 	//Draw character full body portrait
 	VideoManager->Move(855, 145);
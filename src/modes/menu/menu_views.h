@@ -121,6 +121,15 @@ private:
 	//! The image of the character
 	hoa_video::StillImage _portrait;
 
+	//! The text styles of the name and of the other lines, made once rather than at every draw
+	hoa_video::TextStyle _name_style, _text_style;
+
+	//! The labels of the lines, translated once
+	hoa_utils::ustring _level_label, _hp_label, _sp_label, _xp_label;
+
+	//! The buffer each line of text is formatted into, reused at every draw
+	hoa_utils::ustring _text;
+
 public:
 	CharacterWindow();
 
@@ -244,6 +253,15 @@ private:
 	//! character selection option box
 	hoa_gui::OptionBox _char_select;
 
+	//! The labels of the level and points, translated once
+	hoa_utils::ustring _level_label, _hp_label, _sp_label, _xp_label;
+
+	//! The labels of the stats, from strength to evade, translated once
+	std::vector<hoa_utils::ustring> _stat_labels;
+
+	//! The buffer each line of text is formatted into, reused at every draw
+	hoa_utils::ustring _text;
+
 	/*!
 	* \brief initialize character selection option box
 	*/
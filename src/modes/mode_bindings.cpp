@@ -36,6 +36,7 @@
 #include "modes/map/map.h"
 #include "modes/map/map_dialogue.h"
 #include "modes/map/map_events.h"
+#include "modes/map/map_loading.h"
 #include "modes/map/map_objects.h"
 #include "modes/map/map_sprites.h"
 #include "modes/map/map_treasure.h"
@@ -178,6 +179,12 @@ void BindModeCode() {
 			]
 	];
 
+	luabind::module(hoa_script::ScriptManager->GetGlobalState(), "hoa_map")
+	[
+		luabind::class_<MapLoadingMode, hoa_mode_manager::GameMode>("MapLoadingMode")
+			.def(luabind::constructor<const std::string&>())
+	];
+
 	luabind::module(hoa_script::ScriptManager->GetGlobalState(), "hoa_map")
 	[
 		luabind::class_<ObjectSupervisor>("ObjectSupervisor")
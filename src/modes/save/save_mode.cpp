@@ -21,6 +21,7 @@
 #include "engine/input.h"
 #include "modes/boot/boot.h"
 #include "modes/map/map.h"
+#include "modes/map/map_loading.h"
 
 using namespace std;
 using namespace hoa_utils;
@@ -384,17 +385,11 @@ bool SaveMode::_LoadGame(int id) {
 
 		GlobalManager->LoadGame(filename, (uint32)id);
 
-		// Create a new map mode, and fade out and in
+		// Load the map after fading out, the map fades in once loaded.
+		// NOTE: The loading mode returns to boot mode itself on errors.
 		ModeManager->PopAll();
-        try {
-            MapMode *MM = new MapMode(GlobalManager->GetMapFilename());
-            ModeManager->Push(MM, true, true);
-        } catch (luabind::error e) {
-            PRINT_ERROR << "Map::_Load -- Error loading map " << GlobalManager->GetMapFilename() << ", returning to BootMode." << endl;
-            cerr << "Exception message:" << endl;
-            ScriptManager->HandleLuaError(e);
-            ModeManager->Push(new BootMode(), true, true);
-        }
+		MapLoadingMode *MLM = new MapLoadingMode(GlobalManager->GetMapFilename());
+		ModeManager->Push(MLM, true, false);
 		return true;
 	}
 	else {
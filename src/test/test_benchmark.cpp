@@ -0,0 +1,429 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file    test_benchmark.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Source file for the deterministic game benchmark
+*** **************************************************************************/
+
+#include "test_benchmark.h"
+#include "test_main.h"
+
+#include "engine/audio/audio.h"
+#include "engine/input.h"
+#include "engine/mode_manager.h"
+#include "engine/script/script_read.h"
+#include "engine/system.h"
+#include "engine/video/video.h"
+
+#include "common/global/global.h"
+
+#include "modes/map/map_loading.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_audio;
+using namespace hoa_input;
+using namespace hoa_mode_manager;
+using namespace hoa_script;
+using namespace hoa_system;
+using namespace hoa_video;
+using namespace hoa_global;
+using namespace hoa_map;
+
+namespace hoa_test {
+
+namespace {
+
+//! \brief The file holding the functions starting the scripted battles
+const std::string BENCHMARK_BATTLE_FILENAME = "dat/config/debug_battle.lua";
+
+//! \brief A key press or release replayed by the benchmark
+class BenchmarkInput {
+public:
+	//! \brief The frame the event is sent at, counted from the start of the run
+	uint32 frame;
+
+	SDLKey key;
+
+	//! \brief True for a key press, false for a key release
+	bool pressed;
+
+	bool operator<(const BenchmarkInput& other) const
+		{ return frame < other.frame; }
+};
+
+//! \brief The measures of a benchmark run
+class BenchmarkResult {
+public:
+	BenchmarkResult() :
+		load_time(0), number_allocations(0), allocated_bytes(0) {}
+
+	//! \brief The map filename or the battle function name
+	std::string name;
+
+	//! \brief "map" or "battle"
+	std::string type;
+
+	//! \brief The time spent to load the run, in microseconds
+	Uint64 load_time;
+
+	//! \brief The time spent updating and drawing each frame, in microseconds
+	//@{
+	std::vector<uint32> update_times;
+	std::vector<uint32> draw_times;
+	//@}
+
+	//! \brief The number of draw calls of each frame
+	std::vector<uint32> draw_calls;
+
+	//! \brief The number of allocations and of bytes allocated during the frames
+	//@{
+	uint32 number_allocations;
+	uint32 allocated_bytes;
+	//@}
+};
+
+/** \brief Finds the key bound to a game command
+*** \param command The name of the command, as used in the settings file key table (e.g. "confirm")
+*** \return The key, or SDLK_UNKNOWN if the command is unknown
+**/
+SDLKey GetCommandKey(const std::string& command) {
+	std::string key_name;
+	if (command == "up") key_name = InputManager->GetUpKeyName();
+	else if (command == "down") key_name = InputManager->GetDownKeyName();
+	else if (command == "left") key_name = InputManager->GetLeftKeyName();
+	else if (command == "right") key_name = InputManager->GetRightKeyName();
+	else if (command == "confirm") key_name = InputManager->GetConfirmKeyName();
+	else if (command == "cancel") key_name = InputManager->GetCancelKeyName();
+	else if (command == "menu") key_name = InputManager->GetMenuKeyName();
+	else if (command == "swap") key_name = InputManager->GetSwapKeyName();
+	else if (command == "left_select") key_name = InputManager->GetLeftSelectKeyName();
+	else if (command == "right_select") key_name = InputManager->GetRightSelectKeyName();
+	else if (command == "pause") key_name = InputManager->GetPauseKeyName();
+	else
+		return SDLK_UNKNOWN;
+
+	// The input engine only gives the key names, so look for the key having the same name
+	for (int32 key = SDLK_FIRST; key < SDLK_LAST; ++key) {
+		if (key_name == SDL_GetKeyName(static_cast<SDLKey>(key)))
+			return static_cast<SDLKey>(key);
+	}
+	return SDLK_UNKNOWN;
+}
+
+
+
+//! \brief Sends a key event through the SDL event queue, as if it came from the keyboard
+void SendKeyEvent(SDLKey key, bool pressed) {
+	SDL_Event event;
+	event.type = pressed ? SDL_KEYDOWN : SDL_KEYUP;
+	event.key.type = event.type;
+	event.key.state = pressed ? SDL_PRESSED : SDL_RELEASED;
+	event.key.which = 0;
+	event.key.keysym.scancode = 0;
+	event.key.keysym.sym = key;
+	event.key.keysym.mod = KMOD_NONE;
+	event.key.keysym.unicode = 0;
+	SDL_PushEvent(&event);
+}
+
+
+
+//! \brief Seeds the random number generators of the game and of the Lua scripts
+void SeedRandomGenerators(uint32 seed) {
+	srand(seed);
+
+	lua_State* state = ScriptManager->GetGlobalState();
+	lua_getglobal(state, "math");
+	lua_getfield(state, -1, "randomseed");
+	lua_pushnumber(state, seed);
+	lua_call(state, 1, 0);
+	lua_pop(state, 1);
+}
+
+
+
+/** \brief Runs the game mode on top of the stack for a number of frames
+*** \param inputs The key events to replay, sorted by frame
+*** \param result Filled with the measures of each frame
+**/
+void RunFrames(uint32 num_frames, const std::vector<BenchmarkInput>& inputs, BenchmarkResult& result) {
+	result.update_times.reserve(num_frames);
+	result.draw_times.reserve(num_frames);
+	result.draw_calls.reserve(num_frames);
+
+	std::vector<SDLKey> pressed_keys;
+	uint32 next_input = 0;
+
+	StartCountingAllocations();
+	for (uint32 frame = 0; frame < num_frames; ++frame) {
+		for (; next_input < inputs.size() && inputs[next_input].frame <= frame; ++next_input) {
+			const BenchmarkInput& input = inputs[next_input];
+			SendKeyEvent(input.key, input.pressed);
+			if (input.pressed)
+				pressed_keys.push_back(input.key);
+			else
+				pressed_keys.erase(std::remove(pressed_keys.begin(), pressed_keys.end(), input.key), pressed_keys.end());
+		}
+
+		// A single update step per frame, whatever the time the frame took
+		Uint64 start_time = GetMicroseconds();
+		ScriptManager->StepGarbageCollector(0);
+		SystemManager->UpdateTimers();
+		InputManager->EventHandler();
+		VideoManager->Update();
+		AudioManager->Update();
+		ModeManager->Update();
+
+		Uint64 update_time = GetMicroseconds();
+		VideoManager->Clear();
+		ModeManager->Draw();
+		ModeManager->DrawEffects();
+		ModeManager->DrawPostEffects();
+		VideoManager->Draw();
+		SDL_GL_SwapBuffers();
+
+		Uint64 draw_time = GetMicroseconds();
+		result.update_times.push_back(static_cast<uint32>(update_time - start_time));
+		result.draw_times.push_back(static_cast<uint32>(draw_time - update_time));
+		result.draw_calls.push_back(VideoManager->GetDrawCallCount());
+	}
+	StopCountingAllocations(result.number_allocations, result.allocated_bytes);
+
+	// Release the keys still pressed, so that the next run starts without any
+	for (uint32 i = 0; i < pressed_keys.size(); ++i)
+		SendKeyEvent(pressed_keys[i], false);
+	InputManager->EventHandler();
+}
+
+
+
+//! \brief Clears the game data and sets up the party a new game starts with, as the maps expect it
+void ResetGameData() {
+	GlobalManager->ClearAllData();
+	GlobalManager->AddCharacter(1);
+	GlobalManager->AddNewEventGroup("global_events");
+}
+
+
+
+//! \brief Writes the average, the maximum and the 99th percentile of frame measures, in milliseconds if asked
+void WriteStatistics(ofstream& file, const std::vector<uint32>& values, bool milliseconds) {
+	std::vector<uint32> sorted_values(values);
+	std::sort(sorted_values.begin(), sorted_values.end());
+
+	float divisor = milliseconds ? 1000.0f : 1.0f;
+	float average = 0.0f;
+	float maximum = 0.0f;
+	float p99 = 0.0f;
+	if (!sorted_values.empty()) {
+		Uint64 sum = 0;
+		for (uint32 i = 0; i < sorted_values.size(); ++i)
+			sum += sorted_values[i];
+		average = sum / (sorted_values.size() * divisor);
+		maximum = sorted_values.back() / divisor;
+		p99 = sorted_values[(sorted_values.size() * 99) / 100] / divisor;
+	}
+
+	file << "{\"avg\":" << average << ",\"max\":" << maximum << ",\"p99\":" << p99 << "}";
+}
+
+
+
+//! \brief Writes a string as a quoted JSON string, escaping the quotes, the backslashes and the control characters
+void WriteString(ofstream& file, const std::string& value) {
+	file << '"';
+	for (uint32 i = 0; i < value.size(); ++i) {
+		unsigned char c = static_cast<unsigned char>(value[i]);
+		if (c == '"' || c == '\\')
+			file << '\\' << c;
+		else if (c < 0x20)
+			file << "\\u" << hex << setw(4) << setfill('0') << static_cast<uint32>(c) << dec << setfill(' ');
+		else
+			file << c;
+	}
+	file << '"';
+}
+
+} // namespace
+
+bool BenchmarkGame(const std::string& script_filename, const std::string& output_filename) {
+	ReadScriptDescriptor script;
+	if (!script.OpenFile(script_filename)) {
+		PRINT_ERROR << "could not open the benchmark script: " << script_filename << endl;
+		return false;
+	}
+
+	script.OpenTable("benchmark");
+	uint32 seed = script.ReadUInt("seed");
+	uint32 num_frames = script.ReadUInt("frames");
+
+	std::vector<BenchmarkInput> inputs;
+	if (script.DoesTableExist("input")) {
+		script.OpenTable("input");
+		uint32 num_inputs = script.GetTableSize();
+		for (uint32 i = 1; i <= num_inputs; ++i) {
+			script.OpenTable(i);
+			BenchmarkInput input;
+			input.frame = script.ReadUInt(1);
+			std::string command = script.ReadString(2);
+			input.key = GetCommandKey(command);
+			input.pressed = script.ReadBool(3);
+			script.CloseTable();
+
+			if (input.key == SDLK_UNKNOWN) {
+				PRINT_WARNING << "unknown command in the benchmark input: " << command << endl;
+				continue;
+			}
+			inputs.push_back(input);
+		}
+		script.CloseTable();
+	}
+	// Keep the events of a same frame in the script order
+	std::stable_sort(inputs.begin(), inputs.end());
+
+	std::vector<std::string> battle_functions;
+	if (script.DoesTableExist("battles"))
+		script.ReadStringVector("battles", battle_functions);
+	script.CloseTable();
+
+	if (script.IsErrorDetected()) {
+		PRINT_ERROR << "errors while reading the benchmark script: " << script.GetErrorMessages() << endl;
+		script.CloseFile();
+		return false;
+	}
+	script.CloseFile();
+
+	// The maps of the sub-directories are looked for one level deep
+	std::vector<std::string> map_files;
+	std::vector<std::string> map_entries = ListDirectory("dat/maps", "");
+	std::sort(map_entries.begin(), map_entries.end());
+	for (uint32 i = 0; i < map_entries.size(); ++i) {
+		if (map_entries[i].find(".lua") != std::string::npos) {
+			map_files.push_back("dat/maps/" + map_entries[i]);
+			continue;
+		}
+		if (map_entries[i][0] == '.')
+			continue;
+
+		std::vector<std::string> sub_entries = ListDirectory("dat/maps/" + map_entries[i], ".lua");
+		std::sort(sub_entries.begin(), sub_entries.end());
+		for (uint32 j = 0; j < sub_entries.size(); ++j)
+			map_files.push_back("dat/maps/" + map_entries[i] + "/" + sub_entries[j]);
+	}
+
+	// The frames must not wait for the screen refresh
+	VideoManager->SetVSync(false);
+	VideoManager->ApplySettings();
+
+	std::vector<BenchmarkResult> results;
+	for (uint32 i = 0; i < map_files.size(); ++i) {
+		cout << "Benchmarking map: " << map_files[i] << endl;
+		results.push_back(BenchmarkResult());
+		BenchmarkResult& result = results.back();
+		result.name = map_files[i];
+		result.type = "map";
+
+		ResetGameData();
+		SeedRandomGenerators(seed);
+
+		// The map is loaded as in the game, by the loading mode and its thread. The load lasts until
+		// the map mode is on top of the stack and reset.
+		Uint64 start_time = GetMicroseconds();
+		ModeManager->PopAll();
+		ModeManager->Push(new MapLoadingMode(map_files[i]), false, false);
+		do {
+			ModeManager->Update();
+		} while (ModeManager->GetGameType() == MODE_MANAGER_LOADING_MODE);
+		result.load_time = GetMicroseconds() - start_time;
+
+		// The loading mode returns to the boot mode when the map fails to load
+		if (ModeManager->GetGameType() != MODE_MANAGER_MAP_MODE) {
+			PRINT_WARNING << "could not load the map: " << map_files[i] << endl;
+			results.pop_back();
+			continue;
+		}
+
+		RunFrames(num_frames, inputs, result);
+	}
+
+	for (uint32 i = 0; i < battle_functions.size(); ++i) {
+		cout << "Benchmarking battle: " << battle_functions[i] << endl;
+		results.push_back(BenchmarkResult());
+		BenchmarkResult& result = results.back();
+		result.name = battle_functions[i];
+		result.type = "battle";
+
+		GlobalManager->ClearAllData();
+		SeedRandomGenerators(seed);
+
+		Uint64 start_time = GetMicroseconds();
+		ModeManager->PopAll();
+		ReadScriptDescriptor battle_script;
+		if (!battle_script.RunScriptFunction(BENCHMARK_BATTLE_FILENAME, battle_functions[i], true)) {
+			PRINT_WARNING << "could not start the battle: " << battle_functions[i] << endl;
+			results.pop_back();
+			continue;
+		}
+		ModeManager->Update();
+		result.load_time = GetMicroseconds() - start_time;
+
+		RunFrames(num_frames, inputs, result);
+	}
+
+	VideoManager->SetVSync(SystemManager->GetFramePacing() == FRAME_PACING_VSYNC);
+	VideoManager->ApplySettings();
+
+	ofstream file(output_filename.c_str());
+	if (!file) {
+		PRINT_ERROR << "could not open the benchmark output file: " << output_filename << endl;
+		return false;
+	}
+
+	file << fixed << setprecision(3);
+	file << "{\"seed\":" << seed << ",\"frames\":" << num_frames << ",\"runs\":[";
+	for (uint32 i = 0; i < results.size(); ++i) {
+		const BenchmarkResult& result = results[i];
+		float frames = static_cast<float>(std::max(num_frames, 1u));
+		file << (i == 0 ? "" : ",") << endl;
+		file << "{\"name\":";
+		WriteString(file, result.name);
+		file << ",\"type\":";
+		WriteString(file, result.type);
+		file << ",\"load_ms\":" << result.load_time / 1000.0f;
+		file << ",\"update_ms\":";
+		WriteStatistics(file, result.update_times, true);
+		file << ",\"draw_ms\":";
+		WriteStatistics(file, result.draw_times, true);
+		file << ",\"draw_calls\":";
+		WriteStatistics(file, result.draw_calls, false);
+		file << ",\"allocations_per_frame\":" << result.number_allocations / frames
+			<< ",\"allocated_bytes_per_frame\":" << result.allocated_bytes / frames << "}";
+	}
+	file << endl << "]}" << endl;
+
+	if (!file) {
+		PRINT_ERROR << "could not write the benchmark output file: " << output_filename << endl;
+		return false;
+	}
+
+	cout << "Benchmark results written to: " << output_filename << endl;
+	return true;
+} // bool BenchmarkGame(const std::string& script_filename, const std::string& output_filename)
+
+} // namespace hoa_test
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file    test_benchmark.h
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Header file for the deterministic game benchmark
+*** **************************************************************************/
+
+#ifndef __TEST_BENCHMARK_HEADER__
+#define __TEST_BENCHMARK_HEADER__
+
+#include "utils.h"
+
+namespace hoa_test {
+
+/** \brief Benchmarks the maps and the scripted battles, frame after frame
+*** \param script_filename The benchmark script, giving the seed, the number of frames and the input to replay
+*** \param output_filename The name of the JSON file the results are written to
+*** \return False if the benchmark script could not be read or the results could not be written
+***
+*** Every map found in dat/maps and its sub-directories is loaded, then run for the
+*** number of frames given by the script. The battles are started by the functions
+*** of dat/config/debug_battle.lua listed in the script, and run the same way.
+***
+*** Each run starts with the same random seed, and each frame updates the game by a
+*** single fixed step whatever the time it took, so that two runs of the same build
+*** go through the same game states. The key presses and releases of the script are
+*** replayed through the SDL event queue, at the frames they are given for.
+***
+*** The load time of each run is written, along with the update and draw times, the
+*** number of allocations and the number of draw calls per frame.
+***
+*** \note All the engines are required to be initialized, as done by the game
+*** before its main loop. The frames are drawn to the game window, as SDL can't
+*** create an OpenGL context without one. The vertical synchronization is disabled
+*** while the benchmark runs, and the game modes on the stack are popped.
+**/
+bool BenchmarkGame(const std::string& script_filename, const std::string& output_filename);
+
+} // namespace hoa_test
+
+#endif // __TEST_BENCHMARK_HEADER__
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file    test_images.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Source file for the image decoding benchmark
+*** **************************************************************************/
+
+#include "test_images.h"
+
+#include "engine/video/video.h"
+
+#include <sys/stat.h>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_video::private_video;
+
+namespace hoa_test {
+
+//! \brief The number of times the pixels of each image are converted, to get measurable times
+const uint32 BENCHMARK_IMAGES_CONVERSIONS = 10;
+
+//! \brief Adds the .png files found in the directory and its sub-directories to the list
+static void _ListImageFiles(const string& directory, vector<string>& filenames) {
+	vector<string> entries = ListDirectory(directory, "");
+	for (uint32 i = 0; i < entries.size(); ++i) {
+		if (entries[i].empty() || entries[i][0] == '.')
+			continue;
+
+		string path = directory + "/" + entries[i];
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0)
+			continue;
+
+		if (S_ISDIR(info.st_mode))
+			_ListImageFiles(path, filenames);
+		else if (path.size() > 4 && path.compare(path.size() - 4, 4, ".png") == 0)
+			filenames.push_back(path);
+	}
+}
+
+//! \brief Returns a throughput in megabytes per second
+static float _MegabytesPerSecond(float bytes, uint32 milliseconds) {
+	return (bytes / (1024.0f * 1024.0f)) / (static_cast<float>(milliseconds > 0 ? milliseconds : 1) / 1000.0f);
+}
+
+bool BenchmarkImageDecoding(const string& directory) {
+	vector<string> filenames;
+	_ListImageFiles(directory, filenames);
+
+	uint32 decoded_images = 0;
+	float decoded_bytes = 0.0f;
+	uint32 decode_time = 0;
+	uint32 conversion_time = 0;
+
+	for (uint32 i = 0; i < filenames.size(); ++i) {
+		uint32 start_time = SDL_GetTicks();
+		bool swap_red_blue = false;
+		SDL_Surface* surface = DecodeImageFile(filenames[i], swap_red_blue);
+		decode_time += SDL_GetTicks() - start_time;
+		if (surface == NULL)
+			continue;
+
+		uint32 size = surface->w * surface->h * 4;
+		uint8* pixels = static_cast<uint8*>(malloc(size));
+		start_time = SDL_GetTicks();
+		for (uint32 j = 0; j < BENCHMARK_IMAGES_CONVERSIONS; ++j) {
+			ConvertToRGBA(static_cast<const uint8*>(surface->pixels), surface->pitch, swap_red_blue,
+				pixels, surface->w, surface->h);
+		}
+		conversion_time += SDL_GetTicks() - start_time;
+
+		free(pixels);
+		SDL_FreeSurface(surface);
+
+		++decoded_images;
+		decoded_bytes += static_cast<float>(size);
+	}
+
+	if (decoded_images == 0) {
+		cout << "No image could be decoded in: " << directory << endl;
+		return false;
+	}
+
+#ifdef __SSE2__
+	const char* conversion_type = "SSE2";
+#else
+	const char* conversion_type = "scalar";
+#endif
+	cout << decoded_images << " images, " << decoded_bytes / (1024.0f * 1024.0f) << " MB of pixels" << endl;
+	cout << "Decoding: " << decode_time << " ms, "
+		<< _MegabytesPerSecond(decoded_bytes, decode_time) << " MB/s" << endl;
+	cout << "Conversion (" << conversion_type << "): " << conversion_time / BENCHMARK_IMAGES_CONVERSIONS << " ms, "
+		<< _MegabytesPerSecond(decoded_bytes * BENCHMARK_IMAGES_CONVERSIONS, conversion_time) << " MB/s" << endl;
+
+	return true;
+} // bool BenchmarkImageDecoding(const string& directory)
+
+} // namespace hoa_test
@@ -0,0 +1,38 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file    test_images.h
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Header file for the image decoding benchmark
+*** **************************************************************************/
+
+#ifndef __TEST_IMAGES_HEADER__
+#define __TEST_IMAGES_HEADER__
+
+#include "utils.h"
+
+namespace hoa_test {
+
+/** \brief Benchmarks the decoding of the game images
+*** \param directory The directory containing the images, searched recursively
+*** \return False if no image could be decoded
+***
+*** Every .png file found is decoded, and its pixels are then converted to the
+*** texture format. The decoding and the conversion are timed separately, and
+*** their throughput is printed in megabytes of decoded pixels per second.
+***
+*** \note No engine is required to be initialized, as no texture is created.
+**/
+bool BenchmarkImageDecoding(const std::string& directory);
+
+} // namespace hoa_test
+
+#endif // __TEST_IMAGES_HEADER__
@@ -14,21 +14,157 @@
 *** **************************************************************************/
 
 #include "test_main.h"
+#include "test_benchmark.h"
+#include "test_images.h"
+#include "test_particles.h"
+#include "test_pathfinding.h"
 
+#include "engine/script/script.h"
+#include "engine/system.h"
+
+#include "main_init.h"
+
+#include <cstdlib>
 #include <iostream>
+#include <new>
 
-using namespace hoa_test;
 using namespace std;
+using namespace hoa_utils;
+using namespace hoa_script;
+using namespace hoa_system;
+
+namespace {
+
+//! \brief Whether the allocations are counted
+volatile bool counting_allocations = false;
+
+//! \brief The number of allocations and of bytes allocated while counting
+//@{
+volatile uint32 number_allocations = 0;
+volatile uint32 allocated_bytes = 0;
+//@}
+
+//! \brief Adds a value to a counter shared by several threads
+void AtomicAdd(volatile uint32* value, uint32 amount) {
+#ifdef _MSC_VER
+	InterlockedExchangeAdd(reinterpret_cast<volatile LONG*>(value), amount);
+#else
+	__sync_fetch_and_add(value, amount);
+#endif
+}
+
+} // namespace
 
-bool ExecuteTests(string tests) {
-	cout << "This option is not yet implemented." << endl;
+// The global allocation functions are replaced in the test program only, so that the allocations done by any
+// part of the game can be counted. The array forms call these ones.
+void* operator new(size_t size) {
+	if (counting_allocations) {
+		AtomicAdd(&number_allocations, 1);
+		AtomicAdd(&allocated_bytes, static_cast<uint32>(size));
+	}
 
+	void* memory = malloc(size == 0 ? 1 : size);
+	if (memory == NULL)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void* memory) throw() {
+	free(memory);
+}
+
+namespace hoa_test {
+
+bool ExecuteTests(const std::string& tests) {
 	cout << "Tests to execute: " << tests << endl;
-	return false;
-} // bool ExecuteTests(string tests)
+
+	bool success = true;
+	bool found = false;
+	if (tests.find("pathfinding") != string::npos) {
+		success = BenchmarkPathFinding(2000) && success;
+		found = true;
+	}
+	if (tests.find("particles") != string::npos) {
+		success = BenchmarkParticles(10000) && success;
+		found = true;
+	}
+	if (tests.find("images") != string::npos) {
+		success = BenchmarkImageDecoding("img") && success;
+		found = true;
+	}
+	if (tests.find("benchmark") != string::npos) {
+		success = BenchmarkGame("dat/config/benchmark.lua", "benchmark.json") && success;
+		found = true;
+	}
+
+	if (!found) {
+		cout << "This option is not yet implemented." << endl;
+		return false;
+	}
+
+	return success;
+} // bool ExecuteTests(const std::string& tests)
+
+
+
+void StartCountingAllocations() {
+	number_allocations = 0;
+	allocated_bytes = 0;
+	counting_allocations = true;
+}
+
+
+
+void StopCountingAllocations(uint32& allocations, uint32& bytes) {
+	counting_allocations = false;
+	allocations = number_allocations;
+	bytes = allocated_bytes;
+	number_allocations = 0;
+	allocated_bytes = 0;
+}
+
+} // namespace hoa_test
 
 
 // Main entry point to test application
 int main(int argc, char *argv[]) {
-	return 0;
-}
+	// When the program exits, the QuitApp() function will be called first, followed by SDL_Quit()
+	atexit(SDL_Quit);
+	atexit(hoa_main::QuitApp);
+
+	if (argc < 2) {
+		cout << "Usage: " << argv[0] << " <tests>" << endl;
+		cout << "Available tests: pathfinding particles images benchmark" << endl;
+		return EXIT_FAILURE;
+	}
+
+	string tests = argv[1];
+	for (int i = 2; i < argc; ++i)
+		tests += string(" ") + argv[i];
+
+	try {
+		// The game benchmark runs the game modes, while the other tests only need some of the engines
+		if (tests.find("benchmark") != string::npos) {
+			hoa_main::InitializeEngine();
+		}
+		else {
+			// The timer is used by the tests to measure the time they spend
+			if (SDL_Init(SDL_INIT_TIMER) != 0)
+				throw Exception("ERROR: unable to initialize SDL", __FILE__, __LINE__, __FUNCTION__);
+
+			ScriptManager = ScriptEngine::SingletonCreate();
+			if (ScriptManager->SingletonInitialize() == false)
+				throw Exception("ERROR: unable to initialize ScriptManager", __FILE__, __LINE__, __FUNCTION__);
+
+			// The map path finder searches the corridors in a thread created by the system engine
+			SystemManager = SystemEngine::SingletonCreate();
+			if (SystemManager->SingletonInitialize() == false)
+				throw Exception("ERROR: unable to initialize SystemManager", __FILE__, __LINE__, __FUNCTION__);
+		}
+	} catch (Exception& e) {
+		cerr << e.ToString() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return hoa_test::ExecuteTests(tests) ? EXIT_SUCCESS : EXIT_FAILURE;
+} // int main(int argc, char *argv[])
@@ -16,7 +16,7 @@
 #ifndef __TEST_MAIN_HEADER__
 #define __TEST_MAIN_HEADER__
 
-#include <string>
+#include "utils.h"
 
 /** \brief Namespace containing code used only for testing purposes
 *** \note Normally no other code should need to use this namespace.
@@ -27,11 +27,22 @@ namespace hoa_test {
 *** \param tests The list of tests to execute in a space delimited string format
 *** \return False if one or more of the executed tests failed
 ***
-*** This function is used to test specific aspects of the game code. Each test does its own engine initialization
-*** and runs a custom game loop, subverting the primary game loop found in main.cpp. All test code is
-*** contained in the src/test directory.
+*** This function is used to test specific aspects of the game code. It is called by the main() function of
+*** the test program, once the engines required by the tests are initialized, and each test runs its own
+*** loop instead of the primary game loop found in main.cpp. All test code is contained in the src/test directory.
 **/
-bool ExecuteTests(std::string& tests);
+bool ExecuteTests(const std::string& tests);
+
+/** \brief Starts counting the allocations done through the global operator new, by any thread
+*** \note The allocations are only counted in the test program, which replaces the global operator new.
+**/
+void StartCountingAllocations();
+
+/** \brief Gives the number of allocations done since the counting started, and stops counting them
+*** \param allocations Set to the number of allocations
+*** \param bytes Set to the number of bytes allocated
+**/
+void StopCountingAllocations(uint32& allocations, uint32& bytes);
 
 } // namespace hoa_test
 
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file    test_particles.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Source file for the particle update benchmark
+*** **************************************************************************/
+
+#include "test_particles.h"
+
+#include "engine/video/video.h"
+#include "engine/video/particle_effect.h"
+#include "engine/video/particle_manager.h"
+#include "engine/video/particle_system.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_mode_manager;
+
+namespace hoa_test {
+
+//! \brief The simulated time and frame duration, in seconds
+const float BENCHMARK_PARTICLES_DURATION = 10.0f;
+const float BENCHMARK_PARTICLES_FRAME_TIME = 1.0f / 60.0f;
+
+bool BenchmarkParticles(uint32 num_particles) {
+	bool success = false;
+
+	vector<string> effect_files = ListDirectory("dat/effects/particles", ".lua");
+	for (uint32 i = 0; i < effect_files.size(); ++i) {
+		string filename = "dat/effects/particles/" + effect_files[i];
+
+		ParticleEffectDef* def = ParticleManager::LoadEffectDef(filename);
+		if (def == NULL)
+			continue;
+
+		// Scale the systems up to the requested number of particles
+		int32 max_particles = 0;
+		for (list<ParticleSystemDef*>::iterator it = def->_systems.begin(); it != def->_systems.end(); ++it) {
+			if ((*it)->enabled)
+				max_particles += (*it)->max_particles;
+		}
+		if (max_particles <= 0) {
+			delete def;
+			continue;
+		}
+		float scale = static_cast<float>(num_particles) / static_cast<float>(max_particles);
+
+		srand(1000 + i);
+		vector<ParticleSystem*> systems;
+		for (list<ParticleSystemDef*>::iterator it = def->_systems.begin(); it != def->_systems.end(); ++it) {
+			if (!(*it)->enabled)
+				continue;
+
+			(*it)->max_particles = static_cast<int32>((*it)->max_particles * scale + 0.5f);
+			(*it)->emitter._emission_rate *= scale;
+
+			ParticleSystem* system = new ParticleSystem();
+			system->Create(*it, false);
+			systems.push_back(system);
+		}
+
+		EffectParameters params;
+		params.orientation = 0.0f;
+		params.attractor_x = 0.0f;
+		params.attractor_y = 0.0f;
+
+		uint32 num_frames = static_cast<uint32>(BENCHMARK_PARTICLES_DURATION / BENCHMARK_PARTICLES_FRAME_TIME);
+		uint32 updated_particles = 0;
+		uint32 peak_particles = 0;
+
+		uint32 start_time = SDL_GetTicks();
+		for (uint32 frame = 0; frame < num_frames; ++frame) {
+			uint32 frame_particles = 0;
+			for (uint32 j = 0; j < systems.size(); ++j) {
+				// Short lived systems are started over, to keep on simulating particles
+				if (!systems[j]->IsAlive())
+					systems[j]->Reset();
+
+				frame_particles += systems[j]->GetNumParticles();
+				systems[j]->Update(BENCHMARK_PARTICLES_FRAME_TIME, params);
+			}
+			updated_particles += frame_particles;
+			if (frame_particles > peak_particles)
+				peak_particles = frame_particles;
+		}
+		uint32 update_time = SDL_GetTicks() - start_time;
+
+		cout << effect_files[i] << ": " << systems.size() << " systems, "
+			<< peak_particles << " particles at most, "
+			<< updated_particles << " particle updates in " << update_time << " ms, "
+			<< static_cast<float>(updated_particles) / static_cast<float>(update_time > 0 ? update_time : 1)
+			<< " particles/ms" << endl;
+
+		for (uint32 j = 0; j < systems.size(); ++j) {
+			systems[j]->Destroy();
+			delete systems[j];
+		}
+		delete def;
+		success = true;
+	}
+
+	if (!success)
+		cout << "No particle effect could be loaded from dat/effects/particles" << endl;
+	return success;
+} // bool BenchmarkParticles(uint32 num_particles)
+
+} // namespace hoa_test
@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file    test_particles.h
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Header file for the particle update benchmark
+*** **************************************************************************/
+
+#ifndef __TEST_PARTICLES_HEADER__
+#define __TEST_PARTICLES_HEADER__
+
+#include "utils.h"
+
+namespace hoa_test {
+
+/** \brief Benchmarks the particle systems update
+*** \param num_particles The number of particles to simulate for each effect
+*** \return False if no particle effect could be loaded
+***
+*** Every particle effect found in dat/effects/particles is loaded, and the maximum
+*** number of particles and the emission rate of its systems are scaled up so that the
+*** effect holds about num_particles particles. The effect is then simulated for ten
+*** seconds at 60 frames per second, and the number of particles updated per
+*** millisecond is printed.
+***
+*** \note Only the script engine is required to be initialized, as the particle
+*** images aren't loaded.
+**/
+bool BenchmarkParticles(uint32 num_particles);
+
+} // namespace hoa_test
+
+#endif // __TEST_PARTICLES_HEADER__
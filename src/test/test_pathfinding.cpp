@@ -0,0 +1,293 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file    test_pathfinding.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Source file for the map path finding benchmark
+*** **************************************************************************/
+
+#include "test_pathfinding.h"
+
+#include "engine/audio/audio.h"
+#include "engine/script/script_read.h"
+
+#include "modes/map/map.h"
+#include "modes/map/map_compiled.h"
+#include "modes/map/map_objects.h"
+#include "modes/map/map_sprites.h"
+
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_script;
+using namespace hoa_map;
+using namespace hoa_map::private_map;
+
+namespace hoa_test {
+
+namespace {
+
+/** \brief The former path finding implementation, kept as a reference
+***
+*** The open list is sorted on every iteration and both lists are searched linearly.
+**/
+Path LegacyFindPath(ObjectSupervisor& objects, VirtualSprite* sprite, const MapPosition& destination) {
+	Path path;
+
+	PathNode source_node(static_cast<int16>(sprite->GetXPosition()), static_cast<int16>(sprite->GetYPosition()));
+	PathNode dest(static_cast<int16>(destination.x), static_cast<int16>(destination.y));
+	if (source_node == dest)
+		return path;
+
+	std::vector<PathNode> open_list;
+	std::vector<PathNode> closed_list;
+
+	PathNode best_node;
+	PathNode nodes[8];
+	uint32 x_delta, y_delta;
+	int16 g_add;
+
+	open_list.push_back(source_node);
+
+	float offset_x = GetFloatFraction(destination.x);
+	float offset_y = GetFloatFraction(destination.y);
+
+	while (open_list.empty() == false) {
+		sort(open_list.begin(), open_list.end());
+		best_node = open_list.back();
+		open_list.pop_back();
+		closed_list.push_back(best_node);
+
+		if (best_node == dest)
+			break;
+
+		nodes[0].tile_x = best_node.tile_x - 1; nodes[0].tile_y = best_node.tile_y;
+		nodes[1].tile_x = best_node.tile_x + 1; nodes[1].tile_y = best_node.tile_y;
+		nodes[2].tile_x = best_node.tile_x;     nodes[2].tile_y = best_node.tile_y - 1;
+		nodes[3].tile_x = best_node.tile_x;     nodes[3].tile_y = best_node.tile_y + 1;
+		nodes[4].tile_x = best_node.tile_x - 1; nodes[4].tile_y = best_node.tile_y - 1;
+		nodes[5].tile_x = best_node.tile_x - 1; nodes[5].tile_y = best_node.tile_y + 1;
+		nodes[6].tile_x = best_node.tile_x + 1; nodes[6].tile_y = best_node.tile_y - 1;
+		nodes[7].tile_x = best_node.tile_x + 1; nodes[7].tile_y = best_node.tile_y + 1;
+
+		for (uint8 i = 0; i < 8; ++i) {
+			COLLISION_TYPE collision_type = objects.DetectCollision(sprite,
+				((float)nodes[i].tile_x) + offset_x, ((float)nodes[i].tile_y) + offset_y);
+			if (collision_type == WALL_COLLISION)
+				continue;
+
+			if (find(closed_list.begin(), closed_list.end(), nodes[i]) != closed_list.end())
+				continue;
+
+			g_add = (i < 4) ? 10 : 14;
+			if (collision_type == CHARACTER_COLLISION || collision_type == ENEMY_COLLISION)
+				g_add += 20;
+
+			nodes[i].parent_x = best_node.tile_x;
+			nodes[i].parent_y = best_node.tile_y;
+			nodes[i].g_score = best_node.g_score + g_add;
+
+			vector<PathNode>::iterator iter = find(open_list.begin(), open_list.end(), nodes[i]);
+			if (iter != open_list.end()) {
+				if (iter->g_score > nodes[i].g_score) {
+					iter->g_score = nodes[i].g_score;
+					iter->f_score = nodes[i].g_score + iter->h_score;
+					iter->parent_x = nodes[i].parent_x;
+					iter->parent_y = nodes[i].parent_y;
+				}
+			}
+			else {
+				x_delta = abs(dest.tile_x - nodes[i].tile_x);
+				y_delta = abs(dest.tile_y - nodes[i].tile_y);
+				if (x_delta > y_delta)
+					nodes[i].h_score = 14 * y_delta + 10 * (x_delta - y_delta);
+				else
+					nodes[i].h_score = 14 * x_delta + 10 * (y_delta - x_delta);
+
+				nodes[i].f_score = nodes[i].g_score + nodes[i].h_score;
+				open_list.push_back(nodes[i]);
+			}
+		}
+	}
+
+	if (best_node != dest)
+		return path;
+
+	path.push_back(destination);
+
+	int16 parent_x = best_node.parent_x;
+	int16 parent_y = best_node.parent_y;
+	closed_list.pop_back();
+
+	for (vector<PathNode>::iterator iter = closed_list.end() - 1; iter != closed_list.begin(); --iter) {
+		if (iter->tile_y == parent_y && iter->tile_x == parent_x) {
+			path.push_back(MapPosition(((float)iter->tile_x) + offset_x, ((float)iter->tile_y) + offset_y));
+			parent_x = iter->parent_x;
+			parent_y = iter->parent_y;
+		}
+	}
+	std::reverse(path.begin(), path.end());
+
+	return path;
+} // Path LegacyFindPath(ObjectSupervisor& objects, VirtualSprite* sprite, const MapPosition& destination)
+
+
+
+//! \brief Returns the A* cost of a path: 10 per lateral step and 14 per diagonal one
+uint32 GetPathCost(const MapPosition& source, const Path& path) {
+	uint32 cost = 0;
+	MapPosition previous = source;
+	for (uint32 i = 0; i < path.size(); ++i) {
+		bool diagonal = !IsFloatEqual(previous.x, path[i].x) && !IsFloatEqual(previous.y, path[i].y);
+		cost += diagonal ? 14 : 10;
+		previous = path[i];
+	}
+	return cost;
+}
+
+} // namespace
+
+
+
+bool BenchmarkPathFinding(uint32 num_queries) {
+	bool success = true;
+	uint32 num_maps = 0;
+
+	// The maps of the sub-directories are looked for one level deep
+	vector<string> map_files;
+	vector<string> map_entries = ListDirectory("dat/maps", "");
+	for (uint32 i = 0; i < map_entries.size(); ++i) {
+		if (map_entries[i].find(".lua") != string::npos) {
+			map_files.push_back("dat/maps/" + map_entries[i]);
+			continue;
+		}
+		if (map_entries[i][0] == '.')
+			continue;
+
+		vector<string> sub_entries = ListDirectory("dat/maps/" + map_entries[i], ".lua");
+		for (uint32 j = 0; j < sub_entries.size(); ++j)
+			map_files.push_back("dat/maps/" + map_entries[i] + "/" + sub_entries[j]);
+	}
+
+	for (uint32 i = 0; i < map_files.size(); ++i) {
+		const string& filename = map_files[i];
+
+		ReadScriptDescriptor map_script;
+		if (!map_script.OpenFile(filename))
+			continue;
+		map_script.OpenTablespace();
+
+		CompiledMap map_data;
+		ObjectSupervisor objects;
+		if (!map_data.Load(map_script) || !objects.Load(map_data)) {
+			map_script.CloseFile();
+			continue;
+		}
+		map_script.CloseFile();
+
+		// A sprite with the usual character collision box
+		VirtualSprite sprite;
+		sprite.SetCollHalfWidth(0.95f);
+		sprite.SetCollHeight(1.9f);
+
+		// Use the same random walkable positions for both implementations
+		srand(1000 + i);
+		vector<MapPosition> sources;
+		vector<MapPosition> destinations;
+		uint32 attempts = 0;
+		while (sources.size() < num_queries && attempts < num_queries * 100) {
+			++attempts;
+			MapPosition source(RandomBoundedInteger(0, objects.GetGridXAxisSize() - 1) + 0.5f,
+				RandomBoundedInteger(0, objects.GetGridYAxisSize() - 1) + 0.5f);
+			MapPosition destination(RandomBoundedInteger(0, objects.GetGridXAxisSize() - 1) + 0.5f,
+				RandomBoundedInteger(0, objects.GetGridYAxisSize() - 1) + 0.5f);
+
+			if (objects.DetectCollision(&sprite, source.x, source.y) == WALL_COLLISION
+					|| objects.DetectCollision(&sprite, destination.x, destination.y) == WALL_COLLISION
+					|| (static_cast<int16>(source.x) == static_cast<int16>(destination.x)
+					&& static_cast<int16>(source.y) == static_cast<int16>(destination.y)))
+				continue;
+
+			sources.push_back(source);
+			destinations.push_back(destination);
+		}
+		if (sources.empty())
+			continue;
+
+		++num_maps;
+		vector<uint32> costs(sources.size(), 0);
+
+		uint32 start_time = SDL_GetTicks();
+		for (uint32 j = 0; j < sources.size(); ++j) {
+			sprite.SetPosition(sources[j].x, sources[j].y);
+			Path path = objects.FindPath(&sprite, destinations[j]);
+			costs[j] = GetPathCost(sources[j], path);
+		}
+		uint32 heap_time = SDL_GetTicks() - start_time;
+
+		uint32 mismatches = 0;
+		start_time = SDL_GetTicks();
+		for (uint32 j = 0; j < sources.size(); ++j) {
+			sprite.SetPosition(sources[j].x, sources[j].y);
+			Path path = LegacyFindPath(objects, &sprite, destinations[j]);
+			if (GetPathCost(sources[j], path) != costs[j])
+				++mismatches;
+		}
+		uint32 legacy_time = SDL_GetTicks() - start_time;
+
+		// The corridor paths are not always the shortest ones, but they must exist whenever a path does
+		uint32 corridor_mismatches = 0;
+		uint32 corridor_cost = 0;
+		uint32 shortest_cost = 0;
+		start_time = SDL_GetTicks();
+		for (uint32 j = 0; j < sources.size(); ++j) {
+			sprite.SetPosition(sources[j].x, sources[j].y);
+			uint32 request_id = objects.RequestPath(&sprite, destinations[j]);
+			Path path;
+			while (!objects.TakePath(request_id, path))
+				objects.UpdatePathRequests(PATH_FINDING_FRAME_BUDGET);
+
+			if (path.empty() != (costs[j] == 0)) {
+				++corridor_mismatches;
+				continue;
+			}
+			corridor_cost += GetPathCost(sources[j], path);
+			shortest_cost += costs[j];
+		}
+		uint32 corridor_time = SDL_GetTicks() - start_time;
+
+		cout << map_files[i] << ": " << sources.size() << " queries, "
+			<< "binary heap: " << heap_time << " ms, "
+			<< "sorted vector: " << legacy_time << " ms, "
+			<< "corridors: " << corridor_time << " ms";
+		if (shortest_cost > 0)
+			cout << " (" << (corridor_cost - shortest_cost) * 100.0f / shortest_cost << "% longer)";
+		if (mismatches > 0) {
+			cout << ", " << mismatches << " path cost mismatches";
+			success = false;
+		}
+		if (corridor_mismatches > 0) {
+			cout << ", " << corridor_mismatches << " corridor path mismatches";
+			success = false;
+		}
+		cout << endl;
+	}
+
+	if (num_maps == 0) {
+		cout << "No map could be loaded from dat/maps" << endl;
+		return false;
+	}
+	return success;
+} // bool BenchmarkPathFinding(uint32 num_queries)
+
+} // namespace hoa_test
@@ -0,0 +1,40 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file    test_pathfinding.h
+*** \author  Yohann Ferreira, yohann ferreira orange fre
+*** \brief   Header file for the map path finding benchmark
+*** **************************************************************************/
+
+#ifndef __TEST_PATHFINDING_HEADER__
+#define __TEST_PATHFINDING_HEADER__
+
+#include "utils.h"
+
+namespace hoa_test {
+
+/** \brief Benchmarks the map mode path finding against the former implementation
+*** \param num_queries The number of random path queries to run on each map
+*** \return False if no map could be loaded, or if the two implementations disagreed on the length of a path
+***
+*** The collision grid of every map found in dat/maps and its sub-directories is loaded, then the same random
+*** pairs of walkable source and destination positions are given to
+*** ObjectSupervisor::FindPath() and to the former sorted vector based implementation.
+*** The time spent by both of them is printed for every map.
+***
+*** \note Only the script and system engines are required to be initialized, the latter
+*** creating the thread the path finder searches the corridors in.
+**/
+bool BenchmarkPathFinding(uint32 num_queries);
+
+} // namespace hoa_test
+
+#endif // __TEST_PATHFINDING_HEADER__
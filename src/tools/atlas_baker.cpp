@@ -0,0 +1,327 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2011 by The Allacrost Project
+//            Copyright (C) 2012 by Bertram
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ***************************************************************************
+*** \file   atlas_baker.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fre
+*** \brief  Offline tool packing image files into a texture atlas file
+***
+*** Usage: vt-atlas-baker <manifest> <output.vta> [--size <max size>] [--raw]
+***
+*** The manifest is a text file listing one image per line, with the paths
+*** used by the game to load them. Empty lines and lines starting with '#'
+*** are ignored:
+***
+*** - image <filename>: an image loaded by StillImage::Load()
+*** - multi <filename> <rows> <cols>: a multi image loaded with
+***   ImageDescriptor::LoadMultiImageFromElementGrid(), split in its elements
+***
+*** The images are packed in the smallest power of two sheet they fit in, up
+*** to the maximum size (2048 by default). The pixels are compressed with zlib
+*** unless --raw is given.
+*** **************************************************************************/
+
+#include "utils.h"
+
+#include "engine/video/rect_packer.h"
+#include "engine/video/texture_atlas.h"
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_image.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_video::private_video;
+
+namespace {
+
+//! \brief The default maximum width and height of the baked atlases
+const uint32 DEFAULT_MAX_ATLAS_SIZE = 2048;
+
+//! \brief An image to pack, decoded to RGBA
+struct BakedImage {
+	uint32 width, height;
+
+	std::vector<uint8> pixels;
+};
+
+
+
+//! \brief Returns the value of a pixel of an SDL surface, whatever its format
+uint32 GetSurfacePixel(const SDL_Surface* surface, uint32 x, uint32 y) {
+	const uint8* pixel = static_cast<const uint8*>(surface->pixels) + y * surface->pitch + x * surface->format->BytesPerPixel;
+	switch (surface->format->BytesPerPixel) {
+		case 1:
+			return *pixel;
+		case 2:
+			return *reinterpret_cast<const Uint16*>(pixel);
+		case 3:
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			return (pixel[0] << 16) | (pixel[1] << 8) | pixel[2];
+#else
+			return pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+#endif
+		default:
+			return *reinterpret_cast<const Uint32*>(pixel);
+	}
+}
+
+
+
+/** \brief Decodes an image file to RGBA pixels
+*** The color key of palette images is turned into transparent pixels, as done by the game.
+**/
+bool DecodeImage(const std::string& filename, BakedImage& image) {
+	SDL_Surface* surface = IMG_Load(filename.c_str());
+	if (surface == NULL) {
+		PRINT_ERROR << "could not load image file: " << filename << " (" << IMG_GetError() << ")" << endl;
+		return false;
+	}
+
+	image.width = surface->w;
+	image.height = surface->h;
+	image.pixels.resize(image.width * image.height * 4);
+
+	bool color_key = (surface->flags & SDL_SRCCOLORKEY) != 0;
+	SDL_LockSurface(surface);
+	for (uint32 y = 0; y < image.height; ++y) {
+		for (uint32 x = 0; x < image.width; ++x) {
+			uint32 value = GetSurfacePixel(surface, x, y);
+			uint8* rgba = &image.pixels[(y * image.width + x) * 4];
+			SDL_GetRGBA(value, surface->format, &rgba[0], &rgba[1], &rgba[2], &rgba[3]);
+			if (color_key && value == surface->format->colorkey)
+				rgba[3] = 0;
+		}
+	}
+	SDL_UnlockSurface(surface);
+	SDL_FreeSurface(surface);
+	return true;
+}
+
+
+
+//! \brief Copies a part of an image
+void CopyImagePart(const BakedImage& source, uint32 x, uint32 y, BakedImage& part) {
+	part.pixels.resize(part.width * part.height * 4);
+	for (uint32 row = 0; row < part.height; ++row) {
+		memcpy(&part.pixels[row * part.width * 4], &source.pixels[((y + row) * source.width + x) * 4], part.width * 4);
+	}
+}
+
+
+
+/** \brief Reads the manifest and decodes its images
+*** \return False if the manifest or one of its images could not be read
+**/
+bool ReadManifest(const std::string& manifest_filename, TextureAtlasFile& atlas, std::vector<BakedImage>& images) {
+	ifstream manifest(manifest_filename.c_str());
+	if (!manifest) {
+		PRINT_ERROR << "could not open the manifest file: " << manifest_filename << endl;
+		return false;
+	}
+
+	std::string line;
+	uint32 line_number = 0;
+	while (getline(manifest, line)) {
+		++line_number;
+		istringstream words(line);
+		std::string kind, filename;
+		if (!(words >> kind) || kind[0] == '#')
+			continue;
+
+		if (!(words >> filename)) {
+			PRINT_ERROR << manifest_filename << ":" << line_number << ": missing image filename" << endl;
+			return false;
+		}
+
+		// The stamp lets the game ignore the entries whose image file changed since
+		TextureAtlasStamp stamp;
+		if (stamp.Read(filename) == false) {
+			PRINT_ERROR << "could not examine image file: " << filename << endl;
+			return false;
+		}
+
+		BakedImage image;
+		if (kind == "image") {
+			if (DecodeImage(filename, image) == false)
+				return false;
+
+			TextureAtlasEntry entry;
+			entry.filename = filename;
+			entry.stamp = stamp;
+			entry.width = image.width;
+			entry.height = image.height;
+			atlas.entries.push_back(entry);
+			images.push_back(image);
+		}
+		else if (kind == "multi") {
+			TextureAtlasMultiImage multi_image;
+			multi_image.filename = filename;
+			if (!(words >> multi_image.rows >> multi_image.cols) || multi_image.rows == 0 || multi_image.cols == 0) {
+				PRINT_ERROR << manifest_filename << ":" << line_number << ": missing or invalid multi image grid" << endl;
+				return false;
+			}
+
+			if (DecodeImage(filename, image) == false)
+				return false;
+
+			if (image.height % multi_image.rows != 0 || image.width % multi_image.cols != 0) {
+				PRINT_ERROR << "multi image size not evenly divisible by its grid: " << filename << endl;
+				return false;
+			}
+
+			// The elements are stored in the order and with the tags used by ImageDescriptor::_LoadMultiImage()
+			multi_image.first_entry = atlas.entries.size();
+			for (uint32 x = 0; x < multi_image.rows; ++x) {
+				for (uint32 y = 0; y < multi_image.cols; ++y) {
+					BakedImage element;
+					element.width = image.width / multi_image.cols;
+					element.height = image.height / multi_image.rows;
+					CopyImagePart(image, y * element.width, x * element.height, element);
+
+					TextureAtlasEntry entry;
+					entry.filename = filename;
+					entry.stamp = stamp;
+					entry.tags = "<X" + NumberToString(x) + "_" + NumberToString(multi_image.rows) + ">" +
+						"<Y" + NumberToString(y) + "_" + NumberToString(multi_image.cols) + ">";
+					entry.width = element.width;
+					entry.height = element.height;
+					atlas.entries.push_back(entry);
+					images.push_back(element);
+				}
+			}
+			atlas.multi_images.push_back(multi_image);
+		}
+		else {
+			PRINT_ERROR << manifest_filename << ":" << line_number << ": unknown image kind: " << kind << endl;
+			return false;
+		}
+	}
+
+	return true;
+} // bool ReadManifest(...)
+
+
+
+//! \brief Used to pack the tallest images first
+class CompareImageHeights {
+public:
+	CompareImageHeights(const std::vector<BakedImage>& images) :
+		_images(images) {}
+
+	bool operator()(uint32 a, uint32 b) const
+		{ return _images[a].height > _images[b].height || (_images[a].height == _images[b].height && _images[a].width > _images[b].width); }
+
+private:
+	const std::vector<BakedImage>& _images;
+};
+
+
+
+/** \brief Places the images in a sheet of the given size
+*** \return False if they don't all fit
+**/
+bool PackImages(TextureAtlasFile& atlas, const std::vector<uint32>& order, uint32 width, uint32 height) {
+	RectanglePacker packer;
+	packer.Reset(width, height);
+	for (uint32 i = 0; i < order.size(); ++i) {
+		TextureAtlasEntry& entry = atlas.entries[order[i]];
+		if (packer.Insert(entry.width, entry.height, entry.x, entry.y) == false)
+			return false;
+	}
+
+	atlas.width = width;
+	atlas.height = height;
+	return true;
+}
+
+} // namespace
+
+
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		cerr << "Usage: " << argv[0] << " <manifest> <output" << TEXTURE_ATLAS_EXTENSION << "> [--size <max size>] [--raw]" << endl;
+		return 1;
+	}
+
+	std::string manifest_filename = argv[1];
+	std::string atlas_filename = argv[2];
+	uint32 max_size = DEFAULT_MAX_ATLAS_SIZE;
+	bool compress = true;
+	for (int32 i = 3; i < argc; ++i) {
+		std::string option = argv[i];
+		if (option == "--raw") {
+			compress = false;
+		}
+		else if (option == "--size" && i + 1 < argc) {
+			max_size = RoundUpPow2(atoi(argv[++i]));
+		}
+		else {
+			cerr << "Unknown option: " << option << endl;
+			return 1;
+		}
+	}
+
+	TextureAtlasFile atlas;
+	std::vector<BakedImage> images;
+	if (ReadManifest(manifest_filename, atlas, images) == false)
+		return 1;
+
+	if (images.empty()) {
+		PRINT_ERROR << "no image listed in the manifest: " << manifest_filename << endl;
+		return 1;
+	}
+
+	// The smallest power of two sheet holding the total area is tried first
+	uint32 total_area = 0;
+	uint32 largest_side = 0;
+	std::vector<uint32> order(images.size());
+	for (uint32 i = 0; i < images.size(); ++i) {
+		order[i] = i;
+		total_area += images[i].width * images[i].height;
+		largest_side = max(largest_side, max(images[i].width, images[i].height));
+	}
+	sort(order.begin(), order.end(), CompareImageHeights(images));
+
+	bool packed = false;
+	for (uint32 size = RoundUpPow2(largest_side); size <= max_size && packed == false; size *= 2) {
+		// A sheet twice as wide as high is tried before the square one
+		if (size / 2 >= largest_side && (size / 2) * size >= total_area)
+			packed = PackImages(atlas, order, size, size / 2);
+		if (packed == false && size * size >= total_area)
+			packed = PackImages(atlas, order, size, size);
+	}
+
+	if (packed == false) {
+		PRINT_ERROR << "the images don't fit in a " << max_size << "x" << max_size << " atlas" << endl;
+		return 1;
+	}
+
+	atlas.pixels.assign(atlas.width * atlas.height * 4, 0);
+	for (uint32 i = 0; i < images.size(); ++i) {
+		const TextureAtlasEntry& entry = atlas.entries[i];
+		for (uint32 row = 0; row < entry.height; ++row) {
+			memcpy(&atlas.pixels[((entry.y + row) * atlas.width + entry.x) * 4], &images[i].pixels[row * entry.width * 4], entry.width * 4);
+		}
+	}
+
+	if (atlas.Write(atlas_filename, compress) == false)
+		return 1;
+
+	cout << atlas_filename << ": " << atlas.entries.size() << " images in " << atlas.width << "x" << atlas.height << ", "
+		<< (total_area * 100) / (atlas.width * atlas.height) << "% occupied" << endl;
+	return 0;
+} // int main(int argc, char* argv[])
@@ -463,6 +463,43 @@ std::string MakeStandardString(const ustring& text) {
 	return new_str;
 } // string MakeStandardString(const ustring& text)
 
+
+// Appends the digits of a number to a ustring, without any temporary string
+void AppendNumber(ustring& text, int32 number) {
+	// The magnitude is computed unsigned, so that the smallest int32 doesn't overflow
+	uint32 magnitude = static_cast<uint32>(number);
+	if (number < 0) {
+		text += static_cast<uint16>('-');
+		magnitude = 0u - magnitude;
+	}
+
+	uint16 digits[10];
+	uint32 num_digits = 0;
+	do {
+		digits[num_digits++] = static_cast<uint16>('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude != 0);
+
+	while (num_digits > 0)
+		text += digits[--num_digits];
+}
+
+
+void FormatLabel(ustring& text, const ustring& label, int32 number) {
+	text = label;
+	AppendNumber(text, number);
+}
+
+
+void FormatLabel(ustring& text, const ustring& label, int32 number, int32 max_number) {
+	text = label;
+	AppendNumber(text, number);
+	text += static_cast<uint16>(' ');
+	text += static_cast<uint16>('/');
+	text += static_cast<uint16>(' ');
+	AppendNumber(text, max_number);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ///// Random number generator functions
 ////////////////////////////////////////////////////////////////////////////////
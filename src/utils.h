@@ -303,6 +303,12 @@ public:
 
 	ustring & operator = (const ustring& s);
 
+	bool operator == (const ustring& s) const
+		{ return _str == s._str; }
+
+	bool operator != (const ustring& s) const
+		{ return _str != s._str; }
+
 	uint16 & operator [] (size_t pos)
 		{ return _str[pos]; }
 
@@ -506,6 +512,31 @@ hoa_utils::ustring MakeUnicodeString(const std::string& text);
 *** this may come in use if a ustring contains file information.
 **/
 std::string MakeStandardString(const hoa_utils::ustring& text);
+
+/** \brief Appends the decimal representation of an integer to a ustring
+*** \param text The ustring to append the number to
+*** \param number The number to append
+***
+*** Unlike NumberToString() and MakeUnicodeString(), this doesn't create any string. A
+*** text rebuilt every frame into the same ustring doesn't allocate memory, once the
+*** ustring has grown large enough to hold it.
+**/
+void AppendNumber(hoa_utils::ustring& text, int32 number);
+
+/** \brief Sets a ustring to a label followed by a number, as "Lv: 12"
+*** \param text The ustring to write into, whose memory is reused
+*** \param label The label, translated once by the caller rather than at every call
+*** \param number The number following the label
+**/
+void FormatLabel(hoa_utils::ustring& text, const hoa_utils::ustring& label, int32 number);
+
+/** \brief Sets a ustring to a label followed by a number and its maximum, as "HP: 45 / 120"
+*** \param text The ustring to write into, whose memory is reused
+*** \param label The label, translated once by the caller rather than at every call
+*** \param number The number following the label
+*** \param max_number The maximum of the number, following a slash
+**/
+void FormatLabel(hoa_utils::ustring& text, const hoa_utils::ustring& label, int32 number, int32 max_number);
 //@}
 
 